@@ -215,6 +215,8 @@ typedef struct {
     uint32_t  textureEnhancement;
     uint32_t  textureEnhancementControl;
     uint32_t  textureQuality;
+    uint32_t  textureCacheSize;       // MB, 0 for no limit
+    uint32_t  textureUploadLimit;     // KB per frame, 0 for no limit
     uint32_t  anisotropicFiltering;
     uint32_t  multiSampling;
     bool    bTexRectOnly;
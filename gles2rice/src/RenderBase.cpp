@@ -281,6 +281,12 @@ void InitRenderBase()
         ProcessVertexData = ProcessVertexDataNEON;
     }
     else
+#elif defined(__SSE2__)
+    if( status.isSSESupported && !g_curRomInfo.bPrimaryDepthHack && options.enableHackForGames != HACK_FOR_NASCAR && options.enableHackForGames != HACK_FOR_ZELDA_MM && !options.bWinFrameMode)
+    {
+        ProcessVertexData = ProcessVertexDataSSE;
+    }
+    else
 #endif
     {
         ProcessVertexData = ProcessVertexDataNoSSE;
@@ -1066,6 +1072,99 @@ void ProcessVertexDataNEON(uint32_t dwAddr, uint32_t dwV0, uint32_t dwNum)
 }
 #endif
 
+#if defined(__SSE2__) && !defined(__ARM_NEON__)
+/* SSE code */
+
+#include "RenderBase_sse.h"
+
+#ifdef RICE_VERTEX_CAPTURE
+#include <stdio.h>
+
+// stop after about a minute of a busy game
+#define VERTEX_CAPTURE_LIMIT    1000000
+
+static void CaptureVertexBatch(const FiddledVtx *pVtxBase, uint32_t dwNum, int sse_state)
+{
+    static FILE *f = NULL;
+    static uint32_t captured = 0;
+
+    if( captured >= VERTEX_CAPTURE_LIMIT )
+        return;
+
+    if( f == NULL )
+    {
+        f = fopen("rice_vertices.bin", "wb");
+        if( f == NULL )
+        {
+            captured = VERTEX_CAPTURE_LIMIT;
+            return;
+        }
+    }
+
+    PVBatchHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PV_BATCH_MAGIC;
+    header.dwNum = dwNum;
+    header.sse_state = sse_state;
+    header.numLights = gRSPnumLights;
+    header.fFogMin = gRSPfFogMin;
+    header.primitiveColor = gRDP.primitiveColor;
+    memcpy(header.fAmbientLightRGBA, gRSP.fAmbientColors, sizeof(header.fAmbientLightRGBA));
+    header.worldProject = gRSPworldProject;
+    header.modelViewTop = gRSPmodelViewTop;
+    memcpy(header.lights, gRSPlights, sizeof(header.lights));
+
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(pVtxBase, sizeof(FiddledVtx), dwNum, f);
+    fflush(f);
+    captured++;
+}
+#endif
+
+void ProcessVertexDataSSE(uint32_t dwAddr, uint32_t dwV0, uint32_t dwNum)
+{
+    if (gRSP.bTextureGen && gRSP.bLightingEnable) {
+        ProcessVertexDataNoSSE(dwAddr, dwV0, dwNum);
+        return;
+    }
+
+    // Same assumptions as ProcessVertexDataNEON(): g_clipFlag,
+    // g_vtxNonTransformed and g_normal are not used after this returns.
+
+    int sse_state = 0;
+    if ( gRSP.bLightingEnable )
+        sse_state |= PV_SSE_ENABLE_LIGHT;
+    if ( (gRDP.geometryMode & G_SHADE) || gRSP.ucode >= 5 )
+        sse_state |= PV_SSE_ENABLE_SHADE;
+    if ( gRSP.bFogEnabled )
+        sse_state |= PV_SSE_ENABLE_FOG;
+    if ( gRDP.geometryMode & G_FOG )
+        sse_state |= PV_SSE_FOG_ALPHA;
+
+    UpdateCombinedMatrix();
+
+    uint8_t *rdram_u8 = (uint8_t*)gfx_info.RDRAM;
+    const FiddledVtx * pVtxBase = (const FiddledVtx*)(rdram_u8 + dwAddr);
+    g_pVtxBase = (FiddledVtx *)pVtxBase;
+
+    // SP_Timing(RSP_GBI0_Vtx);
+    status.SPCycleCount += Timing_RSP_GBI0_Vtx * dwNum;
+
+#ifdef RICE_VERTEX_CAPTURE
+    CaptureVertexBatch(pVtxBase, dwNum, sse_state);
+#endif
+
+    pv_sse(&g_vtxTransformed[dwV0], &g_vecProjected[dwV0],
+            &g_dwVtxDifColor[dwV0], &g_fVtxTxtCoords[dwV0],
+            &g_fFogCoord[dwV0], &g_clipFlag2[dwV0],
+            dwNum, sse_state, pVtxBase,
+            gRSPlights, gRSP.fAmbientColors,
+            &gRSPworldProject, &gRSPmodelViewTop,
+            gRSPnumLights, gRSPfFogMin,
+            gRDP.primitiveColor);
+}
+#endif
+
 bool PrepareTriangle(uint32_t dwV0, uint32_t dwV1, uint32_t dwV2)
 {
    SP_Timing(SP_Each_Triangle);
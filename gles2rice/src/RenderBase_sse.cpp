@@ -0,0 +1,257 @@
+/*
+Copyright (C) 2003 Rice1964
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "RenderBase_sse.h"
+
+#define X_CLIP_MAX  0x1
+#define X_CLIP_MIN  0x2
+#define Y_CLIP_MAX  0x4
+#define Y_CLIP_MIN  0x8
+
+#if defined(__SSE2__)
+/* SSE2 code */
+
+#include <emmintrin.h>
+
+// Four vertices, one per lane
+typedef struct
+{
+    __m128 x, y, z, w;
+} Vec4x4;
+
+static inline void transpose(__m128 &a, __m128 &b, __m128 &c, __m128 &d)
+{
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+static inline __m128 splat(float f)
+{
+    return _mm_set1_ps(f);
+}
+
+// Each sum is added in the order the C code adds it, so that the
+// rounding is the same.
+static inline __m128 dot3(__m128 x, __m128 y, __m128 z, float a, float b, float c)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, splat(a)), _mm_mul_ps(y, splat(b))), _mm_mul_ps(z, splat(c)));
+}
+
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i select_epi32(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// (uint32_t)c for a color channel in [0, 255], or 0 for NaN like the
+// 64-bit conversion the compiler emits
+static inline __m128i channel(__m128 c)
+{
+    c = _mm_min_ps(splat(255.0f), c);
+    return _mm_cvttps_epi32(_mm_and_ps(c, _mm_cmpord_ps(c, c)));
+}
+
+static void pv_sse_4(VECTOR4 *vtxTransformed, VECTOR4 *vecProjected,
+    uint32_t *dwVtxDifColor, VECTOR2 *fVtxTxtCoords,
+    float *fFogCoord, uint32_t *clipFlag2,
+    int sse_state, const FiddledVtx *vtx,
+    const Light *lights, const float *fAmbientLightRGBA,
+    const MATRIX *wp, const MATRIX *mv,
+    uint32_t numLights, float fFogMin,
+    uint32_t primitiveColor)
+{
+    // Every vertex is four dwords: y|x, flag|z, tv|tu and the color or
+    // normal. Transposed, each register holds one of them for all four.
+    __m128 d0 = _mm_loadu_ps((const float *)&vtx[0]);
+    __m128 d1 = _mm_loadu_ps((const float *)&vtx[1]);
+    __m128 d2 = _mm_loadu_ps((const float *)&vtx[2]);
+    __m128 d3 = _mm_loadu_ps((const float *)&vtx[3]);
+    transpose(d0, d1, d2, d3);
+
+    __m128i xy = _mm_castps_si128(d0);
+    __m128i z = _mm_castps_si128(d1);
+    __m128i uv = _mm_castps_si128(d2);
+    __m128i col = _mm_castps_si128(d3);
+
+    __m128 vx = _mm_cvtepi32_ps(_mm_srai_epi32(xy, 16));
+    __m128 vy = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(xy, 16), 16));
+    __m128 vz = _mm_cvtepi32_ps(_mm_srai_epi32(z, 16));
+
+    // Vec3Transform()
+    Vec4x4 t;
+    t.x = _mm_add_ps(dot3(vx, vy, vz, wp->_11, wp->_21, wp->_31), splat(wp->_41));
+    t.y = _mm_add_ps(dot3(vx, vy, vz, wp->_12, wp->_22, wp->_32), splat(wp->_42));
+    t.z = _mm_add_ps(dot3(vx, vy, vz, wp->_13, wp->_23, wp->_33), splat(wp->_43));
+    t.w = _mm_add_ps(dot3(vx, vy, vz, wp->_14, wp->_24, wp->_34), splat(wp->_44));
+
+    Vec4x4 p;
+    p.w = _mm_div_ps(splat(1.0f), t.w);
+    p.x = _mm_mul_ps(t.x, p.w);
+    p.y = _mm_mul_ps(t.y, p.w);
+    p.z = _mm_mul_ps(t.z, p.w);
+
+    __m128 zero = _mm_setzero_ps();
+
+    if( sse_state & PV_SSE_ENABLE_FOG )
+    {
+        __m128 fogMin = splat(fFogMin);
+        __m128 low = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(p.w, zero), _mm_cmplt_ps(p.z, zero)),
+                _mm_cmplt_ps(p.z, fogMin));
+        _mm_storeu_ps(fFogCoord, select(low, fogMin, p.z));
+    }
+
+    // RSP_Vtx_Clipping()
+    __m128i clip = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(p.x, splat(1.0f))), _mm_set1_epi32(X_CLIP_MAX)),
+                         _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(p.x, splat(-1.0f))), _mm_set1_epi32(X_CLIP_MIN))),
+            _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(p.y, splat(1.0f))), _mm_set1_epi32(Y_CLIP_MAX)),
+                         _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(p.y, splat(-1.0f))), _mm_set1_epi32(Y_CLIP_MIN))));
+    clip = _mm_and_si128(clip, _mm_castps_si128(_mm_cmpgt_ps(p.w, zero)));
+    _mm_storeu_si128((__m128i *)clipFlag2, clip);
+
+    __m128i color;
+    if( sse_state & PV_SSE_ENABLE_LIGHT )
+    {
+        // The normal is nx, ny, nz, na from the top byte down
+        __m128 nx = _mm_cvtepi32_ps(_mm_srai_epi32(col, 24));
+        __m128 ny = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(col, 8), 24));
+        __m128 nz = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(col, 16), 24));
+
+        // Vec3TransformNormal()
+        __m128 tx = dot3(nx, ny, nz, mv->_11, mv->_21, mv->_31);
+        __m128 ty = dot3(nx, ny, nz, mv->_12, mv->_22, mv->_32);
+        __m128 tz = dot3(nx, ny, nz, mv->_13, mv->_23, mv->_33);
+        __m128 norm = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty)), _mm_mul_ps(tz, tz)));
+        __m128 nonzero = _mm_cmpneq_ps(norm, zero);
+        nx = _mm_and_ps(nonzero, _mm_div_ps(tx, norm));
+        ny = _mm_and_ps(nonzero, _mm_div_ps(ty, norm));
+        nz = _mm_and_ps(nonzero, _mm_div_ps(tz, norm));
+
+        // LightVert()
+        __m128 r = splat(fAmbientLightRGBA[0]);
+        __m128 g = splat(fAmbientLightRGBA[1]);
+        __m128 b = splat(fAmbientLightRGBA[2]);
+        for (uint32_t l = 0; l < numLights; l++)
+        {
+            __m128 fCosT = dot3(nx, ny, nz, lights[l].x, lights[l].y, lights[l].z);
+            __m128 lit = _mm_cmpgt_ps(fCosT, zero);
+            r = _mm_add_ps(r, _mm_and_ps(lit, _mm_mul_ps(splat(lights[l].fr), fCosT)));
+            g = _mm_add_ps(g, _mm_and_ps(lit, _mm_mul_ps(splat(lights[l].fg), fCosT)));
+            b = _mm_add_ps(b, _mm_and_ps(lit, _mm_mul_ps(splat(lights[l].fb), fCosT)));
+        }
+
+        // still use alpha from the vertex
+        color = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(col, 24), _mm_slli_epi32(channel(r), 16)),
+                _mm_or_si128(_mm_slli_epi32(channel(g), 8), channel(b)));
+    }
+    else if( sse_state & PV_SSE_ENABLE_SHADE )
+    {
+        // a, b, g, r in the vertex, a, r, g, b in the color
+        color = _mm_or_si128(_mm_srli_epi32(col, 8), _mm_slli_epi32(col, 24));
+    }
+    else
+    {
+        // FLAT shade
+        color = _mm_set1_epi32(primitiveColor);
+    }
+
+    if( sse_state & PV_SSE_FOG_ALPHA )
+    {
+        // ReplaceAlphaWithFogFactor(): the z > 1 case is overwritten by
+        // the next test there, so only z < 0 is special.
+        __m128i alpha = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(p.z, splat(255.0f))), _mm_set1_epi32(0xFF));
+        alpha = _mm_andnot_si128(_mm_castps_si128(_mm_cmplt_ps(p.z, zero)), alpha);
+        color = select_epi32(_mm_set1_epi32(0x00FFFFFF), color, _mm_slli_epi32(alpha, 24));
+    }
+    _mm_storeu_si128((__m128i *)dwVtxDifColor, color);
+
+    __m128 tu = _mm_cvtepi32_ps(_mm_srai_epi32(uv, 16));
+    __m128 tv = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(uv, 16), 16));
+    _mm_storeu_ps(&fVtxTxtCoords[0].x, _mm_unpacklo_ps(tu, tv));
+    _mm_storeu_ps(&fVtxTxtCoords[2].x, _mm_unpackhi_ps(tu, tv));
+
+    transpose(t.x, t.y, t.z, t.w);
+    _mm_storeu_ps(&vtxTransformed[0].x, t.x);
+    _mm_storeu_ps(&vtxTransformed[1].x, t.y);
+    _mm_storeu_ps(&vtxTransformed[2].x, t.z);
+    _mm_storeu_ps(&vtxTransformed[3].x, t.w);
+
+    transpose(p.x, p.y, p.z, p.w);
+    _mm_storeu_ps(&vecProjected[0].x, p.x);
+    _mm_storeu_ps(&vecProjected[1].x, p.y);
+    _mm_storeu_ps(&vecProjected[2].x, p.z);
+    _mm_storeu_ps(&vecProjected[3].x, p.w);
+}
+
+void pv_sse(VECTOR4 *vtxTransformed, VECTOR4 *vecProjected,
+    uint32_t *dwVtxDifColor, VECTOR2 *fVtxTxtCoords,
+    float *fFogCoord, uint32_t *clipFlag2,
+    uint32_t dwNum, int sse_state,
+    const FiddledVtx *vtx,
+    const Light *lights, const float *fAmbientLightRGBA,
+    const MATRIX *worldProject, const MATRIX *modelViewTop,
+    uint32_t numLights, float fFogMin,
+    uint32_t primitiveColor)
+{
+    uint32_t i;
+
+    for (i = 0; i + 4 <= dwNum; i += 4)
+    {
+        pv_sse_4(&vtxTransformed[i], &vecProjected[i], &dwVtxDifColor[i], &fVtxTxtCoords[i],
+                &fFogCoord[i], &clipFlag2[i], sse_state, &vtx[i],
+                lights, fAmbientLightRGBA, worldProject, modelViewTop,
+                numLights, fFogMin, primitiveColor);
+    }
+
+    if (i < dwNum)
+    {
+        // The last few go through the same code, padded to four
+        uint32_t n = dwNum - i;
+        FiddledVtx tailVtx[4];
+        VECTOR4 tailTransformed[4], tailProjected[4];
+        uint32_t tailColor[4], tailClip[4];
+        VECTOR2 tailTxtCoords[4];
+        float tailFog[4];
+
+        memset(tailVtx, 0, sizeof(tailVtx));
+        memcpy(tailVtx, &vtx[i], n * sizeof(FiddledVtx));
+
+        pv_sse_4(tailTransformed, tailProjected, tailColor, tailTxtCoords,
+                tailFog, tailClip, sse_state, tailVtx,
+                lights, fAmbientLightRGBA, worldProject, modelViewTop,
+                numLights, fFogMin, primitiveColor);
+
+        memcpy(&vtxTransformed[i], tailTransformed, n * sizeof(VECTOR4));
+        memcpy(&vecProjected[i], tailProjected, n * sizeof(VECTOR4));
+        memcpy(&dwVtxDifColor[i], tailColor, n * sizeof(uint32_t));
+        memcpy(&fVtxTxtCoords[i], tailTxtCoords, n * sizeof(VECTOR2));
+        memcpy(&clipFlag2[i], tailClip, n * sizeof(uint32_t));
+        if( sse_state & PV_SSE_ENABLE_FOG )
+            memcpy(&fFogCoord[i], tailFog, n * sizeof(float));
+    }
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2003 Rice1964
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#ifndef _RENDERBASE_SSE_H_
+#define _RENDERBASE_SSE_H_
+
+#include <stdint.h>
+
+#include "typedefs.h"
+
+#define PV_SSE_ENABLE_LIGHT     (1 << 0)
+#define PV_SSE_ENABLE_SHADE     (1 << 1)
+#define PV_SSE_ENABLE_FOG       (1 << 2)
+#define PV_SSE_FOG_ALPHA        (1 << 3)
+
+// pv_sse() does for a whole vertex batch what ProcessVertexDataNoSSE()
+// does for each vertex, as long as there is no depth hack, no point light,
+// no texture generation and no wireframe. It works on four vertices at a
+// time, and gives the same bits as the C code, which rice-vertex-check
+// checks by running both over the same RSP state.
+void pv_sse(VECTOR4 *vtxTransformed, VECTOR4 *vecProjected,
+    uint32_t *dwVtxDifColor, VECTOR2 *fVtxTxtCoords,
+    float *fFogCoord, uint32_t *clipFlag2,
+    uint32_t dwNum, int sse_state,
+    const FiddledVtx *vtx,
+    const Light *lights, const float *fAmbientLightRGBA,
+    const MATRIX *worldProject, const MATRIX *modelViewTop,
+    uint32_t numLights, float fFogMin,
+    uint32_t primitiveColor);
+
+// A batch as RICE_VERTEX_CAPTURE builds write it to rice_vertices.bin:
+// this header, then dwNum FiddledVtx.
+#define PV_BATCH_MAGIC          0x58545650  // "PVTX"
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t dwNum;
+    int32_t  sse_state;
+    uint32_t numLights;
+    float    fFogMin;
+    uint32_t primitiveColor;
+    float    fAmbientLightRGBA[4];
+    MATRIX   worldProject;
+    MATRIX   modelViewTop;
+    Light    lights[16];
+} PVBatchHeader;
+
+#endif
@@ -363,6 +363,8 @@ bool InitConfiguration(void)
     ConfigSetDefaultInt(l_ConfigVideoRice, "TextureEnhancement", 0, "Primary texture enhancement filter (0=None, 1=2X, 2=2XSAI, 3=HQ2X, 4=LQ2X, 5=HQ4X, 6=Sharpen, 7=Sharpen More, 8=External, 9=Mirrored)");
     ConfigSetDefaultInt(l_ConfigVideoRice, "TextureEnhancementControl", 0, "Secondary texture enhancement filter (0 = none, 1-4 = filtered)");
     ConfigSetDefaultInt(l_ConfigVideoRice, "TextureQuality", TXT_QUALITY_DEFAULT, "Color bit depth to use for textures (0=default, 1=32 bits, 2=16 bits)");
+    ConfigSetDefaultInt(l_ConfigVideoRice, "TextureCacheSize", 64, "Memory for cached textures in MB, the least recently used ones go first when it is full (0=no limit)");
+    ConfigSetDefaultInt(l_ConfigVideoRice, "TextureUploadLimit", 0, "Texture data uploaded per frame in KB, before changed textures wait for the next frame (0=no limit)");
     ConfigSetDefaultInt(l_ConfigVideoRice, "OpenGLDepthBufferSetting", 16, "Z-buffer depth (only 16 or 32)");
     ConfigSetDefaultInt(l_ConfigVideoRice, "MultiSampling", 0, "Enable/Disable MultiSampling (0=off, 2,4,8,16=quality)");
     ConfigSetDefaultInt(l_ConfigVideoRice, "ColorQuality", TEXTURE_FMT_A8R8G8B8, "Color bit depth for rendering window (0=32 bits, 1=16 bits)");
@@ -383,6 +385,22 @@ bool isMMXSupported()
    return false; 
 }
 
+bool isSSESupported() 
+{ 
+#if defined(__SSE2__)
+   unsigned cpu = 0;
+
+   // without the frontend's word for it the C code runs
+   if (perf_get_cpu_features_cb)
+      cpu = perf_get_cpu_features_cb();
+
+   if (cpu & RETRO_SIMD_SSE2)
+      return true;
+#endif
+
+   return false; 
+}
+
 static void ReadConfiguration(void)
 {
    struct retro_variable var = { "mupen64-screensize", 0 };
@@ -437,6 +455,12 @@ static void ReadConfiguration(void)
    options.textureEnhancement = ConfigGetParamInt(l_ConfigVideoRice, "TextureEnhancement");
    options.textureEnhancementControl = ConfigGetParamInt(l_ConfigVideoRice, "TextureEnhancementControl");
    options.textureQuality = ConfigGetParamInt(l_ConfigVideoRice, "TextureQuality");
+   options.textureCacheSize = ConfigGetParamInt(l_ConfigVideoRice, "TextureCacheSize");
+   if (options.textureCacheSize > 2048)   // or negative: no limit
+      options.textureCacheSize = 0;
+   options.textureUploadLimit = ConfigGetParamInt(l_ConfigVideoRice, "TextureUploadLimit");
+   if (options.textureUploadLimit > 1024*1024)
+      options.textureUploadLimit = 0;
    options.OpenglDepthBufferSetting = ConfigGetParamInt(l_ConfigVideoRice, "OpenGLDepthBufferSetting");
    options.multiSampling = ConfigGetParamInt(l_ConfigVideoRice, "MultiSampling");
    options.colorQuality = ConfigGetParamInt(l_ConfigVideoRice, "ColorQuality");
@@ -445,6 +469,7 @@ static void ReadConfiguration(void)
    CDeviceBuilder::SelectDeviceType((SupportedDeviceType)options.OpenglRenderSetting);
 
    status.isMMXSupported = isMMXSupported();
+   status.isSSESupported = isSSESupported();
    ProcessVertexData = ProcessVertexDataNoSSE;
 }
     
@@ -27,10 +27,6 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 CTextureManager gTextureManager;
 
-unsigned int g_maxTextureMemUsage = (5*1024*1024);
-unsigned int g_amountToFree = (512*1024);
-bool g_bUseSetTextureMem = false;
-
 // Returns the first prime greater than or equal to nFirst
 inline int GetNextPrime(int nFirst)
 {
@@ -79,9 +75,14 @@ CTextureManager::CTextureManager() :
     m_numOfCachedTxtrList = GetNextPrime(800);
 
     m_currentTextureMemUsage    = 0;
+    m_numOfTextures             = 0;
     m_pYoungestTexture          = NULL;
     m_pOldestTexture            = NULL;
 
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_statsFrame = 0;
+    m_statsLogFrame = 0;
+
     m_pCacheTxtrList = new TxtrCacheEntry *[m_numOfCachedTxtrList];
 
     for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
@@ -110,15 +111,12 @@ bool CTextureManager::CleanUp()
 {
     RecycleAllTextures();
 
-    if (!g_bUseSetTextureMem)
+    while (m_pHead)
     {
-        while (m_pHead)
-        {
-            TxtrCacheEntry * pVictim = m_pHead;
-            m_pHead = pVictim->pNext;
+        TxtrCacheEntry * pVictim = m_pHead;
+        m_pHead = pVictim->pNext;
 
-            delete pVictim;
-        }
+        delete pVictim;
     }
 
     if( m_blackTextureEntry.pTexture )      delete m_blackTextureEntry.pTexture;    
@@ -151,29 +149,22 @@ void CTextureManager::PurgeOldTextures()
 {
     if (m_pCacheTxtrList == NULL)
         return;
-    
-    if (g_bUseSetTextureMem)
-        return;
 
     static const uint32_t dwFramesToKill = 5*30;          // 5 secs at 30 fps
     static const uint32_t dwFramesToDelete = 30*30;       // 30 secs at 30 fps
+    static const uint32_t dwFramesToLog = 10*30;          // 10 secs at 30 fps
     
-    for ( uint32_t i = 0; i < m_numOfCachedTxtrList; i++ )
+    // Oldest first, up to the first one still in use
+    TxtrCacheEntry * pEntry = m_pOldestTexture;
+    while (pEntry && status.gDlistCount - pEntry->FrameLastUsed > dwFramesToKill)
     {
-        TxtrCacheEntry * pEntry;
-        TxtrCacheEntry * pNext;
-        
-        pEntry = m_pCacheTxtrList[i];
-        while (pEntry)
+        TxtrCacheEntry * pNextYoungest = pEntry->pNextYoungest;
+
+        if (!TCacheEntryIsLoaded(pEntry))
         {
-            pNext = pEntry->pNext;
-            
-            if ( status.gDlistCount - pEntry->FrameLastUsed > dwFramesToKill && !TCacheEntryIsLoaded(pEntry))
-            {
-                RemoveTexture(pEntry);
-            }
-            pEntry = pNext;
+            RemoveTexture(pEntry);
         }
+        pEntry = pNextYoungest;
     }
     
     
@@ -201,6 +192,17 @@ void CTextureManager::PurgeOldTextures()
             pCurr = pNext;
         }
     }
+
+    if (status.gDlistCount - m_statsLogFrame >= dwFramesToLog)
+    {
+        TextureCacheStats stats;
+        GetCacheStats(&stats);
+
+        DebugMessage(M64MSG_VERBOSE, "Texture cache: %u textures, %u/%u KB, %u hits, %u misses, %u reloads, %u deferred, %u evictions, %u KB uploaded last frame",
+            stats.numTextures, stats.memUsage >> 10, stats.memBudget >> 10, stats.hits, stats.misses,
+            stats.reloads, stats.deferred, stats.evictions, stats.lastFrameUploadBytes >> 10);
+        m_statsLogFrame = status.gDlistCount;
+    }
 }
 
 void CTextureManager::RecycleAllTextures()
@@ -213,6 +215,8 @@ void CTextureManager::RecycleAllTextures()
     
     m_pYoungestTexture          = NULL;
     m_pOldestTexture            = NULL;
+    m_currentTextureMemUsage    = 0;
+    m_numOfTextures             = 0;
 
     for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
     {
@@ -223,9 +227,6 @@ void CTextureManager::RecycleAllTextures()
             
             dwTotalUses += pTVictim->dwUses;
             dwCount++;
-            if (g_bUseSetTextureMem)
-                delete pTVictim;
-            else
             RecycleTexture(pTVictim);
         }
     }
@@ -238,12 +239,9 @@ void CTextureManager::RecheckHiresForAllTextures()
 
     for (uint32_t i = 0; i < m_numOfCachedTxtrList; i++)
     {
-        while (m_pCacheTxtrList[i])
+        for (TxtrCacheEntry *pEntry = m_pCacheTxtrList[i]; pEntry; pEntry = pEntry->pNext)
         {
-            TxtrCacheEntry *pTVictim = m_pCacheTxtrList[i];
-            m_pCacheTxtrList[i] = pTVictim->pNext;
-            pTVictim->bExternalTxtrChecked = false;
-
+            pEntry->bExternalTxtrChecked = false;
         }
     }
 }
@@ -252,9 +250,6 @@ void CTextureManager::RecheckHiresForAllTextures()
 // Add to the recycle list
 void CTextureManager::RecycleTexture(TxtrCacheEntry *pEntry)
 {
-    if (g_bUseSetTextureMem)
-        return;
-
     // Fix me, why I can not reuse the texture in OpenGL,
     // how can I unload texture from video card memory for OpenGL
     delete pEntry;
@@ -263,9 +258,6 @@ void CTextureManager::RecycleTexture(TxtrCacheEntry *pEntry)
 // Search for a texture of the specified dimensions to recycle
 TxtrCacheEntry * CTextureManager::ReviveTexture( uint32_t width, uint32_t height )
 {
-    if (g_bUseSetTextureMem)
-        return NULL;
-
     TxtrCacheEntry* pPrev = NULL;
     TxtrCacheEntry* pCurr = m_pHead;
 
@@ -298,9 +290,6 @@ uint32_t CTextureManager::Hash(uint32_t dwValue)
 
 void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
 {
-    if (!g_bUseSetTextureMem)
-        return;
-
     if (pEntry == m_pYoungestTexture)
         return;
 
@@ -341,6 +330,62 @@ void CTextureManager::MakeTextureYoungest(TxtrCacheEntry *pEntry)
     }
 }
 
+void CTextureManager::RemoveFromAgeList(TxtrCacheEntry *pEntry)
+{
+    if (pEntry == m_pOldestTexture)
+        m_pOldestTexture = pEntry->pNextYoungest;
+    if (pEntry == m_pYoungestTexture)
+        m_pYoungestTexture = pEntry->pLastYoungest;
+
+    if (pEntry->pNextYoungest != NULL)
+        pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
+    if (pEntry->pLastYoungest != NULL)
+        pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
+
+    pEntry->pNextYoungest = NULL;
+    pEntry->pLastYoungest = NULL;
+}
+
+static uint32_t TextureMemSize(CTexture *pTexture)
+{
+    if (pTexture == NULL)
+        return 0;
+
+    return pTexture->m_dwCreatedTextureWidth * pTexture->m_dwCreatedTextureHeight * pTexture->GetPixelSize();
+}
+
+// Count the entry's textures, the enhanced one too, against the budget again
+void CTextureManager::UpdateTextureMemUsage(TxtrCacheEntry *pEntry)
+{
+    uint32_t dwMemSize = TextureMemSize(pEntry->pTexture) + TextureMemSize(pEntry->pEnhancedTexture);
+
+    m_currentTextureMemUsage -= pEntry->dwMemSize;
+    m_currentTextureMemUsage += dwMemSize;
+    pEntry->dwMemSize = dwMemSize;
+}
+
+// Remove the oldest textures until dwMemSize more bytes fit in the budget
+void CTextureManager::MakeRoomForTexture(uint32_t dwMemSize)
+{
+    uint32_t dwBudget = options.textureCacheSize << 20;
+
+    if (dwBudget == 0)
+        return;
+
+    TxtrCacheEntry * pEntry = m_pOldestTexture;
+    while (pEntry && m_currentTextureMemUsage + dwMemSize > dwBudget)
+    {
+        TxtrCacheEntry * pNextYoungest = pEntry->pNextYoungest;
+
+        if (!TCacheEntryIsLoaded(pEntry))
+        {
+            RemoveTexture(pEntry);
+            m_stats.evictions++;
+        }
+        pEntry = pNextYoungest;
+    }
+}
+
 void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
 {   
     uint32_t dwKey = Hash(pEntry->ti.Address);
@@ -353,6 +398,8 @@ void CTextureManager::AddTexture(TxtrCacheEntry *pEntry)
     // Add to head (not tail, for speed - new textures are more likely to be accessed next)
     pEntry->pNext = m_pCacheTxtrList[dwKey];
     m_pCacheTxtrList[dwKey] = pEntry;
+    m_currentTextureMemUsage += pEntry->dwMemSize;
+    m_numOfTextures++;
 
     // Move the texture to the top of the age list
     MakeTextureYoungest(pEntry);
@@ -397,36 +444,18 @@ void CTextureManager::RemoveTexture(TxtrCacheEntry * pEntry)
 
     while (pCurr)
     {
-        // Check that the attributes match
-        if ( pCurr->ti == pEntry->ti )
+        if ( pCurr == pEntry )
         {
             if (pPrev != NULL) 
                 pPrev->pNext = pCurr->pNext;
             else
                m_pCacheTxtrList[dwKey] = pCurr->pNext;
 
-            if (g_bUseSetTextureMem)
-            {
-                // remove the texture from the age list
-                if (pEntry->pNextYoungest != NULL)
-                {
-                    pEntry->pNextYoungest->pLastYoungest = pEntry->pLastYoungest;
-                }
-                if (pEntry->pLastYoungest != NULL)
-                {
-                    pEntry->pLastYoungest->pNextYoungest = pEntry->pNextYoungest;
-                }
-
-                // decrease the mem usage counter
-                m_currentTextureMemUsage -= (pEntry->pTexture->m_dwWidth * pEntry->pTexture->m_dwHeight * 4);
-            
-                delete pEntry;
-            }
-            else
-            {
-                RecycleTexture(pEntry);
-            }
+            RemoveFromAgeList(pEntry);
+            m_currentTextureMemUsage -= pEntry->dwMemSize;
+            m_numOfTextures--;
 
+            RecycleTexture(pEntry);
             break;
         }
 
@@ -439,33 +468,10 @@ TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32_t dwAddr, uint32_t
 {
     TxtrCacheEntry * pEntry = NULL;
 
-    if (g_bUseSetTextureMem)
-    {
-        uint32_t widthToCreate = dwWidth;
-        uint32_t heightToCreate = dwHeight;
-        unsigned int freeUpSize = (widthToCreate * heightToCreate * 4) + g_amountToFree;
-
-        // make sure there is enough room for the new texture by deleting old textures
-        while ((m_currentTextureMemUsage + freeUpSize) > g_maxTextureMemUsage && m_pOldestTexture != NULL)
-        {
-            TxtrCacheEntry *nextYoungest = m_pOldestTexture->pNextYoungest;
-
-            RemoveTexture(m_pOldestTexture);
-
-            m_pOldestTexture = nextYoungest;
-
-        //printf("Freeing Texture\n");
-        }
-
-        m_currentTextureMemUsage += widthToCreate * heightToCreate * 4;
-    }
-    else
-    {
     // Find a used texture
     pEntry = ReviveTexture(dwWidth, dwHeight);
-    }
 
-    if (pEntry == NULL || g_bUseSetTextureMem)
+    if (pEntry == NULL)
     {
         // Couldn't find on - recreate!
         pEntry = new TxtrCacheEntry;
@@ -488,11 +494,16 @@ TxtrCacheEntry * CTextureManager::CreateNewCacheEntry(uint32_t dwAddr, uint32_t
         }
     }
     
+    // Make sure there is enough room for the new texture by deleting old textures
+    uint32_t dwMemSize = TextureMemSize(pEntry->pTexture) + TextureMemSize(pEntry->pEnhancedTexture);
+    MakeRoomForTexture(dwMemSize);
+
     // Initialize
     pEntry->ti.Address = dwAddr;
     pEntry->pNext = NULL;
     pEntry->pNextYoungest = NULL;
     pEntry->pLastYoungest = NULL;
+    pEntry->dwMemSize = dwMemSize;
     pEntry->dwUses = 0;
     pEntry->dwTimeLastUsed = status.gRDPTime;
     pEntry->dwCRC = 0;
@@ -647,6 +658,7 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
             pEntry->lastEntry = g_lastTextureEntry;
             g_lastTextureEntry = pEntry;
             lastEntryModified = false;
+            m_stats.hits++;
 
             DEBUGGER_IF_DUMP((pauseAtNext && loadFromTextureBuffer) ,
             {DebuggerAppendMsg("Load cached texture from render_texture");}
@@ -654,14 +666,35 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
 
             return pEntry;
         }
-        else
+        else if( !loadFromTextureBuffer && pEntry->pTexture != NULL && FrameUploadLimitReached() )
         {
-            //Do something
+            // Too much uploaded this frame already: draw with the old
+            // contents, and leave the CRC as is so that it gets reloaded
+            // on a later frame.
+            pEntry->dwUses++;
+            pEntry->dwTimeLastUsed = status.gRDPTime;
+            pEntry->FrameLastUsed = status.gDlistCount;
+            LOG_TEXTURE(TRACE0("   Use current texture, upload limit reached:\n"));
+            pEntry->lastEntry = g_lastTextureEntry;
+            g_lastTextureEntry = pEntry;
+            lastEntryModified = false;
+            m_stats.deferred++;
+
+            return pEntry;
         }
     }
 
-    if (pEntry == NULL)
+    if (pEntry != NULL)
+    {
+        m_stats.reloads++;
+
+        pEntry->dwTimeLastUsed = status.gRDPTime;
+        pEntry->FrameLastUsed = status.gDlistCount;
+    }
+    else
     {
+        m_stats.misses++;
+
         // We need to create a new entry, and add it
         //  to the hash table.
         pEntry = CreateNewCacheEntry(pgti->Address, pgti->WidthToCreate, pgti->HeightToCreate);
@@ -701,6 +734,8 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
 
        if (dwType != TEXTURE_FMT_UNKNOWN)
        {
+          CountUpload(TextureMemSize(pEntry->pTexture));
+
           if( loadFromTextureBuffer )
           {
              g_pFrameBufferManager->LoadTextureFromRenderTexture(pEntry, txtBufIdxToLoadFrom);
@@ -735,6 +770,8 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
           }
        }
 
+       UpdateTextureMemUsage(pEntry);
+
        pEntry->ti.WidthToLoad = pgti->WidthToLoad;
        pEntry->ti.HeightToLoad = pgti->HeightToLoad;
 
@@ -773,6 +810,50 @@ TxtrCacheEntry * CTextureManager::GetTexture(TxtrInfo * pgti, bool fromTMEM, boo
 
 
 
+void CTextureManager::StartStatsFrame()
+{
+    if (m_statsFrame == status.gDlistCount)
+        return;
+
+    m_stats.lastFrameUploadBytes = m_stats.frameUploadBytes;
+    m_stats.frameUploadBytes = 0;
+    m_statsFrame = status.gDlistCount;
+}
+
+void CTextureManager::CountUpload(uint32_t dwBytes)
+{
+    StartStatsFrame();
+
+    m_stats.uploads++;
+    m_stats.uploadBytes += dwBytes;
+    m_stats.frameUploadBytes += dwBytes;
+}
+
+bool CTextureManager::FrameUploadLimitReached()
+{
+    StartStatsFrame();
+
+    return options.textureUploadLimit != 0 && m_stats.frameUploadBytes >= (options.textureUploadLimit << 10);
+}
+
+void CTextureManager::GetCacheStats(TextureCacheStats *pStats)
+{
+    StartStatsFrame();
+
+    *pStats = m_stats;
+    pStats->frameUploadLimit = options.textureUploadLimit << 10;
+    pStats->numTextures = m_numOfTextures;
+    pStats->memUsage = m_currentTextureMemUsage;
+    pStats->memBudget = options.textureCacheSize << 20;
+}
+
+void CTextureManager::ResetCacheStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_statsFrame = status.gDlistCount;
+}
+
+
 const char *pszImgFormat[8] = {"RGBA", "YUV", "CI", "IA", "I", "?1", "?2", "?3"};
 uint8_t pnImgSize[4]   = {4, 8, 16, 32};
 const char *textlutname[4] = {"RGB16", "I16?", "RGBA16", "IA16"};
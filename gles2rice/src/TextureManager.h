@@ -155,6 +155,7 @@ typedef struct TxtrCacheEntry
     uint32_t  dwTimeLastUsed; // timeGetTime of time of last usage
     uint32_t  FrameLastUsed;  // Frame # that this was last used
     uint32_t  FrameLastUpdated;
+    uint32_t  dwMemSize;      // Bytes counted against the texture budget
 
     CTexture    *pTexture;
     CTexture    *pEnhancedTexture;
@@ -167,6 +168,24 @@ typedef struct TxtrCacheEntry
 } TxtrCacheEntry;
 
 
+// What the texture cache has been doing, for GetCacheStats()
+typedef struct
+{
+    uint32_t  hits;                   // Found in the cache, unchanged
+    uint32_t  misses;                 // Not in the cache
+    uint32_t  reloads;                // In the cache, but changed in RDRAM
+    uint32_t  deferred;               // Changed, but kept for now: upload limit reached
+    uint32_t  evictions;              // Removed to stay within the budget
+    uint32_t  uploads;                // Textures converted and uploaded
+    uint64_t  uploadBytes;
+    uint32_t  frameUploadBytes;       // Uploaded during the current frame
+    uint32_t  lastFrameUploadBytes;   // Uploaded during the previous frame
+    uint32_t  frameUploadLimit;       // 0 for none
+    uint32_t  numTextures;
+    uint32_t  memUsage;
+    uint32_t  memBudget;              // 0 for none
+} TextureCacheStats;
+
 //*****************************************************************************
 // Texture cache implementation
 //*****************************************************************************
@@ -228,11 +247,24 @@ protected:
     TxtrCacheEntry * GetLODFracTexture(uint8_t fac);
     TxtrCacheEntry * GetPrimLODFracTexture(uint8_t fac);
 
+    // Every cached texture is on the age list, from the oldest to the
+    // youngest, so the oldest ones can be removed without a search.
     void MakeTextureYoungest(TxtrCacheEntry *pEntry);
+    void RemoveFromAgeList(TxtrCacheEntry *pEntry);
+    void MakeRoomForTexture(uint32_t dwMemSize);
+    void UpdateTextureMemUsage(TxtrCacheEntry *pEntry);
     unsigned int m_currentTextureMemUsage;
+    uint32_t m_numOfTextures;
     TxtrCacheEntry *m_pYoungestTexture;
     TxtrCacheEntry *m_pOldestTexture;
 
+    void StartStatsFrame();
+    void CountUpload(uint32_t dwBytes);
+    bool FrameUploadLimitReached();
+    TextureCacheStats m_stats;
+    uint32_t m_statsFrame;
+    uint32_t m_statsLogFrame;
+
 public:
     CTextureManager();
     ~CTextureManager();
@@ -243,6 +275,8 @@ public:
     
     void PurgeOldTextures();
     void RecycleAllTextures();
+    void GetCacheStats(TextureCacheStats *pStats);
+    void ResetCacheStats();
     void RecheckHiresForAllTextures();
     bool CleanUp();
     
@@ -118,6 +118,7 @@ typedef struct {
     int     leftRendered,topRendered,rightRendered,bottomRendered;
 
     bool    isMMXSupported;
+    bool    isSSESupported;
 
     bool    isMMXEnabled;
 
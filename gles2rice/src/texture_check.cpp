@@ -0,0 +1,201 @@
+/*
+Copyright (C) 2003 Rice1964
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// rice-texture-check: texture cache eviction order and budget accounting
+//
+// Runs the plugin's CTextureManager with a device builder whose textures
+// only have a size, so no OpenGL context is needed. Each case fills a
+// small budget, then checks which textures are left, and that the age
+// list, the texture count and the bytes in use agree with each other.
+//
+//     rice-texture-check
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DeviceBuilder.h"
+#include "Render.h"
+#include "TextureManager.h"
+#include "Video.h"
+
+class CheckTexture : public CTexture
+{
+public:
+    CheckTexture(uint32_t dwWidth, uint32_t dwHeight) : CTexture(dwWidth, dwHeight, AS_NORMAL)
+    {
+        m_pTexture = NULL;
+        m_dwTextureFmt = TEXTURE_FMT_A8R8G8B8;
+    }
+
+    bool StartUpdate(DrawInfo *di) { return false; }
+    void EndUpdate(DrawInfo *di) {}
+};
+
+class CheckDeviceBuilder : public CDeviceBuilder
+{
+public:
+    CheckDeviceBuilder() { m_pInstance = this; }
+
+    CGraphicsContext * CreateGraphicsContext(void) { return NULL; }
+    CRender * CreateRender(void) { return NULL; }
+    CTexture * CreateTexture(uint32_t dwWidth, uint32_t dwHeight, TextureUsage usage)
+    {
+        return new CheckTexture(dwWidth, dwHeight);
+    }
+    CColorCombiner * CreateColorCombiner(CRender *pRender) { return NULL; }
+    CBlender * CreateAlphaBlender(CRender *pRender) { return NULL; }
+};
+
+// 256x256 at 4 bytes a pixel, four of them fill the 1 MB budget
+enum { TEXTURE_SIZE = 256 };
+
+class CacheCheck : public CTextureManager
+{
+public:
+    TxtrCacheEntry *Create(uint32_t dwAddr)
+    {
+        return CreateNewCacheEntry(dwAddr, TEXTURE_SIZE, TEXTURE_SIZE);
+    }
+
+    // What a lookup that finds the texture does to it
+    void Use(TxtrCacheEntry *pEntry)
+    {
+        pEntry->FrameLastUsed = status.gDlistCount;
+        MakeTextureYoungest(pEntry);
+    }
+
+    void Enhance(TxtrCacheEntry *pEntry, uint32_t dwSize)
+    {
+        pEntry->pEnhancedTexture = new CheckTexture(dwSize, dwSize);
+        UpdateTextureMemUsage(pEntry);
+    }
+
+    void Remove(TxtrCacheEntry *pEntry)
+    {
+        RemoveTexture(pEntry);
+    }
+
+    // The addresses from the oldest to the youngest texture, 0-terminated,
+    // or false if the age list, the count and the bytes don't add up.
+    bool AgeList(uint32_t *addresses, int max)
+    {
+        TxtrCacheEntry *pLast = NULL;
+        uint32_t count = 0, bytes = 0;
+        bool ok = true;
+
+        for (TxtrCacheEntry *pEntry = m_pOldestTexture; pEntry; pEntry = pEntry->pNextYoungest)
+        {
+            if (pEntry->pLastYoungest != pLast || (int)count >= max - 1)
+                return false;
+            addresses[count++] = pEntry->ti.Address;
+            bytes += pEntry->dwMemSize;
+            pLast = pEntry;
+        }
+        addresses[count] = 0;
+
+        if (pLast != m_pYoungestTexture || count != m_numOfTextures || bytes != m_currentTextureMemUsage)
+            ok = false;
+        return ok;
+    }
+};
+
+static int failures = 0;
+
+static void expect(CacheCheck &cache, const char *name, const uint32_t *expected, uint32_t evictions)
+{
+    uint32_t addresses[16];
+    TextureCacheStats stats;
+    bool consistent = cache.AgeList(addresses, 16);
+    int i;
+
+    cache.GetCacheStats(&stats);
+
+    for (i = 0; expected[i] != 0 && addresses[i] == expected[i]; i++)
+        ;
+    bool ok = consistent && expected[i] == 0 && addresses[i] == 0
+        && stats.evictions == evictions && stats.memUsage <= stats.memBudget;
+
+    printf("%-36s %s", name, ok ? "ok" : "FAILED");
+    if (!ok)
+    {
+        printf(" (%s, ages", consistent ? "consistent" : "inconsistent");
+        for (i = 0; consistent && addresses[i] != 0; i++)
+            printf(" %X", addresses[i]);
+        printf(", %u evictions, %u/%u bytes)", stats.evictions, stats.memUsage, stats.memBudget);
+        failures++;
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    CheckDeviceBuilder builder;
+    CacheCheck cache;
+    TxtrCacheEntry *pEntry[8];
+
+    options.textureCacheSize = 1;
+    status.gDlistCount = 1;
+
+    for (int i = 1; i <= 4; i++)
+        pEntry[i] = cache.Create(i << 12);
+    static const uint32_t filled[] = { 0x1000, 0x2000, 0x3000, 0x4000, 0 };
+    expect(cache, "fill the budget", filled, 0);
+
+    // The oldest one that wasn't used since goes first
+    cache.Use(pEntry[1]);
+    pEntry[5] = cache.Create(5 << 12);
+    static const uint32_t used[] = { 0x3000, 0x4000, 0x1000, 0x5000, 0 };
+    expect(cache, "evict the least recently used", used, 1);
+
+    // A texture bound to a tile stays
+    g_textures[0].pTextureEntry = pEntry[3];
+    pEntry[6] = cache.Create(6 << 12);
+    g_textures[0].pTextureEntry = NULL;
+    static const uint32_t bound[] = { 0x3000, 0x1000, 0x5000, 0x6000, 0 };
+    expect(cache, "keep the bound texture", bound, 2);
+
+    // An enhanced texture counts against the budget too, so the next new
+    // texture takes the room of two
+    cache.Use(pEntry[5]);
+    cache.Enhance(pEntry[5], TEXTURE_SIZE);
+    pEntry[7] = cache.Create(7 << 12);
+    static const uint32_t enhanced[] = { 0x6000, 0x5000, 0x7000, 0 };
+    expect(cache, "count the enhanced texture", enhanced, 4);
+
+    // and gives its bytes back when the entry goes
+    cache.Remove(pEntry[5]);
+    static const uint32_t removed[] = { 0x6000, 0x7000, 0 };
+    expect(cache, "free the enhanced texture", removed, 4);
+
+    // Purging takes the textures unused for 5 seconds, not counted as evictions
+    pEntry[1] = cache.Create(1 << 12);
+    pEntry[2] = cache.Create(2 << 12);
+    status.gDlistCount += 200;
+    cache.Use(pEntry[1]);
+    cache.PurgeOldTextures();
+    static const uint32_t purged[] = { 0x1000, 0 };
+    expect(cache, "purge the unused textures", purged, 4);
+
+    cache.RecycleAllTextures();
+    static const uint32_t recycled[] = { 0 };
+    expect(cache, "recycle everything", recycled, 4);
+
+    printf("\n%d failed\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,406 @@
+/*
+Copyright (C) 2003 Rice1964
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// rice-vertex-check: ProcessVertexDataSSE() cross-check and micro-benchmark
+//
+// Every batch is loaded into the RSP state, the matrices, the lights and
+// RDRAM, and run through both ProcessVertexDataSSE() and
+// ProcessVertexDataNoSSE() of the plugin itself, with the vertex arrays
+// filled with the same junk first. Any byte that differs afterwards is
+// reported as a mismatch. Batches come from the rice_vertices.bin files
+// given on the command line, which a RICE_VERTEX_CAPTURE=1 build writes,
+// or else are made up. Then both paths are timed on the same batches, in
+// ns per vertex.
+//
+//     rice-vertex-check [-c batches] [-n iterations] [-s seed] [-v] [capture files...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "Render.h"
+#include "Video.h"
+#include "RenderBase_sse.h"
+
+typedef void (*PVFunc)(uint32_t dwAddr, uint32_t dwV0, uint32_t dwNum);
+
+enum { MISMATCHES_SHOWN = 4 };
+
+typedef struct
+{
+    PVBatchHeader header;
+    FiddledVtx vtx[MAX_VERTS];
+} Batch;
+
+typedef struct
+{
+    VECTOR4 vtxTransformed[MAX_VERTS];
+    VECTOR4 vecProjected[MAX_VERTS];
+    uint32_t dwVtxDifColor[MAX_VERTS];
+    VECTOR2 fVtxTxtCoords[MAX_VERTS];
+    float fFogCoord[MAX_VERTS];
+    uint32_t clipFlag2[MAX_VERTS];
+} Outputs;
+
+static Outputs optimized, reference;
+
+static uint32_t seed = 0x2A2A2A2A;
+
+static uint32_t next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed <<  5;
+    return seed;
+}
+
+// in [-range, range)
+static float random_float(float range)
+{
+    return ((float)(next_random() >> 8) / (float)(1 << 24) * 2 - 1) * range;
+}
+
+// Uniformly random coordinates almost never hit the edges, so a quarter
+// of them are drawn from the interesting values.
+static short random_coordinate(void)
+{
+    static const uint16_t edges[8] = {
+        0x0000, 0x0001, 0xffff, 0x7fff, 0x8000, 0x8001, 0x0100, 0xff00,
+    };
+    const uint32_t r = next_random();
+
+    if ((r & 3) == 0)
+        return (short)edges[(r >> 2) % 8];
+    return (short)(r >> 16);
+}
+
+static void random_matrix(MATRIX *m, float range)
+{
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            m->m[i][j] = random_float(range);
+}
+
+// A projection that puts w on both sides of zero now and then, which is
+// where the fog, clip and alpha tests do something.
+static void random_batch(Batch *batch)
+{
+    PVBatchHeader &h = batch->header;
+
+    memset(batch, 0, sizeof(*batch));
+    h.magic = PV_BATCH_MAGIC;
+    h.dwNum = 1 + next_random() % MAX_VERTS;
+    h.sse_state = next_random() & 0xF;
+    h.numLights = next_random() % 8;
+    h.fFogMin = random_float(1.0f) + 1.0f;
+    h.primitiveColor = next_random();
+    for (int i = 0; i < 3; i++)
+        h.fAmbientLightRGBA[i] = (float)(next_random() & 0xFF);
+
+    random_matrix(&h.worldProject, 1.0f / 512);
+    h.worldProject._44 = random_float(64.0f);
+    switch (next_random() % 4)
+    {
+    case 0:
+        // w == 1, as in an orthographic view
+        h.worldProject._14 = h.worldProject._24 = h.worldProject._34 = 0;
+        h.worldProject._44 = 1;
+        break;
+    case 1:
+        // w == 0 for the vertex at the origin
+        h.worldProject._44 = 0;
+        break;
+    }
+
+    random_matrix(&h.modelViewTop, 1.0f);
+    if ((next_random() % 8) == 0)
+    {
+        // every normal goes to zero
+        h.modelViewTop._11 = h.modelViewTop._21 = h.modelViewTop._31 = 0;
+        h.modelViewTop._12 = h.modelViewTop._22 = h.modelViewTop._32 = 0;
+        h.modelViewTop._13 = h.modelViewTop._23 = h.modelViewTop._33 = 0;
+    }
+
+    for (uint32_t l = 0; l < h.numLights; l++)
+    {
+        h.lights[l].x = random_float(1.0f);
+        h.lights[l].y = random_float(1.0f);
+        h.lights[l].z = random_float(1.0f);
+        h.lights[l].fr = (float)(next_random() & 0xFF);
+        h.lights[l].fg = (float)(next_random() & 0xFF);
+        h.lights[l].fb = (float)(next_random() & 0xFF);
+    }
+
+    for (uint32_t i = 0; i < h.dwNum; i++)
+    {
+        FiddledVtx &v = batch->vtx[i];
+        v.x = random_coordinate();
+        v.y = random_coordinate();
+        v.z = random_coordinate();
+        v.flag = (short)next_random();
+        v.tu = (short)next_random();
+        v.tv = (short)next_random();
+        *(uint32_t *)&v.rgba = next_random();
+    }
+}
+
+static bool read_batch(FILE *f, Batch *batch)
+{
+    if (fread(&batch->header, sizeof(batch->header), 1, f) != 1)
+        return false;
+    if (batch->header.magic != PV_BATCH_MAGIC || batch->header.dwNum > MAX_VERTS
+     || batch->header.numLights > 16)
+        return false;
+    return fread(batch->vtx, sizeof(FiddledVtx), batch->header.dwNum, f) == batch->header.dwNum;
+}
+
+// The vertices go to RDRAM, as the display list would have them.
+static uint8_t rdram[MAX_VERTS * sizeof(FiddledVtx)];
+
+// What ProcessVertexDataSSE() works out sse_state from, set the other way
+// round. No hack, no depth source and no texture generation, which are
+// the cases it leaves to the C code.
+static void load_state(const Batch *batch)
+{
+    const PVBatchHeader &h = batch->header;
+
+    options.enableHackForGames = NO_HACK_FOR_GAME;
+    options.bWinFrameMode = FALSE;
+    g_curRomInfo.bPrimaryDepthHack = FALSE;
+    gRDP.otherMode.depth_source = 0;
+    gRSP.bTextureGen = false;
+    gRSP.ucode = 0;
+
+    gRSP.bLightingEnable = (h.sse_state & PV_SSE_ENABLE_LIGHT) != 0;
+    gRSP.bFogEnabled = (h.sse_state & PV_SSE_ENABLE_FOG) != 0;
+    gRDP.geometryMode = 0;
+    if (h.sse_state & PV_SSE_ENABLE_SHADE)
+        gRDP.geometryMode |= G_SHADE;
+    if (h.sse_state & PV_SSE_FOG_ALPHA)
+        gRDP.geometryMode |= G_FOG;
+
+    gRSPnumLights = h.numLights;
+    memcpy(gRSPlights, h.lights, h.numLights * sizeof(Light));
+    memcpy(gRSP.fAmbientColors, h.fAmbientLightRGBA, sizeof(gRSP.fAmbientColors));
+    gRSPfFogMin = h.fFogMin;
+    gRDP.primitiveColor = h.primitiveColor;
+
+    // UpdateCombinedMatrix() leaves the batch's matrix alone
+    gRSP.bMatrixIsUpdated = false;
+    gRSP.bCombinedMatrixIsUpdated = false;
+    memcpy(&gRSPworldProject, &h.worldProject, sizeof(MATRIX));
+    memcpy(&gRSPmodelViewTop, &h.modelViewTop, sizeof(MATRIX));
+
+    memcpy(rdram, batch->vtx, h.dwNum * sizeof(FiddledVtx));
+}
+
+static void run(PVFunc func, const Batch *batch)
+{
+    load_state(batch);
+    func(0, 0, batch->header.dwNum);
+}
+
+// g_clipFlag and g_vtxNonTransformed are left out, the SSE path doesn't
+// write them and nothing reads them after the batch.
+static void fill_outputs(void)
+{
+    memset(g_vtxTransformed, 0xA5, sizeof(g_vtxTransformed));
+    memset(g_vecProjected, 0xA5, sizeof(g_vecProjected));
+    memset(g_dwVtxDifColor, 0xA5, sizeof(g_dwVtxDifColor));
+    memset(g_fVtxTxtCoords, 0xA5, sizeof(g_fVtxTxtCoords));
+    memset(g_fFogCoord, 0xA5, sizeof(g_fFogCoord));
+    memset(g_clipFlag2, 0xA5, sizeof(g_clipFlag2));
+}
+
+static void save_outputs(Outputs *out)
+{
+    memcpy(out->vtxTransformed, g_vtxTransformed, sizeof(out->vtxTransformed));
+    memcpy(out->vecProjected, g_vecProjected, sizeof(out->vecProjected));
+    memcpy(out->dwVtxDifColor, g_dwVtxDifColor, sizeof(out->dwVtxDifColor));
+    memcpy(out->fVtxTxtCoords, g_fVtxTxtCoords, sizeof(out->fVtxTxtCoords));
+    memcpy(out->fFogCoord, g_fFogCoord, sizeof(out->fFogCoord));
+    memcpy(out->clipFlag2, g_clipFlag2, sizeof(out->clipFlag2));
+}
+
+static void print_mismatch(const char *name, const void *got, const void *ref, size_t size, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const unsigned char *g = (const unsigned char *)got + i * size;
+        const unsigned char *r = (const unsigned char *)ref + i * size;
+
+        if (memcmp(g, r, size) == 0)
+            continue;
+
+        printf("    %s[%u]:", name, (unsigned)i);
+        for (size_t k = 0; k < size; k += 4)
+            printf(" %08X", *(const uint32_t *)(g + k));
+        printf("  (reference");
+        for (size_t k = 0; k < size; k += 4)
+            printf(" %08X", *(const uint32_t *)(r + k));
+        printf(")\n");
+    }
+}
+
+// Both sides start from the same junk, so a value one of them forgets to
+// write or writes past the end is a mismatch too.
+static bool check_batch(const Batch *batch, bool show)
+{
+    fill_outputs();
+    run(ProcessVertexDataSSE, batch);
+    save_outputs(&optimized);
+
+    fill_outputs();
+    run(ProcessVertexDataNoSSE, batch);
+    save_outputs(&reference);
+
+    if (memcmp(&optimized, &reference, sizeof(optimized)) == 0)
+        return true;
+
+    if (show)
+    {
+        const PVBatchHeader &h = batch->header;
+
+        printf("  state=%X lights=%u count=%u:\n", h.sse_state, h.numLights, h.dwNum);
+        print_mismatch("transformed", optimized.vtxTransformed, reference.vtxTransformed, sizeof(VECTOR4), MAX_VERTS);
+        print_mismatch("projected", optimized.vecProjected, reference.vecProjected, sizeof(VECTOR4), MAX_VERTS);
+        print_mismatch("color", optimized.dwVtxDifColor, reference.dwVtxDifColor, sizeof(uint32_t), MAX_VERTS);
+        print_mismatch("texcoord", optimized.fVtxTxtCoords, reference.fVtxTxtCoords, sizeof(VECTOR2), MAX_VERTS);
+        print_mismatch("fog", optimized.fFogCoord, reference.fFogCoord, sizeof(float), MAX_VERTS);
+        print_mismatch("clip", optimized.clipFlag2, reference.clipFlag2, sizeof(uint32_t), MAX_VERTS);
+    }
+    return false;
+}
+
+// Loading the state is timed too, the same for both.
+static double time_batches(PVFunc func, const std::vector<Batch> &batches, long iterations)
+{
+    unsigned long vertices = 0;
+    clock_t t1, t2;
+
+    for (size_t i = 0; i < batches.size(); i++)
+        run(func, &batches[i]);
+
+    t1 = clock();
+    for (long n = 0; n < iterations; n++)
+    {
+        const Batch &batch = batches[n % batches.size()];
+        run(func, &batch);
+        vertices += batch.header.dwNum;
+    }
+    t2 = clock();
+
+    return (double)(t2 - t1) * 1e9 / CLOCKS_PER_SEC / (double)vertices;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "Usage: %s [-c batches] [-n iterations] [-s seed] [-v] [capture files...]\n"
+        "  -c  random batches cross-checked without capture files (default 100000)\n"
+        "  -n  batches timed per build (default 200000)\n"
+        "  -s  random seed (default 0x2A2A2A2A)\n"
+        "  -v  print every mismatch instead of the first few\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    long checks = 100000;
+    long iterations = 200000;
+    bool verbose = false;
+    std::vector<const char *> files;
+    std::vector<Batch> batches;
+    long mismatches = 0, checked = 0;
+
+    gfx_info.RDRAM = rdram;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            checks = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            iterations = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-v") == 0)
+            verbose = true;
+        else if (argv[i][0] == '-')
+            usage(argv[0]);
+        else
+            files.push_back(argv[i]);
+    }
+    if (seed == 0)
+        seed = 1; // xorshift never leaves zero
+    if (checks <= 0 || iterations <= 0)
+        usage(argv[0]);
+
+    Batch batch;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        FILE *f = fopen(files[i], "rb");
+        if (f == NULL)
+        {
+            fprintf(stderr, "Couldn't open %s\n", files[i]);
+            return 2;
+        }
+        while (read_batch(f, &batch))
+        {
+            if (!check_batch(&batch, verbose || mismatches < MISMATCHES_SHOWN))
+                mismatches++;
+            checked++;
+            if (batches.size() < 4096)
+                batches.push_back(batch);
+        }
+        fclose(f);
+    }
+
+    if (files.empty())
+    {
+        for (long i = 0; i < checks; i++)
+        {
+            random_batch(&batch);
+            if (!check_batch(&batch, verbose || mismatches < MISMATCHES_SHOWN))
+                mismatches++;
+            checked++;
+            if (batches.size() < 256)
+                batches.push_back(batch);
+        }
+    }
+
+    if (batches.empty())
+    {
+        fprintf(stderr, "No vertex batches in the capture files\n");
+        return 2;
+    }
+
+    double sse = time_batches(ProcessVertexDataSSE, batches, iterations);
+    double scalar = time_batches(ProcessVertexDataNoSSE, batches, iterations);
+
+    printf("Rice vertices: SSE2 against the C code\n");
+    printf("%ld %s batches checked, %ld timed per build\n\n", checked,
+            files.empty() ? "random" : "captured", iterations);
+    printf("SSE2 ns/vertex  C ns/vertex  speed-up  mismatches\n");
+    printf("%14.2f %12.2f %8.2fx %11ld\n", sse, scalar,
+            sse > 0 ? scalar / sse : 0.0, mismatches);
+    return mismatches != 0;
+}
@@ -0,0 +1,545 @@
+/* Headless benchmark frontend for the mupen64plus libretro core.
+ *
+ * Loads a ROM and an optional recorded input file, runs a fixed number of
+ * frames with the angrylion software renderer and a null audio sink, and
+ * prints per-frame wall time, emulated cycles per second and a per-subsystem
+ * time breakdown. Build with "make bench".
+ *
+ * Input file format: for every frame, 4 ports of 5 little-endian int16
+ * values (joypad button mask using RETRO_DEVICE_ID_JOYPAD_* bits, left
+ * analog x/y, right analog x/y). When the file runs out, all inputs are
+ * released.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "api/libretro.h"
+#include "main/profile.h"
+#include "main/savestates.h"
+#include "r4300/cp0.h"
+
+#ifndef PROFILE
+#error "bench must be built with PROFILE defined (use make bench)"
+#endif
+
+#define BENCH_PORTS 4
+#define BENCH_INPUT_VALUES 5
+/* with -s delta, every this many frames a delta is kept, to be loaded again
+ * after the run, latest first, as rewind would */
+#define BENCH_KEEP_EVERY 20
+
+struct bench_kept_state
+{
+   unsigned char *data;
+   size_t size;
+   uint32_t hash;                /* bench_state_hash() right after */
+};
+
+struct bench_variable
+{
+   const char *key;
+   const char *value;
+};
+
+static struct bench_variable bench_variables[] = {
+   { "mupen64-cpucore",           "dynamic_recompiler" },
+   { "mupen64-rspplugin",         "hle" },
+   { "mupen64-gfxplugin",         "angrylion" },
+   { "mupen64-angrylion-vioverlay", "disabled" },
+   { "mupen64-angrylion-multithread", "1" },
+   { "mupen64-framerate",         "original" },
+   { "mupen64-savestate-delta",   "disabled" },
+   { "mupen64-pak1",              "none" },
+   { "mupen64-pak2",              "none" },
+   { "mupen64-pak3",              "none" },
+   { "mupen64-pak4",              "none" },
+   { NULL, NULL },
+};
+
+static int bench_verbose;
+static int16_t *input_data;
+static size_t input_frames;
+static size_t current_frame;
+static unsigned frames_pushed;
+static uint32_t video_hash = 2166136261u;
+static size_t audio_frames;
+
+static const char *section_names[NUM_TIMED_SECTIONS] = {
+   "all", "rsp-gfx", "rsp-audio", "compiler", "idle", "rdp", "vi", "ai"
+};
+
+static long long int get_time_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (long long int)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static retro_time_t bench_get_time_usec(void)
+{
+   return get_time_ns() / 1000;
+}
+
+static retro_perf_tick_t bench_get_perf_counter(void)
+{
+   return get_time_ns();
+}
+
+/* keep the scalar paths so runs are comparable across hosts */
+static uint64_t bench_get_cpu_features(void)
+{
+   return 0;
+}
+
+static void bench_log(enum retro_log_level level, const char *fmt, ...)
+{
+   va_list ap;
+
+   if (!bench_verbose && level < RETRO_LOG_ERROR)
+      return;
+
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static void bench_set_variable(const char *key, const char *value)
+{
+   struct bench_variable *var;
+
+   for (var = bench_variables; var->key; ++var)
+   {
+      if (!strcmp(var->key, key))
+      {
+         var->value = value;
+         return;
+      }
+   }
+}
+
+static bool bench_environment(unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+      {
+         struct retro_variable *var = (struct retro_variable*)data;
+         struct bench_variable *it;
+
+         var->value = NULL;
+         for (it = bench_variables; it->key; ++it)
+         {
+            if (!strcmp(it->key, var->key))
+            {
+               var->value = it->value;
+               return true;
+            }
+         }
+         return false;
+      }
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         ((struct retro_log_callback*)data)->log = bench_log;
+         return true;
+      case RETRO_ENVIRONMENT_GET_PERF_INTERFACE:
+      {
+         struct retro_perf_callback *perf = (struct retro_perf_callback*)data;
+
+         memset(perf, 0, sizeof(*perf));
+         perf->get_time_usec = bench_get_time_usec;
+         perf->get_cpu_features = bench_get_cpu_features;
+         perf->get_perf_counter = bench_get_perf_counter;
+         return true;
+      }
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         *(const char**)data = ".";
+         return true;
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+      case RETRO_ENVIRONMENT_SET_VARIABLES:
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         *(bool*)data = false;
+         return true;
+      default:
+         return false;
+   }
+}
+
+static void bench_video_refresh(const void *data, unsigned width, unsigned height, size_t pitch)
+{
+   unsigned x, y;
+
+   frames_pushed++;
+   if (!data || data == RETRO_HW_FRAME_BUFFER_VALID)
+      return;
+
+   /* FNV-1a over every frame, to check renderer changes for exact output */
+   for (y = 0; y < height; ++y)
+   {
+      const uint32_t *line = (const uint32_t*)((const uint8_t*)data + y * pitch);
+
+      for (x = 0; x < width; ++x)
+      {
+         video_hash ^= line[x];
+         video_hash *= 16777619u;
+      }
+   }
+}
+
+static size_t bench_audio_batch(const int16_t *data, size_t frames)
+{
+   audio_frames += frames;
+   return frames;
+}
+
+static void bench_input_poll(void)
+{
+}
+
+static int16_t bench_input_state(unsigned port, unsigned device, unsigned index, unsigned id)
+{
+   const int16_t *values;
+
+   if (port >= BENCH_PORTS || current_frame >= input_frames)
+      return 0;
+
+   values = &input_data[(current_frame * BENCH_PORTS + port) * BENCH_INPUT_VALUES];
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         return (values[0] >> id) & 1;
+      case RETRO_DEVICE_ANALOG:
+         if (index > RETRO_DEVICE_INDEX_ANALOG_RIGHT || id > RETRO_DEVICE_ID_ANALOG_Y)
+            return 0;
+         return values[1 + index * 2 + id];
+      default:
+         return 0;
+   }
+}
+
+static void *read_file(const char *path, size_t *size)
+{
+   FILE *f = fopen(path, "rb");
+   void *data;
+   long len;
+
+   if (!f)
+      return NULL;
+
+   fseek(f, 0, SEEK_END);
+   len = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   data = malloc(len > 0 ? len : 1);
+   if (data && fread(data, 1, len, f) != (size_t)len)
+   {
+      free(data);
+      data = NULL;
+   }
+
+   fclose(f);
+   *size = len;
+   return data;
+}
+
+static int load_input(const char *path)
+{
+   size_t size, i, count;
+   uint8_t *raw = (uint8_t*)read_file(path, &size);
+
+   if (!raw)
+      return 0;
+
+   input_frames = size / (BENCH_PORTS * BENCH_INPUT_VALUES * 2);
+   count = input_frames * BENCH_PORTS * BENCH_INPUT_VALUES;
+   input_data = (int16_t*)malloc((count ? count : 1) * sizeof(int16_t));
+
+   /* stored little-endian regardless of host */
+   for (i = 0; i < count; ++i)
+      input_data[i] = (int16_t)(raw[2*i] | (raw[2*i+1] << 8));
+
+   free(raw);
+   return 1;
+}
+
+/* FNV-1a of a full savestate of the current state */
+static uint32_t bench_state_hash(unsigned char *buffer, size_t size)
+{
+   uint32_t hash = 2166136261u;
+   size_t i;
+
+   memset(buffer, 0, size);
+   if (!savestates_save_m64p(buffer, size))
+      return 0;
+   for (i = 0; i < size; ++i)
+   {
+      hash ^= buffer[i];
+      hash *= 16777619u;
+   }
+   return hash;
+}
+
+static void usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [options] rom\n"
+         "  -n frames   number of frames to run (default 600)\n"
+         "  -i file     recorded input file\n"
+         "  -c core     CPU core: dynamic_recompiler|cached_interpreter|pure_interpreter\n"
+         "  -r rsp      RSP plugin: hle|cxd4\n"
+         "  -t threads  angrylion render threads\n"
+         "  -o          run the angrylion VI filters (VI overlay)\n"
+         "  -s mode     savestate after every frame: full|delta\n"
+         "  -q          only print the summary\n"
+         "  -v          show core log messages\n",
+         argv0);
+}
+
+int main(int argc, char **argv)
+{
+   struct retro_game_info game;
+   long long int sections[NUM_TIMED_SECTIONS];
+   long long int totals[NUM_TIMED_SECTIONS];
+   long long int total_time = 0;
+   uint64_t total_cycles = 0;
+   unsigned frames = 600;
+   int quiet = 0;
+   int snapshots = 0;
+   int delta_snapshots = 0;
+   unsigned char *state = NULL;
+   size_t state_capacity = 0;
+   long long int state_time = 0;
+   uint64_t state_bytes = 0;
+   struct bench_kept_state *kept = NULL;
+   unsigned kept_count = 0, kept_matched = 0, kept_lost = 0;
+   const char *rom_path = NULL;
+   const char *input_path = NULL;
+   size_t rom_size;
+   void *rom;
+   unsigned i;
+   int arg;
+
+   for (arg = 1; arg < argc; ++arg)
+   {
+      if (!strcmp(argv[arg], "-n") && arg + 1 < argc)
+         frames = strtoul(argv[++arg], NULL, 0);
+      else if (!strcmp(argv[arg], "-i") && arg + 1 < argc)
+         input_path = argv[++arg];
+      else if (!strcmp(argv[arg], "-c") && arg + 1 < argc)
+         bench_set_variable("mupen64-cpucore", argv[++arg]);
+      else if (!strcmp(argv[arg], "-r") && arg + 1 < argc)
+         bench_set_variable("mupen64-rspplugin", argv[++arg]);
+      else if (!strcmp(argv[arg], "-t") && arg + 1 < argc)
+         bench_set_variable("mupen64-angrylion-multithread", argv[++arg]);
+      else if (!strcmp(argv[arg], "-o"))
+         bench_set_variable("mupen64-angrylion-vioverlay", "enabled");
+      else if (!strcmp(argv[arg], "-s") && arg + 1 < argc)
+      {
+         const char *mode = argv[++arg];
+
+         if (strcmp(mode, "full") && strcmp(mode, "delta"))
+         {
+            usage(argv[0]);
+            return 1;
+         }
+
+         snapshots = 1;
+         delta_snapshots = !strcmp(mode, "delta");
+         bench_set_variable("mupen64-savestate-delta",
+               delta_snapshots ? "enabled" : "disabled");
+      }
+      else if (!strcmp(argv[arg], "-q"))
+         quiet = 1;
+      else if (!strcmp(argv[arg], "-v"))
+         bench_verbose = 1;
+      else if (argv[arg][0] != '-' && !rom_path)
+         rom_path = argv[arg];
+      else
+      {
+         usage(argv[0]);
+         return 1;
+      }
+   }
+
+   if (!rom_path)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   if (delta_snapshots)
+   {
+      kept = (struct bench_kept_state*)calloc(frames / BENCH_KEEP_EVERY + 1, sizeof(*kept));
+      if (!kept)
+         return 1;
+   }
+
+   rom = read_file(rom_path, &rom_size);
+   if (!rom)
+   {
+      fprintf(stderr, "Couldn't read ROM %s\n", rom_path);
+      return 1;
+   }
+
+   if (input_path && !load_input(input_path))
+   {
+      fprintf(stderr, "Couldn't read input file %s\n", input_path);
+      return 1;
+   }
+
+   retro_set_environment(bench_environment);
+   retro_set_video_refresh(bench_video_refresh);
+   retro_set_audio_sample_batch(bench_audio_batch);
+   retro_set_input_poll(bench_input_poll);
+   retro_set_input_state(bench_input_state);
+   retro_init();
+
+   memset(&game, 0, sizeof(game));
+   game.path = rom_path;
+   game.data = rom;
+   game.size = rom_size;
+
+   if (!retro_load_game(&game))
+   {
+      fprintf(stderr, "Couldn't load ROM %s\n", rom_path);
+      return 1;
+   }
+
+   /* first run finishes the plugin setup, don't count it */
+   retro_run();
+   timed_sections_collect(sections);
+   memset(totals, 0, sizeof(totals));
+
+   if (!quiet)
+      printf("frame,wall_us,cycles,rsp_gfx_us,rsp_audio_us,rdp_us,vi_us,ai_us,r4300_us\n");
+
+   for (current_frame = 0; current_frame < frames; ++current_frame)
+   {
+      uint32_t count_start = r4300_cp0_regs()[CP0_COUNT_REG];
+      long long int start = get_time_ns();
+      long long int elapsed, others;
+      uint32_t cycles;
+
+      retro_run();
+
+      elapsed = get_time_ns() - start;
+      /* CP0 Count advances once every two PClock cycles */
+      cycles = (r4300_cp0_regs()[CP0_COUNT_REG] - count_start) * 2;
+      timed_sections_collect(sections);
+
+      others = 0;
+      for (i = TIMED_SECTION_GFX; i < NUM_TIMED_SECTIONS; ++i)
+      {
+         if (i == TIMED_SECTION_COMPILER || i == TIMED_SECTION_IDLE)
+            continue;
+         totals[i] += sections[i];
+         others += sections[i];
+      }
+      totals[TIMED_SECTION_ALL] += elapsed;
+      total_time += elapsed;
+      total_cycles += cycles;
+
+      if (snapshots)
+      {
+         long long int state_start = get_time_ns();
+         size_t size = retro_serialize_size();
+         /* what a frontend keeping deltas would keep of the buffer */
+         size_t used = delta_snapshots ? savestates_delta_size_m64p() : size;
+
+         if (size > state_capacity)
+         {
+            free(state);
+            state = (unsigned char*)malloc(size);
+            state_capacity = size;
+         }
+         if (!state || !retro_serialize(state, size))
+         {
+            fprintf(stderr, "Savestate failed at frame %u\n", (unsigned)current_frame);
+            return 1;
+         }
+         state_time += get_time_ns() - state_start;
+         state_bytes += used;
+
+         if (delta_snapshots && current_frame % BENCH_KEEP_EVERY == BENCH_KEEP_EVERY - 1)
+         {
+            struct bench_kept_state *keep = &kept[kept_count++];
+
+            keep->data = (unsigned char*)malloc(used);
+            keep->size = used;
+            if (!keep->data)
+            {
+               fprintf(stderr, "Out of memory at frame %u\n", (unsigned)current_frame);
+               return 1;
+            }
+            memcpy(keep->data, state, used);
+            keep->hash = bench_state_hash(state, size);
+         }
+      }
+
+      if (!quiet)
+         printf("%u,%lld,%u,%lld,%lld,%lld,%lld,%lld,%lld\n",
+               (unsigned)current_frame, elapsed / 1000, cycles,
+               sections[TIMED_SECTION_GFX] / 1000,
+               sections[TIMED_SECTION_AUDIO] / 1000,
+               sections[TIMED_SECTION_RDP] / 1000,
+               sections[TIMED_SECTION_VI] / 1000,
+               sections[TIMED_SECTION_AI] / 1000,
+               (elapsed - others) / 1000);
+   }
+
+   /* A delta loads if its keyframe is still kept, and must then give back
+    * exactly the state it was taken from. */
+   for (i = kept_count; i-- > 0;)
+   {
+      if (!retro_unserialize(kept[i].data, kept[i].size))
+         kept_lost++;
+      else if (bench_state_hash(state, state_capacity) == kept[i].hash)
+         kept_matched++;
+      free(kept[i].data);
+   }
+
+   retro_unload_game();
+   retro_deinit();
+
+   fprintf(stderr, "frames:         %u (%u pushed, %lu audio frames)\n",
+         frames, frames_pushed, (unsigned long)audio_frames);
+   fprintf(stderr, "video hash:     %08x\n", (unsigned)video_hash);
+   if (frames && total_time)
+   {
+      long long int others = 0;
+
+      fprintf(stderr, "wall time:      %.3f ms (%.3f ms/frame, %.2f fps)\n",
+            total_time / 1e6, total_time / 1e6 / frames, frames * 1e9 / total_time);
+      fprintf(stderr, "emulated:       %.2f Mcycles/s\n",
+            total_cycles * 1e3 / total_time);
+
+      for (i = TIMED_SECTION_GFX; i < NUM_TIMED_SECTIONS; ++i)
+      {
+         if (i == TIMED_SECTION_COMPILER || i == TIMED_SECTION_IDLE)
+            continue;
+         others += totals[i];
+         fprintf(stderr, "%-15s %6.2f%% (%.3f ms)\n", section_names[i],
+               100.0 * totals[i] / total_time, totals[i] / 1e6);
+      }
+      fprintf(stderr, "%-15s %6.2f%% (%.3f ms)\n", "r4300",
+            100.0 * (total_time - others) / total_time, (total_time - others) / 1e6);
+      if (snapshots)
+         fprintf(stderr, "savestates:     %.1f KB, %.3f ms per frame (not in wall time)\n",
+               state_bytes / 1024.0 / frames, state_time / 1e6 / frames);
+      if (kept_count)
+         fprintf(stderr, "reloaded:       %u of %u kept deltas match, %u lost their keyframe\n",
+               kept_matched, kept_count, kept_lost);
+   }
+
+   free(rom);
+   free(input_data);
+   free(state);
+   free(kept);
+   return (kept_matched + kept_lost == kept_count) ? 0 : 1;
+}
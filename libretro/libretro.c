@@ -64,6 +64,7 @@ uint32_t screen_height;
 uint32_t screen_pitch;
 
 static bool first_context_reset;
+static bool delta_savestates;
 
 extern unsigned int VI_REFRESH;
 
@@ -231,10 +232,17 @@ static void setup_variables(void)
       { "mupen64-angrylion-vioverlay",
        "(Angrylion) VI Overlay; disabled|enabled"
       },
+#if !defined(SINGLE_THREAD) && !defined(_MSC_VER) /* HAVE_RDP_THREADS */
+      { "mupen64-angrylion-multithread",
+       "(Angrylion) Render Threads (restart); 1|2|3|4|6|8|12|16"
+      },
+#endif
       { "mupen64-virefresh",
          "VI Refresh (Overclock); 1500|2200" },
       { "mupen64-framerate",
          "Framerate (restart); original|fullspeed" },
+      { "mupen64-savestate-delta",
+         "Delta Savestates; disabled|enabled" },
       { NULL, NULL },
    };
 
@@ -524,6 +532,16 @@ void update_variables(bool startup)
    else
       overlay = 1;
 
+#ifdef HAVE_RDP_THREADS
+   var.key = "mupen64-angrylion-multithread";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      render_threads = atoi(var.value);
+   else
+#endif
+      render_threads = 1;
+
    CFG_HLE_GFX = (gfx_plugin != GFX_ANGRYLION) ? 1 : 0;
    CFG_HLE_AUD = 0; /* There is no HLE audio code in libretro audio plugin. */
 
@@ -601,6 +619,15 @@ void update_variables(bool startup)
          VI_REFRESH = 2200;
    }
 
+   var.key = "mupen64-savestate-delta";
+   var.value = NULL;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      delta_savestates = !strcmp(var.value, "enabled");
+   else
+      delta_savestates = false;
+   savestates_set_delta_m64p(delta_savestates);
+
    var.key = "mupen64-framerate";
    var.value = NULL;
 
@@ -810,13 +837,18 @@ size_t retro_get_memory_size(unsigned type)
 
 
 
+/* Frontends size their buffers once, so this is the full size even with
+ * delta savestates, which only fill the start of the buffer. */
 size_t retro_serialize_size (void)
 {
-    return 16788288 + 1024; // < 16MB and some change... ouch
+    return savestates_size_m64p();
 }
 
 bool retro_serialize(void *data, size_t size)
 {
+    if (delta_savestates)
+        return savestates_save_delta_m64p(data, size) != 0;
+
     if (savestates_save_m64p(data, size))
         return true;
 
@@ -22,6 +22,7 @@
 #include "ai_controller.h"
 
 #include "api/audio_backend.h"
+#include "main/profile.h"
 #include "main/rom.h"
 #include "memory/memory.h"
 #include "r4300/r4300_core.h"
@@ -98,8 +99,10 @@ static void do_dma(struct ai_controller* ai, const struct ai_dma* dma)
    }
 
    /* push audio samples to audio backend */
+   timed_section_start(TIMED_SECTION_AI);
    push_audio_samples(&ai->backend,
          &ai->ri->rdram.dram[dma->address/4], dma->length);
+   timed_section_end(TIMED_SECTION_AI);
 
    /* schedule end of dma event */
    update_count();
@@ -255,7 +255,7 @@ EXPORT m64p_error CALL CoreCheatClearAll(void)
 
 EXPORT m64p_error CALL CoreGetRomSettings(m64p_rom_settings *RomSettings, int RomSettingsLength, int Crc1, int Crc2)
 {
-    romdatabase_entry* entry;
+    const romdatabase_entry* entry;
     int i;
 
     if (!l_CoreInit)
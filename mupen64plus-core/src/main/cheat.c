@@ -52,98 +52,94 @@ typedef struct cheat
 {
     char *name;
     int enabled;
-    int was_enabled;
     struct list_head cheat_codes;
     struct list_head list;
 } cheat_t;
 
-/* Local variables */
-static LIST_HEAD(active_cheats);
-extern unsigned int frame_dupe;
-
-/* Private functions */
-static unsigned short read_address_16bit(unsigned int address)
+/* Cheats are compiled into one flat array of these per entry point, so
+ * that applying them is a single loop without any decoding. */
+enum cheat_op_type
 {
-    return *(unsigned short *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S16)));
-}
-
-static unsigned char read_address_8bit(unsigned int address)
+    CHEAT_OP_WRITE8,
+    CHEAT_OP_WRITE16,
+    /* the conditionals skip the next 'guarded' ops when false */
+    CHEAT_OP_IF_EQUAL8,
+    CHEAT_OP_IF_EQUAL16,
+    CHEAT_OP_IF_NOT_EQUAL8,
+    CHEAT_OP_IF_NOT_EQUAL16,
+    CHEAT_OP_IF_TRUE,
+    /* put back the old value of a disabled cheat, if there is one */
+    CHEAT_OP_RESTORE8,
+    CHEAT_OP_RESTORE16
+};
+
+/* op only runs while the GameShark button is held */
+#define CHEAT_OP_GAMESHARK 1
+
+typedef struct cheat_op
 {
-    return *(unsigned char *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S8)));
-}
-
-static void update_address_16bit(unsigned int address, unsigned short new_value)
+    unsigned int offset; /* into g_rdram, already swizzled */
+    unsigned short value;
+    unsigned char type;
+    unsigned char flags;
+    unsigned int guarded;
+    int *old_value;      /* saved before the first write, or NULL */
+} cheat_op_t;
+
+typedef struct cheat_program
 {
-    *(unsigned short *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S16))) = new_value;
-}
-
-static void update_address_8bit(unsigned int address, unsigned char new_value)
+    cheat_op_t *ops;
+    size_t count;
+    size_t size;
+} cheat_program_t;
+
+/* Built-in fixes, picked from the ROM header when the game starts. The
+ * entries for a game with specific CRCs come before its catch-all. */
+typedef struct game_fix
 {
-     *(unsigned char *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S8))) = new_value;
-}
+    const char *name;
+    unsigned int crc1;
+    unsigned int crc2;
+    int on_frame_dupe;
+    unsigned int address;
+    unsigned short value;
+} game_fix_t;
 
-static int address_equal_to_8bit(unsigned int address, unsigned char value)
+static const game_fix_t game_fixes[] =
 {
-    unsigned char value_read;
-    value_read = *(unsigned char *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S8)));
-    return value_read == value;
-}
+    /* Zelda OOT subscreen delay fix */
+    { "THE LEGEND OF ZELDA", 0xEC7011B7, 0x7616D72B, 0, 0x801DA5CB, 0x0002 }, /* Ocarina of Time (U) + (J) (V1.0) */
+    { "THE LEGEND OF ZELDA", 0xD43DA81F, 0x021E1E19, 0, 0x801DA78B, 0x0002 }, /* Ocarina of Time (U) + (J) (V1.1) */
+    { "THE LEGEND OF ZELDA", 0x693BA2AE, 0xB7F14E9F, 0, 0x801DAE8B, 0x0002 }, /* Ocarina of Time (U) + (J) (V1.2) */
+    { "THE LEGEND OF ZELDA", 0xB044B569, 0x373C1985, 0, 0x801D860B, 0x0002 }, /* Ocarina of Time (E) (V1.0) */
+    { "THE LEGEND OF ZELDA", 0xB2055FBD, 0x0BAB4E0C, 0, 0x801D864B, 0x0002 }, /* Ocarina of Time (E) (V1.1) */
+    { "THE LEGEND OF ZELDA", 0xF034001A, 0xAE47ED06, 0, 0x801DB74B, 0x0002 }, /* Ocarina of Time - Master Quest (U) (GC) */
+    { "THE LEGEND OF ZELDA", 0x1D4136F3, 0xAF63EEA9, 0, 0x801D8F4B, 0x0002 }, /* Ocarina of Time - Master Quest (E) (GC) */
+    { "THE LEGEND OF ZELDA", 0x917D18F6, 0x69BC5453, 0, 0x8022414B, 0x0002 }, /* Ocarina of Time - Master Quest (U) (Debug Version) */
+
+    /* Pokemon Snap controller fix. The D1 check that used to come
+     * before each of these never gated the write, so it is left out. */
+    { "POKEMON SNAP", 0xCA12B547, 0x71FA4EE4, 1, 0x80382D0F, 0x0000 }, /* (U) */
+    { "POKEMON SNAP", 0x7BB18D40, 0x83138559, 1, 0x80382D0F, 0x0000 }, /* (A) */
+    { "POKEMON SNAP", 0x39119872, 0x07722E9F, 1, 0x80382D0F, 0x0000 }, /* Station (U) */
+    { "POKEMON SNAP", 0xEC0F690D, 0x32A7438C, 1, 0x8036D21F, 0x0000 }, /* (J) (V1.0) */
+    { "POKEMON SNAP", 0xE0044E9E, 0xCD659D0D, 1, 0x8036D21F, 0x0000 }, /* (J) (V1.1) */
+    { "POKEMON SNAP", 0x5753720D, 0x2A8A884D, 1, 0x80381BCF, 0x0000 }, /* (G) */
+    { "POKEMON SNAP", 0,          0,          1, 0x80381BEF, 0x0000 }, /* (E) + (F) + (I) + (S) */
+};
 
-static int address_equal_to_16bit(unsigned int address, unsigned short value)
-{
-    unsigned short value_read;
-    value_read = *(unsigned short *)(((unsigned char*)g_rdram + ((address & 0xFFFFFF)^S16)));
-    return value_read == value;
-}
+/* Local variables */
+static LIST_HEAD(active_cheats);
+extern unsigned int frame_dupe;
 
-// individual application - returns 0 if we are supposed to skip the next cheat
-// (only really used on conditional codes)
-static int execute_cheat(unsigned int address, unsigned short value, int *old_value)
-{
-   switch (address & 0xFF000000)
-   {
-      case 0x80000000:
-      case 0x88000000:
-      case 0xA0000000:
-      case 0xA8000000:
-      case 0xF0000000:
-         // if pointer to old value is valid and uninitialized, write current value to it
-         if(old_value && (*old_value == CHEAT_CODE_MAGIC_VALUE))
-            *old_value = (int) read_address_8bit(address);
-         update_address_8bit(address,(unsigned char) value);
-         return 1;
-      case 0x81000000:
-      case 0x89000000:
-      case 0xA1000000:
-      case 0xA9000000:
-      case 0xF1000000:
-         // if pointer to old value is valid and uninitialized, write current value to it
-         if(old_value && (*old_value == CHEAT_CODE_MAGIC_VALUE))
-            *old_value = (int) read_address_16bit(address);
-         update_address_16bit(address,value);
-         return 1;
-      case 0xD0000000:
-      case 0xD8000000:
-         return address_equal_to_8bit(address,(unsigned char) value);
-      case 0xD1000000:
-      case 0xD9000000:
-         return address_equal_to_16bit(address,value);
-      case 0xD2000000:
-      case 0xDB000000:
-         return !(address_equal_to_8bit(address,(unsigned char) value));
-      case 0xD3000000:
-      case 0xDA000000:
-         return !(address_equal_to_16bit(address,value));
-      case 0xEE000000:
-         // most likely, this doesnt do anything.
-         execute_cheat(0xF1000318, 0x0040, NULL);
-         execute_cheat(0xF100031A, 0x0000, NULL);
-         return 1;
-   }
-
-   return 1;
-}
+static cheat_program_t programs[2]; /* indexed by ENTRY_BOOT / ENTRY_VI */
+static cheat_program_t game_fix_program;
+static int game_fix_on_frame_dupe;
 
+static int cheats_changed;
+static int restore_pending;
+
+/* Private functions */
 static cheat_t *find_or_create_cheat(const char *name)
 {
     cheat_t *cheat;
@@ -170,14 +166,12 @@ static cheat_t *find_or_create_cheat(const char *name)
         }
 
         cheat->enabled = 0;
-        cheat->was_enabled = 0;
     }
     else
     {
         cheat = malloc(sizeof(*cheat));
         cheat->name = strdup(name);
         cheat->enabled = 0;
-        cheat->was_enabled = 0;
         INIT_LIST_HEAD(&cheat->cheat_codes);
         list_add_tail(&cheat->list, &active_cheats);
     }
@@ -186,216 +180,345 @@ static cheat_t *find_or_create_cheat(const char *name)
 }
 
 
-// public functions
-void cheat_init(void)
+static cheat_op_t *add_op(cheat_program_t *program, unsigned char type, unsigned int address,
+                          unsigned short value, unsigned char flags, int *old_value)
 {
+    cheat_op_t *op;
+
+    if (program->count == program->size)
+    {
+        size_t size = program->size ? program->size * 2 : 16;
+        cheat_op_t *ops = realloc(program->ops, size * sizeof(*ops));
+        if (ops == NULL)
+            return NULL;
+        program->ops = ops;
+        program->size = size;
+    }
+
+    op = &program->ops[program->count++];
+    op->type = type;
+    op->flags = flags;
+    op->value = value;
+    op->guarded = 0;
+    op->old_value = old_value;
+
+    if (type == CHEAT_OP_WRITE8 || type == CHEAT_OP_IF_EQUAL8 || type == CHEAT_OP_IF_NOT_EQUAL8
+            || type == CHEAT_OP_RESTORE8)
+        op->offset = (address & 0xFFFFFF)^S8;
+    else
+        op->offset = (address & 0xFFFFFF)^S16;
+
+    return op;
 }
 
-void cheat_uninit(void)
+// adds the ops for a single code, returns how many were added
+static unsigned int compile_code(cheat_program_t *program, unsigned int address, unsigned short value,
+                                 unsigned char flags, int *old_value)
 {
+    switch (address & 0xFF000000)
+    {
+        case 0x80000000:
+        case 0x88000000:
+        case 0xA0000000:
+        case 0xA8000000:
+        case 0xF0000000:
+            return add_op(program, CHEAT_OP_WRITE8, address, value, flags, old_value) != NULL;
+        case 0x81000000:
+        case 0x89000000:
+        case 0xA1000000:
+        case 0xA9000000:
+        case 0xF1000000:
+            return add_op(program, CHEAT_OP_WRITE16, address, value, flags, old_value) != NULL;
+        case 0xEE000000:
+            return compile_code(program, 0xF1000318, 0x0040, flags, NULL)
+                 + compile_code(program, 0xF100031A, 0x0000, flags, NULL);
+    }
+
+    return 0;
 }
 
-void cheat_apply_cheats(int entry)
+static unsigned char conditional_type(unsigned int address)
+{
+    switch (address & 0xFF000000)
+    {
+        case 0xD0000000:
+        case 0xD8000000:
+            return CHEAT_OP_IF_EQUAL8;
+        case 0xD1000000:
+        case 0xD9000000:
+            return CHEAT_OP_IF_EQUAL16;
+        case 0xD2000000:
+        case 0xDB000000:
+            return CHEAT_OP_IF_NOT_EQUAL8;
+        case 0xD3000000:
+        case 0xDA000000:
+            return CHEAT_OP_IF_NOT_EQUAL16;
+    }
+
+    return CHEAT_OP_IF_TRUE;
+}
+
+static int needs_gameshark_button(unsigned int address)
+{
+    switch (address & 0xFF000000)
+    {
+        case 0x88000000:
+        case 0x89000000:
+        case 0xA8000000:
+        case 0xA9000000:
+        case 0xD8000000:
+        case 0xD9000000:
+        case 0xDA000000:
+        case 0xDB000000:
+            return 1;
+    }
+
+    return 0;
+}
+
+static void compile_vi_codes(cheat_program_t *program, cheat_t *cheat)
 {
-    cheat_t *cheat;
     cheat_code_t *code;
-    int skip;
-    int execute_next;
-
-#if 0
-   if ((
-         strncmp((char *)ROM_HEADER.Name, (const char *)"BANJO KAZOOIE 2", 15) == 0
-         || strncmp((char *)ROM_HEADER.Name, (const char *)"BANJO TOOIE", 11) == 0
-         ) && entry == ENTRY_VI)
-   {
-      execute_cheat(0x8107913C, 0x0000, NULL);
-      execute_cheat(0x8107913E, 0x0000, NULL);
-   }
-#endif
-
-   if (!frame_dupe)
-   {
-      // If game is Zelda OOT, apply subscreen delay fix
-      if (strncmp((char *)ROM_HEADER.Name, "THE LEGEND OF ZELDA", 19) == 0 && entry == ENTRY_VI) {
-         if (sl(ROM_HEADER.CRC1) == 0xEC7011B7 && sl(ROM_HEADER.CRC2) == 0x7616D72B) {
-            // Legend of Zelda, The - Ocarina of Time (U) + (J) (V1.0)
-            execute_cheat(0x801DA5CB, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0xD43DA81F && sl(ROM_HEADER.CRC2) == 0x021E1E19) {
-            // Legend of Zelda, The - Ocarina of Time (U) + (J) (V1.1)
-            execute_cheat(0x801DA78B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0x693BA2AE && sl(ROM_HEADER.CRC2) == 0xB7F14E9F) {
-            // Legend of Zelda, The - Ocarina of Time (U) + (J) (V1.2)
-            execute_cheat(0x801DAE8B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0xB044B569 && sl(ROM_HEADER.CRC2) == 0x373C1985) {
-            // Legend of Zelda, The - Ocarina of Time (E) (V1.0)
-            execute_cheat(0x801D860B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0xB2055FBD && sl(ROM_HEADER.CRC2) == 0x0BAB4E0C) {
-            // Legend of Zelda, The - Ocarina of Time (E) (V1.1)
-            execute_cheat(0x801D864B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0xF034001A && sl(ROM_HEADER.CRC2) == 0xAE47ED06) {
-            // Legend of Zelda, The - Ocarina of Time - Master Quest (U) (GC)
-            execute_cheat(0x801DB74B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0x1D4136F3 && sl(ROM_HEADER.CRC2) == 0xAF63EEA9) {
-            // Legend of Zelda, The - Ocarina of Time - Master Quest (E) (GC)
-            execute_cheat(0x801D8F4B, 0x0002, NULL);
-         } else if (sl(ROM_HEADER.CRC1) == 0x917D18F6 && sl(ROM_HEADER.CRC2) == 0x69BC5453) {
-            // Legend of Zelda, The - Ocarina of Time - Master Quest (U) (Debug Version)
-            execute_cheat(0x8022414B, 0x0002, NULL);
-         }
-      }
-   }
-
-    // If game is Pokemon Snap, apply controller fix
-    if (strncmp((char *)ROM_HEADER.Name, "POKEMON SNAP", 12) == 0 && entry == ENTRY_VI) {
-       if (sl(ROM_HEADER.CRC1) == 0xCA12B547 && sl(ROM_HEADER.CRC2) == 0x71FA4EE4) {
-          // Pokemon Snap (U)
-          execute_cheat(0xD1382D1C, 0x0002, NULL);
-          execute_cheat(0x80382D0F, 0x0000, NULL);
-       }
-       else if (sl(ROM_HEADER.CRC1) == 0x7BB18D40 && sl(ROM_HEADER.CRC2) == 0x83138559) {
-          // Pokemon Snap (A)
-          execute_cheat(0xD1382D1C, 0x0002, NULL);
-          execute_cheat(0x80382D0F, 0x0000, NULL);
-       }
-       else if (sl(ROM_HEADER.CRC1) == 0x39119872 && sl(ROM_HEADER.CRC2) == 0x07722E9F) {
-          // Pokemon Snap Station (U)
-          execute_cheat(0xD1382D1C, 0x0002, NULL);
-          execute_cheat(0x80382D0F, 0x0000, NULL);
-       }
-       else if (sl(ROM_HEADER.CRC1) == 0xEC0F690D && sl(ROM_HEADER.CRC2) == 0x32A7438C) {
-          // Pokemon Snap (J) (V1.0)
-          execute_cheat(0xD136D22C, 0x802A, NULL);
-          execute_cheat(0x8036D21F, 0x0000, NULL);
-       }
-       else if (sl(ROM_HEADER.CRC1) == 0xE0044E9E && sl(ROM_HEADER.CRC2) == 0xCD659D0D) {
-          // Pokemon Snap (J) (V1.1)
-          execute_cheat(0xD136D22C, 0x802A, NULL);
-          execute_cheat(0x8036D21F, 0x0000, NULL);
-       }
-       else if (sl(ROM_HEADER.CRC1) == 0x5753720D && sl(ROM_HEADER.CRC2) == 0x2A8A884D) {
-          // Pokemon Snap (G)
-          execute_cheat(0xD1381BDC, 0x802C, NULL);
-          execute_cheat(0x80381BCF, 0x0000, NULL);
-       }
-       else {
-          // Pokemon Snap (E) + (F) + (I) + (S)
-          execute_cheat(0xD1381BFC, 0x802C, NULL);
-          execute_cheat(0x80381BEF, 0x0000, NULL);
-       }
+    size_t conditional = 0;
+    int guarding = 0;
+
+    list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list)
+    {
+        if (guarding)
+        {
+            // whatever follows a conditional runs without any further check
+            unsigned int guarded = compile_code(program, code->address, code->value, 0, &code->old_value);
+
+            if (guarded == 0)
+                program->count = conditional;
+            else
+                program->ops[conditional].guarded = guarded;
+
+            guarding = 0;
+        }
+        // conditional cheat codes
+        else if ((code->address & 0xF0000000) == 0xD0000000)
+        {
+            conditional = program->count;
+            guarding = add_op(program, conditional_type(code->address), code->address, code->value,
+                    needs_gameshark_button(code->address) ? CHEAT_OP_GAMESHARK : 0, NULL) != NULL;
+        }
+        // GS button triggers cheat code
+        else if (needs_gameshark_button(code->address))
+            compile_code(program, code->address, code->value, CHEAT_OP_GAMESHARK, NULL);
+        // normal cheat code, excluding boot-time cheat codes
+        else if ((code->address & 0xF0000000) != 0xF0000000)
+            compile_code(program, code->address, code->value, 0, &code->old_value);
     }
-    
-    if (list_empty(&active_cheats))
-        return;
+
+    // a conditional with nothing after it does nothing
+    if (guarding)
+        program->count = conditional;
+}
+
+// only the writes ever save an old value
+static void compile_restore_codes(cheat_program_t *program, cheat_t *cheat)
+{
+    cheat_code_t *code;
+
+    list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list)
+    {
+        switch (code->address & 0xFF000000)
+        {
+            case 0x80000000:
+            case 0x88000000:
+            case 0xA0000000:
+            case 0xA8000000:
+            case 0xF0000000:
+                add_op(program, CHEAT_OP_RESTORE8, code->address, 0, 0, &code->old_value);
+                break;
+            case 0x81000000:
+            case 0x89000000:
+            case 0xA1000000:
+            case 0xA9000000:
+            case 0xF1000000:
+                add_op(program, CHEAT_OP_RESTORE16, code->address, 0, 0, &code->old_value);
+                break;
+        }
+    }
+}
+
+static void compile_cheats(void)
+{
+    cheat_t *cheat;
+    cheat_code_t *code;
+
+    programs[ENTRY_BOOT].count = 0;
+    programs[ENTRY_VI].count = 0;
 
     list_for_each_entry_t(cheat, &active_cheats, cheat_t, list)
     {
-        if (cheat->enabled)
+        if (!cheat->enabled)
         {
-            cheat->was_enabled = 1;
-            switch(entry)
-            {
-                case ENTRY_BOOT:
-                    list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list)
-                    {
-                        // code should only be written once at boot time
-                        if((code->address & 0xF0000000) == 0xF0000000)
-                            execute_cheat(code->address, code->value, &code->old_value);
-                    }
-                    break;
-                case ENTRY_VI:
-                    skip = 0;
-                    execute_next = 0;
-                    list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list)
-                    {
-                        if (skip)
-                        {
-                            skip = 0;
-                            continue;
-                        }
-                        if (execute_next)
-                        {
-                            execute_next = 0;
-
-                            // if code needs GS button pressed, don't save old value
-                            if(((code->address & 0xFF000000) == 0xD8000000 ||
-                                (code->address & 0xFF000000) == 0xD9000000 ||
-                                (code->address & 0xFF000000) == 0xDA000000 ||
-                                (code->address & 0xFF000000) == 0xDB000000))
-                               execute_cheat(code->address, code->value, NULL);
-                            else
-                               execute_cheat(code->address, code->value, &code->old_value);
-
-                            continue;
-                        }
-                        // conditional cheat codes
-                        if((code->address & 0xF0000000) == 0xD0000000)
-                        {
-                            // if code needs GS button pressed and it's not, skip it
-                            if(((code->address & 0xFF000000) == 0xD8000000 ||
-                                (code->address & 0xFF000000) == 0xD9000000 ||
-                                (code->address & 0xFF000000) == 0xDA000000 ||
-                                (code->address & 0xFF000000) == 0xDB000000) &&
-                               !event_gameshark_active())
-                            {
-                                // skip next code
-                                skip = 1;
-                                continue;
-                            }
-
-                            if (execute_cheat(code->address, code->value, NULL))
-                            {
-                                // if condition true, execute next cheat code
-                                execute_next = 1;
-                            }
-                            else
-                            {
-                                // if condition false, skip next code
-                                skip = 1;
-                                continue;
-                            }
-                        }
-                        // GS button triggers cheat code
-                        else if((code->address & 0xFF000000) == 0x88000000 ||
-                                (code->address & 0xFF000000) == 0x89000000 ||
-                                (code->address & 0xFF000000) == 0xA8000000 ||
-                                (code->address & 0xFF000000) == 0xA9000000)
-                        {
-                            if(event_gameshark_active())
-                                execute_cheat(code->address, code->value, NULL);
-                        }
-                        // normal cheat code
-                        else
-                        {
-                            // exclude boot-time cheat codes
-                            if((code->address & 0xF0000000) != 0xF0000000)
-                                execute_cheat(code->address, code->value, &code->old_value);
-                        }
-                    }
-                    break;
-                default:
-                    break;
-            }
+            if (restore_pending)
+                compile_restore_codes(&programs[ENTRY_VI], cheat);
+            continue;
         }
-        // if cheat was enabled, but is now disabled, restore old memory values
-        else if (cheat->was_enabled)
+
+        // code should only be written once at boot time
+        list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list)
         {
-            cheat->was_enabled = 0;
-            switch(entry)
-            {
-                case ENTRY_VI:
-                    list_for_each_entry_t(code, &cheat->cheat_codes, cheat_code_t, list) {
-                        // set memory back to old value and clear saved copy of old value
-                        if(code->old_value != CHEAT_CODE_MAGIC_VALUE)
-                        {
-                            execute_cheat(code->address, code->old_value, NULL);
-                            code->old_value = CHEAT_CODE_MAGIC_VALUE;
-                        }
-                    }
-                    break;
-                default:
-                    break;
-            }
+            if ((code->address & 0xF0000000) == 0xF0000000)
+                compile_code(&programs[ENTRY_BOOT], code->address, code->value, 0, &code->old_value);
         }
+
+        compile_vi_codes(&programs[ENTRY_VI], cheat);
+    }
+
+    cheats_changed = 0;
+}
+
+static int is_conditional(unsigned char type)
+{
+    switch (type)
+    {
+        case CHEAT_OP_IF_EQUAL8:
+        case CHEAT_OP_IF_EQUAL16:
+        case CHEAT_OP_IF_NOT_EQUAL8:
+        case CHEAT_OP_IF_NOT_EQUAL16:
+        case CHEAT_OP_IF_TRUE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void run_program(const cheat_program_t *program)
+{
+    unsigned char *rdram = (unsigned char*)g_rdram;
+    const cheat_op_t *op = program->ops;
+    const cheat_op_t *end = op + program->count;
+    int gameshark = event_gameshark_active();
+    int condition;
+
+    for (; op < end; op++)
+    {
+        if ((op->flags & CHEAT_OP_GAMESHARK) && !gameshark)
+        {
+            // a skipped conditional takes the ops it guards with it
+            if (is_conditional(op->type))
+                op += op->guarded;
+            continue;
+        }
+
+        switch (op->type)
+        {
+            case CHEAT_OP_WRITE8:
+                // if pointer to old value is valid and uninitialized, write current value to it
+                if (op->old_value && *op->old_value == CHEAT_CODE_MAGIC_VALUE)
+                    *op->old_value = rdram[op->offset];
+                rdram[op->offset] = (unsigned char)op->value;
+                continue;
+            case CHEAT_OP_WRITE16:
+                if (op->old_value && *op->old_value == CHEAT_CODE_MAGIC_VALUE)
+                    *op->old_value = *(unsigned short*)(rdram + op->offset);
+                *(unsigned short*)(rdram + op->offset) = op->value;
+                continue;
+            case CHEAT_OP_RESTORE8:
+                if (*op->old_value != CHEAT_CODE_MAGIC_VALUE)
+                    rdram[op->offset] = (unsigned char)*op->old_value;
+                *op->old_value = CHEAT_CODE_MAGIC_VALUE;
+                continue;
+            case CHEAT_OP_RESTORE16:
+                if (*op->old_value != CHEAT_CODE_MAGIC_VALUE)
+                    *(unsigned short*)(rdram + op->offset) = (unsigned short)*op->old_value;
+                *op->old_value = CHEAT_CODE_MAGIC_VALUE;
+                continue;
+            case CHEAT_OP_IF_EQUAL8:
+                condition = rdram[op->offset] == (unsigned char)op->value;
+                break;
+            case CHEAT_OP_IF_EQUAL16:
+                condition = *(unsigned short*)(rdram + op->offset) == op->value;
+                break;
+            case CHEAT_OP_IF_NOT_EQUAL8:
+                condition = rdram[op->offset] != (unsigned char)op->value;
+                break;
+            case CHEAT_OP_IF_NOT_EQUAL16:
+                condition = *(unsigned short*)(rdram + op->offset) != op->value;
+                break;
+            case CHEAT_OP_IF_TRUE:
+            default:
+                condition = 1;
+                break;
+        }
+
+        if (!condition)
+            op += op->guarded;
+    }
+}
+
+static void compile_game_fixes(void)
+{
+    size_t i;
+
+    game_fix_program.count = 0;
+    game_fix_on_frame_dupe = 0;
+
+    for (i = 0; i < sizeof(game_fixes) / sizeof(game_fixes[0]); i++)
+    {
+        const game_fix_t *fix = &game_fixes[i];
+
+        if (strncmp((char *)ROM_HEADER.Name, fix->name, strlen(fix->name)) != 0)
+            continue;
+
+        if (fix->crc1 != 0 && (sl(ROM_HEADER.CRC1) != fix->crc1 || sl(ROM_HEADER.CRC2) != fix->crc2))
+            continue;
+
+        compile_code(&game_fix_program, fix->address, fix->value, 0, NULL);
+        game_fix_on_frame_dupe = fix->on_frame_dupe;
+        break;
+    }
+}
+
+// public functions
+void cheat_init(void)
+{
+    compile_game_fixes();
+    cheats_changed = 1;
+}
+
+void cheat_uninit(void)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+    {
+        free(programs[i].ops);
+        memset(&programs[i], 0, sizeof(programs[i]));
+    }
+
+    free(game_fix_program.ops);
+    memset(&game_fix_program, 0, sizeof(game_fix_program));
+
+    cheats_changed = 1;
+}
+
+void cheat_apply_cheats(int entry)
+{
+    if (entry != ENTRY_BOOT && entry != ENTRY_VI)
+        return;
+
+    if (cheats_changed)
+        compile_cheats();
+
+    if (entry == ENTRY_VI)
+    {
+        if (!frame_dupe || game_fix_on_frame_dupe)
+            run_program(&game_fix_program);
+    }
+
+    run_program(&programs[entry]);
+
+    // the restores only run once
+    if (entry == ENTRY_VI && restore_pending)
+    {
+        restore_pending = 0;
+        cheats_changed = 1;
     }
 }
 
@@ -420,6 +543,8 @@ void cheat_delete_all(void)
         list_del(&cheat->list);
         free(cheat);
     }
+
+    cheats_changed = 1;
 }
 
 int cheat_set_enabled(const char *name, int enabled)
@@ -434,6 +559,9 @@ int cheat_set_enabled(const char *name, int enabled)
         if (strcmp(name, cheat->name) == 0)
         {
             cheat->enabled = enabled;
+            cheats_changed = 1;
+            if (!enabled)
+                restore_pending = 1;
             return 1;
         }
     }
@@ -452,6 +580,7 @@ int cheat_add_new(const char *name, m64p_cheat_code *code_list, int num_codes)
         return 0;
 
     cheat->enabled = 1; /* default for new cheats is enabled */
+    cheats_changed = 1;
 
     for (i = 0; i < num_codes; i++)
     {
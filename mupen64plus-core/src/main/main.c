@@ -88,7 +88,7 @@ m64p_frame_callback g_FrameCallback = NULL;
 int         g_MemHasBeenBSwapped = 0;   // store byte-swapped flag so we don't swap twice when re-playing game
 int         g_EmulatorRunning = 0;      // need separate boolean to tell if emulator is running, since --nogui doesn't use a thread
 
-ALIGN(16, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
+ALIGN(4096, uint32_t g_rdram[RDRAM_MAX_SIZE/4]);
 struct ai_controller g_ai;
 struct pi_controller g_pi;
 struct ri_controller g_ri;
@@ -258,6 +258,9 @@ void main_exit(void)
    input.romClosed();
    gfx.romClosed();
 
+   cheat_uninit();
+   savestates_deinit_m64p();
+
    // clean up
    g_EmulatorRunning = 0;
    StateChanged(M64CORE_EMU_STATE, M64EMU_STOPPED);
@@ -434,6 +437,8 @@ m64p_error main_init(void)
    g_EmulatorRunning = 1;
    StateChanged(M64CORE_EMU_STATE, M64EMU_RUNNING);
 
+   cheat_init();
+
    /* call r4300 CPU core and run the game */
    r4300_reset_hard();
    r4300_reset_soft();
@@ -30,6 +30,11 @@
 static long long int time_in_section[NUM_TIMED_SECTIONS];
 static long long int last_start[NUM_TIMED_SECTIONS];
 
+/* currently open sections, innermost last */
+#define MAX_SECTION_DEPTH 8
+static enum timed_section section_stack[MAX_SECTION_DEPTH];
+static int section_depth;
+
 #if defined(WIN32) && !defined(__MINGW32__)
   // timing
   #include <windows.h>
@@ -64,13 +69,27 @@ static long long int last_start[NUM_TIMED_SECTIONS];
 
 void timed_section_start(enum timed_section section)
 {
+   if (section_depth < MAX_SECTION_DEPTH)
+      section_stack[section_depth++] = section;
+
    last_start[section] = get_time();
 }
 
 void timed_section_end(enum timed_section section)
 {
    long long int end = get_time();
-   time_in_section[section] += end - last_start[section];
+   long long int elapsed = end - last_start[section];
+
+   time_in_section[section] += elapsed;
+
+   if (section_depth > 0 && section_stack[section_depth - 1] == section)
+   {
+      --section_depth;
+
+      /* don't count this section twice if it ran inside another one */
+      if (section_depth > 0)
+         time_in_section[section_stack[section_depth - 1]] -= elapsed;
+   }
 }
 
 void timed_sections_refresh()
@@ -97,5 +116,16 @@ void timed_sections_refresh()
    }
 }
 
+void timed_sections_collect(long long int nsec[NUM_TIMED_SECTIONS])
+{
+   int i;
+
+   for (i = 0; i < NUM_TIMED_SECTIONS; ++i)
+   {
+      nsec[i] = time_to_nsec(time_in_section[i]);
+      time_in_section[i] = 0;
+   }
+}
+
 #endif
 
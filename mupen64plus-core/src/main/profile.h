@@ -31,6 +31,9 @@ enum timed_section
     TIMED_SECTION_AUDIO,
     TIMED_SECTION_COMPILER,
     TIMED_SECTION_IDLE,
+    TIMED_SECTION_RDP,
+    TIMED_SECTION_VI,
+    TIMED_SECTION_AI,
     NUM_TIMED_SECTIONS
 };
 
@@ -38,6 +41,10 @@ enum timed_section
   void timed_section_start(enum timed_section section);
   void timed_section_end(enum timed_section section);
   void timed_sections_refresh(void);
+  /* Copy the time (in ns) spent in each section since the last call and
+   * reset the counters. Time spent in a nested section is not counted
+   * in the enclosing one. */
+  void timed_sections_collect(long long int nsec[NUM_TIMED_SECTIONS]);
 #else
   #define timed_section_start(a)
   #define timed_section_end(a)
@@ -43,7 +43,7 @@
 
 #define DEFAULT 16
 
-static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5);
+static const romdatabase_entry* ini_search_by_md5(md5_byte_t* md5);
 
 static _romdatabase g_romdatabase;
 
@@ -121,7 +121,7 @@ m64p_error open_rom(const unsigned char* romimage, unsigned int size)
 #include "rom_luts.c"
    md5_state_t state;
    md5_byte_t digest[16];
-   romdatabase_entry* entry;
+   const romdatabase_entry* entry;
    char buffer[256];
    unsigned char imagetype;
    int i;
@@ -365,6 +365,28 @@ static int rom_system_type_to_ai_dac_rate(m64p_system_type system_type)
 /********************************************************************************************/
 /* INI Rom database functions */
 
+#include "rom_db.c"
+
+/* Must stay in sync with romdb_hash() in tools/gen_romdb.py. */
+static uint32_t romdb_hash(const uint32_t* words, int count, uint32_t seed)
+{
+   uint32_t h = 0x811C9DC5 ^ seed;
+   int i;
+
+   for (i = 0; i < count; ++i)
+   {
+      h = (h ^ words[i]) * 0x9E3779B1;
+      h ^= h >> 16;
+   }
+   h ^= h >> 13;
+   h *= 0x85EBCA6B;
+   h ^= h >> 16;
+   return h;
+}
+
+/* The built-in database is compiled in from mupen64plus.ini by
+ * tools/gen_romdb.py. A mupen64plus.ini in the system directory is parsed
+ * here as before, and overrides it entry by entry. */
 void romdatabase_open(void)
 {
    FILE *fPtr;
@@ -375,24 +397,22 @@ void romdatabase_open(void)
    int counter, value, lineno;
    unsigned char index;
    const char *pathname = ConfigGetSharedDataFilepath("mupen64plus.ini");
-   DebugMessage(M64MSG_WARNING, "ROM Database: %s", pathname);
+   DebugMessage(M64MSG_VERBOSE, "ROM Database: %i built-in entries", ROMDB_ENTRIES);
 
    if(g_romdatabase.have_database)
       return;
 
-   /* Open romdatabase. */
+   /* Without one, the built-in database is all there is. */
    if (pathname == NULL || (fPtr = fopen(pathname, "rb")) == NULL)
-   {
-      DebugMessage(M64MSG_ERROR, "Unable to open rom database file '%s'.", pathname);
       return;
-   }
 
+   DebugMessage(M64MSG_INFO, "ROM Database: %s overrides the built-in entries", pathname);
    g_romdatabase.have_database = 1;
 
    /* Clear premade indices. */
-   for(counter = 0; counter < 255; ++counter)
+   for(counter = 0; counter < 256; ++counter)
       g_romdatabase.crc_lists[counter] = NULL;
-   for(counter = 0; counter < 255; ++counter)
+   for(counter = 0; counter < 256; ++counter)
       g_romdatabase.md5_lists[counter] = NULL;
    g_romdatabase.list = NULL;
 
@@ -421,7 +441,7 @@ void romdatabase_open(void)
 
                search->entry.goodname = NULL;
                memcpy(search->entry.md5, md5, 16);
-               search->entry.refmd5 = NULL;
+               search->refmd5 = NULL;
                search->entry.crc1 = 0;
                search->entry.crc2 = 0;
                search->entry.status = 0; /* Set default to 0 stars. */
@@ -472,8 +492,8 @@ void romdatabase_open(void)
                md5_byte_t md5[16];
                if (parse_hex(l.value, md5, 16))
                {
-                  search->entry.refmd5 = (md5_byte_t*)malloc(16*sizeof(md5_byte_t));
-                  memcpy(search->entry.refmd5, md5, 16);
+                  search->refmd5 = (md5_byte_t*)malloc(16*sizeof(md5_byte_t));
+                  memcpy(search->refmd5, md5, 16);
                }
                else
                   DebugMessage(M64MSG_WARNING, "ROM Database: Invalid RefMD5 on line %i", lineno);
@@ -530,12 +550,12 @@ void romdatabase_open(void)
 
    fclose(fPtr);
 
-   /* Resolve RefMD5 references */
+   /* Resolve RefMD5 references, in the file or else built in */
    for (search = g_romdatabase.list; search != NULL; search = search->next_entry)
    {
-      if (search->entry.refmd5 != NULL)
+      if (search->refmd5 != NULL)
       {
-         romdatabase_entry *ref = ini_search_by_md5(search->entry.refmd5);
+         const romdatabase_entry *ref = ini_search_by_md5(search->refmd5);
          if (ref != NULL)
          {
             if(ref->savetype!=DEFAULT)
@@ -563,47 +583,71 @@ void romdatabase_close(void)
       romdatabase_search* search = g_romdatabase.list->next_entry;
       if(g_romdatabase.list->entry.goodname)
          free(g_romdatabase.list->entry.goodname);
-      if(g_romdatabase.list->entry.refmd5)
-         free(g_romdatabase.list->entry.refmd5);
+      if(g_romdatabase.list->refmd5)
+         free(g_romdatabase.list->refmd5);
       free(g_romdatabase.list);
       g_romdatabase.list = search;
    }
+   g_romdatabase.have_database = 0;
 }
 
-static romdatabase_entry* ini_search_by_md5(md5_byte_t* md5)
+static const romdatabase_entry* ini_search_by_md5(md5_byte_t* md5)
 {
    romdatabase_search* search;
+   uint32_t key[4];
+   unsigned int index;
+   int i;
 
-   if(!g_romdatabase.have_database)
-      return NULL;
+   if (g_romdatabase.have_database)
+   {
+      search = g_romdatabase.md5_lists[md5[0]];
+
+      while (search != NULL && memcmp(search->entry.md5, md5, 16) != 0)
+         search = search->next_md5;
+
+      if (search != NULL)
+         return &(search->entry);
+   }
 
-   search = g_romdatabase.md5_lists[md5[0]];
+   for (i = 0; i < 4; ++i)
+      key[i] = ((uint32_t)md5[4*i+0] << 24) | ((uint32_t)md5[4*i+1] << 16) |
+               ((uint32_t)md5[4*i+2] <<  8) |  (uint32_t)md5[4*i+3];
 
-   while (search != NULL && memcmp(search->entry.md5, md5, 16) != 0)
-      search = search->next_md5;
+   index = romdb_md5_seeds[romdb_hash(key, 4, 0) % ROMDB_MD5_BUCKETS];
+   index = romdb_md5_slots[romdb_hash(key, 4, index) % ROMDB_MD5_SLOTS];
 
-   if(search==NULL)
+   if (index == ROMDB_NONE || memcmp(romdb_entries[index].md5, md5, 16) != 0)
       return NULL;
 
-   return &(search->entry);
+   return &romdb_entries[index];
 }
 
-romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2)
+const romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2)
 {
    romdatabase_search* search;
+   uint32_t key[2];
+   unsigned int index;
 
-   if(!g_romdatabase.have_database) 
-      return NULL;
+   if (g_romdatabase.have_database)
+   {
+      search = g_romdatabase.crc_lists[((crc1 >> 24) & 0xff)];
 
-   search = g_romdatabase.crc_lists[((crc1 >> 24) & 0xff)];
+      while (search != NULL && (search->entry.crc1 != crc1 || search->entry.crc2 != crc2))
+         search = search->next_crc;
 
-   while (search != NULL && search->entry.crc1 != crc1 && search->entry.crc2 != crc2)
-      search = search->next_crc;
+      if (search != NULL)
+         return &(search->entry);
+   }
 
-   if(search == NULL) 
-      return NULL;
+   key[0] = crc1;
+   key[1] = crc2;
 
-   return &(search->entry);
-}
+   index = romdb_crc_seeds[romdb_hash(key, 2, 0) % ROMDB_CRC_BUCKETS];
+   index = romdb_crc_slots[romdb_hash(key, 2, index) % ROMDB_CRC_SLOTS];
 
+   if (index == ROMDB_NONE ||
+         romdb_entries[index].crc1 != crc1 || romdb_entries[index].crc2 != crc2)
+      return NULL;
 
+   return &romdb_entries[index];
+}
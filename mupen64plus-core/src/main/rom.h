@@ -97,14 +97,16 @@ enum
  * and whether the rom can make use of the N64's rumble feature. Md5, crc1, and
  * crc2 used for rom lookup. Md5s are unique hashes of the ENTIRE rom. Crcs are not
  * unique and read from the rom header, meaning corrupt crcs are also a problem.
- * Crcs were widely used (mainly in the cheat system). Refmd5s allows for a smaller
- * database file and need not be used outside database loading.
+ * Crcs were widely used (mainly in the cheat system). The database is compiled
+ * from mupen64plus.ini by tools/gen_romdb.py into rom_db.c, with RefMD5s
+ * already resolved and perfect hash indices on both md5 and crc1/crc2.
+ * A mupen64plus.ini in the system directory is still read at startup, and
+ * its entries are looked up before the built-in ones.
  */
 typedef struct
 {
    char* goodname;
    md5_byte_t md5[16];
-   md5_byte_t* refmd5;
    unsigned int crc1;
    unsigned int crc2;
    unsigned char status; /* Rom status on a scale from 0-5. */
@@ -116,6 +118,7 @@ typedef struct
 typedef struct _romdatabase_search
 {
     romdatabase_entry entry;
+    md5_byte_t* refmd5;
     struct _romdatabase_search* next_entry;
     struct _romdatabase_search* next_crc;
     struct _romdatabase_search* next_md5;
@@ -134,7 +137,7 @@ void romdatabase_close(void);
 /* Should be used by current cheat system (isn't), when cheat system is
  * migrated to md5s, will be fully depreciated.
  */
-romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2);
+const romdatabase_entry* ini_search_by_crc(unsigned int crc1, unsigned int crc2);
 
 #endif /* __ROM_H__ */
 
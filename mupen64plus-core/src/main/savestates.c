@@ -38,10 +38,12 @@
 
 #include "../ai/ai_controller.h"
 #include "../memory/memory.h"
+#include "../memory/rdram_watch.h"
 #include "../r4300/cp1.h"
 #include "../pi/pi_controller.h"
 #include "../plugin/plugin.h"
 #include "../r4300/r4300_core.h"
+#include "../r4300/tlb.h"
 #include "../rdp/rdp_core.h"
 #include "../ri/ri_controller.h"
 #include "../rsp/rsp_core.h"
@@ -50,8 +52,48 @@
 #include "osal/preproc.h"
 
 static const char* savestate_magic = "M64+SAVE";
+static const char* savestate_delta_magic = "M64+DLTA";
 static const int savestate_latest_version = 0x00010000;  /* 1.0 */
 
+/* Size of a full savestate, not counting the event queue at the end. */
+#define SAVESTATE_SIZE        16788288
+#define SAVESTATE_QUEUE_SIZE  1024
+
+/* Delta savestates
+ *
+ * A delta savestate has the same layout as a full one, except that RDRAM and
+ * the TLB LUTs only carry the 4KB pages that differ from a keyframe, each
+ * prefixed by its page number, and the header names that keyframe by a hash
+ * of it. A keyframe is a full savestate saved or loaded while delta
+ * savestates are on; the last SAVESTATE_KEYFRAMES of them are kept in memory,
+ * and any delta of one of them can be loaded on its own, in any order, as
+ * rewind and rollback need. Deltas of older keyframes are rejected.
+ *
+ * The pages a delta carries are all those written since its keyframe, so
+ * deltas grow until a new keyframe is cheaper, past SAVESTATE_DELTA_MAX.
+ * RDRAM is written behind the core's back by the dynarecs, DMA and the RSP
+ * and RDP plugins, so its pages are found by rdram_watch, and where that
+ * cannot trap writes, by comparing the pages not yet found against the
+ * keyframe. The LUTs are only ever written by tlb.c, which flags the pages
+ * itself.
+ */
+#define SAVESTATE_KEYFRAMES  2
+#define SAVESTATE_DELTA_MAX  (SAVESTATE_SIZE / 4)
+
+struct savestate_keyframe
+{
+   uint32_t hash;
+   uint32_t* rdram;                   /* NULL while the slot is empty */
+   /* Most of the LUTs is zeroes, so only the other pages are kept, r then
+    * w, 0x800 words each. lut_slot holds one plus the index of a page, or 0
+    * for a page of zeroes. */
+   uint32_t* lut;
+   uint16_t lut_slot[TLB_LUT_PAGES];
+};
+
+static struct savestate_keyframe keyframes[SAVESTATE_KEYFRAMES];
+static int delta_enabled = 0;
+
 #define GETARRAY(buff, type, count) \
     (to_little_endian_buffer(buff, sizeof(type),count), \
      buff += count*sizeof(type), \
@@ -68,12 +110,272 @@ static const int savestate_latest_version = 0x00010000;  /* 1.0 */
 #define PUTDATA(buff, type, value) \
     do { type x = value; PUTARRAY(&x, buff, type, 1); } while(0)
 
+/* Names a full savestate by everything in it but RDRAM, the TLB LUTs and
+ * the event queue: all the registers, Count among them, the RSP memory and
+ * the PIF RAM. Hashing the 16MB left out would double the cost of a full
+ * savestate, and two states alike in all of the rest are as good as one. */
+#define SAVESTATE_HASH_INIT  UINT32_C(2166136261)
+
+static uint32_t savestates_hash(uint32_t hash, const unsigned char* data, size_t size)
+{
+   while (size--)
+      hash = (hash ^ *data++) * UINT32_C(16777619);
+   return hash;
+}
+
+static void savestates_drop_keyframes(void)
+{
+   int i;
+
+   rdram_watch_disarm();
+   for (i = 0; i < SAVESTATE_KEYFRAMES; i++)
+   {
+      free(keyframes[i].rdram);
+      free(keyframes[i].lut);
+      memset(&keyframes[i], 0, sizeof(keyframes[i]));
+   }
+}
+
+/* Makes the state just saved or loaded the current keyframe, in place of
+ * a kept one with the same hash or else of the oldest. */
+static void savestates_set_keyframe(uint32_t hash)
+{
+   struct savestate_keyframe keyframe;
+   size_t lut_pages = 0;
+   int slot, i;
+
+   for (slot = 0; slot < SAVESTATE_KEYFRAMES - 1; slot++)
+      if (keyframes[slot].rdram != NULL && keyframes[slot].hash == hash)
+         break;
+   keyframe = keyframes[slot];
+   memmove(&keyframes[1], &keyframes[0], slot*sizeof(keyframe));
+   memset(&keyframes[0], 0, sizeof(keyframe));
+
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+   {
+      int j;
+
+      keyframe.lut_slot[i] = 0;
+      for (j = 0; j < 0x400; j++)
+      {
+         if (tlb_LUT_r[i*0x400 + j] | tlb_LUT_w[i*0x400 + j])
+         {
+            keyframe.lut_slot[i] = ++lut_pages;
+            break;
+         }
+      }
+   }
+
+   free(keyframe.lut);
+   keyframe.lut = (uint32_t*)malloc(lut_pages*0x2000 + 1);
+   if (keyframe.rdram == NULL)
+      keyframe.rdram = (uint32_t*)malloc(RDRAM_MAX_SIZE);
+   if (keyframe.rdram == NULL || keyframe.lut == NULL)
+   {
+      free(keyframe.rdram);
+      free(keyframe.lut);
+      savestates_drop_keyframes();
+      return;
+   }
+
+   keyframe.hash = hash;
+   memcpy(keyframe.rdram, g_rdram, RDRAM_MAX_SIZE);
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+   {
+      uint32_t* page;
+
+      if (keyframe.lut_slot[i] == 0)
+         continue;
+      page = keyframe.lut + (keyframe.lut_slot[i] - 1)*0x800;
+      memcpy(page, tlb_LUT_r + i*0x400, 0x1000);
+      memcpy(page + 0x400, tlb_LUT_w + i*0x400, 0x1000);
+   }
+   keyframes[0] = keyframe;
+
+   memset(rdram_written, 0, sizeof(rdram_written));
+   memset(tlb_LUT_dirty, 0, sizeof(tlb_LUT_dirty));
+   rdram_watch_arm();
+}
+
+/* Puts back RDRAM and the LUTs of a kept keyframe. With tracked, the flags
+ * give every page written since keyframes[0], and only those are copied. */
+static void savestates_restore_keyframe(int slot, int tracked)
+{
+   const struct savestate_keyframe* keyframe = &keyframes[slot];
+   int i;
+
+   if (slot == 0 && tracked)
+   {
+      for (i = 0; i < RDRAM_WATCH_PAGES; i++)
+         if (rdram_written[i])
+            memcpy(g_rdram + i*0x400, keyframe->rdram + i*0x400, 0x1000);
+   }
+   else
+      memcpy(g_rdram, keyframe->rdram, RDRAM_MAX_SIZE);
+
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+   {
+      const uint32_t* page;
+
+      if (slot == 0 && !tlb_LUT_dirty[i])
+         continue;
+      if (keyframe->lut_slot[i] == 0)
+      {
+         memset(tlb_LUT_r + i*0x400, 0, 0x1000);
+         memset(tlb_LUT_w + i*0x400, 0, 0x1000);
+         continue;
+      }
+      page = keyframe->lut + (keyframe->lut_slot[i] - 1)*0x800;
+      memcpy(tlb_LUT_r + i*0x400, page, 0x1000);
+      memcpy(tlb_LUT_w + i*0x400, page + 0x400, 0x1000);
+   }
+
+   memset(rdram_written, 0, sizeof(rdram_written));
+   memset(tlb_LUT_dirty, 0, sizeof(tlb_LUT_dirty));
+}
+
+/* Counts the pages a delta savestate would carry and returns its size. */
+static size_t savestates_scan_delta(void)
+{
+   char queue[SAVESTATE_QUEUE_SIZE];
+   size_t rdram_pages = 0, lut_pages = 0;
+   int tracked = rdram_watch_armed();
+   int i, queuelength;
+
+   for (i = 0; i < RDRAM_WATCH_PAGES; i++)
+   {
+      if (!tracked && !rdram_written[i])
+         rdram_written[i] = memcmp(g_rdram + i*0x400, keyframes[0].rdram + i*0x400, 0x1000) != 0;
+      rdram_pages += rdram_written[i];
+   }
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+      lut_pages += tlb_LUT_dirty[i];
+
+   /* A queue that doesn't fit fails the save itself, count it as full. */
+   queuelength = save_eventqueue_infos(queue, sizeof(queue));
+   if (queuelength < 0)
+      queuelength = sizeof(queue);
+
+   return SAVESTATE_SIZE - RDRAM_MAX_SIZE - 2*sizeof(tlb_LUT_r)
+      + sizeof(uint32_t)                       /* keyframe hash */
+      + sizeof(uint32_t) + rdram_pages*(sizeof(uint32_t) + 0x1000)
+      + sizeof(uint32_t) + lut_pages*(sizeof(uint32_t) + 2*0x1000)
+      + queuelength;
+}
+
+static unsigned char* savestates_put_rdram_pages(unsigned char* curr)
+{
+   uint32_t count = 0;
+   int i;
+
+   for (i = 0; i < RDRAM_WATCH_PAGES; i++)
+      count += rdram_written[i];
+   PUTDATA(curr, uint32_t, count);
+
+   for (i = 0; i < RDRAM_WATCH_PAGES; i++)
+   {
+      if (!rdram_written[i])
+         continue;
+      PUTDATA(curr, uint32_t, i);
+      PUTARRAY(g_rdram + i*0x400, curr, uint32_t, 0x400);
+   }
+   return curr;
+}
+
+static unsigned char* savestates_put_tlb_LUT_pages(unsigned char* curr)
+{
+   uint32_t count = 0;
+   int i;
+
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+      count += tlb_LUT_dirty[i];
+   PUTDATA(curr, uint32_t, count);
+
+   for (i = 0; i < TLB_LUT_PAGES; i++)
+   {
+      if (!tlb_LUT_dirty[i])
+         continue;
+      PUTDATA(curr, uint32_t, i);
+      PUTARRAY(tlb_LUT_r + i*0x400, curr, uint32_t, 0x400);
+      PUTARRAY(tlb_LUT_w + i*0x400, curr, uint32_t, 0x400);
+   }
+   return curr;
+}
+
+/* The keyframe is already back in place, only the pages are left; they
+ * become the pages written since it. */
+static unsigned char* savestates_get_rdram_pages(unsigned char* curr)
+{
+   uint32_t count = GETDATA(curr, uint32_t);
+
+   while (count--)
+   {
+      uint32_t page = GETDATA(curr, uint32_t);
+
+      if (page >= RDRAM_WATCH_PAGES)
+         return NULL;
+      COPYARRAY(g_rdram + page*0x400, curr, uint32_t, 0x400);
+      rdram_written[page] = 1;
+   }
+   return curr;
+}
+
+static unsigned char* savestates_get_tlb_LUT_pages(unsigned char* curr)
+{
+   uint32_t count = GETDATA(curr, uint32_t);
+
+   while (count--)
+   {
+      uint32_t page = GETDATA(curr, uint32_t);
+
+      if (page >= TLB_LUT_PAGES)
+         return NULL;
+      COPYARRAY(tlb_LUT_r + page*0x400, curr, uint32_t, 0x400);
+      COPYARRAY(tlb_LUT_w + page*0x400, curr, uint32_t, 0x400);
+      tlb_LUT_dirty[page] = 1;
+   }
+   return curr;
+}
+
+size_t savestates_size_m64p(void)
+{
+   return SAVESTATE_SIZE + SAVESTATE_QUEUE_SIZE;
+}
+
+void savestates_set_delta_m64p(int enable)
+{
+   if (!enable)
+      savestates_drop_keyframes();
+   delta_enabled = enable;
+}
+
+void savestates_deinit_m64p(void)
+{
+   savestates_drop_keyframes();
+}
+
+size_t savestates_delta_size_m64p(void)
+{
+   size_t size;
+
+   if (!delta_enabled || keyframes[0].rdram == NULL)
+      return savestates_size_m64p();
+
+   size = savestates_scan_delta();
+   return (size <= SAVESTATE_DELTA_MAX) ? size : savestates_size_m64p();
+}
+
 int savestates_load_m64p(const unsigned char *data, size_t size)
 {
    unsigned char header[44], *curr;
-   char queue[1024];
+   char queue[SAVESTATE_QUEUE_SIZE];
    int version;
    int i;
+   int delta = 0;
+   int slot = 0;
+   int tracked;
+   const unsigned char* mark;
+   uint32_t base_hash = 0;
    uint32_t FCR31;
    uint32_t* cp0_regs = r4300_cp0_regs();
 
@@ -82,7 +384,9 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
    curr = (unsigned char*)data; // < HACK
 
    /* Read and check Mupen64Plus magic number. */
-   if(strncmp((char *)curr, savestate_magic, 8)!=0)
+   if(strncmp((char *)curr, savestate_delta_magic, 8)==0)
+      delta = 1;
+   else if(strncmp((char *)curr, savestate_magic, 8)!=0)
       return 0;
 
    curr += 8;
@@ -100,6 +404,25 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
 
    curr += 32;
 
+   if (delta)
+   {
+      base_hash = GETDATA(curr, uint32_t);
+      for (slot = 0; slot < SAVESTATE_KEYFRAMES; slot++)
+         if (keyframes[slot].rdram != NULL && keyframes[slot].hash == base_hash)
+            break;
+      if (slot == SAVESTATE_KEYFRAMES)
+      {
+         DebugMessage(M64MSG_ERROR, "Delta savestate belongs to a full state no longer kept.");
+         return 0;
+      }
+   }
+
+   /* RDRAM is written below, which must not fault. */
+   tracked = rdram_watch_armed();
+   rdram_watch_disarm();
+   if (delta)
+      savestates_restore_keyframe(slot, tracked);
+
    /* Parse savestate */
    g_ri.rdram.regs[RDRAM_CONFIG_REG] = GETDATA(curr, uint32_t);
    g_ri.rdram.regs[RDRAM_DEVICE_ID_REG] = GETDATA(curr, uint32_t);
@@ -217,7 +540,20 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
    g_dp.dps_regs[DPS_BUFTEST_ADDR_REG] = GETDATA(curr, uint32_t);
    g_dp.dps_regs[DPS_BUFTEST_DATA_REG] = GETDATA(curr, uint32_t);
 
-   COPYARRAY(g_rdram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+   if (delta)
+   {
+      if ((curr = savestates_get_rdram_pages(curr)) == NULL)
+      {
+         savestates_drop_keyframes();
+         return 0;
+      }
+   }
+   else
+   {
+      base_hash = savestates_hash(SAVESTATE_HASH_INIT, data, curr - data);
+      COPYARRAY(g_rdram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+   }
+   mark = curr;
    COPYARRAY(g_sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
    COPYARRAY(g_si.pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
@@ -227,8 +563,21 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
    g_pi.flashram.erase_offset = GETDATA(curr, unsigned int);
    g_pi.flashram.write_pointer = GETDATA(curr, unsigned int);
 
-   COPYARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
-   COPYARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+   if (delta)
+   {
+      if ((curr = savestates_get_tlb_LUT_pages(curr)) == NULL)
+      {
+         savestates_drop_keyframes();
+         return 0;
+      }
+   }
+   else
+   {
+      base_hash = savestates_hash(base_hash, mark, curr - mark);
+      COPYARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
+      COPYARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+   }
+   mark = curr;
 
    *r4300_llbit() = GETDATA(curr, unsigned int);
    COPYARRAY(r4300_regs(), curr, int64_t, 32);
@@ -283,12 +632,32 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
    g_vi.next_vi  = GETDATA(curr, unsigned int);
    g_vi.field    = GETDATA(curr, unsigned int);
 
-   memcpy(queue, curr, sizeof(queue));
+   if (!delta)
+      base_hash = savestates_hash(base_hash, mark, curr - mark);
+
+   /* Delta savestates end right after the queue. */
+   memset(queue, 0xFF, sizeof(queue));
+   if (delta && size - (size_t)(curr - data) < sizeof(queue))
+      memcpy(queue, curr, size - (curr - data));
+   else
+      memcpy(queue, curr, sizeof(queue));
    to_little_endian_buffer(queue, 4, 256);
    load_eventqueue_infos(queue);
 
    *r4300_last_addr() = *r4300_pc();
 
+   if (delta)
+   {
+      /* Its keyframe is the current one again. */
+      struct savestate_keyframe keyframe = keyframes[slot];
+
+      memmove(&keyframes[1], &keyframes[0], slot*sizeof(keyframe));
+      keyframes[0] = keyframe;
+      rdram_watch_arm();
+   }
+   else if (delta_enabled)
+      savestates_set_keyframe(base_hash);
+
    /* deliver callback to indicate 
     * completion of state loading operation */
    StateChanged(M64CORE_STATE_LOADCOMPLETE, 1);
@@ -296,21 +665,44 @@ int savestates_load_m64p(const unsigned char *data, size_t size)
    return 1;
 }
 
-int savestates_save_m64p(unsigned char *data, size_t size)
+static size_t savestates_save(unsigned char *data, size_t size, int delta)
 {
    unsigned char outbuf[4];
    int i, queuelength;
-   char queue[1024];
+   char queue[SAVESTATE_QUEUE_SIZE];
    uint32_t* cp0_regs = r4300_cp0_regs();
    unsigned char *curr = (unsigned char*)data;
+   unsigned char *mark;
+   uint32_t base_hash = 0;
+   int keyframe = 0;
 
    if (!curr)
       return 0;
 
-   queuelength = save_eventqueue_infos(queue);
+   if (delta)
+   {
+      /* A keyframe is due first, and again once deltas of the current one
+       * have grown past SAVESTATE_DELTA_MAX. */
+      if (keyframes[0].rdram == NULL)
+         keyframe = 1;
+      else
+      {
+         size_t delta_size = savestates_scan_delta();
+
+         if (delta_size > SAVESTATE_DELTA_MAX)
+            keyframe = 1;
+         else if (delta_size > size)
+            return 0;
+      }
+      delta = !keyframe;
+   }
+
+   queuelength = save_eventqueue_infos(queue, sizeof(queue));
+   if (queuelength < 0)
+      return 0;
 
    // Write the save state data to memory
-   PUTARRAY(savestate_magic, curr, unsigned char, 8);
+   PUTARRAY(delta ? savestate_delta_magic : savestate_magic, curr, unsigned char, 8);
 
    outbuf[0] = (savestate_latest_version >> 24) & 0xff;
    outbuf[1] = (savestate_latest_version >> 16) & 0xff;
@@ -320,6 +712,11 @@ int savestates_save_m64p(unsigned char *data, size_t size)
 
    PUTARRAY(ROM_SETTINGS.MD5, curr, char, 32);
 
+   if (delta)
+   {
+      PUTDATA(curr, uint32_t, keyframes[0].hash);
+   }
+
    PUTDATA(curr, uint32_t, g_ri.rdram.regs[RDRAM_CONFIG_REG]);
    PUTDATA(curr, uint32_t, g_ri.rdram.regs[RDRAM_DEVICE_ID_REG]);
    PUTDATA(curr, uint32_t, g_ri.rdram.regs[RDRAM_DELAY_REG]);
@@ -460,7 +857,14 @@ int savestates_save_m64p(unsigned char *data, size_t size)
    PUTDATA(curr, uint32_t, g_dp.dps_regs[DPS_BUFTEST_ADDR_REG]);
    PUTDATA(curr, uint32_t, g_dp.dps_regs[DPS_BUFTEST_DATA_REG]);
 
-   PUTARRAY(g_rdram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+   if (delta)
+      curr = savestates_put_rdram_pages(curr);
+   else
+   {
+      base_hash = savestates_hash(SAVESTATE_HASH_INIT, data, curr - data);
+      PUTARRAY(g_rdram, curr, uint32_t, RDRAM_MAX_SIZE/4);
+   }
+   mark = curr;
    PUTARRAY(g_sp.mem, curr, uint32_t, SP_MEM_SIZE/4);
    PUTARRAY(g_si.pif.ram, curr, uint8_t, PIF_RAM_SIZE);
 
@@ -470,8 +874,15 @@ int savestates_save_m64p(unsigned char *data, size_t size)
    PUTDATA(curr, unsigned int, g_pi.flashram.erase_offset);
    PUTDATA(curr, unsigned int, g_pi.flashram.write_pointer);
 
-   PUTARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
-   PUTARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+   if (delta)
+      curr = savestates_put_tlb_LUT_pages(curr);
+   else
+   {
+      base_hash = savestates_hash(base_hash, mark, curr - mark);
+      PUTARRAY(tlb_LUT_r, curr, unsigned int, 0x100000);
+      PUTARRAY(tlb_LUT_w, curr, unsigned int, 0x100000);
+   }
+   mark = curr;
 
    PUTDATA(curr, unsigned int, *r4300_llbit());
    PUTARRAY(r4300_regs(), curr, int64_t, 32);
@@ -520,6 +931,9 @@ int savestates_save_m64p(unsigned char *data, size_t size)
    PUTDATA(curr, unsigned int, g_vi.next_vi);
    PUTDATA(curr, unsigned int, g_vi.field);
 
+   if (keyframe)
+      savestates_set_keyframe(savestates_hash(base_hash, mark, curr - mark));
+
    to_little_endian_buffer(queue, 4, queuelength/4);
    PUTARRAY(queue, curr, char, queuelength);
 
@@ -527,5 +941,15 @@ int savestates_save_m64p(unsigned char *data, size_t size)
     * of state saving operation */
    StateChanged(M64CORE_STATE_SAVECOMPLETE, 1);
 
-   return 1;
+   return curr - data;
+}
+
+int savestates_save_m64p(unsigned char *data, size_t size)
+{
+   return savestates_save(data, size, 0) != 0;
+}
+
+size_t savestates_save_delta_m64p(unsigned char *data, size_t size)
+{
+   return savestates_save(data, size, delta_enabled);
 }
@@ -32,8 +32,25 @@ typedef enum _savestates_job
     savestates_job_save
 } savestates_job;
 
+/* Loads full and delta savestates alike. */
 int savestates_load_m64p(const unsigned char *data, size_t size);
 int savestates_save_m64p(unsigned char *data, size_t size);
+size_t savestates_size_m64p(void);
+
+/* Turns delta savestates on or off; off frees the keyframes they keep. */
+void savestates_set_delta_m64p(int enable);
+
+/* Saves only what changed since the current keyframe, or a new keyframe,
+ * a full savestate, when there is none yet or a delta would be too large.
+ * Each delta loads on its own as long as its keyframe is one of the last
+ * ones kept. Returns the number of bytes written, which
+ * savestates_delta_size_m64p() gives ahead of time, or 0 when it does not
+ * fit. With delta savestates off, this is a full savestate. */
+size_t savestates_save_delta_m64p(unsigned char *data, size_t size);
+size_t savestates_delta_size_m64p(void);
+
+/* Frees the keyframes of the delta savestates. */
+void savestates_deinit_m64p(void);
 
 
 #endif /* __SAVESTAVES_H__ */
@@ -0,0 +1,203 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rdram_watch.c                                           *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stddef.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#define RDRAM_WATCH_WIN32
+#elif defined(__GNUC__) && !defined(EMSCRIPTEN) && (defined(__unix__) || defined(__APPLE__))
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#define RDRAM_WATCH_POSIX
+#endif
+
+#include "rdram_watch.h"
+
+uint8_t rdram_written[RDRAM_WATCH_PAGES];
+
+static int armed;
+
+/* Where the fault handler could not be installed, or the host pages are not
+ * 4KB, or RDRAM is not page aligned:  arming fails for good. */
+static int unsupported;
+
+static int rdram_watch_fault(uintptr_t address)
+{
+   const uintptr_t offset = address - (uintptr_t)g_rdram;
+
+   if (!armed || offset >= RDRAM_MAX_SIZE)
+      return 0;
+
+   rdram_written[offset >> 12] = 1;
+   return 1;
+}
+
+#if defined(RDRAM_WATCH_WIN32)
+static PVOID handler;
+
+static int rdram_watch_protect(size_t first, size_t count, int writable)
+{
+   DWORD old;
+
+   return VirtualProtect((unsigned char*)g_rdram + (first << 12), count << 12,
+         writable ? PAGE_READWRITE : PAGE_READONLY, &old) != 0;
+}
+
+static LONG CALLBACK rdram_watch_handler(PEXCEPTION_POINTERS info)
+{
+   const EXCEPTION_RECORD* record = info->ExceptionRecord;
+
+   if (record->ExceptionCode != EXCEPTION_ACCESS_VIOLATION ||
+         record->NumberParameters < 2 || record->ExceptionInformation[0] != 1)
+      return EXCEPTION_CONTINUE_SEARCH;
+   if (!rdram_watch_fault(record->ExceptionInformation[1]))
+      return EXCEPTION_CONTINUE_SEARCH;
+   if (!rdram_watch_protect((record->ExceptionInformation[1] - (uintptr_t)g_rdram) >> 12, 1, 1))
+      return EXCEPTION_CONTINUE_SEARCH;
+   return EXCEPTION_CONTINUE_EXECUTION;
+}
+
+static int rdram_watch_install(void)
+{
+   SYSTEM_INFO system;
+
+   GetSystemInfo(&system);
+   if (system.dwPageSize != 0x1000)
+      return 0;
+   handler = AddVectoredExceptionHandler(1, rdram_watch_handler);
+   return handler != NULL;
+}
+#elif defined(RDRAM_WATCH_POSIX)
+static struct sigaction old_segv;
+static struct sigaction old_bus;
+
+static int rdram_watch_protect(size_t first, size_t count, int writable)
+{
+   return mprotect((unsigned char*)g_rdram + (first << 12), count << 12,
+         writable ? PROT_READ | PROT_WRITE : PROT_READ) == 0;
+}
+
+/* Write faults on RDRAM are ours; anything else goes to whatever handler
+ * was there before, or with none, faults again without this one. */
+static void rdram_watch_handler(int sig, siginfo_t* info, void* context)
+{
+   const struct sigaction* old = (sig == SIGBUS) ? &old_bus : &old_segv;
+   const uintptr_t address = (uintptr_t)info->si_addr;
+
+   if (rdram_watch_fault(address) &&
+         rdram_watch_protect((address - (uintptr_t)g_rdram) >> 12, 1, 1))
+      return;
+
+   if (old->sa_flags & SA_SIGINFO)
+      old->sa_sigaction(sig, info, context);
+   else if (old->sa_handler != SIG_DFL && old->sa_handler != SIG_IGN)
+      old->sa_handler(sig);
+   else
+      sigaction(sig, old, NULL);
+}
+
+static int rdram_watch_install(void)
+{
+   struct sigaction action;
+
+   if (sysconf(_SC_PAGESIZE) != 0x1000)
+      return 0;
+
+   memset(&action, 0, sizeof(action));
+   action.sa_sigaction = rdram_watch_handler;
+   action.sa_flags = SA_SIGINFO;
+   sigemptyset(&action.sa_mask);
+   if (sigaction(SIGSEGV, &action, &old_segv) != 0)
+      return 0;
+   /* Some hosts, macOS among them, raise SIGBUS for protection faults. */
+   if (sigaction(SIGBUS, &action, &old_bus) != 0)
+   {
+      sigaction(SIGSEGV, &old_segv, NULL);
+      return 0;
+   }
+   return 1;
+}
+#else
+static int rdram_watch_protect(size_t first, size_t count, int writable)
+{
+   (void)first;
+   (void)count;
+   (void)writable;
+   return 0;
+}
+
+static int rdram_watch_install(void)
+{
+   return 0;
+}
+#endif
+
+int rdram_watch_arm(void)
+{
+   static int installed;
+   size_t page, run;
+
+   if (armed)
+      rdram_watch_disarm();
+   if (unsupported)
+      return 0;
+   if (!installed)
+   {
+      if (((uintptr_t)g_rdram & 0xFFF) != 0 || !rdram_watch_install())
+      {
+         unsupported = 1;
+         return 0;
+      }
+      installed = 1;
+   }
+
+   armed = 1;
+   for (page = 0; page < RDRAM_WATCH_PAGES; page += run)
+   {
+      const uint8_t flag = rdram_written[page];
+
+      for (run = 1; page + run < RDRAM_WATCH_PAGES; run++)
+         if (rdram_written[page + run] != flag)
+            break;
+      if (!flag && !rdram_watch_protect(page, run, 0))
+      {
+         rdram_watch_disarm();
+         unsupported = 1;
+         return 0;
+      }
+   }
+   return 1;
+}
+
+void rdram_watch_disarm(void)
+{
+   if (!armed)
+      return;
+   rdram_watch_protect(0, RDRAM_WATCH_PAGES, 1);
+   armed = 0;
+}
+
+int rdram_watch_armed(void)
+{
+   return armed;
+}
@@ -0,0 +1,42 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - rdram_watch.h                                           *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MEMORY_RDRAM_WATCH_H
+#define M64P_MEMORY_RDRAM_WATCH_H
+
+#include <stdint.h>
+
+#include "main/main.h"
+
+/* Finds the 4KB pages of RDRAM that get written, whoever writes them: the
+ * interpreter, the dynarec's inline stores, DMA or the RSP and RDP plugins.
+ * While armed, every page whose flag is clear is read-only, and the first
+ * write to it sets the flag and makes it writable again. */
+#define RDRAM_WATCH_PAGES (RDRAM_MAX_SIZE / 0x1000)
+
+extern uint8_t rdram_written[RDRAM_WATCH_PAGES];
+
+/* Returns 0, and leaves RDRAM writable, where the host cannot trap writes
+ * to 4KB pages. The flags are then only what the caller sets itself. */
+int rdram_watch_arm(void);
+void rdram_watch_disarm(void);
+int rdram_watch_armed(void);
+
+#endif /* M64P_MEMORY_RDRAM_WATCH_H */
@@ -56,6 +56,34 @@ static void dma_pi_read(struct pi_controller *pi)
    add_interupt_event(PI_INT, 0x1000/* pi->regs[PI_RD_LEN_REG] */);
 }
 
+/* ROM and RDRAM are both kept as native-endian 32-bit words, so when the
+ * two addresses share their offset within a word, everything between the
+ * unaligned head and tail is a plain copy. */
+static void copy_rom_to_dram(uint8_t *dram, uint32_t dram_address,
+      const uint8_t *rom, uint32_t rom_address, uint32_t length)
+{
+   uint32_t i = 0;
+
+   if (((dram_address ^ rom_address) & 3) == 0)
+   {
+      uint32_t head = (4 - (dram_address & 3)) & 3;
+      uint32_t words;
+
+      if (head > length)
+         head = length;
+
+      for (; i < head; i++)
+         dram[(dram_address+i)^S8] = rom[(rom_address+i)^S8];
+
+      words = (length - head) & ~UINT32_C(3);
+      memcpy(dram + dram_address + head, rom + rom_address + head, words);
+      i += words;
+   }
+
+   for (; i < length; i++)
+      dram[(dram_address+i)^S8] = rom[(rom_address+i)^S8];
+}
+
 static void dma_pi_write(struct pi_controller *pi)
 {
    uint32_t longueur;
@@ -118,11 +146,9 @@ static void dma_pi_write(struct pi_controller *pi)
    dram = (uint8_t*)pi->ri->rdram.dram;
    rom = pi->cart_rom.rom;
 
-   for (i=0; i < longueur; i++)
-      dram[(dram_address+i)^S8] = rom[(rom_address+i)^S8];
+   copy_rom_to_dram(dram, dram_address, rom, rom_address, longueur);
 
-   invalidate_r4300_cached_code(0x80000000 + dram_address, longueur);
-   invalidate_r4300_cached_code(0xa0000000 + dram_address, longueur);
+   invalidate_r4300_cached_rdram(dram_address, longueur);
 
    /* HACK: monitor PI DMA to trigger RDRAM size detection
     * hack just before initial cart ROM loading. */
@@ -0,0 +1,271 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profile.c                                         *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if defined(PROFILE_BLOCKS)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "block_profile.h"
+#include "cp0_private.h"
+#include "interupt.h"
+#include "r4300.h"
+#include "new_dynarec/new_dynarec.h"
+
+#include "api/m64p_types.h"
+#include "api/callbacks.h"
+
+/* at most this many cycles between two samples */
+#ifndef PROFILE_BLOCKS_PERIOD
+#define PROFILE_BLOCKS_PERIOD 2000
+#endif
+
+#define PROFILE_BLOCKS_FILE "r4300_blocks.txt"
+
+/* open addressing on the PC, sized for a few thousand sampled blocks */
+#define SLOT_BITS   15
+#define SLOTS       (1 << SLOT_BITS)
+#define MAX_USED    (SLOTS / 4 * 3)
+#define EMPTY_PC    UINT32_C(0xffffffff)
+
+struct block_stats
+{
+   uint32_t pc;
+   uint32_t samples;
+   uint64_t cycles;
+   long long int time;
+};
+
+static struct block_stats slots[SLOTS];
+static unsigned int used;
+
+/* samples that found the table full */
+static struct block_stats others;
+
+static uint32_t last_count;
+static long long int last_leave;
+
+#if defined(WIN32) && !defined(__MINGW32__)
+  // timing
+  #include <windows.h>
+  static long long int get_time(void)
+  {
+      LARGE_INTEGER counter;
+      QueryPerformanceCounter(&counter);
+      return counter.QuadPart;
+  }
+  static long long int time_to_nsec(long long int time)
+  {
+      static LARGE_INTEGER freq = { 0 };
+      if (freq.QuadPart == 0)
+          QueryPerformanceFrequency(&freq);
+      return time * 1000000000 / freq.QuadPart;
+  }
+
+#else  /* Not WIN32 */
+  // timing
+  #include <time.h>
+  static long long int get_time(void)
+  {
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (long long int)ts.tv_sec * 1000000000 + ts.tv_nsec;
+  }
+  static long long int time_to_nsec(long long int time)
+  {
+      return time;
+  }
+#endif
+
+static uint32_t current_pc(void)
+{
+#ifdef NEW_DYNAREC
+   if (r4300emu == CORE_DYNAREC)
+      return (uint32_t)pcaddr;
+#endif
+   return PC->addr;
+}
+
+static struct block_stats *find_block(uint32_t pc)
+{
+   uint32_t i = ((pc >> 2) * UINT32_C(0x9E3779B1)) >> (32 - SLOT_BITS);
+
+   while (slots[i].pc != pc)
+   {
+      if (slots[i].pc == EMPTY_PC)
+      {
+         if (used >= MAX_USED)
+            return &others;
+
+         ++used;
+         slots[i].pc = pc;
+         break;
+      }
+
+      i = (i + 1) & (SLOTS - 1);
+   }
+
+   return &slots[i];
+}
+
+void block_profile_init(void)
+{
+   unsigned int i;
+
+   memset(slots, 0, sizeof(slots));
+   memset(&others, 0, sizeof(others));
+   for (i = 0; i < SLOTS; ++i)
+      slots[i].pc = EMPTY_PC;
+   used = 0;
+
+   last_count = g_cp0_regs[CP0_COUNT_REG];
+   last_leave = get_time();
+}
+
+void block_profile_schedule(void)
+{
+   add_interupt_event(PROFILE_INT, PROFILE_BLOCKS_PERIOD);
+}
+
+void block_profile_enter(void)
+{
+   struct block_stats *block = find_block(current_pc());
+   uint32_t cycles = g_cp0_regs[CP0_COUNT_REG] - last_count;
+
+   /* Count was written or reset */
+   if (cycles >= UINT32_C(0x80000000))
+      cycles = 0;
+
+   ++block->samples;
+   block->cycles += cycles;
+   block->time += get_time() - last_leave;
+}
+
+void block_profile_leave(void)
+{
+   last_count = g_cp0_regs[CP0_COUNT_REG];
+   last_leave = get_time();
+}
+
+static int compare_blocks(const void *b1, const void *b2)
+{
+   const struct block_stats *x = *(const struct block_stats* const*)b1;
+   const struct block_stats *y = *(const struct block_stats* const*)b2;
+
+   if (x->cycles != y->cycles)
+      return (x->cycles < y->cycles) ? 1 : -1;
+
+   return (x->pc < y->pc) ? -1 : (x->pc > y->pc);
+}
+
+static const char *core_name(void)
+{
+   switch (r4300emu)
+   {
+      case CORE_PURE_INTERPRETER:
+         return "pure interpreter";
+      case CORE_INTERPRETER:
+         return "cached interpreter";
+      default:
+#ifdef NEW_DYNAREC
+         return "new dynarec";
+#else
+         return "dynarec";
+#endif
+   }
+}
+
+void block_profile_report(void)
+{
+   struct block_stats **sorted;
+   uint64_t total_cycles = others.cycles;
+   long long int total_time = others.time;
+   uint64_t cumulated = 0;
+   unsigned int n = 0;
+   unsigned int i;
+   FILE *f;
+
+   sorted = (struct block_stats**)malloc((used + 1) * sizeof(*sorted));
+   if (sorted == NULL)
+      return;
+
+   for (i = 0; i < SLOTS; ++i)
+   {
+      if (slots[i].pc == EMPTY_PC)
+         continue;
+
+      sorted[n++] = &slots[i];
+      total_cycles += slots[i].cycles;
+      total_time += slots[i].time;
+   }
+   qsort(sorted, n, sizeof(*sorted), compare_blocks);
+
+   if (others.samples != 0)
+      sorted[n++] = &others;
+
+   if (total_cycles == 0)
+      total_cycles = 1;
+   if (total_time == 0)
+      total_time = 1;
+
+   f = fopen(PROFILE_BLOCKS_FILE, "w");
+   if (f == NULL)
+   {
+      DebugMessage(M64MSG_ERROR, "Couldn't open %s for writing", PROFILE_BLOCKS_FILE);
+      free(sorted);
+      return;
+   }
+
+   fprintf(f, "# %s, one sample at least every %u cycles\n", core_name(), PROFILE_BLOCKS_PERIOD);
+   fprintf(f, "# cycles are Count ticks, two PClock cycles each\n");
+   fprintf(f, "# %-10s %10s %14s %7s %7s %12s %7s\n",
+         "pc", "samples", "cycles", "%", "cum%", "host_us", "%");
+
+   for (i = 0; i < n; ++i)
+   {
+      const struct block_stats *block = sorted[i];
+      char pc[16];
+
+      if (block == &others)
+         strcpy(pc, "(others)");
+      else
+         sprintf(pc, "%08x", (unsigned int)block->pc);
+
+      cumulated += block->cycles;
+      fprintf(f, "  %-10s %10u %14llu %7.2f %7.2f %12lld %7.2f\n",
+            pc, (unsigned int)block->samples, (unsigned long long)block->cycles,
+            100.0 * block->cycles / total_cycles,
+            100.0 * cumulated / total_cycles,
+            time_to_nsec(block->time) / 1000,
+            100.0 * block->time / total_time);
+
+      if (i < 10)
+         DebugMessage(M64MSG_INFO, "block %s: %.2f%% of cycles, %.2f%% of host time",
+               pc, 100.0 * block->cycles / total_cycles, 100.0 * block->time / total_time);
+   }
+
+   fclose(f);
+   free(sorted);
+   DebugMessage(M64MSG_INFO, "Block profile written to %s", PROFILE_BLOCKS_FILE);
+}
+
+#endif
@@ -0,0 +1,53 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - block_profile.h                                         *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_BLOCK_PROFILE_H
+#define M64P_R4300_BLOCK_PROFILE_H
+
+/* Sampling profiler for guest code, built with PROFILE_BLOCKS.
+ *
+ * All the cores call gen_interupt() at the first jump once Count reaches
+ * the next event, with the PC on the jump target. Each call is a sample:
+ * the cycles and the host time spent running guest code since the previous
+ * one are charged to that PC, so a loop shows up at its head. A PROFILE_INT
+ * event keeps samples at most PROFILE_BLOCKS_PERIOD cycles apart.
+ *
+ * Host time leaves out gen_interupt() itself, where the RSP, the RDP and
+ * the frontend run, but not the plugin calls made by guest memory
+ * accesses.
+ *
+ * The report is sorted by cycles and written to r4300_blocks.txt when
+ * the core stops. */
+
+#if defined(PROFILE_BLOCKS)
+  void block_profile_init(void);
+  void block_profile_schedule(void);
+  void block_profile_enter(void);
+  void block_profile_leave(void);
+  void block_profile_report(void);
+#else
+  #define block_profile_init()
+  #define block_profile_schedule()
+  #define block_profile_enter()
+  #define block_profile_leave()
+  #define block_profile_report()
+#endif
+
+#endif /* M64P_R4300_BLOCK_PROFILE_H */
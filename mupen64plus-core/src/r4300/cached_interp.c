@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "cached_interp.h"
+#include "code_arena.h"
 
 #include "api/m64p_types.h"
 #include "api/callbacks.h"
@@ -541,6 +542,15 @@ void jump_to_func(void)
    if (skip_jump) return;
    paddr = update_invalid_addr(addr);
    if (!paddr) return;
+
+   /* start over once the code arena runs low; whatever code called this
+    * is never returned to, dyna_jump() below sends it to the new block */
+   if (r4300emu == CORE_DYNAREC && code_arena_is_full())
+   {
+      free_blocks();
+      init_blocks();
+   }
+
    actual = blocks[addr>>12];
    if (invalid_code[addr>>12])
    {
@@ -585,6 +595,8 @@ void free_blocks(void)
          blocks[i] = NULL;
       }
    }
+
+   code_arena_reset();
 }
 
 void invalidate_cached_code_hacktarux(uint32_t address, size_t size)
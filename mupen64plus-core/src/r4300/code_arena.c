@@ -0,0 +1,270 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - code_arena.c                                            *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#elif defined(__GNUC__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "api/m64p_types.h"
+#include "api/callbacks.h"
+
+#include "code_arena.h"
+
+/* Every compiled page takes a few hundred kilobytes, most of it for its
+ * precomp_instr array, so this is room for a thousand pages or so on
+ * 64-bit hosts. The memory is only committed as it gets used. */
+#ifndef CODE_ARENA_SIZE
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__)
+#define CODE_ARENA_SIZE ((size_t)512 << 20)
+#else
+#define CODE_ARENA_SIZE ((size_t)128 << 20)
+#endif
+#endif
+
+/* Past this, the arena is emptied at the next jump_to(). What gets
+ * allocated until then is a block being compiled, plus the pages
+ * init_block() pulls in with it, far less than this. */
+#define CODE_ARENA_HIGH_WATER (CODE_ARENA_SIZE - CODE_ARENA_SIZE / 8)
+
+#define CODE_ARENA_ALIGN 64
+
+uintptr_t code_arena_rw_offset = 0;
+
+static unsigned char *arena;
+static unsigned char *arena_rw;
+static size_t top;
+static size_t latest;
+
+#if defined(WIN32)
+static size_t committed;
+#elif defined(__GNUC__)
+static int arena_fd = -1;
+
+#ifndef MAP_ANONYMOUS
+#ifdef MAP_ANON
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+/* maps a memfd twice, or fails without leaving anything behind */
+static int map_dual_views(void)
+{
+   void *rw, *rx;
+   int fd = (int)syscall(SYS_memfd_create, "mupen64plus-dynarec", 1 /* MFD_CLOEXEC */);
+
+   if (fd < 0)
+      return 0;
+
+   if (ftruncate(fd, (off_t)CODE_ARENA_SIZE) != 0)
+   {
+      close(fd);
+      return 0;
+   }
+
+   rw = mmap(NULL, CODE_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (rw == MAP_FAILED)
+   {
+      close(fd);
+      return 0;
+   }
+
+   rx = mmap(NULL, CODE_ARENA_SIZE, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+   if (rx == MAP_FAILED)
+   {
+      munmap(rw, CODE_ARENA_SIZE);
+      close(fd);
+      return 0;
+   }
+
+   arena_fd = fd;
+   arena = (unsigned char*)rx;
+   arena_rw = (unsigned char*)rw;
+   return 1;
+}
+#endif
+#endif
+
+int code_arena_init(void)
+{
+   if (arena != NULL)
+      code_arena_release();
+
+#if defined(WIN32)
+   arena = (unsigned char*)VirtualAlloc(NULL, CODE_ARENA_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+   arena_rw = arena;
+   committed = 0;
+#elif defined(__GNUC__)
+#if defined(__linux__) && defined(SYS_memfd_create)
+   if (!map_dual_views())
+#endif
+   {
+      void *block = mmap(NULL, CODE_ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      arena = (block == MAP_FAILED) ? NULL : (unsigned char*)block;
+      arena_rw = arena;
+   }
+#else
+   arena = (unsigned char*)malloc(CODE_ARENA_SIZE);
+   arena_rw = arena;
+#endif
+
+   if (arena == NULL)
+   {
+      DebugMessage(M64MSG_ERROR, "Memory error: couldn't reserve %u MB of executable memory for dynamic recompiler, falling back to the cached interpreter.",
+            (unsigned int)(CODE_ARENA_SIZE >> 20));
+      return 0;
+   }
+
+   code_arena_rw_offset = (uintptr_t)arena_rw - (uintptr_t)arena;
+   top = 0;
+   latest = 0;
+
+   DebugMessage(M64MSG_VERBOSE, "Dynarec code arena: %u MB, %s", (unsigned int)(CODE_ARENA_SIZE >> 20),
+         (arena_rw != arena) ? "separate writable and executable views" : "writable and executable");
+   return 1;
+}
+
+void code_arena_release(void)
+{
+   if (arena == NULL)
+      return;
+
+#if defined(WIN32)
+   VirtualFree(arena, 0, MEM_RELEASE);
+#elif defined(__GNUC__)
+   if (arena_rw != arena)
+      munmap(arena_rw, CODE_ARENA_SIZE);
+   munmap(arena, CODE_ARENA_SIZE);
+   if (arena_fd >= 0)
+      close(arena_fd);
+   arena_fd = -1;
+#else
+   free(arena);
+#endif
+
+   arena = NULL;
+   arena_rw = NULL;
+   code_arena_rw_offset = 0;
+}
+
+void *code_arena_alloc(size_t size)
+{
+   size_t end;
+
+   size = (size + CODE_ARENA_ALIGN - 1) & ~(size_t)(CODE_ARENA_ALIGN - 1);
+   end = top + size;
+
+   if (arena == NULL || end > CODE_ARENA_SIZE)
+   {
+      DebugMessage(M64MSG_ERROR, "Memory error: dynamic recompiler code arena exhausted (%u byte block).", (unsigned int)size);
+      return NULL;
+   }
+
+#if defined(WIN32)
+   if (end > committed)
+   {
+      if (VirtualAlloc(arena + committed, end - committed, MEM_COMMIT, PAGE_EXECUTE_READWRITE) == NULL)
+      {
+         DebugMessage(M64MSG_ERROR, "Memory error: couldn't commit %u bytes of executable memory.", (unsigned int)(end - committed));
+         return NULL;
+      }
+      committed = end;
+   }
+#endif
+
+   latest = top;
+   top = end;
+   return arena + latest;
+}
+
+void *code_arena_realloc(void *ptr, size_t old_size, size_t new_size)
+{
+   void *block;
+
+   /* the latest allocation just grows in place */
+   if ((unsigned char*)ptr == arena + latest && latest + new_size <= CODE_ARENA_SIZE)
+   {
+      size_t old_top = top;
+
+      top = latest;
+      block = code_arena_alloc(new_size);
+      if (block == NULL)
+         top = old_top;
+      return block;
+   }
+
+   /* like realloc(), the old block stays if there is no room */
+   block = code_arena_alloc(new_size);
+   if (block == NULL)
+      return NULL;
+
+   memcpy(CODE_ARENA_RW(block), ptr, (old_size < new_size) ? old_size : new_size);
+   code_arena_free(ptr, old_size);
+   return block;
+}
+
+void code_arena_free(void *ptr, size_t size)
+{
+   (void)size;
+
+   /* anything else waits for the arena to be emptied */
+   if (ptr != NULL && (unsigned char*)ptr == arena + latest)
+      top = latest;
+}
+
+int code_arena_is_full(void)
+{
+   return top > CODE_ARENA_HIGH_WATER;
+}
+
+void code_arena_reset(void)
+{
+   if (arena == NULL)
+      return;
+
+   /* give the pages back, they are zeroed when touched again */
+#if defined(WIN32)
+   if (committed != 0)
+      VirtualFree(arena, committed, MEM_DECOMMIT);
+   committed = 0;
+#elif defined(__GNUC__) && defined(MADV_REMOVE)
+   if (arena_fd >= 0)
+      madvise(arena_rw, top, MADV_REMOVE);
+   else
+      madvise(arena, top, MADV_DONTNEED);
+#endif
+
+   top = 0;
+   latest = 0;
+}
@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - code_arena.h                                            *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_CODE_ARENA_H
+#define M64P_R4300_CODE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Executable memory for the dynarec.
+ *
+ * The arena is reserved once when the dynarec starts and handed out one
+ * allocation after the other. Nothing goes back to it but the latest
+ * allocation; it is emptied as a whole, by free_blocks(), which the next
+ * jump_to() calls once the arena is past its high-water mark.
+ *
+ * On Linux the arena is a memfd mapped twice: read-write for the
+ * emitter, read-execute for running the code, so that no page is ever
+ * writable and executable at once. The arena hands out executable
+ * addresses. Anything written to goes through CODE_ARENA_RW(), and
+ * CODE_ARENA_RX() maps a writable address back. Elsewhere, or without
+ * memfd, both views are one RWX mapping and the macros change nothing. */
+
+extern uintptr_t code_arena_rw_offset;
+
+#define CODE_ARENA_RW(p) ((unsigned char*)((uintptr_t)(p) + code_arena_rw_offset))
+#define CODE_ARENA_RX(p) ((unsigned char*)((uintptr_t)(p) - code_arena_rw_offset))
+
+int code_arena_init(void);
+void code_arena_release(void);
+
+void *code_arena_alloc(size_t size);
+void *code_arena_realloc(void *ptr, size_t old_size, size_t new_size);
+void code_arena_free(void *ptr, size_t size);
+
+int code_arena_is_full(void);
+void code_arena_reset(void);
+
+#endif /* M64P_R4300_CODE_ARENA_H */
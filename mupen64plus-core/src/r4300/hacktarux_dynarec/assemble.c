@@ -154,17 +154,17 @@ void passe2(precomp_instr *dest, int start, int end, precomp_block *block)
       unsigned char *addr_dest = NULL;
       /* calculate the destination address to jump to */
       if (jump_instr->reg_cache_infos.need_map)
-         addr_dest = jump_instr->reg_cache_infos.jump_wrapper;
+         addr_dest = CODE_ARENA_RX(jump_instr->reg_cache_infos.jump_wrapper);
       else
          addr_dest = block->code + jump_instr->local_addr;
 
       /* write either a 32-bit IP-relative offset or a 64-bit absolute address */
       if (jumps_table[i].absolute64)
-         *((uint64_t *) (block->code + jmp_offset_loc)) = (uint64_t)addr_dest;
+         *((uint64_t *) CODE_ARENA_RW(block->code + jmp_offset_loc)) = (uint64_t)addr_dest;
       else
       {
          long jump_rel_offset = (long) (addr_dest - (block->code + jmp_offset_loc + 4));
-         *((int *) (block->code + jmp_offset_loc)) = (int) jump_rel_offset;
+         *((int *) CODE_ARENA_RW(block->code + jmp_offset_loc)) = (int) jump_rel_offset;
          if (jump_rel_offset >= 0x7fffffffLL || jump_rel_offset < -0x80000000LL)
          {
             DebugMessage(M64MSG_ERROR, "assembler pass2 error: offset too big for relative jump from %p to %p",
@@ -192,7 +192,7 @@ void passe2(precomp_instr *dest, int start, int end, precomp_block *block)
          asm(" int $3; ");
 #endif
       }
-      *((int *) rel_offset_ptr) = (int) rip_rel_offset;
+      *((int *) CODE_ARENA_RW(rel_offset_ptr)) = (int) rip_rel_offset;
    }
 #else
 
@@ -203,7 +203,7 @@ void passe2(precomp_instr *dest, int start, int end, precomp_block *block)
       code_length = jumps_table[i].pc_addr;
       if (dest[(jumps_table[i].mi_addr - dest[0].addr)/4].reg_cache_infos.need_map)
       {
-         addr_dest = (unsigned int)dest[(jumps_table[i].mi_addr - dest[0].addr)/4].reg_cache_infos.jump_wrapper;
+         addr_dest = (unsigned int)CODE_ARENA_RX(dest[(jumps_table[i].mi_addr - dest[0].addr)/4].reg_cache_infos.jump_wrapper);
          put32(addr_dest-((unsigned int)block->code+code_length)-4);
       }
       else
@@ -23,6 +23,7 @@
 #ifndef __ASSEMBLE_H__
 #define __ASSEMBLE_H__
 
+#include "r4300/code_arena.h"
 #include "r4300/recomph.h"
 #include "api/callbacks.h"
 #include "osal/preproc.h"
@@ -86,7 +87,7 @@ void add_jump(unsigned int pc_addr, unsigned int mi_addr, unsigned int absolute6
 
 static INLINE void put8(unsigned char octet)
 {
-   (*inst_pointer)[code_length] = octet;
+   CODE_ARENA_RW(*inst_pointer)[code_length] = octet;
    code_length++;
    if (code_length == max_code_length)
    {
@@ -102,7 +103,7 @@ static INLINE void put32(unsigned int dword)
       *inst_pointer = (unsigned char*)realloc_exec(*inst_pointer, max_code_length, max_code_length+8192);
       max_code_length += 8192;
    }
-   *((unsigned int *) (*inst_pointer + code_length)) = dword;
+   *((unsigned int *) (CODE_ARENA_RW(*inst_pointer) + code_length)) = dword;
    code_length += 4;
 }
 
@@ -113,7 +114,7 @@ static INLINE void put64(unsigned long long qword)
       *inst_pointer = realloc_exec(*inst_pointer, max_code_length, max_code_length+8192);
       max_code_length += 8192;
    }
-   *((unsigned long long *) (*inst_pointer + code_length)) = qword;
+   *((unsigned long long *) (CODE_ARENA_RW(*inst_pointer) + code_length)) = qword;
    code_length += 8;
 }
 
@@ -240,7 +240,7 @@ void genjr(void)
 
    jump_end_rel32();
 
-   mov_reg64_imm64(RSI, (unsigned long long) dst_block->block);
+   mov_reg64_imm64(RSI, (unsigned long long) CODE_ARENA_RX(dst_block->block));
    mov_reg32_reg32(EAX, EBX);
    sub_eax_imm32(dst_block->start);
    shr_reg32_imm8(EAX, 2);
@@ -306,14 +306,14 @@ void genjr(void)
    shr_reg32_imm8(EAX, 2);
    mul_m32((unsigned int *)(&precomp_instr_size));
 
-   mov_reg32_preg32pimm32(EBX, EAX, (unsigned int)(dst_block->block)+diff_need);
+   mov_reg32_preg32pimm32(EBX, EAX, (unsigned int)CODE_ARENA_RX(dst_block->block)+diff_need);
    cmp_reg32_imm32(EBX, 1);
    jne_rj(7);
 
-   add_eax_imm32((unsigned int)(dst_block->block)+diff_wrap); // 5
+   add_eax_imm32((unsigned int)CODE_ARENA_RX(dst_block->block)+diff_wrap); // 5
    jmp_reg32(EAX); // 2
 
-   mov_reg32_preg32pimm32(EAX, EAX, (unsigned int)(dst_block->block)+diff);
+   mov_reg32_preg32pimm32(EAX, EAX, (unsigned int)CODE_ARENA_RX(dst_block->block)+diff);
    add_reg32_m32(EAX, (unsigned int *)(&dst_block->code));
 
    jmp_reg32(EAX);
@@ -373,7 +373,7 @@ void genjalr(void)
 
    jump_end_rel32();
 
-   mov_reg64_imm64(RSI, (unsigned long long) dst_block->block);
+   mov_reg64_imm64(RSI, (unsigned long long) CODE_ARENA_RX(dst_block->block));
    mov_reg32_reg32(EAX, EBX);
    sub_eax_imm32(dst_block->start);
    shr_reg32_imm8(EAX, 2);
@@ -445,14 +445,14 @@ void genjalr(void)
    shr_reg32_imm8(EAX, 2);
    mul_m32((unsigned int *)(&precomp_instr_size));
 
-   mov_reg32_preg32pimm32(EBX, EAX, (unsigned int)(dst_block->block)+diff_need);
+   mov_reg32_preg32pimm32(EBX, EAX, (unsigned int)CODE_ARENA_RX(dst_block->block)+diff_need);
    cmp_reg32_imm32(EBX, 1);
    jne_rj(7);
 
-   add_eax_imm32((unsigned int)(dst_block->block)+diff_wrap); // 5
+   add_eax_imm32((unsigned int)CODE_ARENA_RX(dst_block->block)+diff_wrap); // 5
    jmp_reg32(EAX); // 2
 
-   mov_reg32_preg32pimm32(EAX, EAX, (unsigned int)(dst_block->block)+diff);
+   mov_reg32_preg32pimm32(EAX, EAX, (unsigned int)CODE_ARENA_RX(dst_block->block)+diff);
    add_reg32_m32(EAX, (unsigned int *)(&dst_block->code));
 
    jmp_reg32(EAX);
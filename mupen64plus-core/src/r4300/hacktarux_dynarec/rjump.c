@@ -64,7 +64,7 @@ void dyna_jump(void)
     }
 
     if (PC->reg_cache_infos.need_map)
-        *return_address = (native_type)(PC->reg_cache_infos.jump_wrapper);
+        *return_address = (native_type)CODE_ARENA_RX(PC->reg_cache_infos.jump_wrapper);
     else
         *return_address = (native_type)(actual->code + PC->local_addr);
 }
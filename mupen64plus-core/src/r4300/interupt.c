@@ -22,6 +22,7 @@
 #define M64P_CORE_PROTOTYPES 1
 
 #include "interupt.h"
+#include "block_profile.h"
 #include "cached_interp.h"
 #include "cp0_private.h"
 #include "exception.h"
@@ -43,279 +44,344 @@
 
 #include <boolean.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 extern int retro_return(bool just_flipping);
 
 int interupt_unsafe_state = 0;
 
+/***************************************************************************
+ * Interrupt Queue
+ *
+ * The pending events are kept in a binary min-heap, so adding an event,
+ * removing one by type and popping the next one are all O(log n), and the
+ * queue grows as needed instead of living in a fixed pool.
+ *
+ * The heap is ordered on a 64-bit key, the absolute time of the event on a
+ * clock that keeps running when the 32-bit Count register wraps around.
+ * Events with the same key come out in the order they were added, except
+ * CHECK_INT which always goes in front, as it did with the sorted list.
+ **************************************************************************/
+
 struct interrupt_event
 {
    int type;
    unsigned int count;
+   int64_t key;
+   int64_t seq;
 };
 
+/* one heap slot per event type, CHECK_INT aside which may be queued twice */
+#define EVENT_TYPES 12
 
-/***************************************************************************
- * Pool of Single Linked List Nodes
- **************************************************************************/
-#define POOL_CAPACITY 16
-
-struct node
+struct interrupt_queue
 {
-   struct interrupt_event data;
-   struct node *next;
+   struct interrupt_event *events;
+   size_t size;
+   size_t capacity;
+   int slot[EVENT_TYPES];
+
+   /* Count extended to 64 bits, as of the last queue operation */
+   int64_t clock;
+   uint32_t last_count;
+
+   int64_t back_seq;
+   int64_t front_seq;
 };
 
-struct pool
+static struct interrupt_queue q;
+
+static int event_slot(int type)
 {
-   struct node nodes  [POOL_CAPACITY];
-   struct node *stack [POOL_CAPACITY];
-   size_t index;
-};
+   int i;
 
-static struct node* alloc_node(struct pool* p);
-static void free_node(struct pool* p, struct node* node);
-static void clear_pool(struct pool* p);
+   if (type == CHECK_INT)
+      return -1;
 
+   for (i = 0; i < EVENT_TYPES; ++i)
+      if (type == (1 << i))
+         return i;
 
-/* node allocation/deallocation on a given pool */
-static struct node* alloc_node(struct pool* p)
+   return -1;
+}
+
+static int event_before(const struct interrupt_event *e1, const struct interrupt_event *e2)
 {
-   /* return NULL if pool is too small */
-   if (p->index >= POOL_CAPACITY)
-      return NULL;
+   if (e1->key != e2->key)
+      return e1->key < e2->key;
 
-   return p->stack[p->index++];
+   return e1->seq < e2->seq;
 }
 
-static void free_node(struct pool *p, struct node *node)
+static void set_event(size_t i, const struct interrupt_event *e)
 {
-   if (p->index == 0 || node == NULL)
-      return;
+   int s = event_slot(e->type);
 
-   p->stack[--p->index] = node;
+   q.events[i] = *e;
+   if (s >= 0)
+      q.slot[s] = (int)i;
 }
 
-/* release all nodes */
-static void clear_pool(struct pool *p)
+static void sift_up(size_t i)
 {
-   size_t i;
+   struct interrupt_event e = q.events[i];
 
-   for(i = 0; i < POOL_CAPACITY; ++i)
-      p->stack[i] = &p->nodes[i];
+   while (i > 0 && event_before(&e, &q.events[(i - 1) / 2]))
+   {
+      set_event(i, &q.events[(i - 1) / 2]);
+      i = (i - 1) / 2;
+   }
 
-   p->index = 0;
+   set_event(i, &e);
 }
 
-/***************************************************************************
- * Interrupt Queue
- **************************************************************************/
-
-struct interrupt_queue
+static void sift_down(size_t i)
 {
-   struct pool pool;
-   struct node *first;
-};
+   struct interrupt_event e = q.events[i];
 
-static struct interrupt_queue q;
+   for (;;)
+   {
+      size_t child = 2 * i + 1;
 
-static void clear_queue(void)
-{
-   q.first = NULL;
-   clear_pool(&q.pool);
+      if (child >= q.size)
+         break;
+      if (child + 1 < q.size && event_before(&q.events[child + 1], &q.events[child]))
+         ++child;
+      if (!event_before(&q.events[child], &e))
+         break;
+
+      set_event(i, &q.events[child]);
+      i = child;
+   }
+
+   set_event(i, &e);
 }
 
-static int SPECIAL_done = 0;
+static void remove_at(size_t i)
+{
+   int s = event_slot(q.events[i].type);
+
+   if (s >= 0)
+      q.slot[s] = -1;
 
-static int before_event(unsigned int evt1, unsigned int evt2, int type2)
+   if (--q.size == i)
+      return;
+
+   set_event(i, &q.events[q.size]);
+   if (i > 0 && event_before(&q.events[i], &q.events[(i - 1) / 2]))
+      sift_up(i);
+   else
+      sift_down(i);
+}
+
+static int push_event(struct interrupt_event *e)
 {
-   if(evt1 - g_cp0_regs[CP0_COUNT_REG] < UINT32_C(0x80000000))
+   if (q.size == q.capacity)
    {
-      if(evt2 - g_cp0_regs[CP0_COUNT_REG] < UINT32_C(0x80000000))
-      {
-         if((evt1 - g_cp0_regs[CP0_COUNT_REG]) < (evt2 - g_cp0_regs[CP0_COUNT_REG])) return 1;
-         else return 0;
-      }
-      else
-      {
-         if((g_cp0_regs[CP0_COUNT_REG] - evt2) < UINT32_C(0x10000000))
-         {
-            switch(type2)
-            {
-               case SPECIAL_INT:
-                  if(SPECIAL_done) return 1;
-                  else return 0;
-                  break;
-               default:
-                  return 0;
-            }
-         }
-         else return 1;
-      }
+      size_t capacity = (q.capacity == 0) ? 16 : 2 * q.capacity;
+      struct interrupt_event *events = (struct interrupt_event*)
+         realloc(q.events, capacity * sizeof(*events));
+
+      if (events == NULL)
+         return 0;
+
+      q.events = events;
+      q.capacity = capacity;
    }
-   else return 0;
+
+   q.events[q.size++] = *e;
+   sift_up(q.size - 1);
+   return 1;
 }
 
-void add_interupt_event(int type, unsigned int delay)
+/* bring the 64-bit clock up to date with Count (or with the value about to
+ * be written to it) */
+static void advance_clock(uint32_t now)
 {
-   add_interupt_event_count(type, g_cp0_regs[CP0_COUNT_REG] + delay);
+   q.clock += (uint32_t)(now - q.last_count);
+   q.last_count = now;
 }
 
-void add_interupt_event_count(int type, unsigned count)
+static void clear_queue(void)
 {
-   struct node *event = NULL;
-   struct node *e = NULL;
-   int special;
+   int i;
 
-   special = (type == SPECIAL_INT);
+   q.size = 0;
+   for (i = 0; i < EVENT_TYPES; ++i)
+      q.slot[i] = -1;
 
-   if(g_cp0_regs[CP0_COUNT_REG] > UINT32_C(0x80000000))
-      SPECIAL_done = 0;
+   q.clock = 0;
+   q.last_count = g_cp0_regs[CP0_COUNT_REG];
+   q.back_seq = 0;
+   q.front_seq = 0;
+}
 
-   if (get_event(type))
+/* An event is due count - now cycles from now, modulo 2^32. An event that
+ * is already behind Count therefore lands just before Count gets back to it
+ * after wrapping around, which is where the sorted list put it too.
+ * SPECIAL_INT marks the next wraparound and always goes last. */
+static void queue_event(int type, unsigned int count, uint32_t now)
+{
+   struct interrupt_event event;
+
+   advance_clock(now);
+
+   event.type  = type;
+   event.count = count;
+   event.seq   = q.back_seq++;
+
+   if (type == SPECIAL_INT)
    {
-      //DebugMessage(M64MSG_WARNING, "two events of type 0x%x in interrupt queue", type);
-      return;
+      size_t i;
+
+      event.key = q.clock + (INT64_C(0x100000000) - now);
+      for (i = q.size / 2; i < q.size; ++i)
+         if (q.events[i].key > event.key)
+            event.key = q.events[i].key;
    }
+   else
+      event.key = q.clock + (uint32_t)(count - now);
 
-   event = alloc_node(&q.pool);
-   if (event == NULL)
+   if (!push_event(&event))
    {
       DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
       return;
    }
 
-   event->data.count = count;
-   event->data.type  = type;
+   if (q.events[0].seq == event.seq)
+      next_interupt = count;
+}
 
-   if (q.first == NULL)
-   {
-      q.first = event;
-      event->next = NULL;
-      next_interupt = q.first->data.count;
-   }
-   else if (before_event(count, q.first->data.count, q.first->data.type) && !special)
+static int find_event(int type)
+{
+   int s = event_slot(type);
+   size_t i;
+
+   if (s >= 0)
+      return q.slot[s];
+
+   for (i = 0; i < q.size; ++i)
+      if (q.events[i].type == type)
+         return (int)i;
+
+   return -1;
+}
+
+void add_interupt_event(int type, unsigned int delay)
+{
+   add_interupt_event_count(type, g_cp0_regs[CP0_COUNT_REG] + delay);
+}
+
+void add_interupt_event_count(int type, unsigned count)
+{
+   if (find_event(type) >= 0)
    {
-      event->next = q.first;
-      q.first = event;
-      next_interupt = q.first->data.count;
+      //DebugMessage(M64MSG_WARNING, "two events of type 0x%x in interrupt queue", type);
+      return;
    }
-   else
-   {
-      for(e = q.first;
-            e && e->next != NULL &&
-            (!before_event(count, e->next->data.count, e->next->data.type) || special);
-            e = e->next);
 
-      if (e->next == NULL)
-      {
-         e->next = event;
-         event->next = NULL;
-      }
-      else
-      {
-         if (!special)
-            for(; e->next != NULL && e->next->data.count == count; e = e->next);
+   queue_event(type, count, g_cp0_regs[CP0_COUNT_REG]);
+}
 
-         event->next = e->next;
-         e->next = event;
-      }
-   }
+static void update_next_interupt(void)
+{
+   next_interupt = (q.size != 0
+         && (q.events[0].count > g_cp0_regs[CP0_COUNT_REG]
+            || (g_cp0_regs[CP0_COUNT_REG] - q.events[0].count) < UINT32_C(0x80000000)))
+      ? q.events[0].count
+      : 0;
 }
 
 static void remove_interupt_event(void)
 {
-   struct node *e = q.first;
-   q.first = e->next;
-   free_node(&q.pool, e);
-
-   next_interupt = (q.first != NULL
-         && (q.first->data.count > g_cp0_regs[CP0_COUNT_REG]
-            || (g_cp0_regs[CP0_COUNT_REG] - q.first->data.count) < UINT32_C(0x80000000)))
-      ? q.first->data.count
-      : 0;
+   remove_at(0);
+   update_next_interupt();
 }
 
 unsigned int get_event(int type)
 {
-   struct node* e = q.first;
-
-   if (e == NULL)
-      return 0;
-
-   if (e->data.type == type)
-      return e->data.count;
+   int i = find_event(type);
 
-   for(; e->next != NULL && e->next->data.type != type; e = e->next);
-
-   return (e->next != NULL)
-      ? e->next->data.count
+   return (i >= 0)
+      ? q.events[i].count
       : 0;
 }
 
 int get_next_event_type(void)
 {
-   return (q.first == NULL)
+   return (q.size == 0)
       ? 0
-      : q.first->data.type;
+      : q.events[0].type;
 }
 
 void remove_event(int type)
 {
-   struct node* to_del;
-   struct node* e = q.first;
-
-   if (e == NULL)
-      return;
+   int i = find_event(type);
 
-   if (e->data.type == type)
-   {
-      q.first = e->next;
-      free_node(&q.pool, e);
-   }
-   else
-   {
-      for(; e->next != NULL && e->next->data.type != type; e = e->next);
-
-      if (e->next != NULL)
-      {
-         to_del = e->next;
-         e->next = to_del->next;
-         free_node(&q.pool, to_del);
-      }
-   }
+   if (i >= 0)
+      remove_at((size_t)i);
 }
 
 void translate_event_queue(unsigned int base)
 {
-   struct node *e;
+   size_t i;
 
    remove_event(COMPARE_INT);
    remove_event(SPECIAL_INT);
 
-   for(e = q.first; e != NULL; e = e->next)
-   {
-      e->data.count = (e->data.count - g_cp0_regs[CP0_COUNT_REG]) + base;
-   }
-   add_interupt_event_count(COMPARE_INT, g_cp0_regs[CP0_COMPARE_REG]);
-   add_interupt_event_count(SPECIAL_INT, 0);
+   /* every event stays the same distance ahead, so the keys hold and only
+    * the clock's idea of Count moves */
+   advance_clock(g_cp0_regs[CP0_COUNT_REG]);
+   q.last_count = base;
+   for (i = 0; i < q.size; ++i)
+      q.events[i].count = (q.events[i].count - g_cp0_regs[CP0_COUNT_REG]) + base;
+
+   queue_event(COMPARE_INT, g_cp0_regs[CP0_COMPARE_REG], base);
+   queue_event(SPECIAL_INT, 0, base);
 }
 
-int save_eventqueue_infos(char *buf)
+/* Writes the queue to buf in the order the events will be taken. The heap
+ * holds a dozen events or so, so each one is picked by a scan for the
+ * earliest after the one before, with nothing to allocate. Returns the
+ * length written, or -1 if the queue doesn't fit in size bytes. */
+int save_eventqueue_infos(char *buf, size_t size)
 {
-   int len = 0;
-   struct node *e;
+   const struct interrupt_event *prev = NULL;
+   size_t len = 0;
+   size_t i, n;
 
-   for (e = q.first; e != NULL; e = e->next)
+   for (n = 0; n < q.size; ++n)
    {
-      memcpy(buf + len    , &e->data.type , 4);
-      memcpy(buf + len + 4, &e->data.count, 4);
+      const struct interrupt_event *next = NULL;
+
+      for (i = 0; i < q.size; ++i)
+         if ((prev == NULL || event_before(prev, &q.events[i]))
+               && (next == NULL || event_before(&q.events[i], next)))
+            next = &q.events[i];
+
+      prev = next;
+
+      /* the profiler's samples are not part of the machine state */
+      if (next->type == PROFILE_INT)
+         continue;
+
+      if (len + 8 + 4 > size)
+      {
+         DebugMessage(M64MSG_ERROR, "Interrupt queue doesn't fit in the savestate");
+         return -1;
+      }
+
+      memcpy(buf + len    , &next->type , 4);
+      memcpy(buf + len + 4, &next->count, 4);
       len += 8;
    }
 
+   if (len + 4 > size)
+      return -1;
+
    *((unsigned int*)&buf[len]) = 0xFFFFFFFF;
-   return len+4;
+   return (int)(len+4);
 }
 
 void load_eventqueue_infos(char *buf)
@@ -331,10 +397,16 @@ void load_eventqueue_infos(char *buf)
    }
 }
 
-void init_interupt(void)
+void free_interupt_queue(void)
 {
-   SPECIAL_done = 1;
+   free(q.events);
+   q.events = NULL;
+   q.capacity = 0;
+   clear_queue();
+}
 
+void init_interupt(void)
+{
    g_vi.delay = g_vi.next_vi = 5000;
 
    clear_queue();
@@ -344,7 +416,7 @@ void init_interupt(void)
 
 void check_interupt(void)
 {
-   struct node *event;
+   struct interrupt_event event;
 
    if (g_r4300.mi.regs[MI_INTR_REG] & g_r4300.mi.regs[MI_INTR_REG])
       g_cp0_regs[CP0_CAUSE_REG] = (g_cp0_regs[CP0_CAUSE_REG] | UINT32_C(0x400)) & UINT32_C(0xFFFFFF83);
@@ -354,27 +426,22 @@ void check_interupt(void)
       return;
    if (g_cp0_regs[CP0_STATUS_REG] & g_cp0_regs[CP0_CAUSE_REG] & UINT32_C(0xFF00))
    {
-      event = alloc_node(&q.pool);
+      advance_clock(g_cp0_regs[CP0_COUNT_REG]);
+
+      event.type  = CHECK_INT;
+      event.count = g_cp0_regs[CP0_COUNT_REG];
+      event.key   = (q.size != 0 && q.events[0].key < q.clock)
+         ? q.events[0].key
+         : q.clock;
+      event.seq   = --q.front_seq;
 
-      if (event == NULL)
+      if (!push_event(&event))
       {
          DebugMessage(M64MSG_ERROR, "Failed to allocate node for new interrupt event");
          return;
       }
 
-      event->data.count = next_interupt = g_cp0_regs[CP0_COUNT_REG];
-      event->data.type = CHECK_INT;
-
-      if (q.first == NULL)
-      {
-         q.first = event;
-         event->next = NULL;
-      }
-      else
-      {
-         event->next = q.first;
-         q.first = event;
-      }
+      next_interupt = g_cp0_regs[CP0_COUNT_REG];
    }
 }
 
@@ -412,7 +479,6 @@ static void special_int_handler(void)
    if (g_cp0_regs[CP0_COUNT_REG] > UINT32_C(0x10000000))
       return;
 
-   SPECIAL_done = 1;
    remove_interupt_event();
    add_interupt_event_count(SPECIAL_INT, 0);
 }
@@ -475,7 +541,7 @@ static void nmi_int_handler(void)
    generic_jump_to(UINT32_C(0xa4000040));
 }
 
-void gen_interupt(void)
+static void dispatch_interupt(void)
 {
    if (stop == 1)
    {
@@ -500,17 +566,14 @@ void gen_interupt(void)
       uint32_t dest = skip_jump;
       skip_jump = 0;
 
-      next_interupt = (q.first->data.count > g_cp0_regs[CP0_COUNT_REG]
-            || (g_cp0_regs[CP0_COUNT_REG] - q.first->data.count) < UINT32_C(0x80000000))
-         ? q.first->data.count
-         : 0;
+      update_next_interupt();
 
       last_addr = dest;
       generic_jump_to(dest);
       return;
    } 
 
-   switch(q.first->data.type)
+   switch(q.events[0].type)
    {
       case SPECIAL_INT:
          special_int_handler();
@@ -555,9 +618,29 @@ void gen_interupt(void)
       case NMI_INT:
          nmi_int_handler();
          break;
+#if defined(PROFILE_BLOCKS)
+      case PROFILE_INT:
+         remove_interupt_event();
+         break;
+#endif
       default:
-         DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", q.first->data.type);
+         DebugMessage(M64MSG_ERROR, "Unknown interrupt queue event type %.8X.", q.events[0].type);
          remove_interupt_event();
          break;
    }
 }
+
+void gen_interupt(void)
+{
+   block_profile_enter();
+   dispatch_interupt();
+
+#if defined(PROFILE_BLOCKS)
+   /* sample again later, but never in front of an event that is already
+    * due, which would then wait for Count to wrap around */
+   if ((int32_t)(next_interupt - g_cp0_regs[CP0_COUNT_REG]) > 0)
+      block_profile_schedule();
+#endif
+
+   block_profile_leave();
+}
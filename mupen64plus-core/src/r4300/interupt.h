@@ -22,9 +22,11 @@
 #ifndef M64P_R4300_INTERRUPT_H
 #define M64P_R4300_INTERRUPT_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 void init_interupt(void);
+void free_interupt_queue(void);
 
 /* set to avoid savestates/reset if state may be inconsistent
  * (e.g. in the middle of an instruction) */
@@ -42,7 +44,7 @@ void add_interupt_event(int type, unsigned int delay);
 unsigned int get_event(int type);
 int get_next_event_type(void);
 
-int save_eventqueue_infos(char *buf);
+int save_eventqueue_infos(char *buf, size_t size);
 void load_eventqueue_infos(char *buf);
 
 #define VI_INT      0x001
@@ -56,5 +58,6 @@ void load_eventqueue_infos(char *buf);
 #define DP_INT      0x100
 #define HW2_INT     0x200
 #define NMI_INT     0x400
+#define PROFILE_INT 0x800
 
 #endif /* M64P_R4300_INTERRUPT_H */
@@ -40,6 +40,7 @@ typedef unsigned int u_int;
 #include "../tlb.h"
 #include "../interupt.h"
 #include "../cached_interp.h"
+#include "../perf_jit.h"
 #include "new_dynarec.h"
 
 #include "../../memory/memory.h"
@@ -10920,6 +10921,8 @@ int new_recompile_block(int addr)
   //cacheflush((void *)beginning,out,0);
   #endif
 
+  perf_jit_load((void *)beginning,(u_int)out-beginning,start,NULL);
+
   // If we're within 256K of the end of the buffer,
   // start over from the beginning. (Is 256K enough?)
   if(out > (u_char *)(base_addr+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE-JUMP_TABLE_SIZE))
@@ -0,0 +1,215 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - perf_jit.c                                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#if defined(PERF_JIT)
+
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "perf_jit.h"
+
+#include "api/m64p_types.h"
+#include "api/callbacks.h"
+#include "main/rom.h"
+
+/* see tools/perf/Documentation/jitdump-specification.txt in the kernel */
+#define JITDUMP_MAGIC   UINT32_C(0x4A695444)
+#define JITDUMP_VERSION 1
+
+#define JIT_CODE_LOAD   0
+#define JIT_CODE_CLOSE  3
+
+#if defined(__x86_64__)
+#define JITDUMP_ELF_MACH EM_X86_64
+#elif defined(__i386__)
+#define JITDUMP_ELF_MACH EM_386
+#elif defined(__aarch64__)
+#define JITDUMP_ELF_MACH EM_AARCH64
+#elif defined(__arm__)
+#define JITDUMP_ELF_MACH EM_ARM
+#else
+#define JITDUMP_ELF_MACH EM_NONE
+#endif
+
+struct jitdump_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t total_size;
+   uint32_t elf_mach;
+   uint32_t pad1;
+   uint32_t pid;
+   uint64_t timestamp;
+   uint64_t flags;
+};
+
+struct jitdump_record
+{
+   uint32_t id;
+   uint32_t total_size;
+   uint64_t timestamp;
+};
+
+struct jitdump_code_load
+{
+   struct jitdump_record p;
+   uint32_t pid;
+   uint32_t tid;
+   uint64_t vma;
+   uint64_t code_addr;
+   uint64_t code_size;
+   uint64_t code_index;
+};
+
+static FILE *perf_map;
+static FILE *jitdump;
+
+/* perf record finds the dump through this mapping of it */
+static void *jitdump_marker;
+static size_t jitdump_marker_size;
+
+static uint64_t code_index;
+
+static uint64_t get_timestamp(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void open_jitdump(void)
+{
+   struct jitdump_header header;
+   char filename[64];
+   int fd;
+
+   sprintf(filename, "jit-%d.dump", (int)getpid());
+   jitdump = fopen(filename, "w+");
+   if (jitdump == NULL)
+   {
+      DebugMessage(M64MSG_ERROR, "Couldn't open %s for writing", filename);
+      return;
+   }
+
+   fd = fileno(jitdump);
+   jitdump_marker_size = (size_t)sysconf(_SC_PAGESIZE);
+   jitdump_marker = mmap(NULL, jitdump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+   if (jitdump_marker == MAP_FAILED)
+   {
+      DebugMessage(M64MSG_ERROR, "Couldn't map %s, perf won't find it", filename);
+      jitdump_marker = NULL;
+   }
+
+   memset(&header, 0, sizeof(header));
+   header.magic      = JITDUMP_MAGIC;
+   header.version    = JITDUMP_VERSION;
+   header.total_size = sizeof(header);
+   header.elf_mach   = JITDUMP_ELF_MACH;
+   header.pid        = (uint32_t)getpid();
+   header.timestamp  = get_timestamp();
+   fwrite(&header, sizeof(header), 1, jitdump);
+
+   DebugMessage(M64MSG_INFO, "Writing jitted code to %s", filename);
+}
+
+void perf_jit_open(void)
+{
+   char filename[64];
+
+   code_index = 0;
+
+   sprintf(filename, "/tmp/perf-%d.map", (int)getpid());
+   perf_map = fopen(filename, "w");
+   if (perf_map == NULL)
+      DebugMessage(M64MSG_ERROR, "Couldn't open %s for writing", filename);
+
+   open_jitdump();
+}
+
+void perf_jit_load(const void *code, size_t size, uint32_t vaddr, const char *kind)
+{
+   char name[64];
+   size_t name_size;
+
+   if (size == 0)
+      return;
+
+   if (kind == NULL)
+      snprintf(name, sizeof(name), "%s:%08x", ROM_PARAMS.headername, (unsigned int)vaddr);
+   else
+      snprintf(name, sizeof(name), "%s:%s:%08x", ROM_PARAMS.headername, kind, (unsigned int)vaddr);
+   name_size = strlen(name) + 1;
+
+   if (perf_map != NULL)
+      fprintf(perf_map, "%lx %lx %s\n", (unsigned long)(uintptr_t)code, (unsigned long)size, name);
+
+   if (jitdump != NULL)
+   {
+      struct jitdump_code_load record;
+
+      record.p.id         = JIT_CODE_LOAD;
+      record.p.total_size = (uint32_t)(sizeof(record) + name_size + size);
+      record.p.timestamp  = get_timestamp();
+      record.pid          = (uint32_t)getpid();
+      record.tid          = (uint32_t)syscall(SYS_gettid);
+      record.vma          = (uint64_t)(uintptr_t)code;
+      record.code_addr    = (uint64_t)(uintptr_t)code;
+      record.code_size    = size;
+      record.code_index   = code_index++;
+
+      fwrite(&record, sizeof(record), 1, jitdump);
+      fwrite(name, name_size, 1, jitdump);
+      fwrite(code, size, 1, jitdump);
+   }
+}
+
+void perf_jit_close(void)
+{
+   if (perf_map != NULL)
+   {
+      fclose(perf_map);
+      perf_map = NULL;
+   }
+
+   if (jitdump != NULL)
+   {
+      struct jitdump_record record;
+
+      record.id         = JIT_CODE_CLOSE;
+      record.total_size = sizeof(record);
+      record.timestamp  = get_timestamp();
+      fwrite(&record, sizeof(record), 1, jitdump);
+
+      if (jitdump_marker != NULL)
+         munmap(jitdump_marker, jitdump_marker_size);
+      jitdump_marker = NULL;
+
+      fclose(jitdump);
+      jitdump = NULL;
+   }
+}
+
+#endif
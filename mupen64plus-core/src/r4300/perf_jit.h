@@ -0,0 +1,52 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - perf_jit.h                                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_R4300_PERF_JIT_H
+#define M64P_R4300_PERF_JIT_H
+
+/* Names the code generated by the dynarecs for Linux perf, built with
+ * PERF_JIT.
+ *
+ * Every block is written to /tmp/perf-<pid>.map, which perf report reads
+ * as is, and to jit-<pid>.dump in the current directory, for
+ * `perf record -k mono` followed by `perf inject --jit`. Symbols are
+ * named "<ROM name>:<guest address>", or "<ROM name>:<kind>:<guest address>"
+ * for code that is not a block of its own.
+ *
+ * Neither format has a record for code going away. A jitdump load is
+ * stamped with the time it was emitted and perf goes by the latest one
+ * covering an address, so code recompiled in place after an invalidation
+ * gets its new name. The perf map has no such ordering and may show the
+ * stale name instead. */
+
+#if defined(PERF_JIT)
+  #include <stddef.h>
+  #include <stdint.h>
+
+  void perf_jit_open(void);
+  void perf_jit_load(const void *code, size_t size, uint32_t vaddr, const char *kind);
+  void perf_jit_close(void);
+#else
+  #define perf_jit_open()
+  #define perf_jit_load(code, size, vaddr, kind)
+  #define perf_jit_close()
+#endif
+
+#endif /* M64P_R4300_PERF_JIT_H */
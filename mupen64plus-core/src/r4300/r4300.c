@@ -36,12 +36,15 @@
 
 #include "r4300.h"
 #include "r4300_core.h"
+#include "block_profile.h"
 #include "cached_interp.h"
+#include "code_arena.h"
 #include "cp0_private.h"
 #include "cp1_private.h"
 #include "ops.h"
 #include "interupt.h"
 #include "macros.h"
+#include "perf_jit.h"
 #include "pure_interp.h"
 #include "recomp.h"
 #include "recomph.h"
@@ -127,6 +130,7 @@ void r4300_reset_hard(void)
       tlb_LUT_r[i] = 0;
       tlb_LUT_w[i] = 0;
    }
+   memset(tlb_LUT_dirty, 1, sizeof(tlb_LUT_dirty));
    llbit = 0;
    hi    = 0;
    lo    = 0;
@@ -237,6 +241,7 @@ void r4300_init(void)
 
     last_addr = 0xa4000040;
     next_interupt = 624999;
+    block_profile_init();
     init_interupt();
 
     if (r4300emu == CORE_PURE_INTERPRETER)
@@ -246,12 +251,17 @@ void r4300_init(void)
         pure_interpreter_init();
     }
 #if defined(DYNAREC)
+#ifdef NEW_DYNAREC
     else if (r4300emu >= 2)
+#else
+    else if (r4300emu >= 2 && code_arena_init())
+#endif
     {
         DebugMessage(M64MSG_INFO, "Starting R4300 emulator: Dynamic Recompiler");
 
         {
            r4300emu = CORE_DYNAREC;
+           perf_jit_open();
            init_blocks();
 
 #ifdef NEW_DYNAREC
@@ -280,6 +290,7 @@ void r4300_init(void)
 void r4300_deinit(void)
 {
     DebugMessage(M64MSG_INFO, "R4300 emulator finished.");
+    block_profile_report();
 
     if (r4300emu == CORE_PURE_INTERPRETER)
     {
@@ -292,13 +303,18 @@ void r4300_deinit(void)
           free_blocks();
 #else
           PC++;
+          free_blocks();
+          code_arena_release();
 #endif
+          perf_jit_close();
     }
 #endif
     else /* if (r4300emu == CORE_INTERPRETER) */
     {
         free_blocks();
     }
+
+    free_interupt_queue();
 }
 
 void r4300_execute(void)
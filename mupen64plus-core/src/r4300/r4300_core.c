@@ -93,6 +93,26 @@ void invalidate_r4300_cached_code(uint32_t address, size_t size)
    }
 }
 
+void invalidate_r4300_cached_rdram(uint32_t address, size_t size)
+{
+   uint32_t end = address + (uint32_t)size;
+   uint32_t page;
+
+   if (r4300emu == CORE_PURE_INTERPRETER || size == 0)
+      return;
+
+   for (page = address >> 12; page <= (end - 1) >> 12; ++page)
+   {
+      uint32_t begin = (page << 12 > address) ? page << 12 : address;
+      uint32_t length = ((page + 1) << 12 < end) ? ((page + 1) << 12) - begin : end - begin;
+
+      if (!invalid_code[0x80000 + page])
+         invalidate_r4300_cached_code(0x80000000 + begin, length);
+      if (!invalid_code[0xa0000 + page])
+         invalidate_r4300_cached_code(0xa0000000 + begin, length);
+   }
+}
+
 /* XXX: not really a good interface but it gets the job done... */
 void savestates_load_set_pc(uint32_t pc)
 {
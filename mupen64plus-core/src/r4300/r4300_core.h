@@ -55,6 +55,12 @@ unsigned int get_r4300_emumode(void);
  */
 void invalidate_r4300_cached_code(uint32_t address, size_t size);
 
+/* Same as above for [address, address+size] of RDRAM, through both its
+ * KSEG0 and KSEG1 mirrors. Pages with no compiled code in either mirror
+ * are skipped. Unlike above, size == 0 invalidates nothing.
+ */
+void invalidate_r4300_cached_rdram(uint32_t address, size_t size);
+
 /* Jump to the given address. This works for all r4300 emulator, but is slower.
  * Use this for common code which can be executed from any r4300 emulator. */
 void generic_jump_to(unsigned int address);
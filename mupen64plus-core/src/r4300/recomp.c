@@ -22,23 +22,18 @@
 #include <stdlib.h>
 #include <string.h>
 
-#if defined(__GNUC__)
-#include <unistd.h>
-#ifndef __MINGW32__
-#include <sys/mman.h>
-#endif
-#endif
-
 #include "api/m64p_types.h"
 #include "api/callbacks.h"
 #include "memory/memory.h"
 
 #include "cached_interp.h"
+#include "code_arena.h"
 #include "recomp.h"
 #include "recomph.h" //include for function prototypes
 #include "cp0_private.h"
 #include "r4300.h"
 #include "ops.h"
+#include "perf_jit.h"
 #include "tlb.h"
 
 static void *malloc_exec(size_t size);
@@ -2174,11 +2169,13 @@ void init_block(precomp_block *block)
   {
     size_t memsize = get_block_memsize(block);
     if (r4300emu == CORE_DYNAREC) {
-        block->block = (precomp_instr *) malloc_exec(memsize);
-        if (!block->block) {
+        void *instrs = malloc_exec(memsize);
+        if (!instrs) {
             DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate executable memory for dynamic recompiler. Try to use an interpreter mode.");
             return;
         }
+        /* the jump wrappers in there are built through the writable view */
+        block->block = (precomp_instr *) CODE_ARENA_RW(instrs);
     }
     else {
         block->block = (precomp_instr *) malloc(memsize);
@@ -2278,6 +2275,9 @@ void init_block(precomp_block *block)
     block->code_length = code_length;
     block->max_code_length = max_code_length;
     free_assembler(&block->jumps_table, &block->jumps_number, &block->riprel_table, &block->riprel_number);
+
+    if (!already_exist)
+      perf_jit_load(block->code, code_length, block->start, "stubs");
   }
    
   /* here we're marking the block as a valid code even if it's not compiled
@@ -2342,7 +2342,7 @@ void free_block(precomp_block *block)
 
     if (block->block) {
         if (r4300emu == CORE_DYNAREC)
-            free_exec(block->block, memsize);
+            free_exec(CODE_ARENA_RX(block->block), memsize);
         else
             free(block->block);
         block->block = NULL;
@@ -2359,6 +2359,10 @@ void recompile_block(const uint32_t *source, precomp_block *block, unsigned int
 {
    uint32_t i;
    int length, finished=0;
+#if defined(PERF_JIT)
+   unsigned char *old_code = block->code;
+   int start_length = block->code_length;
+#endif
    start_section(COMPILER_SECTION);
    length = (block->end-block->start)/4;
    dst_block = block;
@@ -2478,6 +2482,13 @@ void recompile_block(const uint32_t *source, precomp_block *block, unsigned int
     block->code_length = code_length;
     block->max_code_length = max_code_length;
     free_assembler(&block->jumps_table, &block->jumps_number, &block->riprel_table, &block->riprel_number);
+
+#if defined(PERF_JIT)
+    /* growing the buffer moved everything compiled for this page so far */
+    if (block->code != old_code)
+      perf_jit_load(block->code, start_length, block->start, "page");
+    perf_jit_load(block->code + start_length, code_length - start_length, func, NULL);
+#endif
      }
 #ifdef CORE_DBG
    DebugMessage(M64MSG_INFO, "block recompiled (%x-%x)", (int)func, (int)(block->start+i*4));
@@ -2598,24 +2609,7 @@ void recompile_opcode(void)
  **********************************************************************/
 static void *malloc_exec(size_t size)
 {
-#if defined(WIN32)
-   return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
-#elif defined(__GNUC__)
-
-   #ifndef  MAP_ANONYMOUS
-      #ifdef MAP_ANON
-         #define MAP_ANONYMOUS MAP_ANON
-      #endif
-   #endif
-
-   void *block = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-   if (block == MAP_FAILED)
-       { DebugMessage(M64MSG_ERROR, "Memory error: couldn't allocate %zi byte block of aligned RWX memory.", size); return NULL; }
-
-   return block;
-#else
-   return malloc(size);
-#endif
+   return code_arena_alloc(size);
 }
 
 /**********************************************************************
@@ -2623,18 +2617,7 @@ static void *malloc_exec(size_t size)
  **********************************************************************/
 void *realloc_exec(void *ptr, size_t oldsize, size_t newsize)
 {
-   void* block = malloc_exec(newsize);
-   if (block != NULL)
-   {
-      size_t copysize;
-      if (oldsize < newsize)
-         copysize = oldsize;
-      else
-         copysize = newsize;
-      memcpy(block, ptr, copysize);
-   }
-   free_exec(ptr, oldsize);
-   return block;
+   return code_arena_realloc(ptr, oldsize, newsize);
 }
 
 /**********************************************************************
@@ -2642,11 +2625,5 @@ void *realloc_exec(void *ptr, size_t oldsize, size_t newsize)
  **********************************************************************/
 static void free_exec(void *ptr, size_t length)
 {
-#if defined(WIN32)
-   VirtualFree(ptr, 0, MEM_RELEASE);
-#elif defined(__GNUC__)
-   munmap(ptr, length);
-#else
-   free(ptr);
-#endif
+   code_arena_free(ptr, length);
 }
@@ -28,6 +28,18 @@ tlb tlb_e[32];
 
 uint32_t tlb_LUT_r[0x100000];
 uint32_t tlb_LUT_w[0x100000];
+uint8_t tlb_LUT_dirty[TLB_LUT_PAGES];
+
+/* Flags the 4KB pages of the LUTs covering [start, end) for delta savestates. */
+static void tlb_LUT_touch(uint32_t start, uint32_t end)
+{
+    uint32_t page;
+
+    if (start >= end)
+        return;
+    for (page = start >> 22; page <= (end - 1) >> 22; page++)
+        tlb_LUT_dirty[page] = 1;
+}
 
 void tlb_unmap(tlb *entry)
 {
@@ -35,6 +47,7 @@ void tlb_unmap(tlb *entry)
 
     if (entry->v_even)
     {
+        tlb_LUT_touch(entry->start_even, entry->end_even);
         for (i=entry->start_even; i<entry->end_even; i += 0x1000)
             tlb_LUT_r[i>>12] = 0;
         if (entry->d_even)
@@ -44,6 +57,7 @@ void tlb_unmap(tlb *entry)
 
     if (entry->v_odd)
     {
+        tlb_LUT_touch(entry->start_odd, entry->end_odd);
         for (i=entry->start_odd; i<entry->end_odd; i += 0x1000)
             tlb_LUT_r[i>>12] = 0;
         if (entry->d_odd)
@@ -62,6 +76,7 @@ void tlb_map(tlb *entry)
             !(entry->start_even >= 0x80000000 && entry->end_even < 0xC0000000) &&
             entry->phys_even < 0x20000000)
         {
+            tlb_LUT_touch(entry->start_even, entry->end_even);
             for (i=entry->start_even;i<entry->end_even;i+=0x1000)
                 tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_even + (i - entry->start_even) + 0xFFF);
             if (entry->d_even)
@@ -76,6 +91,7 @@ void tlb_map(tlb *entry)
             !(entry->start_odd >= 0x80000000 && entry->end_odd < 0xC0000000) &&
             entry->phys_odd < 0x20000000)
         {
+            tlb_LUT_touch(entry->start_odd, entry->end_odd);
             for (i=entry->start_odd;i<entry->end_odd;i+=0x1000)
                 tlb_LUT_r[i>>12] = UINT32_C(0x80000000) | (entry->phys_odd + (i - entry->start_odd) + 0xFFF);
             if (entry->d_odd)
@@ -52,6 +52,12 @@ typedef struct _tlb
 extern tlb tlb_e[32];
 extern uint32_t tlb_LUT_r[0x100000];
 extern uint32_t tlb_LUT_w[0x100000];
+
+/* One flag per 4KB page of tlb_LUT_r/tlb_LUT_w written since the last delta
+ * savestate keyframe, cleared by the savestate code. */
+#define TLB_LUT_PAGES (0x100000 / 0x400)
+extern uint8_t tlb_LUT_dirty[TLB_LUT_PAGES];
+
 void tlb_unmap(tlb *entry);
 void tlb_map(tlb *entry);
 uint32_t virtual_to_physical_address(uint32_t addresse, int w);
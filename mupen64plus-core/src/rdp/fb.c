@@ -38,7 +38,40 @@ void init_fb(struct fb* fb)
 }
 
 
-static void pre_framebuffer_read(struct fb* fb, uint32_t address)
+static void update_fb_pages(struct fb* fb)
+{
+    size_t i;
+
+    memset(fb->page_owner, FB_PAGE_NONE, sizeof(fb->page_owner));
+
+    for(i = 0; i < FB_INFOS_COUNT; ++i)
+    {
+        if (fb->infos[i].addr)
+        {
+            unsigned int start = fb->infos[i].addr & 0x7FFFFF;
+            unsigned int end   = start + fb->infos[i].width*
+                               fb->infos[i].height*
+                               fb->infos[i].size - 1;
+            unsigned int page;
+
+            if (end < start)
+                continue;
+            if (end > 0x7FFFFF)
+                end = 0x7FFFFF;
+
+            for (page = start >> 12; page <= (end >> 12); ++page)
+            {
+                if (fb->page_owner[page] == FB_PAGE_NONE &&
+                        (page << 12) >= start && ((page << 12) | 0xFFF) <= end)
+                    fb->page_owner[page] = (unsigned char)(i + 1);
+                else
+                    fb->page_owner[page] = FB_PAGE_SHARED;
+            }
+        }
+    }
+}
+
+static void pre_framebuffer_read_slow(struct fb* fb, uint32_t address)
 {
     size_t i;
 
@@ -61,7 +94,7 @@ static void pre_framebuffer_read(struct fb* fb, uint32_t address)
     }
 }
 
-static void pre_framebuffer_write(struct fb* fb, uint32_t address)
+static void pre_framebuffer_write_slow(struct fb* fb, uint32_t address)
 {
     size_t i;
 
@@ -79,6 +112,43 @@ static void pre_framebuffer_write(struct fb* fb, uint32_t address)
     }
 }
 
+static void pre_framebuffer_read(struct fb* fb, uint32_t address)
+{
+    unsigned int page  = (address & 0x7FFFFF) >> 12;
+    unsigned char owner = fb->page_owner[page];
+
+    if (owner == FB_PAGE_NONE)
+        return;
+
+    if (owner == FB_PAGE_SHARED)
+    {
+        pre_framebuffer_read_slow(fb, address);
+        return;
+    }
+
+    if (fb->dirty_page[page])
+    {
+        gfx.fBRead(address);
+        fb->dirty_page[page] = 0;
+    }
+}
+
+static void pre_framebuffer_write(struct fb* fb, uint32_t address)
+{
+    unsigned char owner = fb->page_owner[(address & 0x7FFFFF) >> 12];
+
+    if (owner == FB_PAGE_NONE)
+        return;
+
+    if (owner == FB_PAGE_SHARED)
+    {
+        pre_framebuffer_write_slow(fb, address);
+        return;
+    }
+
+    gfx.fBWrite(address, 4);
+}
+
 int read_rdram_fb(void* opaque, uint32_t address, uint32_t* value)
 {
     struct rdp_core* dp = (struct rdp_core*)opaque;
@@ -103,7 +173,10 @@ void protect_framebuffers(struct rdp_core* dp)
     struct fb* fb = &dp->fb;
 
     if (gfx.fBGetFrameBufferInfo && gfx.fBRead && gfx.fBWrite)
+    {
         gfx.fBGetFrameBufferInfo(fb->infos);
+        update_fb_pages(fb);
+    }
 
     if (!gfx.fBGetFrameBufferInfo)
        return;
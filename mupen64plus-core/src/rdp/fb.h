@@ -31,9 +31,16 @@ struct rdp_core;
 enum { FB_INFOS_COUNT = 6 };
 enum { FB_DIRTY_PAGES_COUNT = 0x800 };
 
+/* page_owner values besides 1 + index into infos */
+enum { FB_PAGE_NONE = 0, FB_PAGE_SHARED = 0xFF };
+
 struct fb
 {
     unsigned char dirty_page[FB_DIRTY_PAGES_COUNT];
+    /* which framebuffer covers each 4KB page of RDRAM. Pages only partly
+     * covered, or covered by more than one framebuffer, are FB_PAGE_SHARED
+     * and take the slow path. Rebuilt by protect_framebuffers. */
+    unsigned char page_owner[FB_DIRTY_PAGES_COUNT];
     FrameBufferInfo infos[FB_INFOS_COUNT];
     unsigned int once;
 };
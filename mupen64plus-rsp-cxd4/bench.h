@@ -26,41 +26,15 @@
  * Fortunately, because all the methods are static (no conditional jumps),
  * we can lazily leave the instruction word set to 0x00000000 for all the
  * op-codes we are benching, and it will make no difference in speed.
+ *
+ * The op-code list below is shared with the standalone `rsp-bench` tool,
+ * which does not include "rsp.h", so only DllTest depends on the plugin.
  */
 
 #include <time.h>
-#include "rsp.h"
 
 #define NUMBER_OF_VU_OPCODES    38
 
-static void (*bench_tests[NUMBER_OF_VU_OPCODES])(int, int, int, int) = {
-    VMULF, VMACF, /* signed single-precision fractions */
-    VMULU, VMACU, /* unsigned single-precision fractions */
-
-    VMUDL, VMADL, /* double-precision multiplies using partial products */
-    VMUDM, VMADM,
-    VMUDN, VMADN,
-    VMUDH, VMADH,
-
-    VADD, VSUB, VABS,
-    VADDC, VSUBC,
-    VSAW,
-
-    VEQ, VNE, VLT, VGE, /* normal select compares */
-    VCH, VCL, /* double-precision clip select */
-    VCR, /* single-precision, one's complement */
-    VMRG,
-
-    VAND, VNAND,
-    VOR , VNOR ,
-    VXOR, VNXOR,
-
-    VRCPL, VRSQL, /* double-precision reciprocal look-ups */
-    VRCPH, VRSQH,
-
-    VMOV, VNOP
-};
-
 enum {
     SP_VMULF =  000,
     SP_VMULU =  001,
@@ -127,6 +101,35 @@ enum {
     SP_VINSN =  076,
     SP_VNULLOP= 077
 };
+
+static const int bench_opcodes[NUMBER_OF_VU_OPCODES] = {
+    SP_VMULF, SP_VMACF, /* signed single-precision fractions */
+    SP_VMULU, SP_VMACU, /* unsigned single-precision fractions */
+
+    SP_VMUDL, SP_VMADL, /* double-precision multiplies using partial products */
+    SP_VMUDM, SP_VMADM,
+    SP_VMUDN, SP_VMADN,
+    SP_VMUDH, SP_VMADH,
+
+    SP_VADD, SP_VSUB, SP_VABS,
+    SP_VADDC, SP_VSUBC,
+    SP_VSAW,
+
+    SP_VEQ, SP_VNE, SP_VLT, SP_VGE, /* normal select compares */
+    SP_VCH, SP_VCL, /* double-precision clip select */
+    SP_VCR, /* single-precision, one's complement */
+    SP_VMRG,
+
+    SP_VAND, SP_VNAND,
+    SP_VOR , SP_VNOR ,
+    SP_VXOR, SP_VNXOR,
+
+    SP_VRCPL, SP_VRSQL, /* double-precision reciprocal look-ups */
+    SP_VRCPH, SP_VRSQH,
+
+    SP_VMOV, SP_VNOP
+};
+
 const char* test_names[NUMBER_OF_VU_OPCODES] = {
     mnemonics_C2[SP_VMULF], mnemonics_C2[SP_VMACF],
     mnemonics_C2[SP_VMULU], mnemonics_C2[SP_VMACU],
@@ -162,7 +165,7 @@ const char* notice_starting =
 const char* notice_finished =
     "Finished writing benchmark results.\n"\
     "Check working emulator directory for \"sp_bench.txt\".";
-#if !defined(M64P_PLUGIN_API)
+#if defined(_RSP_H_) && !defined(M64P_PLUGIN_API)
 EXPORT void CALL DllTest(HWND hParent)
 {
     FILE* log;
@@ -185,7 +188,7 @@ EXPORT void CALL DllTest(HWND hParent)
     {
         t1 = clock();
         for (j = -0x1000000; j < 0; j++)
-            bench_tests[i](0, 0, 0, 8);
+            COP2_C2[bench_opcodes[i]](0, 0, 0, 8);
         t2 = clock();
         delta = (float)(t2 - t1) / CLOCKS_PER_SEC;
         fprintf(log, "%s:  %.3f s\n", test_names[i], delta);
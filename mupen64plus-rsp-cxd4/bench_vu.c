@@ -0,0 +1,65 @@
+/******************************************************************************\
+* Project:  MSP Emulation Layer for Vector Unit Computational Operations       *
+* Authors:  Iconoclast                                                         *
+* Release:  2013.12.12                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+
+/*
+ * one stand-alone copy of the vector unit for `rsp-bench`
+ *
+ * This file gets compiled twice, once as is and once with
+ * VU_SCALAR_REFERENCE defined, and both objects go into the same program.
+ * The few globals the VU headers define are renamed with the object's
+ * prefix so that the two copies of the register files do not collide.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "vu/simd.h"
+
+#ifdef VU_SCALAR_REFERENCE
+#define VU_UNIT(name)   reference_##name
+#else
+#define VU_UNIT(name)   optimized_##name
+#endif
+
+#define VR          VU_UNIT(VR)
+#define VCO         VU_UNIT(VCO)
+#define VCC         VU_UNIT(VCC)
+#define VCE         VU_UNIT(VCE)
+#define ne          VU_UNIT(ne)
+#define co          VU_UNIT(co)
+#define clip        VU_UNIT(clip)
+#define comp        VU_UNIT(comp)
+#define vce         VU_UNIT(vce)
+#define sub_mask    VU_UNIT(sub_mask)
+#define get_VCO     VU_UNIT(get_VCO)
+#define get_VCC     VU_UNIT(get_VCC)
+#define get_VCE     VU_UNIT(get_VCE)
+#define set_VCO     VU_UNIT(set_VCO)
+#define set_VCC     VU_UNIT(set_VCC)
+#define set_VCE     VU_UNIT(set_VCE)
+
+extern void message(const char* body, int priority);
+
+#include "vu/vu.h"
+#include "bench_vu.h"
+
+const struct vu_unit VU_UNIT(unit) = {
+    COP2_C2,
+    VR,
+    VACC,
+    ne, co, clip, comp, vce,
+    &DivIn, &DivOut, &DPH
+};
@@ -0,0 +1,34 @@
+/******************************************************************************\
+* Project:  MSP Emulation Layer for Vector Unit Computational Operations       *
+* Authors:  Iconoclast                                                         *
+* Release:  2013.12.12                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+#ifndef _BENCH_VU_H
+#define _BENCH_VU_H
+
+/*
+ * `rsp-bench` links the vector unit in twice:  once with the SIMD kernels
+ * and once built with VU_SCALAR_REFERENCE (see "bench_vu.c").  Each copy
+ * exports its op-code table and register files through one of these,
+ * including the hidden divide state carried from VRCPH to VRCPL.
+ */
+struct vu_unit {
+    void (**ops)(int, int, int, int);
+    short (*VR)[8];
+    short (*VACC)[8];
+    short *ne, *co, *clip, *comp, *vce;
+    int *DivIn, *DivOut, *DPH;
+};
+
+extern const struct vu_unit optimized_unit;
+extern const struct vu_unit reference_unit;
+#endif
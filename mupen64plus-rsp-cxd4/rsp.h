@@ -17,24 +17,7 @@
 #include "Rsp_#1.1.h"
 RSP_INFO RSP;
 
-#ifdef _MSC_VER
-#define NOINLINE    __declspec(noinline)
-#define ALIGNED     _declspec(align(16))
-#else
-#define NOINLINE    __attribute__((noinline))
-#define ALIGNED     __attribute__((aligned(16)))
-#endif
-
-/*
- * Streaming SIMD Extensions version import management
- */
-#ifdef ARCH_MIN_SSSE3
-#define ARCH_MIN_SSE2
-#include <tmmintrin.h>
-#endif
-#ifdef ARCH_MIN_SSE2
-#include <emmintrin.h>
-#endif
+#include "vu/simd.h"
 
 typedef unsigned char byte;
 
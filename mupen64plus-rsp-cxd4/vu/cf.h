@@ -40,11 +40,11 @@ unsigned char VCE;
  * However, since SSE2 uses 128-bit XMM's, and Win32 `int` storage is 32-bit,
  * we have the problem of 32*8 > 128 bits, so we use `short` to reduce packs.
  */
-short ne[8]; /* $vco:  high byte "NOTEQUAL" */
-short co[8]; /* $vco:  low byte "carry/borrow in/out" */
-short clip[8]; /* $vcc:  high byte (clip tests:  VCL, VCH, VCR) */
-short comp[8]; /* $vcc:  low byte (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
-short vce[8]; /* $vce:  vector compare extension register */
+ALIGNED short ne[8]; /* $vco:  high byte "NOTEQUAL" */
+ALIGNED short co[8]; /* $vco:  low byte "carry/borrow in/out" */
+ALIGNED short clip[8]; /* $vcc:  high byte (clip tests:  VCL, VCH, VCR) */
+ALIGNED short comp[8]; /* $vcc:  low byte (VEQ, VNE, VLT, VGE, VCL, VCH, VCR) */
+ALIGNED short vce[8]; /* $vce:  vector compare extension register */
 
 #ifndef ARCH_MIN_SSE2
 unsigned short get_VCO(void)
@@ -214,6 +214,134 @@ static INLINE void SIGNED_CLAMP_AM(short* VD)
     _mm_store_si128((__m128i *)VD, dst);
     return;
 }
+
+/*
+ * Register-level helpers for the SSE2 op-code kernels, so that a whole
+ * multiply-accumulate can stay in XMM registers between the loads of VS, VT
+ * and the accumulator and the final stores.
+ */
+static INLINE __m128i select_epi16(__m128i mask, __m128i pass, __m128i fail)
+{
+    pass = _mm_and_si128(mask, pass);
+    fail = _mm_andnot_si128(mask, fail);
+    return _mm_or_si128(pass, fail);
+}
+static INLINE __m128i carry_epu16(__m128i a, __m128i b)
+{ /* ~0 in every slice where the unsigned (a + b) carries out of bit 15 */
+    __m128i sat, sum;
+
+    sat = _mm_adds_epu16(a, b);
+    sum = _mm_add_epi16(a, b);
+    return _mm_andnot_si128(_mm_cmpeq_epi16(sat, sum), _mm_cmpeq_epi16(a, a));
+}
+static INLINE __m128i mulhi_su(__m128i s, __m128i u)
+{ /* high half of (signed) s * (unsigned) u */
+    __m128i hi;
+
+    hi = _mm_mulhi_epi16(s, u);
+    return _mm_add_epi16(hi, _mm_and_si128(s, _mm_srai_epi16(u, 15)));
+}
+static INLINE __m128i clamp_am(__m128i acc_m, __m128i acc_h)
+{
+    __m128i lo, hi;
+
+    lo = _mm_unpacklo_epi16(acc_m, acc_h);
+    hi = _mm_unpackhi_epi16(acc_m, acc_h);
+    return _mm_packs_epi32(lo, hi);
+}
+static INLINE __m128i clamp_al(__m128i acc_l, __m128i acc_m, __m128i acc_h)
+{
+    __m128i temp, cond;
+
+    temp = clamp_am(acc_m, acc_h);
+    cond = _mm_cmpeq_epi16(temp, acc_m);
+    temp = _mm_xor_si128(temp, _mm_set1_epi16(-0x8000));
+    return select_epi16(cond, acc_l, temp);
+}
+static INLINE __m128i clamp_au(__m128i acc_m, __m128i acc_h)
+{
+    __m128i temp, cond;
+
+    temp = clamp_am(acc_m, acc_h);
+    cond = _mm_cmpgt_epi16(temp, acc_m);
+    temp = _mm_andnot_si128(_mm_srai_epi16(temp, 15), temp);
+    return _mm_or_si128(temp, cond);
+}
+#endif
+
+#ifdef ARCH_MIN_ARM_NEON
+/*
+ * NEON counterparts of the register-level helpers above.
+ * Masks from the compare instructions stay unsigned, as NEON returns them.
+ */
+static INLINE int16x8_t select_s16(uint16x8_t mask, int16x8_t pass, int16x8_t fail)
+{
+    return vbslq_s16(mask, pass, fail);
+}
+static INLINE uint16x8_t carry_u16(int16x8_t a, int16x8_t b)
+{
+    uint16x8_t sum;
+
+    sum = vaddq_u16(vreinterpretq_u16_s16(a), vreinterpretq_u16_s16(b));
+    return vcltq_u16(sum, vreinterpretq_u16_s16(a));
+}
+static INLINE int16x8_t mullo_s16(int16x8_t a, int16x8_t b)
+{
+    return vmulq_s16(a, b);
+}
+static INLINE int16x8_t mulhi_s16(int16x8_t a, int16x8_t b)
+{
+    int32x4_t lo, hi;
+
+    lo = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+    hi = vmull_s16(vget_high_s16(a), vget_high_s16(b));
+    return vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16));
+}
+static INLINE int16x8_t mulhi_u16(int16x8_t a, int16x8_t b)
+{
+    uint32x4_t lo, hi;
+    uint16x8_t ua, ub;
+
+    ua = vreinterpretq_u16_s16(a);
+    ub = vreinterpretq_u16_s16(b);
+    lo = vmull_u16(vget_low_u16(ua), vget_low_u16(ub));
+    hi = vmull_u16(vget_high_u16(ua), vget_high_u16(ub));
+    return vreinterpretq_s16_u16(
+        vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+}
+static INLINE int16x8_t mulhi_su(int16x8_t s, int16x8_t u)
+{ /* high half of (signed) s * (unsigned) u */
+    return vaddq_s16(mulhi_s16(s, u), vandq_s16(s, vshrq_n_s16(u, 15)));
+}
+static INLINE int16x8_t clamp_am(int16x8_t acc_m, int16x8_t acc_h)
+{
+    int16x8x2_t acc;
+
+    acc = vzipq_s16(acc_m, acc_h);
+    return vcombine_s16(
+        vqmovn_s32(vreinterpretq_s32_s16(acc.val[0])),
+        vqmovn_s32(vreinterpretq_s32_s16(acc.val[1])));
+}
+static INLINE int16x8_t clamp_al(int16x8_t acc_l, int16x8_t acc_m, int16x8_t acc_h)
+{
+    int16x8_t temp;
+    uint16x8_t cond;
+
+    temp = clamp_am(acc_m, acc_h);
+    cond = vceqq_s16(temp, acc_m);
+    temp = veorq_s16(temp, vdupq_n_s16(-0x8000));
+    return select_s16(cond, acc_l, temp);
+}
+static INLINE int16x8_t clamp_au(int16x8_t acc_m, int16x8_t acc_h)
+{
+    int16x8_t temp;
+    uint16x8_t cond;
+
+    temp = clamp_am(acc_m, acc_h);
+    cond = vcgtq_s16(temp, acc_m);
+    temp = vbicq_s16(temp, vshrq_n_s16(temp, 15));
+    return vorrq_s16(temp, vreinterpretq_s16_u16(cond));
+}
 #endif
 
 static INLINE void UNSIGNED_CLAMP(short* VD)
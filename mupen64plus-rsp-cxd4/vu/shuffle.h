@@ -15,6 +15,36 @@
 #define _SHUFFLE_H
 
 #ifndef ARCH_MIN_SSE2
+#ifdef ARCH_MIN_ARM_NEON
+INLINE static void SHUFFLE_VECTOR(short* VD, short* VT, const int e)
+{
+    int16x8_t xmm;
+
+    switch (e)
+    {
+        case 0x2: /* 0Q */
+            xmm = vld1q_s16(VT);
+            xmm = vtrnq_s16(xmm, xmm).val[0];
+            break;
+        case 0x3: /* 1Q */
+            xmm = vld1q_s16(VT);
+            xmm = vtrnq_s16(xmm, xmm).val[1];
+            break;
+        case 0x4: case 0x5: case 0x6: case 0x7: /* 0H to 3H */
+            xmm = vcombine_s16(vdup_n_s16(VT[e & 3]), vdup_n_s16(VT[e & 7]));
+            break;
+        case 0x8: case 0x9: case 0xA: case 0xB: /* scalar wholes */
+        case 0xC: case 0xD: case 0xE: case 0xF:
+            xmm = vdupq_n_s16(VT[e & 7]);
+            break;
+        default: /* vector operands */
+            xmm = vld1q_s16(VT);
+            break;
+    }
+    vst1q_s16(VD, xmm);
+    return;
+}
+#else
 /*
  * vector-scalar element decoding
  * Obsolete.  Consider using at least the SSE2 algorithms instead.
@@ -72,6 +102,7 @@ INLINE static void SHUFFLE_VECTOR(short* VD, short* VT, const int e)
         *(VD + i) = *(SV + i);
     return;
 }
+#endif
 #else
 #ifdef ARCH_MIN_SSSE3
 static const unsigned char smask[16][16] = {
@@ -127,7 +158,7 @@ static const int simm[16] = {
     SHUFFLE(07, 07, 07, 07)
 };
 
-static __m128i shuffle_none(__m128i xmm)
+INLINE static __m128i shuffle_none(__m128i xmm)
 {/*
     const int order = simm[0x0];
 
@@ -135,7 +166,7 @@ static __m128i shuffle_none(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);*/
     return (xmm);
 }
-static __m128i shuffle_0q(__m128i xmm)
+INLINE static __m128i shuffle_0q(__m128i xmm)
 {
     const int order = simm[0x2];
 
@@ -143,7 +174,7 @@ static __m128i shuffle_0q(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_1q(__m128i xmm)
+INLINE static __m128i shuffle_1q(__m128i xmm)
 {
     const int order = simm[0x3];
 
@@ -151,7 +182,7 @@ static __m128i shuffle_1q(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_0h(__m128i xmm)
+INLINE static __m128i shuffle_0h(__m128i xmm)
 {
     const int order = simm[0x4];
 
@@ -159,7 +190,7 @@ static __m128i shuffle_0h(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_1h(__m128i xmm)
+INLINE static __m128i shuffle_1h(__m128i xmm)
 {
     const int order = simm[0x5];
 
@@ -167,7 +198,7 @@ static __m128i shuffle_1h(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_2h(__m128i xmm)
+INLINE static __m128i shuffle_2h(__m128i xmm)
 {
     const int order = simm[0x6];
 
@@ -175,7 +206,7 @@ static __m128i shuffle_2h(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_3h(__m128i xmm)
+INLINE static __m128i shuffle_3h(__m128i xmm)
 {
     const int order = simm[0x7];
 
@@ -183,7 +214,7 @@ static __m128i shuffle_3h(__m128i xmm)
     xmm = _mm_shufflelo_epi16(xmm, order);
     return (xmm);
 }
-static __m128i shuffle_0w(__m128i xmm)
+INLINE static __m128i shuffle_0w(__m128i xmm)
 {
     const int order = simm[0x8];
 
@@ -191,7 +222,7 @@ static __m128i shuffle_0w(__m128i xmm)
     xmm = _mm_unpacklo_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_1w(__m128i xmm)
+INLINE static __m128i shuffle_1w(__m128i xmm)
 {
     const int order = simm[0x9];
 
@@ -199,7 +230,7 @@ static __m128i shuffle_1w(__m128i xmm)
     xmm = _mm_unpacklo_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_2w(__m128i xmm)
+INLINE static __m128i shuffle_2w(__m128i xmm)
 {
     const int order = simm[0xA];
 
@@ -207,7 +238,7 @@ static __m128i shuffle_2w(__m128i xmm)
     xmm = _mm_unpacklo_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_3w(__m128i xmm)
+INLINE static __m128i shuffle_3w(__m128i xmm)
 {
     const int order = simm[0xB];
 
@@ -215,7 +246,7 @@ static __m128i shuffle_3w(__m128i xmm)
     xmm = _mm_unpacklo_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_4w(__m128i xmm)
+INLINE static __m128i shuffle_4w(__m128i xmm)
 {
     const int order = simm[0xC];
 
@@ -223,7 +254,7 @@ static __m128i shuffle_4w(__m128i xmm)
     xmm = _mm_unpackhi_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_5w(__m128i xmm)
+INLINE static __m128i shuffle_5w(__m128i xmm)
 {
     const int order = simm[0xD];
 
@@ -231,7 +262,7 @@ static __m128i shuffle_5w(__m128i xmm)
     xmm = _mm_unpackhi_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_6w(__m128i xmm)
+INLINE static __m128i shuffle_6w(__m128i xmm)
 {
     const int order = simm[0xE];
 
@@ -239,7 +270,7 @@ static __m128i shuffle_6w(__m128i xmm)
     xmm = _mm_unpackhi_epi16(xmm, xmm);
     return (xmm);
 }
-static __m128i shuffle_7w(__m128i xmm)
+INLINE static __m128i shuffle_7w(__m128i xmm)
 {
     const int order = simm[0xF];
 
@@ -248,20 +279,33 @@ static __m128i shuffle_7w(__m128i xmm)
     return (xmm);
 }
 
-static __m128i (*SSE2_SHUFFLE_16[16])(__m128i) = {
-    shuffle_none, shuffle_none,
-    shuffle_0q, shuffle_1q,
-    shuffle_0h, shuffle_1h, shuffle_2h, shuffle_3h,
-    shuffle_0w, shuffle_1w, shuffle_2w, shuffle_3w,
-    shuffle_4w, shuffle_5w, shuffle_6w, shuffle_7w
-};
-
+/*
+ * A switch lets the compiler inline the chosen PSHUFLW/PSHUFHW pair instead
+ * of making an indirect call through a table for every vector operation.
+ */
 INLINE static void SHUFFLE_VECTOR(short* VD, short* VT, const int e)
 {
     __m128i xmm;
 
     xmm = _mm_load_si128((__m128i *)VT);
-    xmm = SSE2_SHUFFLE_16[e](xmm);
+    switch (e)
+    {
+        case 0x2:  xmm = shuffle_0q(xmm);  break;
+        case 0x3:  xmm = shuffle_1q(xmm);  break;
+        case 0x4:  xmm = shuffle_0h(xmm);  break;
+        case 0x5:  xmm = shuffle_1h(xmm);  break;
+        case 0x6:  xmm = shuffle_2h(xmm);  break;
+        case 0x7:  xmm = shuffle_3h(xmm);  break;
+        case 0x8:  xmm = shuffle_0w(xmm);  break;
+        case 0x9:  xmm = shuffle_1w(xmm);  break;
+        case 0xA:  xmm = shuffle_2w(xmm);  break;
+        case 0xB:  xmm = shuffle_3w(xmm);  break;
+        case 0xC:  xmm = shuffle_4w(xmm);  break;
+        case 0xD:  xmm = shuffle_5w(xmm);  break;
+        case 0xE:  xmm = shuffle_6w(xmm);  break;
+        case 0xF:  xmm = shuffle_7w(xmm);  break;
+        default:   xmm = shuffle_none(xmm);  break;
+    }
     _mm_store_si128((__m128i *)VD, xmm);
     return;
 }
@@ -0,0 +1,55 @@
+/******************************************************************************\
+* Project:  MSP Emulation Layer for Vector Unit Computational Operations       *
+* Authors:  Iconoclast                                                         *
+* Release:  2013.12.12                                                         *
+* License:  CC0 Public Domain Dedication                                       *
+*                                                                              *
+* To the extent possible under law, the author(s) have dedicated all copyright *
+* and related and neighboring rights to this software to the public domain     *
+* worldwide. This software is distributed without any warranty.                *
+*                                                                              *
+* You should have received a copy of the CC0 Public Domain Dedication along    *
+* with this software.                                                          *
+* If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.             *
+\******************************************************************************/
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#ifdef _MSC_VER
+#define NOINLINE    __declspec(noinline)
+#define ALIGNED     _declspec(align(16))
+#else
+#define NOINLINE    __attribute__((noinline))
+#define ALIGNED     __attribute__((aligned(16)))
+#endif
+
+/*
+ * Streaming SIMD Extensions version import management
+ *
+ * The vector unit kernels are picked from whatever the compiler targets.
+ * Define VU_SCALAR_REFERENCE to build the plain C loops instead, which are
+ * kept as the reference every SIMD kernel must match bit for bit.
+ */
+#ifndef VU_SCALAR_REFERENCE
+#if defined(__SSSE3__)
+#define ARCH_MIN_SSSE3
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCH_MIN_SSE2
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ARCH_MIN_ARM_NEON
+#endif
+#endif
+
+#ifdef ARCH_MIN_ARM_NEON
+#include <arm_neon.h>
+#endif
+#ifdef ARCH_MIN_SSSE3
+#define ARCH_MIN_SSE2
+#include <tmmintrin.h>
+#endif
+#ifdef ARCH_MIN_SSE2
+#include <emmintrin.h>
+#endif
+#endif
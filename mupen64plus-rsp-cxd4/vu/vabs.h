@@ -14,11 +14,43 @@
 #include "vu.h"
 
 /*
- * -1:  VT *= -1, because VS < 0 // VT ^= -2 if even, or ^= -1, += 1
- *  0:  VT *=  0, because VS = 0 // VT ^= VT
- * +1:  VT *= +1, because VS > 0 // VT ^=  0
- *      VT ^= -1, "negate" -32768 as ~+32767 (corner case hack for N64 SP)
+ * -1:  VT *= -1, because VS < 0
+ *  0:  VT *=  0, because VS = 0
+ * +1:  VT *= +1, because VS > 0
+ *
+ * The accumulator keeps the wrapped product, so -(-32768) is -32768 there,
+ * but the result written to VD is saturated to +32767.
  */
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_abs(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, sn, nz;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    sn = _mm_srai_epi16(vs, 15);
+    nz = _mm_cmpeq_epi16(vs, _mm_setzero_si128());
+    vt = _mm_andnot_si128(nz, vt);
+    vt = _mm_xor_si128(vt, sn);
+    _mm_store_si128((__m128i *)VACC_L, _mm_sub_epi16(vt, sn));
+    _mm_store_si128((__m128i *)VD, _mm_subs_epi16(vt, sn));
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_abs(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, sn;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    sn = vshrq_n_s16(vs, 15);
+    vt = vbicq_s16(vt, vreinterpretq_s16_u16(vceqq_s16(vs, vdupq_n_s16(0))));
+    vt = veorq_s16(vt, sn);
+    vst1q_s16(VACC_L, vsubq_s16(vt, sn));
+    vst1q_s16(VD, vqsubq_s16(vt, sn));
+    return;
+}
+#else
 INLINE static void do_abs(short* VD, short* VS, short* VT)
 {
     short neg[N], pos[N];
@@ -27,49 +59,26 @@ INLINE static void do_abs(short* VD, short* VS, short* VT)
     register int i;
 
     vector_copy(res, VT);
-#ifndef ARCH_MIN_SSE2
-#define MASK_XOR
-#endif
     for (i = 0; i < N; i++)
         neg[i]  = (VS[i] <  0x0000);
     for (i = 0; i < N; i++)
         pos[i]  = (VS[i] >  0x0000);
     for (i = 0; i < N; i++)
-        nez[i]  = 0;
-#ifdef MASK_XOR
-    for (i = 0; i < N; i++)
-        neg[i]  = -neg[i];
-    for (i = 0; i < N; i++)
-        nez[i] += neg[i];
-#else
-    for (i = 0; i < N; i++)
-        nez[i] -= neg[i];
-#endif
-    for (i = 0; i < N; i++)
-        nez[i] += pos[i];
-#ifdef MASK_XOR
-    for (i = 0; i < N; i++)
-        res[i] ^= nez[i];
-    for (i = 0; i < N; i++)
-        cch[i]  = (res[i] != -32768);
-    for (i = 0; i < N; i++)
-        res[i] += cch[i]; /* -(x) === (x ^ -1) + 1 */
-#else
+        nez[i]  = pos[i] - neg[i];
     for (i = 0; i < N; i++)
         res[i] *= nez[i];
     for (i = 0; i < N; i++)
-        cch[i]  = (res[i] == -32768);
-    for (i = 0; i < N; i++)
-        res[i] -= cch[i];
-#endif
+        cch[i]  = (res[i] == -32768) & neg[i];
     vector_copy(VACC_L, res);
-    vector_copy(VD, VACC_L);
+    for (i = 0; i < N; i++)
+        VD[i] = res[i] - cch[i];
     return;
 }
+#endif
 
 static void VABS(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_abs(VR[vd], VR[vs], ST);
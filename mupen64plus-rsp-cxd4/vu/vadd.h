@@ -29,7 +29,7 @@ INLINE static void clr_ci(short* VD, short* VS, short* VT)
 
 static void VADD(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     clr_ci(VR[vd], VR[vs], ST);
@@ -32,7 +32,7 @@ INLINE static void set_co(short* VD, short* VS, short* VT)
 
 static void VADDC(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     set_co(VR[vd], VR[vs], ST);
@@ -13,6 +13,72 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_ch(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, vc, sn, one;
+    __m128i eq, ge, le, ce, cmp;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    one = _mm_set1_epi16(1);
+    sn = _mm_srai_epi16(_mm_xor_si128(vs, vt), 15);
+    vc = _mm_xor_si128(vt, sn); /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
+    ce = _mm_and_si128(_mm_cmpeq_epi16(vs, vc), sn);
+    ce = _mm_and_si128(ce, one);
+    vc = _mm_sub_epi16(vc, sn); /* converts ~(VT) into -(VT) if (sign) */
+    eq = _mm_and_si128(_mm_cmpeq_epi16(vs, vc), one);
+    eq = _mm_or_si128(eq, ce);
+
+    ge = _mm_andnot_si128(_mm_cmpgt_epi16(vt, _mm_or_si128(sn, vs)), one);
+    le = _mm_andnot_si128(_mm_srai_epi16(_mm_sub_epi16(vc, vs), 15), one);
+    le = select_epi16(sn, le, _mm_srli_epi16(vt, 15));
+    cmp = select_epi16(sn, le, ge);
+    vs = select_epi16(_mm_cmpeq_epi16(cmp, one), vc, vs);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+
+    _mm_store_si128((__m128i *)clip, ge);
+    _mm_store_si128((__m128i *)comp, le);
+    _mm_store_si128((__m128i *)ne, _mm_xor_si128(eq, one));
+    _mm_store_si128((__m128i *)co, _mm_srli_epi16(sn, 15));
+    _mm_store_si128((__m128i *)vce, ce);
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_ch(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, vc, sn, one;
+    int16x8_t eq, ge, le, ce, cmp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    one = vdupq_n_s16(1);
+    sn = vshrq_n_s16(veorq_s16(vs, vt), 15);
+    vc = veorq_s16(vt, sn); /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
+    ce = vandq_s16(vreinterpretq_s16_u16(vceqq_s16(vs, vc)), sn);
+    ce = vandq_s16(ce, one);
+    vc = vsubq_s16(vc, sn); /* converts ~(VT) into -(VT) if (sign) */
+    eq = vandq_s16(vreinterpretq_s16_u16(vceqq_s16(vs, vc)), one);
+    eq = vorrq_s16(eq, ce);
+
+    ge = vandq_s16(vreinterpretq_s16_u16(vcgeq_s16(vorrq_s16(sn, vs), vt)), one);
+    le = vandq_s16(vreinterpretq_s16_u16(vcgeq_s16(vsubq_s16(vc, vs), vdupq_n_s16(0))), one);
+    le = select_s16(vreinterpretq_u16_s16(sn), le,
+        vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(vt), 15)));
+    cmp = select_s16(vreinterpretq_u16_s16(sn), le, ge);
+    vs = select_s16(vceqq_s16(cmp, one), vc, vs);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+    vst1q_s16(clip, ge);
+    vst1q_s16(comp, le);
+    vst1q_s16(ne, veorq_s16(eq, one));
+    vst1q_s16(co, vandq_s16(sn, one));
+    vst1q_s16(vce, ce);
+    return;
+}
+#else
 INLINE static void do_ch(short* VD, short* VS, short* VT)
 {
     ALIGNED short VC[N];
@@ -80,10 +146,11 @@ INLINE static void do_ch(short* VD, short* VS, short* VT)
     vector_copy(co, sn);
     return;
 }
+#endif
 
 static void VCH(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_ch(VR[vd], VR[vs], ST);
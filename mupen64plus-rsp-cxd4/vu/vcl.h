@@ -13,6 +13,85 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_cl(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, vc, sn, eq, ce, one, zero;
+    __m128i ge, le, gen, len, lz, uz, cmp;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    one = _mm_set1_epi16(1);
+    zero = _mm_setzero_si128();
+    sn = _mm_load_si128((__m128i *)co);
+    eq = _mm_xor_si128(_mm_load_si128((__m128i *)ne), one);
+    ce = _mm_load_si128((__m128i *)vce);
+
+    vc = _mm_xor_si128(vt, _mm_sub_epi16(zero, sn));
+    vc = _mm_add_epi16(vc, sn); /* conditional negation, if sn */
+    lz = _mm_and_si128(_mm_cmpeq_epi16(vs, vc), one);
+    uz = _mm_cmpeq_epi16(_mm_adds_epu16(vs, vt), _mm_add_epi16(vs, vt));
+    uz = _mm_and_si128(uz, one); /* no carry out of (VS + VT) */
+    gen = _mm_and_si128(_mm_or_si128(lz, uz), ce);
+    len = _mm_andnot_si128(ce, _mm_and_si128(lz, uz));
+    len = _mm_or_si128(len, gen);
+    gen = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(vc, vs), zero), one);
+
+    cmp = _mm_cmpeq_epi16(_mm_and_si128(eq, sn), one);
+    le = select_epi16(cmp, len, _mm_load_si128((__m128i *)comp));
+    cmp = _mm_cmpeq_epi16(_mm_andnot_si128(sn, eq), one);
+    ge = select_epi16(cmp, gen, _mm_load_si128((__m128i *)clip));
+    cmp = select_epi16(_mm_cmpeq_epi16(sn, one), le, ge);
+    vs = select_epi16(_mm_cmpeq_epi16(cmp, one), vc, vs);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+
+    _mm_store_si128((__m128i *)clip, ge);
+    _mm_store_si128((__m128i *)comp, le);
+    _mm_store_si128((__m128i *)ne, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)co, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)vce, zero);
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_cl(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, vc, sn, eq, ce, one, zero;
+    int16x8_t ge, le, gen, len, lz, uz, cmp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    one = vdupq_n_s16(1);
+    zero = vdupq_n_s16(0);
+    sn = vld1q_s16(co);
+    eq = veorq_s16(vld1q_s16(ne), one);
+    ce = vld1q_s16(vce);
+
+    vc = veorq_s16(vt, vnegq_s16(sn));
+    vc = vaddq_s16(vc, sn); /* conditional negation, if sn */
+    lz = vandq_s16(vreinterpretq_s16_u16(vceqq_s16(vs, vc)), one);
+    uz = vbicq_s16(one, vreinterpretq_s16_u16(carry_u16(vs, vt)));
+    gen = vandq_s16(vorrq_s16(lz, uz), ce);
+    len = vbicq_s16(vandq_s16(lz, uz), ce);
+    len = vorrq_s16(len, gen);
+    gen = vandq_s16(vreinterpretq_s16_u16(vcgeq_u16(
+        vreinterpretq_u16_s16(vs), vreinterpretq_u16_s16(vc))), one);
+
+    le = select_s16(vceqq_s16(vandq_s16(eq, sn), one), len, vld1q_s16(comp));
+    ge = select_s16(vceqq_s16(vbicq_s16(eq, sn), one), gen, vld1q_s16(clip));
+    cmp = select_s16(vceqq_s16(sn, one), le, ge);
+    vs = select_s16(vceqq_s16(cmp, one), vc, vs);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+    vst1q_s16(clip, ge);
+    vst1q_s16(comp, le);
+    vst1q_s16(ne, vdupq_n_s16(0));
+    vst1q_s16(co, vdupq_n_s16(0));
+    vst1q_s16(vce, zero);
+    return;
+}
+#else
 INLINE static void do_cl(short* VD, short* VS, short* VT)
 {
     ALIGNED unsigned short VB[N], VC[N];
@@ -85,10 +164,11 @@ INLINE static void do_cl(short* VD, short* VS, short* VT)
         vce[i] = 0;
     return;
 }
+#endif
 
 static void VCL(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_cl(VR[vd], VR[vs], ST);
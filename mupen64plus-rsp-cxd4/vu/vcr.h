@@ -13,6 +13,55 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_cr(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, sn, ge, le, one;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    one = _mm_set1_epi16(1);
+    sn = _mm_srai_epi16(_mm_xor_si128(vs, vt), 15);
+    le = _mm_andnot_si128(_mm_and_si128(vs, sn), _mm_cmpeq_epi16(vs, vs));
+    le = _mm_andnot_si128(_mm_cmpgt_epi16(vt, le), one);
+    ge = _mm_andnot_si128(_mm_cmpgt_epi16(vt, _mm_or_si128(vs, sn)), one);
+    vt = _mm_xor_si128(vt, sn); /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
+    vs = select_epi16(_mm_cmpeq_epi16(le, one), vt, vs);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+
+    _mm_store_si128((__m128i *)clip, ge);
+    _mm_store_si128((__m128i *)comp, le);
+    _mm_store_si128((__m128i *)ne, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)co, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)vce, _mm_setzero_si128());
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_cr(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, sn, ge, le, one;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    one = vdupq_n_s16(1);
+    sn = vshrq_n_s16(veorq_s16(vs, vt), 15);
+    le = vmvnq_s16(vandq_s16(vs, sn));
+    le = vandq_s16(vreinterpretq_s16_u16(vcleq_s16(vt, le)), one);
+    ge = vandq_s16(vreinterpretq_s16_u16(vcgeq_s16(vorrq_s16(vs, sn), vt)), one);
+    vt = veorq_s16(vt, sn); /* if (sn == ~0) {VT = ~VT;} else {VT =  VT;} */
+    vs = select_s16(vceqq_s16(le, one), vt, vs);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+
+    vst1q_s16(clip, ge);
+    vst1q_s16(comp, le);
+    vst1q_s16(ne, vdupq_n_s16(0));
+    vst1q_s16(co, vdupq_n_s16(0));
+    vst1q_s16(vce, vdupq_n_s16(0));
+    return;
+}
+#else
 INLINE static void do_cr(short* VD, short* VS, short* VT)
 {
     short ge[N], le[N], sn[N];
@@ -56,10 +105,11 @@ INLINE static void do_cr(short* VD, short* VS, short* VT)
         vce[i] = 0;
     return;
 }
+#endif
 
 static void VCR(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_cr(VR[vd], VR[vs], ST);
@@ -13,6 +13,51 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_ge(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, cn, eq, cmp, one;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    one = _mm_set1_epi16(1);
+    cn = _mm_and_si128(_mm_load_si128((__m128i *)ne), _mm_load_si128((__m128i *)co));
+    eq = _mm_and_si128(_mm_cmpeq_epi16(vs, vt), one);
+    eq = _mm_andnot_si128(cn, eq);
+    cmp = _mm_and_si128(_mm_cmpgt_epi16(vs, vt), one);
+    cmp = _mm_or_si128(cmp, eq);
+    _mm_store_si128((__m128i *)clip, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)comp, cmp);
+    vs = select_epi16(_mm_cmpeq_epi16(cmp, one), vs, vt);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+    _mm_store_si128((__m128i *)ne, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)co, _mm_setzero_si128());
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_ge(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, cn, eq, cmp, one;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    one = vdupq_n_s16(1);
+    cn = vandq_s16(vld1q_s16(ne), vld1q_s16(co));
+    eq = vandq_s16(vreinterpretq_s16_u16(vceqq_s16(vs, vt)), one);
+    eq = vbicq_s16(eq, cn);
+    cmp = vandq_s16(vreinterpretq_s16_u16(vcgtq_s16(vs, vt)), one);
+    cmp = vorrq_s16(cmp, eq);
+    vst1q_s16(clip, vdupq_n_s16(0));
+    vst1q_s16(comp, cmp);
+    vs = select_s16(vceqq_s16(cmp, one), vs, vt);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+    vst1q_s16(ne, vdupq_n_s16(0));
+    vst1q_s16(co, vdupq_n_s16(0));
+    return;
+}
+#else
 INLINE static void do_ge(short* VD, short* VS, short* VT)
 {
     short ce[N];
@@ -40,10 +85,11 @@ INLINE static void do_ge(short* VD, short* VS, short* VT)
         co[i] = 0;
     return;
 }
+#endif
 
 static void VGE(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_ge(VR[vd], VR[vs], ST);
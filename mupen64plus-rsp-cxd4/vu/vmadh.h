@@ -13,6 +13,49 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_madh(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, lo, hi;
+    __m128i acc_m, acc_h;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    acc_m = _mm_load_si128((__m128i *)VACC_M);
+    acc_h = _mm_load_si128((__m128i *)VACC_H);
+    lo = _mm_mullo_epi16(vs, vt);
+    hi = _mm_mulhi_epi16(vs, vt);
+
+    acc_h = _mm_add_epi16(acc_h, hi);
+    acc_h = _mm_sub_epi16(acc_h, carry_epu16(acc_m, lo));
+    acc_m = _mm_add_epi16(acc_m, lo);
+    _mm_store_si128((__m128i *)VACC_M, acc_m);
+    _mm_store_si128((__m128i *)VACC_H, acc_h);
+    _mm_store_si128((__m128i *)VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_madh(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, lo, hi;
+    int16x8_t acc_m, acc_h;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    acc_m = vld1q_s16(VACC_M);
+    acc_h = vld1q_s16(VACC_H);
+    lo = mullo_s16(vs, vt);
+    hi = mulhi_s16(vs, vt);
+
+    acc_h = vaddq_s16(acc_h, hi);
+    acc_h = vsubq_s16(acc_h, vreinterpretq_s16_u16(carry_u16(acc_m, lo)));
+    acc_m = vaddq_s16(acc_m, lo);
+    vst1q_s16(VACC_M, acc_m);
+    vst1q_s16(VACC_H, acc_h);
+    vst1q_s16(VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#else
 INLINE static void do_madh(short* VD, short* VS, short* VT)
 {
     int32_t product[N];
@@ -30,10 +73,11 @@ INLINE static void do_madh(short* VD, short* VS, short* VT)
     SIGNED_CLAMP_AM(VD);
     return;
 }
+#endif
 
 static void VMADH(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_madh(VR[vd], VR[vs], ST);
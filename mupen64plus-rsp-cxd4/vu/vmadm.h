@@ -13,6 +13,63 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_madm(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, lo, hi;
+    __m128i acc_l, acc_m, acc_h, carry, ones;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    acc_l = _mm_load_si128((__m128i *)VACC_L);
+    acc_m = _mm_load_si128((__m128i *)VACC_M);
+    acc_h = _mm_load_si128((__m128i *)VACC_H);
+    ones = _mm_cmpeq_epi16(vs, vs);
+    lo = _mm_mullo_epi16(vs, vt);
+    hi = mulhi_su(vs, vt);
+
+    carry = carry_epu16(acc_l, lo);
+    acc_l = _mm_add_epi16(acc_l, lo);
+    acc_h = _mm_add_epi16(acc_h, _mm_srai_epi16(hi, 15));
+    acc_h = _mm_sub_epi16(acc_h, carry_epu16(acc_m, hi));
+    acc_m = _mm_add_epi16(acc_m, hi);
+    acc_h = _mm_sub_epi16(acc_h, _mm_and_si128(carry, _mm_cmpeq_epi16(acc_m, ones)));
+    acc_m = _mm_sub_epi16(acc_m, carry);
+    _mm_store_si128((__m128i *)VACC_L, acc_l);
+    _mm_store_si128((__m128i *)VACC_M, acc_m);
+    _mm_store_si128((__m128i *)VACC_H, acc_h);
+    _mm_store_si128((__m128i *)VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_madm(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, lo, hi;
+    int16x8_t acc_l, acc_m, acc_h, carry;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    acc_l = vld1q_s16(VACC_L);
+    acc_m = vld1q_s16(VACC_M);
+    acc_h = vld1q_s16(VACC_H);
+    lo = mullo_s16(vs, vt);
+    hi = mulhi_su(vs, vt);
+
+    carry = vreinterpretq_s16_u16(carry_u16(acc_l, lo));
+    acc_l = vaddq_s16(acc_l, lo);
+    acc_h = vaddq_s16(acc_h, vshrq_n_s16(hi, 15));
+    acc_h = vsubq_s16(acc_h, vreinterpretq_s16_u16(carry_u16(acc_m, hi)));
+    acc_m = vaddq_s16(acc_m, hi);
+    acc_h = vsubq_s16(acc_h, vandq_s16(carry,
+        vreinterpretq_s16_u16(vceqq_s16(acc_m, vdupq_n_s16(-1)))));
+    acc_m = vsubq_s16(acc_m, carry);
+    vst1q_s16(VACC_L, acc_l);
+    vst1q_s16(VACC_M, acc_m);
+    vst1q_s16(VACC_H, acc_h);
+    vst1q_s16(VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#else
 INLINE static void do_madm(short* VD, short* VS, short* VT)
 {
     uint32_t addend[N];
@@ -33,10 +90,11 @@ INLINE static void do_madm(short* VD, short* VS, short* VT)
     SIGNED_CLAMP_AM(VD);
     return;
 }
+#endif
 
 static void VMADM(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_madm(VR[vd], VR[vs], ST);
@@ -13,16 +13,45 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_mrg(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, cmp;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    cmp = _mm_cmpeq_epi16(_mm_load_si128((__m128i *)comp), _mm_set1_epi16(1));
+    vs = select_epi16(cmp, vs, vt);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_mrg(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt;
+    uint16x8_t cmp;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    cmp = vceqq_s16(vld1q_s16(comp), vdupq_n_s16(1));
+    vs = select_s16(cmp, vs, vt);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+    return;
+}
+#else
 INLINE static void do_mrg(short* VD, short* VS, short* VT)
 {
     merge(VACC_L, comp, VS, VT);
     vector_copy(VD, VACC_L);
     return;
 }
+#endif
 
 static void VMRG(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_mrg(VR[vd], VR[vs], ST);
@@ -13,6 +13,37 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_mudh(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, lo, hi;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    lo = _mm_mullo_epi16(vs, vt);
+    hi = _mm_mulhi_epi16(vs, vt);
+    _mm_store_si128((__m128i *)VACC_L, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)VACC_M, lo);
+    _mm_store_si128((__m128i *)VACC_H, hi);
+    _mm_store_si128((__m128i *)VD, clamp_am(lo, hi));
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_mudh(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, lo, hi;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    lo = mullo_s16(vs, vt);
+    hi = mulhi_s16(vs, vt);
+    vst1q_s16(VACC_L, vdupq_n_s16(0));
+    vst1q_s16(VACC_M, lo);
+    vst1q_s16(VACC_H, hi);
+    vst1q_s16(VD, clamp_am(lo, hi));
+    return;
+}
+#else
 INLINE static void do_mudh(short* VD, short* VS, short* VT)
 {
     register int i;
@@ -26,10 +57,11 @@ INLINE static void do_mudh(short* VD, short* VS, short* VT)
     SIGNED_CLAMP_AM(VD);
     return;
 }
+#endif
 
 static void VMUDH(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_mudh(VR[vd], VR[vs], ST);
@@ -13,12 +13,41 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_mudl(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, prod;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    prod = _mm_mulhi_epu16(vs, vt);
+    _mm_store_si128((__m128i *)VACC_L, prod);
+    _mm_store_si128((__m128i *)VACC_M, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)VACC_H, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)VD, prod);
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_mudl(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, prod;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    prod = mulhi_u16(vs, vt);
+    vst1q_s16(VACC_L, prod);
+    vst1q_s16(VACC_M, vdupq_n_s16(0));
+    vst1q_s16(VACC_H, vdupq_n_s16(0));
+    vst1q_s16(VD, prod);
+    return;
+}
+#else
 INLINE static void do_mudl(short* VD, short* VS, short* VT)
 {
     register int i;
 
     for (i = 0; i < N; i++)
-        VACC_L[i] = (unsigned short)(VS[i])*(unsigned short)(VT[i]) >> 16;
+        VACC_L[i] = (uint32_t)(unsigned short)(VS[i])*(unsigned short)(VT[i]) >> 16;
     for (i = 0; i < N; i++)
         VACC_M[i] = 0x0000;
     for (i = 0; i < N; i++)
@@ -26,10 +55,11 @@ INLINE static void do_mudl(short* VD, short* VS, short* VT)
     vector_copy(VD, VACC_L); /* no possibilities to clamp */
     return;
 }
+#endif
 
 static void VMUDL(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_mudl(VR[vd], VR[vs], ST);
@@ -13,6 +13,37 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_mudn(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, lo, hi;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    lo = _mm_mullo_epi16(vs, vt);
+    hi = mulhi_su(vt, vs);
+    _mm_store_si128((__m128i *)VACC_L, lo);
+    _mm_store_si128((__m128i *)VACC_M, hi);
+    _mm_store_si128((__m128i *)VACC_H, _mm_srai_epi16(hi, 15));
+    _mm_store_si128((__m128i *)VD, lo);
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_mudn(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, lo, hi;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    lo = mullo_s16(vs, vt);
+    hi = mulhi_su(vt, vs);
+    vst1q_s16(VACC_L, lo);
+    vst1q_s16(VACC_M, hi);
+    vst1q_s16(VACC_H, vshrq_n_s16(hi, 15));
+    vst1q_s16(VD, lo);
+    return;
+}
+#else
 INLINE static void do_mudn(short* VD, short* VS, short* VT)
 {
     register int i;
@@ -26,10 +57,11 @@ INLINE static void do_mudn(short* VD, short* VS, short* VT)
     vector_copy(VD, VACC_L); /* no possibilities to clamp */
     return;
 }
+#endif
 
 static void VMUDN(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_mudn(VR[vd], VR[vs], ST);
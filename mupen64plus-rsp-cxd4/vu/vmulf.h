@@ -25,6 +25,54 @@
 #define SEMIFRAC    (VS[i]*VT[i]*2/2 + 0x8000/2)
 #endif
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_mulf(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, lo, hi;
+    __m128i acc_l, acc_m, acc_h;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    lo = _mm_mullo_epi16(vs, vt);
+    hi = _mm_mulhi_epi16(vs, vt);
+
+    acc_l = _mm_slli_epi16(lo, 1);
+    acc_m = _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+    acc_m = _mm_add_epi16(acc_m, _mm_srli_epi16(acc_l, 15)); /* + 0x8000 */
+    acc_l = _mm_xor_si128(acc_l, _mm_set1_epi16(-0x8000));
+    acc_h = _mm_andnot_si128(_mm_cmpeq_epi16(vs, vt), _mm_srai_epi16(acc_m, 15));
+    _mm_store_si128((__m128i *)VACC_L, acc_l);
+    _mm_store_si128((__m128i *)VACC_M, acc_m);
+    _mm_store_si128((__m128i *)VACC_H, acc_h);
+    _mm_store_si128((__m128i *)VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_mulf(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, lo, hi;
+    int16x8_t acc_l, acc_m, acc_h;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    lo = mullo_s16(vs, vt);
+    hi = mulhi_s16(vs, vt);
+
+    acc_l = vshlq_n_s16(lo, 1);
+    acc_m = vorrq_s16(vshlq_n_s16(hi, 1),
+        vreinterpretq_s16_u16(vshrq_n_u16(vreinterpretq_u16_s16(lo), 15)));
+    acc_m = vaddq_s16(acc_m, vreinterpretq_s16_u16(
+        vshrq_n_u16(vreinterpretq_u16_s16(acc_l), 15))); /* + 0x8000 */
+    acc_l = veorq_s16(acc_l, vdupq_n_s16(-0x8000));
+    acc_h = vbicq_s16(vshrq_n_s16(acc_m, 15),
+        vreinterpretq_s16_u16(vceqq_s16(vs, vt)));
+    vst1q_s16(VACC_L, acc_l);
+    vst1q_s16(VACC_M, acc_m);
+    vst1q_s16(VACC_H, acc_h);
+    vst1q_s16(VD, clamp_am(acc_m, acc_h));
+    return;
+}
+#else
 INLINE static void do_mulf(short* VD, short* VS, short* VT)
 {
     register int i;
@@ -35,19 +83,14 @@ INLINE static void do_mulf(short* VD, short* VS, short* VT)
         VACC_M[i] = (SEMIFRAC << 1) >> 16;
     for (i = 0; i < N; i++)
         VACC_H[i] = -((VACC_M[i] < 0) & (VS[i] != VT[i])); /* -32768 * -32768 */
-#ifndef ARCH_MIN_SSE2
-    vector_copy(VD, VACC_M);
-    for (i = 0; i < N; i++)
-        VD[i] -= (VACC_M[i] < 0) & (VS[i] == VT[i]); /* ACC b 31 set, min*min */
-#else
-    SIGNED_CLAMP_AM(VD);
-#endif
+    SIGNED_CLAMP_AM(VD); /* VD may be VS, so no more reads of VS after it */
     return;
 }
+#endif
 
 static void VMULF(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_mulf(VR[vd], VR[vs], ST);
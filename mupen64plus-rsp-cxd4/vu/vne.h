@@ -13,6 +13,42 @@
 \******************************************************************************/
 #include "vu.h"
 
+#if defined(ARCH_MIN_SSE2)
+INLINE static void do_ne(short* VD, short* VS, short* VT)
+{
+    __m128i vs, vt, neq, one;
+
+    vs = _mm_load_si128((__m128i *)VS);
+    vt = _mm_load_si128((__m128i *)VT);
+    one = _mm_set1_epi16(1);
+    neq = _mm_andnot_si128(_mm_cmpeq_epi16(vs, vt), one);
+    neq = _mm_or_si128(neq, _mm_load_si128((__m128i *)ne));
+    _mm_store_si128((__m128i *)clip, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)comp, neq);
+    _mm_store_si128((__m128i *)VACC_L, vs);
+    _mm_store_si128((__m128i *)VD, vs);
+    _mm_store_si128((__m128i *)ne, _mm_setzero_si128());
+    _mm_store_si128((__m128i *)co, _mm_setzero_si128());
+    return;
+}
+#elif defined(ARCH_MIN_ARM_NEON)
+INLINE static void do_ne(short* VD, short* VS, short* VT)
+{
+    int16x8_t vs, vt, neq;
+
+    vs = vld1q_s16(VS);
+    vt = vld1q_s16(VT);
+    neq = vbicq_s16(vdupq_n_s16(1), vreinterpretq_s16_u16(vceqq_s16(vs, vt)));
+    neq = vorrq_s16(neq, vld1q_s16(ne));
+    vst1q_s16(clip, vdupq_n_s16(0));
+    vst1q_s16(comp, neq);
+    vst1q_s16(VACC_L, vs);
+    vst1q_s16(VD, vs);
+    vst1q_s16(ne, vdupq_n_s16(0));
+    vst1q_s16(co, vdupq_n_s16(0));
+    return;
+}
+#else
 INLINE static void do_ne(short* VD, short* VS, short* VT)
 {
     register int i;
@@ -36,10 +72,11 @@ INLINE static void do_ne(short* VD, short* VS, short* VT)
         co[i] = 0;
     return;
 }
+#endif
 
 static void VNE(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_ne(VR[vd], VR[vs], ST);
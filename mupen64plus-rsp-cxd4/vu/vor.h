@@ -13,7 +13,7 @@
 \******************************************************************************/
 #include "vu.h"
 
-INLINE void do_or(short* VD, short* VS, short* VT)
+INLINE static void do_or(short* VD, short* VS, short* VT)
 {
     register int i;
 
@@ -25,7 +25,7 @@ INLINE void do_or(short* VD, short* VS, short* VT)
 
 static void VOR(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     do_or(VR[vd], VR[vs], ST);
@@ -32,7 +32,7 @@ INLINE static void set_bo(short* VD, short* VS, short* VT)
 
 static void VSUBC(int vd, int vs, int vt, int e)
 {
-    short ST[N];
+    ALIGNED short ST[N];
 
     SHUFFLE_VECTOR(ST, VR[vt], e);
     set_bo(VR[vd], VR[vs], ST);
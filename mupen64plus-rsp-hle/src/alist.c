@@ -31,6 +31,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "simd.h"
 
 struct ramp_t
 {
@@ -76,6 +77,51 @@ static void alist_envmix_mix(size_t n, int16_t** dst, const int16_t* gains, int1
         sample_mix(dst[i], src, gains[i]);
 }
 
+/* mixes count <= 8 samples of in into the first n of dl, dr, wl, wr.
+ * Buffers and volumes are indexed as stored, hence the ^S. */
+static void alist_envmix_frame(size_t n, int16_t** dst, const int16_t* in,
+        const int16_t* l_vol, const int16_t* r_vol, int16_t dry, int16_t wet,
+        size_t count)
+{
+    size_t i, x;
+
+#ifdef HLE_SIMD
+    if (count == 8) {
+        const v16 l = vload16(l_vol);
+        const v16 r = vload16(r_vol);
+        const v16 src = vload16(in);
+        v16 gains[4];
+
+        gains[0] = vmulr16(l, vdup16(dry));
+        gains[1] = vmulr16(r, vdup16(dry));
+        gains[2] = vmulr16(l, vdup16(wet));
+        gains[3] = vmulr16(r, vdup16(wet));
+
+        for (i = 0; i < n; ++i)
+            vstore16(dst[i], vmix16(vload16(dst[i]), src, gains[i]));
+        return;
+    }
+#endif
+
+    for (x = 0; x < count; ++x) {
+        int16_t  gains[4];
+        int16_t* buffers[4];
+
+        i = x ^ S;
+        buffers[0] = dst[0] + i;
+        buffers[1] = dst[1] + i;
+        buffers[2] = dst[2] + i;
+        buffers[3] = dst[3] + i;
+
+        gains[0] = clamp_s16((l_vol[i] * dry + 0x4000) >> 15);
+        gains[1] = clamp_s16((r_vol[i] * dry + 0x4000) >> 15);
+        gains[2] = clamp_s16((l_vol[i] * wet + 0x4000) >> 15);
+        gains[3] = clamp_s16((r_vol[i] * wet + 0x4000) >> 15);
+
+        alist_envmix_mix(n, buffers, gains, in[i]);
+    }
+}
+
 static int16_t ramp_step(struct ramp_t* ramp)
 {
 	bool target_reached;
@@ -153,6 +199,7 @@ void alist_load(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t cou
     dmem    &= ~3;
     address &= ~7;
     count = align(count, 8);
+    hle_capture_read(hle, address, count);
     memcpy(hle->alist_buffer + dmem, hle->dram + address, count);
 }
 
@@ -273,6 +320,10 @@ void alist_envmix_exp(
     int32_t exp_seq[2];
     int32_t exp_rates[2];
 
+    int16_t  l_vol[8];
+    int16_t  r_vol[8];
+    int16_t* buffers[4];
+
     uint32_t ptr = 0;
     int x, y;
     short *save_buffer = (short*)((uint8_t*)hle->dram + address);
@@ -287,6 +338,7 @@ void alist_envmix_exp(
         exp_seq[0]      = (vol[0] * rate[0]);
         exp_seq[1]      = (vol[1] * rate[1]);
     } else {
+        hle_capture_read(hle, address, 40);
         wet             = *(int16_t *)(save_buffer +  0); /* 0-1 */
         dry             = *(int16_t *)(save_buffer +  2); /* 2-3 */
         ramps[0].target = *(int32_t *)(save_buffer +  4); /* 4-5 */
@@ -318,24 +370,17 @@ void alist_envmix_exp(
         }
 
         for (x = 0; x < 8; ++x) {
-            int16_t  gains[4];
-            int16_t* buffers[4];
-            int16_t l_vol = ramp_step(&ramps[0]);
-            int16_t r_vol = ramp_step(&ramps[1]);
-
-            buffers[0] = dl + (ptr^S);
-            buffers[1] = dr + (ptr^S);
-            buffers[2] = wl + (ptr^S);
-            buffers[3] = wr + (ptr^S);
-
-            gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-            gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-            gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-            gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
-
-            alist_envmix_mix(n, buffers, gains, in[ptr^S]);
-            ++ptr;
+            l_vol[x^S] = ramp_step(&ramps[0]);
+            r_vol[x^S] = ramp_step(&ramps[1]);
         }
+
+        buffers[0] = dl + ptr;
+        buffers[1] = dr + ptr;
+        buffers[2] = wl + ptr;
+        buffers[3] = wr + ptr;
+
+        alist_envmix_frame(n, buffers, in + ptr, l_vol, r_vol, dry, wet, 8);
+        ptr += 8;
     }
 
     *(int16_t *)(save_buffer +  0) = wet;                       /* 0-1 */
@@ -383,6 +428,7 @@ void alist_envmix_ge(
         ramps[0].step   = rate[0] / 8;
         ramps[1].step   = rate[1] / 8;
     } else {
+        hle_capture_read(hle, address, 40);
         wet             = *(int16_t *)(save_buffer +  0);   /* 0-1 */
         dry             = *(int16_t *)(save_buffer +  2);   /* 2-3 */
         ramps[0].target = *(int32_t *)(save_buffer +  4);   /* 4-5 */
@@ -396,23 +442,23 @@ void alist_envmix_ge(
     }
 
     count >>= 1;
-    for (k = 0; k < count; ++k) {
-        int16_t  gains[4];
+    for (k = 0; k < count; k += 8) {
+        int16_t  l_vol[8];
+        int16_t  r_vol[8];
         int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
+        unsigned x, frame = (count - k < 8) ? count - k : 8;
 
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
+        for (x = 0; x < frame; ++x) {
+            l_vol[x^S] = ramp_step(&ramps[0]);
+            r_vol[x^S] = ramp_step(&ramps[1]);
+        }
 
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+        buffers[0] = dl + k;
+        buffers[1] = dr + k;
+        buffers[2] = wl + k;
+        buffers[3] = wr + k;
 
-        alist_envmix_mix(n, buffers, gains, in[k^S]);
+        alist_envmix_frame(n, buffers, in + k, l_vol, r_vol, dry, wet, frame);
     }
 
     *(int16_t *)(save_buffer +  0) = wet;                       /* 0-1 */
@@ -458,6 +504,7 @@ void alist_envmix_lin(
         ramps[1].target = (target[1] << 16);
     }
     else {
+        hle_capture_read(hle, address, 40);
         wet             = *(int16_t *)(save_buffer +  0); /* 0-1 */
         dry             = *(int16_t *)(save_buffer +  2); /* 2-3 */
         ramps[0].target = *(int16_t *)(save_buffer +  4) << 16; /* 4-5 */
@@ -469,23 +516,23 @@ void alist_envmix_lin(
     }
 
     count >>= 1;
-    for(k = 0; k < count; ++k) {
-        int16_t  gains[4];
+    for (k = 0; k < count; k += 8) {
+        int16_t  l_vol[8];
+        int16_t  r_vol[8];
         int16_t* buffers[4];
-        int16_t l_vol = ramp_step(&ramps[0]);
-        int16_t r_vol = ramp_step(&ramps[1]);
+        unsigned x, frame = (count - k < 8) ? count - k : 8;
 
-        buffers[0] = dl + (k^S);
-        buffers[1] = dr + (k^S);
-        buffers[2] = wl + (k^S);
-        buffers[3] = wr + (k^S);
+        for (x = 0; x < frame; ++x) {
+            l_vol[x^S] = ramp_step(&ramps[0]);
+            r_vol[x^S] = ramp_step(&ramps[1]);
+        }
 
-        gains[0] = clamp_s16((l_vol * dry + 0x4000) >> 15);
-        gains[1] = clamp_s16((r_vol * dry + 0x4000) >> 15);
-        gains[2] = clamp_s16((l_vol * wet + 0x4000) >> 15);
-        gains[3] = clamp_s16((r_vol * wet + 0x4000) >> 15);
+        buffers[0] = dl + k;
+        buffers[1] = dr + k;
+        buffers[2] = wl + k;
+        buffers[3] = wr + k;
 
-        alist_envmix_mix(4, buffers, gains, in[k^S]);
+        alist_envmix_frame(4, buffers, in + k, l_vol, r_vol, dry, wet, frame);
     }
 
     *(int16_t *)(save_buffer +  0) = wet;                           /* 0-1 */
@@ -524,6 +571,18 @@ void alist_envmix_nead(
         swap(&wl, &wr);
 
     while (count != 0) {
+#ifdef HLE_SIMD
+        const v16 src = vload16(in);
+        const v16 l  = vxor16(vwrap32(vsra32(vmul32su(src, vdup16((int16_t)env_values[0])), 16)), vdup16(xors[0]));
+        const v16 r  = vxor16(vwrap32(vsra32(vmul32su(src, vdup16((int16_t)env_values[1])), 16)), vdup16(xors[1]));
+        const v16 l2 = vxor16(vwrap32(vsra32(vmul32su(l,   vdup16((int16_t)env_values[2])), 16)), vdup16(xors[2]));
+        const v16 r2 = vxor16(vwrap32(vsra32(vmul32su(r,   vdup16((int16_t)env_values[2])), 16)), vdup16(xors[3]));
+
+        vstore16(dl, vadds16(vload16(dl), l));
+        vstore16(dr, vadds16(vload16(dr), r));
+        vstore16(wl, vadds16(vload16(wl), l2));
+        vstore16(wr, vadds16(vload16(wr), r2));
+#else
         size_t i;
         for(i = 0; i < 8; ++i) {
             int16_t l  = (((int32_t)in[i^S] * (uint32_t)env_values[0]) >> 16) ^ xors[0];
@@ -536,6 +595,7 @@ void alist_envmix_nead(
             wl[i^S] = clamp_s16(wl[i^S] + l2);
             wr[i^S] = clamp_s16(wr[i^S] + r2);
         }
+#endif
 
         env_values[0] += env_steps[0];
         env_values[1] += env_steps[1];
@@ -558,6 +618,11 @@ void alist_mix(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
 
     count >>= 1;
 
+#ifdef HLE_SIMD
+    for (; count >= 8; count -= 8, dst += 8, src += 8)
+        vstore16(dst, vmix16(vload16(dst), vload16(src), vdup16(gain)));
+#endif
+
     while(count != 0) {
         sample_mix(dst, *src, gain);
 
@@ -573,6 +638,11 @@ void alist_multQ44(struct hle_t* hle, uint16_t dmem, uint16_t count, int8_t gain
 
     count >>= 1;
 
+#ifdef HLE_SIMD
+    for (; count >= 8; count -= 8, dst += 8)
+        vstore16(dst, vpack32(vsra32(vmul32(vload16(dst), vdup16(gain)), 4)));
+#endif
+
     while(count != 0) {
         *dst = clamp_s16(*dst * gain >> 4);
 
@@ -588,6 +658,11 @@ void alist_add(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count
 
     count >>= 1;
 
+#ifdef HLE_SIMD
+    for (; count >= 8; count -= 8, dst += 8, src += 8)
+        vstore16(dst, vadds16(vload16(dst), vload16(src)));
+#endif
+
     while(count != 0) {
         *dst = clamp_s16(*dst + *src);
 
@@ -797,12 +872,45 @@ void alist_filter(
     int16_t* in1 = (int16_t*)(hle->dram + address);
     int16_t* in2 = (int16_t*)(hle->alist_buffer + dmem);
 
+    hle_capture_read(hle, lut_address[0], 16);
+    hle_capture_read(hle, lut_address[1], 16);
+    hle_capture_read(hle, address, 16);
 
     for (x = 0; x < 8; ++x) {
         int32_t v = (lutt5[x] + lutt6[x]) >> 1;
         lutt5[x] = lutt6[x] = v;
     }
 
+#ifdef HLE_SIMD
+    /* with the pairs of in1, in2 and lutt6 swapped back in sample order,
+     * output sample n is the sum of in[n + 1 + k] * lut[7 - k] */
+    {
+        v16 prev = vswap16(vload16(in1));
+        v16 taps[8];
+
+        for (x = 0; x < 8; ++x)
+            taps[x] = vdup16(lutt6[(7 - x) ^ 1]);
+
+        for (x = 0; x < count; x += 16) {
+            const v16 next = vswap16(vload16(in2));
+            v32 v;
+
+            v = vmul32(vext16(prev, next, 1), taps[0]);
+            v = vadd32(v, vmul32(vext16(prev, next, 2), taps[1]));
+            v = vadd32(v, vmul32(vext16(prev, next, 3), taps[2]));
+            v = vadd32(v, vmul32(vext16(prev, next, 4), taps[3]));
+            v = vadd32(v, vmul32(vext16(prev, next, 5), taps[4]));
+            v = vadd32(v, vmul32(vext16(prev, next, 6), taps[5]));
+            v = vadd32(v, vmul32(vext16(prev, next, 7), taps[6]));
+            v = vadd32(v, vmul32(next, taps[7]));
+            vstore16(outp, vswap16(vwrap32(vsra32(vaddn32(v, 0x4000), 15))));
+
+            prev = next;
+            in2 += 8;
+            outp += 8;
+        }
+    }
+#else
     for (x = 0; x < count; x += 16) {
         int32_t v[8];
 
@@ -890,6 +998,7 @@ void alist_filter(
         in2 += 8;
         outp += 8;
     }
+#endif
 
     memcpy(hle->dram + address, in2 - 8, 16);
     memcpy(hle->alist_buffer + dmem, outbuff, count);
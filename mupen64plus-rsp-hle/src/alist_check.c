@@ -0,0 +1,693 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - alist_check.c                                   *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* alist-check: audio kernel cross-check and micro-benchmark
+ *
+ * Every kernel runs the same randomized calls on the same randomized DMEM
+ * and RDRAM through both the SIMD build and the scalar reference build of
+ * alist.c and audio.c. Any byte of either memory that differs afterwards
+ * is reported as a mismatch, and the program exits non-zero. Then both
+ * builds are timed, and the cost of each kernel is printed in ns/call.
+ * MusyX gets checked the same way, on whole tasks made up of random voices
+ * and effects.
+ *
+ * Given audio task snapshots (see hle_capture.h), it replays them instead,
+ * whole ucodes and all, through both builds. The RDRAM and DMEM they leave
+ * must be the same, and the output checksum the one captured.
+ *
+ *     alist-check [-c checks] [-n iterations] [-s seed] [-v] [snapshot...]
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alist_check.h"
+#include "common.h"
+#include "hle.h"
+#include "hle_capture.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "memory.h"
+
+#define DRAM_SIZE           0x10000
+#define SLOT_SIZE           0x280
+#define MISMATCHES_SHOWN    4
+#define TIMED_CALLS         16
+#define TASK_COST           50      /* in kernel calls, to scale the task runs */
+#define MAX_UCODES          32
+
+static const char* const kernel_names[CHECK_KERNELS] = {
+    "envmix_exp",
+    "envmix_ge",
+    "envmix_lin",
+    "envmix_nead",
+    "mix",
+    "multQ44",
+    "add",
+    "resample",
+    "adpcm",
+    "filter",
+    "musyx_v1",
+    "musyx_v2"
+};
+
+static struct hle_t optimized_hle, reference_hle;
+static unsigned char optimized_dram[DRAM_SIZE];
+static unsigned char reference_dram[DRAM_SIZE];
+static unsigned char initial_dmem[0x1000];
+static unsigned char initial_dram[DRAM_SIZE];
+
+struct ucode_stats {
+    const char* name;
+    long tasks;
+    long mismatches;
+    double simd_ns;
+    double scalar_ns;
+};
+
+/* replays: one RDRAM and DMEM per build */
+static struct hle_t replay_hle[2];
+static unsigned char replay_dmem[2][0x1000];
+static unsigned char replay_imem[2][0x1000];
+static struct ucode_stats ucode_stats[MAX_UCODES];
+static unsigned ucode_count;
+
+void HleVerboseMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleWarnMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleErrorMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+static uint32_t seed = 0x2A2A2A2A;
+
+static uint32_t next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed <<  5;
+    return seed;
+}
+
+/* Uniformly random samples almost never hit the clamps, so a quarter of
+ * them are drawn from the interesting values. */
+static int16_t random_sample(void)
+{
+    static const uint16_t edges[12] = {
+        0x0000, 0x0001, 0xffff, 0x7fff, 0x8000, 0x8001,
+        0x7ffe, 0xfffe, 0x00ff, 0xff00, 0x0100, 0x4000,
+    };
+    const uint32_t r = next_random();
+
+    if ((r & 3) == 0)
+        return (int16_t)edges[(r >> 2) % 12];
+    return (int16_t)(r >> 16);
+}
+
+static void randomize(unsigned char* buffer, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i += 2)
+        *(int16_t*)(buffer + i) = random_sample();
+}
+
+/* DMEM is cut in slots far enough apart for the largest call, so buffers
+ * only ever alias on purpose */
+static uint16_t slot(unsigned i)
+{
+    return i * SLOT_SIZE + (next_random() % 0x40) * 2;
+}
+
+/* RDRAM addresses: state in the first 16KB, tables in the next ones */
+static uint32_t address(unsigned i)
+{
+    return i * 0x4000 + (next_random() % 0x700) * 8;
+}
+
+/* MusyX tasks are laid out in RDRAM as
+ *   0x0000  the sound frame descriptors (SFD), with their voices
+ *   0x1800  the state of each SFD
+ *   0x2000  the delay effect, then the v2 mixing tables
+ *   0x2200  the ADPCM codebooks
+ *   0x3000  the delay line
+ *   0x4000  ADPCM frames, then PCM16 samples
+ *   0x8000  the output of each SFD
+ * over random values. Offsets and sizes are the ones of musyx.c. */
+enum {
+    MUSYX_SFD       = 0x0000,
+    MUSYX_STATE     = 0x1800,
+    MUSYX_SFX       = 0x2000,
+    MUSYX_PTR_24    = 0x2100,
+    MUSYX_PTR_18    = 0x2140,
+    MUSYX_CODEBOOKS = 0x2200,
+    MUSYX_PTR_1C    = 0x2800,
+    MUSYX_CBUFFER   = 0x3000,
+    MUSYX_ADPCM     = 0x4000,
+    MUSYX_PCM16     = 0x5000,
+    MUSYX_OUTPUT    = 0x8000,
+
+    MUSYX_SUBFRAME  = 192,
+    MUSYX_VOICE     = 0x50
+};
+
+static uint32_t random_below(uint32_t n)
+{
+    return next_random() % n;
+}
+
+/* One voice. It only ever reads samples it loaded: the start point and the
+ * loop stay inside them, and the pitch is at most 2x. */
+static void random_musyx_voice(struct hle_t* hle, uint32_t voice_ptr)
+{
+    unsigned count, end_point, k;
+    unsigned skip = random_below(32);
+
+    if (next_random() & 1) {
+        /* ADPCM, 20 bytes a frame from two DMA sources, and predictor
+         * indices within the 128 entry codebook */
+        unsigned frames = 4 + random_below(11);
+        unsigned size1 = 2 * random_below(161);
+
+        count = frames * 32;
+        *dram_u8(hle, voice_ptr + 0x3c) = frames;
+        *dram_u8(hle, voice_ptr + 0x3d) = 0;
+        *dram_u8(hle, voice_ptr + 0x3e) = skip + 32 * (next_random() & 1);
+        *dram_u32(hle, voice_ptr + 0x40) = MUSYX_CODEBOOKS + 0x100 * random_below(4);
+        *dram_u32(hle, voice_ptr + 0x24) = MUSYX_ADPCM + 2 * random_below(0x600);
+        *dram_u32(hle, voice_ptr + 0x28) = MUSYX_ADPCM + 2 * random_below(0x600);
+        *dram_u16(hle, voice_ptr + 0x2c) = size1;
+        *dram_u16(hle, voice_ptr + 0x2e) = 320 - size1;
+    } else {
+        unsigned u16_40 = 128 + random_below(0x1e0 - 128 - 31);
+        unsigned size1;
+
+        count = align(u16_40 + skip, 4);
+        size1 = 2 * random_below(count + 1);
+        *dram_u8(hle, voice_ptr + 0x3c) = 0;
+        *dram_u8(hle, voice_ptr + 0x3e) = skip;
+        *dram_u16(hle, voice_ptr + 0x40) = u16_40;
+        *dram_u16(hle, voice_ptr + 0x42) = 0;
+        *dram_u32(hle, voice_ptr + 0x24) = MUSYX_PCM16 + 2 * random_below(0x1000);
+        *dram_u32(hle, voice_ptr + 0x28) = MUSYX_PCM16 + 2 * random_below(0x1000);
+        *dram_u16(hle, voice_ptr + 0x2c) = size1;
+        *dram_u16(hle, voice_ptr + 0x2e) = 2 * count - size1;
+    }
+
+    end_point = 64 + random_below(count - 8 - 64 + 1);
+    *dram_u16(hle, voice_ptr + 0x48) = end_point;
+    *dram_u16(hle, voice_ptr + 0x4a) = random_below(end_point);
+    *dram_u16(hle, voice_ptr + 0x4e) = random_below(16);
+    *dram_u16(hle, voice_ptr + 0x20) = (uint16_t)next_random();
+    *dram_u16(hle, voice_ptr + 0x22) = random_below(0x2001);
+    for (k = 0; k < 8; ++k)
+        *dram_u32(hle, voice_ptr + 4 * k) = next_random();
+    *dram_u32(hle, voice_ptr + 0x44) = 0;
+}
+
+static void random_musyx_sfx(struct hle_t* hle)
+{
+    unsigned subframes = 4 + random_below(5);
+    unsigned length = subframes * MUSYX_SUBFRAME;
+    unsigned k;
+
+    *dram_u32(hle, MUSYX_SFX + 0x00) = MUSYX_CBUFFER;
+    *dram_u32(hle, MUSYX_SFX + 0x04) = length;
+    *dram_u16(hle, MUSYX_SFX + 0x08) = random_below(9);
+    for (k = 0; k < 8; ++k)
+        *dram_u32(hle, MUSYX_SFX + 0x0c + 4 * k) = 1 + random_below(length - 1);
+}
+
+/* a task of one or two SFDs of up to 6 voices, whose first voice may have
+ * no samples, which skips the voices */
+static void random_musyx_task(bool v2)
+{
+    struct hle_t hle;
+    const uint32_t sfd_size = (v2 ? 0x28 : 0x10) + 32 * MUSYX_VOICE;
+    const unsigned sfd_count = 1 + random_below(2);
+    unsigned i, k;
+
+    hle.dram = initial_dram;
+    hle.dmem = initial_dmem;
+    *dmem_u32(&hle, TASK_DATA_PTR) = MUSYX_SFD;
+    *dmem_u32(&hle, TASK_DATA_SIZE) = sfd_count;
+
+    /* ADPCM predictor indices below 8, so codebooks are never overrun */
+    for (k = MUSYX_ADPCM; k < MUSYX_PCM16; ++k)
+        *dram_u8(&hle, k) &= 0x7f;
+
+    random_musyx_sfx(&hle);
+
+    for (i = 0; i < sfd_count; ++i) {
+        const uint32_t sfd_ptr = MUSYX_SFD + i * sfd_size;
+        const uint32_t voice_ptr = sfd_ptr + (v2 ? 0x28 : 0x10);
+        const uint32_t output_ptr = MUSYX_OUTPUT + i * 0x800;
+        const unsigned voices = 1 + random_below(6);
+
+        *dram_u16(&hle, sfd_ptr + 0x2) = random_below(4);
+        *dram_u32(&hle, sfd_ptr + 0x4) = next_random();
+        *dram_u32(&hle, sfd_ptr + 0x8) = MUSYX_STATE + i * 0x400;
+        *dram_u32(&hle, sfd_ptr + 0xc) = (next_random() & 3) ? MUSYX_SFX : 0;
+
+        if (v2) {
+            *dram_u32(&hle, sfd_ptr + 0x10) = 0;
+            *dram_u8(&hle, sfd_ptr + 0x15) = next_random();
+            *dram_u16(&hle, sfd_ptr + 0x16) = (next_random() & 1) ? next_random() & 0xff : 0;
+            *dram_u32(&hle, sfd_ptr + 0x18) = MUSYX_PTR_18;
+            *dram_u32(&hle, sfd_ptr + 0x1c) = MUSYX_PTR_1C;
+            *dram_u32(&hle, sfd_ptr + 0x20) = output_ptr + 0x480;
+            *dram_u32(&hle, sfd_ptr + 0x24) = MUSYX_PTR_24;
+        }
+
+        for (k = 0; k < voices; ++k)
+            random_musyx_voice(&hle, voice_ptr + k * MUSYX_VOICE);
+        *dram_u32(&hle, voice_ptr + (voices - 1) * MUSYX_VOICE + 0x44) = output_ptr;
+
+        if ((next_random() & 7) == 0) {
+            *dram_u16(&hle, voice_ptr + 0x2c) = 0;
+            *dram_u32(&hle, voice_ptr + 0x44) = output_ptr;
+        }
+    }
+
+    /* the v2 mixing table: a source of 3 subframes and a gain per entry */
+    for (k = 0; k < 8; ++k)
+        *dram_u32(&hle, MUSYX_PTR_18 + 8 * k) = MUSYX_PCM16 + 2 * random_below(0x1000);
+}
+
+static void random_call(unsigned kernel, struct alist_call* call)
+{
+    unsigned i;
+
+    memset(call, 0, sizeof(*call));
+    call->init = next_random() & 1;
+    call->flag = next_random() & 1;
+    call->dmemo = slot(0);
+    call->dmemi = slot(1);
+    for (i = 0; i < 4; ++i)
+        call->dmem[i] = slot(2 + i);
+    for (i = 0; i < 2; ++i) {
+        call->gain[i] = random_sample();
+        call->vol[i] = random_sample();
+        call->target[i] = random_sample();
+        call->rate[i] = (int32_t)next_random();
+    }
+    for (i = 0; i < 3; ++i) {
+        call->address[i] = address(i);
+        call->env_values[i] = (uint16_t)random_sample();
+        call->env_steps[i] = (uint16_t)random_sample();
+    }
+    for (i = 0; i < 4; ++i)
+        call->xors[i] = (next_random() & 1) ? -1 : random_sample();
+    for (i = 0; i < 0x80; ++i)
+        call->codebook[i] = random_sample();
+
+    switch (kernel)
+    {
+    case CHECK_ENVMIX_EXP:
+        call->count = 16 * (1 + next_random() % 32);
+        break;
+    case CHECK_ENVMIX_GE:
+    case CHECK_ENVMIX_LIN:
+        call->count = 2 * (next_random() % 256);
+        break;
+    case CHECK_ENVMIX_NEAD:
+        call->count = 1 + next_random() % 256;
+        break;
+    case CHECK_MIX:
+    case CHECK_MULTQ44:
+    case CHECK_ADD:
+        call->count = 2 * (next_random() % 256);
+        if ((next_random() & 7) == 0)
+            call->dmemi = call->dmemo;
+        break;
+    case CHECK_RESAMPLE:
+        /* up to 2x, reading up to 4 samples before dmemi */
+        call->count = 2 * (next_random() % 128);
+        call->pitch = next_random() % 0x20000;
+        call->dmemi += 8;
+        if ((next_random() & 3) == 0)
+            call->dmemo = call->dmemi + 2 * (next_random() % 32) - 32;
+        break;
+    case CHECK_ADPCM:
+        call->count = 32 * (1 + next_random() % 8);
+        break;
+    case CHECK_FILTER:
+        call->count = 16 * (1 + next_random() % 32);
+        break;
+    }
+
+    /* envmix into the same buffer twice */
+    if ((next_random() & 7) == 0)
+        call->dmem[1] = call->dmem[0];
+
+    if (kernel == CHECK_MUSYX_V1 || kernel == CHECK_MUSYX_V2)
+        random_musyx_task(kernel == CHECK_MUSYX_V2);
+}
+
+static void reset(void)
+{
+    memcpy(optimized_hle.alist_buffer, initial_dmem, sizeof(initial_dmem));
+    memcpy(reference_hle.alist_buffer, initial_dmem, sizeof(initial_dmem));
+    memcpy(optimized_dram, initial_dram, DRAM_SIZE);
+    memcpy(reference_dram, initial_dram, DRAM_SIZE);
+}
+
+static void print_mismatch(const char* memory, const unsigned char* got,
+        const unsigned char* ref, size_t size)
+{
+    size_t i, shown = 0;
+
+    for (i = 0; i < size && shown < 8; i += 2) {
+        if (memcmp(got + i, ref + i, 2) == 0)
+            continue;
+        printf("    %s[%04x]: %04x  (reference %04x)\n", memory, (unsigned)i,
+                *(const uint16_t*)(got + i), *(const uint16_t*)(ref + i));
+        ++shown;
+    }
+}
+
+static long check_kernel(unsigned kernel, long checks, int verbose)
+{
+    struct alist_call call;
+    long mismatches = 0;
+    long i;
+
+    for (i = 0; i < checks; ++i) {
+        randomize(initial_dmem, sizeof(initial_dmem));
+        randomize(initial_dram, DRAM_SIZE);
+        random_call(kernel, &call);
+        reset();
+
+        optimized_alist_run(&optimized_hle, kernel, &call);
+        reference_alist_run(&reference_hle, kernel, &call);
+
+        if (memcmp(optimized_hle.alist_buffer, reference_hle.alist_buffer, 0x1000) == 0
+         && memcmp(optimized_dram, reference_dram, DRAM_SIZE) == 0)
+            continue;
+
+        if (mismatches < MISMATCHES_SHOWN || verbose) {
+            if (kernel == CHECK_MUSYX_V1 || kernel == CHECK_MUSYX_V2)
+                printf("  %s task %ld:\n", kernel_names[kernel], i);
+            else
+                printf("  %s init=%d flag=%d dmemo=%04x dmemi=%04x count=%u:\n",
+                        kernel_names[kernel], call.init, call.flag,
+                        call.dmemo, call.dmemi, call.count);
+            print_mismatch("dmem", optimized_hle.alist_buffer,
+                    reference_hle.alist_buffer, 0x1000);
+            print_mismatch("dram", optimized_dram, reference_dram, DRAM_SIZE);
+        }
+        ++mismatches;
+    }
+
+    return mismatches;
+}
+
+/* both builds are timed on the same calls and the same initial state */
+static double time_kernel(void (*run)(struct hle_t*, unsigned, const struct alist_call*),
+        struct hle_t* hle, unsigned kernel, const struct alist_call* calls, long count)
+{
+    clock_t t1, t2;
+    long i;
+
+    reset();
+    for (i = 0; i < TIMED_CALLS; ++i)
+        run(hle, kernel, &calls[i]);
+
+    t1 = clock();
+    for (i = 0; i < count; ++i)
+        run(hle, kernel, &calls[i % TIMED_CALLS]);
+    t2 = clock();
+
+    return (double)(t2 - t1) * 1e9 / CLOCKS_PER_SEC / (double)count;
+}
+
+static const char* simd_target(void)
+{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    return "SSE2";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+static double time_task(const struct capture_snapshot* snapshot,
+        const struct audio_ucode_t* ucode, struct hle_t* hle, long iterations)
+{
+    clock_t total = 0;
+    long i;
+
+    for (i = 0; i < iterations; ++i) {
+        clock_t t1;
+
+        capture_restore(snapshot, hle);
+        t1 = clock();
+        ucode->process(hle);
+        total += clock() - t1;
+    }
+
+    return (double)total * 1e9 / CLOCKS_PER_SEC / (double)iterations;
+}
+
+static struct ucode_stats* find_stats(const char* name)
+{
+    unsigned i;
+
+    for (i = 0; i < ucode_count; ++i) {
+        if (strcmp(ucode_stats[i].name, name) == 0)
+            return &ucode_stats[i];
+    }
+
+    if (ucode_count == MAX_UCODES)
+        return NULL;
+
+    ucode_stats[ucode_count].name = name;
+    return &ucode_stats[ucode_count++];
+}
+
+/* runs one snapshot through both builds; returns false if it can't */
+static bool replay(const char* filename, long iterations, int verbose)
+{
+    const struct audio_ucode_t* ucodes[2];
+    struct capture_snapshot snapshot;
+    struct ucode_stats* stats;
+    uint64_t checksums[2];
+    unsigned i;
+
+    if (!capture_load(filename, &snapshot))
+        return false;
+
+    ucodes[0] = optimized_find_ucode(snapshot.header.ucode);
+    ucodes[1] = reference_find_ucode(snapshot.header.ucode);
+    stats = (ucodes[0] != NULL) ? find_stats(ucodes[0]->name) : NULL;
+    if (stats == NULL) {
+        fprintf(stderr, "%s: can't replay %s tasks\n", filename, snapshot.header.ucode);
+        capture_free(&snapshot);
+        return false;
+    }
+
+    /* the timed runs go first so that the checked ones are the last */
+    stats->simd_ns += time_task(&snapshot, ucodes[0], &replay_hle[0], iterations);
+    stats->scalar_ns += time_task(&snapshot, ucodes[1], &replay_hle[1], iterations);
+
+    for (i = 0; i < 2; ++i) {
+        /* blocks outside the snapshot are zero, whatever ran before */
+        memset(replay_hle[i].dram, 0, CAPTURE_RDRAM_SIZE);
+        capture_restore(&snapshot, &replay_hle[i]);
+        ucodes[i]->process(&replay_hle[i]);
+        checksums[i] = capture_checksum(replay_hle[i].dram, snapshot.outputs,
+                snapshot.header.outputs);
+    }
+
+    ++stats->tasks;
+    if (checksums[0] == snapshot.header.checksum
+     && checksums[1] == snapshot.header.checksum
+     && memcmp(replay_hle[0].dmem, replay_hle[1].dmem, 0x1000) == 0
+     && memcmp(replay_hle[0].dram, replay_hle[1].dram, CAPTURE_RDRAM_SIZE) == 0) {
+        if (verbose)
+            printf("  %s: checksum %016llx\n", filename,
+                    (unsigned long long)checksums[0]);
+        capture_free(&snapshot);
+        return true;
+    }
+
+    if (stats->mismatches < MISMATCHES_SHOWN || verbose) {
+        printf("  %s: checksum %016llx, reference %016llx (captured %016llx):\n",
+                filename, (unsigned long long)checksums[0],
+                (unsigned long long)checksums[1],
+                (unsigned long long)snapshot.header.checksum);
+        print_mismatch("dmem", replay_hle[0].dmem, replay_hle[1].dmem, 0x1000);
+        print_mismatch("dram", replay_hle[0].dram, replay_hle[1].dram, CAPTURE_RDRAM_SIZE);
+    }
+    ++stats->mismatches;
+
+    capture_free(&snapshot);
+    return true;
+}
+
+static long replay_snapshots(char** filenames, int count, long iterations, int verbose)
+{
+    long tasks = 0, failures = 0, errors = 0;
+    double total_simd = 0, total_scalar = 0;
+    unsigned k;
+    int i;
+
+    for (i = 0; i < 2; ++i) {
+        replay_hle[i].dram = calloc(1, CAPTURE_RDRAM_SIZE);
+        replay_hle[i].dmem = replay_dmem[i];
+        replay_hle[i].imem = replay_imem[i];
+        if (replay_hle[i].dram == NULL) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    printf("HLE audio:  %s ucodes against the scalar reference\n", simd_target());
+    printf("%d snapshots, %ld timed runs per task\n\n", count, iterations);
+
+    for (i = 0; i < count; ++i)
+        errors += !replay(filenames[i], iterations, verbose);
+
+    printf("ucode        %6s us/task  scalar us/task  speed-up  mismatches\n", simd_target());
+    for (k = 0; k < ucode_count; ++k) {
+        const struct ucode_stats* stats = &ucode_stats[k];
+
+        printf("%-12s %14.1f %15.1f %8.2fx %11ld\n", stats->name,
+                stats->simd_ns / 1e3 / stats->tasks,
+                stats->scalar_ns / 1e3 / stats->tasks,
+                stats->simd_ns > 0 ? stats->scalar_ns / stats->simd_ns : 0.0,
+                stats->mismatches);
+        tasks += stats->tasks;
+        total_simd += stats->simd_ns;
+        total_scalar += stats->scalar_ns;
+        failures += stats->mismatches;
+    }
+
+    printf("\ntotal        %14.1f %15.1f %8.2fx %11ld\n",
+            tasks ? total_simd / 1e3 / tasks : 0.0,
+            tasks ? total_scalar / 1e3 / tasks : 0.0,
+            total_simd > 0 ? total_scalar / total_simd : 0.0, failures);
+    if (errors)
+        printf("%ld snapshots could not be replayed\n", errors);
+
+    for (i = 0; i < 2; ++i)
+        free(replay_hle[i].dram);
+    return failures + errors;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [-c checks] [-n iterations] [-s seed] [-v] [snapshot...]\n"
+        "  -c  random calls cross-checked per kernel (default 20000)\n"
+        "  -n  calls timed per kernel and build (default 100000),\n"
+        "      or runs per snapshot and build (default 20)\n"
+        "  -s  random seed (default 0x2A2A2A2A)\n"
+        "  -v  print every mismatch instead of the first few per kernel\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    long checks = 20000;
+    long iterations = 0;
+    int verbose = 0;
+    long failures = 0;
+    double total_simd = 0, total_scalar = 0;
+    unsigned kernel;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            checks = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            iterations = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-v") == 0)
+            verbose = 1;
+        else
+            usage(argv[0]);
+    }
+    if (seed == 0)
+        seed = 1; /* xorshift never leaves zero */
+    if (checks < 0 || iterations < 0)
+        usage(argv[0]);
+
+    if (i < argc)
+        return replay_snapshots(argv + i, argc - i, iterations ? iterations : 20, verbose) != 0;
+    if (iterations == 0)
+        iterations = 100000;
+
+    optimized_hle.dram = optimized_dram;
+    reference_hle.dram = reference_dram;
+    /* MusyX reads its task header from DMEM, the alist buffer will do */
+    optimized_hle.dmem = optimized_hle.alist_buffer;
+    reference_hle.dmem = reference_hle.alist_buffer;
+
+    printf("HLE audio:  %s kernels against the scalar reference\n", simd_target());
+    printf("%ld checks, %ld timed calls per kernel\n\n", checks, iterations);
+    printf("kernel       %6s ns/call  scalar ns/call  speed-up  mismatches\n", simd_target());
+
+    for (kernel = 0; kernel < CHECK_KERNELS; ++kernel) {
+        const bool task = (kernel == CHECK_MUSYX_V1 || kernel == CHECK_MUSYX_V2);
+        struct alist_call calls[TIMED_CALLS];
+        double simd, scalar;
+        long mismatches, count;
+        unsigned j;
+
+        mismatches = check_kernel(kernel,
+                task ? (checks + TASK_COST - 1) / TASK_COST : checks, verbose);
+
+        randomize(initial_dmem, sizeof(initial_dmem));
+        randomize(initial_dram, DRAM_SIZE);
+        for (j = 0; j < TIMED_CALLS; ++j)
+            random_call(kernel, &calls[j]);
+        count = task ? (iterations + TASK_COST - 1) / TASK_COST : iterations;
+        simd = time_kernel(optimized_alist_run, &optimized_hle, kernel, calls, count);
+        scalar = time_kernel(reference_alist_run, &reference_hle, kernel, calls, count);
+        printf("%-12s %14.1f %15.1f %8.2fx %11ld\n",
+                kernel_names[kernel], simd, scalar,
+                simd > 0 ? scalar / simd : 0.0, mismatches);
+        fflush(stdout);
+
+        /* the totals are of one call of each kernel */
+        if (!task) {
+            total_simd += simd;
+            total_scalar += scalar;
+        }
+        failures += mismatches;
+    }
+
+    printf("\ntotal        %14.1f %15.1f %8.2fx %11ld\n",
+            total_simd, total_scalar,
+            total_simd > 0 ? total_scalar / total_simd : 0.0, failures);
+    return failures != 0;
+}
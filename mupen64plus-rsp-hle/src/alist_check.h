@@ -0,0 +1,79 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - alist_check.h                                   *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ALIST_CHECK_H
+#define ALIST_CHECK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct audio_ucode_t;
+struct hle_t;
+
+/* `alist-check` links the audio kernels and ucodes in twice: once with the
+ * SIMD versions and once built with HLE_SCALAR_REFERENCE (see
+ * alist_check_unit.h). Both copies run the same call on copies of the
+ * same state. */
+enum {
+    CHECK_ENVMIX_EXP,
+    CHECK_ENVMIX_GE,
+    CHECK_ENVMIX_LIN,
+    CHECK_ENVMIX_NEAD,
+    CHECK_MIX,
+    CHECK_MULTQ44,
+    CHECK_ADD,
+    CHECK_RESAMPLE,
+    CHECK_ADPCM,
+    CHECK_FILTER,
+
+    /* whole MusyX tasks, built in DMEM and RDRAM beforehand */
+    CHECK_MUSYX_V1,
+    CHECK_MUSYX_V2,
+    CHECK_KERNELS
+};
+
+/* arguments of one kernel call, each kernel takes the ones it needs */
+struct alist_call {
+    bool init;
+    bool flag;              /* aux, swap_wet_LR, loop or two bits per sample */
+    uint16_t dmemo;
+    uint16_t dmemi;
+    uint16_t dmem[4];       /* dl, dr, wl, wr */
+    uint16_t count;
+    int16_t gain[2];        /* dry and wet, or gain */
+    int16_t vol[2];
+    int16_t target[2];
+    int32_t rate[2];
+    uint32_t pitch;
+    uint32_t address[3];    /* state, then loop or filter tables */
+    uint16_t env_values[3];
+    uint16_t env_steps[3];
+    int16_t xors[4];
+    int16_t codebook[0x80];
+};
+
+void optimized_alist_run(struct hle_t* hle, unsigned kernel, const struct alist_call* call);
+void reference_alist_run(struct hle_t* hle, unsigned kernel, const struct alist_call* call);
+
+/* the whole ucodes, for replaying captured tasks; NULL for unknown names */
+const struct audio_ucode_t* optimized_find_ucode(const char* name);
+const struct audio_ucode_t* reference_find_ucode(const char* name);
+
+#endif
@@ -0,0 +1,132 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - alist_check_unit.c                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* One stand-alone copy of alist.c and audio.c for `alist-check`, see
+ * alist_check_unit.h. The ucode sources go in separate objects. */
+
+#include "alist_check_unit.h"
+
+#include "alist.c"
+#include "audio.c"
+#include "alist_check.h"
+#include "hle.h"
+#include "ucodes.h"
+
+/* the audio ucodes of hle.c, by the name captures carry */
+static const struct audio_ucode_t ucodes[] = {
+    { 0, "audio",       alist_process_audio },
+    { 0, "audio_ge",    alist_process_audio_ge },
+    { 0, "audio_bc",    alist_process_audio_bc },
+    { 0, "nead_mk",     alist_process_nead_mk },
+    { 0, "nead_sfj",    alist_process_nead_sfj },
+    { 0, "nead_wrjb",   alist_process_nead_wrjb },
+    { 0, "nead_sf",     alist_process_nead_sf },
+    { 0, "nead_fz",     alist_process_nead_fz },
+    { 0, "nead_ys",     alist_process_nead_ys },
+    { 0, "nead_1080",   alist_process_nead_1080 },
+    { 0, "nead_oot",    alist_process_nead_oot },
+    { 0, "nead_mm",     alist_process_nead_mm },
+    { 0, "nead_mmb",    alist_process_nead_mmb },
+    { 0, "nead_ac",     alist_process_nead_ac },
+    { 0, "musyx_v2",    musyx_v2_task },
+    { 0, "musyx_v1",    musyx_v1_task },
+    { 0, "naudio",      alist_process_naudio },
+    { 0, "naudio_bk",   alist_process_naudio_bk },
+    { 0, "naudio_dk",   alist_process_naudio_dk },
+    { 0, "naudio_mp3",  alist_process_naudio_mp3 },
+    { 0, "naudio_cbfd", alist_process_naudio_cbfd },
+};
+
+const struct audio_ucode_t* ALIST_UNIT(find_ucode)(const char* name)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(ucodes) / sizeof(ucodes[0]); ++i) {
+        if (strcmp(ucodes[i].name, name) == 0)
+            return &ucodes[i];
+    }
+
+    return NULL;
+}
+
+void ALIST_UNIT(alist_run)(struct hle_t* hle, unsigned kernel, const struct alist_call* call)
+{
+    uint16_t env_values[3];
+    uint16_t env_steps[3];
+    uint32_t luts[2];
+
+    switch (kernel)
+    {
+    case CHECK_ENVMIX_EXP:
+        alist_envmix_exp(hle, call->init, call->flag,
+                call->dmem[0], call->dmem[1], call->dmem[2], call->dmem[3],
+                call->dmemi, call->count, call->gain[0], call->gain[1],
+                call->vol, call->target, call->rate, call->address[0]);
+        break;
+    case CHECK_ENVMIX_GE:
+        alist_envmix_ge(hle, call->init, call->flag,
+                call->dmem[0], call->dmem[1], call->dmem[2], call->dmem[3],
+                call->dmemi, call->count, call->gain[0], call->gain[1],
+                call->vol, call->target, call->rate, call->address[0]);
+        break;
+    case CHECK_ENVMIX_LIN:
+        alist_envmix_lin(hle, call->init,
+                call->dmem[0], call->dmem[1], call->dmem[2], call->dmem[3],
+                call->dmemi, call->count, call->gain[0], call->gain[1],
+                call->vol, call->target, call->rate, call->address[0]);
+        break;
+    case CHECK_ENVMIX_NEAD:
+        memcpy(env_values, call->env_values, sizeof(env_values));
+        memcpy(env_steps, call->env_steps, sizeof(env_steps));
+        alist_envmix_nead(hle, call->flag,
+                call->dmem[0], call->dmem[1], call->dmem[2], call->dmem[3],
+                call->dmemi, call->count, env_values, env_steps, call->xors);
+        break;
+    case CHECK_MIX:
+        alist_mix(hle, call->dmemo, call->dmemi, call->count, call->gain[0]);
+        break;
+    case CHECK_MULTQ44:
+        alist_multQ44(hle, call->dmemo, call->count, (int8_t)call->gain[0]);
+        break;
+    case CHECK_ADD:
+        alist_add(hle, call->dmemo, call->dmemi, call->count);
+        break;
+    case CHECK_RESAMPLE:
+        alist_resample(hle, call->init, false, call->dmemo, call->dmemi,
+                call->count, call->pitch, call->address[0]);
+        break;
+    case CHECK_ADPCM:
+        alist_adpcm(hle, call->init, false, call->flag, call->dmemo,
+                call->dmemi, call->count, call->codebook,
+                call->address[1], call->address[0]);
+        break;
+    case CHECK_FILTER:
+        luts[0] = call->address[1];
+        luts[1] = call->address[2];
+        alist_filter(hle, call->dmemo, call->count, call->address[0], luts);
+        break;
+    case CHECK_MUSYX_V1:
+        musyx_v1_task(hle);
+        break;
+    case CHECK_MUSYX_V2:
+        musyx_v2_task(hle);
+        break;
+    }
+}
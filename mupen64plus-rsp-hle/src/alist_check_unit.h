@@ -0,0 +1,86 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - alist_check_unit.h                              *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Names of one stand-alone copy of the audio sources for `alist-check`.
+ *
+ * alist_check_unit.c and the ucode sources get compiled twice, once as is
+ * and once with HLE_SCALAR_REFERENCE defined, and both copies go into the
+ * same program. This header is included first in all of them, so every
+ * global of the two copies is renamed with the copy's prefix. */
+
+#ifndef ALIST_CHECK_UNIT_H
+#define ALIST_CHECK_UNIT_H
+
+#ifdef HLE_SCALAR_REFERENCE
+#define ALIST_UNIT(name)    reference_##name
+#else
+#define ALIST_UNIT(name)    optimized_##name
+#endif
+
+#define alist_process                   ALIST_UNIT(alist_process)
+#define alist_get_address               ALIST_UNIT(alist_get_address)
+#define alist_set_address               ALIST_UNIT(alist_set_address)
+#define alist_clear                     ALIST_UNIT(alist_clear)
+#define alist_load                      ALIST_UNIT(alist_load)
+#define alist_save                      ALIST_UNIT(alist_save)
+#define alist_move                      ALIST_UNIT(alist_move)
+#define alist_copy_every_other_sample   ALIST_UNIT(alist_copy_every_other_sample)
+#define alist_repeat64                  ALIST_UNIT(alist_repeat64)
+#define alist_copy_blocks               ALIST_UNIT(alist_copy_blocks)
+#define alist_interleave                ALIST_UNIT(alist_interleave)
+#define alist_envmix_exp                ALIST_UNIT(alist_envmix_exp)
+#define alist_envmix_ge                 ALIST_UNIT(alist_envmix_ge)
+#define alist_envmix_lin                ALIST_UNIT(alist_envmix_lin)
+#define alist_envmix_nead               ALIST_UNIT(alist_envmix_nead)
+#define alist_mix                       ALIST_UNIT(alist_mix)
+#define alist_multQ44                   ALIST_UNIT(alist_multQ44)
+#define alist_add                       ALIST_UNIT(alist_add)
+#define alist_resample                  ALIST_UNIT(alist_resample)
+#define alist_resample_zoh              ALIST_UNIT(alist_resample_zoh)
+#define alist_adpcm                     ALIST_UNIT(alist_adpcm)
+#define alist_filter                    ALIST_UNIT(alist_filter)
+#define alist_polef                     ALIST_UNIT(alist_polef)
+#define alist_iirf                      ALIST_UNIT(alist_iirf)
+#define RESAMPLE_LUT                    ALIST_UNIT(RESAMPLE_LUT)
+#define rdot                            ALIST_UNIT(rdot)
+#define adpcm_compute_residuals         ALIST_UNIT(adpcm_compute_residuals)
+#define alist_process_audio             ALIST_UNIT(alist_process_audio)
+#define alist_process_audio_ge          ALIST_UNIT(alist_process_audio_ge)
+#define alist_process_audio_bc          ALIST_UNIT(alist_process_audio_bc)
+#define alist_process_naudio            ALIST_UNIT(alist_process_naudio)
+#define alist_process_naudio_bk         ALIST_UNIT(alist_process_naudio_bk)
+#define alist_process_naudio_dk         ALIST_UNIT(alist_process_naudio_dk)
+#define alist_process_naudio_mp3        ALIST_UNIT(alist_process_naudio_mp3)
+#define alist_process_naudio_cbfd       ALIST_UNIT(alist_process_naudio_cbfd)
+#define alist_process_nead_mk           ALIST_UNIT(alist_process_nead_mk)
+#define alist_process_nead_sfj          ALIST_UNIT(alist_process_nead_sfj)
+#define alist_process_nead_sf           ALIST_UNIT(alist_process_nead_sf)
+#define alist_process_nead_fz           ALIST_UNIT(alist_process_nead_fz)
+#define alist_process_nead_wrjb         ALIST_UNIT(alist_process_nead_wrjb)
+#define alist_process_nead_ys           ALIST_UNIT(alist_process_nead_ys)
+#define alist_process_nead_1080         ALIST_UNIT(alist_process_nead_1080)
+#define alist_process_nead_oot          ALIST_UNIT(alist_process_nead_oot)
+#define alist_process_nead_mm           ALIST_UNIT(alist_process_nead_mm)
+#define alist_process_nead_mmb          ALIST_UNIT(alist_process_nead_mmb)
+#define alist_process_nead_ac           ALIST_UNIT(alist_process_nead_ac)
+#define musyx_v1_task                   ALIST_UNIT(musyx_v1_task)
+#define musyx_v2_task                   ALIST_UNIT(musyx_v2_task)
+
+#endif
@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "arithmetics.h"
+#include "simd.h"
 
 const int16_t RESAMPLE_LUT[64 * 4] = {
     (int16_t)0x0c39, (int16_t)0x66ad, (int16_t)0x0d46, (int16_t)0xffdf,
@@ -115,6 +116,30 @@ void adpcm_compute_residuals(int16_t* dst, const int16_t* src,
 
     assert(count <= 8);
 
+#ifdef HLE_SIMD
+    /* the rdot terms form a triangular matrix: column k is src shifted up
+     * by k + 1 samples, scaled by book2[k] */
+    if (count == 8) {
+        const v16 zero = vdup16(0);
+        const v16 x = vload16(src);
+        v32 accu;
+
+        accu = vmul32(x, vdup16(1 << 11));
+        accu = vadd32(accu, vmul32(vload16(book1), vdup16(l1)));
+        accu = vadd32(accu, vmul32(vload16(book2), vdup16(l2)));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 7), vdup16(book2[0])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 6), vdup16(book2[1])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 5), vdup16(book2[2])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 4), vdup16(book2[3])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 3), vdup16(book2[4])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 2), vdup16(book2[5])));
+        accu = vadd32(accu, vmul32(vext16(zero, x, 1), vdup16(book2[6])));
+
+        vstore16(dst, vpack32(vsra32(accu, 11)));
+        return;
+    }
+#endif
+
     for(i = 0; i < count; ++i) {
         int32_t accu = (int32_t)src[i] << 11;
         accu += book1[i]*l1 + book2[i]*l2 + rdot(i, book2, src + i);
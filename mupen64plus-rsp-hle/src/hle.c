@@ -28,6 +28,8 @@
 #include <stdio.h>
 #endif
 
+#include "hle.h"
+#include "hle_capture.h"
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
@@ -178,85 +180,99 @@ static void forward_gfx_task(struct hle_t* hle)
       rsp_info.ProcessDlistList();
 }
 
-static bool try_fast_audio_dispatching(struct hle_t* hle)
+/* audio ucodes, identified by the content of ucode_data */
+static const struct audio_ucode_t ABI1_UCODES[] = {
+    { 0x1e24138c, "audio",      alist_process_audio },      /* audio ABI (most common) */
+    { 0x1dc8138c, "audio_ge",   alist_process_audio_ge },   /* GoldenEye */
+    { 0x1e3c1390, "audio_bc",   alist_process_audio_bc },   /* BlastCorp, DiddyKongRacing */
+};
+
+static const struct audio_ucode_t ABI2_UCODES[] = {
+    { 0x11181350, "nead_mk",    alist_process_nead_mk },    /* MarioKart, WaveRace (E) */
+    { 0x111812e0, "nead_sfj",   alist_process_nead_sfj },   /* StarFox (J) */
+    { 0x110412ac, "nead_wrjb",  alist_process_nead_wrjb },  /* WaveRace (J RevB) */
+    { 0x110412cc, "nead_sf",    alist_process_nead_sf },    /* StarFox/LylatWars (except J) */
+    { 0x1cd01250, "nead_fz",    alist_process_nead_fz },    /* FZeroX */
+    { 0x1f08122c, "nead_ys",    alist_process_nead_ys },    /* YoshisStory */
+    { 0x1f38122c, "nead_1080",  alist_process_nead_1080 },  /* 1080° Snowboarding */
+    { 0x1f681230, "nead_oot",   alist_process_nead_oot },   /* Zelda OoT / Zelda MM (J, J RevA) */
+    { 0x1f801250, "nead_mm",    alist_process_nead_mm },    /* Zelda MM (except J, J RevA, E Beta), PokemonStadium 2 */
+    { 0x109411f8, "nead_mmb",   alist_process_nead_mmb },   /* Zelda MM (E Beta) */
+    { 0x1eac11b8, "nead_ac",    alist_process_nead_ac },    /* AnimalCrossing */
+    { 0x00010010, "musyx_v2",   musyx_v2_task },            /* MusyX v2 (IndianaJones, BattleForNaboo) */
+};
+
+static const struct audio_ucode_t ABI3_UCODES[] = {
+    /* MusyX v1
+       RogueSquadron, ResidentEvil2, PolarisSnoCross,
+       TheWorldIsNotEnough, RugratsInParis, NBAShowTime,
+       HydroThunder, Tarzan, GauntletLegend, Rush2049 */
+    { 0x00000001, "musyx_v1",   musyx_v1_task },
+    { 0x0000127c, "naudio",     alist_process_naudio },     /* naudio (many games) */
+    { 0x00001280, "naudio_bk",  alist_process_naudio_bk },  /* BanjoKazooie */
+    { 0x1c58126c, "naudio_dk",  alist_process_naudio_dk },  /* DonkeyKong */
+    { 0x1ae8143c, "naudio_mp3", alist_process_naudio_mp3 }, /* BanjoTooie, JetForceGemini, MickeySpeedWayUSA, PerfectDark */
+    { 0x1ab0140c, "naudio_cbfd", alist_process_naudio_cbfd }, /* ConkerBadFurDay */
+};
+
+static const struct audio_ucode_t* find_ucode(const struct audio_ucode_t* ucodes, size_t n, uint32_t v)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        if (ucodes[i].v == v)
+            return &ucodes[i];
+    }
+
+    return NULL;
+}
+
+const struct audio_ucode_t* hle_find_audio_ucode(struct hle_t* hle)
 {
     /* identify audio ucode by using the content of ucode_data */
     uint32_t ucode_data = *dmem_u32(hle, TASK_UCODE_DATA);
+    const struct audio_ucode_t* ucode;
     uint32_t v;
 
     if (*dram_u32(hle, ucode_data) == 0x00000001) {
         if (*dram_u32(hle, ucode_data + 0x30) == 0xf0000f00) {
             v = *dram_u32(hle, ucode_data + 0x28);
-            switch(v)
-            {
-            case 0x1e24138c: /* audio ABI (most common) */
-                alist_process_audio(hle); return true;
-            case 0x1dc8138c: /* GoldenEye */
-                alist_process_audio_ge(hle); return true;
-            case 0x1e3c1390: /* BlastCorp, DiddyKongRacing */
-                alist_process_audio_bc(hle); return true;
-            default:
+            ucode = find_ucode(ABI1_UCODES, sizeof(ABI1_UCODES) / sizeof(ABI1_UCODES[0]), v);
+            if (ucode == NULL)
                 HleWarnMessage(hle->user_defined, "ABI1 identification regression: v=%08x", v);
-            }
         } else {
             v = *dram_u32(hle, ucode_data + 0x10);
-            switch(v)
-            {
-            case 0x11181350: /* MarioKart, WaveRace (E) */
-                alist_process_nead_mk(hle); return true;
-            case 0x111812e0: /* StarFox (J) */
-                alist_process_nead_sfj(hle); return true;
-            case 0x110412ac: /* WaveRace (J RevB) */
-                alist_process_nead_wrjb(hle); return true;
-            case 0x110412cc: /* StarFox/LylatWars (except J) */
-                alist_process_nead_sf(hle); return true;
-            case 0x1cd01250: /* FZeroX */
-                alist_process_nead_fz(hle); return true;
-            case 0x1f08122c: /* YoshisStory */
-                alist_process_nead_ys(hle); return true;
-            case 0x1f38122c: /* 1080° Snowboarding */
-                alist_process_nead_1080(hle); return true;
-            case 0x1f681230: /* Zelda OoT / Zelda MM (J, J RevA) */
-                alist_process_nead_oot(hle); return true;
-            case 0x1f801250: /* Zelda MM (except J, J RevA, E Beta), PokemonStadium 2 */
-                alist_process_nead_mm(hle); return true;
-            case 0x109411f8: /* Zelda MM (E Beta) */
-                alist_process_nead_mmb(hle); return true;
-            case 0x1eac11b8: /* AnimalCrossing */
-                alist_process_nead_ac(hle); return true;
-            case 0x00010010: /* MusyX v2 (IndianaJones, BattleForNaboo) */
-                musyx_v2_task(hle); return true;
-
-            default:
+            ucode = find_ucode(ABI2_UCODES, sizeof(ABI2_UCODES) / sizeof(ABI2_UCODES[0]), v);
+            if (ucode == NULL)
                 HleWarnMessage(hle->user_defined, "ABI2 identification regression: v=%08x", v);
-            }
         }
     } else {
         v = *dram_u32(hle, ucode_data + 0x10);
-        switch(v)
-        {
-        case 0x00000001: /* MusyX v1
-            RogueSquadron, ResidentEvil2, PolarisSnoCross,
-            TheWorldIsNotEnough, RugratsInParis, NBAShowTime,
-            HydroThunder, Tarzan, GauntletLegend, Rush2049 */
-            musyx_v1_task(hle); return true;
-        case 0x0000127c: /* naudio (many games) */
-            alist_process_naudio(hle); return true;
-        case 0x00001280: /* BanjoKazooie */
-            alist_process_naudio_bk(hle); return true;
-        case 0x1c58126c: /* DonkeyKong */
-            alist_process_naudio_dk(hle); return true;
-        case 0x1ae8143c: /* BanjoTooie, JetForceGemini, MickeySpeedWayUSA, PerfectDark */
-            alist_process_naudio_mp3(hle); return true;
-        case 0x1ab0140c: /* ConkerBadFurDay */
-            alist_process_naudio_cbfd(hle); return true;
-
-        default:
+        ucode = find_ucode(ABI3_UCODES, sizeof(ABI3_UCODES) / sizeof(ABI3_UCODES[0]), v);
+        if (ucode == NULL)
             HleWarnMessage(hle->user_defined, "ABI3 identification regression: v=%08x", v);
-        }
     }
 
-    return false;
+    return ucode;
+}
+
+static bool try_fast_audio_dispatching(struct hle_t* hle)
+{
+    const struct audio_ucode_t* ucode;
+
+#ifdef ENABLE_AUDIO_CAPTURE
+    hle_capture_begin(hle);
+#endif
+
+    ucode = hle_find_audio_ucode(hle);
+    if (ucode != NULL)
+        ucode->process(hle);
+
+#ifdef ENABLE_AUDIO_CAPTURE
+    hle_capture_end(hle, ucode);
+#endif
+
+    return (ucode != NULL);
 }
 
 static bool try_fast_task_dispatching(struct hle_t* hle)
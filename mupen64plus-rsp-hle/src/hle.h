@@ -50,5 +50,14 @@ void hle_init(struct hle_t* hle,
 
 void hle_execute(struct hle_t* hle);
 
+/* audio ucodes recognized by the fast audio dispatching */
+struct audio_ucode_t {
+    uint32_t v;
+    const char* name;
+    void (*process)(struct hle_t* hle);
+};
+
+const struct audio_ucode_t* hle_find_audio_ucode(struct hle_t* hle);
+
 #endif
 
@@ -0,0 +1,222 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - hle_audio_bench.c                               *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* hle-audio-bench: replays captured audio tasks (see hle_capture.h)
+ *
+ * Every snapshot is restored and run through the ucode it was captured
+ * with, as identified by hle_find_audio_ucode, and the checksum of the
+ * RDRAM it writes is compared with the one recorded at capture time. Any
+ * difference is reported, and the program exits non-zero. The time spent
+ * in the ucode is summed per ABI and printed in us/task.
+ *
+ *     hle-audio-bench [-n iterations] [-v] snapshot...
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "hle.h"
+#include "hle_capture.h"
+#include "hle_external.h"
+#include "hle_internal.h"
+#include "m64p_plugin.h"
+
+#define MAX_ABIS    32
+
+struct abi_stats {
+    const char* name;
+    long tasks;
+    long mismatches;
+    long long time_ns;
+};
+
+/* hle.c forwards graphics tasks through it, which replays never do */
+RSP_INFO rsp_info;
+
+static struct hle_t hle;
+static unsigned char* dram;
+static unsigned char dmem[0x1000];
+static unsigned char imem[0x1000];
+
+static struct abi_stats abis[MAX_ABIS];
+static unsigned int abi_count;
+
+void HleVerboseMessage(void* UNUSED(user_defined), const char* UNUSED(message), ...)
+{
+}
+
+void HleErrorMessage(void* UNUSED(user_defined), const char* message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void HleWarnMessage(void* UNUSED(user_defined), const char* message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+static long long get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct abi_stats* find_abi(const char* name)
+{
+    unsigned int i;
+
+    for (i = 0; i < abi_count; ++i) {
+        if (strcmp(abis[i].name, name) == 0)
+            return &abis[i];
+    }
+
+    if (abi_count == MAX_ABIS)
+        return NULL;
+
+    abis[abi_count].name = name;
+    return &abis[abi_count++];
+}
+
+static int replay(const char* filename, long iterations, int verbose)
+{
+    struct capture_snapshot snapshot;
+    const struct audio_ucode_t* ucode;
+    struct abi_stats* abi;
+    uint64_t checksum;
+    long i;
+
+    if (!capture_load(filename, &snapshot))
+        return 1;
+
+    capture_restore(&snapshot, &hle);
+    ucode = hle_find_audio_ucode(&hle);
+    if (ucode == NULL || strcmp(ucode->name, snapshot.header.ucode) != 0) {
+        fprintf(stderr, "%s: captured as %s, identified as %s\n", filename,
+                snapshot.header.ucode, (ucode != NULL) ? ucode->name : "unknown");
+        capture_free(&snapshot);
+        return 1;
+    }
+
+    abi = find_abi(ucode->name);
+    if (abi == NULL) {
+        fprintf(stderr, "%s: too many ABIs\n", filename);
+        capture_free(&snapshot);
+        return 1;
+    }
+
+    for (i = 0; i < iterations; ++i) {
+        long long start;
+
+        capture_restore(&snapshot, &hle);
+        start = get_time_ns();
+        ucode->process(&hle);
+        abi->time_ns += get_time_ns() - start;
+    }
+
+    checksum = capture_checksum(dram, snapshot.outputs, snapshot.header.outputs);
+    ++abi->tasks;
+    if (checksum != snapshot.header.checksum) {
+        ++abi->mismatches;
+        printf("  %s: checksum %016llx (captured %016llx)\n", filename,
+               (unsigned long long)checksum,
+               (unsigned long long)snapshot.header.checksum);
+    } else if (verbose) {
+        printf("  %s: checksum %016llx, %u blocks in, %u out\n", filename,
+               (unsigned long long)checksum,
+               snapshot.header.inputs, snapshot.header.outputs);
+    }
+
+    capture_free(&snapshot);
+    return 0;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [-n iterations] [-v] snapshot...\n"
+        "  -n  runs per task (default 20)\n"
+        "  -v  print the checksum of every task\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    long iterations = 20;
+    int verbose = 0;
+    long tasks = 0, failures = 0, errors = 0;
+    long long time_ns = 0;
+    unsigned int k;
+    int i;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            iterations = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-v") == 0)
+            verbose = 1;
+        else
+            usage(argv[0]);
+    }
+    if (i == argc || iterations <= 0)
+        usage(argv[0]);
+
+    dram = calloc(1, CAPTURE_RDRAM_SIZE);
+    if (dram == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    hle.dram = dram;
+    hle.dmem = dmem;
+    hle.imem = imem;
+
+    for (; i < argc; ++i)
+        errors += replay(argv[i], iterations, verbose);
+
+    printf("%-12s %8s %12s %11s\n", "ucode", "tasks", "us/task", "mismatches");
+    for (k = 0; k < abi_count; ++k) {
+        printf("%-12s %8ld %12.1f %11ld\n", abis[k].name, abis[k].tasks,
+               abis[k].time_ns / 1e3 / (double)(abis[k].tasks * iterations),
+               abis[k].mismatches);
+        tasks += abis[k].tasks;
+        failures += abis[k].mismatches;
+        time_ns += abis[k].time_ns;
+    }
+    printf("\n%-12s %8ld %12.1f %11ld\n", "total", tasks,
+           tasks ? time_ns / 1e3 / (double)(tasks * iterations) : 0.0, failures);
+    if (errors)
+        printf("%ld snapshots could not be replayed\n", errors);
+
+    free(dram);
+    return (failures != 0 || errors != 0);
+}
@@ -0,0 +1,279 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - hle_capture.c                                   *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "hle_capture.h"
+#include "hle_external.h"
+#include "memory.h"
+
+/* Global functions */
+uint64_t capture_checksum(const unsigned char* dram, const uint32_t* outputs, size_t count)
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    size_t i, k;
+
+    for (i = 0; i < count; ++i) {
+        const unsigned char* block = dram + outputs[i];
+
+        for (k = 0; k < 4; ++k) {
+            hash ^= (outputs[i] >> (8 * k)) & 0xff;
+            hash *= UINT64_C(0x100000001b3);
+        }
+        for (k = 0; k < CAPTURE_BLOCK; ++k) {
+            hash ^= block[k];
+            hash *= UINT64_C(0x100000001b3);
+        }
+    }
+
+    return hash;
+}
+
+void capture_free(struct capture_snapshot* snapshot)
+{
+    free(snapshot->state);
+    free(snapshot->input_addresses);
+    free(snapshot->inputs);
+    free(snapshot->outputs);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+bool capture_load(const char* filename, struct capture_snapshot* snapshot)
+{
+    struct capture_header* header = &snapshot->header;
+    bool ok = false;
+    uint32_t i;
+    FILE* f;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    f = fopen(filename, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: cannot open\n", filename);
+        return false;
+    }
+
+    if (fread(header, sizeof(*header), 1, f) != 1
+     || header->magic != CAPTURE_MAGIC || header->version != CAPTURE_VERSION) {
+        fprintf(stderr, "%s: not an audio task snapshot\n", filename);
+        goto done;
+    }
+    if (header->state_size != CAPTURE_STATE_SIZE
+     || header->inputs > CAPTURE_BLOCKS || header->outputs > CAPTURE_BLOCKS) {
+        fprintf(stderr, "%s: captured by an incompatible build\n", filename);
+        goto done;
+    }
+    header->ucode[sizeof(header->ucode) - 1] = '\0';
+
+    snapshot->state = malloc(header->state_size);
+    snapshot->input_addresses = malloc(header->inputs * sizeof(uint32_t) + 1);
+    snapshot->inputs = malloc(header->inputs * CAPTURE_BLOCK + 1);
+    snapshot->outputs = malloc(header->outputs * sizeof(uint32_t) + 1);
+    if (snapshot->state == NULL || snapshot->input_addresses == NULL
+     || snapshot->inputs == NULL || snapshot->outputs == NULL) {
+        fprintf(stderr, "%s: out of memory\n", filename);
+        goto done;
+    }
+
+    ok = fread(snapshot->dmem, sizeof(snapshot->dmem), 1, f) == 1
+      && fread(snapshot->state, header->state_size, 1, f) == 1;
+
+    for (i = 0; ok && i < header->inputs; ++i)
+        ok = fread(&snapshot->input_addresses[i], sizeof(uint32_t), 1, f) == 1
+          && snapshot->input_addresses[i] <= CAPTURE_RDRAM_SIZE - CAPTURE_BLOCK
+          && fread(snapshot->inputs + i * CAPTURE_BLOCK, CAPTURE_BLOCK, 1, f) == 1;
+
+    if (ok)
+        ok = fread(snapshot->outputs, sizeof(uint32_t), header->outputs, f) == header->outputs;
+    for (i = 0; ok && i < header->outputs; ++i)
+        ok = snapshot->outputs[i] <= CAPTURE_RDRAM_SIZE - CAPTURE_BLOCK;
+
+    if (!ok)
+        fprintf(stderr, "%s: truncated or corrupted\n", filename);
+
+done:
+    fclose(f);
+    if (!ok)
+        capture_free(snapshot);
+    return ok;
+}
+
+void capture_restore(const struct capture_snapshot* snapshot, struct hle_t* hle)
+{
+    uint32_t i;
+
+    for (i = 0; i < snapshot->header.inputs; ++i)
+        memcpy(hle->dram + snapshot->input_addresses[i],
+               snapshot->inputs + i * CAPTURE_BLOCK, CAPTURE_BLOCK);
+
+    memcpy(hle->dmem, snapshot->dmem, sizeof(snapshot->dmem));
+    memcpy((unsigned char*)hle + CAPTURE_STATE_OFFSET, snapshot->state, CAPTURE_STATE_SIZE);
+}
+
+#ifdef ENABLE_AUDIO_CAPTURE
+
+/* stop after about a minute of audio */
+#ifndef CAPTURE_LIMIT
+#define CAPTURE_LIMIT   3600
+#endif
+
+static bool capturing;
+static unsigned int captured;
+
+/* the task as it was before it ran */
+static unsigned char* shadow_dram;
+static unsigned char shadow_dmem[0x1000];
+static unsigned char shadow_state[CAPTURE_STATE_SIZE];
+
+static uint8_t touched[CAPTURE_BLOCKS / 8];
+static uint32_t blocks[CAPTURE_BLOCKS];
+
+static void touch(unsigned int block)
+{
+    touched[block >> 3] |= 1 << (block & 7);
+}
+
+static bool is_touched(unsigned int block)
+{
+    return (touched[block >> 3] >> (block & 7)) & 1;
+}
+
+static bool write_u32(FILE* f, uint32_t x)
+{
+    return fwrite(&x, sizeof(x), 1, f) == 1;
+}
+
+static void write_snapshot(struct hle_t* hle, const struct audio_ucode_t* ucode)
+{
+    struct capture_header header;
+    char filename[256];
+    unsigned int block, outputs = 0, inputs = 0;
+    bool ok;
+    FILE* f;
+
+    /* outputs: the blocks the task changed */
+    for (block = 0; block < CAPTURE_BLOCKS; ++block) {
+        uint32_t address = block * CAPTURE_BLOCK;
+
+        if (memcmp(shadow_dram + address, hle->dram + address, CAPTURE_BLOCK) != 0) {
+            blocks[outputs++] = address;
+            touch(block);
+        }
+    }
+
+    /* inputs: the blocks it read or changed, as they were before */
+    for (block = 0; block < CAPTURE_BLOCKS; ++block)
+        inputs += is_touched(block);
+
+    memset(&header, 0, sizeof(header));
+    header.magic      = CAPTURE_MAGIC;
+    header.version    = CAPTURE_VERSION;
+    strncpy(header.ucode, ucode->name, sizeof(header.ucode) - 1);
+    header.state_size = CAPTURE_STATE_SIZE;
+    header.inputs     = inputs;
+    header.outputs    = outputs;
+    header.checksum   = capture_checksum(hle->dram, blocks, outputs);
+
+    sprintf(filename, "audio_task_%06u_%s.bin", captured, ucode->name);
+    f = fopen(filename, "wb");
+    if (f == NULL) {
+        HleErrorMessage(hle->user_defined, "Couldn't open %s for writing !", filename);
+        return;
+    }
+
+    ok = fwrite(&header, sizeof(header), 1, f) == 1
+      && fwrite(shadow_dmem, sizeof(shadow_dmem), 1, f) == 1
+      && fwrite(shadow_state, sizeof(shadow_state), 1, f) == 1;
+
+    for (block = 0; ok && block < CAPTURE_BLOCKS; ++block) {
+        uint32_t address = block * CAPTURE_BLOCK;
+
+        if (is_touched(block))
+            ok = write_u32(f, address)
+              && fwrite(shadow_dram + address, CAPTURE_BLOCK, 1, f) == 1;
+    }
+
+    if (ok)
+        ok = fwrite(blocks, sizeof(blocks[0]), outputs, f) == outputs;
+
+    if (!ok)
+        HleErrorMessage(hle->user_defined, "Writing error on %s", filename);
+    fclose(f);
+}
+
+void hle_capture_begin(struct hle_t* hle)
+{
+    if (captured >= CAPTURE_LIMIT)
+        return;
+
+    if (shadow_dram == NULL) {
+        shadow_dram = malloc(CAPTURE_RDRAM_SIZE);
+        if (shadow_dram == NULL)
+            return;
+    }
+
+    memcpy(shadow_dram, hle->dram, CAPTURE_RDRAM_SIZE);
+    memcpy(shadow_dmem, hle->dmem, sizeof(shadow_dmem));
+    memcpy(shadow_state, (unsigned char*)hle + CAPTURE_STATE_OFFSET, sizeof(shadow_state));
+    memset(touched, 0, sizeof(touched));
+    capturing = true;
+
+    /* the alist is read through a pointer */
+    hle_capture_read(hle, *dmem_u32(hle, TASK_DATA_PTR), *dmem_u32(hle, TASK_DATA_SIZE));
+}
+
+void hle_capture_end(struct hle_t* hle, const struct audio_ucode_t* ucode)
+{
+    if (!capturing)
+        return;
+
+    capturing = false;
+    if (ucode == NULL)
+        return;
+
+    write_snapshot(hle, ucode);
+    ++captured;
+}
+
+void hle_capture_read(struct hle_t* UNUSED(hle), uint32_t address, size_t size)
+{
+    uint32_t block, last;
+
+    if (!capturing || size == 0)
+        return;
+
+    address &= 0xffffff;
+    if (address >= CAPTURE_RDRAM_SIZE)
+        return;
+
+    block = address / CAPTURE_BLOCK;
+    last  = (address + size - 1) / CAPTURE_BLOCK;
+    if (last >= CAPTURE_BLOCKS)
+        last = CAPTURE_BLOCKS - 1;
+
+    for (; block <= last; ++block)
+        touch(block);
+}
+
+#endif
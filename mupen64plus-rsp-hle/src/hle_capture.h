@@ -0,0 +1,97 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - hle_capture.h                                   *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HLE_CAPTURE_H
+#define HLE_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hle.h"
+#include "hle_internal.h"
+
+/* Audio task snapshots
+ *
+ * Built with ENABLE_AUDIO_CAPTURE, the fast audio dispatching writes one
+ * snapshot per task to the working directory, audio_task_<n>_<ucode>.bin.
+ * hle-audio-bench and alist-check replay them without the rest of the
+ * emulator.
+ *
+ * A snapshot holds all the task depends on: DMEM with the task header, the
+ * HLE state kept between tasks, and every RDRAM block the task read or
+ * wrote, as it was before the task ran. It also lists the blocks the task
+ * changed and the checksum of their final content.
+ *
+ * Layout, in host byte order:
+ *   struct capture_header
+ *   DMEM                 0x1000 bytes
+ *   HLE state            state_size bytes
+ *   input blocks         inputs times: uint32_t address, CAPTURE_BLOCK bytes
+ *   output blocks        outputs times: uint32_t address
+ */
+#define CAPTURE_MAGIC       0x41454c48  /* "HLEA" */
+#define CAPTURE_VERSION     1
+#define CAPTURE_BLOCK       64
+#define CAPTURE_RDRAM_SIZE  0x800000
+#define CAPTURE_BLOCKS      (CAPTURE_RDRAM_SIZE / CAPTURE_BLOCK)
+
+#define CAPTURE_STATE_OFFSET    offsetof(struct hle_t, alist_buffer)
+#define CAPTURE_STATE_SIZE      (sizeof(struct hle_t) - CAPTURE_STATE_OFFSET)
+
+struct capture_header {
+    uint32_t magic;
+    uint32_t version;
+    char ucode[16];
+    uint32_t state_size;
+    uint32_t inputs;
+    uint32_t outputs;
+    uint32_t reserved;
+    uint64_t checksum;
+};
+
+/* a snapshot as read back by the replay tools */
+struct capture_snapshot {
+    struct capture_header header;
+    unsigned char dmem[0x1000];
+    unsigned char* state;
+    uint32_t* input_addresses;
+    unsigned char* inputs;
+    uint32_t* outputs;
+};
+
+/* FNV-1a of the output blocks, addresses included */
+uint64_t capture_checksum(const unsigned char* dram, const uint32_t* outputs, size_t count);
+
+/* reads a snapshot, telling on stderr what is wrong with it if it can't */
+bool capture_load(const char* filename, struct capture_snapshot* snapshot);
+void capture_free(struct capture_snapshot* snapshot);
+
+/* puts DMEM, the HLE state and the input blocks back into hle, whose RDRAM
+ * must hold CAPTURE_RDRAM_SIZE bytes */
+void capture_restore(const struct capture_snapshot* snapshot, struct hle_t* hle);
+
+#ifdef ENABLE_AUDIO_CAPTURE
+/* brackets an audio task; ucode is NULL when it was not recognized */
+void hle_capture_begin(struct hle_t* hle);
+void hle_capture_end(struct hle_t* hle, const struct audio_ucode_t* ucode);
+#endif
+
+#endif
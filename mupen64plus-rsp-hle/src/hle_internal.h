@@ -58,6 +58,9 @@ struct hle_t
     void* user_defined;
 
 
+    /* everything below is state kept between tasks, which audio captures
+     * save along with DMEM (see hle_capture.h) */
+
     /* alist.c */
     uint8_t alist_buffer[0x1000];
 
@@ -87,6 +87,13 @@ void store_u8 (unsigned char* buffer, unsigned address, const uint8_t*  src, siz
 void store_u16(unsigned char* buffer, unsigned address, const uint16_t* src, size_t count);
 void store_u32(unsigned char* buffer, unsigned address, const uint32_t* src, size_t count);
 
+#ifdef ENABLE_AUDIO_CAPTURE
+/* hle_capture.c: notes RDRAM read by the audio task being captured */
+void hle_capture_read(struct hle_t* hle, uint32_t address, size_t size);
+#else
+#define hle_capture_read(hle, address, size)
+#endif
+
 
 /* convenient functions for DMEM access */
 static INLINE uint8_t* dmem_u8(struct hle_t* hle, uint16_t address)
@@ -137,31 +144,37 @@ static INLINE void dmem_store_u32(struct hle_t* hle, const uint32_t* src, uint16
 /* convenient functions DRAM access */
 static INLINE uint8_t* dram_u8(struct hle_t* hle, uint32_t address)
 {
+    hle_capture_read(hle, address, 1);
     return u8(hle->dram, address & 0xffffff);
 }
 
 static INLINE uint16_t* dram_u16(struct hle_t* hle, uint32_t address)
 {
+    hle_capture_read(hle, address, 2);
     return u16(hle->dram, address & 0xffffff);
 }
 
 static INLINE uint32_t* dram_u32(struct hle_t* hle, uint32_t address)
 {
+    hle_capture_read(hle, address, 4);
     return u32(hle->dram, address & 0xffffff);
 }
 
 static INLINE void dram_load_u8(struct hle_t* hle, uint8_t* dst, uint32_t address, size_t count)
 {
+    hle_capture_read(hle, address, count);
     load_u8(dst, hle->dram, address & 0xffffff, count);
 }
 
 static INLINE void dram_load_u16(struct hle_t* hle, uint16_t* dst, uint32_t address, size_t count)
 {
+    hle_capture_read(hle, address, count * 2);
     load_u16(dst, hle->dram, address & 0xffffff, count);
 }
 
 static INLINE void dram_load_u32(struct hle_t* hle, uint32_t* dst, uint32_t address, size_t count)
 {
+    hle_capture_read(hle, address, count * 4);
     load_u32(dst, hle->dram, address & 0xffffff, count);
 }
 
@@ -223,12 +223,14 @@ void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address)
 
     writePtr = readPtr = address;
     /* Just do that for efficiency... may remove and use directly later anyway */
+    hle_capture_read(hle, readPtr, 8);
     memcpy(hle->mp3_buffer + 0xCE8, hle->dram + readPtr, 8);
     /* This must be a header byte or whatnot */
     readPtr += 8;
 
     for (cnt = 0; cnt < 0x480; cnt += 0x180) {
         /* DMA: 0xCF0 <- RDRAM[s5] : 0x180 */
+        hle_capture_read(hle, readPtr, 0x180);
         memcpy(hle->mp3_buffer + 0xCF0, hle->dram + readPtr, 0x180);
         inPtr  = 0xCF0; /* s7 */
         outPtr = 0xE70; /* s3 */
@@ -31,6 +31,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "simd.h"
 
 /* various constants */
 enum { SUBFRAME_SIZE = 192 };
@@ -127,6 +128,11 @@ typedef struct {
 
     /* */
     int16_t subframe_740_last4[4];
+
+    /* ADPCM codebook of each voice, kept from one subframe to the next */
+    uint32_t adpcm_tables_loaded;
+    uint32_t adpcm_table_ptrs[MAX_VOICES];
+    int16_t adpcm_tables[MAX_VOICES][128];
 } musyx_t;
 
 typedef void (*mix_sfx_with_main_subframes_t)(musyx_t *musyx, const int16_t *subframe,
@@ -150,7 +156,8 @@ static void dma_cat16(struct hle_t* hle, uint16_t *dst, uint32_t catsrc_ptr);
 
 static void load_samples_PCM16(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
                                unsigned *segbase, unsigned *offset);
-static void load_samples_ADPCM(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+static void load_samples_ADPCM(struct hle_t* hle, musyx_t *musyx, unsigned voice,
+                               uint32_t voice_ptr, int16_t *samples,
                                unsigned *segbase, unsigned *offset);
 
 static void adpcm_decode_frames(struct hle_t* hle,
@@ -166,6 +173,8 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
                               uint32_t voice_ptr, const int16_t *samples,
                               unsigned segbase, unsigned offset, uint32_t last_sample_ptr);
 
+static int16_t envmix_subframe(int16_t *dst, const int16_t *v, int32_t env, int32_t env_step);
+
 static void sfx_stage(struct hle_t* hle,
                       mix_sfx_with_main_subframes_t mix_sfx_with_main_subframes,
                       musyx_t *musyx, uint32_t sfx_ptr, uint16_t idx);
@@ -213,6 +222,8 @@ void musyx_v1_task(struct hle_t* hle)
                       sfd_ptr,
                       sfd_count);
 
+    musyx.adpcm_tables_loaded = 0;
+
     state_ptr = *dram_u32(hle, sfd_ptr + SFD_STATE_PTR);
 
     /* load initial state */
@@ -273,6 +284,8 @@ void musyx_v2_task(struct hle_t* hle)
                       sfd_ptr,
                       sfd_count);
 
+    musyx.adpcm_tables_loaded = 0;
+
     for (;;) {
         /* parse SFD structure */
         uint16_t sfx_index       = *dram_u16(hle, sfd_ptr + SFD_SFX_INDEX);
@@ -476,7 +489,7 @@ static uint32_t voice_stage(struct hle_t* hle, musyx_t *musyx,
             if (*dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES) == 0)
                 load_samples_PCM16(hle, voice_ptr, samples, &segbase, &offset);
             else
-                load_samples_ADPCM(hle, voice_ptr, samples, &segbase, &offset);
+                load_samples_ADPCM(hle, musyx, i, voice_ptr, samples, &segbase, &offset);
 
             /* mix them with each internal subframes */
             mix_voice_samples(hle, musyx, voice_ptr, samples, segbase, offset,
@@ -567,13 +580,15 @@ static void load_samples_PCM16(struct hle_t* hle, uint32_t voice_ptr, int16_t *s
         dma_cat16(hle, (uint16_t *)samples, voice_ptr + VOICE_CATSRC_1);
 }
 
-static void load_samples_ADPCM(struct hle_t* hle, uint32_t voice_ptr, int16_t *samples,
+static void load_samples_ADPCM(struct hle_t* hle, musyx_t *musyx, unsigned voice,
+                               uint32_t voice_ptr, int16_t *samples,
                                unsigned *segbase, unsigned *offset)
 {
     /* decompressed samples cannot exceed 0x400 bytes;
      * ADPCM has a compression ratio of 5/16 */
     uint8_t buffer[SAMPLE_BUFFER_SIZE * 2 * 5 / 16];
-    int16_t adpcm_table[128];
+    int16_t voice_table[128];
+    int16_t *adpcm_table = voice_table;
 
     uint8_t u8_3c = *dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES    );
     uint8_t u8_3d = *dram_u8(hle, voice_ptr + VOICE_ADPCM_FRAMES + 1);
@@ -584,8 +599,22 @@ static void load_samples_ADPCM(struct hle_t* hle, uint32_t voice_ptr, int16_t *s
 
     HleVerboseMessage(hle->user_defined, "Format: ADPCM");
 
-    HleVerboseMessage(hle->user_defined, "Loading ADPCM table: %08x", adpcm_table_ptr);
-    dram_load_u16(hle, (uint16_t *)adpcm_table, adpcm_table_ptr, 128);
+    /* the task never writes codebooks, so a voice keeps its own for all
+     * the subframes of the task */
+    if (voice >= MAX_VOICES) {
+        HleVerboseMessage(hle->user_defined, "Loading ADPCM table: %08x", adpcm_table_ptr);
+        dram_load_u16(hle, (uint16_t *)adpcm_table, adpcm_table_ptr, 128);
+    } else {
+        adpcm_table = musyx->adpcm_tables[voice];
+
+        if (!(musyx->adpcm_tables_loaded & (1u << voice))
+         || musyx->adpcm_table_ptrs[voice] != adpcm_table_ptr) {
+            HleVerboseMessage(hle->user_defined, "Loading ADPCM table: %08x", adpcm_table_ptr);
+            dram_load_u16(hle, (uint16_t *)adpcm_table, adpcm_table_ptr, 128);
+            musyx->adpcm_table_ptrs[voice] = adpcm_table_ptr;
+            musyx->adpcm_tables_loaded |= (1u << voice);
+        }
+    }
 
     count = u8_3c << 5;
 
@@ -693,6 +722,7 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
     int32_t  v4_env_step[4];
     int16_t *v4_dst[4];
     int16_t  v4[4];
+    int16_t  v[SUBFRAME_SIZE];
 
     dram_load_u32(hle, (uint32_t *)v4_env,      voice_ptr + VOICE_ENV_BEGIN, 4);
     dram_load_u32(hle, (uint32_t *)v4_env_step, voice_ptr + VOICE_ENV_STEP,  4);
@@ -716,11 +746,11 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
                       v4_env[0],      v4_env[1],      v4_env[2],      v4_env[3],
                       v4_env_step[0], v4_env_step[1], v4_env_step[2], v4_env_step[3]);
 
+    /* resample the voice first, then mix it in each subframe in turn */
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         /* update sample and lut pointers and then pitch_accu */
         const int16_t *lut = (RESAMPLE_LUT + ((pitch_accu & 0xfc00) >> 8));
         int dist;
-        int16_t v;
 
         sample += (pitch_accu >> 16);
         pitch_accu &= 0xffff;
@@ -732,20 +762,12 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
             sample = sample_restart + dist;
 
         /* apply resample filter */
-        v = clamp_s16(dot4(sample, lut));
-
-        for (k = 0; k < 4; ++k) {
-            /* envmix */
-            int32_t accu = (v * (v4_env[k] >> 16)) >> 15;
-            v4[k] = clamp_s16(accu);
-            *(v4_dst[k]) = clamp_s16(accu + *(v4_dst[k]));
-
-            /* update envelopes and dst pointers */
-            ++(v4_dst[k]);
-            v4_env[k] += v4_env_step[k];
-        }
+        v[i] = clamp_s16(dot4(sample, lut));
     }
 
+    for (k = 0; k < 4; ++k)
+        v4[k] = envmix_subframe(v4_dst[k], v, v4_env[k], v4_env_step[k]);
+
     /* save last resampled sample */
     dram_store_u16(hle, (uint16_t *)v4, last_sample_ptr, 4);
 
@@ -754,6 +776,41 @@ static void mix_voice_samples(struct hle_t* hle, musyx_t *musyx,
                       v4[0], v4[1], v4[2], v4[3]);
 }
 
+/* dst[i] += v[i] * env[i], with env[i + 1] = env[i] + env_step; returns the
+ * last v[i] * env[i] */
+static int16_t envmix_subframe(int16_t *dst, const int16_t *v, int32_t env, int32_t env_step)
+{
+    int32_t accu = 0;
+    unsigned i = 0;
+
+#ifdef HLE_SIMD
+    int32_t envs[8];
+    v32 venv;
+
+    for (i = 0; i < 8; ++i)
+        envs[i] = env + (int32_t)((uint32_t)env_step * i);
+    venv = vload32(envs);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        const v32 vaccu = vsra32(vmul32(vload16(v + i), vwrap32(vsra32(venv, 16))), 15);
+
+        vstore16(dst + i, vpack32(vadd32(vaccu, vwiden32(vload16(dst + i)))));
+        venv = vaddn32(venv, (int32_t)((uint32_t)env_step * 8));
+    }
+
+    i = SUBFRAME_SIZE - 1;
+    env += (int32_t)((uint32_t)env_step * i);
+    accu = (v[i] * (env >> 16)) >> 15;
+#else
+    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+        accu = (v[i] * (env >> 16)) >> 15;
+        dst[i] = clamp_s16(accu + dst[i]);
+        env += env_step;
+    }
+#endif
+
+    return clamp_s16(accu);
+}
 
 static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_with_main_subframes,
                       musyx_t *musyx, uint32_t sfx_ptr, uint16_t idx)
@@ -853,11 +910,19 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 {
     unsigned i;
 
+#ifdef HLE_SIMD
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        const v16 v = vload16(subframe + i);
+        vstore16(musyx->left + i,  vadds16(vload16(musyx->left + i),  v));
+        vstore16(musyx->right + i, vadds16(vload16(musyx->right + i), v));
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         musyx->left[i]  = clamp_s16(musyx->left[i]  + v);
         musyx->right[i] = clamp_s16(musyx->right[i] + v);
     }
+#endif
 }
 
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
@@ -865,6 +930,20 @@ static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subfra
 {
     unsigned i;
 
+#ifdef HLE_SIMD
+    const v16 g1 = vdup16((int16_t)gains[0]);
+    const v16 g2 = vdup16((int16_t)gains[1]);
+
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        const v16 v  = vload16(subframe + i);
+        const v16 v1 = vpack32(vsra32(vmul32su(v, g1), 16));
+        const v16 v2 = vpack32(vsra32(vmul32su(v, g2), 16));
+
+        vstore16(musyx->left + i,  vadds16(vload16(musyx->left + i),  v1));
+        vstore16(musyx->right + i, vadds16(vload16(musyx->right + i), v1));
+        vstore16(musyx->cc0 + i,   vadds16(vload16(musyx->cc0 + i),   v2));
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         int16_t v1 = (int32_t)(v * gains[0]) >> 16;
@@ -874,6 +953,7 @@ static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subfra
         musyx->right[i] = clamp_s16(musyx->right[i] + v1);
         musyx->cc0[i]   = clamp_s16(musyx->cc0[i]   + v2);
     }
+#endif
 }
 
 static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
@@ -885,8 +965,18 @@ static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain)
 {
     unsigned int i;
 
+#ifdef HLE_SIMD
+    const v16 g = vdup16(hgain);
+
+    /* no clamp on the product, (-32768 * -32768 + 0x4000) >> 15 is 32768 */
+    for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+        const v32 v = vsra32(vaddn32(vmul32(vload16(x + i), g), 0x4000), 15);
+        vstore16(y + i, vpack32(vadd32(vwiden32(vload16(y + i)), v)));
+    }
+#else
     for (i = 0; i < SUBFRAME_SIZE; ++i)
         mix_samples(&y[i], x[i], hgain);
+#endif
 }
 
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
@@ -899,6 +989,25 @@ static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t
     h[2] = (hgain * hcoeffs[2]) >> 15;
     h[3] = (hgain * hcoeffs[3]) >> 15;
 
+#ifdef HLE_SIMD
+    /* taps fit 16 bits unless both hgain and a coefficient are -32768 */
+    if (h[0] < 32768 && h[1] < 32768 && h[2] < 32768 && h[3] < 32768) {
+        const v16 h0 = vdup16(h[0]);
+        const v16 h1 = vdup16(h[1]);
+        const v16 h2 = vdup16(h[2]);
+        const v16 h3 = vdup16(h[3]);
+
+        for (i = 0; i < SUBFRAME_SIZE; i += 8) {
+            v32 v = vmul32(vload16(x + i), h0);
+            v = vadd32(v, vmul32(vload16(x + i + 1), h1));
+            v = vadd32(v, vmul32(vload16(x + i + 2), h2));
+            v = vadd32(v, vmul32(vload16(x + i + 3), h3));
+            vstore16(y + i, vpack32(vadd32(vwiden32(vload16(y + i)), vsra32(v, 15))));
+        }
+        return;
+    }
+#endif
+
     for (i = 0; i < SUBFRAME_SIZE; ++i) {
         int32_t v = (h[0] * x[i] + h[1] * x[i + 1] + h[2] * x[i + 2] + h[3] * x[i + 3]) >> 15;
         y[i] = clamp_s16(y[i] + v);
@@ -0,0 +1,287 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - simd.h                                          *
+ *   Mupen64Plus homepage: http://code.google.com/p/mupen64plus/           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+
+/* The audio kernels work on 8 samples at a time, like the RSP vector unit
+ * the microcodes run them on. They use SSE2 or NEON when the compiler
+ * targets either. Define HLE_SCALAR_REFERENCE to build the plain C loops
+ * instead, which are kept as the reference the SIMD kernels must match
+ * sample for sample (see alist_check.c).
+ *
+ * v16 holds 8 int16 lanes and v32 8 int32 lanes.
+ * Buffers need no particular alignment. */
+#ifndef HLE_SCALAR_REFERENCE
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ARCH_MIN_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ARCH_MIN_ARM_NEON
+#endif
+#endif
+
+#if defined(ARCH_MIN_SSE2)
+#include <emmintrin.h>
+#define HLE_SIMD
+
+typedef __m128i v16;
+typedef struct { __m128i lo, hi; } v32;
+
+static INLINE v16 vload16(const int16_t* src)
+{
+    return _mm_loadu_si128((const __m128i*)src);
+}
+
+static INLINE void vstore16(int16_t* dst, v16 x)
+{
+    _mm_storeu_si128((__m128i*)dst, x);
+}
+
+static INLINE v16 vdup16(int16_t x)
+{
+    return _mm_set1_epi16(x);
+}
+
+static INLINE v16 vadds16(v16 x, v16 y)
+{
+    return _mm_adds_epi16(x, y);
+}
+
+static INLINE v16 vxor16(v16 x, v16 y)
+{
+    return _mm_xor_si128(x, y);
+}
+
+/* swaps the two samples of each 32-bit word */
+static INLINE v16 vswap16(v16 x)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xb1), 0xb1);
+}
+
+/* samples n to n + 7 of x followed by y, n a constant from 1 to 7 */
+#define vext16(x, y, n) \
+    _mm_or_si128(_mm_srli_si128((x), 2 * (n)), _mm_slli_si128((y), 16 - 2 * (n)))
+
+static INLINE v32 vload32(const int32_t* src)
+{
+    v32 r;
+    r.lo = _mm_loadu_si128((const __m128i*)src);
+    r.hi = _mm_loadu_si128((const __m128i*)(src + 4));
+    return r;
+}
+
+static INLINE v32 vwiden32(v16 x)
+{
+    v32 r;
+    r.lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    r.hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    return r;
+}
+
+/* x * y, both signed */
+static INLINE v32 vmul32(v16 x, v16 y)
+{
+    const __m128i lo = _mm_mullo_epi16(x, y);
+    const __m128i hi = _mm_mulhi_epi16(x, y);
+    v32 r;
+    r.lo = _mm_unpacklo_epi16(lo, hi);
+    r.hi = _mm_unpackhi_epi16(lo, hi);
+    return r;
+}
+
+/* x * y with y unsigned, modulo 2^32 */
+static INLINE v32 vmul32su(v16 x, v16 y)
+{
+    const __m128i lo = _mm_mullo_epi16(x, y);
+    const __m128i hi = _mm_sub_epi16(_mm_mulhi_epu16(x, y),
+            _mm_and_si128(_mm_srai_epi16(x, 15), y));
+    v32 r;
+    r.lo = _mm_unpacklo_epi16(lo, hi);
+    r.hi = _mm_unpackhi_epi16(lo, hi);
+    return r;
+}
+
+static INLINE v32 vadd32(v32 x, v32 y)
+{
+    x.lo = _mm_add_epi32(x.lo, y.lo);
+    x.hi = _mm_add_epi32(x.hi, y.hi);
+    return x;
+}
+
+static INLINE v32 vaddn32(v32 x, int32_t n)
+{
+    const __m128i y = _mm_set1_epi32(n);
+    x.lo = _mm_add_epi32(x.lo, y);
+    x.hi = _mm_add_epi32(x.hi, y);
+    return x;
+}
+
+static INLINE v32 vsra32(v32 x, int n)
+{
+    x.lo = _mm_srai_epi32(x.lo, n);
+    x.hi = _mm_srai_epi32(x.hi, n);
+    return x;
+}
+
+/* narrows with clamp_s16 */
+static INLINE v16 vpack32(v32 x)
+{
+    return _mm_packs_epi32(x.lo, x.hi);
+}
+
+/* narrows by keeping the low 16 bits, like an (int16_t) cast */
+static INLINE v16 vwrap32(v32 x)
+{
+    x.lo = _mm_srai_epi32(_mm_slli_epi32(x.lo, 16), 16);
+    x.hi = _mm_srai_epi32(_mm_slli_epi32(x.hi, 16), 16);
+    return _mm_packs_epi32(x.lo, x.hi);
+}
+
+#elif defined(ARCH_MIN_ARM_NEON)
+#include <arm_neon.h>
+#define HLE_SIMD
+
+typedef int16x8_t v16;
+typedef int32x4x2_t v32;
+
+static INLINE v16 vload16(const int16_t* src)
+{
+    return vld1q_s16(src);
+}
+
+static INLINE void vstore16(int16_t* dst, v16 x)
+{
+    vst1q_s16(dst, x);
+}
+
+static INLINE v16 vdup16(int16_t x)
+{
+    return vdupq_n_s16(x);
+}
+
+static INLINE v16 vadds16(v16 x, v16 y)
+{
+    return vqaddq_s16(x, y);
+}
+
+static INLINE v16 vxor16(v16 x, v16 y)
+{
+    return veorq_s16(x, y);
+}
+
+/* swaps the two samples of each 32-bit word */
+static INLINE v16 vswap16(v16 x)
+{
+    return vrev32q_s16(x);
+}
+
+/* samples n to n + 7 of x followed by y, n a constant from 1 to 7 */
+#define vext16(x, y, n) vextq_s16((x), (y), (n))
+
+static INLINE v32 vload32(const int32_t* src)
+{
+    v32 r;
+    r.val[0] = vld1q_s32(src);
+    r.val[1] = vld1q_s32(src + 4);
+    return r;
+}
+
+static INLINE v32 vwiden32(v16 x)
+{
+    v32 r;
+    r.val[0] = vmovl_s16(vget_low_s16(x));
+    r.val[1] = vmovl_s16(vget_high_s16(x));
+    return r;
+}
+
+/* x * y, both signed */
+static INLINE v32 vmul32(v16 x, v16 y)
+{
+    v32 r;
+    r.val[0] = vmull_s16(vget_low_s16(x), vget_low_s16(y));
+    r.val[1] = vmull_s16(vget_high_s16(x), vget_high_s16(y));
+    return r;
+}
+
+/* x * y with y unsigned, modulo 2^32 */
+static INLINE v32 vmul32su(v16 x, v16 y)
+{
+    const uint16x8_t u = vreinterpretq_u16_s16(y);
+    v32 r;
+    r.val[0] = vmulq_s32(vmovl_s16(vget_low_s16(x)),
+            vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(u))));
+    r.val[1] = vmulq_s32(vmovl_s16(vget_high_s16(x)),
+            vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(u))));
+    return r;
+}
+
+static INLINE v32 vadd32(v32 x, v32 y)
+{
+    x.val[0] = vaddq_s32(x.val[0], y.val[0]);
+    x.val[1] = vaddq_s32(x.val[1], y.val[1]);
+    return x;
+}
+
+static INLINE v32 vaddn32(v32 x, int32_t n)
+{
+    const int32x4_t y = vdupq_n_s32(n);
+    x.val[0] = vaddq_s32(x.val[0], y);
+    x.val[1] = vaddq_s32(x.val[1], y);
+    return x;
+}
+
+static INLINE v32 vsra32(v32 x, int n)
+{
+    const int32x4_t y = vdupq_n_s32(-n);
+    x.val[0] = vshlq_s32(x.val[0], y);
+    x.val[1] = vshlq_s32(x.val[1], y);
+    return x;
+}
+
+/* narrows with clamp_s16 */
+static INLINE v16 vpack32(v32 x)
+{
+    return vcombine_s16(vqmovn_s32(x.val[0]), vqmovn_s32(x.val[1]));
+}
+
+/* narrows by keeping the low 16 bits, like an (int16_t) cast */
+static INLINE v16 vwrap32(v32 x)
+{
+    return vcombine_s16(vmovn_s32(x.val[0]), vmovn_s32(x.val[1]));
+}
+#endif
+
+#ifdef HLE_SIMD
+/* clamp_s16(x + ((y * gain) >> 15)) */
+static INLINE v16 vmix16(v16 x, v16 y, v16 gain)
+{
+    return vpack32(vadd32(vwiden32(x), vsra32(vmul32(y, gain), 15)));
+}
+
+/* clamp_s16((x * y + 0x4000) >> 15) */
+static INLINE v16 vmulr16(v16 x, v16 y)
+{
+    return vpack32(vsra32(vaddn32(vmul32(x, y), 0x4000), 15));
+}
+#endif
+
+#endif
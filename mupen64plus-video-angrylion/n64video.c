@@ -5,84 +5,14 @@
 #include "rdp.h"
 #include <stdarg.h>
 
-int scfield;
-int sckeepodd;
-
-int ti_format;
-int ti_size;
-int ti_width;
-UINT32 ti_address;
-
-int fb_format;
-int fb_size;
-int fb_width;
-UINT32 fb_address;
-UINT32 zb_address;
-
-UINT32 max_level;
-INT32 min_level;
-INT32 primitive_lod_frac;
-
-UINT32 primitive_z;
-UINT16 primitive_delta_z;
-
-UINT32 fill_color;
-
-INT32 *combiner_rgbsub_a_r[2];
-INT32 *combiner_rgbsub_a_g[2];
-INT32 *combiner_rgbsub_a_b[2];
-INT32 *combiner_rgbsub_b_r[2];
-INT32 *combiner_rgbsub_b_g[2];
-INT32 *combiner_rgbsub_b_b[2];
-INT32 *combiner_rgbmul_r[2];
-INT32 *combiner_rgbmul_g[2];
-INT32 *combiner_rgbmul_b[2];
-INT32 *combiner_rgbadd_r[2];
-INT32 *combiner_rgbadd_g[2];
-INT32 *combiner_rgbadd_b[2];
-
-INT32 *combiner_alphasub_a[2];
-INT32 *combiner_alphasub_b[2];
-INT32 *combiner_alphamul[2];
-INT32 *combiner_alphaadd[2];
-
-INT32 *blender1a_r[2];
-INT32 *blender1a_g[2];
-INT32 *blender1a_b[2];
-INT32 *blender1b_a[2];
-INT32 *blender2a_r[2];
-INT32 *blender2a_g[2];
-INT32 *blender2a_b[2];
-INT32 *blender2b_a[2];
-
-INT32 k0, k1, k2, k3, k4, k5;
-
-TILE tile[8];
-
-OTHER_MODES other_modes;
-COMBINE_MODES combine;
-
-COLOR key_width;
-COLOR key_scale;
-COLOR key_center;
-COLOR fog_color;
-COLOR blend_color;
-COLOR prim_color;
-COLOR env_color;
+/* the emulation thread's, which is render thread 0 as well */
+static RDP_STATE rdp_main_state;
+TLS RDP_STATE* rdp_state = &rdp_main_state;
 
 int rdp_pipeline_crashed;
 
 UINT32 z64gl_command;
 
-RECTANGLE __clip = {
-    0, 0, 0x2000, 0x2000
-};
-
-void (*fbread1_ptr)(UINT32, UINT32*);
-void (*fbread2_ptr)(UINT32, UINT32*);
-void (*fbwrite_ptr)(UINT32, UINT32, UINT32, UINT32, UINT32, UINT32, UINT32);
-void (*fbfill_ptr)(UINT32);
-
 #undef  LOG_RDP_EXECUTION
 #define DETAILED_LOGGING 0
 
@@ -95,21 +25,6 @@ UINT32 old_vi_origin = 0;
 UINT32 oldhstart = 0;
 UINT32 oldsomething = 0;
 UINT32 double_stretch = 0;
-int blshifta = 0, blshiftb = 0, pastblshifta = 0, pastblshiftb = 0;
-INT32 iseed = 1;
-
-SPAN span[1024];
-UINT32 cvgbuf[1024];
-
-i32 spans_d_rgba[4];
-i32 spans_d_stwz[4];
-u16 spans_dzpix;
-
-i32 spans_d_rgba_dy[4];
-i32 spans_cd_rgba[4];
-int spans_cdz;
-
-i32 spans_d_stwz_dy[4];
 
 typedef struct
 {
@@ -137,30 +52,14 @@ typedef struct
 #define ZMODE_TRANSPARENT        2
 #define ZMODE_DECAL                3
 
-COLOR combined_color;
-COLOR texel0_color;
-COLOR texel1_color;
-COLOR nexttexel_color;
-COLOR shade_color;
-static INT32 noise = 0;
 static INT32 one_color = 0x100;
 static INT32 zero_color = 0x00;
 
-INT32 keyalpha;
-
 static INT32 blenderone    = 0xff;
 
-COLOR pixel_color;
-COLOR inv_pixel_color;
-COLOR blended_pixel_color;
-COLOR memory_color;
-COLOR pre_memory_color;
-
 int oldscyl = 0;
 
-UINT8 __TMEM[0x1000]; 
-
-#define tlut ((UINT16*)(&__TMEM[0x800]))
+#define tlut ((UINT16*)(&rdp_state->__TMEM[0x800]))
 
 #define PIXELS_TO_BYTES(pix, siz) (((pix) << (siz)) >> 1)
 
@@ -199,7 +98,6 @@ int blender_2cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 blend_en
 static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST, UINT32 tilenum, UINT32 cycle);
 static void tc_pipeline_copy(INT32* sss0, INT32* sss1, INT32* sss2, INT32* sss3, INT32* sst, int tilenum);
 STRICTINLINE void tc_pipeline_load(INT32* sss, INT32* sst, int tilenum, int coord_quad);
-STRICTINLINE void tcclamp_generic(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC, INT32 maxs, INT32 maxt, INT32 num);
 STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC, INT32 maxs, INT32 maxt, INT32 num);
 STRICTINLINE void tcclamp_cycle_light(INT32* S, INT32* T, INT32 maxs, INT32 maxt, INT32 num);
 STRICTINLINE void tcshift_cycle(INT32* S, INT32* T, INT32* maxs, INT32* maxt, UINT32 num);
@@ -227,6 +125,7 @@ static UINT32 z_compare(UINT32 zcurpixel, UINT32 sz, UINT16 dzpix, int dzpixenc,
 STRICTINLINE int finalize_spanalpha(
     UINT32 blend_en, UINT32 curpixel_cvg, UINT32 curpixel_memcvg);
 STRICTINLINE INT32 CLIP(INT32 value,INT32 min,INT32 max);
+STRICTINLINE INT32 irand(void);
 static void tcdiv_persp(INT32 ss, INT32 st, INT32 sw, INT32* sss, INT32* sst);
 static void tcdiv_nopersp(INT32 ss, INT32 st, INT32 sw, INT32* sss, INT32* sst);
 STRICTINLINE void tclod_4x17_to_15(INT32 scurr, INT32 snext, INT32 tcurr, INT32 tnext, INT32 previous, INT32* lod);
@@ -251,7 +150,6 @@ static void rgbaz_correct_clip(int offx, int offy, int r, int g, int b, int a, i
 int IsBadPtrW32(void *ptr, UINT32 bytes);
 UINT32 vi_integer_sqrt(UINT32 a);
 
-static INT32 lod_frac = 0;
 UINT32 DebugMode = 0, DebugMode2 = 0;
 int debugcolor = 0;
 struct {UINT32 shift; UINT32 add;} z_dec_table[8] = {
@@ -290,11 +188,6 @@ static void (*render_spans_2cycle_func[4])(int, int, int, int) =
     render_spans_2cycle_notex, render_spans_2cycle_notexel1, render_spans_2cycle_notexelnext, render_spans_2cycle_complete
 };
 
-static void (*get_dither_noise_ptr)(int, int, int*, int*);
-static void (*rgb_dither_ptr)(int*, int*, int*, int);
-static void (*tcdiv_ptr)(INT32, INT32, INT32, INT32*, INT32*);
-void (*render_spans_1cycle_ptr)(int, int, int, int);
-void (*render_spans_2cycle_ptr)(int, int, int, int);
 
 UINT16 z_com_table[0x40000];
 UINT32 z_complete_dec_table[0x4000];
@@ -321,27 +214,27 @@ STRICTINLINE void tcmask(INT32* S, INT32* T, INT32 num)
     
     
 
-    if (tile[num].mask_s)
+    if (rdp_state->tile[num].mask_s)
     {
-        if (tile[num].ms)
+        if (rdp_state->tile[num].ms)
         {
-            wrap = *S >> tile[num].f.masksclamped;
+            wrap = *S >> rdp_state->tile[num].f.masksclamped;
             wrap &= 1;
             *S ^= (-wrap);
         }
-        *S &= maskbits_table[tile[num].mask_s];
+        *S &= maskbits_table[rdp_state->tile[num].mask_s];
     }
 
-    if (tile[num].mask_t)
+    if (rdp_state->tile[num].mask_t)
     {
-        if (tile[num].mt)
+        if (rdp_state->tile[num].mt)
         {
-            wrap = *T >> tile[num].f.masktclamped;
+            wrap = *T >> rdp_state->tile[num].f.masktclamped;
             wrap &= 1;
             *T ^= (-wrap);
         }
         
-        *T &= maskbits_table[tile[num].mask_t];
+        *T &= maskbits_table[rdp_state->tile[num].mask_t];
     }
 }
 
@@ -354,11 +247,11 @@ STRICTINLINE void tcmask_coupled(INT32* S, INT32* S1, INT32* T, INT32* T1, INT32
     INT32 wrapthreshold; 
 
 
-    if (tile[num].mask_s)
+    if (rdp_state->tile[num].mask_s)
     {
-        if (tile[num].ms)
+        if (rdp_state->tile[num].ms)
         {
-            wrapthreshold = tile[num].f.masksclamped;
+            wrapthreshold = rdp_state->tile[num].f.masksclamped;
 
             wrap = (*S >> wrapthreshold) & 1;
             *S ^= (-wrap);
@@ -367,16 +260,16 @@ STRICTINLINE void tcmask_coupled(INT32* S, INT32* S1, INT32* T, INT32* T1, INT32
             *S1 ^= (-wrap);
         }
 
-        maskbits = maskbits_table[tile[num].mask_s];
+        maskbits = maskbits_table[rdp_state->tile[num].mask_s];
         *S &= maskbits;
         *S1 &= maskbits;
     }
 
-    if (tile[num].mask_t)
+    if (rdp_state->tile[num].mask_t)
     {
-        if (tile[num].mt)
+        if (rdp_state->tile[num].mt)
         {
-            wrapthreshold = tile[num].f.masktclamped;
+            wrapthreshold = rdp_state->tile[num].f.masktclamped;
 
             wrap = (*T >> wrapthreshold) & 1;
             *T ^= (-wrap);
@@ -384,7 +277,7 @@ STRICTINLINE void tcmask_coupled(INT32* S, INT32* S1, INT32* T, INT32* T1, INT32
             wrap = (*T1 >> wrapthreshold) & 1;
             *T1 ^= (-wrap);
         }
-        maskbits = maskbits_table[tile[num].mask_t];
+        maskbits = maskbits_table[rdp_state->tile[num].mask_t];
         *T &= maskbits;
         *T1 &= maskbits;
     }
@@ -398,11 +291,11 @@ STRICTINLINE void tcmask_copy(INT32* S, INT32* S1, INT32* S2, INT32* S3, INT32*
     INT32 maskbits_s; 
     INT32 swrapthreshold; 
 
-    if (tile[num].mask_s)
+    if (rdp_state->tile[num].mask_s)
     {
-        if (tile[num].ms)
+        if (rdp_state->tile[num].ms)
         {
-            swrapthreshold = tile[num].f.masksclamped;
+            swrapthreshold = rdp_state->tile[num].f.masksclamped;
 
             wrap = (*S >> swrapthreshold) & 1;
             *S ^= (-wrap);
@@ -417,23 +310,23 @@ STRICTINLINE void tcmask_copy(INT32* S, INT32* S1, INT32* S2, INT32* S3, INT32*
             *S3 ^= (-wrap);
         }
 
-        maskbits_s = maskbits_table[tile[num].mask_s];
+        maskbits_s = maskbits_table[rdp_state->tile[num].mask_s];
         *S &= maskbits_s;
         *S1 &= maskbits_s;
         *S2 &= maskbits_s;
         *S3 &= maskbits_s;
     }
 
-    if (tile[num].mask_t)
+    if (rdp_state->tile[num].mask_t)
     {
-        if (tile[num].mt)
+        if (rdp_state->tile[num].mt)
         {
-            wrap = *T >> tile[num].f.masktclamped; 
+            wrap = *T >> rdp_state->tile[num].f.masktclamped; 
             wrap &= 1;
             *T ^= (-wrap);
         }
 
-        *T &= maskbits_table[tile[num].mask_t];
+        *T &= maskbits_table[rdp_state->tile[num].mask_t];
     }
 }
 
@@ -444,7 +337,7 @@ STRICTINLINE void tcshift_cycle(INT32* S, INT32* T, INT32* maxs, INT32* maxt, UI
 
 
     INT32 coord = *S;
-    INT32 shifter = tile[num].shift_s;
+    INT32 shifter = rdp_state->tile[num].shift_s;
 
     if (shifter < 11)
     {
@@ -461,12 +354,12 @@ STRICTINLINE void tcshift_cycle(INT32* S, INT32* T, INT32* maxs, INT32* maxt, UI
     
 
     
-    *maxs = ((coord >> 3) >= tile[num].sh);
+    *maxs = ((coord >> 3) >= rdp_state->tile[num].sh);
     
     
 
     coord = *T;
-    shifter = tile[num].shift_t;
+    shifter = rdp_state->tile[num].shift_t;
 
     if (shifter < 11)
     {
@@ -479,14 +372,14 @@ STRICTINLINE void tcshift_cycle(INT32* S, INT32* T, INT32* maxs, INT32* maxt, UI
         coord = SIGN16(coord);
     }
     *T = coord; 
-    *maxt = ((coord >> 3) >= tile[num].th);
+    *maxt = ((coord >> 3) >= rdp_state->tile[num].th);
 }    
 
 
 STRICTINLINE void tcshift_copy(INT32* S, INT32* T, UINT32 num)
 {
     INT32 coord = *S;
-    INT32 shifter = tile[num].shift_s;
+    INT32 shifter = rdp_state->tile[num].shift_s;
 
     if (shifter < 11)
     {
@@ -501,7 +394,7 @@ STRICTINLINE void tcshift_copy(INT32* S, INT32* T, UINT32 num)
     *S = coord; 
 
     coord = *T;
-    shifter = tile[num].shift_t;
+    shifter = rdp_state->tile[num].shift_t;
 
     if (shifter < 11)
     {
@@ -522,7 +415,7 @@ STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC,
 {
 
     INT32 locs = *S, loct = *T;
-    if (tile[num].f.clampens)
+    if (rdp_state->tile[num].f.clampens)
     {
         if (!(locs & 0x10000))
         {
@@ -530,7 +423,7 @@ STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC,
                 *S = (locs >> 5);
             else
             {
-                *S = tile[num].f.clampdiffs;
+                *S = rdp_state->tile[num].f.clampdiffs;
                 *SFRAC = 0;
             }
         }
@@ -543,7 +436,7 @@ STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC,
     else
         *S = (locs >> 5);
 
-    if (tile[num].f.clampent)
+    if (rdp_state->tile[num].f.clampent)
     {
         if (!(loct & 0x10000))
         {
@@ -551,7 +444,7 @@ STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC,
                 *T = (loct >> 5);
             else
             {
-                *T = tile[num].f.clampdifft;
+                *T = rdp_state->tile[num].f.clampdifft;
                 *TFRAC = 0;
             }
         }
@@ -569,14 +462,14 @@ STRICTINLINE void tcclamp_cycle(INT32* S, INT32* T, INT32* SFRAC, INT32* TFRAC,
 STRICTINLINE void tcclamp_cycle_light(INT32* S, INT32* T, INT32 maxs, INT32 maxt, INT32 num)
 {
     INT32 locs = *S, loct = *T;
-    if (tile[num].f.clampens)
+    if (rdp_state->tile[num].f.clampens)
     {
         if (!(locs & 0x10000))
         {
             if (!maxs)
                 *S = (locs >> 5);
             else
-                *S = tile[num].f.clampdiffs;
+                *S = rdp_state->tile[num].f.clampdiffs;
         }
         else
             *S = 0;
@@ -584,14 +477,14 @@ STRICTINLINE void tcclamp_cycle_light(INT32* S, INT32* T, INT32 maxs, INT32 maxt
     else
         *S = (locs >> 5);
 
-    if (tile[num].f.clampent)
+    if (rdp_state->tile[num].f.clampent)
     {
         if (!(loct & 0x10000))
         {
             if (!maxt)
                 *T = (loct >> 5);
             else
-                *T = tile[num].f.clampdifft;
+                *T = rdp_state->tile[num].f.clampdifft;
         }
         else
             *T = 0;
@@ -609,61 +502,12 @@ void rdp_init(void)
         rdp_exec = fopen("rdp_execute.txt", "wt");
 #endif
 
-    fbread1_ptr = fbread_func[0];
-    fbread2_ptr = fbread2_func[0];
-    fbwrite_ptr = fbwrite_func[0];
-    fbfill_ptr = fbfill_func[0];
-    get_dither_noise_ptr = get_dither_noise_func[0];
-    rgb_dither_ptr = rgb_dither_func[0];
-    tcdiv_ptr = tcdiv_func[0];
-    render_spans_1cycle_ptr = render_spans_1cycle_func[2];
-    render_spans_2cycle_ptr = render_spans_2cycle_func[1];
-
-    combiner_rgbsub_a_r[0] = combiner_rgbsub_a_r[1] = &one_color;
-    combiner_rgbsub_a_g[0] = combiner_rgbsub_a_g[1] = &one_color;
-    combiner_rgbsub_a_b[0] = combiner_rgbsub_a_b[1] = &one_color;
-    combiner_rgbsub_b_r[0] = combiner_rgbsub_b_r[1] = &one_color;
-    combiner_rgbsub_b_g[0] = combiner_rgbsub_b_g[1] = &one_color;
-    combiner_rgbsub_b_b[0] = combiner_rgbsub_b_b[1] = &one_color;
-    combiner_rgbmul_r[0] = combiner_rgbmul_r[1] = &one_color;
-    combiner_rgbmul_g[0] = combiner_rgbmul_g[1] = &one_color;
-    combiner_rgbmul_b[0] = combiner_rgbmul_b[1] = &one_color;
-    combiner_rgbadd_r[0] = combiner_rgbadd_r[1] = &one_color;
-    combiner_rgbadd_g[0] = combiner_rgbadd_g[1] = &one_color;
-    combiner_rgbadd_b[0] = combiner_rgbadd_b[1] = &one_color;
-
-    combiner_alphasub_a[0] = combiner_alphasub_a[1] = &one_color;
-    combiner_alphasub_b[0] = combiner_alphasub_b[1] = &one_color;
-    combiner_alphamul[0] = combiner_alphamul[1] = &one_color;
-    combiner_alphaadd[0] = combiner_alphaadd[1] = &one_color;
-
-    SET_BLENDER_INPUT(0, 0, &blender1a_r[0], &blender1a_g[0], &blender1a_b[0],
-                      &blender1b_a[0], 0, 0);
-    SET_BLENDER_INPUT(0, 1, &blender2a_r[0], &blender2a_g[0], &blender2a_b[0],
-                      &blender2b_a[0], 0, 0);
-    SET_BLENDER_INPUT(1, 0, &blender1a_r[1], &blender1a_g[1], &blender1a_b[1],
-                      &blender1b_a[1], 0, 0);
-    SET_BLENDER_INPUT(1, 1, &blender2a_r[1], &blender2a_g[1], &blender2a_b[1],
-                      &blender2b_a[1], 0, 0);
-    other_modes.f.stalederivs = 1;
-    zerobuf(__TMEM, 0x1000);
+    rdp_state = &rdp_main_state;
+    rdp_init_state();
 
     for (i = 0; i < sizeof(hidden_bits); i++)
         hidden_bits[i] = 0x03;
 
-    zerobuf(tile, sizeof(tile));
-    for (i = 0; i < 8; i++)
-    {
-        calculate_tile_derivs(i);
-        calculate_clamp_diffs(i);
-    }
-
-    zerobuf(&combined_color, sizeof(COLOR));
-    zerobuf(&prim_color, sizeof(COLOR));
-    zerobuf(&env_color, sizeof(COLOR));
-    zerobuf(&key_scale, sizeof(COLOR));
-    zerobuf(&key_center, sizeof(COLOR));
-
     rdp_pipeline_crashed = 0;
     zerobuf(&onetimewarnings, sizeof(onetimewarnings));
 
@@ -684,20 +528,90 @@ void rdp_init(void)
 
     rdram_8 = (UINT8*)gfx_info.RDRAM;
     rdram_16 = (UINT16*)gfx_info.RDRAM;
+
+#ifdef HAVE_RDP_THREADS
+    rdp_threads_init();
+#endif
+}
+
+/*
+ * Resets the RDP_STATE rdp_state points to, as render thread 0.  Each worker
+ * runs this on its own state, as the combiner and blender inputs point into
+ * it, and then sets its thread index.
+ */
+void rdp_init_state(void)
+{
+    const RECTANGLE clip = { 0, 0, 0x2000, 0x2000 };
+    register int i;
+
+    zerobuf(rdp_state, sizeof(*rdp_state));
+    rdp_state->__clip = clip;
+    rdp_state->iseed = 1;
+    rdp_state->fbread1_ptr = fbread_func[0];
+    rdp_state->fbread2_ptr = fbread2_func[0];
+    rdp_state->fbwrite_ptr = fbwrite_func[0];
+    rdp_state->fbfill_ptr = fbfill_func[0];
+    rdp_state->get_dither_noise_ptr = get_dither_noise_func[0];
+    rdp_state->rgb_dither_ptr = rgb_dither_func[0];
+    rdp_state->tcdiv_ptr = tcdiv_func[0];
+    rdp_state->render_spans_1cycle_ptr = render_spans_1cycle_func[2];
+    rdp_state->render_spans_2cycle_ptr = render_spans_2cycle_func[1];
+
+    rdp_state->combiner_rgbsub_a_r[0] = rdp_state->combiner_rgbsub_a_r[1] = &one_color;
+    rdp_state->combiner_rgbsub_a_g[0] = rdp_state->combiner_rgbsub_a_g[1] = &one_color;
+    rdp_state->combiner_rgbsub_a_b[0] = rdp_state->combiner_rgbsub_a_b[1] = &one_color;
+    rdp_state->combiner_rgbsub_b_r[0] = rdp_state->combiner_rgbsub_b_r[1] = &one_color;
+    rdp_state->combiner_rgbsub_b_g[0] = rdp_state->combiner_rgbsub_b_g[1] = &one_color;
+    rdp_state->combiner_rgbsub_b_b[0] = rdp_state->combiner_rgbsub_b_b[1] = &one_color;
+    rdp_state->combiner_rgbmul_r[0] = rdp_state->combiner_rgbmul_r[1] = &one_color;
+    rdp_state->combiner_rgbmul_g[0] = rdp_state->combiner_rgbmul_g[1] = &one_color;
+    rdp_state->combiner_rgbmul_b[0] = rdp_state->combiner_rgbmul_b[1] = &one_color;
+    rdp_state->combiner_rgbadd_r[0] = rdp_state->combiner_rgbadd_r[1] = &one_color;
+    rdp_state->combiner_rgbadd_g[0] = rdp_state->combiner_rgbadd_g[1] = &one_color;
+    rdp_state->combiner_rgbadd_b[0] = rdp_state->combiner_rgbadd_b[1] = &one_color;
+
+    rdp_state->combiner_alphasub_a[0] = rdp_state->combiner_alphasub_a[1] = &one_color;
+    rdp_state->combiner_alphasub_b[0] = rdp_state->combiner_alphasub_b[1] = &one_color;
+    rdp_state->combiner_alphamul[0] = rdp_state->combiner_alphamul[1] = &one_color;
+    rdp_state->combiner_alphaadd[0] = rdp_state->combiner_alphaadd[1] = &one_color;
+
+    SET_BLENDER_INPUT(0, 0, &rdp_state->blender1a_r[0], &rdp_state->blender1a_g[0], &rdp_state->blender1a_b[0],
+                      &rdp_state->blender1b_a[0], 0, 0);
+    SET_BLENDER_INPUT(0, 1, &rdp_state->blender2a_r[0], &rdp_state->blender2a_g[0], &rdp_state->blender2a_b[0],
+                      &rdp_state->blender2b_a[0], 0, 0);
+    SET_BLENDER_INPUT(1, 0, &rdp_state->blender1a_r[1], &rdp_state->blender1a_g[1], &rdp_state->blender1a_b[1],
+                      &rdp_state->blender1b_a[1], 0, 0);
+    SET_BLENDER_INPUT(1, 1, &rdp_state->blender2a_r[1], &rdp_state->blender2a_g[1], &rdp_state->blender2a_b[1],
+                      &rdp_state->blender2b_a[1], 0, 0);
+    rdp_state->other_modes.f.stalederivs = 1;
+    zerobuf(rdp_state->__TMEM, 0x1000);
+
+    zerobuf(rdp_state->tile, sizeof(rdp_state->tile));
+    for (i = 0; i < 8; i++)
+    {
+        calculate_tile_derivs(i);
+        calculate_clamp_diffs(i);
+    }
+
+    zerobuf(&rdp_state->combined_color, sizeof(COLOR));
+    zerobuf(&rdp_state->prim_color, sizeof(COLOR));
+    zerobuf(&rdp_state->env_color, sizeof(COLOR));
+    zerobuf(&rdp_state->key_scale, sizeof(COLOR));
+    zerobuf(&rdp_state->key_center, sizeof(COLOR));
 }
 
 INLINE void SET_SUBA_RGB_INPUT(INT32 **input_r, INT32 **input_g, INT32 **input_b, int code)
 {
     switch (code & 0xf)
     {
-        case 0:        *input_r = &combined_color.r;    *input_g = &combined_color.g;    *input_b = &combined_color.b;    break;
-        case 1:        *input_r = &texel0_color.r;        *input_g = &texel0_color.g;        *input_b = &texel0_color.b;        break;
-        case 2:        *input_r = &texel1_color.r;        *input_g = &texel1_color.g;        *input_b = &texel1_color.b;        break;
-        case 3:        *input_r = &prim_color.r;        *input_g = &prim_color.g;        *input_b = &prim_color.b;        break;
-        case 4:        *input_r = &shade_color.r;        *input_g = &shade_color.g;        *input_b = &shade_color.b;        break;
-        case 5:        *input_r = &env_color.r;        *input_g = &env_color.g;        *input_b = &env_color.b;        break;
+        case 0:        *input_r = &rdp_state->combined_color.r;    *input_g = &rdp_state->combined_color.g;    *input_b = &rdp_state->combined_color.b;    break;
+        case 1:        *input_r = &rdp_state->texel0_color.r;        *input_g = &rdp_state->texel0_color.g;        *input_b = &rdp_state->texel0_color.b;        break;
+        case 2:        *input_r = &rdp_state->texel1_color.r;        *input_g = &rdp_state->texel1_color.g;        *input_b = &rdp_state->texel1_color.b;        break;
+        case 3:        *input_r = &rdp_state->prim_color.r;        *input_g = &rdp_state->prim_color.g;        *input_b = &rdp_state->prim_color.b;        break;
+        case 4:        *input_r = &rdp_state->shade_color.r;        *input_g = &rdp_state->shade_color.g;        *input_b = &rdp_state->shade_color.b;        break;
+        case 5:        *input_r = &rdp_state->env_color.r;        *input_g = &rdp_state->env_color.g;        *input_b = &rdp_state->env_color.b;        break;
         case 6:        *input_r = &one_color;            *input_g = &one_color;            *input_b = &one_color;        break;
-        case 7:        *input_r = &noise;                *input_g = &noise;                *input_b = &noise;                break;
+        case 7:        *input_r = &rdp_state->noise;                *input_g = &rdp_state->noise;                *input_b = &rdp_state->noise;                break;
         case 8: case 9: case 10: case 11: case 12: case 13: case 14: case 15:
         {
             *input_r = &zero_color;        *input_g = &zero_color;        *input_b = &zero_color;        break;
@@ -709,14 +623,14 @@ INLINE void SET_SUBB_RGB_INPUT(INT32 **input_r, INT32 **input_g, INT32 **input_b
 {
     switch (code & 0xf)
     {
-        case 0:        *input_r = &combined_color.r;    *input_g = &combined_color.g;    *input_b = &combined_color.b;    break;
-        case 1:        *input_r = &texel0_color.r;        *input_g = &texel0_color.g;        *input_b = &texel0_color.b;        break;
-        case 2:        *input_r = &texel1_color.r;        *input_g = &texel1_color.g;        *input_b = &texel1_color.b;        break;
-        case 3:        *input_r = &prim_color.r;        *input_g = &prim_color.g;        *input_b = &prim_color.b;        break;
-        case 4:        *input_r = &shade_color.r;        *input_g = &shade_color.g;        *input_b = &shade_color.b;        break;
-        case 5:        *input_r = &env_color.r;        *input_g = &env_color.g;        *input_b = &env_color.b;        break;
-        case 6:        *input_r = &key_center.r;        *input_g = &key_center.g;        *input_b = &key_center.b;        break;
-        case 7:        *input_r = &k4;                    *input_g = &k4;                    *input_b = &k4;                    break;
+        case 0:        *input_r = &rdp_state->combined_color.r;    *input_g = &rdp_state->combined_color.g;    *input_b = &rdp_state->combined_color.b;    break;
+        case 1:        *input_r = &rdp_state->texel0_color.r;        *input_g = &rdp_state->texel0_color.g;        *input_b = &rdp_state->texel0_color.b;        break;
+        case 2:        *input_r = &rdp_state->texel1_color.r;        *input_g = &rdp_state->texel1_color.g;        *input_b = &rdp_state->texel1_color.b;        break;
+        case 3:        *input_r = &rdp_state->prim_color.r;        *input_g = &rdp_state->prim_color.g;        *input_b = &rdp_state->prim_color.b;        break;
+        case 4:        *input_r = &rdp_state->shade_color.r;        *input_g = &rdp_state->shade_color.g;        *input_b = &rdp_state->shade_color.b;        break;
+        case 5:        *input_r = &rdp_state->env_color.r;        *input_g = &rdp_state->env_color.g;        *input_b = &rdp_state->env_color.b;        break;
+        case 6:        *input_r = &rdp_state->key_center.r;        *input_g = &rdp_state->key_center.g;        *input_b = &rdp_state->key_center.b;        break;
+        case 7:        *input_r = &rdp_state->k4;                    *input_g = &rdp_state->k4;                    *input_b = &rdp_state->k4;                    break;
         case 8: case 9: case 10: case 11: case 12: case 13: case 14: case 15:
         {
             *input_r = &zero_color;        *input_g = &zero_color;        *input_b = &zero_color;        break;
@@ -728,22 +642,22 @@ INLINE void SET_MUL_RGB_INPUT(INT32 **input_r, INT32 **input_g, INT32 **input_b,
 {
     switch (code & 0x1f)
     {
-        case 0:        *input_r = &combined_color.r;    *input_g = &combined_color.g;    *input_b = &combined_color.b;    break;
-        case 1:        *input_r = &texel0_color.r;        *input_g = &texel0_color.g;        *input_b = &texel0_color.b;        break;
-        case 2:        *input_r = &texel1_color.r;        *input_g = &texel1_color.g;        *input_b = &texel1_color.b;        break;
-        case 3:        *input_r = &prim_color.r;        *input_g = &prim_color.g;        *input_b = &prim_color.b;        break;
-        case 4:        *input_r = &shade_color.r;        *input_g = &shade_color.g;        *input_b = &shade_color.b;        break;
-        case 5:        *input_r = &env_color.r;        *input_g = &env_color.g;        *input_b = &env_color.b;        break;
-        case 6:        *input_r = &key_scale.r;        *input_g = &key_scale.g;        *input_b = &key_scale.b;        break;
-        case 7:        *input_r = &combined_color.a;    *input_g = &combined_color.a;    *input_b = &combined_color.a;    break;
-        case 8:        *input_r = &texel0_color.a;        *input_g = &texel0_color.a;        *input_b = &texel0_color.a;        break;
-        case 9:        *input_r = &texel1_color.a;        *input_g = &texel1_color.a;        *input_b = &texel1_color.a;        break;
-        case 10:    *input_r = &prim_color.a;        *input_g = &prim_color.a;        *input_b = &prim_color.a;        break;
-        case 11:    *input_r = &shade_color.a;        *input_g = &shade_color.a;        *input_b = &shade_color.a;        break;
-        case 12:    *input_r = &env_color.a;        *input_g = &env_color.a;        *input_b = &env_color.a;        break;
-        case 13:    *input_r = &lod_frac;            *input_g = &lod_frac;            *input_b = &lod_frac;            break;
-        case 14:    *input_r = &primitive_lod_frac;    *input_g = &primitive_lod_frac;    *input_b = &primitive_lod_frac; break;
-        case 15:    *input_r = &k5;                    *input_g = &k5;                    *input_b = &k5;                    break;
+        case 0:        *input_r = &rdp_state->combined_color.r;    *input_g = &rdp_state->combined_color.g;    *input_b = &rdp_state->combined_color.b;    break;
+        case 1:        *input_r = &rdp_state->texel0_color.r;        *input_g = &rdp_state->texel0_color.g;        *input_b = &rdp_state->texel0_color.b;        break;
+        case 2:        *input_r = &rdp_state->texel1_color.r;        *input_g = &rdp_state->texel1_color.g;        *input_b = &rdp_state->texel1_color.b;        break;
+        case 3:        *input_r = &rdp_state->prim_color.r;        *input_g = &rdp_state->prim_color.g;        *input_b = &rdp_state->prim_color.b;        break;
+        case 4:        *input_r = &rdp_state->shade_color.r;        *input_g = &rdp_state->shade_color.g;        *input_b = &rdp_state->shade_color.b;        break;
+        case 5:        *input_r = &rdp_state->env_color.r;        *input_g = &rdp_state->env_color.g;        *input_b = &rdp_state->env_color.b;        break;
+        case 6:        *input_r = &rdp_state->key_scale.r;        *input_g = &rdp_state->key_scale.g;        *input_b = &rdp_state->key_scale.b;        break;
+        case 7:        *input_r = &rdp_state->combined_color.a;    *input_g = &rdp_state->combined_color.a;    *input_b = &rdp_state->combined_color.a;    break;
+        case 8:        *input_r = &rdp_state->texel0_color.a;        *input_g = &rdp_state->texel0_color.a;        *input_b = &rdp_state->texel0_color.a;        break;
+        case 9:        *input_r = &rdp_state->texel1_color.a;        *input_g = &rdp_state->texel1_color.a;        *input_b = &rdp_state->texel1_color.a;        break;
+        case 10:    *input_r = &rdp_state->prim_color.a;        *input_g = &rdp_state->prim_color.a;        *input_b = &rdp_state->prim_color.a;        break;
+        case 11:    *input_r = &rdp_state->shade_color.a;        *input_g = &rdp_state->shade_color.a;        *input_b = &rdp_state->shade_color.a;        break;
+        case 12:    *input_r = &rdp_state->env_color.a;        *input_g = &rdp_state->env_color.a;        *input_b = &rdp_state->env_color.a;        break;
+        case 13:    *input_r = &rdp_state->lod_frac;            *input_g = &rdp_state->lod_frac;            *input_b = &rdp_state->lod_frac;            break;
+        case 14:    *input_r = &rdp_state->primitive_lod_frac;    *input_g = &rdp_state->primitive_lod_frac;    *input_b = &rdp_state->primitive_lod_frac; break;
+        case 15:    *input_r = &rdp_state->k5;                    *input_g = &rdp_state->k5;                    *input_b = &rdp_state->k5;                    break;
         case 16: case 17: case 18: case 19: case 20: case 21: case 22: case 23:
         case 24: case 25: case 26: case 27: case 28: case 29: case 30: case 31:
         {
@@ -756,12 +670,12 @@ INLINE void SET_ADD_RGB_INPUT(INT32 **input_r, INT32 **input_g, INT32 **input_b,
 {
     switch (code & 0x7)
     {
-        case 0:        *input_r = &combined_color.r;    *input_g = &combined_color.g;    *input_b = &combined_color.b;    break;
-        case 1:        *input_r = &texel0_color.r;        *input_g = &texel0_color.g;        *input_b = &texel0_color.b;        break;
-        case 2:        *input_r = &texel1_color.r;        *input_g = &texel1_color.g;        *input_b = &texel1_color.b;        break;
-        case 3:        *input_r = &prim_color.r;        *input_g = &prim_color.g;        *input_b = &prim_color.b;        break;
-        case 4:        *input_r = &shade_color.r;        *input_g = &shade_color.g;        *input_b = &shade_color.b;        break;
-        case 5:        *input_r = &env_color.r;        *input_g = &env_color.g;        *input_b = &env_color.b;        break;
+        case 0:        *input_r = &rdp_state->combined_color.r;    *input_g = &rdp_state->combined_color.g;    *input_b = &rdp_state->combined_color.b;    break;
+        case 1:        *input_r = &rdp_state->texel0_color.r;        *input_g = &rdp_state->texel0_color.g;        *input_b = &rdp_state->texel0_color.b;        break;
+        case 2:        *input_r = &rdp_state->texel1_color.r;        *input_g = &rdp_state->texel1_color.g;        *input_b = &rdp_state->texel1_color.b;        break;
+        case 3:        *input_r = &rdp_state->prim_color.r;        *input_g = &rdp_state->prim_color.g;        *input_b = &rdp_state->prim_color.b;        break;
+        case 4:        *input_r = &rdp_state->shade_color.r;        *input_g = &rdp_state->shade_color.g;        *input_b = &rdp_state->shade_color.b;        break;
+        case 5:        *input_r = &rdp_state->env_color.r;        *input_g = &rdp_state->env_color.g;        *input_b = &rdp_state->env_color.b;        break;
         case 6:        *input_r = &one_color;            *input_g = &one_color;            *input_b = &one_color;            break;
         case 7:        *input_r = &zero_color;            *input_g = &zero_color;            *input_b = &zero_color;            break;
     }
@@ -771,12 +685,12 @@ INLINE void SET_SUB_ALPHA_INPUT(INT32 **input, int code)
 {
     switch (code & 0x7)
     {
-        case 0:        *input = &combined_color.a; break;
-        case 1:        *input = &texel0_color.a; break;
-        case 2:        *input = &texel1_color.a; break;
-        case 3:        *input = &prim_color.a; break;
-        case 4:        *input = &shade_color.a; break;
-        case 5:        *input = &env_color.a; break;
+        case 0:        *input = &rdp_state->combined_color.a; break;
+        case 1:        *input = &rdp_state->texel0_color.a; break;
+        case 2:        *input = &rdp_state->texel1_color.a; break;
+        case 3:        *input = &rdp_state->prim_color.a; break;
+        case 4:        *input = &rdp_state->shade_color.a; break;
+        case 5:        *input = &rdp_state->env_color.a; break;
         case 6:        *input = &one_color; break;
         case 7:        *input = &zero_color; break;
     }
@@ -786,13 +700,13 @@ INLINE void SET_MUL_ALPHA_INPUT(INT32 **input, int code)
 {
     switch (code & 0x7)
     {
-        case 0:        *input = &lod_frac; break;
-        case 1:        *input = &texel0_color.a; break;
-        case 2:        *input = &texel1_color.a; break;
-        case 3:        *input = &prim_color.a; break;
-        case 4:        *input = &shade_color.a; break;
-        case 5:        *input = &env_color.a; break;
-        case 6:        *input = &primitive_lod_frac; break;
+        case 0:        *input = &rdp_state->lod_frac; break;
+        case 1:        *input = &rdp_state->texel0_color.a; break;
+        case 2:        *input = &rdp_state->texel1_color.a; break;
+        case 3:        *input = &rdp_state->prim_color.a; break;
+        case 4:        *input = &rdp_state->shade_color.a; break;
+        case 5:        *input = &rdp_state->env_color.a; break;
+        case 6:        *input = &rdp_state->primitive_lod_frac; break;
         case 7:        *input = &zero_color; break;
     }
 }
@@ -805,111 +719,111 @@ static void combiner_1cycle(int adseed, UINT32* curpixel_cvg)
     
 
     
-    combined_color.r = color_combiner_equation(*combiner_rgbsub_a_r[1],*combiner_rgbsub_b_r[1],*combiner_rgbmul_r[1],*combiner_rgbadd_r[1]);
-    combined_color.g = color_combiner_equation(*combiner_rgbsub_a_g[1],*combiner_rgbsub_b_g[1],*combiner_rgbmul_g[1],*combiner_rgbadd_g[1]);
-    combined_color.b = color_combiner_equation(*combiner_rgbsub_a_b[1],*combiner_rgbsub_b_b[1],*combiner_rgbmul_b[1],*combiner_rgbadd_b[1]);
-    combined_color.a = alpha_combiner_equation(*combiner_alphasub_a[1],*combiner_alphasub_b[1],*combiner_alphamul[1],*combiner_alphaadd[1]);
+    rdp_state->combined_color.r = color_combiner_equation(*rdp_state->combiner_rgbsub_a_r[1],*rdp_state->combiner_rgbsub_b_r[1],*rdp_state->combiner_rgbmul_r[1],*rdp_state->combiner_rgbadd_r[1]);
+    rdp_state->combined_color.g = color_combiner_equation(*rdp_state->combiner_rgbsub_a_g[1],*rdp_state->combiner_rgbsub_b_g[1],*rdp_state->combiner_rgbmul_g[1],*rdp_state->combiner_rgbadd_g[1]);
+    rdp_state->combined_color.b = color_combiner_equation(*rdp_state->combiner_rgbsub_a_b[1],*rdp_state->combiner_rgbsub_b_b[1],*rdp_state->combiner_rgbmul_b[1],*rdp_state->combiner_rgbadd_b[1]);
+    rdp_state->combined_color.a = alpha_combiner_equation(*rdp_state->combiner_alphasub_a[1],*rdp_state->combiner_alphasub_b[1],*rdp_state->combiner_alphamul[1],*rdp_state->combiner_alphaadd[1]);
 
-    pixel_color.a = special_9bit_clamptable[combined_color.a];
-    if (pixel_color.a == 0xff)
-        pixel_color.a = 0x100;
+    rdp_state->pixel_color.a = special_9bit_clamptable[rdp_state->combined_color.a];
+    if (rdp_state->pixel_color.a == 0xff)
+        rdp_state->pixel_color.a = 0x100;
 
-    if (!other_modes.key_en)
+    if (!rdp_state->other_modes.key_en)
     {
         
-        combined_color.r >>= 8;
-        combined_color.g >>= 8;
-        combined_color.b >>= 8;
-        pixel_color.r = special_9bit_clamptable[combined_color.r];
-        pixel_color.g = special_9bit_clamptable[combined_color.g];
-        pixel_color.b = special_9bit_clamptable[combined_color.b];
+        rdp_state->combined_color.r >>= 8;
+        rdp_state->combined_color.g >>= 8;
+        rdp_state->combined_color.b >>= 8;
+        rdp_state->pixel_color.r = special_9bit_clamptable[rdp_state->combined_color.r];
+        rdp_state->pixel_color.g = special_9bit_clamptable[rdp_state->combined_color.g];
+        rdp_state->pixel_color.b = special_9bit_clamptable[rdp_state->combined_color.b];
     }
     else
     {
-        redkey = combined_color.r;
+        redkey = rdp_state->combined_color.r;
         if (redkey >= 0)
-            redkey = (key_width.r << 4) - redkey;
+            redkey = (rdp_state->key_width.r << 4) - redkey;
         else
-            redkey = (key_width.r << 4) + redkey;
-        greenkey = combined_color.g;
+            redkey = (rdp_state->key_width.r << 4) + redkey;
+        greenkey = rdp_state->combined_color.g;
         if (greenkey >= 0)
-            greenkey = (key_width.g << 4) - greenkey;
+            greenkey = (rdp_state->key_width.g << 4) - greenkey;
         else
-            greenkey = (key_width.g << 4) + greenkey;
-        bluekey = combined_color.b;
+            greenkey = (rdp_state->key_width.g << 4) + greenkey;
+        bluekey = rdp_state->combined_color.b;
         if (bluekey >= 0)
-            bluekey = (key_width.b << 4) - bluekey;
+            bluekey = (rdp_state->key_width.b << 4) - bluekey;
         else
-            bluekey = (key_width.b << 4) + bluekey;
-        keyalpha = (redkey < greenkey) ? redkey : greenkey;
-        keyalpha = (bluekey < keyalpha) ? bluekey : keyalpha;
-        keyalpha = CLIP(keyalpha, 0, 0xff);
+            bluekey = (rdp_state->key_width.b << 4) + bluekey;
+        rdp_state->keyalpha = (redkey < greenkey) ? redkey : greenkey;
+        rdp_state->keyalpha = (bluekey < rdp_state->keyalpha) ? bluekey : rdp_state->keyalpha;
+        rdp_state->keyalpha = CLIP(rdp_state->keyalpha, 0, 0xff);
 
         
-        pixel_color.r = special_9bit_clamptable[*combiner_rgbsub_a_r[1]];
-        pixel_color.g = special_9bit_clamptable[*combiner_rgbsub_a_g[1]];
-        pixel_color.b = special_9bit_clamptable[*combiner_rgbsub_a_b[1]];
+        rdp_state->pixel_color.r = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_r[1]];
+        rdp_state->pixel_color.g = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_g[1]];
+        rdp_state->pixel_color.b = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_b[1]];
 
         
-        combined_color.r >>= 8;
-        combined_color.g >>= 8;
-        combined_color.b >>= 8;
+        rdp_state->combined_color.r >>= 8;
+        rdp_state->combined_color.g >>= 8;
+        rdp_state->combined_color.b >>= 8;
     }
     
     
-    if (other_modes.cvg_times_alpha)
+    if (rdp_state->other_modes.cvg_times_alpha)
     {
-        temp = (pixel_color.a * (*curpixel_cvg) + 4) >> 3;
+        temp = (rdp_state->pixel_color.a * (*curpixel_cvg) + 4) >> 3;
         *curpixel_cvg = (temp >> 5) & 0xf;
     }
 
-    if (!other_modes.alpha_cvg_select)
+    if (!rdp_state->other_modes.alpha_cvg_select)
     {    
-        if (!other_modes.key_en)
+        if (!rdp_state->other_modes.key_en)
         {
-            pixel_color.a += adseed;
-            if (pixel_color.a & 0x100)
-                pixel_color.a = 0xff;
+            rdp_state->pixel_color.a += adseed;
+            if (rdp_state->pixel_color.a & 0x100)
+                rdp_state->pixel_color.a = 0xff;
         }
         else
-            pixel_color.a = keyalpha;
+            rdp_state->pixel_color.a = rdp_state->keyalpha;
     }
     else
     {
-        if (other_modes.cvg_times_alpha)
-            pixel_color.a = temp;
+        if (rdp_state->other_modes.cvg_times_alpha)
+            rdp_state->pixel_color.a = temp;
         else
-            pixel_color.a = (*curpixel_cvg) << 5;
-        if (pixel_color.a > 0xff)
-            pixel_color.a = 0xff;
+            rdp_state->pixel_color.a = (*curpixel_cvg) << 5;
+        if (rdp_state->pixel_color.a > 0xff)
+            rdp_state->pixel_color.a = 0xff;
     }
     
 
-    shade_color.a += adseed;
-    if (shade_color.a & 0x100)
-        shade_color.a = 0xff;
+    rdp_state->shade_color.a += adseed;
+    if (rdp_state->shade_color.a & 0x100)
+        rdp_state->shade_color.a = 0xff;
 }
 
 static void combiner_2cycle(int adseed, UINT32* curpixel_cvg)
 {
     INT32 redkey, greenkey, bluekey, temp;
 
-    combined_color.r = color_combiner_equation(*combiner_rgbsub_a_r[0],*combiner_rgbsub_b_r[0],*combiner_rgbmul_r[0],*combiner_rgbadd_r[0]);
-    combined_color.g = color_combiner_equation(*combiner_rgbsub_a_g[0],*combiner_rgbsub_b_g[0],*combiner_rgbmul_g[0],*combiner_rgbadd_g[0]);
-    combined_color.b = color_combiner_equation(*combiner_rgbsub_a_b[0],*combiner_rgbsub_b_b[0],*combiner_rgbmul_b[0],*combiner_rgbadd_b[0]);
-    combined_color.a = alpha_combiner_equation(*combiner_alphasub_a[0],*combiner_alphasub_b[0],*combiner_alphamul[0],*combiner_alphaadd[0]);
+    rdp_state->combined_color.r = color_combiner_equation(*rdp_state->combiner_rgbsub_a_r[0],*rdp_state->combiner_rgbsub_b_r[0],*rdp_state->combiner_rgbmul_r[0],*rdp_state->combiner_rgbadd_r[0]);
+    rdp_state->combined_color.g = color_combiner_equation(*rdp_state->combiner_rgbsub_a_g[0],*rdp_state->combiner_rgbsub_b_g[0],*rdp_state->combiner_rgbmul_g[0],*rdp_state->combiner_rgbadd_g[0]);
+    rdp_state->combined_color.b = color_combiner_equation(*rdp_state->combiner_rgbsub_a_b[0],*rdp_state->combiner_rgbsub_b_b[0],*rdp_state->combiner_rgbmul_b[0],*rdp_state->combiner_rgbadd_b[0]);
+    rdp_state->combined_color.a = alpha_combiner_equation(*rdp_state->combiner_alphasub_a[0],*rdp_state->combiner_alphasub_b[0],*rdp_state->combiner_alphamul[0],*rdp_state->combiner_alphaadd[0]);
 
     
     
 
     
-    combined_color.r >>= 8;
-    combined_color.g >>= 8;
-    combined_color.b >>= 8;
+    rdp_state->combined_color.r >>= 8;
+    rdp_state->combined_color.g >>= 8;
+    rdp_state->combined_color.b >>= 8;
 
     
-    texel0_color = texel1_color;
-    texel1_color = nexttexel_color;
+    rdp_state->texel0_color = rdp_state->texel1_color;
+    rdp_state->texel1_color = rdp_state->nexttexel_color;
 
     
     
@@ -919,90 +833,90 @@ static void combiner_2cycle(int adseed, UINT32* curpixel_cvg)
     
     
 
-    combined_color.r = color_combiner_equation(*combiner_rgbsub_a_r[1],*combiner_rgbsub_b_r[1],*combiner_rgbmul_r[1],*combiner_rgbadd_r[1]);
-    combined_color.g = color_combiner_equation(*combiner_rgbsub_a_g[1],*combiner_rgbsub_b_g[1],*combiner_rgbmul_g[1],*combiner_rgbadd_g[1]);
-    combined_color.b = color_combiner_equation(*combiner_rgbsub_a_b[1],*combiner_rgbsub_b_b[1],*combiner_rgbmul_b[1],*combiner_rgbadd_b[1]);
-    combined_color.a = alpha_combiner_equation(*combiner_alphasub_a[1],*combiner_alphasub_b[1],*combiner_alphamul[1],*combiner_alphaadd[1]);
+    rdp_state->combined_color.r = color_combiner_equation(*rdp_state->combiner_rgbsub_a_r[1],*rdp_state->combiner_rgbsub_b_r[1],*rdp_state->combiner_rgbmul_r[1],*rdp_state->combiner_rgbadd_r[1]);
+    rdp_state->combined_color.g = color_combiner_equation(*rdp_state->combiner_rgbsub_a_g[1],*rdp_state->combiner_rgbsub_b_g[1],*rdp_state->combiner_rgbmul_g[1],*rdp_state->combiner_rgbadd_g[1]);
+    rdp_state->combined_color.b = color_combiner_equation(*rdp_state->combiner_rgbsub_a_b[1],*rdp_state->combiner_rgbsub_b_b[1],*rdp_state->combiner_rgbmul_b[1],*rdp_state->combiner_rgbadd_b[1]);
+    rdp_state->combined_color.a = alpha_combiner_equation(*rdp_state->combiner_alphasub_a[1],*rdp_state->combiner_alphasub_b[1],*rdp_state->combiner_alphamul[1],*rdp_state->combiner_alphaadd[1]);
 
-    if (!other_modes.key_en)
+    if (!rdp_state->other_modes.key_en)
     {
         
-        combined_color.r >>= 8;
-        combined_color.g >>= 8;
-        combined_color.b >>= 8;
+        rdp_state->combined_color.r >>= 8;
+        rdp_state->combined_color.g >>= 8;
+        rdp_state->combined_color.b >>= 8;
 
-        pixel_color.r = special_9bit_clamptable[combined_color.r];
-        pixel_color.g = special_9bit_clamptable[combined_color.g];
-        pixel_color.b = special_9bit_clamptable[combined_color.b];
+        rdp_state->pixel_color.r = special_9bit_clamptable[rdp_state->combined_color.r];
+        rdp_state->pixel_color.g = special_9bit_clamptable[rdp_state->combined_color.g];
+        rdp_state->pixel_color.b = special_9bit_clamptable[rdp_state->combined_color.b];
     }
     else
     {
-        redkey = combined_color.r;
+        redkey = rdp_state->combined_color.r;
         if (redkey >= 0)
-            redkey = (key_width.r << 4) - redkey;
+            redkey = (rdp_state->key_width.r << 4) - redkey;
         else
-            redkey = (key_width.r << 4) + redkey;
-        greenkey = combined_color.g;
+            redkey = (rdp_state->key_width.r << 4) + redkey;
+        greenkey = rdp_state->combined_color.g;
         if (greenkey >= 0)
-            greenkey = (key_width.g << 4) - greenkey;
+            greenkey = (rdp_state->key_width.g << 4) - greenkey;
         else
-            greenkey = (key_width.g << 4) + greenkey;
-        bluekey = combined_color.b;
+            greenkey = (rdp_state->key_width.g << 4) + greenkey;
+        bluekey = rdp_state->combined_color.b;
         if (bluekey >= 0)
-            bluekey = (key_width.b << 4) - bluekey;
+            bluekey = (rdp_state->key_width.b << 4) - bluekey;
         else
-            bluekey = (key_width.b << 4) + bluekey;
-        keyalpha = (redkey < greenkey) ? redkey : greenkey;
-        keyalpha = (bluekey < keyalpha) ? bluekey : keyalpha;
-        keyalpha = CLIP(keyalpha, 0, 0xff);
+            bluekey = (rdp_state->key_width.b << 4) + bluekey;
+        rdp_state->keyalpha = (redkey < greenkey) ? redkey : greenkey;
+        rdp_state->keyalpha = (bluekey < rdp_state->keyalpha) ? bluekey : rdp_state->keyalpha;
+        rdp_state->keyalpha = CLIP(rdp_state->keyalpha, 0, 0xff);
 
         
-        pixel_color.r = special_9bit_clamptable[*combiner_rgbsub_a_r[1]];
-        pixel_color.g = special_9bit_clamptable[*combiner_rgbsub_a_g[1]];
-        pixel_color.b = special_9bit_clamptable[*combiner_rgbsub_a_b[1]];
+        rdp_state->pixel_color.r = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_r[1]];
+        rdp_state->pixel_color.g = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_g[1]];
+        rdp_state->pixel_color.b = special_9bit_clamptable[*rdp_state->combiner_rgbsub_a_b[1]];
 
         
-        combined_color.r >>= 8;
-        combined_color.g >>= 8;
-        combined_color.b >>= 8;
+        rdp_state->combined_color.r >>= 8;
+        rdp_state->combined_color.g >>= 8;
+        rdp_state->combined_color.b >>= 8;
     }
     
-    pixel_color.a = special_9bit_clamptable[combined_color.a];
-    if (pixel_color.a == 0xff)
-        pixel_color.a = 0x100;
+    rdp_state->pixel_color.a = special_9bit_clamptable[rdp_state->combined_color.a];
+    if (rdp_state->pixel_color.a == 0xff)
+        rdp_state->pixel_color.a = 0x100;
 
     
-    if (other_modes.cvg_times_alpha)
+    if (rdp_state->other_modes.cvg_times_alpha)
     {
-        temp = (pixel_color.a * (*curpixel_cvg) + 4) >> 3;
+        temp = (rdp_state->pixel_color.a * (*curpixel_cvg) + 4) >> 3;
         *curpixel_cvg = (temp >> 5) & 0xf;
     }
 
-    if (!other_modes.alpha_cvg_select)
+    if (!rdp_state->other_modes.alpha_cvg_select)
     {
-        if (!other_modes.key_en)
+        if (!rdp_state->other_modes.key_en)
         {
-            pixel_color.a += adseed;
-            if (pixel_color.a & 0x100)
-                pixel_color.a = 0xff;
+            rdp_state->pixel_color.a += adseed;
+            if (rdp_state->pixel_color.a & 0x100)
+                rdp_state->pixel_color.a = 0xff;
         }
         else
-            pixel_color.a = keyalpha;
+            rdp_state->pixel_color.a = rdp_state->keyalpha;
     }
     else
     {
-        if (other_modes.cvg_times_alpha)
-            pixel_color.a = temp;
+        if (rdp_state->other_modes.cvg_times_alpha)
+            rdp_state->pixel_color.a = temp;
         else
-            pixel_color.a = (*curpixel_cvg) << 5;
-        if (pixel_color.a > 0xff)
-            pixel_color.a = 0xff;
+            rdp_state->pixel_color.a = (*curpixel_cvg) << 5;
+        if (rdp_state->pixel_color.a > 0xff)
+            rdp_state->pixel_color.a = 0xff;
     }
     
 
-    shade_color.a += adseed;
-    if (shade_color.a & 0x100)
-        shade_color.a = 0xff;
+    rdp_state->shade_color.a += adseed;
+    if (rdp_state->shade_color.a & 0x100)
+        rdp_state->shade_color.a = 0xff;
 }
 
 static void precalculate_everything(void)
@@ -1145,36 +1059,36 @@ INLINE void SET_BLENDER_INPUT(int cycle, int which, INT32 **input_r, INT32 **inp
         {
             if (cycle == 0)
             {
-                *input_r = &pixel_color.r;
-                *input_g = &pixel_color.g;
-                *input_b = &pixel_color.b;
+                *input_r = &rdp_state->pixel_color.r;
+                *input_g = &rdp_state->pixel_color.g;
+                *input_b = &rdp_state->pixel_color.b;
             }
             else
             {
-                *input_r = &blended_pixel_color.r;
-                *input_g = &blended_pixel_color.g;
-                *input_b = &blended_pixel_color.b;
+                *input_r = &rdp_state->blended_pixel_color.r;
+                *input_g = &rdp_state->blended_pixel_color.g;
+                *input_b = &rdp_state->blended_pixel_color.b;
             }
             break;
         }
 
         case 1:
         {
-            *input_r = &memory_color.r;
-            *input_g = &memory_color.g;
-            *input_b = &memory_color.b;
+            *input_r = &rdp_state->memory_color.r;
+            *input_g = &rdp_state->memory_color.g;
+            *input_b = &rdp_state->memory_color.b;
             break;
         }
 
         case 2:
         {
-            *input_r = &blend_color.r;        *input_g = &blend_color.g;        *input_b = &blend_color.b;
+            *input_r = &rdp_state->blend_color.r;        *input_g = &rdp_state->blend_color.g;        *input_b = &rdp_state->blend_color.b;
             break;
         }
 
         case 3:
         {
-            *input_r = &fog_color.r;        *input_g = &fog_color.g;        *input_b = &fog_color.b;
+            *input_r = &rdp_state->fog_color.r;        *input_g = &rdp_state->fog_color.g;        *input_b = &rdp_state->fog_color.b;
             break;
         }
     }
@@ -1183,9 +1097,9 @@ INLINE void SET_BLENDER_INPUT(int cycle, int which, INT32 **input_r, INT32 **inp
     {
         switch (b & 0x3)
         {
-            case 0:        *input_a = &pixel_color.a; break;
-            case 1:        *input_a = &fog_color.a; break;
-            case 2:        *input_a = &shade_color.a; break;
+            case 0:        *input_a = &rdp_state->pixel_color.a; break;
+            case 1:        *input_a = &rdp_state->fog_color.a; break;
+            case 2:        *input_a = &rdp_state->shade_color.a; break;
             case 3:        *input_a = &zero_color; break;
         }
     }
@@ -1193,8 +1107,8 @@ INLINE void SET_BLENDER_INPUT(int cycle, int which, INT32 **input_r, INT32 **inp
     {
         switch (b & 0x3)
         {
-            case 0:        *input_a = &inv_pixel_color.a; break;
-            case 1:        *input_a = &memory_color.a; break;
+            case 0:        *input_a = &rdp_state->inv_pixel_color.a; break;
+            case 1:        *input_a = &rdp_state->memory_color.a; break;
             case 2:        *input_a = &blenderone; break;
             case 3:        *input_a = &zero_color; break;
         }
@@ -1219,7 +1133,7 @@ static int blender_1cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 b
     int r, g, b, dontblend;
     
     
-    if (alpha_compare(pixel_color.a))
+    if (alpha_compare(rdp_state->pixel_color.a))
     {
 
         
@@ -1227,21 +1141,21 @@ static int blender_1cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 b
         
         
         
-        if (other_modes.antialias_en ? (curpixel_cvg) : (curpixel_cvbit))
+        if (rdp_state->other_modes.antialias_en ? (curpixel_cvg) : (curpixel_cvbit))
         {
 
-            if (!other_modes.color_on_cvg || prewrap)
+            if (!rdp_state->other_modes.color_on_cvg || prewrap)
             {
-                dontblend = (other_modes.f.partialreject_1cycle && pixel_color.a >= 0xff);
+                dontblend = (rdp_state->other_modes.f.partialreject_1cycle && rdp_state->pixel_color.a >= 0xff);
                 if (!blend_en || dontblend)
                 {
-                    r = *blender1a_r[0];
-                    g = *blender1a_g[0];
-                    b = *blender1a_b[0];
+                    r = *rdp_state->blender1a_r[0];
+                    g = *rdp_state->blender1a_g[0];
+                    b = *rdp_state->blender1a_b[0];
                 }
                 else
                 {
-                    inv_pixel_color.a =  (~(*blender1b_a[0])) & 0xff;
+                    rdp_state->inv_pixel_color.a =  (~(*rdp_state->blender1b_a[0])) & 0xff;
                     
                     
                     
@@ -1252,12 +1166,12 @@ static int blender_1cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 b
             }
             else
             {
-                r = *blender2a_r[0];
-                g = *blender2a_g[0];
-                b = *blender2a_b[0];
+                r = *rdp_state->blender2a_r[0];
+                g = *rdp_state->blender2a_g[0];
+                b = *rdp_state->blender2a_b[0];
             }
 
-            rgb_dither_ptr(&r, &g, &b, dith);
+            rdp_state->rgb_dither_ptr(&r, &g, &b, dith);
             *fr = r;
             *fg = g;
             *fb = b;
@@ -1275,47 +1189,47 @@ int blender_2cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 blend_en
     int r, g, b, dontblend;
 
     
-    if (alpha_compare(pixel_color.a))
+    if (alpha_compare(rdp_state->pixel_color.a))
     {
-        if (other_modes.antialias_en ? (curpixel_cvg) : (curpixel_cvbit))
+        if (rdp_state->other_modes.antialias_en ? (curpixel_cvg) : (curpixel_cvbit))
         {
             
-            inv_pixel_color.a =  (~(*blender1b_a[0])) & 0xff;
+            rdp_state->inv_pixel_color.a =  (~(*rdp_state->blender1b_a[0])) & 0xff;
 
             blender_equation_cycle0_2(&r, &g, &b);
 
             
-            memory_color = pre_memory_color;
+            rdp_state->memory_color = rdp_state->pre_memory_color;
 
-            blended_pixel_color.r = r;
-            blended_pixel_color.g = g;
-            blended_pixel_color.b = b;
-            blended_pixel_color.a = pixel_color.a;
+            rdp_state->blended_pixel_color.r = r;
+            rdp_state->blended_pixel_color.g = g;
+            rdp_state->blended_pixel_color.b = b;
+            rdp_state->blended_pixel_color.a = rdp_state->pixel_color.a;
 
-            if (!other_modes.color_on_cvg || prewrap)
+            if (!rdp_state->other_modes.color_on_cvg || prewrap)
             {
-                dontblend = (other_modes.f.partialreject_2cycle && pixel_color.a >= 0xff);
+                dontblend = (rdp_state->other_modes.f.partialreject_2cycle && rdp_state->pixel_color.a >= 0xff);
                 if (!blend_en || dontblend)
                 {
-                    r = *blender1a_r[1];
-                    g = *blender1a_g[1];
-                    b = *blender1a_b[1];
+                    r = *rdp_state->blender1a_r[1];
+                    g = *rdp_state->blender1a_g[1];
+                    b = *rdp_state->blender1a_b[1];
                 }
                 else
                 {
-                    inv_pixel_color.a =  (~(*blender1b_a[1])) & 0xff;
+                    rdp_state->inv_pixel_color.a =  (~(*rdp_state->blender1b_a[1])) & 0xff;
                     blender_equation_cycle1(&r, &g, &b);
                 }
             }
             else
             {
-                r = *blender2a_r[1];
-                g = *blender2a_g[1];
-                b = *blender2a_b[1];
+                r = *rdp_state->blender2a_r[1];
+                g = *rdp_state->blender2a_g[1];
+                b = *rdp_state->blender2a_b[1];
             }
 
             
-            rgb_dither_ptr(&r, &g, &b, dith);
+            rdp_state->rgb_dither_ptr(&r, &g, &b, dith);
             *fr = r;
             *fg = g;
             *fb = b;
@@ -1330,10 +1244,10 @@ int blender_2cycle(UINT32* fr, UINT32* fg, UINT32* fb, int dith, UINT32 blend_en
 
 static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 {
-    UINT32 tbase = tile[tilenum].line * t + tile[tilenum].tmem;
+    UINT32 tbase = rdp_state->tile[tilenum].line * t + rdp_state->tile[tilenum].tmem;
     
 
-    UINT32 tpal    = tile[tilenum].palette;
+    UINT32 tpal    = rdp_state->tile[tilenum].palette;
 
     
     
@@ -1342,14 +1256,14 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
     
     
     
-    UINT16 *tc16 = (UINT16*)__TMEM;
+    UINT16 *tc16 = (UINT16*)rdp_state->__TMEM;
     UINT32 taddr = 0;
 
     
 
     
 
-    switch (tile[tilenum].f.notlutswitch)
+    switch (rdp_state->tile[tilenum].f.notlutswitch)
     {
     case TEXEL_RGBA4:
         {
@@ -1357,7 +1271,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
             taddr = ((tbase << 4) + s) >> 1;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
 
-            byteval = __TMEM[taddr & 0xfff];
+            byteval = rdp_state->__TMEM[taddr & 0xfff];
             c = ((s & 1)) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color->r = c;
@@ -1373,7 +1287,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
 
-            p = __TMEM[taddr & 0xfff];
+            p = rdp_state->__TMEM[taddr & 0xfff];
             color->r = p;
             color->g = p;
             color->b = p;
@@ -1448,7 +1362,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
             taddr &= 0x7ff;
             taddrlow &= 0x3ff;
             c = tc16[taddrlow];
-            y = __TMEM[taddr | 0x800];
+            y = rdp_state->__TMEM[taddr | 0x800];
             u = c >> 8;
             v = c & 0xff;
 
@@ -1470,7 +1384,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
             taddr = ((tbase << 4) + s) >> 1;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
 
-            p = __TMEM[taddr & 0xfff];
+            p = rdp_state->__TMEM[taddr & 0xfff];
             p = (s & 1) ? (p & 0xf) : (p >> 4);
             p = (tpal << 4) | p;
             color->r = color->g = color->b = color->a = p;
@@ -1483,7 +1397,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
 
-            p = __TMEM[taddr & 0xfff];
+            p = rdp_state->__TMEM[taddr & 0xfff];
             color->r = p;
             color->g = p;
             color->b = p;
@@ -1523,7 +1437,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 
             taddr = ((tbase << 4) + s) >> 1;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            p = __TMEM[taddr & 0xfff];
+            p = rdp_state->__TMEM[taddr & 0xfff];
             p = (s & 1) ? (p & 0xf) : (p >> 4);
             i = p & 0xe;
             i = (i << 4) | (i << 1) | (i >> 2);
@@ -1539,7 +1453,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            p = __TMEM[taddr & 0xfff];
+            p = rdp_state->__TMEM[taddr & 0xfff];
             i = p & 0xf0;
             i |= (i >> 4);
             color->r = i;
@@ -1578,7 +1492,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 
             taddr = ((tbase << 4) + s) >> 1;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            byteval = __TMEM[taddr & 0xfff];
+            byteval = rdp_state->__TMEM[taddr & 0xfff];
             c = (s & 1) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color->r = c;
@@ -1593,7 +1507,7 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0xfff];
+            c = rdp_state->__TMEM[taddr & 0xfff];
             color->r = c;
             color->g = c;
             color->b = c;
@@ -1631,15 +1545,15 @@ static void fetch_texel(COLOR *color, int s, int t, UINT32 tilenum)
 
 static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
 {
-    UINT32 tbase = tile[tilenum].line * t + tile[tilenum].tmem;
-    UINT32 tpal    = tile[tilenum].palette << 4;
-    UINT16 *tc16 = (UINT16*)__TMEM;
+    UINT32 tbase = rdp_state->tile[tilenum].line * t + rdp_state->tile[tilenum].tmem;
+    UINT32 tpal    = rdp_state->tile[tilenum].palette << 4;
+    UINT16 *tc16 = (UINT16*)rdp_state->__TMEM;
     UINT32 taddr = 0;
     UINT32 c;
 
     
     
-    switch(tile[tilenum].f.tlutswitch)
+    switch(rdp_state->tile[tilenum].f.tlutswitch)
     {
     case 0:
     case 1:
@@ -1647,7 +1561,7 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
         {
             taddr = ((tbase << 4) + s) >> 1;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0x7ff];
+            c = rdp_state->__TMEM[taddr & 0x7ff];
             c = (s & 1) ? (c & 0xf) : (c >> 4);
             c = tlut[((tpal | c) << 2) ^ WORD_ADDR_XOR];
         }
@@ -1656,7 +1570,7 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
         {
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0x7ff];
+            c = rdp_state->__TMEM[taddr & 0x7ff];
             c = (s & 1) ? (c & 0xf) : (c >> 4);
             c = tlut[((tpal | c) << 2) ^ WORD_ADDR_XOR];
         }
@@ -1668,7 +1582,7 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
         {
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0x7ff];
+            c = rdp_state->__TMEM[taddr & 0x7ff];
             c = tlut[(c << 2) ^ WORD_ADDR_XOR];
         }
         break;
@@ -1687,7 +1601,7 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
         {
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0x7ff];
+            c = rdp_state->__TMEM[taddr & 0x7ff];
             c = tlut[(c << 2) ^ WORD_ADDR_XOR];
         }
         break;
@@ -1705,13 +1619,13 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
         {
             taddr = (tbase << 3) + s;
             taddr ^= ((t & 1) ? BYTE_XOR_DWORD_SWAP : BYTE_ADDR_XOR);
-            c = __TMEM[taddr & 0x7ff];
+            c = rdp_state->__TMEM[taddr & 0x7ff];
             c = tlut[(c << 2) ^ WORD_ADDR_XOR];
         }
         break;
     }
 
-    if (!other_modes.tlut_type)
+    if (!rdp_state->other_modes.tlut_type)
     {
         color->r = GET_HI_RGBA16_TMEM(c);
         color->g = GET_MED_RGBA16_TMEM(c);
@@ -1731,19 +1645,19 @@ static void fetch_texel_entlut(COLOR *color, int s, int t, UINT32 tilenum)
 static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLOR *color3, int s0, int s1, int t0, int t1, UINT32 tilenum)
 {
 
-    UINT32 tbase0 = tile[tilenum].line * t0 + tile[tilenum].tmem;
-    UINT32 tbase2 = tile[tilenum].line * t1 + tile[tilenum].tmem;
-    UINT32 tpal    = tile[tilenum].palette;
+    UINT32 tbase0 = rdp_state->tile[tilenum].line * t0 + rdp_state->tile[tilenum].tmem;
+    UINT32 tbase2 = rdp_state->tile[tilenum].line * t1 + rdp_state->tile[tilenum].tmem;
+    UINT32 tpal    = rdp_state->tile[tilenum].palette;
     UINT32 xort = 0, ands = 0;
 
     
     
 
-    UINT16 *tc16 = (UINT16*)__TMEM;
+    UINT16 *tc16 = (UINT16*)rdp_state->__TMEM;
     UINT32 taddr0 = 0, taddr1 = 0, taddr2 = 0, taddr3 = 0;
     UINT32 taddrlow0 = 0, taddrlow1 = 0, taddrlow2 = 0, taddrlow3 = 0;
 
-    switch (tile[tilenum].f.notlutswitch)
+    switch (rdp_state->tile[tilenum].f.notlutswitch)
     {
     case TEXEL_RGBA4:
         {
@@ -1764,14 +1678,14 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
             ands = s0 & 1;
-            byteval = __TMEM[taddr0];
+            byteval = rdp_state->__TMEM[taddr0];
             c = (ands) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color0->r = c;
             color0->g = c;
             color0->b = c;
             color0->a = c;
-            byteval = __TMEM[taddr2];
+            byteval = rdp_state->__TMEM[taddr2];
             c = (ands) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color2->r = c;
@@ -1780,14 +1694,14 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             color2->a = c;
 
             ands = s1 & 1;
-            byteval = __TMEM[taddr1];
+            byteval = rdp_state->__TMEM[taddr1];
             c = (ands) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color1->r = c;
             color1->g = c;
             color1->b = c;
             color1->a = c;
-            byteval = __TMEM[taddr3];
+            byteval = rdp_state->__TMEM[taddr3];
             c = (ands) ? (byteval & 0xf) : (byteval >> 4);
             c |= (c << 4);
             color3->r = c;
@@ -1814,22 +1728,22 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr1 &= 0xfff;
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             color0->r = p;
             color0->g = p;
             color0->b = p;
             color0->a = p;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             color2->r = p;
             color2->g = p;
             color2->b = p;
             color2->a = p;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             color1->r = p;
             color1->g = p;
             color1->b = p;
             color1->a = p;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             color3->r = p;
             color3->g = p;
             color3->b = p;
@@ -2029,16 +1943,16 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             c2 = tc16[taddrlow2];
             c3 = tc16[taddrlow3];                    
             
-            y0 = __TMEM[taddr0 | 0x800];
+            y0 = rdp_state->__TMEM[taddr0 | 0x800];
             u0 = c0 >> 8;
             v0 = c0 & 0xff;
-            y1 = __TMEM[taddr1 | 0x800];
+            y1 = rdp_state->__TMEM[taddr1 | 0x800];
             u1 = c1 >> 8;
             v1 = c1 & 0xff;
-            y2 = __TMEM[taddr2 | 0x800];
+            y2 = rdp_state->__TMEM[taddr2 | 0x800];
             u2 = c2 >> 8;
             v2 = c2 & 0xff;
-            y3 = __TMEM[taddr3 | 0x800];
+            y3 = rdp_state->__TMEM[taddr3 | 0x800];
             u3 = c3 >> 8;
             v3 = c3 & 0xff;
 
@@ -2100,21 +2014,21 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
             ands = s0 & 1;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             p = (ands) ? (p & 0xf) : (p >> 4);
             p = (tpal << 4) | p;
             color0->r = color0->g = color0->b = color0->a = p;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             p = (ands) ? (p & 0xf) : (p >> 4);
             p = (tpal << 4) | p;
             color2->r = color2->g = color2->b = color2->a = p;
 
             ands = s1 & 1;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             p = (ands) ? (p & 0xf) : (p >> 4);
             p = (tpal << 4) | p;
             color1->r = color1->g = color1->b = color1->a = p;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             p = (ands) ? (p & 0xf) : (p >> 4);
             p = (tpal << 4) | p;
             color3->r = color3->g = color3->b = color3->a = p;
@@ -2139,22 +2053,22 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr1 &= 0xfff;
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             color0->r = p;
             color0->g = p;
             color0->b = p;
             color0->a = p;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             color2->r = p;
             color2->g = p;
             color2->b = p;
             color2->a = p;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             color1->r = p;
             color1->g = p;
             color1->b = p;
             color1->a = p;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             color3->r = p;
             color3->g = p;
             color3->b = p;
@@ -2260,7 +2174,7 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
             ands = s0 & 1;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             p = ands ? (p & 0xf) : (p >> 4);
             i = p & 0xe;
             i = (i << 4) | (i << 1) | (i >> 2);
@@ -2268,7 +2182,7 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             color0->g = i;
             color0->b = i;
             color0->a = (p & 0x1) ? 0xff : 0;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             p = ands ? (p & 0xf) : (p >> 4);
             i = p & 0xe;
             i = (i << 4) | (i << 1) | (i >> 2);
@@ -2278,7 +2192,7 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             color2->a = (p & 0x1) ? 0xff : 0;
 
             ands = s1 & 1;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             p = ands ? (p & 0xf) : (p >> 4);
             i = p & 0xe;
             i = (i << 4) | (i << 1) | (i >> 2);
@@ -2286,7 +2200,7 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             color1->g = i;
             color1->b = i;
             color1->a = (p & 0x1) ? 0xff : 0;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             p = ands ? (p & 0xf) : (p >> 4);
             i = p & 0xe;
             i = (i << 4) | (i << 1) | (i >> 2);
@@ -2315,28 +2229,28 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr1 &= 0xfff;
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             i = p & 0xf0;
             i |= (i >> 4);
             color0->r = i;
             color0->g = i;
             color0->b = i;
             color0->a = ((p & 0xf) << 4) | (p & 0xf);
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             i = p & 0xf0;
             i |= (i >> 4);
             color1->r = i;
             color1->g = i;
             color1->b = i;
             color1->a = ((p & 0xf) << 4) | (p & 0xf);
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             i = p & 0xf0;
             i |= (i >> 4);
             color2->r = i;
             color2->g = i;
             color2->b = i;
             color2->a = ((p & 0xf) << 4) | (p & 0xf);
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             i = p & 0xf0;
             i |= (i >> 4);
             color3->r = i;
@@ -2436,21 +2350,21 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
             ands = s0 & 1;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             c0 = ands ? (p & 0xf) : (p >> 4);
             c0 |= (c0 << 4);
             color0->r = color0->g = color0->b = color0->a = c0;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             c2 = ands ? (p & 0xf) : (p >> 4);
             c2 |= (c2 << 4);
             color2->r = color2->g = color2->b = color2->a = c2;
 
             ands = s1 & 1;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             c1 = ands ? (p & 0xf) : (p >> 4);
             c1 |= (c1 << 4);
             color1->r = color1->g = color1->b = color1->a = c1;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             c3 = ands ? (p & 0xf) : (p >> 4);
             c3 |= (c3 << 4);
             color3->r = color3->g = color3->b = color3->a = c3;
@@ -2475,22 +2389,22 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
             taddr1 &= 0xfff;
             taddr2 &= 0xfff;
             taddr3 &= 0xfff;
-            p = __TMEM[taddr0];
+            p = rdp_state->__TMEM[taddr0];
             color0->r = p;
             color0->g = p;
             color0->b = p;
             color0->a = p;
-            p = __TMEM[taddr1];
+            p = rdp_state->__TMEM[taddr1];
             color1->r = p;
             color1->g = p;
             color1->b = p;
             color1->a = p;
-            p = __TMEM[taddr2];
+            p = rdp_state->__TMEM[taddr2];
             color2->r = p;
             color2->g = p;
             color2->b = p;
             color2->a = p;
-            p = __TMEM[taddr3];
+            p = rdp_state->__TMEM[taddr3];
             color3->r = p;
             color3->g = p;
             color3->b = p;
@@ -2582,18 +2496,18 @@ static void fetch_texel_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLO
 
 static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color2, COLOR *color3, int s0, int s1, int t0, int t1, UINT32 tilenum)
 {
-    UINT32 tbase0 = tile[tilenum].line * t0 + tile[tilenum].tmem;
-    UINT32 tbase2 = tile[tilenum].line * t1 + tile[tilenum].tmem;
-    UINT32 tpal    = tile[tilenum].palette << 4;
+    UINT32 tbase0 = rdp_state->tile[tilenum].line * t0 + rdp_state->tile[tilenum].tmem;
+    UINT32 tbase2 = rdp_state->tile[tilenum].line * t1 + rdp_state->tile[tilenum].tmem;
+    UINT32 tpal    = rdp_state->tile[tilenum].palette << 4;
     UINT32 xort = 0, ands = 0;
 
-    UINT16 *tc16 = (UINT16*)__TMEM;
+    UINT16 *tc16 = (UINT16*)rdp_state->__TMEM;
     UINT32 taddr0 = 0, taddr1 = 0, taddr2 = 0, taddr3 = 0;
     UINT16 c0, c1, c2, c3;
 
     
     
-    switch(tile[tilenum].f.tlutswitch)
+    switch(rdp_state->tile[tilenum].f.tlutswitch)
     {
     case 0:
     case 1:
@@ -2611,18 +2525,18 @@ static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color
             taddr3 ^= xort;
                                                             
             ands = s0 & 1;
-            c0 = __TMEM[taddr0 & 0x7ff];
+            c0 = rdp_state->__TMEM[taddr0 & 0x7ff];
             c0 = (ands) ? (c0 & 0xf) : (c0 >> 4);
             c0 = tlut[((tpal | c0) << 2) ^ WORD_ADDR_XOR];
-            c2 = __TMEM[taddr2 & 0x7ff];
+            c2 = rdp_state->__TMEM[taddr2 & 0x7ff];
             c2 = (ands) ? (c2 & 0xf) : (c2 >> 4);
             c2 = tlut[((tpal | c2) << 2) ^ WORD_ADDR_XOR];
 
             ands = s1 & 1;
-            c1 = __TMEM[taddr1 & 0x7ff];
+            c1 = rdp_state->__TMEM[taddr1 & 0x7ff];
             c1 = (ands) ? (c1 & 0xf) : (c1 >> 4);
             c1 = tlut[((tpal | c1) << 2) ^ WORD_ADDR_XOR];
-            c3 = __TMEM[taddr3 & 0x7ff];
+            c3 = rdp_state->__TMEM[taddr3 & 0x7ff];
             c3 = (ands) ? (c3 & 0xf) : (c3 >> 4);
             c3 = tlut[((tpal | c3) << 2) ^ WORD_ADDR_XOR];
         }
@@ -2641,18 +2555,18 @@ static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color
             taddr3 ^= xort;
                                                             
             ands = s0 & 1;
-            c0 = __TMEM[taddr0 & 0x7ff];
+            c0 = rdp_state->__TMEM[taddr0 & 0x7ff];
             c0 = (ands) ? (c0 & 0xf) : (c0 >> 4);
             c0 = tlut[((tpal | c0) << 2) ^ WORD_ADDR_XOR];
-            c2 = __TMEM[taddr2 & 0x7ff];
+            c2 = rdp_state->__TMEM[taddr2 & 0x7ff];
             c2 = (ands) ? (c2 & 0xf) : (c2 >> 4);
             c2 = tlut[((tpal | c2) << 2) ^ WORD_ADDR_XOR];
 
             ands = s1 & 1;
-            c1 = __TMEM[taddr1 & 0x7ff];
+            c1 = rdp_state->__TMEM[taddr1 & 0x7ff];
             c1 = (ands) ? (c1 & 0xf) : (c1 >> 4);
             c1 = tlut[((tpal | c1) << 2) ^ WORD_ADDR_XOR];
-            c3 = __TMEM[taddr3 & 0x7ff];
+            c3 = rdp_state->__TMEM[taddr3 & 0x7ff];
             c3 = (ands) ? (c3 & 0xf) : (c3 >> 4);
             c3 = tlut[((tpal | c3) << 2) ^ WORD_ADDR_XOR];
         }
@@ -2673,13 +2587,13 @@ static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color
             taddr2 ^= xort;
             taddr3 ^= xort;
             
-            c0 = __TMEM[taddr0 & 0x7ff];
+            c0 = rdp_state->__TMEM[taddr0 & 0x7ff];
             c0 = tlut[(c0 << 2) ^ WORD_ADDR_XOR];
-            c2 = __TMEM[taddr2 & 0x7ff];
+            c2 = rdp_state->__TMEM[taddr2 & 0x7ff];
             c2 = tlut[(c2 << 2) ^ WORD_ADDR_XOR];
-            c1 = __TMEM[taddr1 & 0x7ff];
+            c1 = rdp_state->__TMEM[taddr1 & 0x7ff];
             c1 = tlut[(c1 << 2) ^ WORD_ADDR_XOR];
-            c3 = __TMEM[taddr3 & 0x7ff];
+            c3 = rdp_state->__TMEM[taddr3 & 0x7ff];
             c3 = tlut[(c3 << 2) ^ WORD_ADDR_XOR];
         }
         break;
@@ -2721,13 +2635,13 @@ static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color
             taddr2 ^= xort;
             taddr3 ^= xort;
             
-            c0 = __TMEM[taddr0 & 0x7ff];
+            c0 = rdp_state->__TMEM[taddr0 & 0x7ff];
             c0 = tlut[(c0 << 2) ^ WORD_ADDR_XOR];
-            c2 = __TMEM[taddr2 & 0x7ff];
+            c2 = rdp_state->__TMEM[taddr2 & 0x7ff];
             c2 = tlut[(c2 << 2) ^ WORD_ADDR_XOR];
-            c1 = __TMEM[taddr1 & 0x7ff];
+            c1 = rdp_state->__TMEM[taddr1 & 0x7ff];
             c1 = tlut[(c1 << 2) ^ WORD_ADDR_XOR];
-            c3 = __TMEM[taddr3 & 0x7ff];
+            c3 = rdp_state->__TMEM[taddr3 & 0x7ff];
             c3 = tlut[(c3 << 2) ^ WORD_ADDR_XOR];
         }
         break;
@@ -2769,19 +2683,19 @@ static void fetch_texel_entlut_quadro(COLOR *color0, COLOR *color1, COLOR *color
             taddr2 ^= xort;
             taddr3 ^= xort;
             
-            c0 = __TMEM[taddr0 & 0x7ff];
+            c0 = rdp_state->__TMEM[taddr0 & 0x7ff];
             c0 = tlut[(c0 << 2) ^ WORD_ADDR_XOR];
-            c2 = __TMEM[taddr2 & 0x7ff];
+            c2 = rdp_state->__TMEM[taddr2 & 0x7ff];
             c2 = tlut[(c2 << 2) ^ WORD_ADDR_XOR];
-            c1 = __TMEM[taddr1 & 0x7ff];
+            c1 = rdp_state->__TMEM[taddr1 & 0x7ff];
             c1 = tlut[(c1 << 2) ^ WORD_ADDR_XOR];
-            c3 = __TMEM[taddr3 & 0x7ff];
+            c3 = rdp_state->__TMEM[taddr3 & 0x7ff];
             c3 = tlut[(c3 << 2) ^ WORD_ADDR_XOR];
         }
         break;
     }
 
-    if (!other_modes.tlut_type)
+    if (!rdp_state->other_modes.tlut_type)
     {
         color0->r = GET_HI_RGBA16_TMEM(c0);
         color0->g = GET_MED_RGBA16_TMEM(c0);
@@ -2822,10 +2736,10 @@ void get_tmem_idx(int s, int t, UINT32 tilenum, UINT32* idx0, UINT32* idx1, UINT
     UINT32 sshorts;
     int tidx_a, tidx_b, tidx_c, tidx_d;
 
-    tbase  = (tile[tilenum].line * t) & 0x000001FF;
-    tbase += tile[tilenum].tmem;
-    tsize = tile[tilenum].size;
-    tformat = tile[tilenum].format;
+    tbase  = (rdp_state->tile[tilenum].line * t) & 0x000001FF;
+    tbase += rdp_state->tile[tilenum].tmem;
+    tsize = rdp_state->tile[tilenum].size;
+    tformat = rdp_state->tile[tilenum].format;
     sshorts = 0;
 
     if (tsize == PIXEL_SIZE_8BIT || tformat == FORMAT_YUV)
@@ -2872,10 +2786,10 @@ void read_tmem_copy(int s, int s1, int s2, int s3, int t, UINT32 tilenum, UINT32
     int tidx_a, tidx_blow, tidx_bhi, tidx_c, tidx_dlow, tidx_dhi;
 
     delta = 0;
-    tbase  = (tile[tilenum].line * t) & 0x000001FF;
-    tbase += tile[tilenum].tmem;
-    tsize = tile[tilenum].size;
-    tformat = tile[tilenum].format;
+    tbase  = (rdp_state->tile[tilenum].line * t) & 0x000001FF;
+    tbase += rdp_state->tile[tilenum].tmem;
+    tsize = rdp_state->tile[tilenum].size;
+    tformat = rdp_state->tile[tilenum].format;
 
     if (tsize == PIXEL_SIZE_8BIT || tformat == FORMAT_YUV)
     {
@@ -2945,7 +2859,7 @@ void read_tmem_copy(int s, int s1, int s2, int s3, int t, UINT32 tilenum, UINT32
     lowbits[4] = tidx_dlow & 0xf;
     lowbits[5] = tidx_dhi & 0xf;
 
-    tmem16 = (UINT16 *)__TMEM;
+    tmem16 = (UINT16 *)rdp_state->__TMEM;
 
     tidx_a >>= 2;
     tidx_blow >>= 2;
@@ -2971,7 +2885,7 @@ void read_tmem_copy(int s, int s1, int s2, int s3, int t, UINT32 tilenum, UINT32
     sort_tmem_shorts_lowhalf(&sortshort[2], short0, short1, short2, short3, lowbits[3] >> 2);
     sort_tmem_shorts_lowhalf(&sortshort[3], short0, short1, short2, short3, lowbits[4] >> 2);
 
-    if (other_modes.en_tlut)
+    if (rdp_state->other_modes.en_tlut)
     {
          
         compute_color_index(&short0, sortshort[0], lowbits[0] & 3, tilenum);
@@ -2998,7 +2912,7 @@ void read_tmem_copy(int s, int s1, int s2, int s3, int t, UINT32 tilenum, UINT32
     short2 = tmem16[(sortidx[6] | 0x400) ^ WORD_ADDR_XOR];
     short3 = tmem16[(sortidx[7] | 0x400) ^ WORD_ADDR_XOR];
 
-    if (other_modes.en_tlut)
+    if (rdp_state->other_modes.en_tlut)
     {
         sort_tmem_shorts_lowhalf(&sortshort[4], short0, short1, short2, short3, 0);
         sort_tmem_shorts_lowhalf(&sortshort[5], short0, short1, short2, short3, 1);
@@ -3053,10 +2967,10 @@ void sort_tmem_shorts_lowhalf(UINT32* bindshort, UINT32 short0, UINT32 short1, U
 void compute_color_index(UINT32* cidx, UINT32 readshort, UINT32 nybbleoffset, UINT32 tilenum)
 {
     UINT32 lownib, hinib;
-    if (tile[tilenum].size == PIXEL_SIZE_4BIT)
+    if (rdp_state->tile[tilenum].size == PIXEL_SIZE_4BIT)
     {
         lownib = (nybbleoffset ^ 3) << 2;
-        hinib = tile[tilenum].palette;
+        hinib = rdp_state->tile[tilenum].palette;
     }
     else
     {
@@ -3078,7 +2992,7 @@ void replicate_for_copy(UINT32* outbyte, UINT32 inshort, UINT32 nybbleoffset, UI
         lownib = hinib = (inshort >> lownib) & 0xf;
         if (tformat == FORMAT_CI)
         {
-            *outbyte = (tile[tilenum].palette << 4) | lownib;
+            *outbyte = (rdp_state->tile[tilenum].palette << 4) | lownib;
         }
         else if (tformat == FORMAT_IA)
         {
@@ -3118,15 +3032,15 @@ void fetch_qword_copy(UINT32* hidword, UINT32* lowdword, INT32 ssss, INT32 ssst,
     int largetex = 0;
 
     UINT32 tformat, tsize;
-    if (other_modes.en_tlut)
+    if (rdp_state->other_modes.en_tlut)
     {
         tsize = PIXEL_SIZE_16BIT;
-        tformat = other_modes.tlut_type ? FORMAT_IA : FORMAT_RGBA;
+        tformat = rdp_state->other_modes.tlut_type ? FORMAT_IA : FORMAT_RGBA;
     }
     else
     {
-        tsize = tile[tilenum].size;
-        tformat = tile[tilenum].format;
+        tsize = rdp_state->tile[tilenum].size;
+        tformat = rdp_state->tile[tilenum].format;
     }
 
     tc_pipeline_copy(&sss, &sss1, &sss2, &sss3, &sst, tilenum);
@@ -3134,7 +3048,7 @@ void fetch_qword_copy(UINT32* hidword, UINT32* lowdword, INT32 ssss, INT32 ssst,
     largetex = (tformat == FORMAT_YUV || (tformat == FORMAT_RGBA && tsize == PIXEL_SIZE_32BIT));
 
     
-    if (other_modes.en_tlut)
+    if (rdp_state->other_modes.en_tlut)
     {
         shorta = sortshort[4];
         shortb = sortshort[5];
@@ -3181,8 +3095,8 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
     INT32 maxs, maxt, invt0r, invt0g, invt0b, invt0a;
     INT32 sfrac, tfrac, invsf, invtf;
     int upper = 0;
-    int bilerp = cycle ? other_modes.bi_lerp1 : other_modes.bi_lerp0;
-    int convert = other_modes.convert_one && cycle;
+    int bilerp = cycle ? rdp_state->other_modes.bi_lerp1 : rdp_state->other_modes.bi_lerp0;
+    int convert = rdp_state->other_modes.convert_one && cycle;
     COLOR t0, t1, t2, t3;
     int sss1, sst1, sss2, sst2;
     INT32 newk0, newk1, newk2, newk3, invk0, invk1, invk2, invk3;
@@ -3192,10 +3106,10 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
 
     tcshift_cycle(&sss1, &sst1, &maxs, &maxt, tilenum);
 
-    sss1 = TRELATIVE(sss1, tile[tilenum].sl);
-    sst1 = TRELATIVE(sst1, tile[tilenum].tl);
+    sss1 = TRELATIVE(sss1, rdp_state->tile[tilenum].sl);
+    sst1 = TRELATIVE(sst1, rdp_state->tile[tilenum].tl);
 
-    if (other_modes.sample_type)
+    if (rdp_state->other_modes.sample_type)
     {    
         sfrac = sss1 & 0x1f;
         tfrac = sst1 & 0x1f;
@@ -3203,7 +3117,7 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
         tcclamp_cycle(&sss1, &sst1, &sfrac, &tfrac, maxs, maxt, tilenum);
         
     
-        if (tile[tilenum].format != FORMAT_YUV)
+        if (rdp_state->tile[tilenum].format != FORMAT_YUV)
             sss2 = sss1 + 1;
         else
             sss2 = sss1 + 2;
@@ -3228,12 +3142,12 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
         if (bilerp)
         {
             
-            if (!other_modes.en_tlut)
+            if (!rdp_state->other_modes.en_tlut)
                 fetch_texel_quadro(&t0, &t1, &t2, &t3, sss1, sss2, sst1, sst2, tilenum);
             else
                 fetch_texel_entlut_quadro(&t0, &t1, &t2, &t3, sss1, sss2, sst1, sst2, tilenum);
 
-            if (!other_modes.mid_texel || sfrac != 0x10 || tfrac != 0x10)
+            if (!rdp_state->other_modes.mid_texel || sfrac != 0x10 || tfrac != 0x10)
             {
                 if (!convert)
                 {
@@ -3298,15 +3212,15 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
         }
         else
         {
-            newk0 = SIGN(k0, 9);
-            newk1 = SIGN(k1, 9);
-            newk2 = SIGN(k2, 9);
-            newk3 = SIGN(k3, 9);
+            newk0 = SIGN(rdp_state->k0, 9);
+            newk1 = SIGN(rdp_state->k1, 9);
+            newk2 = SIGN(rdp_state->k2, 9);
+            newk3 = SIGN(rdp_state->k3, 9);
             invk0 = ~newk0; 
             invk1 = ~newk1; 
             invk2 = ~newk2; 
             invk3 = ~newk3;
-            if (!other_modes.en_tlut)
+            if (!rdp_state->other_modes.en_tlut)
                 fetch_texel(&t0, sss1, sst1, tilenum);
             else
                 fetch_texel_entlut(&t0, sss1, sst1, tilenum);
@@ -3339,7 +3253,7 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
         tcmask(&sss1, &sst1, tilenum);    
                                                                                                         
             
-        if (!other_modes.en_tlut)
+        if (!rdp_state->other_modes.en_tlut)
             fetch_texel(&t0, sss1, sst1, tilenum);
         else
             fetch_texel_entlut(&t0, sss1, sst1, tilenum);
@@ -3353,10 +3267,10 @@ static void texture_pipeline_cycle(COLOR* TEX, COLOR* prev, INT32 SSS, INT32 SST
         }
         else
         {
-            newk0 = SIGN(k0, 9); 
-            newk1 = SIGN(k1, 9); 
-            newk2 = SIGN(k2, 9); 
-            newk3 = SIGN(k3, 9);
+            newk0 = SIGN(rdp_state->k0, 9); 
+            newk1 = SIGN(rdp_state->k1, 9); 
+            newk2 = SIGN(rdp_state->k2, 9); 
+            newk3 = SIGN(rdp_state->k3, 9);
             invk0 = ~newk0; 
             invk1 = ~newk1; 
             invk2 = ~newk2; 
@@ -3388,8 +3302,8 @@ static void tc_pipeline_copy(INT32* sss0, INT32* sss1, INT32* sss2, INT32* sss3,
     
     
 
-    ss0 = TRELATIVE(ss0, tile[tilenum].sl);
-    st = TRELATIVE(st, tile[tilenum].tl);
+    ss0 = TRELATIVE(ss0, rdp_state->tile[tilenum].sl);
+    st = TRELATIVE(st, rdp_state->tile[tilenum].tl);
     ss0 = (ss0 >> 5);
     st = (st >> 5);
 
@@ -3413,8 +3327,8 @@ STRICTINLINE void tc_pipeline_load(INT32* sss, INT32* sst, int tilenum, int coor
     sst1 = SIGN16(sst1);
 
     
-    sss1 = TRELATIVE(sss1, tile[tilenum].sl);
-    sst1 = TRELATIVE(sst1, tile[tilenum].tl);
+    sss1 = TRELATIVE(sss1, rdp_state->tile[tilenum].sl);
+    sst1 = TRELATIVE(sst1, rdp_state->tile[tilenum].tl);
     
 
     
@@ -3433,6 +3347,39 @@ STRICTINLINE void tc_pipeline_load(INT32* sss, INT32* sst, int tilenum, int coor
     *sst = sst1;
 }
 
+/*
+ * The pixel pipeline carries some state over from the last pixel drawn, which
+ * for the first pixel of a span would be whatever scanline this thread drew
+ * before.  Restart it, and the noise generator, from values that depend only
+ * on the scanline and the primitive, so that the output is the same however
+ * many threads the scanlines are spread over, one included.
+ */
+STRICTINLINE static void reset_span_pipeline(int scanline)
+{
+    UINT32 seed;
+
+    seed  = (rdp_state->primitive_count << 10) ^ (UINT32)scanline;
+    seed ^= seed >> 16;
+    seed *= 0x7FEB352D;
+    seed ^= seed >> 15;
+    seed *= 0x846CA68B;
+    seed ^= seed >> 16;
+    rdp_state->iseed = (INT32)seed;
+
+    zerobuf(&rdp_state->combined_color, sizeof(COLOR));
+    zerobuf(&rdp_state->texel0_color, sizeof(COLOR));
+    zerobuf(&rdp_state->texel1_color, sizeof(COLOR));
+    zerobuf(&rdp_state->nexttexel_color, sizeof(COLOR));
+    zerobuf(&rdp_state->pixel_color, sizeof(COLOR));
+    zerobuf(&rdp_state->blended_pixel_color, sizeof(COLOR));
+    zerobuf(&rdp_state->memory_color, sizeof(COLOR));
+    zerobuf(&rdp_state->pre_memory_color, sizeof(COLOR));
+    rdp_state->blshifta = rdp_state->blshiftb = rdp_state->pastblshifta = rdp_state->pastblshiftb = 0;
+    rdp_state->keyalpha = 0;
+    rdp_state->lod_frac = 0;
+    rdp_state->noise = 0;
+}
+
 void render_spans_1cycle_complete(int start, int end, int tilenum, int flip)
 {
     UINT8 offx, offy;
@@ -3466,57 +3413,58 @@ void render_spans_1cycle_complete(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -3562,21 +3510,21 @@ void render_spans_1cycle_complete(int start, int end, int tilenum, int flip)
             sigs.endspan = (j == length);
             sigs.preendspan = (j == (length - 1));
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
 
             get_texel1_1cycle(&news, &newt, s, t, w, dsinc, dtinc, dwinc, i, &sigs);
 
             if (!sigs.startspan)
             {
-                texel0_color = texel1_color;
-                lod_frac = prelodfrac;
+                rdp_state->texel0_color = rdp_state->texel1_color;
+                rdp_state->lod_frac = prelodfrac;
             }
             else
             {
-                tcdiv_ptr(ss, st, sw, &sss, &sst);
+                rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
 
                 tclod_1cycle_current(&sss, &sst, news, newt, s, t, w, dsinc, dtinc, dwinc, i, prim_tile, &tile1, &sigs);
-                texture_pipeline_cycle(&texel0_color, &texel0_color, sss, sst, tile1, 0);
+                texture_pipeline_cycle(&rdp_state->texel0_color, &rdp_state->texel0_color, sss, sst, tile1, 0);
 
                 sigs.startspan = 0;
             }
@@ -3588,19 +3536,19 @@ void render_spans_1cycle_complete(int start, int end, int tilenum, int flip)
             t += dtinc;
             w += dwinc;
             tclod_1cycle_next(&news, &newt, s, t, w, dsinc, dtinc, dwinc, i, prim_tile, &newtile, &sigs, &prelodfrac);
-            texture_pipeline_cycle(&texel1_color, &texel1_color, news, newt, newtile, 0);
+            texture_pipeline_cycle(&rdp_state->texel1_color, &rdp_state->texel1_color, news, newt, newtile, 0);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
 
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_1cycle(adith, &curpixel_cvg);
-            fbread1_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread1_ptr(curpixel, &curpixel_memcvg);
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -3650,57 +3598,58 @@ void render_spans_1cycle_notexel1(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
                     
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -3746,26 +3695,26 @@ void render_spans_1cycle_notexel1(int start, int end, int tilenum, int flip)
             sigs.endspan = (j == length);
             sigs.preendspan = (j == (length - 1));
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
 
-            tcdiv_ptr(ss, st, sw, &sss, &sst);
+            rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
 
             tclod_1cycle_current_simple(&sss, &sst, s, t, w, dsinc, dtinc, dwinc, i, prim_tile, &tile1, &sigs);
 
-            texture_pipeline_cycle(&texel0_color, &texel0_color, sss, sst, tile1, 0);
+            texture_pipeline_cycle(&rdp_state->texel0_color, &rdp_state->texel0_color, sss, sst, tile1, 0);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
 
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_1cycle(adith, &curpixel_cvg);
                 
-            fbread1_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread1_ptr(curpixel, &curpixel_memcvg);
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -3814,48 +3763,49 @@ void render_spans_1cycle_notex(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
     
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
                     
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -3889,20 +3839,20 @@ void render_spans_1cycle_notex(int start, int end, int tilenum, int flip)
             sa = a >> 14;
             sz = (z >> 10) & 0x3fffff;
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
 
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_1cycle(adith, &curpixel_cvg);
                 
-            fbread1_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread1_ptr(curpixel, &curpixel_memcvg);
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_1cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
@@ -3959,57 +3909,58 @@ void render_spans_2cycle_complete(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
                 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -4050,23 +4001,23 @@ void render_spans_2cycle_complete(int start, int end, int tilenum, int flip)
             sw = w >> 16;
             sz = (z >> 10) & 0x3fffff;
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
 
             get_nexttexel0_2cycle(&news, &newt, s, t, w, dsinc, dtinc, dwinc);
             if (!sigs.startspan)
             {
-                lod_frac = prelodfrac;
-                texel0_color = nexttexel_color;
-                texel1_color = nexttexel1_color;
+                rdp_state->lod_frac = prelodfrac;
+                rdp_state->texel0_color = rdp_state->nexttexel_color;
+                rdp_state->texel1_color = nexttexel1_color;
             }
             else
             {
-                tcdiv_ptr(ss, st, sw, &sss, &sst);
+                rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
 
                 tclod_2cycle_current(&sss, &sst, news, newt, s, t, w, dsinc, dtinc, dwinc, prim_tile, &tile1, &tile2);
 
-                texture_pipeline_cycle(&texel0_color, &texel0_color, sss, sst, tile1, 0);
-                texture_pipeline_cycle(&texel1_color, &texel0_color, sss, sst, tile2, 1);
+                texture_pipeline_cycle(&rdp_state->texel0_color, &rdp_state->texel0_color, sss, sst, tile1, 0);
+                texture_pipeline_cycle(&rdp_state->texel1_color, &rdp_state->texel0_color, sss, sst, tile2, 1);
 
                 sigs.startspan = 0;
             }
@@ -4077,27 +4028,27 @@ void render_spans_2cycle_complete(int start, int end, int tilenum, int flip)
 
             tclod_2cycle_next(&news, &newt, s, t, w, dsinc, dtinc, dwinc, prim_tile, &newtile1, &newtile2, &prelodfrac);
 
-            texture_pipeline_cycle(&nexttexel_color, &nexttexel_color, news, newt, newtile1, 0);
-            texture_pipeline_cycle(&nexttexel1_color, &nexttexel_color, news, newt, newtile2, 1);
+            texture_pipeline_cycle(&rdp_state->nexttexel_color, &rdp_state->nexttexel_color, news, newt, newtile1, 0);
+            texture_pipeline_cycle(&nexttexel1_color, &rdp_state->nexttexel_color, news, newt, newtile2, 1);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_2cycle(adith, &curpixel_cvg);
-            fbread2_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread2_ptr(curpixel, &curpixel_memcvg);
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                     
                 }
             }
 
-            memory_color = pre_memory_color;
-            pastblshifta = blshifta;
-            pastblshiftb = blshiftb;
+            rdp_state->memory_color = rdp_state->pre_memory_color;
+            rdp_state->pastblshifta = rdp_state->blshifta;
+            rdp_state->pastblshiftb = rdp_state->blshiftb;
             r += drinc;
             g += dginc;
             b += dbinc;
@@ -4146,57 +4097,58 @@ void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
                 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -4236,35 +4188,35 @@ void render_spans_2cycle_notexelnext(int start, int end, int tilenum, int flip)
             sw = w >> 16;
             sz = (z >> 10) & 0x3fffff;
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
             
-            tcdiv_ptr(ss, st, sw, &sss, &sst);
+            rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
 
             tclod_2cycle_current_simple(&sss, &sst, s, t, w, dsinc, dtinc, dwinc, prim_tile, &tile1, &tile2);
                 
-            texture_pipeline_cycle(&texel0_color, &texel0_color, sss, sst, tile1, 0);
-            texture_pipeline_cycle(&texel1_color, &texel0_color, sss, sst, tile2, 1);
+            texture_pipeline_cycle(&rdp_state->texel0_color, &rdp_state->texel0_color, sss, sst, tile1, 0);
+            texture_pipeline_cycle(&rdp_state->texel1_color, &rdp_state->texel0_color, sss, sst, tile2, 1);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
                     
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_2cycle(adith, &curpixel_cvg);
                 
-            fbread2_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread2_ptr(curpixel, &curpixel_memcvg);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
 
-            memory_color = pre_memory_color;
-            pastblshifta = blshifta;
-            pastblshiftb = blshiftb;
+            rdp_state->memory_color = rdp_state->pre_memory_color;
+            rdp_state->pastblshifta = rdp_state->blshifta;
+            rdp_state->pastblshiftb = rdp_state->blshiftb;
             s += dsinc;
             t += dtinc;
             w += dwinc;
@@ -4314,57 +4266,58 @@ void render_spans_2cycle_notexel1(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -4404,35 +4357,35 @@ void render_spans_2cycle_notexel1(int start, int end, int tilenum, int flip)
             sw = w >> 16;
             sz = (z >> 10) & 0x3fffff;
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
             
-            tcdiv_ptr(ss, st, sw, &sss, &sst);
+            rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
 
             tclod_2cycle_current_notexel1(&sss, &sst, s, t, w, dsinc, dtinc, dwinc, prim_tile, &tile1);
             
             
-            texture_pipeline_cycle(&texel0_color, &texel0_color, sss, sst, tile1, 0);
+            texture_pipeline_cycle(&rdp_state->texel0_color, &rdp_state->texel0_color, sss, sst, tile1, 0);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
                     
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_2cycle(adith, &curpixel_cvg);
                 
-            fbread2_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread2_ptr(curpixel, &curpixel_memcvg);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
 
-            memory_color = pre_memory_color;
-            pastblshifta = blshifta;
-            pastblshiftb = blshiftb;
+            rdp_state->memory_color = rdp_state->pre_memory_color;
+            rdp_state->pastblshifta = rdp_state->blshifta;
+            rdp_state->pastblshiftb = rdp_state->blshiftb;
             s += dsinc;
             t += dtinc;
             w += dwinc;
@@ -4477,48 +4430,49 @@ void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        drinc = spans_d_rgba[0];
-        dginc = spans_d_rgba[1];
-        dbinc = spans_d_rgba[2];
-        dainc = spans_d_rgba[3];
-        dzinc = spans_d_stwz[3];
+        drinc = rdp_state->spans_d_rgba[0];
+        dginc = rdp_state->spans_d_rgba[1];
+        dbinc = rdp_state->spans_d_rgba[2];
+        dainc = rdp_state->spans_d_rgba[3];
+        dzinc = rdp_state->spans_d_stwz[3];
         xinc = 1;
     }
     else
     {
-        drinc = -spans_d_rgba[0];
-        dginc = -spans_d_rgba[1];
-        dbinc = -spans_d_rgba[2];
-        dainc = -spans_d_rgba[3];
-        dzinc = -spans_d_stwz[3];
+        drinc = -rdp_state->spans_d_rgba[0];
+        dginc = -rdp_state->spans_d_rgba[1];
+        dbinc = -rdp_state->spans_d_rgba[2];
+        dainc = -rdp_state->spans_d_rgba[3];
+        dzinc = -rdp_state->spans_d_stwz[3];
         xinc = -1;
     }
 
-    if (!other_modes.z_source_sel)
-        dzpix = spans_dzpix;
+    if (!rdp_state->other_modes.z_source_sel)
+        dzpix = rdp_state->spans_dzpix;
     else
     {
-        dzpix = primitive_delta_z;
-        dzinc = spans_cdz = spans_d_stwz_dy[3] = 0;
+        dzpix = rdp_state->primitive_delta_z;
+        dzinc = rdp_state->spans_cdz = rdp_state->spans_d_stwz_dy[3] = 0;
     }
     dzpixenc = dz_compress(dzpix);
                 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        r = span[i].rgba[0];
-        g = span[i].rgba[1];
-        b = span[i].rgba[2];
-        a = span[i].rgba[3];
-        z = other_modes.z_source_sel ? primitive_z : span[i].stwz[3];
+        reset_span_pipeline(i);
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        r = rdp_state->span[i].rgba[0];
+        g = rdp_state->span[i].rgba[1];
+        b = rdp_state->span[i].rgba[2];
+        a = rdp_state->span[i].rgba[3];
+        z = rdp_state->other_modes.z_source_sel ? rdp_state->primitive_z : rdp_state->span[i].stwz[3];
 
         x = xendsc;
-        curpixel = fb_width * i + x;
-        zbcur  = zb_address + 2*curpixel;
+        curpixel = rdp_state->fb_width * i + x;
+        zbcur  = rdp_state->zb_address + 2*curpixel;
         zbcur &= 0x00FFFFFF;
         zbcur  = zbcur >> 1;
 
@@ -4552,28 +4506,28 @@ void render_spans_2cycle_notex(int start, int end, int tilenum, int flip)
             sa = a >> 14;
             sz = (z >> 10) & 0x3fffff;
 
-            lookup_cvmask_derivatives(cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
+            lookup_cvmask_derivatives(rdp_state->cvgbuf[x], &offx, &offy, &curpixel_cvg, &curpixel_cvbit);
 
             rgbaz_correct_clip(offx, offy, sr, sg, sb, sa, &sz, curpixel_cvg);
                     
-            get_dither_noise_ptr(x, i, &cdith, &adith);
+            rdp_state->get_dither_noise_ptr(x, i, &cdith, &adith);
             combiner_2cycle(adith, &curpixel_cvg);
                 
-            fbread2_ptr(curpixel, &curpixel_memcvg);
+            rdp_state->fbread2_ptr(curpixel, &curpixel_memcvg);
 
             if (z_compare(zbcur, sz, dzpix, dzpixenc, &blend_en, &prewrap, &curpixel_cvg, curpixel_memcvg))
             {
                 if (blender_2cycle(&fir, &fig, &fib, cdith, blend_en, prewrap, curpixel_cvg, curpixel_cvbit))
                 {
-                    fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
-                    if (other_modes.z_update_en)
+                    rdp_state->fbwrite_ptr(curpixel, fir, fig, fib, blend_en, curpixel_cvg, curpixel_memcvg);
+                    if (rdp_state->other_modes.z_update_en)
                         z_store(zbcur, sz, dzpixenc);
                 }
             }
 
-            memory_color = pre_memory_color;
-            pastblshifta = blshifta;
-            pastblshiftb = blshiftb;
+            rdp_state->memory_color = rdp_state->pre_memory_color;
+            rdp_state->pastblshifta = rdp_state->blshifta;
+            rdp_state->pastblshiftb = rdp_state->blshiftb;
             r += drinc;
             g += dginc;
             b += dbinc;
@@ -4595,13 +4549,13 @@ NOINLINE void render_spans_fill(int start, int end, int flip)
     register int i, j;
     const int xinc = (flip & 1) ? +1 : -1;
     const int fastkillbits
-      = other_modes.image_read_en | other_modes.z_compare_en;
+      = rdp_state->other_modes.image_read_en | rdp_state->other_modes.z_compare_en;
     const int slowkillbits
-      = other_modes.z_update_en & ~other_modes.z_source_sel & ~fastkillbits;
+      = rdp_state->other_modes.z_update_en & ~rdp_state->other_modes.z_source_sel & ~fastkillbits;
 
     flip = -(flip & 1);
-    fbfill_ptr = fbfill_func[fb_size];
-    if (fb_size == PIXEL_SIZE_4BIT)
+    rdp_state->fbfill_ptr = fbfill_func[rdp_state->fb_size];
+    if (rdp_state->fb_size == PIXEL_SIZE_4BIT)
     {
         rdp_pipeline_crashed = 1;
         return;
@@ -4611,7 +4565,7 @@ NOINLINE void render_spans_fill(int start, int end, int flip)
     { /* branch very unlikely */
         for (i = start; i <= end; i++)
         {
-            length  = span[i].rx - span[i].lx; /* end - start */
+            length  = rdp_state->span[i].rx - rdp_state->span[i].lx; /* end - start */
             length ^= flip;
             length -= flip;
 
@@ -4633,16 +4587,16 @@ NOINLINE void render_spans_fill(int start, int end, int flip)
     {
         for (i = start; i <= end; i++)
         {
-            const int xstart = span[i].lx;
-            const int xendsc = span[i].rx;
+            const int xstart = rdp_state->span[i].lx;
+            const int xendsc = rdp_state->span[i].rx;
 
-            if (span[i].validline == 0)
+            if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
                 continue;
-            curpixel = fb_width*i + xendsc;
+            curpixel = rdp_state->fb_width*i + xendsc;
             length = +(xendsc - xstart);
             for (j = 0; j <= length; j++)
             {
-                fbfill_ptr(curpixel);
+                rdp_state->fbfill_ptr(curpixel);
                 --curpixel;
             }
         }
@@ -4651,16 +4605,16 @@ NOINLINE void render_spans_fill(int start, int end, int flip)
     {
         for (i = start; i <= end; i++)
         {
-            const int xstart = span[i].lx;
-            const int xendsc = span[i].rx;
+            const int xstart = rdp_state->span[i].lx;
+            const int xendsc = rdp_state->span[i].rx;
 
-            if (span[i].validline == 0)
+            if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
                 continue;
-            curpixel = fb_width*i + xendsc;
+            curpixel = rdp_state->fb_width*i + xendsc;
             length = -(xendsc - xstart);
             for (j = 0; j <= length; j++)
             {
-                fbfill_ptr(curpixel);
+                rdp_state->fbfill_ptr(curpixel);
                 ++curpixel;
             }
         }
@@ -4684,17 +4638,17 @@ NOINLINE void render_spans_copy(int start, int end, int tilenum, int flip)
 
     UINT32 hidword = 0, lowdword = 0;
     UINT32 hidword1 = 0, lowdword1 = 0;
-    int fbadvance = (fb_size == PIXEL_SIZE_4BIT) ? 8 : 16 >> fb_size;
+    int fbadvance = (rdp_state->fb_size == PIXEL_SIZE_4BIT) ? 8 : 16 >> rdp_state->fb_size;
     UINT32 fbptr = 0;
     int fbptr_advance = flip ? 8 : -8;
     UINT64 copyqword = 0;
     UINT32 tempdword = 0, tempbyte = 0;
     int copywmask = 0, alphamask = 0;
-    int bytesperpixel = (fb_size == PIXEL_SIZE_4BIT) ? 1 : (1 << (fb_size - 1));
+    int bytesperpixel = (rdp_state->fb_size == PIXEL_SIZE_4BIT) ? 1 : (1 << (rdp_state->fb_size - 1));
     UINT32 fbendptr = 0;
     INT32 threshold, currthreshold;
 
-    if (fb_size == PIXEL_SIZE_32BIT)
+    if (rdp_state->fb_size == PIXEL_SIZE_32BIT)
     {
         rdp_pipeline_crashed = 1;
         return;
@@ -4702,16 +4656,16 @@ NOINLINE void render_spans_copy(int start, int end, int tilenum, int flip)
 
     if (flip)
     {
-        dsinc = spans_d_stwz[0];
-        dtinc = spans_d_stwz[1];
-        dwinc = spans_d_stwz[2];
+        dsinc = rdp_state->spans_d_stwz[0];
+        dtinc = rdp_state->spans_d_stwz[1];
+        dwinc = rdp_state->spans_d_stwz[2];
         xinc = 1;
     }
     else
     {
-        dsinc = -spans_d_stwz[0];
-        dtinc = -spans_d_stwz[1];
-        dwinc = -spans_d_stwz[2];
+        dsinc = -rdp_state->spans_d_stwz[0];
+        dtinc = -rdp_state->spans_d_stwz[1];
+        dwinc = -rdp_state->spans_d_stwz[2];
         xinc = -1;
     }
 
@@ -4719,18 +4673,19 @@ NOINLINE void render_spans_copy(int start, int end, int tilenum, int flip)
                 
     for (i = start; i <= end; i++)
     {
-        if (span[i].validline == 0)
+        if (rdp_state->span[i].validline == 0 || SCANLINE_SKIPPED(i))
             continue;
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
-        w = span[i].stwz[2];
+        reset_span_pipeline(i);
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
+        w = rdp_state->span[i].stwz[2];
         
-        xstart = span[i].lx;
-        xendsc = span[i].rx;
+        xstart = rdp_state->span[i].lx;
+        xendsc = rdp_state->span[i].rx;
 
-        fb_index = fb_width * i + xendsc;
-        fbptr = fb_address + PIXELS_TO_BYTES_SPECIAL4(fb_index, fb_size);
-        fbendptr = fb_address + PIXELS_TO_BYTES_SPECIAL4((fb_width * i + xstart), fb_size);
+        fb_index = rdp_state->fb_width * i + xendsc;
+        fbptr = rdp_state->fb_address + PIXELS_TO_BYTES_SPECIAL4(fb_index, rdp_state->fb_size);
+        fbendptr = rdp_state->fb_address + PIXELS_TO_BYTES_SPECIAL4((rdp_state->fb_width * i + xstart), rdp_state->fb_size);
         fbptr &= 0x00FFFFFF;
         fbendptr &= 0x00FFFFFF;
         length = flip ? (xstart - xendsc) : (xendsc - xstart);
@@ -4741,17 +4696,17 @@ NOINLINE void render_spans_copy(int start, int end, int tilenum, int flip)
             st = t >> 16;
             sw = w >> 16;
 
-            tcdiv_ptr(ss, st, sw, &sss, &sst);
+            rdp_state->tcdiv_ptr(ss, st, sw, &sss, &sst);
             tclod_copy(&sss, &sst, s, t, w, dsinc, dtinc, dwinc, prim_tile, &tile1);
             fetch_qword_copy(&hidword, &lowdword, sss, sst, tile1);
 
-            if (fb_size == PIXEL_SIZE_16BIT || fb_size == PIXEL_SIZE_8BIT)
+            if (rdp_state->fb_size == PIXEL_SIZE_16BIT || rdp_state->fb_size == PIXEL_SIZE_8BIT)
                 copyqword = ((UINT64)hidword << 32) | ((UINT64)lowdword);
             else
                 copyqword = 0;
-            if (!other_modes.alpha_compare_en)
+            if (!rdp_state->other_modes.alpha_compare_en)
                 alphamask = 0xff;
-            else if (fb_size == PIXEL_SIZE_16BIT)
+            else if (rdp_state->fb_size == PIXEL_SIZE_16BIT)
             {
                 alphamask = 0;
                 alphamask |= (((copyqword >> 48) & 1) ? 0xC0 : 0);
@@ -4759,11 +4714,11 @@ NOINLINE void render_spans_copy(int start, int end, int tilenum, int flip)
                 alphamask |= (((copyqword >> 16) & 1) ? 0xC : 0);
                 alphamask |= ((copyqword & 1) ? 0x3 : 0);
             }
-            else if (fb_size == PIXEL_SIZE_8BIT)
+            else if (rdp_state->fb_size == PIXEL_SIZE_8BIT)
             {
                 alphamask = 0;
-                threshold = (other_modes.dither_alpha_en) ? (irand() & 0xff) : blend_color.a;
-                if (other_modes.dither_alpha_en)
+                threshold = (rdp_state->other_modes.dither_alpha_en) ? (irand() & 0xff) : rdp_state->blend_color.a;
+                if (rdp_state->other_modes.dither_alpha_en)
                 {
                     currthreshold = threshold;
                     alphamask |= (((copyqword >> 24) & 0xff) >= currthreshold ? 0xC0 : 0);
@@ -4830,7 +4785,7 @@ NOINLINE void loading_pipeline(
 
     UINT32 tmemidx0 = 0, tmemidx1 = 0, tmemidx2 = 0, tmemidx3 = 0;
     int dswap = 0;
-    UINT16* tmem16 = (UINT16*)__TMEM;
+    UINT16* tmem16 = (UINT16*)rdp_state->__TMEM;
     UINT32 readval0, readval1, readval2, readval3;
     UINT32 readidx32;
     UINT64 loadqword;
@@ -4841,8 +4796,8 @@ NOINLINE void loading_pipeline(
     int tiadvance = 0, spanadvance = 0;
     unsigned long tiptr;
 
-    dsinc = spans_d_stwz[0];
-    dtinc = spans_d_stwz[1];
+    dsinc = rdp_state->spans_d_stwz[0];
+    dtinc = rdp_state->spans_d_stwz[1];
 
     if (end > start && ltlut)
     {
@@ -4850,14 +4805,14 @@ NOINLINE void loading_pipeline(
         return;
     }
 
-    if (tile[tilenum].format == FORMAT_YUV)
+    if (rdp_state->tile[tilenum].format == FORMAT_YUV)
         tmem_formatting = 0;
-    else if (tile[tilenum].format == FORMAT_RGBA && tile[tilenum].size == PIXEL_SIZE_32BIT)
+    else if (rdp_state->tile[tilenum].format == FORMAT_RGBA && rdp_state->tile[tilenum].size == PIXEL_SIZE_32BIT)
         tmem_formatting = 1;
     else
         tmem_formatting = 2;
 
-    switch (ti_size)
+    switch (rdp_state->ti_size)
     {
     case PIXEL_SIZE_4BIT:
         rdp_pipeline_crashed = 1;
@@ -4887,14 +4842,14 @@ NOINLINE void loading_pipeline(
 
     for (i = start; i <= end; i++)
     {
-        xstart = span[i].lx;
-        xend = span[i].unscrx;
-        xendsc = span[i].rx;
-        s = span[i].stwz[0];
-        t = span[i].stwz[1];
+        xstart = rdp_state->span[i].lx;
+        xend = rdp_state->span[i].unscrx;
+        xendsc = rdp_state->span[i].rx;
+        s = rdp_state->span[i].stwz[0];
+        t = rdp_state->span[i].stwz[1];
 
-        ti_index = ti_width * i + xend;
-        tiptr = ti_address + PIXELS_TO_BYTES(ti_index, ti_size);
+        ti_index = rdp_state->ti_width * i + xend;
+        tiptr = rdp_state->ti_address + PIXELS_TO_BYTES(ti_index, rdp_state->ti_size);
         tiptr = tiptr & 0x00FFFFFF;
 
         length = (xstart - xend + 1) & 0xfff;
@@ -5094,7 +5049,7 @@ void edgewalker_for_loads(INT32* lewdata)
     INT32 yhlimit;
 
     flip = 1;
-    max_level = 0;
+    rdp_state->max_level = 0;
     tilenum = (lewdata[0] >> 16) & 7;
 
     
@@ -5121,16 +5076,16 @@ void edgewalker_for_loads(INT32* lewdata)
     dsdy = 0;
     dtdy = (lewdata[8] & 0xffff) << 16;
 
-    spans_d_stwz[0] = dsdx & ~0x1f;
-    spans_d_stwz[1] = dtdx & ~0x1f;
-    spans_d_stwz[2] = 0;
+    rdp_state->spans_d_stwz[0] = dsdx & ~0x1f;
+    rdp_state->spans_d_stwz[1] = dtdx & ~0x1f;
+    rdp_state->spans_d_stwz[2] = 0;
 
     xright = xh & ~0x1;
     xleft = xm & ~0x1;
 
 #define ADJUST_ATTR_LOAD() {           \
-    span[j].stwz[0] = s & ~0x000003FF; \
-    span[j].stwz[1] = t & ~0x000003FF; \
+    rdp_state->span[j].stwz[0] = s & ~0x000003FF; \
+    rdp_state->span[j].stwz[1] = t & ~0x000003FF; \
 }
 
 #define ADDVALUES_LOAD() { \
@@ -5174,14 +5129,14 @@ void edgewalker_for_loads(INT32* lewdata)
 
             if (spix == 0)
             {
-                span[j].unscrx = xend;
+                rdp_state->span[j].unscrx = xend;
                 ADJUST_ATTR_LOAD();
             }
 
             if (spix == 3)
             {
-                span[j].lx = maxxmx;
-                span[j].rx = minxhx;
+                rdp_state->span[j].lx = maxxmx;
+                rdp_state->span[j].rx = minxhx;
             }
         }
 
@@ -5206,76 +5161,76 @@ void deduce_derivatives()
     int lod_frac_used_in_cc1 = 0, lod_frac_used_in_cc0 = 0;
     int lodfracused = 0;
 
-    other_modes.f.partialreject_1cycle = (blender2b_a[0] == &inv_pixel_color.a && blender1b_a[0] == &pixel_color.a);
-    other_modes.f.partialreject_2cycle = (blender2b_a[1] == &inv_pixel_color.a && blender1b_a[1] == &pixel_color.a);
+    rdp_state->other_modes.f.partialreject_1cycle = (rdp_state->blender2b_a[0] == &rdp_state->inv_pixel_color.a && rdp_state->blender1b_a[0] == &rdp_state->pixel_color.a);
+    rdp_state->other_modes.f.partialreject_2cycle = (rdp_state->blender2b_a[1] == &rdp_state->inv_pixel_color.a && rdp_state->blender1b_a[1] == &rdp_state->pixel_color.a);
 
-    other_modes.f.special_bsel0 = (blender2b_a[0] == &memory_color.a);
-    other_modes.f.special_bsel1 = (blender2b_a[1] == &memory_color.a);
+    rdp_state->other_modes.f.special_bsel0 = (rdp_state->blender2b_a[0] == &rdp_state->memory_color.a);
+    rdp_state->other_modes.f.special_bsel1 = (rdp_state->blender2b_a[1] == &rdp_state->memory_color.a);
 
-    other_modes.f.rgb_alpha_dither = (other_modes.rgb_dither_sel << 2) | other_modes.alpha_dither_sel;
+    rdp_state->other_modes.f.rgb_alpha_dither = (rdp_state->other_modes.rgb_dither_sel << 2) | rdp_state->other_modes.alpha_dither_sel;
 
-    if (other_modes.rgb_dither_sel == 3)
-        rgb_dither_ptr = rgb_dither_func[1];
+    if (rdp_state->other_modes.rgb_dither_sel == 3)
+        rdp_state->rgb_dither_ptr = rgb_dither_func[1];
     else
-        rgb_dither_ptr = rgb_dither_func[0];
+        rdp_state->rgb_dither_ptr = rgb_dither_func[0];
 
-    tcdiv_ptr = tcdiv_func[other_modes.persp_tex_en];
+    rdp_state->tcdiv_ptr = tcdiv_func[rdp_state->other_modes.persp_tex_en];
 
-    if ((combiner_rgbmul_r[1] == &lod_frac) || (combiner_alphamul[1] == &lod_frac))
+    if ((rdp_state->combiner_rgbmul_r[1] == &rdp_state->lod_frac) || (rdp_state->combiner_alphamul[1] == &rdp_state->lod_frac))
         lod_frac_used_in_cc1 = 1;
-    if ((combiner_rgbmul_r[0] == &lod_frac) || (combiner_alphamul[0] == &lod_frac))
+    if ((rdp_state->combiner_rgbmul_r[0] == &rdp_state->lod_frac) || (rdp_state->combiner_alphamul[0] == &rdp_state->lod_frac))
         lod_frac_used_in_cc0 = 1;
 
-    if (combiner_rgbmul_r[1] == &texel1_color.r || combiner_rgbsub_a_r[1] == &texel1_color.r || combiner_rgbsub_b_r[1] == &texel1_color.r || combiner_rgbadd_r[1] == &texel1_color.r || \
-        combiner_alphamul[1] == &texel1_color.a || combiner_alphasub_a[1] == &texel1_color.a || combiner_alphasub_b[1] == &texel1_color.a || combiner_alphaadd[1] == &texel1_color.a || \
-        combiner_rgbmul_r[1] == &texel1_color.a)
+    if (rdp_state->combiner_rgbmul_r[1] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbsub_a_r[1] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbsub_b_r[1] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbadd_r[1] == &rdp_state->texel1_color.r || \
+        rdp_state->combiner_alphamul[1] == &rdp_state->texel1_color.a || rdp_state->combiner_alphasub_a[1] == &rdp_state->texel1_color.a || rdp_state->combiner_alphasub_b[1] == &rdp_state->texel1_color.a || rdp_state->combiner_alphaadd[1] == &rdp_state->texel1_color.a || \
+        rdp_state->combiner_rgbmul_r[1] == &rdp_state->texel1_color.a)
         texel1_used_in_cc1 = 1;
-    if (combiner_rgbmul_r[1] == &texel0_color.r || combiner_rgbsub_a_r[1] == &texel0_color.r || combiner_rgbsub_b_r[1] == &texel0_color.r || combiner_rgbadd_r[1] == &texel0_color.r || \
-        combiner_alphamul[1] == &texel0_color.a || combiner_alphasub_a[1] == &texel0_color.a || combiner_alphasub_b[1] == &texel0_color.a || combiner_alphaadd[1] == &texel0_color.a || \
-        combiner_rgbmul_r[1] == &texel0_color.a)
+    if (rdp_state->combiner_rgbmul_r[1] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbsub_a_r[1] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbsub_b_r[1] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbadd_r[1] == &rdp_state->texel0_color.r || \
+        rdp_state->combiner_alphamul[1] == &rdp_state->texel0_color.a || rdp_state->combiner_alphasub_a[1] == &rdp_state->texel0_color.a || rdp_state->combiner_alphasub_b[1] == &rdp_state->texel0_color.a || rdp_state->combiner_alphaadd[1] == &rdp_state->texel0_color.a || \
+        rdp_state->combiner_rgbmul_r[1] == &rdp_state->texel0_color.a)
         texel0_used_in_cc1 = 1;
-    if (combiner_rgbmul_r[0] == &texel1_color.r || combiner_rgbsub_a_r[0] == &texel1_color.r || combiner_rgbsub_b_r[0] == &texel1_color.r || combiner_rgbadd_r[0] == &texel1_color.r || \
-        combiner_alphamul[0] == &texel1_color.a || combiner_alphasub_a[0] == &texel1_color.a || combiner_alphasub_b[0] == &texel1_color.a || combiner_alphaadd[0] == &texel1_color.a || \
-        combiner_rgbmul_r[0] == &texel1_color.a)
+    if (rdp_state->combiner_rgbmul_r[0] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbsub_a_r[0] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbsub_b_r[0] == &rdp_state->texel1_color.r || rdp_state->combiner_rgbadd_r[0] == &rdp_state->texel1_color.r || \
+        rdp_state->combiner_alphamul[0] == &rdp_state->texel1_color.a || rdp_state->combiner_alphasub_a[0] == &rdp_state->texel1_color.a || rdp_state->combiner_alphasub_b[0] == &rdp_state->texel1_color.a || rdp_state->combiner_alphaadd[0] == &rdp_state->texel1_color.a || \
+        rdp_state->combiner_rgbmul_r[0] == &rdp_state->texel1_color.a)
         texel1_used_in_cc0 = 1;
-    if (combiner_rgbmul_r[0] == &texel0_color.r || combiner_rgbsub_a_r[0] == &texel0_color.r || combiner_rgbsub_b_r[0] == &texel0_color.r || combiner_rgbadd_r[0] == &texel0_color.r || \
-        combiner_alphamul[0] == &texel0_color.a || combiner_alphasub_a[0] == &texel0_color.a || combiner_alphasub_b[0] == &texel0_color.a || combiner_alphaadd[0] == &texel0_color.a || \
-        combiner_rgbmul_r[0] == &texel0_color.a)
+    if (rdp_state->combiner_rgbmul_r[0] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbsub_a_r[0] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbsub_b_r[0] == &rdp_state->texel0_color.r || rdp_state->combiner_rgbadd_r[0] == &rdp_state->texel0_color.r || \
+        rdp_state->combiner_alphamul[0] == &rdp_state->texel0_color.a || rdp_state->combiner_alphasub_a[0] == &rdp_state->texel0_color.a || rdp_state->combiner_alphasub_b[0] == &rdp_state->texel0_color.a || rdp_state->combiner_alphaadd[0] == &rdp_state->texel0_color.a || \
+        rdp_state->combiner_rgbmul_r[0] == &rdp_state->texel0_color.a)
         texel0_used_in_cc0 = 1;
     texels_in_cc0 = texel0_used_in_cc0 || texel1_used_in_cc0;
     texels_in_cc1 = texel0_used_in_cc1 || texel1_used_in_cc1;    
 
     
     if (texel1_used_in_cc1)
-        render_spans_1cycle_ptr = render_spans_1cycle_func[2];
+        rdp_state->render_spans_1cycle_ptr = render_spans_1cycle_func[2];
     else if (texel0_used_in_cc1 || lod_frac_used_in_cc1)
-        render_spans_1cycle_ptr = render_spans_1cycle_func[1];
+        rdp_state->render_spans_1cycle_ptr = render_spans_1cycle_func[1];
     else
-        render_spans_1cycle_ptr = render_spans_1cycle_func[0];
+        rdp_state->render_spans_1cycle_ptr = render_spans_1cycle_func[0];
 
     if (texel1_used_in_cc1)
-        render_spans_2cycle_ptr = render_spans_2cycle_func[3];
+        rdp_state->render_spans_2cycle_ptr = render_spans_2cycle_func[3];
     else if (texel1_used_in_cc0 || texel0_used_in_cc1)
-        render_spans_2cycle_ptr = render_spans_2cycle_func[2];
+        rdp_state->render_spans_2cycle_ptr = render_spans_2cycle_func[2];
     else if (texel0_used_in_cc0 || lod_frac_used_in_cc0 || lod_frac_used_in_cc1)
-        render_spans_2cycle_ptr = render_spans_2cycle_func[1];
+        rdp_state->render_spans_2cycle_ptr = render_spans_2cycle_func[1];
     else
-        render_spans_2cycle_ptr = render_spans_2cycle_func[0];
+        rdp_state->render_spans_2cycle_ptr = render_spans_2cycle_func[0];
 
-    if ((other_modes.cycle_type == CYCLE_TYPE_2 && (lod_frac_used_in_cc0 || lod_frac_used_in_cc1)) || \
-        (other_modes.cycle_type == CYCLE_TYPE_1 && lod_frac_used_in_cc1))
+    if ((rdp_state->other_modes.cycle_type == CYCLE_TYPE_2 && (lod_frac_used_in_cc0 || lod_frac_used_in_cc1)) || \
+        (rdp_state->other_modes.cycle_type == CYCLE_TYPE_1 && lod_frac_used_in_cc1))
         lodfracused = 1;
 
-    if ((other_modes.cycle_type == CYCLE_TYPE_1 && combiner_rgbsub_a_r[1] == &noise) || \
-        (other_modes.cycle_type == CYCLE_TYPE_2 && (combiner_rgbsub_a_r[0] == &noise || combiner_rgbsub_a_r[1] == &noise)) || \
-        other_modes.alpha_dither_sel == 2)
-        get_dither_noise_ptr = get_dither_noise_func[0];
-    else if (other_modes.f.rgb_alpha_dither != 0xf)
-        get_dither_noise_ptr = get_dither_noise_func[1];
+    if ((rdp_state->other_modes.cycle_type == CYCLE_TYPE_1 && rdp_state->combiner_rgbsub_a_r[1] == &rdp_state->noise) || \
+        (rdp_state->other_modes.cycle_type == CYCLE_TYPE_2 && (rdp_state->combiner_rgbsub_a_r[0] == &rdp_state->noise || rdp_state->combiner_rgbsub_a_r[1] == &rdp_state->noise)) || \
+        rdp_state->other_modes.alpha_dither_sel == 2)
+        rdp_state->get_dither_noise_ptr = get_dither_noise_func[0];
+    else if (rdp_state->other_modes.f.rgb_alpha_dither != 0xf)
+        rdp_state->get_dither_noise_ptr = get_dither_noise_func[1];
     else
-        get_dither_noise_ptr = get_dither_noise_func[2];
+        rdp_state->get_dither_noise_ptr = get_dither_noise_func[2];
 
-    other_modes.f.dolod = other_modes.tex_lod_en || lodfracused;
+    rdp_state->other_modes.f.dolod = rdp_state->other_modes.tex_lod_en || lodfracused;
     return;
 }
 
@@ -5285,10 +5240,10 @@ void tile_tlut_common_cs_decoder(UINT32 w1, UINT32 w2)
     int tilenum = (w2 >> 24) & 0x7;
     int sl, tl, sh, th;
 
-    tile[tilenum].sl = sl = ((w1 >> 12) & 0xfff);
-    tile[tilenum].tl = tl = ((w1 >>  0) & 0xfff);
-    tile[tilenum].sh = sh = ((w2 >> 12) & 0xfff);
-    tile[tilenum].th = th = ((w2 >>  0) & 0xfff);
+    rdp_state->tile[tilenum].sl = sl = ((w1 >> 12) & 0xfff);
+    rdp_state->tile[tilenum].tl = tl = ((w1 >>  0) & 0xfff);
+    rdp_state->tile[tilenum].sh = sh = ((w2 >> 12) & 0xfff);
+    rdp_state->tile[tilenum].th = th = ((w2 >>  0) & 0xfff);
 
     calculate_clamp_diffs(tilenum);
 
@@ -5299,7 +5254,7 @@ void tile_tlut_common_cs_decoder(UINT32 w1, UINT32 w2)
     lewdata[4] = ((sh >> 2) << 16) | ((sh & 3) << 14);
     lewdata[5] = ((sl << 3) << 16) | (tl << 3);
     lewdata[6] = 0;
-    lewdata[7] = (0x200 >> ti_size) << 16;
+    lewdata[7] = (0x200 >> rdp_state->ti_size) << 16;
     lewdata[8] = 0x20;
     lewdata[9] = 0x20;
 
@@ -5309,21 +5264,21 @@ void tile_tlut_common_cs_decoder(UINT32 w1, UINT32 w2)
 
 STRICTINLINE INT32 irand(void)
 {
-    iseed *= 0x343fd;
-    iseed += 0x269ec3;
-    return ((iseed >> 16) & 0x7fff);
+    rdp_state->iseed *= 0x343fd;
+    rdp_state->iseed += 0x269ec3;
+    return ((rdp_state->iseed >> 16) & 0x7fff);
 }
 
 STRICTINLINE int alpha_compare(INT32 comb_alpha)
 {
     INT32 threshold;
 
-    if (!other_modes.alpha_compare_en)
+    if (!rdp_state->other_modes.alpha_compare_en)
         return 1;
     else
     {
-        if (!other_modes.dither_alpha_en)
-            threshold = blend_color.a;
+        if (!rdp_state->other_modes.dither_alpha_en)
+            threshold = rdp_state->blend_color.a;
         else
             threshold = irand() & 0xff;
         if (comb_alpha >= threshold)
@@ -5360,21 +5315,21 @@ static void blender_equation_cycle0(int* r, int* g, int* b)
     int blr, blg, blb, sum;
     int mulb;
 
-    blend1a = *blender1b_a[0] >> 3;
-    blend2a = *blender2b_a[0] >> 3;
+    blend1a = *rdp_state->blender1b_a[0] >> 3;
+    blend2a = *rdp_state->blender2b_a[0] >> 3;
 
-    if (other_modes.f.special_bsel0)
+    if (rdp_state->other_modes.f.special_bsel0)
     {
-        blend1a = (blend1a >> blshifta) & 0x3C;
-        blend2a = (blend2a >> blshiftb) | 3;
+        blend1a = (blend1a >> rdp_state->blshifta) & 0x3C;
+        blend2a = (blend2a >> rdp_state->blshiftb) | 3;
     }
     mulb = blend2a + 1;
 
-    blr = (*blender1a_r[0]) * blend1a + (*blender2a_r[0]) * mulb;
-    blg = (*blender1a_g[0]) * blend1a + (*blender2a_g[0]) * mulb;
-    blb = (*blender1a_b[0]) * blend1a + (*blender2a_b[0]) * mulb;
+    blr = (*rdp_state->blender1a_r[0]) * blend1a + (*rdp_state->blender2a_r[0]) * mulb;
+    blg = (*rdp_state->blender1a_g[0]) * blend1a + (*rdp_state->blender2a_g[0]) * mulb;
+    blb = (*rdp_state->blender1a_b[0]) * blend1a + (*rdp_state->blender2a_b[0]) * mulb;
 
-    if (!other_modes.force_blend)
+    if (!rdp_state->other_modes.force_blend)
     {
         sum = ((blend1a & ~3) + (blend2a & ~3) + 4) << 9;
         *r = bldiv_hwaccurate_table[sum | ((blr >> 2) & 0x7ff)];
@@ -5392,18 +5347,18 @@ static void blender_equation_cycle0(int* r, int* g, int* b)
 STRICTINLINE void blender_equation_cycle0_2(int* r, int* g, int* b)
 {
     int blend1a, blend2a;
-    blend1a = *blender1b_a[0] >> 3;
-    blend2a = *blender2b_a[0] >> 3;
+    blend1a = *rdp_state->blender1b_a[0] >> 3;
+    blend2a = *rdp_state->blender2b_a[0] >> 3;
 
-    if (other_modes.f.special_bsel0)
+    if (rdp_state->other_modes.f.special_bsel0)
     {
-        blend1a = (blend1a >> pastblshifta) & 0x3C;
-        blend2a = (blend2a >> pastblshiftb) | 3;
+        blend1a = (blend1a >> rdp_state->pastblshifta) & 0x3C;
+        blend2a = (blend2a >> rdp_state->pastblshiftb) | 3;
     }
     blend2a += 1;
-    *r = (((*blender1a_r[0]) * blend1a + (*blender2a_r[0]) * blend2a) >> 5) & 0xff;
-    *g = (((*blender1a_g[0]) * blend1a + (*blender2a_g[0]) * blend2a) >> 5) & 0xff;
-    *b = (((*blender1a_b[0]) * blend1a + (*blender2a_b[0]) * blend2a) >> 5) & 0xff;
+    *r = (((*rdp_state->blender1a_r[0]) * blend1a + (*rdp_state->blender2a_r[0]) * blend2a) >> 5) & 0xff;
+    *g = (((*rdp_state->blender1a_g[0]) * blend1a + (*rdp_state->blender2a_g[0]) * blend2a) >> 5) & 0xff;
+    *b = (((*rdp_state->blender1a_b[0]) * blend1a + (*rdp_state->blender2a_b[0]) * blend2a) >> 5) & 0xff;
 }
 
 static void blender_equation_cycle1(int* r, int* g, int* b)
@@ -5412,20 +5367,20 @@ static void blender_equation_cycle1(int* r, int* g, int* b)
     int blr, blg, blb, sum;
     int mulb;
 
-    blend1a = *blender1b_a[1] >> 3;
-    blend2a = *blender2b_a[1] >> 3;
+    blend1a = *rdp_state->blender1b_a[1] >> 3;
+    blend2a = *rdp_state->blender2b_a[1] >> 3;
 
-    if (other_modes.f.special_bsel1)
+    if (rdp_state->other_modes.f.special_bsel1)
     {
-        blend1a = (blend1a >> blshifta) & 0x3C;
-        blend2a = (blend2a >> blshiftb) | 3;
+        blend1a = (blend1a >> rdp_state->blshifta) & 0x3C;
+        blend2a = (blend2a >> rdp_state->blshiftb) | 3;
     }
     mulb = blend2a + 1;
-    blr = (*blender1a_r[1]) * blend1a + (*blender2a_r[1]) * mulb;
-    blg = (*blender1a_g[1]) * blend1a + (*blender2a_g[1]) * mulb;
-    blb = (*blender1a_b[1]) * blend1a + (*blender2a_b[1]) * mulb;
+    blr = (*rdp_state->blender1a_r[1]) * blend1a + (*rdp_state->blender2a_r[1]) * mulb;
+    blg = (*rdp_state->blender1a_g[1]) * blend1a + (*rdp_state->blender2a_g[1]) * mulb;
+    blb = (*rdp_state->blender1a_b[1]) * blend1a + (*rdp_state->blender2a_b[1]) * mulb;
 
-    if (!other_modes.force_blend)
+    if (!rdp_state->other_modes.force_blend)
     {
         sum = ((blend1a & ~3) + (blend2a & ~3) + 4) << 9;
         *r = bldiv_hwaccurate_table[sum | ((blr >> 2) & 0x7ff)];
@@ -5462,18 +5417,18 @@ static void compute_cvg_flip(INT32 scanline)
     int i, length, fmask, maskshift, fmaskshifted;
     INT32 fleft, minorcur, majorcur, minorcurint, majorcurint, samecvg;
 
-    purgestart = span[scanline].rx;
-    purgeend = span[scanline].lx;
+    purgestart = rdp_state->span[scanline].rx;
+    purgeend = rdp_state->span[scanline].lx;
     length = purgeend - purgestart;
     if (length >= 0)
     {
-        zerobuf(&cvgbuf[purgestart], (length + 1) << 2);
+        zerobuf(&rdp_state->cvgbuf[purgestart], (length + 1) << 2);
         for(i = 0; i < 4; i++)
         {
-            if (!span[scanline].invalyscan[i])
+            if (!rdp_state->span[scanline].invalyscan[i])
             {
-                minorcur = span[scanline].minorx[i];
-                majorcur = span[scanline].majorx[i];
+                minorcur = rdp_state->span[scanline].minorx[i];
+                majorcur = rdp_state->span[scanline].majorx[i];
                 minorcurint = minorcur >> 3;
                 majorcurint = majorcur >> 3;
                 fmask = 0xa >> (i & 1);
@@ -5488,16 +5443,16 @@ static void compute_cvg_flip(INT32 scanline)
 
                 if (minorcurint != majorcurint)
                 {
-                    cvgbuf[minorcurint] |= (rightcvghex(minorcur, fmask) << maskshift);
-                    cvgbuf[majorcurint] |= (leftcvghex(majorcur, fmask) << maskshift);
+                    rdp_state->cvgbuf[minorcurint] |= (rightcvghex(minorcur, fmask) << maskshift);
+                    rdp_state->cvgbuf[majorcurint] |= (leftcvghex(majorcur, fmask) << maskshift);
                 }
                 else
                 {
                     samecvg = rightcvghex(minorcur, fmask) & leftcvghex(majorcur, fmask);
-                    cvgbuf[majorcurint] |= (samecvg << maskshift);
+                    rdp_state->cvgbuf[majorcurint] |= (samecvg << maskshift);
                 }
                 for (; fleft < minorcurint; fleft++)
-                    cvgbuf[fleft] |= fmaskshifted;
+                    rdp_state->cvgbuf[fleft] |= fmaskshifted;
             }
         }
     }
@@ -5509,20 +5464,20 @@ static void compute_cvg_noflip(INT32 scanline)
     int i, length, fmask, maskshift, fmaskshifted;
     INT32 fleft, minorcur, majorcur, minorcurint, majorcurint, samecvg;
     
-    purgestart = span[scanline].lx;
-    purgeend = span[scanline].rx;
+    purgestart = rdp_state->span[scanline].lx;
+    purgeend = rdp_state->span[scanline].rx;
     length = purgeend - purgestart;
 
     if (length >= 0)
     {
-        zerobuf(&cvgbuf[purgestart], (length + 1) << 2);
+        zerobuf(&rdp_state->cvgbuf[purgestart], (length + 1) << 2);
 
         for(i = 0; i < 4; i++)
         {
-            if (!span[scanline].invalyscan[i])
+            if (!rdp_state->span[scanline].invalyscan[i])
             {
-                minorcur = span[scanline].minorx[i];
-                majorcur = span[scanline].majorx[i];
+                minorcur = rdp_state->span[scanline].minorx[i];
+                majorcur = rdp_state->span[scanline].majorx[i];
                 minorcurint = minorcur >> 3;
                 majorcurint = majorcur >> 3;
                 fmask = 0xa >> (i & 1);
@@ -5532,16 +5487,16 @@ static void compute_cvg_noflip(INT32 scanline)
 
                 if (minorcurint != majorcurint)
                 {
-                    cvgbuf[minorcurint] |= (leftcvghex(minorcur, fmask) << maskshift);
-                    cvgbuf[majorcurint] |= (rightcvghex(majorcur, fmask) << maskshift);
+                    rdp_state->cvgbuf[minorcurint] |= (leftcvghex(minorcur, fmask) << maskshift);
+                    rdp_state->cvgbuf[majorcurint] |= (rightcvghex(majorcur, fmask) << maskshift);
                 }
                 else
                 {
                     samecvg = leftcvghex(minorcur, fmask) & rightcvghex(majorcur, fmask);
-                    cvgbuf[majorcurint] |= (samecvg << maskshift);
+                    rdp_state->cvgbuf[majorcurint] |= (samecvg << maskshift);
                 }
                 for (; fleft < majorcurint; fleft++)
-                    cvgbuf[fleft] |= fmaskshifted;
+                    rdp_state->cvgbuf[fleft] |= fmaskshifted;
             }
         }
     }
@@ -5549,6 +5504,9 @@ static void compute_cvg_noflip(INT32 scanline)
 
 void rdp_close(void)
 {
+#ifdef HAVE_RDP_THREADS
+    rdp_threads_close();
+#endif
     return;
 }
 
@@ -5558,7 +5516,7 @@ void fbwrite_4(
 {
     register unsigned long addr;
 
-    addr  = fb_address + curpixel*1;
+    addr  = rdp_state->fb_address + curpixel*1;
     addr &= 0x00FFFFFF;
 
     RWRITEADDR8(addr, 0x00);
@@ -5571,7 +5529,7 @@ void fbwrite_8(
 {
     register unsigned long addr;
 
-    addr  = fb_address + 1*curpixel;
+    addr  = rdp_state->fb_address + 1*curpixel;
     addr &= 0x00FFFFFF;
     PAIRWRITE8(addr, r, (r & 1) ? 3 : 0);
     return;
@@ -5594,7 +5552,7 @@ void fbwrite_16(
     g = covdraw;
     b = covdraw;
 #endif
-    if (fb_format != FORMAT_RGBA)
+    if (rdp_state->fb_format != FORMAT_RGBA)
     {
         color = (r << 8) | (coverage << 5);
         coverage = 0x00;
@@ -5607,7 +5565,7 @@ void fbwrite_16(
         color = (r << 8) | (g << 3) | (b >> 2) | (coverage >> 2);
     }
 
-    addr  = fb_address + 2*curpixel;
+    addr  = rdp_state->fb_address + 2*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 1;
     PAIRWRITE16(addr, color, coverage & 3);
@@ -5622,7 +5580,7 @@ void fbwrite_32(
     int coverage;
     register unsigned long addr;
 
-    addr  = fb_address + 4*curpixel;
+    addr  = rdp_state->fb_address + 4*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 2;
 
@@ -5646,10 +5604,10 @@ void fbfill_8(UINT32 curpixel)
     unsigned char source;
     register unsigned long addr;
 
-    addr  = fb_address + 1*curpixel;
+    addr  = rdp_state->fb_address + 1*curpixel;
     addr &= 0x00FFFFFF;
 
-    source = (fill_color >> 8*(~addr & 3)) & 0xFF;
+    source = (rdp_state->fill_color >> 8*(~addr & 3)) & 0xFF;
     PAIRWRITE8(addr, source, -(source & 1) & 3);
     return;
 }
@@ -5659,11 +5617,11 @@ void fbfill_16(UINT32 curpixel)
     register unsigned long addr;
     register unsigned short source;
 
-    addr  = fb_address + 2*curpixel;
+    addr  = rdp_state->fb_address + 2*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 1;
 
-    source = fill_color>>16*(~addr & 1) & 0xFFFF;
+    source = rdp_state->fill_color>>16*(~addr & 1) & 0xFFFF;
     PAIRWRITE16(addr, source, -(source & 1) & 3);
     return;
 }
@@ -5671,29 +5629,29 @@ void fbfill_16(UINT32 curpixel)
 void fbfill_32(UINT32 curpixel)
 {
     register unsigned long addr;
-    const unsigned short fill_color_hi = (fill_color >> 16) & 0xFFFF;
-    const unsigned short fill_color_lo = (fill_color >>  0) & 0xFFFF;
+    const unsigned short fill_color_hi = (rdp_state->fill_color >> 16) & 0xFFFF;
+    const unsigned short fill_color_lo = (rdp_state->fill_color >>  0) & 0xFFFF;
 
-    addr  = fb_address + 4*curpixel;
+    addr  = rdp_state->fb_address + 4*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 2;
-    PAIRWRITE32(addr, fill_color,
+    PAIRWRITE32(addr, rdp_state->fill_color,
         -(fill_color_hi & 0x0001) & 3, -(fill_color_lo & 0x0001) & 3);
     return;
 }
 
 void fbread_4(UINT32 curpixel, UINT32* curpixel_memcvg)
 {
-    memory_color.r = memory_color.g = memory_color.b = 0x00;
-    memory_color.a = 0xE0;
+    rdp_state->memory_color.r = rdp_state->memory_color.g = rdp_state->memory_color.b = 0x00;
+    rdp_state->memory_color.a = 0xE0;
     *curpixel_memcvg = 7;
     return;
 }
 
 void fbread2_4(UINT32 curpixel, UINT32* curpixel_memcvg)
 {
-    pre_memory_color.r = pre_memory_color.g = pre_memory_color.b = 0x00;
-    pre_memory_color.a = 0xE0;
+    rdp_state->pre_memory_color.r = rdp_state->pre_memory_color.g = rdp_state->pre_memory_color.b = 0x00;
+    rdp_state->pre_memory_color.a = 0xE0;
     *curpixel_memcvg = 7;
     return;
 }
@@ -5703,14 +5661,14 @@ void fbread_8(UINT32 curpixel, UINT32* curpixel_memcvg)
     u8 color;
     register unsigned long addr;
 
-    addr  = fb_address + 1*curpixel;
+    addr  = rdp_state->fb_address + 1*curpixel;
     addr &= 0x00FFFFFF;
     color = RREADADDR8(addr);
 
-    memory_color.r = color;
-    memory_color.g = color;
-    memory_color.b = color;
-    memory_color.a = 0xE0;
+    rdp_state->memory_color.r = color;
+    rdp_state->memory_color.g = color;
+    rdp_state->memory_color.b = color;
+    rdp_state->memory_color.a = 0xE0;
     *curpixel_memcvg = 7;
     return;
 }
@@ -5720,14 +5678,14 @@ void fbread2_8(UINT32 curpixel, UINT32* curpixel_memcvg)
     u8 color;
     register unsigned long addr;
 
-    addr  = fb_address + 1*curpixel;
+    addr  = rdp_state->fb_address + 1*curpixel;
     addr &= 0x00FFFFFF;
     color = RREADADDR8(addr);
 
-    pre_memory_color.r = color;
-    pre_memory_color.g = color;
-    pre_memory_color.b = color;
-    pre_memory_color.a = 0xE0;
+    rdp_state->pre_memory_color.r = color;
+    rdp_state->pre_memory_color.g = color;
+    rdp_state->pre_memory_color.b = color;
+    rdp_state->pre_memory_color.a = 0xE0;
     *curpixel_memcvg = 7;
     return;
 }
@@ -5738,28 +5696,28 @@ void fbread_16(UINT32 curpixel, UINT32* curpixel_memcvg)
     u16 color;
     register unsigned long addr;
 
-    addr  = fb_address + 2*curpixel;
+    addr  = rdp_state->fb_address + 2*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 1;
     PAIRREAD16(color, hidden, addr);
 
-    if (fb_format != FORMAT_RGBA)
+    if (rdp_state->fb_format != FORMAT_RGBA)
     {
-        memory_color.r = color >> 8;
-        memory_color.g = color >> 8;
-        memory_color.b = color >> 8;
-        memory_color.a = color; /* & 0xE0 */
+        rdp_state->memory_color.r = color >> 8;
+        rdp_state->memory_color.g = color >> 8;
+        rdp_state->memory_color.b = color >> 8;
+        rdp_state->memory_color.a = color; /* & 0xE0 */
     }
     else
     {
-        memory_color.r = GET_HI(color);
-        memory_color.g = GET_MED(color);
-        memory_color.b = GET_LOW(color);
-        memory_color.a = (4*color + hidden) << 5;
+        rdp_state->memory_color.r = GET_HI(color);
+        rdp_state->memory_color.g = GET_MED(color);
+        rdp_state->memory_color.b = GET_LOW(color);
+        rdp_state->memory_color.a = (4*color + hidden) << 5;
     }
-    memory_color.a |= ~(-other_modes.image_read_en);
-    memory_color.a &= 0xE0;
-    *curpixel_memcvg = (unsigned char)(memory_color.a) >> 5;
+    rdp_state->memory_color.a |= ~(-rdp_state->other_modes.image_read_en);
+    rdp_state->memory_color.a &= 0xE0;
+    *curpixel_memcvg = (unsigned char)(rdp_state->memory_color.a) >> 5;
     return;
 }
 
@@ -5769,28 +5727,28 @@ void fbread2_16(UINT32 curpixel, UINT32* curpixel_memcvg)
     u16 color;
     register unsigned long addr;
 
-    addr  = fb_address + 2*curpixel;
+    addr  = rdp_state->fb_address + 2*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 1;
     PAIRREAD16(color, hidden, addr);
 
-    if (fb_format != FORMAT_RGBA)
+    if (rdp_state->fb_format != FORMAT_RGBA)
     {
-        pre_memory_color.r = color >> 8;
-        pre_memory_color.g = color >> 8;
-        pre_memory_color.b = color >> 8;
-        pre_memory_color.a = color; /* & 0xE0 */
+        rdp_state->pre_memory_color.r = color >> 8;
+        rdp_state->pre_memory_color.g = color >> 8;
+        rdp_state->pre_memory_color.b = color >> 8;
+        rdp_state->pre_memory_color.a = color; /* & 0xE0 */
     }
     else
     {
-        pre_memory_color.r = GET_HI(color);
-        pre_memory_color.g = GET_MED(color);
-        pre_memory_color.b = GET_LOW(color);
-        pre_memory_color.a = (4*color + hidden) << 5;
+        rdp_state->pre_memory_color.r = GET_HI(color);
+        rdp_state->pre_memory_color.g = GET_MED(color);
+        rdp_state->pre_memory_color.b = GET_LOW(color);
+        rdp_state->pre_memory_color.a = (4*color + hidden) << 5;
     }
-    pre_memory_color.a |= ~(-other_modes.image_read_en);
-    pre_memory_color.a &= 0xE0;
-    *curpixel_memcvg = (unsigned char)(pre_memory_color.a) >> 5;
+    rdp_state->pre_memory_color.a |= ~(-rdp_state->other_modes.image_read_en);
+    rdp_state->pre_memory_color.a &= 0xE0;
+    *curpixel_memcvg = (unsigned char)(rdp_state->pre_memory_color.a) >> 5;
     return;
 }
 
@@ -5799,20 +5757,20 @@ void fbread_32(UINT32 curpixel, UINT32* curpixel_memcvg)
     u32 color;
     register unsigned long addr;
 
-    addr  = fb_address + 4*curpixel;
+    addr  = rdp_state->fb_address + 4*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 2;
     color = RREADIDX32(addr);
 
-    memory_color.r = (color >> 24) & 0xFF;
-    memory_color.g = (color >> 16) & 0xFF;
-    memory_color.b = (color >>  8) & 0xFF;
+    rdp_state->memory_color.r = (color >> 24) & 0xFF;
+    rdp_state->memory_color.g = (color >> 16) & 0xFF;
+    rdp_state->memory_color.b = (color >>  8) & 0xFF;
 
-    memory_color.a  = (color >>  0) & 0xFF;
-    memory_color.a |= ~(-other_modes.image_read_en);
-    memory_color.a &= 0xE0;
+    rdp_state->memory_color.a  = (color >>  0) & 0xFF;
+    rdp_state->memory_color.a |= ~(-rdp_state->other_modes.image_read_en);
+    rdp_state->memory_color.a &= 0xE0;
 
-    *curpixel_memcvg = (unsigned char)(memory_color.a) >> 5;
+    *curpixel_memcvg = (unsigned char)(rdp_state->memory_color.a) >> 5;
     return;
 }
 
@@ -5821,20 +5779,20 @@ void fbread2_32(UINT32 curpixel, UINT32* curpixel_memcvg)
     u32 color;
     register unsigned long addr;
 
-    addr  = fb_address + 4*curpixel;
+    addr  = rdp_state->fb_address + 4*curpixel;
     addr &= 0x00FFFFFF;
     addr  = addr >> 2;
     color = RREADIDX32(addr);
 
-    pre_memory_color.r = (color >> 24) & 0xFF;
-    pre_memory_color.g = (color >> 16) & 0xFF;
-    pre_memory_color.b = (color >>  8) & 0xFF;
+    rdp_state->pre_memory_color.r = (color >> 24) & 0xFF;
+    rdp_state->pre_memory_color.g = (color >> 16) & 0xFF;
+    rdp_state->pre_memory_color.b = (color >>  8) & 0xFF;
 
-    pre_memory_color.a  = (color >>  0) & 0xFF;
-    pre_memory_color.a |= ~(-other_modes.image_read_en);
-    pre_memory_color.a &= 0xE0;
+    rdp_state->pre_memory_color.a  = (color >>  0) & 0xFF;
+    rdp_state->pre_memory_color.a |= ~(-rdp_state->other_modes.image_read_en);
+    rdp_state->pre_memory_color.a &= 0xE0;
 
-    *curpixel_memcvg = (unsigned char)(pre_memory_color.a) >> 5;
+    *curpixel_memcvg = (unsigned char)(rdp_state->pre_memory_color.a) >> 5;
     return;
 }
 
@@ -6096,7 +6054,7 @@ static UINT32 z_compare(UINT32 zcurpixel, UINT32 sz, UINT16 dzpix, int dzpixenc,
     INT32 rawdzmem;
 
     sz &= 0x3ffff;
-    if (other_modes.z_compare_en)
+    if (rdp_state->other_modes.z_compare_en)
     {
         UINT32 dznew;
         UINT32 dznotshift;
@@ -6110,8 +6068,8 @@ static UINT32 z_compare(UINT32 zcurpixel, UINT32 sz, UINT16 dzpix, int dzpixenc,
         rawdzmem = ((zval & 3) << 2) | hval;
         dzmem = dz_decompress(rawdzmem);
 
-        blshifta = CLIP(dzpixenc - rawdzmem, 0, 4);
-        blshiftb = CLIP(rawdzmem - dzpixenc, 0, 4);
+        rdp_state->blshifta = CLIP(dzpixenc - rawdzmem, 0, 4);
+        rdp_state->blshiftb = CLIP(rawdzmem - dzpixenc, 0, 4);
 
         precision_factor = (zval >> 13) & 0xf;
 
@@ -6142,11 +6100,11 @@ static UINT32 z_compare(UINT32 zcurpixel, UINT32 sz, UINT16 dzpix, int dzpixenc,
         farther = force_coplanar || ((sz + dznew) >= oz);
         
         overflow = (curpixel_memcvg + *curpixel_cvg) & 8;
-        *blend_en = other_modes.force_blend || (!overflow && other_modes.antialias_en && farther);
+        *blend_en = rdp_state->other_modes.force_blend || (!overflow && rdp_state->other_modes.antialias_en && farther);
         
         *prewrap = overflow;
 
-        switch(other_modes.z_mode)
+        switch(rdp_state->other_modes.z_mode)
         {
         case ZMODE_OPAQUE: 
             infront = sz < oz;
@@ -6190,10 +6148,10 @@ static UINT32 z_compare(UINT32 zcurpixel, UINT32 sz, UINT16 dzpix, int dzpixenc,
     {
         int overflow = (curpixel_memcvg + *curpixel_cvg) & 8;
 
-        blshifta = CLIP(dzpixenc - 0xf, 0, 4);
-        blshiftb = CLIP(0xf - dzpixenc, 0, 4);
+        rdp_state->blshifta = CLIP(dzpixenc - 0xf, 0, 4);
+        rdp_state->blshiftb = CLIP(0xf - dzpixenc, 0, 4);
 
-        *blend_en = other_modes.force_blend || (!overflow && other_modes.antialias_en);
+        *blend_en = rdp_state->other_modes.force_blend || (!overflow && rdp_state->other_modes.antialias_en);
         *prewrap = overflow;
 
         return 1;
@@ -6214,7 +6172,7 @@ STRICTINLINE int finalize_spanalpha(
     possibilities[CVG_WRAP] += curpixel_cvg;
     possibilities[CVG_CLAMP] |= -(possibilities[CVG_CLAMP]>>3 & 1);
 
-    return (possibilities[other_modes.cvg_dest] & 7);
+    return (possibilities[rdp_state->other_modes.cvg_dest] & 7);
 }
 
 STRICTINLINE INT32 CLIP(INT32 value,INT32 min,INT32 max)
@@ -6229,19 +6187,19 @@ STRICTINLINE INT32 CLIP(INT32 value,INT32 min,INT32 max)
 
 INLINE void calculate_clamp_diffs(UINT32 i)
 {
-    tile[i].f.clampdiffs = ((tile[i].sh >> 2) - (tile[i].sl >> 2)) & 0x3ff;
-    tile[i].f.clampdifft = ((tile[i].th >> 2) - (tile[i].tl >> 2)) & 0x3ff;
+    rdp_state->tile[i].f.clampdiffs = ((rdp_state->tile[i].sh >> 2) - (rdp_state->tile[i].sl >> 2)) & 0x3ff;
+    rdp_state->tile[i].f.clampdifft = ((rdp_state->tile[i].th >> 2) - (rdp_state->tile[i].tl >> 2)) & 0x3ff;
 }
 
 
 INLINE void calculate_tile_derivs(UINT32 i)
 {
-    tile[i].f.clampens = tile[i].cs || !tile[i].mask_s;
-    tile[i].f.clampent = tile[i].ct || !tile[i].mask_t;
-    tile[i].f.masksclamped = tile[i].mask_s <= 10 ? tile[i].mask_s : 10;
-    tile[i].f.masktclamped = tile[i].mask_t <= 10 ? tile[i].mask_t : 10;
-    tile[i].f.notlutswitch = (tile[i].format << 2) | tile[i].size;
-    tile[i].f.tlutswitch = (tile[i].size << 2) | ((tile[i].format + 2) & 3);
+    rdp_state->tile[i].f.clampens = rdp_state->tile[i].cs || !rdp_state->tile[i].mask_s;
+    rdp_state->tile[i].f.clampent = rdp_state->tile[i].ct || !rdp_state->tile[i].mask_t;
+    rdp_state->tile[i].f.masksclamped = rdp_state->tile[i].mask_s <= 10 ? rdp_state->tile[i].mask_s : 10;
+    rdp_state->tile[i].f.masktclamped = rdp_state->tile[i].mask_t <= 10 ? rdp_state->tile[i].mask_t : 10;
+    rdp_state->tile[i].f.notlutswitch = (rdp_state->tile[i].format << 2) | rdp_state->tile[i].size;
+    rdp_state->tile[i].f.tlutswitch = (rdp_state->tile[i].size << 2) | ((rdp_state->tile[i].format + 2) & 3);
 }
 
 static void rgb_dither_complete(int* r, int* g, int* b, int dith)
@@ -6253,7 +6211,7 @@ static void rgb_dither_complete(int* r, int* g, int* b, int dith)
         else
             *r = (*r & 0xf8) + 8;
     }
-    if (other_modes.rgb_dither_sel != 2)
+    if (rdp_state->other_modes.rgb_dither_sel != 2)
     {
         if ((*g & 7) > dith)
         {
@@ -6298,8 +6256,8 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
 {
     int dithindex;
 
-    noise = ((irand() & 7) << 6) | 0x20;
-    switch(other_modes.f.rgb_alpha_dither)
+    rdp_state->noise = ((irand() & 7) << 6) | 0x20;
+    switch(rdp_state->other_modes.f.rgb_alpha_dither)
     {
     case 0:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6313,7 +6271,7 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
     case 2:
         dithindex = ((y & 3) << 2) | (x & 3);
         *cdith = magic_matrix[dithindex];
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 3:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6332,7 +6290,7 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
     case 6:
         dithindex = ((y & 3) << 2) | (x & 3);
         *cdith = bayer_matrix[dithindex];
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 7:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6351,7 +6309,7 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
         break;
     case 10:
         *cdith = irand() & 7;
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 11:
         *cdith = irand() & 7;
@@ -6369,7 +6327,7 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
         break;
     case 14:
         *cdith = 7;
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 15:
         *cdith = 7;
@@ -6382,7 +6340,7 @@ static void get_dither_noise_complete(int x, int y, int* cdith, int* adith)
 static void get_dither_only(int x, int y, int* cdith, int* adith)
 {
     int dithindex; 
-    switch(other_modes.f.rgb_alpha_dither)
+    switch(rdp_state->other_modes.f.rgb_alpha_dither)
     {
     case 0:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6396,7 +6354,7 @@ static void get_dither_only(int x, int y, int* cdith, int* adith)
     case 2:
         dithindex = ((y & 3) << 2) | (x & 3);
         *cdith = magic_matrix[dithindex];
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 3:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6415,7 +6373,7 @@ static void get_dither_only(int x, int y, int* cdith, int* adith)
     case 6:
         dithindex = ((y & 3) << 2) | (x & 3);
         *cdith = bayer_matrix[dithindex];
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 7:
         dithindex = ((y & 3) << 2) | (x & 3);
@@ -6434,7 +6392,7 @@ static void get_dither_only(int x, int y, int* cdith, int* adith)
         break;
     case 10:
         *cdith = irand() & 7;
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 11:
         *cdith = irand() & 7;
@@ -6452,7 +6410,7 @@ static void get_dither_only(int x, int y, int* cdith, int* adith)
         break;
     case 14:
         *cdith = 7;
-        *adith = (noise >> 6) & 7;
+        *adith = (rdp_state->noise >> 6) & 7;
         break;
     case 15:
         *cdith = 7;
@@ -6485,11 +6443,11 @@ static void rgbaz_correct_clip(int offx, int offy, int r, int g, int b, int a, i
     }
     else
     {
-        summand_r = offx * spans_cd_rgba[0] + offy * spans_d_rgba_dy[0];
-        summand_g = offx * spans_cd_rgba[1] + offy * spans_d_rgba_dy[1];
-        summand_b = offx * spans_cd_rgba[2] + offy * spans_d_rgba_dy[2];
-        summand_a = offx * spans_cd_rgba[3] + offy * spans_d_rgba_dy[3];
-        summand_z = offx * spans_cdz + offy * spans_d_stwz_dy[3];
+        summand_r = offx * rdp_state->spans_cd_rgba[0] + offy * rdp_state->spans_d_rgba_dy[0];
+        summand_g = offx * rdp_state->spans_cd_rgba[1] + offy * rdp_state->spans_d_rgba_dy[1];
+        summand_b = offx * rdp_state->spans_cd_rgba[2] + offy * rdp_state->spans_d_rgba_dy[2];
+        summand_a = offx * rdp_state->spans_cd_rgba[3] + offy * rdp_state->spans_d_rgba_dy[3];
+        summand_z = offx * rdp_state->spans_cdz + offy * rdp_state->spans_d_stwz_dy[3];
 
         r = ((r << 2) + summand_r) >> 4;
         g = ((g << 2) + summand_g) >> 4;
@@ -6499,10 +6457,10 @@ static void rgbaz_correct_clip(int offx, int offy, int r, int g, int b, int a, i
     }
 
     
-    shade_color.r = special_9bit_clamptable[r & 0x1ff];
-    shade_color.g = special_9bit_clamptable[g & 0x1ff];
-    shade_color.b = special_9bit_clamptable[b & 0x1ff];
-    shade_color.a = special_9bit_clamptable[a & 0x1ff];
+    rdp_state->shade_color.r = special_9bit_clamptable[r & 0x1ff];
+    rdp_state->shade_color.g = special_9bit_clamptable[g & 0x1ff];
+    rdp_state->shade_color.b = special_9bit_clamptable[b & 0x1ff];
+    rdp_state->shade_color.a = special_9bit_clamptable[a & 0x1ff];
     
     
     
@@ -6652,7 +6610,7 @@ static void tclod_2cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
 
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         
         
@@ -6660,11 +6618,11 @@ static void tclod_2cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
         
         
         
-        nextys = (s + spans_d_stwz_dy[0]) >> 16;
-        nextyt = (t + spans_d_stwz_dy[1]) >> 16;
-        nextysw = (w + spans_d_stwz_dy[2]) >> 16;
+        nextys = (s + rdp_state->spans_d_stwz_dy[0]) >> 16;
+        nextyt = (t + rdp_state->spans_d_stwz_dy[1]) >> 16;
+        nextysw = (w + rdp_state->spans_d_stwz_dy[2]) >> 16;
 
-        tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
+        rdp_state->tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
 
         lodclamp = (initt & 0x60000) || (nextt & 0x60000) || (inits & 0x60000) || (nexts & 0x60000) || (nextys & 0x60000) || (nextyt & 0x60000);
         
@@ -6677,14 +6635,14 @@ static void tclod_2cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
         lodfrac_lodtile_signals(lodclamp, lod, &l_tile, &magnify, &distant);
 
         
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en)
             {
                 *t1 = (prim_tile + l_tile) & 7;
-                if (!(distant || (!other_modes.sharpen_tex_en && magnify)))
+                if (!(distant || (!rdp_state->other_modes.sharpen_tex_en && magnify)))
                     *t2 = (*t1 + 1) & 7;
                 else
                     *t2 = *t1;
@@ -6718,17 +6676,17 @@ static void tclod_2cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
 
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         nextsw = (w + dwinc) >> 16;
         nexts = (s + dsinc) >> 16;
         nextt = (t + dtinc) >> 16;
-        nextys = (s + spans_d_stwz_dy[0]) >> 16;
-        nextyt = (t + spans_d_stwz_dy[1]) >> 16;
-        nextysw = (w + spans_d_stwz_dy[2]) >> 16;
+        nextys = (s + rdp_state->spans_d_stwz_dy[0]) >> 16;
+        nextyt = (t + rdp_state->spans_d_stwz_dy[1]) >> 16;
+        nextysw = (w + rdp_state->spans_d_stwz_dy[2]) >> 16;
 
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
 
         lodclamp = (initt & 0x60000) || (nextt & 0x60000) || (inits & 0x60000) || (nexts & 0x60000) || (nextys & 0x60000) || (nextyt & 0x60000);
 
@@ -6737,14 +6695,14 @@ static void tclod_2cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
 
         lodfrac_lodtile_signals(lodclamp, lod, &l_tile, &magnify, &distant);
     
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en)
             {
                 *t1 = (prim_tile + l_tile) & 7;
-                if (!(distant || (!other_modes.sharpen_tex_en && magnify)))
+                if (!(distant || (!rdp_state->other_modes.sharpen_tex_en && magnify)))
                     *t2 = (*t1 + 1) & 7;
                 else
                     *t2 = *t1;
@@ -6778,17 +6736,17 @@ static void tclod_2cycle_current_notexel1(INT32* sss, INT32* sst, INT32 s, INT32
 
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         nextsw = (w + dwinc) >> 16;
         nexts = (s + dsinc) >> 16;
         nextt = (t + dtinc) >> 16;
-        nextys = (s + spans_d_stwz_dy[0]) >> 16;
-        nextyt = (t + spans_d_stwz_dy[1]) >> 16;
-        nextysw = (w + spans_d_stwz_dy[2]) >> 16;
+        nextys = (s + rdp_state->spans_d_stwz_dy[0]) >> 16;
+        nextyt = (t + rdp_state->spans_d_stwz_dy[1]) >> 16;
+        nextysw = (w + rdp_state->spans_d_stwz_dy[2]) >> 16;
 
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
 
         lodclamp = (initt & 0x60000) || (nextt & 0x60000) || (inits & 0x60000) || (nexts & 0x60000) || (nextys & 0x60000) || (nextyt & 0x60000);
 
@@ -6797,11 +6755,11 @@ static void tclod_2cycle_current_notexel1(INT32* sss, INT32* sst, INT32 s, INT32
 
         lodfrac_lodtile_signals(lodclamp, lod, &l_tile, &magnify, &distant);
     
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en || magnify)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en || magnify)
                 *t1 = (prim_tile + l_tile) & 7;
             else
                 *t1 = (prim_tile + l_tile + 1) & 7;
@@ -6822,17 +6780,17 @@ static void tclod_2cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
 
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         nextsw = (w + dwinc) >> 16;
         nexts = (s + dsinc) >> 16;
         nextt = (t + dtinc) >> 16;
-        nextys = (s + spans_d_stwz_dy[0]) >> 16;
-        nextyt = (t + spans_d_stwz_dy[1]) >> 16;
-        nextysw = (w + spans_d_stwz_dy[2]) >> 16;
+        nextys = (s + rdp_state->spans_d_stwz_dy[0]) >> 16;
+        nextyt = (t + rdp_state->spans_d_stwz_dy[1]) >> 16;
+        nextysw = (w + rdp_state->spans_d_stwz_dy[2]) >> 16;
 
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(nextys, nextyt, nextysw, &nextys, &nextyt);
     
         lodclamp = (initt & 0x60000) || (nextt & 0x60000) || (inits & 0x60000) || (nexts & 0x60000) || (nextys & 0x60000) || (nextyt & 0x60000);
 
@@ -6842,17 +6800,17 @@ static void tclod_2cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
         
         if ((lod & 0x4000) || lodclamp)
             lod = 0x7fff;
-        else if (lod < min_level)
-            lod = min_level;
+        else if (lod < rdp_state->min_level)
+            lod = rdp_state->min_level;
                         
         magnify = (lod < 32) ? 1: 0;
         l_tile =  log2table[(lod >> 5) & 0xff];
-        distant = ((lod & 0x6000) || (l_tile >= max_level)) ? 1 : 0;
+        distant = ((lod & 0x6000) || (l_tile >= rdp_state->max_level)) ? 1 : 0;
 
         *prelodfrac = ((lod << 3) >> l_tile) & 0xff;
 
         
-        if(!other_modes.sharpen_tex_en && !other_modes.detail_tex_en)
+        if(!rdp_state->other_modes.sharpen_tex_en && !rdp_state->other_modes.detail_tex_en)
         {
             if (distant)
                 *prelodfrac = 0xff;
@@ -6863,17 +6821,17 @@ static void tclod_2cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
         
         
 
-        if(other_modes.sharpen_tex_en && magnify)
+        if(rdp_state->other_modes.sharpen_tex_en && magnify)
             *prelodfrac |= 0x100;
 
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en)
             {
                 *t1 = (prim_tile + l_tile) & 7;
-                if (!(distant || (!other_modes.sharpen_tex_en && magnify)))
+                if (!(distant || (!rdp_state->other_modes.sharpen_tex_en && magnify)))
                     *t2 = (*t1 + 1) & 7;
                 else
                     *t2 = *t1;
@@ -6912,12 +6870,12 @@ static void tclod_1cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
     
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         int nextscan = scanline + 1;
 
         
-        if (span[nextscan].validline)
+        if (rdp_state->span[nextscan].validline)
         {
             if (!sigs->endspan || !sigs->longspan)
             {
@@ -6936,9 +6894,9 @@ static void tclod_1cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
             }
             else
             {
-                fars = (span[nextscan].stwz[0] + dsinc) >> 16;
-                fart = (span[nextscan].stwz[1] + dtinc) >> 16;
-                farsw = (span[nextscan].stwz[2] + dwinc) >> 16;
+                fars = (rdp_state->span[nextscan].stwz[0] + dsinc) >> 16;
+                fart = (rdp_state->span[nextscan].stwz[1] + dtinc) >> 16;
+                farsw = (rdp_state->span[nextscan].stwz[2] + dwinc) >> 16;
             }
         }
         else
@@ -6948,7 +6906,7 @@ static void tclod_1cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
             fart = (t + (dtinc << 1)) >> 16;
         }
 
-        tcdiv_ptr(fars, fart, farsw, &fars, &fart);
+        rdp_state->tcdiv_ptr(fars, fart, farsw, &fars, &fart);
 
         lodclamp = (fart & 0x60000) || (nextt & 0x60000) || (fars & 0x60000) || (nexts & 0x60000);
         
@@ -6959,14 +6917,14 @@ static void tclod_1cycle_current(INT32* sss, INT32* sst, INT32 nexts, INT32 next
 
         lodfrac_lodtile_signals(lodclamp, lod, &l_tile, &magnify, &distant);
     
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
+                l_tile = rdp_state->max_level;
 
             
             
-            if (!other_modes.detail_tex_en || magnify)
+            if (!rdp_state->other_modes.detail_tex_en || magnify)
                 *t1 = (prim_tile + l_tile) & 7;
             else
                 *t1 = (prim_tile + l_tile + 1) & 7;
@@ -6985,11 +6943,11 @@ static void tclod_1cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
     
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
 
         int nextscan = scanline + 1;
-        if (span[nextscan].validline)
+        if (rdp_state->span[nextscan].validline)
         {
             if (!sigs->endspan || !sigs->longspan)
             {
@@ -7012,12 +6970,12 @@ static void tclod_1cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
             }
             else
             {
-                nexts = span[nextscan].stwz[0] >> 16;
-                nextt = span[nextscan].stwz[1] >> 16;
-                nextsw = span[nextscan].stwz[2] >> 16;
-                fars = (span[nextscan].stwz[0] + dsinc) >> 16;
-                fart = (span[nextscan].stwz[1] + dtinc) >> 16;
-                farsw = (span[nextscan].stwz[2] + dwinc) >> 16;
+                nexts = rdp_state->span[nextscan].stwz[0] >> 16;
+                nextt = rdp_state->span[nextscan].stwz[1] >> 16;
+                nextsw = rdp_state->span[nextscan].stwz[2] >> 16;
+                fars = (rdp_state->span[nextscan].stwz[0] + dsinc) >> 16;
+                fart = (rdp_state->span[nextscan].stwz[1] + dtinc) >> 16;
+                farsw = (rdp_state->span[nextscan].stwz[2] + dwinc) >> 16;
             }
         }
         else
@@ -7030,8 +6988,8 @@ static void tclod_1cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
             fart = (t + (dtinc << 1)) >> 16;
         }
 
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(fars, fart, farsw, &fars, &fart);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(fars, fart, farsw, &fars, &fart);
 
         lodclamp = (fart & 0x60000) || (nextt & 0x60000) || (fars & 0x60000) || (nexts & 0x60000);
 
@@ -7039,11 +6997,11 @@ static void tclod_1cycle_current_simple(INT32* sss, INT32* sst, INT32 s, INT32 t
 
         lodfrac_lodtile_signals(lodclamp, lod, &l_tile, &magnify, &distant);
     
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en || magnify)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en || magnify)
                 *t1 = (prim_tile + l_tile) & 7;
             else
                 *t1 = (prim_tile + l_tile + 1) & 7;
@@ -7060,12 +7018,12 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
     
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.f.dolod)
+    if (rdp_state->other_modes.f.dolod)
     {
         
         int nextscan = scanline + 1;
         
-        if (span[nextscan].validline)
+        if (rdp_state->span[nextscan].validline)
         {
             if (!sigs->nextspan)
             {
@@ -7090,9 +7048,9 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
                 }
                 else
                 {
-                    nexts = span[nextscan].stwz[0];
-                    nextt = span[nextscan].stwz[1];
-                    nextsw = span[nextscan].stwz[2];
+                    nexts = rdp_state->span[nextscan].stwz[0];
+                    nextt = rdp_state->span[nextscan].stwz[1];
+                    nextsw = rdp_state->span[nextscan].stwz[2];
                     fart = (nextt + dtinc) >> 16;
                     fars = (nexts + dsinc) >> 16;
                     farsw = (nextsw + dwinc) >> 16;
@@ -7105,9 +7063,9 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
             {
                 if (sigs->longspan || sigs->midspan)
                 {
-                    nexts = span[nextscan].stwz[0] + dsinc;
-                    nextt = span[nextscan].stwz[1] + dtinc;
-                    nextsw = span[nextscan].stwz[2] + dwinc;
+                    nexts = rdp_state->span[nextscan].stwz[0] + dsinc;
+                    nextt = rdp_state->span[nextscan].stwz[1] + dtinc;
+                    nextsw = rdp_state->span[nextscan].stwz[2] + dwinc;
                     fart = (nextt + dtinc) >> 16;
                     fars = (nexts + dsinc) >> 16;
                     farsw = (nextsw + dwinc) >> 16;
@@ -7136,8 +7094,8 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
             fart = (t + (dtinc << 1)) >> 16;
         }
 
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(fars, fart, farsw, &fars, &fart);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(fars, fart, farsw, &fars, &fart);
 
         lodclamp = (fart & 0x60000) || (nextt & 0x60000) || (fars & 0x60000) || (nexts & 0x60000);
         
@@ -7147,17 +7105,17 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
         
         if ((lod & 0x4000) || lodclamp)
             lod = 0x7fff;
-        else if (lod < min_level)
-            lod = min_level;
+        else if (lod < rdp_state->min_level)
+            lod = rdp_state->min_level;
                     
         magnify = (lod < 32) ? 1: 0;
         l_tile =  log2table[(lod >> 5) & 0xff];
-        distant = ((lod & 0x6000) || (l_tile >= max_level)) ? 1 : 0;
+        distant = ((lod & 0x6000) || (l_tile >= rdp_state->max_level)) ? 1 : 0;
 
         *prelodfrac = ((lod << 3) >> l_tile) & 0xff;
 
         
-        if(!other_modes.sharpen_tex_en && !other_modes.detail_tex_en)
+        if(!rdp_state->other_modes.sharpen_tex_en && !rdp_state->other_modes.detail_tex_en)
         {
             if (distant)
                 *prelodfrac = 0xff;
@@ -7165,14 +7123,14 @@ static void tclod_1cycle_next(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w,
                 *prelodfrac = 0;
         }
 
-        if(other_modes.sharpen_tex_en && magnify)
+        if(rdp_state->other_modes.sharpen_tex_en && magnify)
             *prelodfrac |= 0x100;
 
-        if (other_modes.tex_lod_en)
+        if (rdp_state->other_modes.tex_lod_en)
         {
             if (distant)
-                l_tile = max_level;
-            if (!other_modes.detail_tex_en || magnify)
+                l_tile = rdp_state->max_level;
+            if (!rdp_state->other_modes.detail_tex_en || magnify)
                 *t1 = (prim_tile + l_tile) & 7;
             else
                 *t1 = (prim_tile + l_tile + 1) & 7;
@@ -7193,7 +7151,7 @@ static void tclod_copy(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w, INT32
 
     tclod_tcclamp(sss, sst);
 
-    if (other_modes.tex_lod_en)
+    if (rdp_state->other_modes.tex_lod_en)
     {
         
         
@@ -7205,8 +7163,8 @@ static void tclod_copy(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w, INT32
         fars = (s + (dsinc << 1)) >> 16;
         fart = (t + (dtinc << 1)) >> 16;
     
-        tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
-        tcdiv_ptr(fars, fart, farsw, &fars, &fart);
+        rdp_state->tcdiv_ptr(nexts, nextt, nextsw, &nexts, &nextt);
+        rdp_state->tcdiv_ptr(fars, fart, farsw, &fars, &fart);
 
         lodclamp = (fart & 0x60000) || (nextt & 0x60000) || (fars & 0x60000) || (nexts & 0x60000);
 
@@ -7214,17 +7172,17 @@ static void tclod_copy(INT32* sss, INT32* sst, INT32 s, INT32 t, INT32 w, INT32
 
         if ((lod & 0x4000) || lodclamp)
             lod = 0x7fff;
-        else if (lod < min_level)
-            lod = min_level;
+        else if (lod < rdp_state->min_level)
+            lod = rdp_state->min_level;
                         
         magnify = (lod < 32) ? 1: 0;
         l_tile =  log2table[(lod >> 5) & 0xff];
-        distant = ((lod & 0x6000) || (l_tile >= max_level)) ? 1 : 0;
+        distant = ((lod & 0x6000) || (l_tile >= rdp_state->max_level)) ? 1 : 0;
 
         if (distant)
-            l_tile = max_level;
+            l_tile = rdp_state->max_level;
     
-        if (!other_modes.detail_tex_en || magnify)
+        if (!rdp_state->other_modes.detail_tex_en || magnify)
             *t1 = (prim_tile + l_tile) & 7;
         else
             *t1 = (prim_tile + l_tile + 1) & 7;
@@ -7236,7 +7194,7 @@ STRICTINLINE void get_texel1_1cycle(INT32* s1, INT32* t1, INT32 s, INT32 t, INT3
 {
     INT32 nexts, nextt, nextsw;
     
-    if (!sigs->endspan || !sigs->longspan || !span[scanline + 1].validline)
+    if (!sigs->endspan || !sigs->longspan || !rdp_state->span[scanline + 1].validline)
     {
     
     
@@ -7248,11 +7206,11 @@ STRICTINLINE void get_texel1_1cycle(INT32* s1, INT32* t1, INT32 s, INT32 t, INT3
     {
         INT32 nextscan = scanline + 1;
 
-        nexts = span[nextscan].stwz[0] >> 16;
-        nextt = span[nextscan].stwz[1] >> 16;
-        nextsw = span[nextscan].stwz[2] >> 16;
+        nexts = rdp_state->span[nextscan].stwz[0] >> 16;
+        nextt = rdp_state->span[nextscan].stwz[1] >> 16;
+        nextsw = rdp_state->span[nextscan].stwz[2] >> 16;
     }
-    tcdiv_ptr(nexts, nextt, nextsw, s1, t1);
+    rdp_state->tcdiv_ptr(nexts, nextt, nextsw, s1, t1);
     return;
 }
 
@@ -7263,7 +7221,7 @@ STRICTINLINE void get_nexttexel0_2cycle(INT32* s1, INT32* t1, INT32 s, INT32 t,
     nexts = (s + dsinc) >> 16;
     nextt = (t + dtinc) >> 16;
 
-    tcdiv_ptr(nexts, nextt, nextsw, s1, t1);
+    rdp_state->tcdiv_ptr(nexts, nextt, nextsw, s1, t1);
 }
 
 
@@ -7347,17 +7305,17 @@ STRICTINLINE void lodfrac_lodtile_signals(int lodclamp, INT32 lod, UINT32* l_til
     
     if ((lod & 0x4000) || lodclamp)
         lod = 0x7fff;
-    else if (lod < min_level)
-        lod = min_level;
+    else if (lod < rdp_state->min_level)
+        lod = rdp_state->min_level;
                         
     mag = (lod < 32) ? 1: 0;
     ltil=  log2table[(lod >> 5) & 0xff];
-    dis = ((lod & 0x6000) || (ltil >= max_level)) ? 1 : 0;
+    dis = ((lod & 0x6000) || (ltil >= rdp_state->max_level)) ? 1 : 0;
                         
     lf = ((lod << 3) >> ltil) & 0xff;
 
     
-    if(!other_modes.sharpen_tex_en && !other_modes.detail_tex_en)
+    if(!rdp_state->other_modes.sharpen_tex_en && !rdp_state->other_modes.detail_tex_en)
     {
         if (dis)
             lf = 0xff;
@@ -7368,11 +7326,11 @@ STRICTINLINE void lodfrac_lodtile_signals(int lodclamp, INT32 lod, UINT32* l_til
     
     
 
-    if(other_modes.sharpen_tex_en && mag)
+    if(rdp_state->other_modes.sharpen_tex_en && mag)
         lf |= 0x100;
 
     *distant = dis;
     *l_tile = ltil;
     *magnify = mag;
-    lod_frac = lf;
+    rdp_state->lod_frac = lf;
 }
@@ -7,6 +7,7 @@
 #include "rdp.h"
 #include "m64p_types.h"
 #include "m64p_config.h"
+#include "main/profile.h"
 
 extern unsigned int screen_width, screen_height;
 extern uint32_t screen_pitch;
@@ -83,7 +84,9 @@ EXPORT void CALL angrylionProcessDList(void)
 
 EXPORT void CALL angrylionProcessRDPList(void)
 {
+    timed_section_start(TIMED_SECTION_RDP);
     process_RDP_list();
+    timed_section_end(TIMED_SECTION_RDP);
     return;
 }
 
@@ -137,7 +140,12 @@ EXPORT void CALL angrylionUpdateScreen(void)
         return;
     counter = 0;
 #endif
+    timed_section_start(TIMED_SECTION_RDP);
+    flush_RDP_list();
+    timed_section_end(TIMED_SECTION_RDP);
+    timed_section_start(TIMED_SECTION_VI);
     rdp_update();
+    timed_section_end(TIMED_SECTION_VI);
     retro_return(true);
 #if 0
     if (step != 0)
@@ -168,6 +176,7 @@ EXPORT void CALL angrylionFBWrite(unsigned int addr, unsigned int size)
 
 EXPORT void CALL angrylionFBRead(unsigned int addr)
 {
+    flush_RDP_list();
 }
 
 EXPORT void CALL angrylionFBGetFrameBufferInfo(void *pinfo)
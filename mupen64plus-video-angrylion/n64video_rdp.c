@@ -1,13 +1,58 @@
+#include <string.h>
 #include "z64.h"
 #include "vi.h"
 #include "rdp.h"
 
-static int cmd_cur;
+#ifdef HAVE_RDP_THREADS
+#include <stdlib.h>
+#include <pthread.h>
+#endif
+
 static int cmd_ptr; /* for 64-bit elements, always <= +0x7FFF */
+static int cmd_done; /* first command not yet replayed by the worker threads */
 
 /* static DP_FIFO cmd_fifo; */
 static DP_FIFO cmd_data[0x0003FFFF/sizeof(i64) + 1];
 
+int render_threads = 1;
+int rdp_threads = 1;
+
+#ifdef HAVE_RDP_THREADS
+/*
+ * With more than one render thread, process_RDP_list only buffers commands.
+ * At each sync point all the workers, the emulation thread being number 0,
+ * replay the buffered commands into their own RDP_STATE and draw only the
+ * scanlines where (y % rdp_threads == rdp_thread_index).
+ */
+#define MAX_RDP_THREADS     16
+
+static pthread_t rdp_worker[MAX_RDP_THREADS];
+static RDP_STATE* rdp_worker_state[MAX_RDP_THREADS];
+static pthread_mutex_t rdp_worker_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rdp_worker_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t rdp_worker_idle = PTHREAD_COND_INITIALIZER;
+static unsigned int replay_serial;
+static int replay_begin, replay_end;
+static int workers_busy;
+static int workers_quit;
+
+/*
+ * The little of the RDP state that the emulation thread still has to track
+ * while commands are only being buffered:  where the pending primitives may
+ * have drawn to, so that a texture load from there can sync first.
+ */
+static struct {
+    UINT32 ti_address;
+    int ti_size, ti_width;
+    UINT32 fb_address;
+    int fb_size, fb_width;
+    UINT32 zb_address;
+    int clip_yl;
+    int z_update_en;
+    UINT32 dirty_lo[2], dirty_hi[2]; /* color and depth image */
+} deferred;
+#endif
+
 static void invalid(void);
 static void noop(void);
 static void tri_noshade(void);
@@ -50,6 +95,9 @@ static NOINLINE void draw_triangle(int shade, int texture, int zbuffer);
 NOINLINE static void render_spans(
     int yhlimit, int yllimit, int tilenum, int flip);
 STRICTINLINE static u16 normalize_dzpix(u16 sum);
+#ifdef HAVE_RDP_THREADS
+static void defer_command(int command);
+#endif
 
 static void (*const rdp_command_table[64])(void) = {
     noop              ,invalid           ,invalid           ,invalid           ,
@@ -200,6 +248,15 @@ void process_RDP_list(void)
         return;
     length = (unsigned)(length) / sizeof(i64);
     if ((cmd_ptr + length) & ~(0x0003FFFF / sizeof(i64)))
+    { /* Make room by dropping every command that has been run already. */
+        flush_RDP_list();
+        memmove(
+            &cmd_data[0], &cmd_data[rdp_state->cmd_cur],
+            (cmd_ptr - rdp_state->cmd_cur) * sizeof(DP_FIFO));
+        cmd_ptr -= rdp_state->cmd_cur;
+        rdp_state->cmd_cur = cmd_done = 0;
+    }
+    if ((cmd_ptr + length) & ~(0x0003FFFF / sizeof(i64)))
     {
         DisplayError("ProcessRDPList\nOut of command cache memory.");
         return;
@@ -234,25 +291,38 @@ void process_RDP_list(void)
 #endif
     cmd_ptr += (DP_END - DP_CURRENT) / sizeof(i64); /* += length */
     if (rdp_pipeline_crashed != 0)
+    {
+        flush_RDP_list();
         goto exit_a;
+    }
 
-    while (cmd_cur - cmd_ptr < 0)
+    while (rdp_state->cmd_cur - cmd_ptr < 0)
     {
         int command, cmd_length;
 
-        command = (cmd_data[cmd_cur + 0].UW32[0] >> 24) % 64;
+        command = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] >> 24) % 64;
         cmd_length = sizeof(i64)/sizeof(i64) * DP_CMD_LEN_W[command];
 #ifdef TRACE_DP_COMMANDS
         ++cmd_count[command];
 #endif
-        if (cmd_ptr - cmd_cur - cmd_length < 0)
+        if (cmd_ptr - rdp_state->cmd_cur - cmd_length < 0)
             goto exit_b;
+#ifdef HAVE_RDP_THREADS
+        if (rdp_threads > 1)
+            defer_command(command);
+        else
+#endif
         rdp_command_table[command]();
-        cmd_cur += cmd_length;
+        rdp_state->cmd_cur += cmd_length;
     };
+#ifdef HAVE_RDP_THREADS
+    if (rdp_threads > 1 && cmd_done != rdp_state->cmd_cur)
+        goto exit_b; /* keep the pending commands for the next sync point */
+#endif
 exit_a:
     cmd_ptr = 0;
-    cmd_cur = 0;
+    rdp_state->cmd_cur = 0;
+    cmd_done = 0;
 exit_b:
     *GET_GFX_INFO(DPC_START_REG)
   = *GET_GFX_INFO(DPC_CURRENT_REG)
@@ -260,11 +330,235 @@ exit_b:
     return;
 }
 
+#ifdef HAVE_RDP_THREADS
+static void replay_commands(int begin, int end)
+{
+    int command;
+
+    for (rdp_state->cmd_cur = begin; rdp_state->cmd_cur < end; rdp_state->cmd_cur += DP_CMD_LEN_W[command])
+    {
+        command = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] >> 24) % 64;
+        rdp_command_table[command]();
+    }
+    return;
+}
+
+static void mark_dirty(int image, UINT32 lo, UINT32 hi)
+{
+    if (deferred.dirty_lo[image] >= deferred.dirty_hi[image])
+    {
+        deferred.dirty_lo[image] = lo;
+        deferred.dirty_hi[image] = hi;
+        return;
+    }
+    if (deferred.dirty_lo[image] > lo)
+        deferred.dirty_lo[image] = lo;
+    if (deferred.dirty_hi[image] < hi)
+        deferred.dirty_hi[image] = hi;
+    return;
+}
+
+static int is_dirty(UINT32 lo, UINT32 hi)
+{
+    register int image;
+
+    for (image = 0; image < 2; image++)
+        if (lo < deferred.dirty_hi[image] && deferred.dirty_lo[image] < hi)
+            return 1;
+    return 0;
+}
+
+/*
+ * Called instead of the command handler when commands are deferred to the
+ * worker threads.  Besides shadowing the image addresses, this forces a sync
+ * wherever the emulation thread, or a following command, could otherwise see
+ * memory the workers have not finished drawing to.
+ */
+static void defer_command(int command)
+{
+    const DP_FIFO cmd_fifo = cmd_data[rdp_state->cmd_cur + 0];
+    UINT32 lo, hi;
+    int rows;
+
+    switch (command)
+    {
+    case 0x29: /* sync_full */
+        flush_RDP_list();
+        sync_full();
+        cmd_done = rdp_state->cmd_cur + DP_CMD_LEN_W[command];
+        break;
+    case 0x3F: /* set_color_image:  the scanlines are split by image rows */
+        flush_RDP_list();
+        deferred.fb_size    = (cmd_fifo.UW32[0] & 0x00180000) >> (51 - 32);
+        deferred.fb_width   = (cmd_fifo.UW32[0] & 0x000003FF) + 1;
+        deferred.fb_address = cmd_fifo.UW32[1] & 0x00FFFFFF;
+        break;
+    case 0x3E: /* set_mask_image */
+        deferred.zb_address = cmd_fifo.UW32[1] & 0x00FFFFFF;
+        break;
+    case 0x3D: /* set_texture_image */
+        deferred.ti_size    = (cmd_fifo.UW32[0] & 0x00180000) >> (51 - 32);
+        deferred.ti_width   = (cmd_fifo.UW32[0] & 0x000003FF) + 1;
+        deferred.ti_address = cmd_fifo.UW32[1] & 0x00FFFFFF;
+        break;
+    case 0x2D: /* set_scissor */
+        deferred.clip_yl = cmd_fifo.UW32[1] & 0x00000FFF;
+        break;
+    case 0x2F: /* set_other_modes */
+        deferred.z_update_en = !!(cmd_fifo.UW32[1] & 0x00000020);
+        break;
+    case 0x30: /* load_tlut */
+    case 0x34: /* load_tile */
+        rows = ((cmd_fifo.UW32[1] & 0x00000FFF) >> 2) + 1;
+        lo = deferred.ti_address;
+        hi = lo + ((rows*deferred.ti_width << deferred.ti_size) >> 1) + 8;
+        if (is_dirty(lo, hi))
+            flush_RDP_list();
+        break;
+    case 0x33: /* load_block */
+        rows = (cmd_fifo.UW32[0] & 0x00000FFF) >> 0;
+        lo = deferred.ti_address;
+        hi = rows*deferred.ti_width + ((cmd_fifo.UW32[1] & 0x00FFF000) >> 12);
+        hi = lo + (((hi + 1) << deferred.ti_size) >> 1) + 8;
+        if (is_dirty(lo, hi))
+            flush_RDP_list();
+        break;
+    case 0x08: case 0x09: case 0x0A: case 0x0B:
+    case 0x0C: case 0x0D: case 0x0E: case 0x0F:
+    case 0x24: /* tex_rect */
+    case 0x25: /* tex_rect_flip */
+    case 0x36: /* fill_rect */
+        rows = (deferred.clip_yl >> 2) + 1;
+        rows = (rows < 1024) ? rows : 1024;
+        lo = deferred.fb_address;
+        hi = lo + ((rows*deferred.fb_width << deferred.fb_size) >> 1);
+        mark_dirty(0, lo, hi);
+        if (deferred.z_update_en)
+        {
+            lo = deferred.zb_address;
+            hi = lo + rows*deferred.fb_width*sizeof(i16);
+            mark_dirty(1, lo, hi);
+        }
+        break;
+    }
+    return;
+}
+
+static void* rdp_worker_main(void* arg)
+{
+    const int index = (int)(intptr_t)arg;
+    unsigned int serial = 0;
+
+    rdp_state = rdp_worker_state[index];
+    rdp_init_state();
+    rdp_state->rdp_thread_index = index;
+
+    pthread_mutex_lock(&rdp_worker_lock);
+    for (;;)
+    {
+        while (serial == replay_serial && workers_quit == 0)
+            pthread_cond_wait(&rdp_worker_wake, &rdp_worker_lock);
+        if (workers_quit != 0)
+            break;
+        serial = replay_serial;
+        pthread_mutex_unlock(&rdp_worker_lock);
+
+        replay_commands(replay_begin, replay_end);
+
+        pthread_mutex_lock(&rdp_worker_lock);
+        if (--workers_busy == 0)
+            pthread_cond_signal(&rdp_worker_idle);
+    }
+    pthread_mutex_unlock(&rdp_worker_lock);
+    return NULL;
+}
+
+void rdp_threads_init(void)
+{
+    zerobuf(&deferred, sizeof(deferred));
+    deferred.clip_yl = rdp_state->__clip.yl;
+    cmd_done = 0;
+    rdp_state->rdp_thread_index = 0;
+    rdp_threads = 1;
+    replay_serial = 0;
+    workers_quit = 0;
+    while (rdp_threads < render_threads && rdp_threads < MAX_RDP_THREADS)
+    {
+        rdp_worker_state[rdp_threads] = (RDP_STATE*)malloc(sizeof(RDP_STATE));
+        if (rdp_worker_state[rdp_threads] == NULL)
+            break;
+        if (pthread_create(
+            &rdp_worker[rdp_threads], NULL, rdp_worker_main,
+            (void*)(intptr_t)rdp_threads) != 0)
+        {
+            free(rdp_worker_state[rdp_threads]);
+            rdp_worker_state[rdp_threads] = NULL;
+            break;
+        }
+        ++rdp_threads;
+    }
+    return;
+}
+
+void rdp_threads_close(void)
+{
+    register int i;
+
+    flush_RDP_list();
+    pthread_mutex_lock(&rdp_worker_lock);
+    workers_quit = 1;
+    pthread_cond_broadcast(&rdp_worker_wake);
+    pthread_mutex_unlock(&rdp_worker_lock);
+    for (i = 1; i < rdp_threads; i++)
+    {
+        pthread_join(rdp_worker[i], NULL);
+        free(rdp_worker_state[i]);
+        rdp_worker_state[i] = NULL;
+    }
+    rdp_threads = 1;
+    return;
+}
+
+/*
+ * Have all the workers run the commands buffered since the last sync point.
+ * Returns once every scanline has been drawn.
+ */
+void flush_RDP_list(void)
+{
+    if (rdp_threads < 2 || cmd_done == rdp_state->cmd_cur)
+        return;
+    pthread_mutex_lock(&rdp_worker_lock);
+    replay_begin = cmd_done;
+    replay_end = rdp_state->cmd_cur;
+    workers_busy = rdp_threads - 1;
+    ++replay_serial;
+    pthread_cond_broadcast(&rdp_worker_wake);
+    pthread_mutex_unlock(&rdp_worker_lock);
+
+    replay_commands(replay_begin, replay_end);
+
+    pthread_mutex_lock(&rdp_worker_lock);
+    while (workers_busy != 0)
+        pthread_cond_wait(&rdp_worker_idle, &rdp_worker_lock);
+    pthread_mutex_unlock(&rdp_worker_lock);
+
+    cmd_done = rdp_state->cmd_cur;
+    deferred.dirty_lo[0] = deferred.dirty_hi[0] = 0;
+    deferred.dirty_lo[1] = deferred.dirty_hi[1] = 0;
+    return;
+}
+#else
+void flush_RDP_list(void)
+{
+    return;
+}
+#endif
+
 static char invalid_command[] = "00\nDP reserved command.";
 static void invalid(void)
 {
     const unsigned int command
-      = (cmd_data[cmd_cur + 0].UW32[0] & 0x3F000000) >> 24;
+      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x3F000000) >> 24;
 
     invalid_command[0] = '0' | command >> 3;
     invalid_command[1] = '0' | command & 07;
@@ -338,6 +632,7 @@ static void tex_rect(void)
     int curcross;
     int allover, allunder, curover, curunder;
     int allinval;
+    int maxxmx = 0x000, minxhx = 0xFFF; /* reset at each scanline */
     register int j, k;
     i32 stwz[4];
     i32 d_stwz_dx[4];
@@ -346,21 +641,21 @@ static void tex_rect(void)
     i32 d_stwz_dxh[4];
     i32 xleft, xright;
     u8 xfrac;
-    const i32 clipxlshift = __clip.xl << 1;
-    const i32 clipxhshift = __clip.xh << 1;
+    const i32 clipxlshift = rdp_state->__clip.xl << 1;
+    const i32 clipxhshift = rdp_state->__clip.xh << 1;
 
-    xl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
-    yl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
-    tilenum = (cmd_data[cmd_cur + 0].UW32[1] & 0x07000000) >> 24;
-    xh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> 12;
-    yh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >>  0;
+    xl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
+    yl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
+    tilenum = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x07000000) >> 24;
+    xh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> 12;
+    yh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >>  0;
 
-    yl |= (other_modes.cycle_type & 2) ? 3 : 0; /* FILL OR COPY */
+    yl |= (rdp_state->other_modes.cycle_type & 2) ? 3 : 0; /* FILL OR COPY */
 
-    s    = (cmd_data[cmd_cur + 1].UW32[0] & 0xFFFF0000) >> 16;
-    t    = (cmd_data[cmd_cur + 1].UW32[0] & 0x0000FFFF) >>  0;
-    dsdx = (cmd_data[cmd_cur + 1].UW32[1] & 0xFFFF0000) >> 16;
-    dtdy = (cmd_data[cmd_cur + 1].UW32[1] & 0x0000FFFF) >>  0;
+    s    = (cmd_data[rdp_state->cmd_cur + 1].UW32[0] & 0xFFFF0000) >> 16;
+    t    = (cmd_data[rdp_state->cmd_cur + 1].UW32[0] & 0x0000FFFF) >>  0;
+    dsdx = (cmd_data[rdp_state->cmd_cur + 1].UW32[1] & 0xFFFF0000) >> 16;
+    dtdy = (cmd_data[rdp_state->cmd_cur + 1].UW32[1] & 0x0000FFFF) >>  0;
     
     dsdx = SIGN16(dsdx);
     dtdy = SIGN16(dtdy);
@@ -369,7 +664,7 @@ static void tex_rect(void)
     xhint = (unsigned)(xh) >> 2;
 
  /* edgewalker for primitives */
-    max_level = 0;
+    rdp_state->max_level = 0;
     xl = (xlint << 16) | (xl & 3)<<14;
     xl = SIGN(xl, 30);
     xh = (xhint << 16) | (xh & 3)<<14;
@@ -384,39 +679,39 @@ static void tex_rect(void)
     d_stwz_dy[0] = 0x00000000;
     d_stwz_dy[1] = dtdy << 11;
 
-    setzero_si128(spans_d_rgba);
-    spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
-    spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
-    spans_d_stwz[2] = 0x00000000;
-    spans_d_stwz[3] = 0x00000000;
+    setzero_si128(rdp_state->spans_d_rgba);
+    rdp_state->spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
+    rdp_state->spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
+    rdp_state->spans_d_stwz[2] = 0x00000000;
+    rdp_state->spans_d_stwz[3] = 0x00000000;
 
-    setzero_si128(spans_d_rgba_dy);
-    spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
-    spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
-    spans_d_stwz_dy[2] = 0x00000000;
-    spans_d_stwz_dy[3] = 0x00000000;
+    setzero_si128(rdp_state->spans_d_rgba_dy);
+    rdp_state->spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[2] = 0x00000000;
+    rdp_state->spans_d_stwz_dy[3] = 0x00000000;
 
-    setzero_si128(spans_cd_rgba);
-    spans_cdz = 0x00000000;
-    spans_dzpix = normalize_dzpix(0);
+    setzero_si128(rdp_state->spans_cd_rgba);
+    rdp_state->spans_cdz = 0x00000000;
+    rdp_state->spans_dzpix = normalize_dzpix(0);
 
     d_stwz_dxh[1] = 0x00000000;
-    if (other_modes.cycle_type == CYCLE_TYPE_COPY)
+    if (rdp_state->other_modes.cycle_type == CYCLE_TYPE_COPY)
         d_stwz_dxh[0] = 0x00000000;
     else
         d_stwz_dxh[0] = (d_stwz_dx[0] >> 8) & ~0x00000001;
 
     invaly = 1;
-    yllimit = (yl < __clip.yl) ? yl : __clip.yl;
+    yllimit = (yl < rdp_state->__clip.yl) ? yl : rdp_state->__clip.yl;
 
     ycur = yh & ~3;
     ylfar = yllimit | 3;
     if ((yl >> 2) > (ylfar >> 2))
         ylfar += 4;
     else if ((yllimit >> 2) >= 0 && (yllimit >> 2) < 1023)
-        span[(yllimit >> 2) + 1].validline = 0;
+        rdp_state->span[(yllimit >> 2) + 1].validline = 0;
 
-    yhlimit = (yh >= __clip.yh) ? yh : __clip.yh;
+    yhlimit = (yh >= rdp_state->__clip.yh) ? yh : rdp_state->__clip.yh;
 
     xleft = xl & ~0x00000001;
     xright = xh & ~0x00000001;
@@ -431,7 +726,6 @@ static void tex_rect(void)
     allinval = 1;
     for (k = ycur; k <= ylfar; k++)
     {
-        static int maxxmx, minxhx;
         int xrsc, xlsc, stickybit;
         const int yhclose = yhlimit & ~3;
         const int spix = k & 3;
@@ -460,7 +754,7 @@ static void tex_rect(void)
             xrsc = xrsc & 0x1FFF;
             curover |= (u32)~(xrsc - clipxlshift) >> 31;
             xrsc = curover ? clipxlshift : xrsc;
-            span[j].majorx[spix] = xrsc & 0x1FFF;
+            rdp_state->span[j].majorx[spix] = xrsc & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
@@ -474,14 +768,14 @@ static void tex_rect(void)
             xlsc &= 0x1FFF;
             curover |= (u32)~(xlsc - clipxlshift) >> 31;
             xlsc = curover ? clipxlshift : xlsc;
-            span[j].minorx[spix] = xlsc & 0x1FFF;
+            rdp_state->span[j].minorx[spix] = xlsc & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
             curcross = ((xleft&0x0FFFC000 ^ 0x08000000)
                      < (xright&0x0FFFC000 ^ 0x08000000));
             invaly |= curcross;
-            span[j].invalyscan[spix] = invaly;
+            rdp_state->span[j].invalyscan[spix] = invaly;
             allinval &= invaly;
             if (invaly != 0)
                 { /* branch */ }
@@ -495,20 +789,20 @@ static void tex_rect(void)
 
             if (spix == 0)
             {
-                span[j].unscrx = xright >> 16;
-                setzero_si128(span[j].rgba);
-                span[j].stwz[0] = (stwz[0] - xfrac*d_stwz_dxh[0]) & ~0x000003FF;
-                span[j].stwz[1] = stwz[1];
-                span[j].stwz[2] = 0x00000000;
-                span[j].stwz[3] = 0x00000000;
+                rdp_state->span[j].unscrx = xright >> 16;
+                setzero_si128(rdp_state->span[j].rgba);
+                rdp_state->span[j].stwz[0] = (stwz[0] - xfrac*d_stwz_dxh[0]) & ~0x000003FF;
+                rdp_state->span[j].stwz[1] = stwz[1];
+                rdp_state->span[j].stwz[2] = 0x00000000;
+                rdp_state->span[j].stwz[3] = 0x00000000;
             }
             else if (spix == 3)
             {
-                const int invalidline = (sckeepodd ^ j) & scfield
+                const int invalidline = (rdp_state->sckeepodd ^ j) & rdp_state->scfield
                                       | (allinval | allover | allunder);
-                span[j].lx = maxxmx;
-                span[j].rx = minxhx;
-                span[j].validline = invalidline ^ 1;
+                rdp_state->span[j].lx = maxxmx;
+                rdp_state->span[j].rx = minxhx;
+                rdp_state->span[j].validline = invalidline ^ 1;
              /* stwz[0] = (stwz[0] + 0x00000000) & ~0x000001FF; */
                 stwz[1] = (stwz[1] + d_stwz_de[1]) & ~0x000003FF;
             }
@@ -532,6 +826,7 @@ static void tex_rect_flip(void)
     int curcross;
     int allover, allunder, curover, curunder;
     int allinval;
+    int maxxmx = 0x000, minxhx = 0xFFF; /* reset at each scanline */
     register int j, k;
     i32 stwz[4];
     i32 d_stwz_dx[4];
@@ -540,21 +835,21 @@ static void tex_rect_flip(void)
     i32 d_stwz_dxh[4];
     i32 xleft, xright;
     u8 xfrac;
-    const i32 clipxlshift = __clip.xl << 1;
-    const i32 clipxhshift = __clip.xh << 1;
+    const i32 clipxlshift = rdp_state->__clip.xl << 1;
+    const i32 clipxhshift = rdp_state->__clip.xh << 1;
 
-    xl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
-    yl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
-    tilenum = (cmd_data[cmd_cur + 0].UW32[1] & 0x07000000) >> 24;
-    xh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> 12;
-    yh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >>  0;
+    xl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
+    yl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
+    tilenum = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x07000000) >> 24;
+    xh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> 12;
+    yh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >>  0;
 
-    yl |= (other_modes.cycle_type & 2) ? 3 : 0; /* FILL OR COPY */
+    yl |= (rdp_state->other_modes.cycle_type & 2) ? 3 : 0; /* FILL OR COPY */
 
-    s    = (cmd_data[cmd_cur + 1].UW32[0] & 0xFFFF0000) >> 16;
-    t    = (cmd_data[cmd_cur + 1].UW32[0] & 0x0000FFFF) >>  0;
-    dsdx = (cmd_data[cmd_cur + 1].UW32[1] & 0xFFFF0000) >> 16;
-    dtdy = (cmd_data[cmd_cur + 1].UW32[1] & 0x0000FFFF) >>  0;
+    s    = (cmd_data[rdp_state->cmd_cur + 1].UW32[0] & 0xFFFF0000) >> 16;
+    t    = (cmd_data[rdp_state->cmd_cur + 1].UW32[0] & 0x0000FFFF) >>  0;
+    dsdx = (cmd_data[rdp_state->cmd_cur + 1].UW32[1] & 0xFFFF0000) >> 16;
+    dtdy = (cmd_data[rdp_state->cmd_cur + 1].UW32[1] & 0x0000FFFF) >>  0;
     
     dsdx = SIGN16(dsdx);
     dtdy = SIGN16(dtdy);
@@ -570,7 +865,7 @@ static void tex_rect_flip(void)
     xhint = (unsigned)(xh) >> 2;
 
  /* edgewalker for primitives */
-    max_level = 0;
+    rdp_state->max_level = 0;
     xl = (xlint << 16) | (xl & 3)<<14;
     xl = SIGN(xl, 30);
     xh = (xhint << 16) | (xh & 3)<<14;
@@ -585,39 +880,39 @@ static void tex_rect_flip(void)
     d_stwz_dy[0] = 0x00000000;
     d_stwz_dy[1] = dtdy << 11;
 
-    setzero_si128(spans_d_rgba);
-    spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
-    spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
-    spans_d_stwz[2] = 0x00000000;
-    spans_d_stwz[3] = 0x00000000;
+    setzero_si128(rdp_state->spans_d_rgba);
+    rdp_state->spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
+    rdp_state->spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
+    rdp_state->spans_d_stwz[2] = 0x00000000;
+    rdp_state->spans_d_stwz[3] = 0x00000000;
 
-    setzero_si128(spans_d_rgba_dy);
-    spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
-    spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
-    spans_d_stwz_dy[2] = 0x00000000;
-    spans_d_stwz_dy[3] = 0x00000000;
+    setzero_si128(rdp_state->spans_d_rgba_dy);
+    rdp_state->spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[2] = 0x00000000;
+    rdp_state->spans_d_stwz_dy[3] = 0x00000000;
 
-    setzero_si128(spans_cd_rgba);
-    spans_cdz = 0x00000000;
-    spans_dzpix = normalize_dzpix(0);
+    setzero_si128(rdp_state->spans_cd_rgba);
+    rdp_state->spans_cdz = 0x00000000;
+    rdp_state->spans_dzpix = normalize_dzpix(0);
 
     d_stwz_dxh[1] = 0x00000000;
-    if (other_modes.cycle_type == CYCLE_TYPE_COPY)
+    if (rdp_state->other_modes.cycle_type == CYCLE_TYPE_COPY)
         d_stwz_dxh[0] = 0x00000000;
     else
         d_stwz_dxh[0] = (d_stwz_dx[0] >> 8) & ~0x00000001;
 
     invaly = 1;
-    yllimit = (yl < __clip.yl) ? yl : __clip.yl;
+    yllimit = (yl < rdp_state->__clip.yl) ? yl : rdp_state->__clip.yl;
 
     ycur = yh & ~3;
     ylfar = yllimit | 3;
     if ((yl >> 2) > (ylfar >> 2))
         ylfar += 4;
     else if ((yllimit >> 2) >= 0 && (yllimit >> 2) < 1023)
-        span[(yllimit >> 2) + 1].validline = 0;
+        rdp_state->span[(yllimit >> 2) + 1].validline = 0;
 
-    yhlimit = (yh >= __clip.yh) ? yh : __clip.yh;
+    yhlimit = (yh >= rdp_state->__clip.yh) ? yh : rdp_state->__clip.yh;
 
     xleft = xl & ~0x00000001;
     xright = xh & ~0x00000001;
@@ -632,7 +927,6 @@ static void tex_rect_flip(void)
     allinval = 1;
     for (k = ycur; k <= ylfar; k++)
     {
-        static int maxxmx, minxhx;
         int xrsc, xlsc, stickybit;
         const int yhclose = yhlimit & ~3;
         const int spix = k & 3;
@@ -661,7 +955,7 @@ static void tex_rect_flip(void)
             xrsc = xrsc & 0x1FFF;
             curover |= (u32)~(xrsc - clipxlshift) >> 31;
             xrsc = curover ? clipxlshift : xrsc;
-            span[j].majorx[spix] = xrsc & 0x1FFF;
+            rdp_state->span[j].majorx[spix] = xrsc & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
@@ -675,14 +969,14 @@ static void tex_rect_flip(void)
             xlsc &= 0x1FFF;
             curover |= (u32)~(xlsc - clipxlshift) >> 31;
             xlsc = curover ? clipxlshift : xlsc;
-            span[j].minorx[spix] = xlsc & 0x1FFF;
+            rdp_state->span[j].minorx[spix] = xlsc & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
             curcross = ((xleft&0x0FFFC000 ^ 0x08000000)
                      < (xright&0x0FFFC000 ^ 0x08000000));
             invaly |= curcross;
-            span[j].invalyscan[spix] = invaly;
+            rdp_state->span[j].invalyscan[spix] = invaly;
             allinval &= invaly;
             if (invaly != 0)
                 { /* branch */ }
@@ -696,20 +990,20 @@ static void tex_rect_flip(void)
 
             if (spix == 0)
             {
-                span[j].unscrx = xright >> 16;
-                setzero_si128(span[j].rgba);
-                span[j].stwz[0] = (stwz[0] - xfrac*d_stwz_dxh[0]) & ~0x000003FF;
-                span[j].stwz[1] = stwz[1];
-                span[j].stwz[2] = 0x00000000;
-                span[j].stwz[3] = 0x00000000;
+                rdp_state->span[j].unscrx = xright >> 16;
+                setzero_si128(rdp_state->span[j].rgba);
+                rdp_state->span[j].stwz[0] = (stwz[0] - xfrac*d_stwz_dxh[0]) & ~0x000003FF;
+                rdp_state->span[j].stwz[1] = stwz[1];
+                rdp_state->span[j].stwz[2] = 0x00000000;
+                rdp_state->span[j].stwz[3] = 0x00000000;
             }
             else if (spix == 3)
             {
-                const int invalidline = (sckeepodd ^ j) & scfield
+                const int invalidline = (rdp_state->sckeepodd ^ j) & rdp_state->scfield
                                       | (allinval | allover | allunder);
-                span[j].lx = maxxmx;
-                span[j].rx = minxhx;
-                span[j].validline = invalidline ^ 1;
+                rdp_state->span[j].lx = maxxmx;
+                rdp_state->span[j].rx = minxhx;
+                rdp_state->span[j].validline = invalidline ^ 1;
              /* stwz[0] = (stwz[0] + 0x00000000) & ~0x000001FF; */
                 stwz[1] = (stwz[1] + d_stwz_de[1]) & ~0x000003FF;
             }
@@ -744,113 +1038,113 @@ static void sync_full(void)
 
 static void set_key_gb(void)
 {
-    key_width.g  = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
-    key_width.b  = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
-    key_center.g = (cmd_data[cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
-    key_scale.g  = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
-    key_center.b = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    key_scale.b  = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->key_width.g  = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> 12;
+    rdp_state->key_width.b  = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >>  0;
+    rdp_state->key_center.g = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
+    rdp_state->key_scale.g  = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
+    rdp_state->key_center.b = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->key_scale.b  = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_key_r(void)
 {
-    key_width.r  = (cmd_data[cmd_cur + 0].UW32[1] & 0x0FFF0000) >> 16;
-    key_center.r = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    key_scale.r  = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->key_width.r  = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0FFF0000) >> 16;
+    rdp_state->key_center.r = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->key_scale.r  = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_convert(void)
 {
-    k0 = (cmd_data[cmd_cur + 0].UW32[0] & 0x003FE000) >> (45 - 32);
-    k1 = (cmd_data[cmd_cur + 0].UW32[0] & 0x00001FF0) >> (36 - 32);
-    k2  = (cmd_data[cmd_cur + 0].UW32[0] & 0x0000000F) << 5;
-    k2 |= (cmd_data[cmd_cur + 0].UW32[1] & 0xF8000000) >> (27 - 0);
-    k3 = (cmd_data[cmd_cur + 0].UW32[1] & 0x07FC0000) >> 18;
-    k4 = (cmd_data[cmd_cur + 0].UW32[1] & 0x0003FE00) >>  9;
-    k5 = (cmd_data[cmd_cur + 0].UW32[1] & 0x000001FF) >>  0;
+    rdp_state->k0 = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x003FE000) >> (45 - 32);
+    rdp_state->k1 = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00001FF0) >> (36 - 32);
+    rdp_state->k2  = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x0000000F) << 5;
+    rdp_state->k2 |= (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xF8000000) >> (27 - 0);
+    rdp_state->k3 = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x07FC0000) >> 18;
+    rdp_state->k4 = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0003FE00) >>  9;
+    rdp_state->k5 = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000001FF) >>  0;
     return;
 }
 
 static void set_scissor(void)
 {
-    __clip.xh   = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
-    __clip.yh   = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
-    scfield   = (cmd_data[cmd_cur + 0].UW32[1] & 0x02000000) >> (25 -  0);
-    sckeepodd = (cmd_data[cmd_cur + 0].UW32[1] & 0x01000000) >> (24 -  0);
-    __clip.xl   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
-    __clip.yl   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
+    rdp_state->__clip.xh   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
+    rdp_state->__clip.yh   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
+    rdp_state->scfield   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x02000000) >> (25 -  0);
+    rdp_state->sckeepodd = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x01000000) >> (24 -  0);
+    rdp_state->__clip.xl   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
+    rdp_state->__clip.yl   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
     return;
 }
 
 static void set_prim_depth(void)
 {
-    primitive_z       = (cmd_data[cmd_cur + 0].UW32[1] & 0xFFFF0000) >> 16;
-    primitive_delta_z = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FFFF) >>  0;
-    primitive_z = (primitive_z & 0x7FFF) << 16; /* angrylion does this why? */
+    rdp_state->primitive_z       = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFFFF0000) >> 16;
+    rdp_state->primitive_delta_z = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FFFF) >>  0;
+    rdp_state->primitive_z = (rdp_state->primitive_z & 0x7FFF) << 16; /* angrylion does this why? */
     return;
 }
 
 static void set_other_modes(void)
 {
-    const DP_FIFO cmd_fifo = cmd_data[cmd_cur + 0];
+    const DP_FIFO cmd_fifo = cmd_data[rdp_state->cmd_cur + 0];
 
  /* K:  atomic_prim              = (cmd_fifo.UW & 0x0080000000000000) >> 55; */
  /* j:  reserved for future use -- (cmd_fifo.UW & 0x0040000000000000) >> 54 */
-    other_modes.cycle_type       = (cmd_fifo.UW32[0] & 0x00300000) >> (52 - 32);
-    other_modes.persp_tex_en     = !!(cmd_fifo.UW32[0] & 0x00080000); /* 51 */
-    other_modes.detail_tex_en    = !!(cmd_fifo.UW32[0] & 0x00040000); /* 50 */
-    other_modes.sharpen_tex_en   = !!(cmd_fifo.UW32[0] & 0x00020000); /* 49 */
-    other_modes.tex_lod_en       = !!(cmd_fifo.UW32[0] & 0x00010000); /* 48 */
-    other_modes.en_tlut          = !!(cmd_fifo.UW32[0] & 0x00008000); /* 47 */
-    other_modes.tlut_type        = !!(cmd_fifo.UW32[0] & 0x00004000); /* 46 */
-    other_modes.sample_type      = !!(cmd_fifo.UW32[0] & 0x00002000); /* 45 */
-    other_modes.mid_texel        = !!(cmd_fifo.UW32[0] & 0x00001000); /* 44 */
-    other_modes.bi_lerp0         = !!(cmd_fifo.UW32[0] & 0x00000800); /* 43 */
-    other_modes.bi_lerp1         = !!(cmd_fifo.UW32[0] & 0x00000400); /* 42 */
-    other_modes.convert_one      = !!(cmd_fifo.UW32[0] & 0x00000200); /* 41 */
-    other_modes.key_en           = !!(cmd_fifo.UW32[0] & 0x00000100); /* 40 */
-    other_modes.rgb_dither_sel   = (cmd_fifo.UW32[0] & 0x000000C0) >> (38 - 32);
-    other_modes.alpha_dither_sel = (cmd_fifo.UW32[0] & 0x00000030) >> (36 - 32);
+    rdp_state->other_modes.cycle_type       = (cmd_fifo.UW32[0] & 0x00300000) >> (52 - 32);
+    rdp_state->other_modes.persp_tex_en     = !!(cmd_fifo.UW32[0] & 0x00080000); /* 51 */
+    rdp_state->other_modes.detail_tex_en    = !!(cmd_fifo.UW32[0] & 0x00040000); /* 50 */
+    rdp_state->other_modes.sharpen_tex_en   = !!(cmd_fifo.UW32[0] & 0x00020000); /* 49 */
+    rdp_state->other_modes.tex_lod_en       = !!(cmd_fifo.UW32[0] & 0x00010000); /* 48 */
+    rdp_state->other_modes.en_tlut          = !!(cmd_fifo.UW32[0] & 0x00008000); /* 47 */
+    rdp_state->other_modes.tlut_type        = !!(cmd_fifo.UW32[0] & 0x00004000); /* 46 */
+    rdp_state->other_modes.sample_type      = !!(cmd_fifo.UW32[0] & 0x00002000); /* 45 */
+    rdp_state->other_modes.mid_texel        = !!(cmd_fifo.UW32[0] & 0x00001000); /* 44 */
+    rdp_state->other_modes.bi_lerp0         = !!(cmd_fifo.UW32[0] & 0x00000800); /* 43 */
+    rdp_state->other_modes.bi_lerp1         = !!(cmd_fifo.UW32[0] & 0x00000400); /* 42 */
+    rdp_state->other_modes.convert_one      = !!(cmd_fifo.UW32[0] & 0x00000200); /* 41 */
+    rdp_state->other_modes.key_en           = !!(cmd_fifo.UW32[0] & 0x00000100); /* 40 */
+    rdp_state->other_modes.rgb_dither_sel   = (cmd_fifo.UW32[0] & 0x000000C0) >> (38 - 32);
+    rdp_state->other_modes.alpha_dither_sel = (cmd_fifo.UW32[0] & 0x00000030) >> (36 - 32);
  /* reserved for future, def:15 -- (cmd_fifo.UW & 0x0000000F00000000) >> 32 */
-    other_modes.blend_m1a_0      = (cmd_fifo.UW32[1] & 0xC0000000) >> (30 -  0);
-    other_modes.blend_m1a_1      = (cmd_fifo.UW32[1] & 0x30000000) >> (28 -  0);
-    other_modes.blend_m1b_0      = (cmd_fifo.UW32[1] & 0x0C000000) >> (26 -  0);
-    other_modes.blend_m1b_1      = (cmd_fifo.UW32[1] & 0x03000000) >> (24 -  0);
-    other_modes.blend_m2a_0      = (cmd_fifo.UW32[1] & 0x00C00000) >> (22 -  0);
-    other_modes.blend_m2a_1      = (cmd_fifo.UW32[1] & 0x00300000) >> (20 -  0);
-    other_modes.blend_m2b_0      = (cmd_fifo.UW32[1] & 0x000C0000) >> (18 -  0);
-    other_modes.blend_m2b_1      = (cmd_fifo.UW32[1] & 0x00030000) >> (16 -  0);
+    rdp_state->other_modes.blend_m1a_0      = (cmd_fifo.UW32[1] & 0xC0000000) >> (30 -  0);
+    rdp_state->other_modes.blend_m1a_1      = (cmd_fifo.UW32[1] & 0x30000000) >> (28 -  0);
+    rdp_state->other_modes.blend_m1b_0      = (cmd_fifo.UW32[1] & 0x0C000000) >> (26 -  0);
+    rdp_state->other_modes.blend_m1b_1      = (cmd_fifo.UW32[1] & 0x03000000) >> (24 -  0);
+    rdp_state->other_modes.blend_m2a_0      = (cmd_fifo.UW32[1] & 0x00C00000) >> (22 -  0);
+    rdp_state->other_modes.blend_m2a_1      = (cmd_fifo.UW32[1] & 0x00300000) >> (20 -  0);
+    rdp_state->other_modes.blend_m2b_0      = (cmd_fifo.UW32[1] & 0x000C0000) >> (18 -  0);
+    rdp_state->other_modes.blend_m2b_1      = (cmd_fifo.UW32[1] & 0x00030000) >> (16 -  0);
  /* N:  reserved for future use -- (cmd_fifo.UW & 0x0000000000008000) >> 15 */
-    other_modes.force_blend      = !!(cmd_fifo.UW32[1] & 0x00004000); /* 14 */
-    other_modes.alpha_cvg_select = !!(cmd_fifo.UW32[1] & 0x00002000); /* 13 */
-    other_modes.cvg_times_alpha  = !!(cmd_fifo.UW32[1] & 0x00001000); /* 12 */
-    other_modes.z_mode           = (cmd_fifo.UW32[1] & 0x00000C00) >> (10 -  0);
-    other_modes.cvg_dest         = (cmd_fifo.UW32[1] & 0x00000300) >> ( 8 -  0);
-    other_modes.color_on_cvg     = !!(cmd_fifo.UW32[1] & 0x00000080); /*  7 */
-    other_modes.image_read_en    = !!(cmd_fifo.UW32[1] & 0x00000040); /*  6 */
-    other_modes.z_update_en      = !!(cmd_fifo.UW32[1] & 0x00000020); /*  5 */
-    other_modes.z_compare_en     = !!(cmd_fifo.UW32[1] & 0x00000010); /*  4 */
-    other_modes.antialias_en     = !!(cmd_fifo.UW32[1] & 0x00000008); /*  3 */
-    other_modes.z_source_sel     = !!(cmd_fifo.UW32[1] & 0x00000004); /*  2 */
-    other_modes.dither_alpha_en  = !!(cmd_fifo.UW32[1] & 0x00000002); /*  1 */
-    other_modes.alpha_compare_en = !!(cmd_fifo.UW32[1] & 0x00000001); /*  0 */
+    rdp_state->other_modes.force_blend      = !!(cmd_fifo.UW32[1] & 0x00004000); /* 14 */
+    rdp_state->other_modes.alpha_cvg_select = !!(cmd_fifo.UW32[1] & 0x00002000); /* 13 */
+    rdp_state->other_modes.cvg_times_alpha  = !!(cmd_fifo.UW32[1] & 0x00001000); /* 12 */
+    rdp_state->other_modes.z_mode           = (cmd_fifo.UW32[1] & 0x00000C00) >> (10 -  0);
+    rdp_state->other_modes.cvg_dest         = (cmd_fifo.UW32[1] & 0x00000300) >> ( 8 -  0);
+    rdp_state->other_modes.color_on_cvg     = !!(cmd_fifo.UW32[1] & 0x00000080); /*  7 */
+    rdp_state->other_modes.image_read_en    = !!(cmd_fifo.UW32[1] & 0x00000040); /*  6 */
+    rdp_state->other_modes.z_update_en      = !!(cmd_fifo.UW32[1] & 0x00000020); /*  5 */
+    rdp_state->other_modes.z_compare_en     = !!(cmd_fifo.UW32[1] & 0x00000010); /*  4 */
+    rdp_state->other_modes.antialias_en     = !!(cmd_fifo.UW32[1] & 0x00000008); /*  3 */
+    rdp_state->other_modes.z_source_sel     = !!(cmd_fifo.UW32[1] & 0x00000004); /*  2 */
+    rdp_state->other_modes.dither_alpha_en  = !!(cmd_fifo.UW32[1] & 0x00000002); /*  1 */
+    rdp_state->other_modes.alpha_compare_en = !!(cmd_fifo.UW32[1] & 0x00000001); /*  0 */
 
     SET_BLENDER_INPUT(
-        0, 0, &blender1a_r[0], &blender1a_g[0], &blender1a_b[0],
-        &blender1b_a[0], other_modes.blend_m1a_0, other_modes.blend_m1b_0);
+        0, 0, &rdp_state->blender1a_r[0], &rdp_state->blender1a_g[0], &rdp_state->blender1a_b[0],
+        &rdp_state->blender1b_a[0], rdp_state->other_modes.blend_m1a_0, rdp_state->other_modes.blend_m1b_0);
     SET_BLENDER_INPUT(
-        0, 1, &blender2a_r[0], &blender2a_g[0], &blender2a_b[0],
-        &blender2b_a[0], other_modes.blend_m2a_0, other_modes.blend_m2b_0);
+        0, 1, &rdp_state->blender2a_r[0], &rdp_state->blender2a_g[0], &rdp_state->blender2a_b[0],
+        &rdp_state->blender2b_a[0], rdp_state->other_modes.blend_m2a_0, rdp_state->other_modes.blend_m2b_0);
     SET_BLENDER_INPUT(
-        1, 0, &blender1a_r[1], &blender1a_g[1], &blender1a_b[1],
-        &blender1b_a[1], other_modes.blend_m1a_1, other_modes.blend_m1b_1);
+        1, 0, &rdp_state->blender1a_r[1], &rdp_state->blender1a_g[1], &rdp_state->blender1a_b[1],
+        &rdp_state->blender1b_a[1], rdp_state->other_modes.blend_m1a_1, rdp_state->other_modes.blend_m1b_1);
     SET_BLENDER_INPUT(
-        1, 1, &blender2a_r[1], &blender2a_g[1], &blender2a_b[1],
-        &blender2b_a[1], other_modes.blend_m2a_1, other_modes.blend_m2b_1);
+        1, 1, &rdp_state->blender2a_r[1], &rdp_state->blender2a_g[1], &rdp_state->blender2a_b[1],
+        &rdp_state->blender2b_a[1], rdp_state->other_modes.blend_m2a_1, rdp_state->other_modes.blend_m2b_1);
 
-    other_modes.f.stalederivs = 1;
+    rdp_state->other_modes.f.stalederivs = 1;
     return;
 }
 
@@ -858,16 +1152,16 @@ static void set_tile_size(void)
 {
     int sl, tl, tilenum, sh, th;
 
-    sl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
-    tl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
-    tilenum = (cmd_data[cmd_cur + 0].UW32[1] & 0x07000000) >> (24 -  0);
-    sh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
-    th      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
+    sl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
+    tl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
+    tilenum = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x07000000) >> (24 -  0);
+    sh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
+    th      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
 
-    tile[tilenum].sl = sl;
-    tile[tilenum].tl = tl;
-    tile[tilenum].sh = sh;
-    tile[tilenum].th = th;
+    rdp_state->tile[tilenum].sl = sl;
+    rdp_state->tile[tilenum].tl = tl;
+    rdp_state->tile[tilenum].sh = sh;
+    rdp_state->tile[tilenum].th = th;
     calculate_clamp_diffs(tilenum);
     return;
 }
@@ -875,18 +1169,18 @@ static void set_tile_size(void)
 static void load_block(void)
 {
     INT32 lewdata[10];
-    const int command = (cmd_data[cmd_cur + 0].UW32[0] & 0xFF000000) >> (56-32);
-    const int sl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44-32);
-    const int tl      = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32-32);
-    const int tilenum = (cmd_data[cmd_cur + 0].UW32[1] & 0x07000000) >> (24- 0);
-    const int sh      = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12- 0);
-    const int dxt     = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0- 0);
+    const int command = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0xFF000000) >> (56-32);
+    const int sl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44-32);
+    const int tl      = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32-32);
+    const int tilenum = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x07000000) >> (24- 0);
+    const int sh      = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12- 0);
+    const int dxt     = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0- 0);
     const int tlclamped = tl & 0x3FF;
 
-    tile[tilenum].sl = sl;
-    tile[tilenum].tl = tl;
-    tile[tilenum].sh = sh;
-    tile[tilenum].th = dxt;
+    rdp_state->tile[tilenum].sl = sl;
+    rdp_state->tile[tilenum].tl = tl;
+    rdp_state->tile[tilenum].sh = sh;
+    rdp_state->tile[tilenum].th = dxt;
 
     calculate_clamp_diffs(tilenum);
 
@@ -901,7 +1195,7 @@ static void load_block(void)
     lewdata[4] = sh << 16;
     lewdata[5] = ((sl << 3) << 16) | (tl << 3);
     lewdata[6] = (dxt & 0xff) << 8;
-    lewdata[7] = ((0x80 >> ti_size) << 16) | (dxt >> 8);
+    lewdata[7] = ((0x80 >> rdp_state->ti_size) << 16) | (dxt >> 8);
     lewdata[8] = 0x20;
     lewdata[9] = 0x20;
 
@@ -912,36 +1206,36 @@ static void load_block(void)
 static void load_tlut(void)
 {
     tile_tlut_common_cs_decoder(
-        cmd_data[cmd_cur + 0].UW32[0], cmd_data[cmd_cur + 0].UW32[1]);
+        cmd_data[rdp_state->cmd_cur + 0].UW32[0], cmd_data[rdp_state->cmd_cur + 0].UW32[1]);
     return;
 }
 
 static void load_tile(void)
 {
     tile_tlut_common_cs_decoder(
-        cmd_data[cmd_cur + 0].UW32[0], cmd_data[cmd_cur + 0].UW32[1]);
+        cmd_data[rdp_state->cmd_cur + 0].UW32[0], cmd_data[rdp_state->cmd_cur + 0].UW32[1]);
     return;
 }
 
 static void set_tile(void)
 {
-    const DP_FIFO cmd_fifo = cmd_data[cmd_cur + 0];
+    const DP_FIFO cmd_fifo = cmd_data[rdp_state->cmd_cur + 0];
     const int tilenum     = (cmd_fifo.UW32[1] & 0x07000000) >> 24;
     
-    tile[tilenum].format  = (cmd_fifo.UW32[0] & 0x00E00000) >> (53 - 32);
-    tile[tilenum].size    = (cmd_fifo.UW32[0] & 0x00180000) >> (51 - 32);
-    tile[tilenum].line    = (cmd_fifo.UW32[0] & 0x0003FE00) >> (41 - 32);
-    tile[tilenum].tmem    = (cmd_fifo.UW32[0] & 0x000001FF) >> (32 - 32);
+    rdp_state->tile[tilenum].format  = (cmd_fifo.UW32[0] & 0x00E00000) >> (53 - 32);
+    rdp_state->tile[tilenum].size    = (cmd_fifo.UW32[0] & 0x00180000) >> (51 - 32);
+    rdp_state->tile[tilenum].line    = (cmd_fifo.UW32[0] & 0x0003FE00) >> (41 - 32);
+    rdp_state->tile[tilenum].tmem    = (cmd_fifo.UW32[0] & 0x000001FF) >> (32 - 32);
  /* tilenum               = (cmd_fifo.UW & 0x0000000007000000) >> 24; */
-    tile[tilenum].palette = (cmd_fifo.UW32[1] & 0x00F00000) >> (20 -  0);
-    tile[tilenum].ct      = (cmd_fifo.UW32[1] & 0x00080000) >> (19 -  0);
-    tile[tilenum].mt      = (cmd_fifo.UW32[1] & 0x00040000) >> (18 -  0);
-    tile[tilenum].mask_t  = (cmd_fifo.UW32[1] & 0x0003C000) >> (14 -  0);
-    tile[tilenum].shift_t = (cmd_fifo.UW32[1] & 0x00003C00) >> (10 -  0);
-    tile[tilenum].cs      = (cmd_fifo.UW32[1] & 0x00000200) >> ( 9 -  0);
-    tile[tilenum].ms      = (cmd_fifo.UW32[1] & 0x00000100) >> ( 8 -  0);
-    tile[tilenum].mask_s  = (cmd_fifo.UW32[1] & 0x000000F0) >> ( 4 -  0);
-    tile[tilenum].shift_s = (cmd_fifo.UW32[1] & 0x0000000F) >> ( 0 -  0);
+    rdp_state->tile[tilenum].palette = (cmd_fifo.UW32[1] & 0x00F00000) >> (20 -  0);
+    rdp_state->tile[tilenum].ct      = (cmd_fifo.UW32[1] & 0x00080000) >> (19 -  0);
+    rdp_state->tile[tilenum].mt      = (cmd_fifo.UW32[1] & 0x00040000) >> (18 -  0);
+    rdp_state->tile[tilenum].mask_t  = (cmd_fifo.UW32[1] & 0x0003C000) >> (14 -  0);
+    rdp_state->tile[tilenum].shift_t = (cmd_fifo.UW32[1] & 0x00003C00) >> (10 -  0);
+    rdp_state->tile[tilenum].cs      = (cmd_fifo.UW32[1] & 0x00000200) >> ( 9 -  0);
+    rdp_state->tile[tilenum].ms      = (cmd_fifo.UW32[1] & 0x00000100) >> ( 8 -  0);
+    rdp_state->tile[tilenum].mask_s  = (cmd_fifo.UW32[1] & 0x000000F0) >> ( 4 -  0);
+    rdp_state->tile[tilenum].shift_s = (cmd_fifo.UW32[1] & 0x0000000F) >> ( 0 -  0);
 
     calculate_tile_derivs(tilenum);
     return;
@@ -958,47 +1252,48 @@ static void fill_rect(void)
     int curcross;
     int allover, allunder, curover, curunder;
     int allinval;
+    int maxxmx = 0x000, minxhx = 0xFFF; /* reset at each scanline */
     register int j, k;
-    const i32 clipxlshift = __clip.xl << 1;
-    const i32 clipxhshift = __clip.xh << 1;
+    const i32 clipxlshift = rdp_state->__clip.xl << 1;
+    const i32 clipxhshift = rdp_state->__clip.xh << 1;
 
-    xl = (cmd_data[cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
-    yl = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
-    xh = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
-    yh = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
+    xl = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00FFF000) >> (44 - 32);
+    yl = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000FFF) >> (32 - 32);
+    xh = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FFF000) >> (12 -  0);
+    yh = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000FFF) >> ( 0 -  0);
 
-    yl |= (other_modes.cycle_type & 2) ? 3 : 0; /* FILL or COPY */
+    yl |= (rdp_state->other_modes.cycle_type & 2) ? 3 : 0; /* FILL or COPY */
 
     xlint = (unsigned)(xl) >> 2;
     xhint = (unsigned)(xh) >> 2;
 
-    max_level = 0;
+    rdp_state->max_level = 0;
     xl = (xlint << 16) | (xl & 3)<<14;
     xl = SIGN(xl, 30);
     xh = (xhint << 16) | (xh & 3)<<14;
     xh = SIGN(xh, 30);
 
-    setzero_si128(spans_d_rgba);
-    setzero_si128(spans_d_stwz);
+    setzero_si128(rdp_state->spans_d_rgba);
+    setzero_si128(rdp_state->spans_d_stwz);
 
-    setzero_si128(spans_d_rgba_dy);
-    setzero_si128(spans_d_stwz_dy);
+    setzero_si128(rdp_state->spans_d_rgba_dy);
+    setzero_si128(rdp_state->spans_d_stwz_dy);
 
-    setzero_si128(spans_cd_rgba);
-    spans_cdz = 0;
+    setzero_si128(rdp_state->spans_cd_rgba);
+    rdp_state->spans_cdz = 0;
 
-    spans_dzpix = normalize_dzpix(0);
+    rdp_state->spans_dzpix = normalize_dzpix(0);
 
     invaly = 1;
-    yllimit = (yl < __clip.yl) ? yl : __clip.yl;
+    yllimit = (yl < rdp_state->__clip.yl) ? yl : rdp_state->__clip.yl;
 
     ycur = yh & ~3;
     ylfar = yllimit | 3;
     if (yl >> 2 > ylfar >> 2)
         ylfar += 4;
     else if (yllimit >> 2 >= 0 && yllimit>>2 < 1023)
-        span[(yllimit >> 2) + 1].validline = 0;
-    yhlimit = (yh >= __clip.yh) ? yh : __clip.yh;
+        rdp_state->span[(yllimit >> 2) + 1].validline = 0;
+    yhlimit = (yh >= rdp_state->__clip.yh) ? yh : rdp_state->__clip.yh;
 
     allover = 1;
     allunder = 1;
@@ -1007,7 +1302,6 @@ static void fill_rect(void)
     allinval = 1;
     for (k = ycur; k <= ylfar; k++)
     {
-        static int maxxmx, minxhx;
         int xrsc, xlsc, stickybit;
         const i32 xleft = xl & ~0x00000001, xright = xh & ~0x00000001;
         const int yhclose = yhlimit & ~3;
@@ -1035,7 +1329,7 @@ static void fill_rect(void)
         xrsc = xrsc & 0x1FFF;
         curover |= (u32)~(xrsc - clipxlshift) >> 31;
         xrsc = curover ? clipxlshift : xrsc;
-        span[j].majorx[spix] = xrsc & 0x1FFF;
+        rdp_state->span[j].majorx[spix] = xrsc & 0x1FFF;
         allover &= curover;
         allunder &= curunder;
 
@@ -1049,14 +1343,14 @@ static void fill_rect(void)
         xlsc &= 0x1FFF;
         curover |= (u32)~(xlsc - clipxlshift) >> 31;
         xlsc = curover ? clipxlshift : xlsc;
-        span[j].minorx[spix] = xlsc & 0x1FFF;
+        rdp_state->span[j].minorx[spix] = xlsc & 0x1FFF;
         allover &= curover;
         allunder &= curunder;
 
         curcross = ((xleft&0x0FFFC000 ^ 0x08000000)
                  < (xright&0x0FFFC000 ^ 0x08000000));
         invaly |= curcross;
-        span[j].invalyscan[spix] = invaly;
+        rdp_state->span[j].invalyscan[spix] = invaly;
         allinval &= invaly;
         if (invaly != 0)
             { /* branch */ }
@@ -1070,17 +1364,17 @@ static void fill_rect(void)
 
         if (spix == 0)
         {
-            span[j].unscrx = xright >> 16;
-            setzero_si128(span[j].rgba);
-            setzero_si128(span[j].stwz);
+            rdp_state->span[j].unscrx = xright >> 16;
+            setzero_si128(rdp_state->span[j].rgba);
+            setzero_si128(rdp_state->span[j].stwz);
         }
         else if (spix == 3)
         {
-            const int invalidline = (sckeepodd ^ j) & scfield
+            const int invalidline = (rdp_state->sckeepodd ^ j) & rdp_state->scfield
                                   | (allinval | allover | allunder);
-            span[j].lx = maxxmx;
-            span[j].rx = minxhx;
-            span[j].validline = invalidline ^ 1;
+            rdp_state->span[j].lx = maxxmx;
+            rdp_state->span[j].rx = minxhx;
+            rdp_state->span[j].validline = invalidline ^ 1;
         }
     }
     render_spans(yhlimit >> 2, yllimit >> 2, 0, 1);
@@ -1089,130 +1383,130 @@ static void fill_rect(void)
 
 static void set_fill_color(void)
 {
-    fill_color = cmd_data[cmd_cur + 0].UW32[1];
+    rdp_state->fill_color = cmd_data[rdp_state->cmd_cur + 0].UW32[1];
     return;
 }
 
 static void set_fog_color(void)
 {
-    fog_color.r = (cmd_data[cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
-    fog_color.g = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
-    fog_color.b = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    fog_color.a = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->fog_color.r = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
+    rdp_state->fog_color.g = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
+    rdp_state->fog_color.b = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->fog_color.a = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_blend_color(void)
 {
-    blend_color.r = (cmd_data[cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
-    blend_color.g = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
-    blend_color.b = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    blend_color.a = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->blend_color.r = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
+    rdp_state->blend_color.g = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
+    rdp_state->blend_color.b = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->blend_color.a = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_prim_color(void)
 {
-    min_level          = (cmd_data[cmd_cur + 0].UW32[0] & 0x00001F00) >>(40-32);
-    primitive_lod_frac = (cmd_data[cmd_cur + 0].UW32[0] & 0x000000FF) >>(32-32);
-    prim_color.r       = (cmd_data[cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
-    prim_color.g       = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
-    prim_color.b       = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    prim_color.a       = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->min_level          = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00001F00) >>(40-32);
+    rdp_state->primitive_lod_frac = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x000000FF) >>(32-32);
+    rdp_state->prim_color.r       = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
+    rdp_state->prim_color.g       = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
+    rdp_state->prim_color.b       = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->prim_color.a       = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_env_color(void)
 {
-    env_color.r = (cmd_data[cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
-    env_color.g = (cmd_data[cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
-    env_color.b = (cmd_data[cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
-    env_color.a = (cmd_data[cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
+    rdp_state->env_color.r = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xFF000000) >> 24;
+    rdp_state->env_color.g = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00FF0000) >> 16;
+    rdp_state->env_color.b = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0000FF00) >>  8;
+    rdp_state->env_color.a = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000000FF) >>  0;
     return;
 }
 
 static void set_combine(void)
 {
-    combine.sub_a_rgb0 = (cmd_data[cmd_cur + 0].UW32[0] & 0x00F00000) >>(52-32);
-    combine.mul_rgb0   = (cmd_data[cmd_cur + 0].UW32[0] & 0x000F8000) >>(47-32);
-    combine.sub_a_a0   = (cmd_data[cmd_cur + 0].UW32[0] & 0x00007000) >>(44-32);
-    combine.mul_a0     = (cmd_data[cmd_cur + 0].UW32[0] & 0x00000E00) >>(41-32);
-    combine.sub_a_rgb1 = (cmd_data[cmd_cur + 0].UW32[0] & 0x000001E0) >>(37-32);
-    combine.mul_rgb1   = (cmd_data[cmd_cur + 0].UW32[0] & 0x0000001F) >>(32-32);
-    combine.sub_b_rgb0 = (cmd_data[cmd_cur + 0].UW32[1] & 0xF0000000) >> 28;
-    combine.sub_b_rgb1 = (cmd_data[cmd_cur + 0].UW32[1] & 0x0F000000) >> 24;
-    combine.sub_a_a1   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00E00000) >> 21;
-    combine.mul_a1     = (cmd_data[cmd_cur + 0].UW32[1] & 0x001C0000) >> 18;
-    combine.add_rgb0   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00038000) >> 15;
-    combine.sub_b_a0   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00007000) >> 12;
-    combine.add_a0     = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000E00) >>  9;
-    combine.add_rgb1   = (cmd_data[cmd_cur + 0].UW32[1] & 0x000001C0) >>  6;
-    combine.sub_b_a1   = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000038) >>  3;
-    combine.add_a1     = (cmd_data[cmd_cur + 0].UW32[1] & 0x00000007) >>  0;
+    rdp_state->combine.sub_a_rgb0 = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00F00000) >>(52-32);
+    rdp_state->combine.mul_rgb0   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x000F8000) >>(47-32);
+    rdp_state->combine.sub_a_a0   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00007000) >>(44-32);
+    rdp_state->combine.mul_a0     = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00000E00) >>(41-32);
+    rdp_state->combine.sub_a_rgb1 = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x000001E0) >>(37-32);
+    rdp_state->combine.mul_rgb1   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x0000001F) >>(32-32);
+    rdp_state->combine.sub_b_rgb0 = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0xF0000000) >> 28;
+    rdp_state->combine.sub_b_rgb1 = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x0F000000) >> 24;
+    rdp_state->combine.sub_a_a1   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00E00000) >> 21;
+    rdp_state->combine.mul_a1     = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x001C0000) >> 18;
+    rdp_state->combine.add_rgb0   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00038000) >> 15;
+    rdp_state->combine.sub_b_a0   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00007000) >> 12;
+    rdp_state->combine.add_a0     = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000E00) >>  9;
+    rdp_state->combine.add_rgb1   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x000001C0) >>  6;
+    rdp_state->combine.sub_b_a1   = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000038) >>  3;
+    rdp_state->combine.add_a1     = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x00000007) >>  0;
 
     SET_SUBA_RGB_INPUT(
-        &combiner_rgbsub_a_r[0], &combiner_rgbsub_a_g[0],
-        &combiner_rgbsub_a_b[0], combine.sub_a_rgb0);
+        &rdp_state->combiner_rgbsub_a_r[0], &rdp_state->combiner_rgbsub_a_g[0],
+        &rdp_state->combiner_rgbsub_a_b[0], rdp_state->combine.sub_a_rgb0);
     SET_SUBB_RGB_INPUT(
-        &combiner_rgbsub_b_r[0], &combiner_rgbsub_b_g[0],
-        &combiner_rgbsub_b_b[0], combine.sub_b_rgb0);
+        &rdp_state->combiner_rgbsub_b_r[0], &rdp_state->combiner_rgbsub_b_g[0],
+        &rdp_state->combiner_rgbsub_b_b[0], rdp_state->combine.sub_b_rgb0);
     SET_MUL_RGB_INPUT(
-        &combiner_rgbmul_r[0], &combiner_rgbmul_g[0], &combiner_rgbmul_b[0],
-        combine.mul_rgb0);
+        &rdp_state->combiner_rgbmul_r[0], &rdp_state->combiner_rgbmul_g[0], &rdp_state->combiner_rgbmul_b[0],
+        rdp_state->combine.mul_rgb0);
     SET_ADD_RGB_INPUT(
-        &combiner_rgbadd_r[0], &combiner_rgbadd_g[0], &combiner_rgbadd_b[0],
-        combine.add_rgb0);
-    SET_SUB_ALPHA_INPUT(&combiner_alphasub_a[0], combine.sub_a_a0);
-    SET_SUB_ALPHA_INPUT(&combiner_alphasub_b[0], combine.sub_b_a0);
-    SET_MUL_ALPHA_INPUT(&combiner_alphamul[0], combine.mul_a0);
-    SET_SUB_ALPHA_INPUT(&combiner_alphaadd[0], combine.add_a0);
+        &rdp_state->combiner_rgbadd_r[0], &rdp_state->combiner_rgbadd_g[0], &rdp_state->combiner_rgbadd_b[0],
+        rdp_state->combine.add_rgb0);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphasub_a[0], rdp_state->combine.sub_a_a0);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphasub_b[0], rdp_state->combine.sub_b_a0);
+    SET_MUL_ALPHA_INPUT(&rdp_state->combiner_alphamul[0], rdp_state->combine.mul_a0);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphaadd[0], rdp_state->combine.add_a0);
 
     SET_SUBA_RGB_INPUT(
-        &combiner_rgbsub_a_r[1], &combiner_rgbsub_a_g[1],
-        &combiner_rgbsub_a_b[1], combine.sub_a_rgb1);
+        &rdp_state->combiner_rgbsub_a_r[1], &rdp_state->combiner_rgbsub_a_g[1],
+        &rdp_state->combiner_rgbsub_a_b[1], rdp_state->combine.sub_a_rgb1);
     SET_SUBB_RGB_INPUT(
-        &combiner_rgbsub_b_r[1], &combiner_rgbsub_b_g[1],
-        &combiner_rgbsub_b_b[1], combine.sub_b_rgb1);
+        &rdp_state->combiner_rgbsub_b_r[1], &rdp_state->combiner_rgbsub_b_g[1],
+        &rdp_state->combiner_rgbsub_b_b[1], rdp_state->combine.sub_b_rgb1);
     SET_MUL_RGB_INPUT(
-        &combiner_rgbmul_r[1], &combiner_rgbmul_g[1], &combiner_rgbmul_b[1],
-        combine.mul_rgb1);
+        &rdp_state->combiner_rgbmul_r[1], &rdp_state->combiner_rgbmul_g[1], &rdp_state->combiner_rgbmul_b[1],
+        rdp_state->combine.mul_rgb1);
     SET_ADD_RGB_INPUT(
-        &combiner_rgbadd_r[1], &combiner_rgbadd_g[1], &combiner_rgbadd_b[1],
-        combine.add_rgb1);
-    SET_SUB_ALPHA_INPUT(&combiner_alphasub_a[1], combine.sub_a_a1);
-    SET_SUB_ALPHA_INPUT(&combiner_alphasub_b[1], combine.sub_b_a1);
-    SET_MUL_ALPHA_INPUT(&combiner_alphamul[1], combine.mul_a1);
-    SET_SUB_ALPHA_INPUT(&combiner_alphaadd[1], combine.add_a1);
-
-    other_modes.f.stalederivs = 1;
+        &rdp_state->combiner_rgbadd_r[1], &rdp_state->combiner_rgbadd_g[1], &rdp_state->combiner_rgbadd_b[1],
+        rdp_state->combine.add_rgb1);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphasub_a[1], rdp_state->combine.sub_a_a1);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphasub_b[1], rdp_state->combine.sub_b_a1);
+    SET_MUL_ALPHA_INPUT(&rdp_state->combiner_alphamul[1], rdp_state->combine.mul_a1);
+    SET_SUB_ALPHA_INPUT(&rdp_state->combiner_alphaadd[1], rdp_state->combine.add_a1);
+
+    rdp_state->other_modes.f.stalederivs = 1;
     return;
 }
 
 static void set_texture_image(void)
 {
-    ti_format  = (cmd_data[cmd_cur + 0].UW32[0] & 0x00E00000) >> (53 - 32);
-    ti_size    = (cmd_data[cmd_cur + 0].UW32[0] & 0x00180000) >> (51 - 32);
-    ti_width   = (cmd_data[cmd_cur + 0].UW32[0] & 0x000003FF) >> (32 - 32);
-    ti_address = (cmd_data[cmd_cur + 0].UW32[1] & 0x03FFFFFF) >> ( 0 -  0);
+    rdp_state->ti_format  = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00E00000) >> (53 - 32);
+    rdp_state->ti_size    = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00180000) >> (51 - 32);
+    rdp_state->ti_width   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x000003FF) >> (32 - 32);
+    rdp_state->ti_address = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x03FFFFFF) >> ( 0 -  0);
  /* ti_address &= 0x00FFFFFF; // physical memory limit, enforced later */
-    ++ti_width;
+    ++rdp_state->ti_width;
     return;
 }
 
 static void set_mask_image(void)
 {
-    zb_address = cmd_data[cmd_cur + 0].UW32[1] & 0x03FFFFFF;
+    rdp_state->zb_address = cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x03FFFFFF;
  /* zb_address &= 0x00FFFFFF; */
     return;
 }
 
 static void set_color_image(void)
 {
-    fb_format  = (cmd_data[cmd_cur + 0].UW32[0] & 0x00E00000) >> (53 - 32);
-    fb_size    = (cmd_data[cmd_cur + 0].UW32[0] & 0x00180000) >> (51 - 32);
-    fb_width   = (cmd_data[cmd_cur + 0].UW32[0] & 0x000003FF) >> (32 - 32);
-    fb_address = (cmd_data[cmd_cur + 0].UW32[1] & 0x03FFFFFF) >> ( 0 -  0);
-    ++fb_width;
+    rdp_state->fb_format  = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00E00000) >> (53 - 32);
+    rdp_state->fb_size    = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x00180000) >> (51 - 32);
+    rdp_state->fb_width   = (cmd_data[rdp_state->cmd_cur + 0].UW32[0] & 0x000003FF) >> (32 - 32);
+    rdp_state->fb_address = (cmd_data[rdp_state->cmd_cur + 0].UW32[1] & 0x03FFFFFF) >> ( 0 -  0);
+    ++rdp_state->fb_width;
  /* fb_address &= 0x00FFFFFF; */
     return;
 }
@@ -1248,6 +1542,7 @@ static NOINLINE void draw_triangle(int shade, int texture, int zbuffer)
     i32 d_stwz_dxh[4];
     i32 d_rgba_diff[4], d_stwz_diff[4];
     i32 xlr[2], xlr_inc[2];
+    int minmax[2]; /* reset at each scanline */
     u8 xfrac;
 #ifdef USE_SSE_SUPPORT
     __m128i xmm_d_rgba_de, xmm_d_stwz_de;
@@ -1261,10 +1556,10 @@ static NOINLINE void draw_triangle(int shade, int texture, int zbuffer)
     int allover, allunder, curover, curunder;
     int allinval;
     register int j, k;
-    const i32 clipxlshift = __clip.xl << 1;
-    const i32 clipxhshift = __clip.xh << 1;
+    const i32 clipxlshift = rdp_state->__clip.xl << 1;
+    const i32 clipxhshift = rdp_state->__clip.xh << 1;
 
-    base = cmd_cur + 0;
+    base = rdp_state->cmd_cur + 0;
     setzero_si64(rgba_int);
     setzero_si64(rgba_frac);
     setzero_si64(d_rgba_dx_int);
@@ -1290,7 +1585,7 @@ static NOINLINE void draw_triangle(int shade, int texture, int zbuffer)
     level = (cmd_data[base + 0].UW32[0] & 0x00380000) >> (51 - 32);
     tile  = (cmd_data[base + 0].UW32[0] & 0x00070000) >> (48 - 32);
     flip = lft;
-    max_level = level;
+    rdp_state->max_level = level;
     tilenum = tile;
 
     yl = (cmd_data[base + 0].UW32[0] & 0x0000FFFF) >> (32 - 32); /* & 0x3FFF */
@@ -1523,44 +1818,44 @@ no_read_zbuffer_coefficients:
 /*
  * rest of edgewalker algorithm
  */
-    spans_d_rgba[0] = d_rgba_dx[0] & ~0x0000001F;
-    spans_d_rgba[1] = d_rgba_dx[1] & ~0x0000001F;
-    spans_d_rgba[2] = d_rgba_dx[2] & ~0x0000001F;
-    spans_d_rgba[3] = d_rgba_dx[3] & ~0x0000001F;
-    spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
-    spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
-    spans_d_stwz[2] = d_stwz_dx[2] & ~0x0000001F;
-    spans_d_stwz[3] = d_stwz_dx[3];
-
-    spans_d_rgba_dy[0] = d_rgba_dy[0] >> 14;
-    spans_d_rgba_dy[1] = d_rgba_dy[1] >> 14;
-    spans_d_rgba_dy[2] = d_rgba_dy[2] >> 14;
-    spans_d_rgba_dy[3] = d_rgba_dy[3] >> 14;
-    spans_d_rgba_dy[0] = SIGN(spans_d_rgba_dy[0], 13);
-    spans_d_rgba_dy[1] = SIGN(spans_d_rgba_dy[1], 13);
-    spans_d_rgba_dy[2] = SIGN(spans_d_rgba_dy[2], 13);
-    spans_d_rgba_dy[3] = SIGN(spans_d_rgba_dy[3], 13);
-
-    spans_cd_rgba[0] = spans_d_rgba[0] >> 14;
-    spans_cd_rgba[1] = spans_d_rgba[1] >> 14;
-    spans_cd_rgba[2] = spans_d_rgba[2] >> 14;
-    spans_cd_rgba[3] = spans_d_rgba[3] >> 14;
-    spans_cd_rgba[0] = SIGN(spans_cd_rgba[0], 13);
-    spans_cd_rgba[1] = SIGN(spans_cd_rgba[1], 13);
-    spans_cd_rgba[2] = SIGN(spans_cd_rgba[2], 13);
-    spans_cd_rgba[3] = SIGN(spans_cd_rgba[3], 13);
-    spans_cdz = spans_d_stwz[3] >> 10;
-    spans_cdz = SIGN(spans_cdz, 22);
-
-    spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
-    spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
-    spans_d_stwz_dy[2] = d_stwz_dy[2] & ~0x00007FFF;
-    spans_d_stwz_dy[3] = d_stwz_dy[3] >> 10;
-    spans_d_stwz_dy[3] = SIGN(spans_d_stwz_dy[3], 22);
+    rdp_state->spans_d_rgba[0] = d_rgba_dx[0] & ~0x0000001F;
+    rdp_state->spans_d_rgba[1] = d_rgba_dx[1] & ~0x0000001F;
+    rdp_state->spans_d_rgba[2] = d_rgba_dx[2] & ~0x0000001F;
+    rdp_state->spans_d_rgba[3] = d_rgba_dx[3] & ~0x0000001F;
+    rdp_state->spans_d_stwz[0] = d_stwz_dx[0] & ~0x0000001F;
+    rdp_state->spans_d_stwz[1] = d_stwz_dx[1] & ~0x0000001F;
+    rdp_state->spans_d_stwz[2] = d_stwz_dx[2] & ~0x0000001F;
+    rdp_state->spans_d_stwz[3] = d_stwz_dx[3];
+
+    rdp_state->spans_d_rgba_dy[0] = d_rgba_dy[0] >> 14;
+    rdp_state->spans_d_rgba_dy[1] = d_rgba_dy[1] >> 14;
+    rdp_state->spans_d_rgba_dy[2] = d_rgba_dy[2] >> 14;
+    rdp_state->spans_d_rgba_dy[3] = d_rgba_dy[3] >> 14;
+    rdp_state->spans_d_rgba_dy[0] = SIGN(rdp_state->spans_d_rgba_dy[0], 13);
+    rdp_state->spans_d_rgba_dy[1] = SIGN(rdp_state->spans_d_rgba_dy[1], 13);
+    rdp_state->spans_d_rgba_dy[2] = SIGN(rdp_state->spans_d_rgba_dy[2], 13);
+    rdp_state->spans_d_rgba_dy[3] = SIGN(rdp_state->spans_d_rgba_dy[3], 13);
+
+    rdp_state->spans_cd_rgba[0] = rdp_state->spans_d_rgba[0] >> 14;
+    rdp_state->spans_cd_rgba[1] = rdp_state->spans_d_rgba[1] >> 14;
+    rdp_state->spans_cd_rgba[2] = rdp_state->spans_d_rgba[2] >> 14;
+    rdp_state->spans_cd_rgba[3] = rdp_state->spans_d_rgba[3] >> 14;
+    rdp_state->spans_cd_rgba[0] = SIGN(rdp_state->spans_cd_rgba[0], 13);
+    rdp_state->spans_cd_rgba[1] = SIGN(rdp_state->spans_cd_rgba[1], 13);
+    rdp_state->spans_cd_rgba[2] = SIGN(rdp_state->spans_cd_rgba[2], 13);
+    rdp_state->spans_cd_rgba[3] = SIGN(rdp_state->spans_cd_rgba[3], 13);
+    rdp_state->spans_cdz = rdp_state->spans_d_stwz[3] >> 10;
+    rdp_state->spans_cdz = SIGN(rdp_state->spans_cdz, 22);
+
+    rdp_state->spans_d_stwz_dy[0] = d_stwz_dy[0] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[1] = d_stwz_dy[1] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[2] = d_stwz_dy[2] & ~0x00007FFF;
+    rdp_state->spans_d_stwz_dy[3] = d_stwz_dy[3] >> 10;
+    rdp_state->spans_d_stwz_dy[3] = SIGN(rdp_state->spans_d_stwz_dy[3], 22);
 
     d_stwz_dx_int[3] ^= (d_stwz_dx_int[3] < 0) ? ~0 : 0;
     d_stwz_dy_int[3] ^= (d_stwz_dy_int[3] < 0) ? ~0 : 0;
-    spans_dzpix = normalize_dzpix(d_stwz_dx_int[3] + d_stwz_dy_int[3]);
+    rdp_state->spans_dzpix = normalize_dzpix(d_stwz_dx_int[3] + d_stwz_dy_int[3]);
 
     sign_dxhdy = (DxHDy < 0);
     if (sign_dxhdy ^ flip) /* !do_offset */
@@ -1609,7 +1904,7 @@ no_read_zbuffer_coefficients:
         d_stwz_diff[3] -= (d_stwz_diff[3] >> 2);
     }
 
-    if (other_modes.cycle_type == CYCLE_TYPE_COPY)
+    if (rdp_state->other_modes.cycle_type == CYCLE_TYPE_COPY)
     {
         setzero_si128(d_rgba_dxh);
         setzero_si128(d_stwz_dxh);
@@ -1628,16 +1923,16 @@ no_read_zbuffer_coefficients:
 
     ldflag = (sign_dxhdy ^ flip) ? 0 : 3;
     invaly = 1;
-    yllimit = (yl - __clip.yl < 0) ? yl : __clip.yl; /* clip.yl always &= 0xFFF */
+    yllimit = (yl - rdp_state->__clip.yl < 0) ? yl : rdp_state->__clip.yl; /* clip.yl always &= 0xFFF */
 
     ycur = yh & ~3;
     ylfar = yllimit | 3;
     if (yl >> 2 > ylfar >> 2)
         ylfar += 4;
     else if (yllimit >> 2 >= 0 && yllimit >> 2 < 1023)
-        span[(yllimit >> 2) + 1].validline = 0;
+        rdp_state->span[(yllimit >> 2) + 1].validline = 0;
 
-    yhlimit = (yh - __clip.yh >= 0) ? yh : __clip.yh; /* clip.yh always &= 0xFFF */
+    yhlimit = (yh - rdp_state->__clip.yh >= 0) ? yh : rdp_state->__clip.yh; /* clip.yh always &= 0xFFF */
 
     xlr_inc[0] = (DxMDy >> 2) & ~0x00000001;
     xlr_inc[1] = (DxHDy >> 2) & ~0x00000001;
@@ -1653,7 +1948,6 @@ no_read_zbuffer_coefficients:
 
     for (k = ycur; k <= ylfar; k++)
     {
-        static int minmax[2];
         int stickybit;
         int xlrsc[2];
         const int spix = k & 3;
@@ -1689,7 +1983,7 @@ no_read_zbuffer_coefficients:
             xlrsc[1] = xlrsc[1] & 0x1FFF;
             curover |= (u32)~(xlrsc[1] - clipxlshift) >> 31;
             xlrsc[1] = curover ? clipxlshift : xlrsc[1];
-            span[j].majorx[spix] = xlrsc[1] & 0x1FFF;
+            rdp_state->span[j].majorx[spix] = xlrsc[1] & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
@@ -1703,14 +1997,14 @@ no_read_zbuffer_coefficients:
             xlrsc[0] &= 0x1FFF;
             curover |= (u32)~(xlrsc[0] - clipxlshift) >> 31;
             xlrsc[0] = curover ? clipxlshift : xlrsc[0];
-            span[j].minorx[spix] = xlrsc[0] & 0x1FFF;
+            rdp_state->span[j].minorx[spix] = xlrsc[0] & 0x1FFF;
             allover &= curover;
             allunder &= curunder;
 
             curcross = ((xlr[1 - flip]&0x0FFFC000 ^ 0x08000000)
                      <  (xlr[0 + flip]&0x0FFFC000 ^ 0x08000000));
             invaly |= curcross;
-            span[j].invalyscan[spix] = invaly;
+            rdp_state->span[j].invalyscan[spix] = invaly;
             allinval &= invaly;
             if (invaly != 0)
                 { /* branch */ }
@@ -1732,7 +2026,7 @@ no_read_zbuffer_coefficients:
                 __m128i prod_hi, prod_lo;
                 __m128i result;
 
-                span[j].unscrx = xlr[1] >> 16;
+                rdp_state->span[j].unscrx = xlr[1] >> 16;
                 xfrac = (xlr[1] >> 8) & 0xFF;
                 xmm_frac = _mm_set1_epi32(xfrac);
 
@@ -1752,7 +2046,7 @@ no_read_zbuffer_coefficients:
                 result = _mm_sub_epi32(result, delta_x_high);
                 result = _mm_srli_epi32(result, 10);
                 result = _mm_slli_epi32(result, 10);
-                _mm_store_si128((__m128i *)span[j].rgba, result);
+                _mm_store_si128((__m128i *)rdp_state->span[j].rgba, result);
 
                 delta_x_high = _mm_load_si128((__m128i *)d_stwz_dxh);
                 prod_lo = _mm_mul_epu32(delta_x_high, xmm_frac);
@@ -1770,45 +2064,45 @@ no_read_zbuffer_coefficients:
                 result = _mm_sub_epi32(result, delta_x_high);
                 result = _mm_srli_epi32(result, 10);
                 result = _mm_slli_epi32(result, 10);
-                _mm_store_si128((__m128i *)span[j].stwz, result);
+                _mm_store_si128((__m128i *)rdp_state->span[j].stwz, result);
             }
 #else
             {
-                span[j].unscrx = xlr[1] >> 16;
+                rdp_state->span[j].unscrx = xlr[1] >> 16;
                 xfrac = (xlr[1] >> 8) & 0xFF;
-                span[j].rgba[0]
+                rdp_state->span[j].rgba[0]
                   = ((rgba[0] & ~0x1FF) + d_rgba_diff[0] - xfrac*d_rgba_dxh[0])
                   & ~0x000003FF;
-                span[j].rgba[1]
+                rdp_state->span[j].rgba[1]
                   = ((rgba[1] & ~0x1FF) + d_rgba_diff[1] - xfrac*d_rgba_dxh[1])
                   & ~0x000003FF;
-                span[j].rgba[2]
+                rdp_state->span[j].rgba[2]
                   = ((rgba[2] & ~0x1FF) + d_rgba_diff[2] - xfrac*d_rgba_dxh[2])
                   & ~0x000003FF;
-                span[j].rgba[3]
+                rdp_state->span[j].rgba[3]
                   = ((rgba[3] & ~0x1FF) + d_rgba_diff[3] - xfrac*d_rgba_dxh[3])
                   & ~0x000003FF;
-                span[j].stwz[0]
+                rdp_state->span[j].stwz[0]
                   = ((stwz[0] & ~0x1FF) + d_stwz_diff[0] - xfrac*d_stwz_dxh[0])
                   & ~0x000003FF;
-                span[j].stwz[1]
+                rdp_state->span[j].stwz[1]
                   = ((stwz[1] & ~0x1FF) + d_stwz_diff[1] - xfrac*d_stwz_dxh[1])
                   & ~0x000003FF;
-                span[j].stwz[2]
+                rdp_state->span[j].stwz[2]
                   = ((stwz[2] & ~0x1FF) + d_stwz_diff[2] - xfrac*d_stwz_dxh[2])
                   & ~0x000003FF;
-                span[j].stwz[3]
+                rdp_state->span[j].stwz[3]
                   = ((stwz[3] & ~0x1FF) + d_stwz_diff[3] - xfrac*d_stwz_dxh[3])
                   & ~0x000003FF;
             }
 #endif
             if (spix == 3)
             {
-                const int invalidline = (sckeepodd ^ j) & scfield
+                const int invalidline = (rdp_state->sckeepodd ^ j) & rdp_state->scfield
                                       | (allinval | allover | allunder);
-                span[j].lx = minmax[flip - 0];
-                span[j].rx = minmax[1 - flip];
-                span[j].validline = invalidline ^ 1;
+                rdp_state->span[j].lx = minmax[flip - 0];
+                rdp_state->span[j].rx = minmax[1 - flip];
+                rdp_state->span[j].validline = invalidline ^ 1;
             }
         }
         if (spix == 3)
@@ -1851,18 +2145,19 @@ STRICTINLINE static u16 normalize_dzpix(u16 sum)
 NOINLINE static void render_spans(
     int yhlimit, int yllimit, int tilenum, int flip)
 {
-    const unsigned int cycle_type = other_modes.cycle_type & 03;
+    const unsigned int cycle_type = rdp_state->other_modes.cycle_type & 03;
 
-    if (other_modes.f.stalederivs == 0)
+    ++rdp_state->primitive_count;
+    if (rdp_state->other_modes.f.stalederivs == 0)
         { /* branch */ }
     else
     {
         deduce_derivatives();
-        other_modes.f.stalederivs = 0;
+        rdp_state->other_modes.f.stalederivs = 0;
     }
-    fbread1_ptr = fbread_func[fb_size];
-    fbread2_ptr = fbread2_func[fb_size];
-    fbwrite_ptr = fbwrite_func[fb_size];
+    rdp_state->fbread1_ptr = fbread_func[rdp_state->fb_size];
+    rdp_state->fbread2_ptr = fbread2_func[rdp_state->fb_size];
+    rdp_state->fbwrite_ptr = fbwrite_func[rdp_state->fb_size];
 
 #ifdef _DEBUG
     ++render_cycle_mode_counts[cycle_type];
@@ -1875,9 +2170,9 @@ NOINLINE static void render_spans(
             render_spans_copy(yhlimit, yllimit, tilenum, flip);
     else
         if (cycle_type & 01)
-            render_spans_2cycle_ptr(yhlimit, yllimit, tilenum, flip);
+            rdp_state->render_spans_2cycle_ptr(yhlimit, yllimit, tilenum, flip);
         else
-            render_spans_1cycle_ptr(yhlimit, yllimit, tilenum, flip);
+            rdp_state->render_spans_1cycle_ptr(yhlimit, yllimit, tilenum, flip);
     return;
 }
 
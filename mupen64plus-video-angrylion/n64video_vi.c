@@ -26,29 +26,8 @@ static UINT32 tvfadeoutstate[625];
 static UINT32 brightness = 0;
 static UINT32 prevwasblank = 0;
 
-STRICTINLINE static void video_filter16(
-    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres,
-    UINT32 centercvg);
-STRICTINLINE static void video_filter32(
-    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
-    UINT32 centercvg);
-STRICTINLINE static void divot_filter(
-    CCVG* final, CCVG centercolor, CCVG leftcolor, CCVG rightcolor);
-STRICTINLINE static void restore_filter16(
-    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres);
-STRICTINLINE static void restore_filter32(
-    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres);
-static void gamma_filters(unsigned char* argb, int gamma_and_dither);
 static void adjust_brightness(unsigned char* argb, int brightcoeff);
 STRICTINLINE static void vi_vl_lerp(CCVG* up, CCVG down, UINT32 frac);
-STRICTINLINE static void video_max_optimized(UINT32* Pixels, UINT32* pen);
-
-STRICTINLINE static void vi_fetch_filter16(
-    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fsaa, UINT32 dither_filter,
-    UINT32 vres);
-STRICTINLINE static void vi_fetch_filter32(
-    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fsaa, UINT32 dither_filter,
-    UINT32 vres);
 
 static void do_frame_buffer_proper(
     UINT32 prescale_ptr, int hres, int vres, int x_start, int vitype,
@@ -60,11 +39,9 @@ static void (*do_frame_buffer[2])(UINT32, int, int, int, int, int) = {
     do_frame_buffer_raw, do_frame_buffer_proper
 };
 
-static void (*vi_fetch_filter_ptr)(
-    CCVG*, UINT32, UINT32, UINT32, UINT32, UINT32);
-static void (*vi_fetch_filter_func[2])(
-    CCVG*, UINT32, UINT32, UINT32, UINT32, UINT32) = {
-    vi_fetch_filter16, vi_fetch_filter32
+static void (*vi_fetch_filter_row[2])(
+    CCVG*, UINT32, UINT32, int, UINT32, UINT32, UINT32) = {
+    vi_fetch_filter16_row, vi_fetch_filter32_row
 };
 
 void rdp_update(void)
@@ -245,7 +222,7 @@ static void do_frame_buffer_proper(
     UINT32 prescale_ptr, int hres, int vres, int x_start, int vitype,
     int linecount)
 {
-    CCVG viaa_array[2048];
+    CCVG viaa_array[2 + 2048];
     CCVG divot_array[2048];
     CCVG *viaa_cache, *viaa_cache_next, *divot_cache, *divot_cache_next;
     CCVG *tempccvgptr;
@@ -256,9 +233,8 @@ static void do_frame_buffer_proper(
     UINT32 y_start = (vi_y_scale >> 16) & 0x0FFF;
 	UINT32 frame_buffer = vi_origin & 0x00FFFFFF;
     signed int cache_marker_init;
-    int line_x = 0, next_line_x = 0, prev_line_x = 0, far_line_x = 0;
-    int prev_scan_x = 0, scan_x = 0, next_scan_x = 0, far_scan_x = 0;
-    int prev_x = 0, cur_x = 0, next_x = 0, far_x = 0;
+    int line_x = 0, next_line_x = 0;
+    int fetch_start, fetch_end;
     int cache_marker = 0, cache_next_marker = 0, divot_cache_marker = 0, divot_cache_next_marker = 0;
     int xfrac = 0, yfrac = 0;
     int slowbright;
@@ -287,13 +263,22 @@ static void do_frame_buffer_proper(
             "turning this bit on will result in permanent damage to the "\
             "hardware! Emulation will now continue.");
 
-    viaa_cache = &viaa_array[0];
-    viaa_cache_next = &viaa_array[1024];
+    viaa_cache = &viaa_array[1];
+    viaa_cache_next = &viaa_array[1 + 1024 + 1];
     divot_cache = &divot_array[0];
     divot_cache_next = &divot_array[1024];
 
-    cache_marker_init  = (x_start >> 10) - 2;
-    cache_marker_init |= -(cache_marker_init < 0);
+    /*
+     * The divot filter of column 0 reads column -1, so that one is fetched
+     * too, into the slot in front of each viaa cache.
+     */
+    cache_marker_init = (x_start >> 10) - 2;
+    if (cache_marker_init < -2)
+        cache_marker_init = -2;
+
+    fetch_start = (((vi_x_scale >> 16) & 0x0FFF) >> 10) - 1;
+    fetch_end = ((((vi_x_scale >> 16) & 0x0FFF) + (hres - 1)*x_add) >> 10) + 1;
+    fetch_end += divot;
 
     slowbright = 0;
 #if 0
@@ -345,150 +330,84 @@ static void do_frame_buffer_proper(
         pixels = vi_width_low * prevy;
         nextpixels = pixels + vi_width_low;
 
-        for (i = 0; i < hres; i++)
+        /*
+         * Every scanline reads the same columns, from prev_line_x of the
+         * first pixel to next_line_x (far_line_x with divot) of the last
+         * one, so filter all of them that the caches miss in one go. When
+         * x_add is over 1.0 this also filters the columns skipped between
+         * pixels, which nothing reads.
+         */
+        if (hres > 0)
         {
-            unsigned char argb[4];
-
-            line_x = x_start >> 10;
-            prev_line_x = line_x - 1;
-            next_line_x = line_x + 1;
-            far_line_x = line_x + 2;
-
-            cur_x = pixels + line_x;
-            prev_x = pixels + prev_line_x;
-            next_x = pixels + next_line_x;
-            far_x = pixels + far_line_x;
-
-            scan_x = nextpixels + line_x;
-            prev_scan_x = nextpixels + prev_line_x;
-            next_scan_x = nextpixels + next_line_x;
-            far_scan_x = nextpixels + far_line_x;
+            if (fetch_end > cache_marker)
+            {
+                int start = cache_marker + 1;
 
-            xfrac = (x_start >> 5) & 0x1f;
-            lerping = lerp_en & (xfrac || yfrac);
+                if (start < fetch_start)
+                    start = fetch_start;
 
-            if (prev_line_x > cache_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[prev_line_x], frame_buffer, prev_x, fsaa,
-                    dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[line_x], frame_buffer, cur_x, fsaa,
-                    dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter, vres);
-                cache_marker = next_line_x;
+                vi_fetch_filter_row[vitype & 1](
+                    &viaa_cache[start], frame_buffer, pixels + start,
+                    fetch_end - start + 1, vi_width_low, fsaa, dither_filter);
+                cache_marker = fetch_end;
             }
-            else if (line_x > cache_marker)
+            if (fetch_end > cache_next_marker)
             {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[line_x], frame_buffer, cur_x, fsaa,
-                    dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter, vres);
-                cache_marker = next_line_x;
-            }
-            else if (next_line_x > cache_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache[next_line_x], frame_buffer, next_x, fsaa,
-                    dither_filter, vres);
-                cache_marker = next_line_x;
-            }
+                int start = cache_next_marker + 1;
 
-            if (prev_line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[prev_line_x], frame_buffer, prev_scan_x,
-                    fsaa, dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[line_x], frame_buffer, scan_x, fsaa,
-                    dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter, vres);
-                cache_next_marker = next_line_x;
-            }
-            else if (line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[line_x], frame_buffer, scan_x, fsaa,
-                    dither_filter, vres);
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter, vres);
-                cache_next_marker = next_line_x;
-            }
-            else if (next_line_x > cache_next_marker)
-            {
-                vi_fetch_filter_func[vitype & 1](
-                    &viaa_cache_next[next_line_x], frame_buffer, next_scan_x,
-                    fsaa, dither_filter, vres);
-                cache_next_marker = next_line_x;
-            }
+                if (start < fetch_start)
+                    start = fetch_start;
 
+                vi_fetch_filter_row[vitype & 1](
+                    &viaa_cache_next[start], frame_buffer, nextpixels + start,
+                    fetch_end - start + 1, vi_width_low, fsaa, dither_filter);
+                cache_next_marker = fetch_end;
+            }
             if (divot == 0)
-                color = viaa_cache[line_x];
+                {/* do nothing and branch */}
             else
             {
-                if (far_line_x > cache_marker)
+                if (fetch_end - 1 > divot_cache_marker)
                 {
-                    vi_fetch_filter_func[vitype & 1](
-                        &viaa_cache[far_line_x], frame_buffer, far_x, fsaa,
-                        dither_filter, vres);
-                    cache_marker = far_line_x;
-                }
+                    int start = divot_cache_marker + 1;
 
-                if (far_line_x > cache_next_marker)
-                {
-                    vi_fetch_filter_func[vitype & 1](
-                        &viaa_cache_next[far_line_x], frame_buffer, far_scan_x,
-                        fsaa, dither_filter, vres);
-                    cache_next_marker = far_line_x;
-                }
+                    if (start < fetch_start + 1)
+                        start = fetch_start + 1;
 
-                if (line_x > divot_cache_marker)
-                {
-                    divot_filter(
-                        &divot_cache[line_x], viaa_cache[line_x],
-                        viaa_cache[prev_line_x], viaa_cache[next_line_x]);
-                    divot_filter(
-                        &divot_cache[next_line_x], viaa_cache[next_line_x],
-                        viaa_cache[line_x], viaa_cache[far_line_x]);
-                    divot_cache_marker = next_line_x;
+                    divot_filter_row(
+                        &divot_cache[start], &viaa_cache[start],
+                        fetch_end - start);
+                    divot_cache_marker = fetch_end - 1;
                 }
-                else if (next_line_x > divot_cache_marker)
+                if (fetch_end - 1 > divot_cache_next_marker)
                 {
-                    divot_filter(
-                        &divot_cache[next_line_x], viaa_cache[next_line_x],
-                        viaa_cache[line_x], viaa_cache[far_line_x]);
-                    divot_cache_marker = next_line_x;
-                }
+                    int start = divot_cache_next_marker + 1;
 
-                if (line_x > divot_cache_next_marker)
-                {
-                    divot_filter(
-                        &divot_cache_next[line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[prev_line_x],
-                        viaa_cache_next[next_line_x]);
-                    divot_filter(
-                        &divot_cache_next[next_line_x],
-                        viaa_cache_next[next_line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[far_line_x]);
-                    divot_cache_next_marker = next_line_x;
-                }
-                else if (next_line_x > divot_cache_next_marker)
-                {
-                    divot_filter(
-                        &divot_cache_next[next_line_x],
-                        viaa_cache_next[next_line_x], viaa_cache_next[line_x],
-                        viaa_cache_next[far_line_x]);
-                    divot_cache_next_marker = next_line_x;
+                    if (start < fetch_start + 1)
+                        start = fetch_start + 1;
+
+                    divot_filter_row(
+                        &divot_cache_next[start], &viaa_cache_next[start],
+                        fetch_end - start);
+                    divot_cache_next_marker = fetch_end - 1;
                 }
-                color = divot_cache[line_x];
             }
+        }
+
+        for (i = 0; i < hres; i++)
+        {
+            unsigned char argb[4];
+
+            line_x = x_start >> 10;
+            next_line_x = line_x + 1;
+
+            xfrac = (x_start >> 5) & 0x1f;
+            lerping = lerp_en & (xfrac || yfrac);
+
+            if (divot == 0)
+                color = viaa_cache[line_x];
+            else
+                color = divot_cache[line_x];
 
             if (lerping)
             {
@@ -520,7 +439,6 @@ static void do_frame_buffer_proper(
             argb[2 ^ BYTE_ADDR_XOR] = color.g;
             argb[3 ^ BYTE_ADDR_XOR] = color.b;
 
-            gamma_filters(argb, gamma_and_dither);
 #ifdef BW_ZBUFFER
             UINT32 tempz = RREADIDX16((frame_buffer >> 1) + cur_x);
 
@@ -551,11 +469,12 @@ static void do_frame_buffer_proper(
 #endif
             x_start += x_add;
             scanline[i] = *(INT32 *)(argb);
-            if (slowbright == 0)
-                continue;
-            adjust_brightness(argb, slowbright);
-            scanline[i] = *(INT32 *)(argb);
         }
+
+        gamma_filters_row(scanline, hres, gamma_and_dither);
+        if (slowbright != 0)
+            for (i = 0; i < hres; i++)
+                adjust_brightness((unsigned char *)&scanline[i], slowbright);
         y_start += y_add;
     }
 }
@@ -648,356 +567,6 @@ static void do_frame_buffer_raw(
     return;
 }
 
-STRICTINLINE static void vi_fetch_filter16(
-    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fsaa, UINT32 dither_filter,
-    UINT32 vres)
-{
-    int r, g, b;
-    UINT32 pix, hval;
-    UINT32 cur_cvg;
-    UINT32 idx = (fboffset >> 1) + cur_x;
-    UINT32 fbw = vi_width & 0xfff;
-
-    PAIRREAD16(pix, hval, idx); 
-    if (fsaa)
-        cur_cvg = ((pix & 1) << 2) | hval;
-    else
-        cur_cvg = 7;
-    r = GET_HI(pix);
-    g = GET_MED(pix);
-    b = GET_LOW(pix);
-
-    if (cur_cvg == 7)
-    {
-        if (dither_filter)
-            restore_filter16(&r, &g, &b, fboffset, cur_x, fbw);
-    }
-    else
-    {
-        video_filter16(&r, &g, &b, fboffset, cur_x, fbw, cur_cvg);
-    }
-
-    res -> r = r;
-    res -> g = g;
-    res -> b = b;
-    res -> cvg = cur_cvg;
-    return;
-}
-
-STRICTINLINE static void vi_fetch_filter32(
-    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fsaa, UINT32 dither_filter,
-    UINT32 vres)
-{
-    int r, g, b;
-    UINT32 cur_cvg;
-    UINT32 pix = RREADIDX32((fboffset >> 2) + cur_x);
-    UINT32 fbw = vi_width & 0xfff;
-
-    if (fsaa)
-        cur_cvg = (pix >> 5) & 7;
-    else
-        cur_cvg = 7;
-
-    r = (pix >> 24) & 0xff;
-    g = (pix >> 16) & 0xff;
-    b = (pix >> 8) & 0xff;
-
-    if (cur_cvg == 7)
-    {
-        if (dither_filter)
-            restore_filter32(&r, &g, &b, fboffset, cur_x, fbw);
-    }
-    else
-    {
-        video_filter32(&r, &g, &b, fboffset, cur_x, fbw, cur_cvg);
-    }
-
-    res -> r = r;
-    res -> g = g;
-    res -> b = b;
-    res -> cvg = cur_cvg;
-    return;
-}
-
-STRICTINLINE static void video_filter16(
-    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
-    UINT32 centercvg)
-{
-    UINT32 penumaxr, penumaxg, penumaxb, penuminr, penuming, penuminb;
-    UINT16 pix;
-    UINT32 numoffull = 1;
-    UINT32 hidval;
-    UINT32 r, g, b; 
-    UINT32 backr[7], backg[7], backb[7];
-    UINT32 invr[7], invg[7], invb[7];
-    UINT32 colr, colg, colb;
-
-    UINT32 idx = (fboffset >> 1) + num;
-    UINT32 leftup = idx - hres - 1;
-    UINT32 rightup = idx - hres + 1;
-    UINT32 toleft = idx - 2;
-    UINT32 toright = idx + 2;
-    UINT32 leftdown = idx + hres - 1;
-    UINT32 rightdown = idx + hres + 1;
-    UINT32 coeff = 7 - centercvg;
-
-    r = *endr;
-    g = *endg;
-    b = *endb;
-
-    backr[0] = r;
-    backg[0] = g;
-    backb[0] = b;
-    invr[0] = (~r) & 0xff;
-    invg[0] = (~g) & 0xff;
-    invb[0] = (~b) & 0xff;
-
-    VI_ANDER(leftup);
-    VI_ANDER(rightup);
-    VI_ANDER(toleft);
-    VI_ANDER(toright);
-    VI_ANDER(leftdown);
-    VI_ANDER(rightdown);
-
-    video_max_optimized(&backr[0], &penumaxr);
-    video_max_optimized(&backg[0], &penumaxg);
-    video_max_optimized(&backb[0], &penumaxb);
-    video_max_optimized(&invr[0], &penuminr);
-    video_max_optimized(&invg[0], &penuming);
-    video_max_optimized(&invb[0], &penuminb);
-
-    penuminr = (~penuminr) & 0xFF;
-    penuming = (~penuming) & 0xFF;
-    penuminb = (~penuminb) & 0xFF;
-
-    colr = penuminr + penumaxr - (r << 1);
-    colg = penuming + penumaxg - (g << 1);
-    colb = penuminb + penumaxb - (b << 1);
-
-    colr = (((colr * coeff) + 4) >> 3) + r;
-    colg = (((colg * coeff) + 4) >> 3) + g;
-    colb = (((colb * coeff) + 4) >> 3) + b;
-
-    *endr = colr & 0xFF;
-    *endg = colg & 0xFF;
-    *endb = colb & 0xFF;
-    return;
-}
-
-STRICTINLINE static void video_filter32(
-    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
-    UINT32 centercvg)
-{
-    UINT32 penumaxr, penumaxg, penumaxb, penuminr, penuming, penuminb;
-    UINT32 numoffull = 1;
-    UINT32 pix = 0, pixcvg = 0;
-    UINT32 r, g, b; 
-    UINT32 backr[7], backg[7], backb[7];
-    UINT32 invr[7], invg[7], invb[7];
-    UINT32 colr, colg, colb;
-
-    UINT32 idx = (fboffset >> 2) + num;
-    UINT32 leftup = idx - hres - 1;
-    UINT32 rightup = idx - hres + 1;
-    UINT32 toleft = idx - 2;
-    UINT32 toright = idx + 2;
-    UINT32 leftdown = idx + hres - 1;
-    UINT32 rightdown = idx + hres + 1;
-    UINT32 coeff = 7 - centercvg;
-
-    r = *endr;
-    g = *endg;
-    b = *endb;
-
-    backr[0] = r;
-    backg[0] = g;
-    backb[0] = b;
-    invr[0] = (~r) & 0xff;
-    invg[0] = (~g) & 0xff;
-    invb[0] = (~b) & 0xff;
-
-    VI_ANDER32(leftup);
-    VI_ANDER32(rightup);
-    VI_ANDER32(toleft);
-    VI_ANDER32(toright);
-    VI_ANDER32(leftdown);
-    VI_ANDER32(rightdown);
-
-    video_max_optimized(&backr[0], &penumaxr);
-    video_max_optimized(&backg[0], &penumaxg);
-    video_max_optimized(&backb[0], &penumaxb);
-    video_max_optimized(&invr[0], &penuminr);
-    video_max_optimized(&invg[0], &penuming);
-    video_max_optimized(&invb[0], &penuminb);
-
-    penuminr = (~penuminr) & 0xFF;
-    penuming = (~penuming) & 0xFF;
-    penuminb = (~penuminb) & 0xFF;
-
-    colr = penuminr + penumaxr - (r << 1);
-    colg = penuming + penumaxg - (g << 1);
-    colb = penuminb + penumaxb - (b << 1);
-
-    colr = (((colr * coeff) + 4) >> 3) + r;
-    colg = (((colg * coeff) + 4) >> 3) + g;
-    colb = (((colb * coeff) + 4) >> 3) + b;
-
-    *endr = colr & 0xFF;
-    *endg = colg & 0xFF;
-    *endb = colb & 0xFF;
-    return;
-}
-
-STRICTINLINE static void divot_filter(
-    CCVG* final, CCVG centercolor, CCVG leftcolor, CCVG rightcolor)
-{
-    UINT32 leftr, leftg, leftb;
-    UINT32 rightr, rightg, rightb;
-    UINT32 centerr, centerg, centerb;
-
-    *final = centercolor;
-    if ((centercolor.cvg & leftcolor.cvg & rightcolor.cvg) == 7)
-        return;
-
-    leftr = leftcolor.r;    
-    leftg = leftcolor.g;    
-    leftb = leftcolor.b;
-    rightr = rightcolor.r;    
-    rightg = rightcolor.g;    
-    rightb = rightcolor.b;
-    centerr = centercolor.r;
-    centerg = centercolor.g;
-    centerb = centercolor.b;
-
-    if ((leftr >= centerr && rightr >= leftr) || (leftr >= rightr && centerr >= leftr))
-        final -> r = leftr;
-    else if ((rightr >= centerr && leftr >= rightr) || (rightr >= leftr && centerr >= rightr))
-        final -> r = rightr;
-
-    if ((leftg >= centerg && rightg >= leftg) || (leftg >= rightg && centerg >= leftg))
-        final -> g = leftg;
-    else if ((rightg >= centerg && leftg >= rightg) || (rightg >= leftg && centerg >= rightg))
-        final -> g = rightg;
-
-    if ((leftb >= centerb && rightb >= leftb) || (leftb >= rightb && centerb >= leftb))
-        final -> b = leftb;
-    else if ((rightb >= centerb && leftb >= rightb) || (rightb >= leftb && centerb >= rightb))
-        final -> b = rightb;
-    return;
-}
-
-STRICTINLINE static void restore_filter16(
-    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres)
-{
-    UINT32 tempr, tempg, tempb;
-    UINT16 pix;
-
-    UINT32 idx = (fboffset >> 1) + num;
-    UINT32 leftuppix = idx - hres - 1;
-    UINT32 leftdownpix = idx + hres - 1;
-    UINT32 toleftpix = idx - 1;
-
-    UINT32 rend = *r;
-    UINT32 gend = *g;
-    UINT32 bend = *b;
-    UINT32 rcomp = (rend >> 3) & 31;
-    UINT32 gcomp = (gend >> 3) & 31;
-    UINT32 bcomp = (bend >> 3) & 31;
-
-    VI_COMPARE(leftuppix);
-    VI_COMPARE(leftuppix + 1);
-    VI_COMPARE(leftuppix + 2);
-    VI_COMPARE(leftdownpix);
-    VI_COMPARE(leftdownpix + 1);
-    VI_COMPARE(leftdownpix + 2);
-    VI_COMPARE(toleftpix);
-    VI_COMPARE(toleftpix + 2);
-
-    *r = rend;
-    *g = gend;
-    *b = bend;
-    return;
-}
-
-STRICTINLINE static void restore_filter32(
-    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres)
-{
-    UINT32 tempr, tempg, tempb;
-    UINT32 pix;
-
-    UINT32 idx = (fboffset >> 2) + num;
-    UINT32 leftuppix = idx - hres - 1;
-    UINT32 leftdownpix = idx + hres - 1;
-    UINT32 toleftpix = idx - 1;
-
-    UINT32 rend = *r;
-    UINT32 gend = *g;
-    UINT32 bend = *b;
-    UINT32 rcomp = (rend >> 3) & 31;
-    UINT32 gcomp = (gend >> 3) & 31;
-    UINT32 bcomp = (bend >> 3) & 31;
-
-    VI_COMPARE32(leftuppix);
-    VI_COMPARE32(leftuppix + 1);
-    VI_COMPARE32(leftuppix + 2);
-    VI_COMPARE32(leftdownpix);
-    VI_COMPARE32(leftdownpix + 1);
-    VI_COMPARE32(leftdownpix + 2);
-    VI_COMPARE32(toleftpix);
-    VI_COMPARE32(toleftpix + 2);
-
-    *r = rend;
-    *g = gend;
-    *b = bend;
-    return;
-}
-
-static void gamma_filters(unsigned char* argb, int gamma_and_dither)
-{
-    int cdith, dith;
-    int r, g, b;
-
-    r = argb[1 ^ BYTE_ADDR_XOR];
-    g = argb[2 ^ BYTE_ADDR_XOR];
-    b = argb[3 ^ BYTE_ADDR_XOR];
-    switch(gamma_and_dither)
-    {
-        case 0:
-            return;
-            break;
-        case 1:
-            cdith = irand();
-            dith = cdith & 1;
-            if (r < 255)
-                r += dith;
-            dith = (cdith >> 1) & 1;
-            if (g < 255)
-                g += dith;
-            dith = (cdith >> 2) & 1;
-            if (b < 255)
-                b += dith;
-            break;
-        case 2:
-            r = gamma_table[r];
-            g = gamma_table[g];
-            b = gamma_table[b];
-            break;
-        case 3:
-            cdith = irand();
-            dith = cdith & 0x3f;
-            r = gamma_dither_table[(r << 6) | dith];
-            dith = (cdith >> 6) & 0x3f;
-            g = gamma_dither_table[(g << 6) | dith];
-            dith = ((cdith >> 9) & 0x38) | (cdith & 7);
-            b = gamma_dither_table[(b << 6) | dith];
-            break;
-    }
-    argb[1 ^ BYTE_ADDR_XOR] = (unsigned char)(r);
-    argb[2 ^ BYTE_ADDR_XOR] = (unsigned char)(g);
-    argb[3 ^ BYTE_ADDR_XOR] = (unsigned char)(b);
-    return;
-}
-
 static void adjust_brightness(unsigned char* argb, int brightcoeff)
 {
     int r, g, b;
@@ -1061,37 +630,6 @@ STRICTINLINE static void vi_vl_lerp(CCVG* up, CCVG down, UINT32 frac)
     return;
 }
 
-STRICTINLINE static void video_max_optimized(UINT32* Pixels, UINT32* pen)
-{
-    int i;
-    int pos;
-    UINT32 max;
-    UINT32 curpen = Pixels[0];
-
-    pos = 0;
-    for (i = 1; i < 7; i++)
-    {
-        if (Pixels[i] > Pixels[pos])
-        {
-            curpen = Pixels[pos];
-            pos = i;            
-        }
-    }
-    max = Pixels[pos];
-    if (curpen != max)
-    {
-        for (i = pos + 1; i < 7; i++)
-        {
-            if (Pixels[i] > curpen)
-            {
-                curpen = Pixels[i];
-            }
-        }
-    }
-    *pen = curpen;
-    return;
-}
-
 NOINLINE void DisplayError(char * error)
 {
     //MessageBox(NULL, error, NULL, MB_ICONERROR);
@@ -0,0 +1,1127 @@
+#include "z64.h"
+#include "vi.h"
+
+/*
+ * The VI filters, a scanline of source pixels at a time. Each one has a
+ * per-pixel C version, which is also what the row functions fall back to
+ * at the edges of RDRAM and on hosts without SSE2 or NEON. The SIMD
+ * versions give the same bits; vi-filter-check builds this file a second
+ * time with VI_SCALAR_REFERENCE defined and compares the two. The NEON
+ * versions follow the SSE2 ones line for line.
+ */
+#if !defined(VI_SCALAR_REFERENCE)
+#if defined(USE_SSE_SUPPORT)
+#define VI_FILTER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VI_FILTER_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#ifdef VI_SCALAR_REFERENCE
+#define vi_fetch_filter16_row   vi_fetch_filter16_row_reference
+#define vi_fetch_filter32_row   vi_fetch_filter32_row_reference
+#define divot_filter_row        divot_filter_row_reference
+#define gamma_filters_row       gamma_filters_row_reference
+#endif
+
+/*
+ * The VI dither has a noise generator of its own.  The RDP one is reseeded at
+ * every span (see reset_span_pipeline), on whichever render thread draws it.
+ */
+static INT32 vi_seed = 1;
+
+STRICTINLINE static void video_filter16(
+    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres,
+    UINT32 centercvg);
+STRICTINLINE static void video_filter32(
+    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
+    UINT32 centercvg);
+STRICTINLINE static void divot_filter(
+    CCVG* final, CCVG centercolor, CCVG leftcolor, CCVG rightcolor);
+STRICTINLINE static void restore_filter16(
+    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres);
+STRICTINLINE static void restore_filter32(
+    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres);
+STRICTINLINE static void gamma_filters(
+    unsigned char* argb, int gamma_and_dither);
+STRICTINLINE static void video_max_optimized(UINT32* Pixels, UINT32* pen);
+STRICTINLINE static INT32 vi_irand(void);
+
+STRICTINLINE static void vi_fetch_filter16(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fbw, UINT32 fsaa,
+    UINT32 dither_filter);
+STRICTINLINE static void vi_fetch_filter32(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fbw, UINT32 fsaa,
+    UINT32 dither_filter);
+
+#ifdef VI_FILTER_SSE2
+#define VI_FILTER_LANES     8
+
+typedef struct {
+    __m128i r, g, b, cvg;
+} vi_pixels;
+
+/*
+ * Eight framebuffer pixels from idx on, as 16-bit lanes, and if full is
+ * not NULL, which of them VI_ANDER/VI_ANDER32 count as fully covered.
+ */
+STRICTINLINE static void vi_load_pixels16(
+    vi_pixels* px, __m128i* full, UINT32 idx)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i pix, hval;
+
+    /* pixel idx + i is halfword (idx + i) ^ WORD_ADDR_XOR */
+    if (idx & 1)
+    {
+        const __m128i even = _mm_set1_epi32(0x0000FFFF);
+        __m128i lo = _mm_loadu_si128((__m128i *)&rdram_16[idx - 1]);
+        __m128i hi = _mm_loadu_si128((__m128i *)&rdram_16[idx + 1]);
+
+        pix = _mm_or_si128(_mm_and_si128(even, lo), _mm_andnot_si128(even, hi));
+    }
+    else
+    {
+        pix = _mm_loadu_si128((__m128i *)&rdram_16[idx]);
+        pix = _mm_shufflelo_epi16(pix, _MM_SHUFFLE(2, 3, 0, 1));
+        pix = _mm_shufflehi_epi16(pix, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+    hval = _mm_loadl_epi64((__m128i *)&hidden_bits[idx]);
+    hval = _mm_unpacklo_epi8(hval, _mm_setzero_si128());
+
+    px->r = _mm_and_si128(_mm_srli_epi16(pix, 8), _mm_set1_epi16(0x00F8));
+    px->g = _mm_srli_epi16(_mm_and_si128(pix, _mm_set1_epi16(0x07C0)), 3);
+    px->b = _mm_slli_epi16(_mm_and_si128(pix, _mm_set1_epi16(0x003E)), 2);
+    pix = _mm_and_si128(pix, one);
+    px->cvg = _mm_or_si128(_mm_slli_epi16(pix, 2), hval);
+    if (full != NULL)
+        *full = _mm_and_si128(
+            _mm_cmpeq_epi16(hval, _mm_set1_epi16(3)), _mm_cmpeq_epi16(pix, one));
+}
+
+STRICTINLINE static void vi_load_pixels32(
+    vi_pixels* px, __m128i* full, UINT32 idx)
+{
+    const __m128i ff = _mm_set1_epi32(0xFF);
+    __m128i lo = _mm_loadu_si128((__m128i *)&rdram[idx + 0]);
+    __m128i hi = _mm_loadu_si128((__m128i *)&rdram[idx + 4]);
+
+    px->r = _mm_packs_epi32(_mm_srli_epi32(lo, 24), _mm_srli_epi32(hi, 24));
+    px->g = _mm_packs_epi32(
+        _mm_and_si128(_mm_srli_epi32(lo, 16), ff),
+        _mm_and_si128(_mm_srli_epi32(hi, 16), ff));
+    px->b = _mm_packs_epi32(
+        _mm_and_si128(_mm_srli_epi32(lo, 8), ff),
+        _mm_and_si128(_mm_srli_epi32(hi, 8), ff));
+    px->cvg = _mm_packs_epi32(
+        _mm_and_si128(_mm_srli_epi32(lo, 5), _mm_set1_epi32(7)),
+        _mm_and_si128(_mm_srli_epi32(hi, 5), _mm_set1_epi32(7)));
+    if (full != NULL)
+        *full = _mm_cmpeq_epi16(px->cvg, _mm_set1_epi16(7));
+}
+
+STRICTINLINE static void vi_load_pixels(
+    vi_pixels* px, __m128i* full, UINT32 idx, int is32)
+{
+    if (is32)
+        vi_load_pixels32(px, full, idx);
+    else
+        vi_load_pixels16(px, full, idx);
+}
+
+/*
+ * video_max_optimized() gives the second largest of its seven values, or
+ * the first one if that is the largest. That is the larger of the first
+ * value and the second largest of the other six, so keep the two largest
+ * neighbours as they come in.
+ */
+#define VI_MAX2(m1, m2, v) {                                  \
+    m2 = _mm_max_epi16(m2, _mm_min_epi16(m1, v));             \
+    m1 = _mm_max_epi16(m1, v);                                \
+}
+
+/*
+ * VI_COMPARE32 compares the low five bits of each neighbour's component
+ * with the high five of the center's, where VI_COMPARE takes the five
+ * bits a 16-bit pixel has.
+ */
+#define VI_RESTORE(sum, center5, n, is32) {                   \
+    __m128i n5 = is32 ? _mm_and_si128(n, _mm_set1_epi16(0x1F)) \
+                      : _mm_srli_epi16(n, 3);                 \
+    sum = _mm_sub_epi16(sum, _mm_cmpgt_epi16(n5, center5));   \
+    sum = _mm_add_epi16(sum, _mm_cmpgt_epi16(center5, n5));   \
+}
+
+STRICTINLINE static __m128i vi_video_filter_lane(
+    __m128i c, __m128i m2, __m128i m2inv, __m128i coeff)
+{
+    const __m128i ff = _mm_set1_epi16(0xFF);
+    __m128i penumax = _mm_max_epi16(c, m2);
+    __m128i penumin = _mm_xor_si128(
+        _mm_max_epi16(_mm_xor_si128(c, ff), m2inv), ff);
+    __m128i col;
+
+    /*
+     * Only the low 8 bits of the result are kept, which depend on bits 3
+     * to 10 of the product alone, so 16-bit lanes are wide enough.
+     */
+    col = _mm_sub_epi16(_mm_add_epi16(penumin, penumax), _mm_slli_epi16(c, 1));
+    col = _mm_mullo_epi16(col, coeff);
+    col = _mm_srli_epi16(_mm_add_epi16(col, _mm_set1_epi16(4)), 3);
+    return _mm_and_si128(_mm_add_epi16(col, c), ff);
+}
+
+/*
+ * vi_fetch_filter16/32() for the eight pixels from idx on, which must all
+ * have their neighbours (and for 16-bit pixels, one more halfword on each
+ * side) inside RDRAM.
+ */
+STRICTINLINE static void vi_fetch_filter_lanes(
+    CCVG* res, UINT32 idx, UINT32 fbw, UINT32 fsaa, UINT32 dither_filter,
+    int is32)
+{
+    const __m128i seven = _mm_set1_epi16(7);
+    vi_pixels center;
+    __m128i partial, r, g, b, cvg;
+
+    vi_load_pixels(&center, NULL, idx, is32);
+    cvg = fsaa ? center.cvg : seven;
+    partial = _mm_xor_si128(_mm_cmpeq_epi16(cvg, seven), _mm_set1_epi16(-1));
+    r = center.r;
+    g = center.g;
+    b = center.b;
+
+    if (_mm_movemask_epi8(partial) != 0)
+    {
+        static const int offsets[6] = { -1, +1, -2, +2, -1, +1 };
+        const __m128i ff = _mm_set1_epi16(0xFF);
+        __m128i maxr = _mm_setzero_si128(), penr = _mm_setzero_si128();
+        __m128i maxg = _mm_setzero_si128(), peng = _mm_setzero_si128();
+        __m128i maxb = _mm_setzero_si128(), penb = _mm_setzero_si128();
+        __m128i maxir = _mm_setzero_si128(), penir = _mm_setzero_si128();
+        __m128i maxig = _mm_setzero_si128(), penig = _mm_setzero_si128();
+        __m128i maxib = _mm_setzero_si128(), penib = _mm_setzero_si128();
+        __m128i coeff = _mm_sub_epi16(seven, cvg);
+        int k;
+
+        for (k = 0; k < 6; k++)
+        {
+            UINT32 n = idx + offsets[k] + (k < 2 ? -fbw : k < 4 ? 0 : fbw);
+            vi_pixels px;
+            __m128i full;
+
+            vi_load_pixels(&px, &full, n, is32);
+            px.r = _mm_and_si128(px.r, full);
+            px.g = _mm_and_si128(px.g, full);
+            px.b = _mm_and_si128(px.b, full);
+            VI_MAX2(maxr, penr, px.r);
+            VI_MAX2(maxg, peng, px.g);
+            VI_MAX2(maxb, penb, px.b);
+            VI_MAX2(maxir, penir, _mm_and_si128(_mm_xor_si128(px.r, ff), full));
+            VI_MAX2(maxig, penig, _mm_and_si128(_mm_xor_si128(px.g, ff), full));
+            VI_MAX2(maxib, penib, _mm_and_si128(_mm_xor_si128(px.b, ff), full));
+        }
+
+        r = vi_video_filter_lane(center.r, penr, penir, coeff);
+        g = vi_video_filter_lane(center.g, peng, penig, coeff);
+        b = vi_video_filter_lane(center.b, penb, penib, coeff);
+        r = _mm_or_si128(_mm_and_si128(partial, r), _mm_andnot_si128(partial, center.r));
+        g = _mm_or_si128(_mm_and_si128(partial, g), _mm_andnot_si128(partial, center.g));
+        b = _mm_or_si128(_mm_and_si128(partial, b), _mm_andnot_si128(partial, center.b));
+    }
+
+    if (dither_filter && _mm_movemask_epi8(partial) != 0xFFFF)
+    {
+        static const int offsets[8] = { -1, 0, +1, -1, 0, +1, -1, +1 };
+        const __m128i ff = _mm_set1_epi16(0xFF);
+        __m128i r5 = _mm_srli_epi16(center.r, 3);
+        __m128i g5 = _mm_srli_epi16(center.g, 3);
+        __m128i b5 = _mm_srli_epi16(center.b, 3);
+        __m128i sumr = center.r, sumg = center.g, sumb = center.b;
+        int k;
+
+        for (k = 0; k < 8; k++)
+        {
+            UINT32 n = idx + offsets[k] + (k < 3 ? -fbw : k < 6 ? fbw : 0);
+            vi_pixels px;
+
+            vi_load_pixels(&px, NULL, n, is32);
+            VI_RESTORE(sumr, r5, px.r, is32);
+            VI_RESTORE(sumg, g5, px.g, is32);
+            VI_RESTORE(sumb, b5, px.b, is32);
+        }
+
+        r = _mm_or_si128(_mm_and_si128(partial, r), _mm_andnot_si128(partial, _mm_and_si128(sumr, ff)));
+        g = _mm_or_si128(_mm_and_si128(partial, g), _mm_andnot_si128(partial, _mm_and_si128(sumg, ff)));
+        b = _mm_or_si128(_mm_and_si128(partial, b), _mm_andnot_si128(partial, _mm_and_si128(sumb, ff)));
+    }
+
+    /* r, g, b, cvg bytes */
+    r = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    b = _mm_or_si128(b, _mm_slli_epi16(cvg, 8));
+    _mm_storeu_si128((__m128i *)&res[0], _mm_unpacklo_epi16(r, b));
+    _mm_storeu_si128((__m128i *)&res[4], _mm_unpackhi_epi16(r, b));
+}
+#endif
+
+#ifdef VI_FILTER_NEON
+#define VI_FILTER_LANES     8
+
+typedef struct {
+    uint16x8_t r, g, b, cvg;
+} vi_pixels;
+
+/* the same as vi_load_pixels16/32() above, in NEON */
+STRICTINLINE static void vi_load_pixels16(
+    vi_pixels* px, uint16x8_t* full, UINT32 idx)
+{
+    const uint16x8_t one = vdupq_n_u16(1);
+    uint16x8_t pix, hval;
+
+    if (idx & 1)
+    {
+        const uint16x8_t even = vreinterpretq_u16_u32(vdupq_n_u32(0x0000FFFF));
+
+        pix = vbslq_u16(even,
+            vld1q_u16(&rdram_16[idx - 1]), vld1q_u16(&rdram_16[idx + 1]));
+    }
+    else
+        pix = vrev32q_u16(vld1q_u16(&rdram_16[idx]));
+    hval = vmovl_u8(vld1_u8(&hidden_bits[idx]));
+
+    px->r = vandq_u16(vshrq_n_u16(pix, 8), vdupq_n_u16(0x00F8));
+    px->g = vshrq_n_u16(vandq_u16(pix, vdupq_n_u16(0x07C0)), 3);
+    px->b = vshlq_n_u16(vandq_u16(pix, vdupq_n_u16(0x003E)), 2);
+    pix = vandq_u16(pix, one);
+    px->cvg = vorrq_u16(vshlq_n_u16(pix, 2), hval);
+    if (full != NULL)
+        *full = vandq_u16(
+            vceqq_u16(hval, vdupq_n_u16(3)), vceqq_u16(pix, one));
+}
+
+STRICTINLINE static void vi_load_pixels32(
+    vi_pixels* px, uint16x8_t* full, UINT32 idx)
+{
+    const uint32x4_t ff = vdupq_n_u32(0xFF);
+    uint32x4_t lo = vld1q_u32(&rdram[idx + 0]);
+    uint32x4_t hi = vld1q_u32(&rdram[idx + 4]);
+
+    px->r = vcombine_u16(
+        vmovn_u32(vshrq_n_u32(lo, 24)), vmovn_u32(vshrq_n_u32(hi, 24)));
+    px->g = vcombine_u16(
+        vmovn_u32(vandq_u32(vshrq_n_u32(lo, 16), ff)),
+        vmovn_u32(vandq_u32(vshrq_n_u32(hi, 16), ff)));
+    px->b = vcombine_u16(
+        vmovn_u32(vandq_u32(vshrq_n_u32(lo, 8), ff)),
+        vmovn_u32(vandq_u32(vshrq_n_u32(hi, 8), ff)));
+    px->cvg = vcombine_u16(
+        vmovn_u32(vandq_u32(vshrq_n_u32(lo, 5), vdupq_n_u32(7))),
+        vmovn_u32(vandq_u32(vshrq_n_u32(hi, 5), vdupq_n_u32(7))));
+    if (full != NULL)
+        *full = vceqq_u16(px->cvg, vdupq_n_u16(7));
+}
+
+STRICTINLINE static void vi_load_pixels(
+    vi_pixels* px, uint16x8_t* full, UINT32 idx, int is32)
+{
+    if (is32)
+        vi_load_pixels32(px, full, idx);
+    else
+        vi_load_pixels16(px, full, idx);
+}
+
+/* whether any lane of a comparison result is set */
+STRICTINLINE static int vi_any(uint16x8_t mask)
+{
+    uint32x2_t x = vreinterpret_u32_u16(
+        vorr_u16(vget_low_u16(mask), vget_high_u16(mask)));
+
+    return (vget_lane_u32(x, 0) | vget_lane_u32(x, 1)) != 0;
+}
+
+/* The components are below 0x100, so unsigned lanes order them the same. */
+#define VI_MAX2(m1, m2, v) {                                  \
+    m2 = vmaxq_u16(m2, vminq_u16(m1, v));                     \
+    m1 = vmaxq_u16(m1, v);                                    \
+}
+
+/* sum counts up for each greater neighbour: the mask is all ones */
+#define VI_RESTORE(sum, center5, n, is32) {                   \
+    uint16x8_t n5 = is32 ? vandq_u16(n, vdupq_n_u16(0x1F))    \
+                         : vshrq_n_u16(n, 3);                 \
+    sum = vsubq_u16(sum, vcgtq_u16(n5, center5));             \
+    sum = vaddq_u16(sum, vcgtq_u16(center5, n5));             \
+}
+
+STRICTINLINE static uint16x8_t vi_video_filter_lane(
+    uint16x8_t c, uint16x8_t m2, uint16x8_t m2inv, uint16x8_t coeff)
+{
+    const uint16x8_t ff = vdupq_n_u16(0xFF);
+    uint16x8_t penumax = vmaxq_u16(c, m2);
+    uint16x8_t penumin = veorq_u16(vmaxq_u16(veorq_u16(c, ff), m2inv), ff);
+    uint16x8_t col;
+
+    col = vsubq_u16(vaddq_u16(penumin, penumax), vshlq_n_u16(c, 1));
+    col = vmulq_u16(col, coeff);
+    col = vshrq_n_u16(vaddq_u16(col, vdupq_n_u16(4)), 3);
+    return vandq_u16(vaddq_u16(col, c), ff);
+}
+
+STRICTINLINE static void vi_fetch_filter_lanes(
+    CCVG* res, UINT32 idx, UINT32 fbw, UINT32 fsaa, UINT32 dither_filter,
+    int is32)
+{
+    const uint16x8_t seven = vdupq_n_u16(7);
+    vi_pixels center;
+    uint16x8_t partial, r, g, b, cvg;
+    uint8x8x4_t bytes;
+
+    vi_load_pixels(&center, NULL, idx, is32);
+    cvg = fsaa ? center.cvg : seven;
+    partial = vmvnq_u16(vceqq_u16(cvg, seven));
+    r = center.r;
+    g = center.g;
+    b = center.b;
+
+    if (vi_any(partial))
+    {
+        static const int offsets[6] = { -1, +1, -2, +2, -1, +1 };
+        const uint16x8_t ff = vdupq_n_u16(0xFF);
+        uint16x8_t maxr = vdupq_n_u16(0), penr = vdupq_n_u16(0);
+        uint16x8_t maxg = vdupq_n_u16(0), peng = vdupq_n_u16(0);
+        uint16x8_t maxb = vdupq_n_u16(0), penb = vdupq_n_u16(0);
+        uint16x8_t maxir = vdupq_n_u16(0), penir = vdupq_n_u16(0);
+        uint16x8_t maxig = vdupq_n_u16(0), penig = vdupq_n_u16(0);
+        uint16x8_t maxib = vdupq_n_u16(0), penib = vdupq_n_u16(0);
+        uint16x8_t coeff = vsubq_u16(seven, cvg);
+        int k;
+
+        for (k = 0; k < 6; k++)
+        {
+            UINT32 n = idx + offsets[k] + (k < 2 ? -fbw : k < 4 ? 0 : fbw);
+            vi_pixels px;
+            uint16x8_t full;
+
+            vi_load_pixels(&px, &full, n, is32);
+            px.r = vandq_u16(px.r, full);
+            px.g = vandq_u16(px.g, full);
+            px.b = vandq_u16(px.b, full);
+            VI_MAX2(maxr, penr, px.r);
+            VI_MAX2(maxg, peng, px.g);
+            VI_MAX2(maxb, penb, px.b);
+            VI_MAX2(maxir, penir, vandq_u16(veorq_u16(px.r, ff), full));
+            VI_MAX2(maxig, penig, vandq_u16(veorq_u16(px.g, ff), full));
+            VI_MAX2(maxib, penib, vandq_u16(veorq_u16(px.b, ff), full));
+        }
+
+        r = vbslq_u16(partial, vi_video_filter_lane(center.r, penr, penir, coeff), center.r);
+        g = vbslq_u16(partial, vi_video_filter_lane(center.g, peng, penig, coeff), center.g);
+        b = vbslq_u16(partial, vi_video_filter_lane(center.b, penb, penib, coeff), center.b);
+    }
+
+    if (dither_filter && vi_any(vmvnq_u16(partial)))
+    {
+        static const int offsets[8] = { -1, 0, +1, -1, 0, +1, -1, +1 };
+        const uint16x8_t ff = vdupq_n_u16(0xFF);
+        uint16x8_t r5 = vshrq_n_u16(center.r, 3);
+        uint16x8_t g5 = vshrq_n_u16(center.g, 3);
+        uint16x8_t b5 = vshrq_n_u16(center.b, 3);
+        uint16x8_t sumr = center.r, sumg = center.g, sumb = center.b;
+        int k;
+
+        for (k = 0; k < 8; k++)
+        {
+            UINT32 n = idx + offsets[k] + (k < 3 ? -fbw : k < 6 ? fbw : 0);
+            vi_pixels px;
+
+            vi_load_pixels(&px, NULL, n, is32);
+            VI_RESTORE(sumr, r5, px.r, is32);
+            VI_RESTORE(sumg, g5, px.g, is32);
+            VI_RESTORE(sumb, b5, px.b, is32);
+        }
+
+        r = vbslq_u16(partial, r, vandq_u16(sumr, ff));
+        g = vbslq_u16(partial, g, vandq_u16(sumg, ff));
+        b = vbslq_u16(partial, b, vandq_u16(sumb, ff));
+    }
+
+    /* r, g, b, cvg bytes */
+    bytes.val[0] = vmovn_u16(r);
+    bytes.val[1] = vmovn_u16(g);
+    bytes.val[2] = vmovn_u16(b);
+    bytes.val[3] = vmovn_u16(cvg);
+    vst4_u8((uint8_t *)res, bytes);
+}
+#endif
+
+void vi_fetch_filter16_row(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter)
+{
+#ifdef VI_FILTER_LANES
+    UINT32 idx = (fboffset >> 1) + cur_x;
+
+    for (; count >= VI_FILTER_LANES; count -= VI_FILTER_LANES)
+    {
+        /* the neighbours are up to fbw + 2 pixels away */
+        if (idx >= fbw + 3 && (UINT64)idx + fbw + VI_FILTER_LANES + 2 <= idxlim16)
+            vi_fetch_filter_lanes(res, idx, fbw, fsaa, dither_filter, 0);
+        else
+        {
+            int i;
+
+            for (i = 0; i < VI_FILTER_LANES; i++)
+                vi_fetch_filter16(
+                    &res[i], fboffset, cur_x + i, fbw, fsaa, dither_filter);
+        }
+        res += VI_FILTER_LANES;
+        cur_x += VI_FILTER_LANES;
+        idx += VI_FILTER_LANES;
+    }
+#endif
+    for (; count > 0; count--)
+        vi_fetch_filter16(res++, fboffset, cur_x++, fbw, fsaa, dither_filter);
+    return;
+}
+
+void vi_fetch_filter32_row(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter)
+{
+#ifdef VI_FILTER_LANES
+    UINT32 idx = (fboffset >> 2) + cur_x;
+
+    for (; count >= VI_FILTER_LANES; count -= VI_FILTER_LANES)
+    {
+        if (idx >= fbw + 2 && (UINT64)idx + fbw + VI_FILTER_LANES + 1 <= idxlim32)
+            vi_fetch_filter_lanes(res, idx, fbw, fsaa, dither_filter, 1);
+        else
+        {
+            int i;
+
+            for (i = 0; i < VI_FILTER_LANES; i++)
+                vi_fetch_filter32(
+                    &res[i], fboffset, cur_x + i, fbw, fsaa, dither_filter);
+        }
+        res += VI_FILTER_LANES;
+        cur_x += VI_FILTER_LANES;
+        idx += VI_FILTER_LANES;
+    }
+#endif
+    for (; count > 0; count--)
+        vi_fetch_filter32(res++, fboffset, cur_x++, fbw, fsaa, dither_filter);
+    return;
+}
+
+/*
+ * final[i] from viaa[i - 1], viaa[i] and viaa[i + 1]. divot_filter() picks
+ * the median of the three for each component, unless all three pixels are
+ * fully covered.
+ */
+void divot_filter_row(CCVG* final, const CCVG* viaa, int count)
+{
+#ifdef VI_FILTER_SSE2
+    const __m128i cvgmask = _mm_set1_epi32(0xFF000000);
+    const __m128i full = _mm_set1_epi32(0x07000000);
+
+    for (; count >= 4; count -= 4)
+    {
+        __m128i left = _mm_loadu_si128((__m128i *)&viaa[-1]);
+        __m128i center = _mm_loadu_si128((__m128i *)&viaa[0]);
+        __m128i right = _mm_loadu_si128((__m128i *)&viaa[1]);
+        __m128i median, keep;
+
+        median = _mm_max_epu8(
+            _mm_min_epu8(left, right),
+            _mm_min_epu8(_mm_max_epu8(left, right), center));
+        keep = _mm_and_si128(_mm_and_si128(left, right), center);
+        keep = _mm_cmpeq_epi32(_mm_and_si128(keep, cvgmask), full);
+        keep = _mm_or_si128(keep, cvgmask);
+        _mm_storeu_si128((__m128i *)final, _mm_or_si128(
+            _mm_and_si128(keep, center), _mm_andnot_si128(keep, median)));
+        final += 4;
+        viaa += 4;
+    }
+#elif defined(VI_FILTER_NEON)
+    const uint32x4_t cvgmask = vdupq_n_u32(0xFF000000);
+    const uint32x4_t full = vdupq_n_u32(0x07000000);
+
+    for (; count >= 4; count -= 4)
+    {
+        uint8x16_t left = vld1q_u8((const uint8_t *)&viaa[-1]);
+        uint8x16_t center = vld1q_u8((const uint8_t *)&viaa[0]);
+        uint8x16_t right = vld1q_u8((const uint8_t *)&viaa[1]);
+        uint8x16_t median;
+        uint32x4_t keep;
+
+        median = vmaxq_u8(
+            vminq_u8(left, right),
+            vminq_u8(vmaxq_u8(left, right), center));
+        keep = vreinterpretq_u32_u8(vandq_u8(vandq_u8(left, right), center));
+        keep = vceqq_u32(vandq_u32(keep, cvgmask), full);
+        keep = vorrq_u32(keep, cvgmask);
+        vst1q_u8((uint8_t *)final,
+            vbslq_u8(vreinterpretq_u8_u32(keep), center, median));
+        final += 4;
+        viaa += 4;
+    }
+#endif
+    for (; count > 0; count--)
+    {
+        divot_filter(final, viaa[0], viaa[-1], viaa[1]);
+        final++;
+        viaa++;
+    }
+    return;
+}
+
+#ifdef VI_FILTER_SSE2
+/*
+ * gamma_table[] and gamma_dither_table[] hold twice the integer square
+ * root of their index, which sqrtps gets exactly below 0x4000.
+ */
+STRICTINLINE static __m128i vi_gamma_sse2(__m128i c, __m128i dith)
+{
+    __m128i x = _mm_or_si128(_mm_slli_epi32(c, 6), dith);
+
+    x = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(x)));
+    return _mm_slli_epi32(x, 1);
+}
+
+STRICTINLINE static __m128i vi_irand4(void)
+{
+    INT32 c0 = vi_irand();
+    INT32 c1 = vi_irand();
+    INT32 c2 = vi_irand();
+    INT32 c3 = vi_irand();
+
+    return _mm_set_epi32(c3, c2, c1, c0);
+}
+#elif defined(VI_FILTER_NEON)
+/* AArch64 has vsqrtq_f32 for vi_gamma_sse2()'s trick, ARMv7 looks it up */
+STRICTINLINE static uint32x4_t vi_gamma_neon(uint32x4_t c, uint32x4_t dith)
+{
+    uint32x4_t x = vorrq_u32(vshlq_n_u32(c, 6), dith);
+#ifdef __aarch64__
+    x = vcvtq_u32_f32(vsqrtq_f32(vcvtq_f32_u32(x)));
+    return vshlq_n_u32(x, 1);
+#else
+    UINT32 lanes[4];
+    int i;
+
+    vst1q_u32(lanes, x);
+    for (i = 0; i < 4; i++)
+        lanes[i] = gamma_dither_table[lanes[i]];
+    return vld1q_u32(lanes);
+#endif
+}
+
+STRICTINLINE static uint32x4_t vi_irand4(void)
+{
+    UINT32 c[4];
+
+    c[0] = vi_irand();
+    c[1] = vi_irand();
+    c[2] = vi_irand();
+    c[3] = vi_irand();
+    return vld1q_u32(c);
+}
+#endif
+
+/* gamma_filters() on scanline[0..count - 1], one vi_irand() per pixel */
+void gamma_filters_row(UINT32* scanline, int count, int gamma_and_dither)
+{
+#ifdef VI_FILTER_SSE2
+    const __m128i ff = _mm_set1_epi32(0xFF);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i six = _mm_set1_epi32(0x3F);
+
+    if (gamma_and_dither == 0)
+        return;
+
+    for (; count >= 4; count -= 4)
+    {
+        __m128i pix = _mm_loadu_si128((__m128i *)scanline);
+        __m128i cdith, dithr, dithg, dithb;
+        __m128i r, g, b;
+
+        if (gamma_and_dither == 1)
+        {
+            cdith = vi_irand4();
+            dithr = _mm_slli_epi32(_mm_and_si128(cdith, one), 16);
+            dithg = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(cdith, 1), one), 8);
+            dithb = _mm_and_si128(_mm_srli_epi32(cdith, 2), one);
+
+            /* saturating, like the r < 255 tests */
+            pix = _mm_adds_epu8(pix, _mm_or_si128(dithr, _mm_or_si128(dithg, dithb)));
+            _mm_storeu_si128((__m128i *)scanline, pix);
+            scanline += 4;
+            continue;
+        }
+
+        if (gamma_and_dither == 2)
+            dithr = dithg = dithb = _mm_setzero_si128();
+        else
+        {
+            cdith = vi_irand4();
+            dithr = _mm_and_si128(cdith, six);
+            dithg = _mm_and_si128(_mm_srli_epi32(cdith, 6), six);
+            dithb = _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(cdith, 9), _mm_set1_epi32(0x38)),
+                _mm_and_si128(cdith, _mm_set1_epi32(7)));
+        }
+
+        r = vi_gamma_sse2(_mm_and_si128(_mm_srli_epi32(pix, 16), ff), dithr);
+        g = vi_gamma_sse2(_mm_and_si128(_mm_srli_epi32(pix, 8), ff), dithg);
+        b = vi_gamma_sse2(_mm_and_si128(pix, ff), dithb);
+        pix = _mm_andnot_si128(_mm_set1_epi32(0x00FFFFFF), pix);
+        pix = _mm_or_si128(pix, _mm_or_si128(
+            _mm_slli_epi32(r, 16), _mm_or_si128(_mm_slli_epi32(g, 8), b)));
+        _mm_storeu_si128((__m128i *)scanline, pix);
+        scanline += 4;
+    }
+#elif defined(VI_FILTER_NEON)
+    const uint32x4_t ff = vdupq_n_u32(0xFF);
+    const uint32x4_t one = vdupq_n_u32(1);
+    const uint32x4_t six = vdupq_n_u32(0x3F);
+
+    if (gamma_and_dither == 0)
+        return;
+
+    for (; count >= 4; count -= 4)
+    {
+        uint32x4_t pix = vld1q_u32(scanline);
+        uint32x4_t cdith, dithr, dithg, dithb;
+        uint32x4_t r, g, b;
+
+        if (gamma_and_dither == 1)
+        {
+            cdith = vi_irand4();
+            dithr = vshlq_n_u32(vandq_u32(cdith, one), 16);
+            dithg = vshlq_n_u32(vandq_u32(vshrq_n_u32(cdith, 1), one), 8);
+            dithb = vandq_u32(vshrq_n_u32(cdith, 2), one);
+
+            /* saturating, like the r < 255 tests */
+            pix = vreinterpretq_u32_u8(vqaddq_u8(vreinterpretq_u8_u32(pix),
+                vreinterpretq_u8_u32(vorrq_u32(dithr, vorrq_u32(dithg, dithb)))));
+            vst1q_u32(scanline, pix);
+            scanline += 4;
+            continue;
+        }
+
+        if (gamma_and_dither == 2)
+            dithr = dithg = dithb = vdupq_n_u32(0);
+        else
+        {
+            cdith = vi_irand4();
+            dithr = vandq_u32(cdith, six);
+            dithg = vandq_u32(vshrq_n_u32(cdith, 6), six);
+            dithb = vorrq_u32(
+                vandq_u32(vshrq_n_u32(cdith, 9), vdupq_n_u32(0x38)),
+                vandq_u32(cdith, vdupq_n_u32(7)));
+        }
+
+        r = vi_gamma_neon(vandq_u32(vshrq_n_u32(pix, 16), ff), dithr);
+        g = vi_gamma_neon(vandq_u32(vshrq_n_u32(pix, 8), ff), dithg);
+        b = vi_gamma_neon(vandq_u32(pix, ff), dithb);
+        pix = vandq_u32(pix, vdupq_n_u32(0xFF000000));
+        pix = vorrq_u32(pix, vorrq_u32(
+            vshlq_n_u32(r, 16), vorrq_u32(vshlq_n_u32(g, 8), b)));
+        vst1q_u32(scanline, pix);
+        scanline += 4;
+    }
+#endif
+    for (; count > 0; count--)
+        gamma_filters((unsigned char *)scanline++, gamma_and_dither);
+    return;
+}
+
+STRICTINLINE static void vi_fetch_filter16(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fbw, UINT32 fsaa,
+    UINT32 dither_filter)
+{
+    int r, g, b;
+    UINT32 pix, hval;
+    UINT32 cur_cvg;
+    UINT32 idx = (fboffset >> 1) + cur_x;
+
+    PAIRREAD16(pix, hval, idx);
+    if (fsaa)
+        cur_cvg = ((pix & 1) << 2) | hval;
+    else
+        cur_cvg = 7;
+    r = GET_HI(pix);
+    g = GET_MED(pix);
+    b = GET_LOW(pix);
+
+    if (cur_cvg == 7)
+    {
+        if (dither_filter)
+            restore_filter16(&r, &g, &b, fboffset, cur_x, fbw);
+    }
+    else
+    {
+        video_filter16(&r, &g, &b, fboffset, cur_x, fbw, cur_cvg);
+    }
+
+    res -> r = r;
+    res -> g = g;
+    res -> b = b;
+    res -> cvg = cur_cvg;
+    return;
+}
+
+STRICTINLINE static void vi_fetch_filter32(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, UINT32 fbw, UINT32 fsaa,
+    UINT32 dither_filter)
+{
+    int r, g, b;
+    UINT32 cur_cvg;
+    UINT32 pix = RREADIDX32((fboffset >> 2) + cur_x);
+
+    if (fsaa)
+        cur_cvg = (pix >> 5) & 7;
+    else
+        cur_cvg = 7;
+
+    r = (pix >> 24) & 0xff;
+    g = (pix >> 16) & 0xff;
+    b = (pix >> 8) & 0xff;
+
+    if (cur_cvg == 7)
+    {
+        if (dither_filter)
+            restore_filter32(&r, &g, &b, fboffset, cur_x, fbw);
+    }
+    else
+    {
+        video_filter32(&r, &g, &b, fboffset, cur_x, fbw, cur_cvg);
+    }
+
+    res -> r = r;
+    res -> g = g;
+    res -> b = b;
+    res -> cvg = cur_cvg;
+    return;
+}
+
+STRICTINLINE static void video_filter16(
+    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
+    UINT32 centercvg)
+{
+    UINT32 penumaxr, penumaxg, penumaxb, penuminr, penuming, penuminb;
+    UINT16 pix;
+    UINT32 numoffull = 1;
+    UINT32 hidval;
+    UINT32 r, g, b; 
+    UINT32 backr[7], backg[7], backb[7];
+    UINT32 invr[7], invg[7], invb[7];
+    UINT32 colr, colg, colb;
+
+    UINT32 idx = (fboffset >> 1) + num;
+    UINT32 leftup = idx - hres - 1;
+    UINT32 rightup = idx - hres + 1;
+    UINT32 toleft = idx - 2;
+    UINT32 toright = idx + 2;
+    UINT32 leftdown = idx + hres - 1;
+    UINT32 rightdown = idx + hres + 1;
+    UINT32 coeff = 7 - centercvg;
+
+    r = *endr;
+    g = *endg;
+    b = *endb;
+
+    backr[0] = r;
+    backg[0] = g;
+    backb[0] = b;
+    invr[0] = (~r) & 0xff;
+    invg[0] = (~g) & 0xff;
+    invb[0] = (~b) & 0xff;
+
+    VI_ANDER(leftup);
+    VI_ANDER(rightup);
+    VI_ANDER(toleft);
+    VI_ANDER(toright);
+    VI_ANDER(leftdown);
+    VI_ANDER(rightdown);
+
+    video_max_optimized(&backr[0], &penumaxr);
+    video_max_optimized(&backg[0], &penumaxg);
+    video_max_optimized(&backb[0], &penumaxb);
+    video_max_optimized(&invr[0], &penuminr);
+    video_max_optimized(&invg[0], &penuming);
+    video_max_optimized(&invb[0], &penuminb);
+
+    penuminr = (~penuminr) & 0xFF;
+    penuming = (~penuming) & 0xFF;
+    penuminb = (~penuminb) & 0xFF;
+
+    colr = penuminr + penumaxr - (r << 1);
+    colg = penuming + penumaxg - (g << 1);
+    colb = penuminb + penumaxb - (b << 1);
+
+    colr = (((colr * coeff) + 4) >> 3) + r;
+    colg = (((colg * coeff) + 4) >> 3) + g;
+    colb = (((colb * coeff) + 4) >> 3) + b;
+
+    *endr = colr & 0xFF;
+    *endg = colg & 0xFF;
+    *endb = colb & 0xFF;
+    return;
+}
+
+STRICTINLINE static void video_filter32(
+    int* endr, int* endg, int* endb, UINT32 fboffset, UINT32 num, UINT32 hres,
+    UINT32 centercvg)
+{
+    UINT32 penumaxr, penumaxg, penumaxb, penuminr, penuming, penuminb;
+    UINT32 numoffull = 1;
+    UINT32 pix = 0, pixcvg = 0;
+    UINT32 r, g, b; 
+    UINT32 backr[7], backg[7], backb[7];
+    UINT32 invr[7], invg[7], invb[7];
+    UINT32 colr, colg, colb;
+
+    UINT32 idx = (fboffset >> 2) + num;
+    UINT32 leftup = idx - hres - 1;
+    UINT32 rightup = idx - hres + 1;
+    UINT32 toleft = idx - 2;
+    UINT32 toright = idx + 2;
+    UINT32 leftdown = idx + hres - 1;
+    UINT32 rightdown = idx + hres + 1;
+    UINT32 coeff = 7 - centercvg;
+
+    r = *endr;
+    g = *endg;
+    b = *endb;
+
+    backr[0] = r;
+    backg[0] = g;
+    backb[0] = b;
+    invr[0] = (~r) & 0xff;
+    invg[0] = (~g) & 0xff;
+    invb[0] = (~b) & 0xff;
+
+    VI_ANDER32(leftup);
+    VI_ANDER32(rightup);
+    VI_ANDER32(toleft);
+    VI_ANDER32(toright);
+    VI_ANDER32(leftdown);
+    VI_ANDER32(rightdown);
+
+    video_max_optimized(&backr[0], &penumaxr);
+    video_max_optimized(&backg[0], &penumaxg);
+    video_max_optimized(&backb[0], &penumaxb);
+    video_max_optimized(&invr[0], &penuminr);
+    video_max_optimized(&invg[0], &penuming);
+    video_max_optimized(&invb[0], &penuminb);
+
+    penuminr = (~penuminr) & 0xFF;
+    penuming = (~penuming) & 0xFF;
+    penuminb = (~penuminb) & 0xFF;
+
+    colr = penuminr + penumaxr - (r << 1);
+    colg = penuming + penumaxg - (g << 1);
+    colb = penuminb + penumaxb - (b << 1);
+
+    colr = (((colr * coeff) + 4) >> 3) + r;
+    colg = (((colg * coeff) + 4) >> 3) + g;
+    colb = (((colb * coeff) + 4) >> 3) + b;
+
+    *endr = colr & 0xFF;
+    *endg = colg & 0xFF;
+    *endb = colb & 0xFF;
+    return;
+}
+
+STRICTINLINE static void divot_filter(
+    CCVG* final, CCVG centercolor, CCVG leftcolor, CCVG rightcolor)
+{
+    UINT32 leftr, leftg, leftb;
+    UINT32 rightr, rightg, rightb;
+    UINT32 centerr, centerg, centerb;
+
+    *final = centercolor;
+    if ((centercolor.cvg & leftcolor.cvg & rightcolor.cvg) == 7)
+        return;
+
+    leftr = leftcolor.r;    
+    leftg = leftcolor.g;    
+    leftb = leftcolor.b;
+    rightr = rightcolor.r;    
+    rightg = rightcolor.g;    
+    rightb = rightcolor.b;
+    centerr = centercolor.r;
+    centerg = centercolor.g;
+    centerb = centercolor.b;
+
+    if ((leftr >= centerr && rightr >= leftr) || (leftr >= rightr && centerr >= leftr))
+        final -> r = leftr;
+    else if ((rightr >= centerr && leftr >= rightr) || (rightr >= leftr && centerr >= rightr))
+        final -> r = rightr;
+
+    if ((leftg >= centerg && rightg >= leftg) || (leftg >= rightg && centerg >= leftg))
+        final -> g = leftg;
+    else if ((rightg >= centerg && leftg >= rightg) || (rightg >= leftg && centerg >= rightg))
+        final -> g = rightg;
+
+    if ((leftb >= centerb && rightb >= leftb) || (leftb >= rightb && centerb >= leftb))
+        final -> b = leftb;
+    else if ((rightb >= centerb && leftb >= rightb) || (rightb >= leftb && centerb >= rightb))
+        final -> b = rightb;
+    return;
+}
+
+STRICTINLINE static void restore_filter16(
+    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres)
+{
+    UINT32 tempr, tempg, tempb;
+    UINT16 pix;
+
+    UINT32 idx = (fboffset >> 1) + num;
+    UINT32 leftuppix = idx - hres - 1;
+    UINT32 leftdownpix = idx + hres - 1;
+    UINT32 toleftpix = idx - 1;
+
+    UINT32 rend = *r;
+    UINT32 gend = *g;
+    UINT32 bend = *b;
+    UINT32 rcomp = (rend >> 3) & 31;
+    UINT32 gcomp = (gend >> 3) & 31;
+    UINT32 bcomp = (bend >> 3) & 31;
+
+    VI_COMPARE(leftuppix);
+    VI_COMPARE(leftuppix + 1);
+    VI_COMPARE(leftuppix + 2);
+    VI_COMPARE(leftdownpix);
+    VI_COMPARE(leftdownpix + 1);
+    VI_COMPARE(leftdownpix + 2);
+    VI_COMPARE(toleftpix);
+    VI_COMPARE(toleftpix + 2);
+
+    *r = rend;
+    *g = gend;
+    *b = bend;
+    return;
+}
+
+STRICTINLINE static void restore_filter32(
+    int* r, int* g, int* b, UINT32 fboffset, UINT32 num, UINT32 hres)
+{
+    UINT32 tempr, tempg, tempb;
+    UINT32 pix;
+
+    UINT32 idx = (fboffset >> 2) + num;
+    UINT32 leftuppix = idx - hres - 1;
+    UINT32 leftdownpix = idx + hres - 1;
+    UINT32 toleftpix = idx - 1;
+
+    UINT32 rend = *r;
+    UINT32 gend = *g;
+    UINT32 bend = *b;
+    UINT32 rcomp = (rend >> 3) & 31;
+    UINT32 gcomp = (gend >> 3) & 31;
+    UINT32 bcomp = (bend >> 3) & 31;
+
+    VI_COMPARE32(leftuppix);
+    VI_COMPARE32(leftuppix + 1);
+    VI_COMPARE32(leftuppix + 2);
+    VI_COMPARE32(leftdownpix);
+    VI_COMPARE32(leftdownpix + 1);
+    VI_COMPARE32(leftdownpix + 2);
+    VI_COMPARE32(toleftpix);
+    VI_COMPARE32(toleftpix + 2);
+
+    *r = rend;
+    *g = gend;
+    *b = bend;
+    return;
+}
+
+STRICTINLINE static void gamma_filters(
+    unsigned char* argb, int gamma_and_dither)
+{
+    int cdith, dith;
+    int r, g, b;
+
+    r = argb[1 ^ BYTE_ADDR_XOR];
+    g = argb[2 ^ BYTE_ADDR_XOR];
+    b = argb[3 ^ BYTE_ADDR_XOR];
+    switch(gamma_and_dither)
+    {
+        case 0:
+            return;
+            break;
+        case 1:
+            cdith = vi_irand();
+            dith = cdith & 1;
+            if (r < 255)
+                r += dith;
+            dith = (cdith >> 1) & 1;
+            if (g < 255)
+                g += dith;
+            dith = (cdith >> 2) & 1;
+            if (b < 255)
+                b += dith;
+            break;
+        case 2:
+            r = gamma_table[r];
+            g = gamma_table[g];
+            b = gamma_table[b];
+            break;
+        case 3:
+            cdith = vi_irand();
+            dith = cdith & 0x3f;
+            r = gamma_dither_table[(r << 6) | dith];
+            dith = (cdith >> 6) & 0x3f;
+            g = gamma_dither_table[(g << 6) | dith];
+            dith = ((cdith >> 9) & 0x38) | (cdith & 7);
+            b = gamma_dither_table[(b << 6) | dith];
+            break;
+    }
+    argb[1 ^ BYTE_ADDR_XOR] = (unsigned char)(r);
+    argb[2 ^ BYTE_ADDR_XOR] = (unsigned char)(g);
+    argb[3 ^ BYTE_ADDR_XOR] = (unsigned char)(b);
+    return;
+}
+
+STRICTINLINE static void video_max_optimized(UINT32* Pixels, UINT32* pen)
+{
+    int i;
+    int pos;
+    UINT32 max;
+    UINT32 curpen = Pixels[0];
+
+    pos = 0;
+    for (i = 1; i < 7; i++)
+    {
+        if (Pixels[i] > Pixels[pos])
+        {
+            curpen = Pixels[pos];
+            pos = i;            
+        }
+    }
+    max = Pixels[pos];
+    if (curpen != max)
+    {
+        for (i = pos + 1; i < 7; i++)
+        {
+            if (Pixels[i] > curpen)
+            {
+                curpen = Pixels[i];
+            }
+        }
+    }
+    *pen = curpen;
+    return;
+}
+
+/* irand(), on the VI's own generator */
+STRICTINLINE static INT32 vi_irand(void)
+{
+    vi_seed *= 0x343fd;
+    vi_seed += 0x269ec3;
+    return ((vi_seed >> 16) & 0x7fff);
+}
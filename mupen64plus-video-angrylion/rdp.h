@@ -317,16 +317,14 @@ enum {
 };
 
 extern void process_RDP_list(void);
+extern void flush_RDP_list(void);
+extern void rdp_threads_init(void);
+extern void rdp_threads_close(void);
+extern void rdp_init_state(void);
 #ifdef TRACE_DP_COMMANDS
 extern void count_DP_commands(void);
 #endif
 
-extern void (*fbread1_ptr)(UINT32, UINT32*);
-extern void (*fbread2_ptr)(UINT32, UINT32*);
-extern void (*fbwrite_ptr)(
-    UINT32, UINT32, UINT32, UINT32, UINT32, UINT32, UINT32);
-extern void (*fbfill_ptr)(UINT32);
-
 extern void fbwrite_4(
     UINT32 curpixel, UINT32 r, UINT32 g, UINT32 b, UINT32 blend_en,
     UINT32 curpixel_cvg, UINT32 curpixel_memcvg);
@@ -378,8 +376,6 @@ extern NOINLINE void render_spans_copy(
 extern NOINLINE void render_spans_fill(int start, int end, int flip);
 
 NOINLINE extern void edgewalker_for_loads(INT32* lewdata);
-extern void (*render_spans_1cycle_ptr)(int, int, int, int);
-extern void (*render_spans_2cycle_ptr)(int, int, int, int);
 
 extern INLINE void SET_BLENDER_INPUT(
     int cycle, int which, INT32 **input_r, INT32 **input_g, INT32 **input_b,
@@ -399,82 +395,136 @@ extern INLINE void SET_MUL_ALPHA_INPUT(INT32 **input, int code);
 int render_cycle_mode_counts[4];
 #endif
 
-extern i32 spans_d_rgba[4];
-extern i32 spans_d_stwz[4];
-extern u16 spans_dzpix;
-extern SPAN span[1024];
-
-extern i32 spans_d_rgba_dy[4];
-extern i32 spans_cd_rgba[4];
-extern int spans_cdz;
-
-extern i32 spans_d_stwz_dy[4];
-
-extern int scfield;
-extern int sckeepodd;
-
-extern int ti_format;
-extern int ti_size;
-extern int ti_width;
-extern UINT32 ti_address;
-
-extern int fb_format;
-extern int fb_size;
-extern int fb_width;
-extern UINT32 fb_address;
-extern UINT32 zb_address;
-
-extern UINT32 max_level;
-extern INT32 min_level;
-extern INT32 primitive_lod_frac;
-
-extern UINT32 primitive_z;
-extern UINT16 primitive_delta_z;
-
-extern UINT32 fill_color;
-
-extern INT32 *combiner_rgbsub_a_r[2];
-extern INT32 *combiner_rgbsub_a_g[2];
-extern INT32 *combiner_rgbsub_a_b[2];
-extern INT32 *combiner_rgbsub_b_r[2];
-extern INT32 *combiner_rgbsub_b_g[2];
-extern INT32 *combiner_rgbsub_b_b[2];
-extern INT32 *combiner_rgbmul_r[2];
-extern INT32 *combiner_rgbmul_g[2];
-extern INT32 *combiner_rgbmul_b[2];
-extern INT32 *combiner_rgbadd_r[2];
-extern INT32 *combiner_rgbadd_g[2];
-extern INT32 *combiner_rgbadd_b[2];
-
-extern INT32 *combiner_alphasub_a[2];
-extern INT32 *combiner_alphasub_b[2];
-extern INT32 *combiner_alphamul[2];
-extern INT32 *combiner_alphaadd[2];
-
-extern INT32 *blender1a_r[2];
-extern INT32 *blender1a_g[2];
-extern INT32 *blender1a_b[2];
-extern INT32 *blender1b_a[2];
-extern INT32 *blender2a_r[2];
-extern INT32 *blender2a_g[2];
-extern INT32 *blender2a_b[2];
-extern INT32 *blender2b_a[2];
-
-extern INT32 k0, k1, k2, k3, k4, k5;
-
-extern RECTANGLE __clip;
-extern TILE tile[8];
-
-extern OTHER_MODES other_modes;
-extern COMBINE_MODES combine;
-
-extern COLOR key_width;
-extern COLOR key_scale;
-extern COLOR key_center;
-extern COLOR fog_color;
-extern COLOR blend_color;
-extern COLOR prim_color;
-extern COLOR env_color;
+/*
+ * Everything the RDP commands and the pixel pipeline change while drawing.
+ * With more than one render thread, each worker replays the command list into
+ * a copy of its own (see n64video_rdp.c).  rdp_state points to the calling
+ * thread's copy.
+ */
+typedef struct {
+    int cmd_cur;
+    int rdp_thread_index;
+    UINT32 primitive_count;
+
+    int scfield;
+    int sckeepodd;
+
+    int ti_format;
+    int ti_size;
+    int ti_width;
+    UINT32 ti_address;
+
+    int fb_format;
+    int fb_size;
+    int fb_width;
+    UINT32 fb_address;
+    UINT32 zb_address;
+
+    UINT32 max_level;
+    INT32 min_level;
+    INT32 primitive_lod_frac;
+
+    UINT32 primitive_z;
+    UINT16 primitive_delta_z;
+
+    UINT32 fill_color;
+
+    INT32 *combiner_rgbsub_a_r[2];
+    INT32 *combiner_rgbsub_a_g[2];
+    INT32 *combiner_rgbsub_a_b[2];
+    INT32 *combiner_rgbsub_b_r[2];
+    INT32 *combiner_rgbsub_b_g[2];
+    INT32 *combiner_rgbsub_b_b[2];
+    INT32 *combiner_rgbmul_r[2];
+    INT32 *combiner_rgbmul_g[2];
+    INT32 *combiner_rgbmul_b[2];
+    INT32 *combiner_rgbadd_r[2];
+    INT32 *combiner_rgbadd_g[2];
+    INT32 *combiner_rgbadd_b[2];
+
+    INT32 *combiner_alphasub_a[2];
+    INT32 *combiner_alphasub_b[2];
+    INT32 *combiner_alphamul[2];
+    INT32 *combiner_alphaadd[2];
+
+    INT32 *blender1a_r[2];
+    INT32 *blender1a_g[2];
+    INT32 *blender1a_b[2];
+    INT32 *blender1b_a[2];
+    INT32 *blender2a_r[2];
+    INT32 *blender2a_g[2];
+    INT32 *blender2a_b[2];
+    INT32 *blender2b_a[2];
+
+    INT32 k0, k1, k2, k3, k4, k5;
+
+    RECTANGLE __clip;
+    TILE tile[8];
+
+    OTHER_MODES other_modes;
+    COMBINE_MODES combine;
+
+    COLOR key_width;
+    COLOR key_scale;
+    COLOR key_center;
+    COLOR fog_color;
+    COLOR blend_color;
+    COLOR prim_color;
+    COLOR env_color;
+
+    COLOR combined_color;
+    COLOR texel0_color;
+    COLOR texel1_color;
+    COLOR nexttexel_color;
+    COLOR shade_color;
+    COLOR pixel_color;
+    COLOR inv_pixel_color;
+    COLOR blended_pixel_color;
+    COLOR memory_color;
+    COLOR pre_memory_color;
+    INT32 noise;
+    INT32 keyalpha;
+    INT32 lod_frac;
+    int blshifta, blshiftb, pastblshifta, pastblshiftb;
+    INT32 iseed;
+
+    void (*fbread1_ptr)(UINT32, UINT32*);
+    void (*fbread2_ptr)(UINT32, UINT32*);
+    void (*fbwrite_ptr)(
+        UINT32, UINT32, UINT32, UINT32, UINT32, UINT32, UINT32);
+    void (*fbfill_ptr)(UINT32);
+    void (*get_dither_noise_ptr)(int, int, int*, int*);
+    void (*rgb_dither_ptr)(int*, int*, int*, int);
+    void (*tcdiv_ptr)(INT32, INT32, INT32, INT32*, INT32*);
+    void (*render_spans_1cycle_ptr)(int, int, int, int);
+    void (*render_spans_2cycle_ptr)(int, int, int, int);
+
+    ALIGNED i32 spans_d_rgba[4];
+    ALIGNED i32 spans_d_stwz[4];
+    u16 spans_dzpix;
+
+    ALIGNED i32 spans_d_rgba_dy[4];
+    ALIGNED i32 spans_cd_rgba[4];
+    int spans_cdz;
+
+    ALIGNED i32 spans_d_stwz_dy[4];
+
+    SPAN span[1024];
+    UINT32 cvgbuf[1024];
+
+    UINT8 __TMEM[0x1000];
+} RDP_STATE;
+
+extern TLS RDP_STATE* rdp_state;
+
+extern int rdp_threads;
+
+#ifdef HAVE_RDP_THREADS
+#define SCANLINE_SKIPPED(y) \
+    ((unsigned)(y) % rdp_threads != rdp_state->rdp_thread_index)
+#else
+#define SCANLINE_SKIPPED(y) 0
+#endif
 
 extern int rdp_pipeline_crashed;
 
@@ -0,0 +1,344 @@
+/*
+ * rdp-thread-check: the renderer on one and on several render threads
+ *
+ * Draws a made-up display list a few times over, the way a game would once
+ * per frame: fills of the colour and depth images, triangles with shade and
+ * depth in 1-cycle and 2-cycle modes with the noise on, and a copy of a
+ * block of the colour image through TMEM.
+ *
+ * On 2, 3 and 4 threads the images have to hash to the same as on one:  each
+ * span starts the pixel pipeline and the noise generator over from the same
+ * seed, whichever thread draws it.
+ *
+ *     rdp-thread-check [-n frames] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "z64.h"
+#include "vi.h"
+
+#define RDRAM_SIZE          0x800000
+#define DL_ADDRESS          0x002000
+#define FB_ADDRESS          0x100000
+#define ZB_ADDRESS          0x200000
+#define FB_WIDTH            320
+#define FB_HEIGHT           240
+#define MAX_DL_WORDS        0x4000
+
+#define DEFAULT_FRAMES      8
+
+GFX_INFO gfx_info;
+UINT8* rdram_8;
+UINT16* rdram_16;
+UINT32 plim;
+UINT32 idxlim16;
+UINT32 idxlim32;
+UINT8 hidden_bits[0x400000];
+UINT32 gamma_table[0x100];
+UINT32 gamma_dither_table[0x4000];
+INT32 vi_restore_table[0x400];
+onetime onetimewarnings;
+
+extern void process_RDP_list(void);
+extern void flush_RDP_list(void);
+
+static UINT32 rdram_image[RDRAM_SIZE / 4];
+static UINT32 dmem[0x1000 / 4];
+static UINT32 mi_intr, dpc_start, dpc_end, dpc_current, dpc_status;
+static UINT32 dl_words;
+static UINT32 seed = 0x2A2A2A2A;
+static int verbose;
+
+NOINLINE void DisplayError(char * error)
+{
+    if (verbose)
+        fprintf(stderr, "rdp: %s\n", error);
+}
+
+NOINLINE void zerobuf(void * memory, size_t length)
+{
+    memset(memory, 0, length);
+}
+
+static void check_interrupts(void)
+{
+}
+
+static UINT32 next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed <<  5;
+    return seed;
+}
+
+/* a number from lo to hi - 1 */
+static INT32 random_range(INT32 lo, INT32 hi)
+{
+    return lo + (INT32)(next_random() % (UINT32)(hi - lo));
+}
+
+static void command(UINT32 w0, UINT32 w1)
+{
+    UINT32* dl = &rdram_image[DL_ADDRESS / 4];
+
+    if (dl_words + 2 > MAX_DL_WORDS)
+    {
+        fprintf(stderr, "rdp-thread-check: display list too long\n");
+        exit(2);
+    }
+    dl[dl_words++] = w0;
+    dl[dl_words++] = w1;
+}
+
+static void set_color_image(UINT32 address)
+{
+    command(0x3F << 24 | 2 << 19 | (FB_WIDTH - 1), address);
+}
+
+static void fill_rectangle(int x0, int y0, int x1, int y1)
+{
+    command(0x36 << 24 | (x1*4) << 12 | (y1*4), (x0*4) << 12 | (y0*4));
+}
+
+/* 16.16 fixed point as the edge and attribute coefficients take it */
+static UINT32 fixed(INT32 whole, INT32 fraction)
+{
+    return (UINT32)(whole << 16) + (UINT32)fraction;
+}
+
+static void attribute_pairs(const UINT32* v, UINT32 out[2][2])
+{
+    out[0][0] = (v[0] & 0xFFFF0000) | (v[1] >> 16);
+    out[0][1] = (v[2] & 0xFFFF0000) | (v[3] >> 16);
+    out[1][0] = (v[0] << 16) | (v[1] & 0x0000FFFF);
+    out[1][1] = (v[2] << 16) | (v[3] & 0x0000FFFF);
+}
+
+/* a shaded, depth-buffered triangle (command 0x0D) around cx, cy */
+static void triangle(int cx, int cy, int size)
+{
+    int x[3], y[3];
+    INT32 dxh, dxm, dxl;
+    UINT32 color[4], dcolor_dx[4], dcolor_de[4];
+    UINT32 c[2][2], dx[2][2], de[2][2];
+    UINT32 z, dz;
+    int lft;
+    int i, j;
+
+    for (i = 0; i < 3; i++)
+    {
+        x[i] = cx + random_range(-size, size);
+        y[i] = cy + random_range(-size, size);
+    }
+    for (i = 0; i < 3; i++)
+        for (j = i + 1; j < 3; j++)
+            if (y[j] < y[i])
+            {
+                int t;
+
+                t = x[i]; x[i] = x[j]; x[j] = t;
+                t = y[i]; y[i] = y[j]; y[j] = t;
+            }
+    if (y[2] == y[0])
+        return;
+
+    dxh = (INT32)(((INT64)(x[2] - x[0]) << 16) / (y[2] - y[0]));
+    dxm = (y[1] == y[0]) ? 0 : (INT32)(((INT64)(x[1] - x[0]) << 16) / (y[1] - y[0]));
+    dxl = (y[2] == y[1]) ? 0 : (INT32)(((INT64)(x[2] - x[1]) << 16) / (y[2] - y[1]));
+    lft = ((INT64)x[0] << 16) + (INT64)dxh*(y[1] - y[0]) < ((INT64)x[1] << 16);
+
+    command(
+        0x0D << 24 | lft << 23 | ((y[2]*4) & 0x3FFF),
+        ((y[1]*4) & 0x3FFF) << 16 | ((y[0]*4) & 0x3FFF));
+    command(fixed(x[1], 0), (UINT32)dxl);
+    command(fixed(x[0], 0), (UINT32)dxh);
+    command(fixed(x[0], 0), (UINT32)dxm);
+
+    for (i = 0; i < 4; i++)
+    {
+        color[i] = fixed(random_range(i == 3 ? 64 : 0, 256), 0);
+        dcolor_dx[i] = (UINT32)random_range(-0x10000, 0x10000);
+        dcolor_de[i] = (UINT32)random_range(-0x10000, 0x10000);
+    }
+    attribute_pairs(color, c);
+    attribute_pairs(dcolor_dx, dx);
+    attribute_pairs(dcolor_de, de);
+    command(c[0][0], c[0][1]);
+    command(dx[0][0], dx[0][1]);
+    command(c[1][0], c[1][1]);
+    command(dx[1][0], dx[1][1]);
+    command(de[0][0], de[0][1]);
+    command(de[0][0], de[0][1]);
+    command(de[1][0], de[1][1]);
+    command(de[1][0], de[1][1]);
+
+    z = fixed(random_range(100, 30000), 0);
+    dz = (UINT32)random_range(-20 << 16, 20 << 16);
+    command(z, dz);
+    command(dz, dz);
+}
+
+static void build_display_list(void)
+{
+    int k;
+
+    dl_words = 0;
+    command(0x3E << 24, ZB_ADDRESS);                    /* set_mask_image */
+    /* scissor:  a pixel at x == FB_WIDTH would be the next row's, and thread's */
+    command(0x2D << 24, ((FB_WIDTH - 1)*4) << 12 | (FB_HEIGHT*4));
+    command(0x27 << 24, 0);
+    command(0x2F << 24 | 3 << 20, 0);                   /* fill mode */
+    set_color_image(ZB_ADDRESS);
+    command(0x37 << 24, 0xFFFCFFFC);
+    fill_rectangle(0, 0, FB_WIDTH - 1, FB_HEIGHT - 1);
+    command(0x27 << 24, 0);
+    set_color_image(FB_ADDRESS);
+    command(0x37 << 24, 0x21432143);
+    fill_rectangle(0, 0, FB_WIDTH - 1, FB_HEIGHT - 1);
+    command(0x27 << 24, 0);
+
+    for (k = 0; k < 240; k++)
+    {
+        if (k % 60 == 0)
+        {
+            command(0x27 << 24, 0);
+            if (k % 120 == 0)
+            { /* 1 cycle, noise dither, blend with memory, depth */
+                command(
+                    0x2F << 24 | 0 << 20 | 2 << 6 | 2 << 4,
+                    0x00400000 | 0x4000 | 0x40 | 0x30 | 0x08);
+                command(
+                    0x3C << 24 | 15 << 20 | 31 << 15 | 7 << 12 | 7 << 9
+                  | 15 << 5 | 31,
+                    15u << 28 | 15 << 24 | 7 << 21 | 7 << 18 | 4 << 15
+                  | 7 << 12 | 4 << 9 | 4 << 6 | 7 << 3 | 4);
+            }
+            else
+            { /* 2 cycle, noise in the combiner */
+                command(
+                    0x2F << 24 | 1 << 20 | 2 << 6 | 2 << 4,
+                    0x00400000 | 0x00100000 | 0x4000 | 0x40 | 0x30 | 0x08);
+                command(
+                    0x3C << 24 | 7 << 20 | 4 << 15 | 7 << 12 | 7 << 9
+                  | 15 << 5 | 31,
+                    8u << 28 | 15 << 24 | 7 << 21 | 7 << 18 | 7 << 15
+                  | 7 << 12 | 4 << 9 | 0 << 6 | 7 << 3 | 0);
+            }
+        }
+        triangle(
+            random_range(0, FB_WIDTH), random_range(0, FB_HEIGHT),
+            random_range(10, 70));
+    }
+
+    /* copy a 64x32 block of the colour image back into it through TMEM */
+    command(0x27 << 24, 0);
+    command(0x3D << 24 | 2 << 19 | (FB_WIDTH - 1), FB_ADDRESS);
+    command(0x35 << 24 | 2 << 19 | 16 << 9, 0);          /* set_tile */
+    command(0x26 << 24, 0);
+    command(0x34 << 24, (63*4) << 12 | (31*4));          /* load_tile */
+    command(0x28 << 24, 0);
+    command(0x32 << 24, (63*4) << 12 | (31*4));          /* set_tile_size */
+    command(0x2F << 24 | 2 << 20, 0);                    /* copy mode */
+    for (k = 0; k < 4; k++)
+    {
+        const int x = 200 + 8*k, y = 150 + 20*k;
+
+        command(
+            0x24 << 24 | ((x + 63)*4) << 12 | ((y + 31)*4),
+            (x*4) << 12 | (y*4));
+        command(0, (4 << 10) << 16 | (1 << 10));
+    }
+    command(0x29 << 24, 0);                              /* sync_full */
+}
+
+static UINT32 hash_bytes(UINT32 hash, const void* data, size_t length)
+{
+    const UINT8* p = (const UINT8*)data;
+
+    while (length-- != 0)
+    {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Draws the frames and hashes the colour and depth images after each. */
+static UINT32 run_frames(int threads, int frames)
+{
+    UINT32 hash = 2166136261u;
+    int frame;
+
+    render_threads = threads;
+    rdp_init();
+    for (frame = 0; frame < frames; frame++)
+    {
+        dpc_status = 0;
+        dpc_start = dpc_current = DL_ADDRESS;
+        dpc_end = DL_ADDRESS + 4*dl_words;
+        process_RDP_list();
+        flush_RDP_list();
+
+        hash = hash_bytes(hash, &rdram_image[FB_ADDRESS / 4], FB_WIDTH*FB_HEIGHT*2);
+        hash = hash_bytes(hash, &rdram_image[ZB_ADDRESS / 4], FB_WIDTH*FB_HEIGHT*2);
+    }
+    rdp_close();
+    return hash;
+}
+
+int main(int argc, char** argv)
+{
+    UINT32 serial, threaded;
+    int frames = DEFAULT_FRAMES;
+    int failed = 0;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else
+        {
+            fprintf(stderr, "usage: %s [-n frames] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames < 1)
+        frames = 1;
+
+    gfx_info.RDRAM = (unsigned char*)rdram_image;
+    gfx_info.DMEM = (unsigned char*)dmem;
+    gfx_info.MI_INTR_REG = &mi_intr;
+    gfx_info.DPC_START_REG = &dpc_start;
+    gfx_info.DPC_END_REG = &dpc_end;
+    gfx_info.DPC_CURRENT_REG = &dpc_current;
+    gfx_info.DPC_STATUS_REG = &dpc_status;
+    gfx_info.CheckInterrupts = check_interrupts;
+    build_display_list();
+
+    printf("Angrylion RDP: %u display list words, %d frames\n\n",
+        (unsigned)dl_words, frames);
+
+    serial = run_frames(1, frames);
+    printf("1 thread    %08x\n", (unsigned)serial);
+
+    for (i = 2; i <= 4; i++)
+    {
+        threaded = run_frames(i, frames);
+        printf("%d threads   %08x", i, (unsigned)threaded);
+        if (threaded == serial)
+            printf("\n");
+        else
+        {
+            printf("  MISMATCH, 1 thread drew %08x\n", (unsigned)serial);
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -65,6 +65,7 @@ extern UINT32 idxlim32;
 extern UINT8 hidden_bits[0x400000];
 
 extern int overlay;
+extern int render_threads;
 extern int skip;
 extern int step;
 
@@ -78,7 +79,14 @@ extern INT32* PreScale;
 extern NOINLINE void DisplayError(char * error);
 extern NOINLINE void zerobuf(void * memory, size_t length);
 
-extern STRICTINLINE INT32 irand(void);
+extern void vi_fetch_filter16_row(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter);
+extern void vi_fetch_filter32_row(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter);
+extern void divot_filter_row(CCVG* final, const CCVG* viaa, int count);
+extern void gamma_filters_row(UINT32* scanline, int count, int gamma_and_dither);
 extern void rdp_init(void);
 extern void rdp_close(void);
 extern void rdp_update(void);
@@ -0,0 +1,478 @@
+/*
+ * vi-filter-check: cross-check and micro-benchmark of the VI filter rows
+ *
+ * Every row goes through both the SIMD build (SSE2 or NEON) and the C build of
+ * n64video_vi_filter.c, into output buffers filled with the same junk, and
+ * any byte that differs afterwards is a mismatch. The rows are made up:
+ * framebuffers of random pixels, or of a few colours so that the filters
+ * see ties, at random places in RDRAM including both ends of it. Column 0
+ * with divot on is also run the way the VI runs it, fetch then divot. Then
+ * both builds are timed on a 320x240 framebuffer, in ns per pixel.
+ *
+ *     vi-filter-check [-c rows] [-n frames] [-s seed] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "z64.h"
+#include "vi.h"
+
+#define RDRAM_SIZE          0x800000
+#define MAX_ROW             1024
+#define MISMATCHES_SHOWN    4
+
+GFX_INFO gfx_info;
+UINT16* rdram_16;
+UINT32 idxlim16;
+UINT32 idxlim32;
+UINT8 hidden_bits[0x400000];
+UINT32 gamma_table[0x100];
+UINT32 gamma_dither_table[0x4000];
+INT32 vi_restore_table[0x400];
+
+extern void vi_fetch_filter16_row_reference(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter);
+extern void vi_fetch_filter32_row_reference(
+    CCVG* res, UINT32 fboffset, UINT32 cur_x, int count, UINT32 fbw,
+    UINT32 fsaa, UINT32 dither_filter);
+extern void divot_filter_row_reference(
+    CCVG* final, const CCVG* viaa, int count);
+extern void gamma_filters_row_reference(
+    UINT32* scanline, int count, int gamma_and_dither);
+
+typedef void (*fetch_func)(
+    CCVG*, UINT32, UINT32, int, UINT32, UINT32, UINT32);
+
+enum { FETCH16, FETCH32, DIVOT, GAMMA, NUM_FILTERS };
+
+static const char* filter_names[NUM_FILTERS] = {
+    "fetch16", "fetch32", "divot", "gamma"
+};
+
+static UINT32 seed = 0x2A2A2A2A;
+static int verbose;
+static long mismatches[NUM_FILTERS];
+static long shown;
+
+static UINT32 next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed <<  5;
+    return seed;
+}
+
+/* as rdp_init() builds them */
+static UINT32 integer_sqrt(UINT32 a)
+{
+    UINT32 op = a, res = 0, one = 1 << 30;
+
+    while (one > op)
+        one >>= 2;
+    while (one != 0)
+    {
+        if (op >= res + one)
+        {
+            op -= res + one;
+            res += one << 1;
+        }
+        res >>= 1;
+        one >>= 2;
+    }
+    return res;
+}
+
+static void init_tables(void)
+{
+    int i;
+
+    for (i = 0; i < 0x100; i++)
+        gamma_table[i] = integer_sqrt(i << 6) << 1;
+    for (i = 0; i < 0x4000; i++)
+        gamma_dither_table[i] = integer_sqrt(i) << 1;
+    for (i = 0; i < 0x400; i++)
+    {
+        if (((i >> 5) & 0x1f) > (i & 0x1f))
+            vi_restore_table[i] = 1;
+        else if (((i >> 5) & 0x1f) < (i & 0x1f))
+            vi_restore_table[i] = -1;
+        else
+            vi_restore_table[i] = 0;
+    }
+}
+
+/*
+ * Half of the time only four colours, and full coverage more often than
+ * not, which is what the filters have to pick between in real frames.
+ */
+static void fill_pixels(UINT32 first, UINT32 count, int is32)
+{
+    UINT32 palette[4];
+    int few = next_random() & 1;
+    UINT32 i;
+
+    for (i = 0; i < 4; i++)
+        palette[i] = next_random();
+
+    for (i = first; i < first + count; i++)
+    {
+        UINT32 pix = few ? palette[next_random() & 3] : next_random();
+        UINT32 full = (next_random() & 3) != 0;
+
+        if (is32)
+        {
+            if (i > idxlim32)
+                break;
+            if (full)
+                pix |= 7 << 5;
+            rdram[i] = pix;
+        }
+        else
+        {
+            if (i > idxlim16)
+                break;
+            if (full)
+                pix |= 1;
+            rdram_16[i] = (UINT16)pix;
+            hidden_bits[i] = full ? 3 : (pix >> 16) & 3;
+        }
+    }
+}
+
+static void report(int filter, const char* what, const void* got,
+    const void* ref, size_t size)
+{
+    const UINT32* g = (const UINT32 *)got;
+    const UINT32* r = (const UINT32 *)ref;
+    size_t i;
+    int lines = 0;
+
+    mismatches[filter]++;
+    if (!verbose && shown >= MISMATCHES_SHOWN)
+        return;
+    shown++;
+
+    printf("  %s %s:\n", filter_names[filter], what);
+    for (i = 0; i < size / 4 && lines < 8; i++)
+        if (g[i] != r[i])
+        {
+            printf("    [%u] %08X  (reference %08X)\n", (unsigned)i, g[i], r[i]);
+            lines++;
+        }
+}
+
+static void check_fetch(int is32)
+{
+    static CCVG got[MAX_ROW], ref[MAX_ROW];
+    UINT32 limit = is32 ? idxlim32 : idxlim16;
+    UINT32 fbw = 1 + next_random() % 640;
+    UINT32 fsaa = next_random() & 1;
+    UINT32 dither_filter = next_random() & 1;
+    int count = 1 + next_random() % (MAX_ROW - 1);
+    UINT32 fboffset = next_random() & 0xFFFFFF;
+    UINT32 cur_x, idx, first;
+    char what[96];
+
+    /* the edges of RDRAM are where the row falls back to the C code */
+    switch (next_random() & 7)
+    {
+        case 0:
+            idx = next_random() % (2 * fbw + 16);
+            break;
+        case 1:
+            idx = limit - next_random() % (2 * fbw + MAX_ROW);
+            break;
+        default:
+            idx = next_random() % (limit + 1);
+            break;
+    }
+    cur_x = idx - (fboffset >> (is32 ? 2 : 1));
+    first = idx > fbw + 16 ? idx - fbw - 16 : 0;
+    fill_pixels(first, idx + count + fbw + 16 - first, is32);
+
+    memset(got, 0xA5, sizeof(got));
+    memset(ref, 0xA5, sizeof(ref));
+    if (is32)
+    {
+        vi_fetch_filter32_row(got, fboffset, cur_x, count, fbw, fsaa, dither_filter);
+        vi_fetch_filter32_row_reference(ref, fboffset, cur_x, count, fbw, fsaa, dither_filter);
+    }
+    else
+    {
+        vi_fetch_filter16_row(got, fboffset, cur_x, count, fbw, fsaa, dither_filter);
+        vi_fetch_filter16_row_reference(ref, fboffset, cur_x, count, fbw, fsaa, dither_filter);
+    }
+
+    if (memcmp(got, ref, sizeof(got)) != 0)
+    {
+        sprintf(what, "idx=%X count=%d fbw=%u fsaa=%u dither_filter=%u",
+            idx, count, fbw, fsaa, dither_filter);
+        report(is32 ? FETCH32 : FETCH16, what, got, ref, sizeof(got));
+    }
+}
+
+static void check_divot(void)
+{
+    static CCVG viaa[MAX_ROW + 2], got[MAX_ROW], ref[MAX_ROW];
+    int count = 1 + next_random() % (MAX_ROW - 1);
+    int few = next_random() & 1;
+    char what[32];
+    int i;
+
+    for (i = 0; i < count + 2; i++)
+    {
+        UINT32 pix = next_random();
+
+        if (few)
+            pix &= 0x03030303;
+        viaa[i].r = pix;
+        viaa[i].g = pix >> 8;
+        viaa[i].b = pix >> 16;
+        viaa[i].cvg = (next_random() & 1) ? 7 : (pix >> 24) & 7;
+    }
+
+    memset(got, 0xA5, sizeof(got));
+    memset(ref, 0xA5, sizeof(ref));
+    divot_filter_row(got, &viaa[1], count);
+    divot_filter_row_reference(ref, &viaa[1], count);
+
+    if (memcmp(got, ref, sizeof(got)) != 0)
+    {
+        sprintf(what, "count=%d", count);
+        report(DIVOT, what, got, ref, sizeof(got));
+    }
+}
+
+/*
+ * Column 0 with divot on, as do_frame_buffer_proper() runs it: column -1
+ * is fetched into the slot in front of the cache, and the divot filter of
+ * column 0 reads it from there. The SIMD build runs twice, over caches
+ * filled with different junk, so that a column read but never fetched
+ * shows up as a mismatch too.
+ */
+static void check_divot_column0(int is32)
+{
+    static CCVG viaa[2][MAX_ROW + 2], got[2][MAX_ROW], ref[MAX_ROW];
+    UINT32 fbw = 1 + next_random() % 640;
+    UINT32 fsaa = next_random() & 1;
+    UINT32 dither_filter = next_random() & 1;
+    int count = 1 + next_random() % (MAX_ROW - 1);
+    UINT32 fboffset = next_random() & 0x1FFFFC;
+    UINT32 line = next_random() % 240;
+    UINT32 cur_x, idx, first;
+    char what[96];
+    int k;
+
+    /* the first line of a framebuffer at 0 fetches column -1 off RDRAM */
+    if ((next_random() & 7) == 0)
+        fboffset = line = 0;
+    cur_x = line * fbw - 1;
+    idx = (fboffset >> (is32 ? 2 : 1)) + cur_x;
+    first = idx > fbw + 16 ? idx - fbw - 16 : 0;
+    fill_pixels(first, idx + count + fbw + 16 - first, is32);
+
+    for (k = 0; k < 2; k++)
+    {
+        memset(viaa[k], k ? 0x5A : 0xA5, sizeof(viaa[k]));
+        memset(got[k], 0xA5, sizeof(got[k]));
+        if (is32)
+            vi_fetch_filter32_row(viaa[k], fboffset, cur_x, count + 2, fbw, fsaa, dither_filter);
+        else
+            vi_fetch_filter16_row(viaa[k], fboffset, cur_x, count + 2, fbw, fsaa, dither_filter);
+        divot_filter_row(got[k], &viaa[k][1], count);
+    }
+
+    memset(viaa[0], 0xA5, sizeof(viaa[0]));
+    memset(ref, 0xA5, sizeof(ref));
+    if (is32)
+        vi_fetch_filter32_row_reference(viaa[0], fboffset, cur_x, count + 2, fbw, fsaa, dither_filter);
+    else
+        vi_fetch_filter16_row_reference(viaa[0], fboffset, cur_x, count + 2, fbw, fsaa, dither_filter);
+    divot_filter_row_reference(ref, &viaa[0][1], count);
+
+    for (k = 0; k < 2; k++)
+        if (memcmp(got[k], ref, sizeof(ref)) != 0)
+        {
+            sprintf(what, "column 0, %s junk, %u-bit line=%u fbw=%u count=%d",
+                k ? "second" : "first", is32 ? 32 : 16, line, fbw, count);
+            report(DIVOT, what, got[k], ref, sizeof(ref));
+            break;
+        }
+}
+
+/* both builds draw the same number of vi_irand() values, so stay in step */
+static void check_gamma(void)
+{
+    static UINT32 got[MAX_ROW], ref[MAX_ROW];
+    int count = next_random() % MAX_ROW;
+    int gamma_and_dither = next_random() & 3;
+    char what[48];
+    int i;
+
+    for (i = 0; i < MAX_ROW; i++)
+        got[i] = ref[i] = next_random();
+
+    gamma_filters_row(got, count, gamma_and_dither);
+    gamma_filters_row_reference(ref, count, gamma_and_dither);
+
+    if (memcmp(got, ref, sizeof(got)) != 0)
+    {
+        sprintf(what, "count=%d gamma_and_dither=%d", count, gamma_and_dither);
+        report(GAMMA, what, got, ref, sizeof(got));
+    }
+}
+
+static double time_fetch(fetch_func func, long frames, int is32)
+{
+    static CCVG out[MAX_ROW];
+    UINT32 fboffset = 0x100000;
+    long pixels = 0, n;
+    clock_t t1, t2;
+    int y;
+
+    t1 = clock();
+    for (n = 0; n < frames; n++)
+        for (y = 0; y < 240; y++)
+        {
+            func(out, fboffset, 320 * y, 320, 320, 1, 1);
+            pixels += 320;
+        }
+    t2 = clock();
+
+    return (double)(t2 - t1) * 1e9 / CLOCKS_PER_SEC / (double)pixels;
+}
+
+static double time_divot(
+    void (*func)(CCVG*, const CCVG*, int), long frames)
+{
+    static CCVG viaa[322], out[320];
+    long pixels = 0, n;
+    clock_t t1, t2;
+    int i, y;
+
+    for (i = 0; i < 322; i++)
+        *(UINT32 *)&viaa[i] = next_random() & 0x07FFFFFF;
+
+    t1 = clock();
+    for (n = 0; n < frames; n++)
+        for (y = 0; y < 240; y++)
+        {
+            func(out, &viaa[1], 320);
+            pixels += 320;
+        }
+    t2 = clock();
+
+    return (double)(t2 - t1) * 1e9 / CLOCKS_PER_SEC / (double)pixels;
+}
+
+static double time_gamma(
+    void (*func)(UINT32*, int, int), long frames)
+{
+    static UINT32 scanline[320];
+    long pixels = 0, n;
+    clock_t t1, t2;
+    int i, y;
+
+    t1 = clock();
+    for (n = 0; n < frames; n++)
+        for (y = 0; y < 240; y++)
+        {
+            for (i = 0; i < 320; i++)
+                scanline[i] = 0x00010101 * (i & 0xFF);
+            func(scanline, 320, 3);
+            pixels += 320;
+        }
+    t2 = clock();
+
+    return (double)(t2 - t1) * 1e9 / CLOCKS_PER_SEC / (double)pixels;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [-c rows] [-n frames] [-s seed] [-v]\n"
+        "  -c  random rows cross-checked per filter (default 20000)\n"
+        "  -n  320x240 frames timed per build (default 50)\n"
+        "  -s  random seed (default 0x2A2A2A2A)\n"
+        "  -v  print every mismatch instead of the first few\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    double simd[NUM_FILTERS], scalar[NUM_FILTERS];
+    long checks = 20000;
+    long frames = 50;
+    long total = 0;
+    long i;
+    int f;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            checks = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            frames = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            seed = (UINT32)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-v") == 0)
+            verbose = 1;
+        else
+            usage(argv[0]);
+    }
+    if (seed == 0)
+        seed = 1; /* xorshift never leaves zero */
+    if (checks <= 0 || frames <= 0)
+        usage(argv[0]);
+
+    gfx_info.RDRAM = (unsigned char *)calloc(1, RDRAM_SIZE);
+    if (gfx_info.RDRAM == NULL)
+        return 2;
+    rdram_16 = (UINT16 *)gfx_info.RDRAM;
+    init_tables();
+
+    for (i = 0; i < checks; i++)
+    {
+        /* 8 MB of RDRAM, and 4 MB */
+        UINT32 plim = (i & 1) ? 0x007FFFFF : 0x003FFFFF;
+
+        idxlim16 = (plim >> 1) & 0x00FFFFFF;
+        idxlim32 = (plim >> 2) & 0x00FFFFFF;
+        check_fetch(0);
+        check_fetch(1);
+        check_divot();
+        check_divot_column0(i & 1);
+        check_gamma();
+    }
+
+    idxlim16 = 0x003FFFFF;
+    idxlim32 = 0x001FFFFF;
+    fill_pixels(0x100000 >> 1, 320 * 240 + 2048, 0);
+    simd[FETCH16] = time_fetch(vi_fetch_filter16_row, frames, 0);
+    scalar[FETCH16] = time_fetch(vi_fetch_filter16_row_reference, frames, 0);
+    fill_pixels(0x100000 >> 2, 320 * 240 + 2048, 1);
+    simd[FETCH32] = time_fetch(vi_fetch_filter32_row, frames, 1);
+    scalar[FETCH32] = time_fetch(vi_fetch_filter32_row_reference, frames, 1);
+    simd[DIVOT] = time_divot(divot_filter_row, frames);
+    scalar[DIVOT] = time_divot(divot_filter_row_reference, frames);
+    simd[GAMMA] = time_gamma(gamma_filters_row, frames);
+    scalar[GAMMA] = time_gamma(gamma_filters_row_reference, frames);
+
+    printf("Angrylion VI filters: SIMD against the C code\n");
+    printf("%ld random rows checked per filter, %ld frames timed per build\n\n",
+        checks, frames);
+    printf("filter   SIMD ns/px  C ns/px  speed-up  mismatches\n");
+    for (f = 0; f < NUM_FILTERS; f++)
+    {
+        printf("%-8s %10.2f %8.2f %8.2fx %11ld\n", filter_names[f],
+            simd[f], scalar[f], simd[f] > 0 ? scalar[f] / simd[f] : 0.0,
+            mismatches[f]);
+        total += mismatches[f];
+    }
+    return total != 0;
+}
@@ -93,6 +93,23 @@ typedef int8_t INT8;
 #define ALIGNED         __attribute__((aligned(16)))
 #endif
 
+/*
+ * With render threads, each thread draws into an RDP_STATE of its own, which
+ * rdp_state (rdp.h) points to.  That pointer is the only thread-local variable
+ * of the renderer.  With glibc it gets a slot in the static TLS block, so that
+ * looking it up is a single load rather than a call into the loader.
+ */
+#if defined(SINGLE_THREAD) || defined(_MSC_VER)
+#define TLS
+#else
+#define HAVE_RDP_THREADS
+#if defined(__GLIBC__) && defined(__ELF__)
+#define TLS             __thread __attribute__((tls_model("initial-exec")))
+#else
+#define TLS             __thread
+#endif
+#endif
+
 #define PRESCALE_WIDTH 640
 #define PRESCALE_HEIGHT 625
 
@@ -517,6 +517,7 @@ void WriteSettings (bool saveEmulationSettings)
   ini->Write(_T("ghq_enht_f16bpp"), settings.ghq_enht_f16bpp);
   ini->Write(_T("ghq_enht_gz"), settings.ghq_enht_gz);
   ini->Write(_T("ghq_enht_nobg"), settings.ghq_enht_nobg);
+  ini->Write(_T("ghq_enht_async"), settings.ghq_enht_async);
   ini->Write(_T("ghq_hirs_cmpr"), settings.ghq_hirs_cmpr);
   ini->Write(_T("ghq_hirs_tile"), settings.ghq_hirs_tile);
   ini->Write(_T("ghq_hirs_f16bpp"), settings.ghq_hirs_f16bpp);
@@ -1067,6 +1068,8 @@ int InitGfx ()
         options |= FORCE16BPP_HIRESTEX;
       if (settings.ghq_enht_gz)
         options |= GZ_TEXCACHE;
+      if (settings.ghq_enht_async)
+        options |= ASYNC_TEX;
       if (settings.ghq_hirs_gz)
         options |= GZ_HIRESTEXCACHE;
       if (settings.ghq_cache_save)
@@ -2151,6 +2154,12 @@ void newSwapBuffers()
 
   frame_count ++;
 
+#ifdef TEXTURE_FILTER
+  // Textures enhanced in the background during this frame show from the next
+  if (settings.ghq_use && settings.ghq_enht_async)
+    ext_ghq_txfilter_collect();
+#endif
+
 #ifndef __LIBRETRO__
   swapbuffer_toggledebugger();
 #endif
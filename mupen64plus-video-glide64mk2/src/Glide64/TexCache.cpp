@@ -88,48 +88,145 @@ typedef struct HIRESTEX_t {
 #endif
 
 //****************************************************************
-// List functions
+// Cache lookup table
+//
+// Open addressing with linear probing. Each cached texture takes one slot,
+// keyed on everything GetTexInfo matches on, so probing reads nothing but
+// the table. A slot is only live if it carries the current generation, so
+// ClearCache empties the table by bumping the generation. A live slot
+// without a cache entry was dropped and only keeps probe chains intact.
+//
+// At most MAX_CACHE textures per tmu are cached before the cache is
+// cleared, so the table never gets more than half full.
+
+#define CACHE_SLOTS (MAX_CACHE*MAX_TMU*2)
+
+typedef struct CACHE_SLOT_t {
+  uint32_t  generation;
+  uint32_t  crc;
+  uint32_t  width;
+  uint32_t  height;
+  uint32_t  flags;
+  int       tmu;
+  int       number;
+  CACHE_LUT *cache;
+} CACHE_SLOT;
 
-typedef struct NODE_t {
-  uint32_t	crc;
-  uintptr_t	data;
-  int		tmu;
-  int		number;
-  NODE_t	*pNext;
-} NODE;
+static CACHE_SLOT cachelut[CACHE_SLOTS];
+static uint32_t cache_generation = 1;
 
-NODE *cachelut[65536];
+static inline uint32_t CacheSlot (uint32_t crc, uint32_t width, uint32_t height, uint32_t flags)
+{
+  uint32_t h = crc ^ flags ^ (width << 20) ^ (height << 8);
+  h *= 0x9E3779B1;
+  return (h ^ (h >> 15)) & (CACHE_SLOTS - 1);
+}
 
-void AddToList (NODE **list, uint32_t crc, uintptr_t data, int tmu, int number)
+static void AddToList (CACHE_LUT *cache, int tmu, int number)
 {
-  NODE *node = new NODE;
-  node->crc = crc;
-  node->data = data;
-  node->tmu = tmu;
-  node->number = number;
-  node->pNext = *list;
-  *list = node;
+  uint32_t i = CacheSlot(cache->crc, cache->width, cache->height, cache->flags);
+  while (cachelut[i].generation == cache_generation)
+    i = (i + 1) & (CACHE_SLOTS - 1);
+
+  CACHE_SLOT *slot = &cachelut[i];
+  slot->generation = cache_generation;
+  slot->crc = cache->crc;
+  slot->width = cache->width;
+  slot->height = cache->height;
+  slot->flags = cache->flags;
+  slot->tmu = tmu;
+  slot->number = number;
+  slot->cache = cache;
   rdp.n_cached[tmu] ++;
   if (voodoo.tex_UMA)
     rdp.n_cached[tmu^1] = rdp.n_cached[tmu];
 }
 
-void DeleteList (NODE **list)
+#ifdef TEXTURE_FILTER
+// Texture memory of placeholders dropped for their enhanced copy. The
+// next textures that fit are put there instead of at tmem_ptr. Memory at
+// the end of what is in use goes straight back to tmem_ptr. If the list
+// is full, the smallest range is forgotten until ClearCache.
+#define MAX_FREED 32
+
+typedef struct TMEM_RANGE_t {
+  uint32_t addr;
+  uint32_t size;
+} TMEM_RANGE;
+
+static TMEM_RANGE tmem_freed[MAX_TMU][MAX_FREED];
+static int n_freed[MAX_TMU];
+
+static void FreeTexMem (int tmu, uint32_t addr, uint32_t size)
 {
-  while (*list)
+  if (voodoo.tex_UMA)
+    tmu = 0;
+  if (size == 0)
+    return;
+
+  if (addr + size == voodoo.tmem_ptr[tmu])
   {
-    NODE *next = (*list)->pNext;
-    delete (*list);
-    *list = next;
+    voodoo.tmem_ptr[tmu] = addr;
+    // which may bring a freed range to the end as well
+    for (int i = 0; i < n_freed[tmu]; i++)
+    {
+      TMEM_RANGE *range = &tmem_freed[tmu][i];
+      if (range->addr + range->size == voodoo.tmem_ptr[tmu])
+      {
+        voodoo.tmem_ptr[tmu] = range->addr;
+        *range = tmem_freed[tmu][--n_freed[tmu]];
+        i = -1;
+      }
+    }
+    if (voodoo.tex_UMA)
+      voodoo.tmem_ptr[1] = voodoo.tmem_ptr[0];
+    return;
   }
+
+  int n = n_freed[tmu];
+  if (n == MAX_FREED)
+  {
+    int smallest = 0;
+    for (int i = 1; i < MAX_FREED; i++)
+      if (tmem_freed[tmu][i].size < tmem_freed[tmu][smallest].size)
+        smallest = i;
+    if (tmem_freed[tmu][smallest].size >= size)
+      return;
+    n = smallest;
+  }
+  else
+    n_freed[tmu]++;
+  tmem_freed[tmu][n].addr = addr;
+  tmem_freed[tmu][n].size = size;
 }
 
-void TexCacheInit ()
+// Takes size bytes from the first freed range they fit in
+static int ReuseTexMem (int tmu, uint32_t size, uint32_t *addr)
 {
-  for (int i=0; i<65536; i++)
+  if (voodoo.tex_UMA)
+    tmu = 0;
+
+  for (int i = 0; i < n_freed[tmu]; i++)
   {
-    cachelut[i] = NULL;
+    TMEM_RANGE *range = &tmem_freed[tmu][i];
+    if (range->size < size)
+      continue;
+
+    *addr = range->addr;
+    range->addr += size;
+    range->size -= size;
+    if (range->size == 0)
+      *range = tmem_freed[tmu][--n_freed[tmu]];
+    return TRUE;
   }
+  return FALSE;
+}
+#endif
+
+void TexCacheInit ()
+{
+  memset(cachelut, 0, sizeof(cachelut));
+  cache_generation = 1;
 }
 
 //****************************************************************
@@ -141,11 +238,12 @@ void ClearCache ()
   rdp.n_cached[0] = 0;
   voodoo.tmem_ptr[1] = voodoo.tex_UMA ? offset_textures : offset_texbuf1;
   rdp.n_cached[1] = 0;
+#ifdef TEXTURE_FILTER
+  n_freed[0] = n_freed[1] = 0;
+#endif
 
-  for (int i=0; i<65536; i++)
-  {
-    DeleteList (&cachelut[i]);
-  }
+  if (++cache_generation == 0)
+    TexCacheInit ();
 }
 
 //****************************************************************
@@ -458,38 +556,55 @@ static void GetTexInfo (int id, int tile)
     modfactor = cmb.modfactor_1;
   }
 
-  NODE *node = cachelut[crc>>16];
+  // Slots holding the same texture are probed oldest first. With separate
+  // tmus the oldest copy in each one is used, with UMA the newest.
   uint32_t mod_mask = (rdp.tiles[tile].format == 2)?0xFFFFFFFF:0xF0F0F0F0;
-  while (node)
+  uint32_t cache_width = rdp.tiles[tile].width;
+  uint32_t cache_height = rdp.tiles[tile].height;
+  CACHE_SLOT *found = NULL;
+  for (uint32_t i = CacheSlot(crc, cache_width, cache_height, flags);
+       cachelut[i].generation == cache_generation;
+       i = (i + 1) & (CACHE_SLOTS - 1))
   {
-    if (node->crc == crc)
+    CACHE_SLOT *slot = &cachelut[i];
+    if (!slot->cache || slot->crc != crc || slot->width != cache_width ||
+        slot->height != cache_height || slot->flags != flags)
+      continue;
+
+    cache = slot->cache;
+#ifdef TEXTURE_FILTER
+    // The enhanced copy of a placeholder is ready. Drop the placeholder
+    // from the table and give back its texture memory, so the texture is
+    // loaded again. Not while T0 of this same draw is using it.
+    if (cache->ghq_pending && !(id == 1 && (rdp.tex & 1) && tex_found[0][slot->tmu] == slot->number) &&
+        !ext_ghq_txfilter_pending((uint64)cache->g64_crc))
     {
-      cache = (CACHE_LUT*)node->data;
-      if (/*tex_found[id][node->tmu] == -1 &&
-          rdp.tiles[tile].palette == cache->palette &&
-          rdp.tiles[tile].format == cache->format &&
-          rdp.tiles[tile].size == cache->size &&*/
-          rdp.tiles[tile].width == cache->width &&
-          rdp.tiles[tile].height == cache->height &&
-          flags == cache->flags)
-      {
-        if (!(mod+cache->mod) || (cache->mod == mod &&
-          (cache->mod_color&mod_mask) == (modcolor&mod_mask) &&
-          (cache->mod_color1&mod_mask) == (modcolor1&mod_mask) &&
-          (cache->mod_color2&mod_mask) == (modcolor2&mod_mask) &&
-          abs((int)(cache->mod_factor - modfactor)) < 8))
-        {
-          FRDP (" | | | |- Texture found in cache (tmu=%d).\n", node->tmu);
-          tex_found[id][node->tmu] = node->number;
-          if (voodoo.tex_UMA)
-          {
-            tex_found[id][node->tmu^1] = node->number;
-            return;
-          }
-        }
-      }
+      cache->ghq_pending = FALSE;
+      FreeTexMem (slot->tmu, cache->tmem_addr, cache->tmem_size);
+      cache->tmem_size = 0;
+      slot->cache = NULL;
+      continue;
+    }
+#endif
+    if (!(mod+cache->mod) || (cache->mod == mod &&
+      (cache->mod_color&mod_mask) == (modcolor&mod_mask) &&
+      (cache->mod_color1&mod_mask) == (modcolor1&mod_mask) &&
+      (cache->mod_color2&mod_mask) == (modcolor2&mod_mask) &&
+      abs((int)(cache->mod_factor - modfactor)) < 8))
+    {
+      FRDP (" | | | |- Texture found in cache (tmu=%d).\n", slot->tmu);
+      if (voodoo.tex_UMA)
+        found = slot;
+      else if (tex_found[id][slot->tmu] == -1)
+        tex_found[id][slot->tmu] = slot->number;
     }
-    node = node->pNext;
+  }
+
+  if (found)
+  {
+    tex_found[id][found->tmu] = found->number;
+    tex_found[id][found->tmu^1] = found->number;
+    return;
   }
 
   LRDP(" | | | +- Done.\n | | +- GetTexInfo end\n");
@@ -1078,10 +1193,13 @@ static void LoadTex (int id, int tmu)
 #ifdef TEXTURE_FILTER
   cache->is_hires_tex = FALSE;
   cache->ricecrc    = texinfo[id].ricecrc;
+  cache->ghq_pending = FALSE;
+  cache->g64_crc    = 0;
+  cache->tmem_size  = 0;
 #endif
 
   // Add this cache to the list
-  AddToList (&cachelut[cache->crc>>16], cache->crc, (uintptr_t)(cache), tmu, rdp.n_cached[tmu]);
+  AddToList (cache, tmu, rdp.n_cached[tmu]);
 
   // temporary
   cache->t_info.format = GR_TEXFMT_ARGB_1555;
@@ -1681,7 +1799,14 @@ static void LoadTex (int id, int tmu)
 
         if (!ghqTexInfo.data)
           if (!settings.ghq_enht_nobg || !rdp.texrecting || (texinfo[id].splits == 1 && texinfo[id].width <= 256))
+          {
             ext_ghq_txfilter((uint8_t*)texture, (int)real_x, (int)real_y, LOWORD(result), (uint64)g64_crc, &ghqTexInfo);
+            if (!ghqTexInfo.data && settings.ghq_enht_async)
+            {
+              cache->ghq_pending = ext_ghq_txfilter_pending((uint64)g64_crc);
+              cache->g64_crc = g64_crc;
+            }
+          }
 
         if (ghqTexInfo.data)
         {
@@ -1824,10 +1949,18 @@ static void LoadTex (int id, int tmu)
 
       uint32_t texture_size = grTexTextureMemRequired (GR_MIPMAPLEVELMASK_BOTH, t_info);
 
+#ifdef TEXTURE_FILTER
+      // Use the room of a dropped placeholder if the texture fits there
+      int reused = ReuseTexMem (tmu, texture_size, &cache->tmem_addr);
+      cache->tmem_size = texture_size;
+#else
+      int reused = FALSE;
+#endif
+
 #ifdef HAVE_GLIDE_2MB_TEX_BOUNDARY
       // Check for 2mb boundary
       // Hiroshi Morii <koolsmoky@users.sourceforge.net> required only for V1,Rush, and V2
-      if (voodoo.has_2mb_tex_boundary &&
+      if (!reused && voodoo.has_2mb_tex_boundary &&
         (voodoo.tmem_ptr[tmu] < TEXMEM_2MB_EDGE) && (voodoo.tmem_ptr[tmu]+texture_size > TEXMEM_2MB_EDGE))
       {
         voodoo.tmem_ptr[tmu] = TEXMEM_2MB_EDGE;
@@ -1836,7 +1969,7 @@ static void LoadTex (int id, int tmu)
 #endif
 
       // Check for end of memory (too many textures to fit, clear cache)
-      if (voodoo.tmem_ptr[tmu]+texture_size >= voodoo.tex_max_addr[tmu])
+      if (!reused && voodoo.tmem_ptr[tmu]+texture_size >= voodoo.tex_max_addr[tmu])
       {
         LRDP("Cache size reached, clearing...\n");
         ClearCache ();
@@ -1849,7 +1982,7 @@ static void LoadTex (int id, int tmu)
         // DON'T CONTINUE (already done)
       }
 
-      uint32_t tex_addr = GetTexAddr(tmu, texture_size);
+      uint32_t tex_addr = reused ? voodoo.tex_min_addr[tmu] + cache->tmem_addr : GetTexAddr(tmu, texture_size);
       grTexDownloadMipMap (tmu,
         tex_addr,
         GR_MIPMAPLEVELMASK_BOTH,
@@ -306,6 +306,7 @@ typedef struct {
   int ghq_enht_f16bpp;
   int ghq_enht_gz;
   int ghq_enht_nobg;
+  int ghq_enht_async;
   int ghq_hirs_cmpr;
   int ghq_hirs_tile;
   int ghq_hirs_f16bpp;
@@ -527,6 +528,9 @@ typedef struct {
 #ifdef TEXTURE_FILTER
   uint64 ricecrc;
   int is_hires_tex;
+  int ghq_pending;  // uploaded as is, enhanced copy still being made
+  uint32_t g64_crc;
+  uint32_t tmem_size;  // bytes taken at tmem_addr, given back when dropped
 #endif
 } CACHE_LUT;
 
@@ -45,6 +45,10 @@ boolean txfilter_dmptx(unsigned char *src, int width, int height, int rowStrideP
 
 boolean txfilter_reloadhirestex();
 
+boolean txfilter_pending(uint64 g64crc);
+
+void txfilter_collect();
+
 }
 
 void ext_ghq_shutdown(void)
@@ -109,3 +113,17 @@ boolean ext_ghq_reloadhirestex()
 
   return ret;
 }
+
+boolean ext_ghq_txfilter_pending(uint64 g64crc)
+{
+  boolean ret = 0;
+
+  ret = txfilter_pending(g64crc);
+
+  return ret;
+}
+
+void ext_ghq_txfilter_collect()
+{
+  txfilter_collect();
+}
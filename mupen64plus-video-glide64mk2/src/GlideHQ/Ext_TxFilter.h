@@ -98,7 +98,7 @@ typedef unsigned char boolean;
 #define DUMP_TEXCACHE       0x01000000
 #define DUMP_HIRESTEXCACHE  0x02000000
 #define TILE_HIRESTEX       0x04000000
-#define UNDEFINED_0         0x08000000
+#define ASYNC_TEX           0x08000000
 #define FORCE16BPP_HIRESTEX 0x10000000
 #define FORCE16BPP_TEX      0x20000000
 #define LET_TEXARTISTS_FLY  0x40000000 /* a little freedom for texture artists */
@@ -211,6 +211,10 @@ boolean ext_ghq_dmptx(unsigned char *src,   /* input texture (must be in 3Dfx Gl
                       );
 
 boolean ext_ghq_reloadhirestex();
+
+boolean ext_ghq_txfilter_pending(uint64 g64crc); /* glide64 crc */
+
+void ext_ghq_txfilter_collect(); /* once a frame, finishes background enhancement */
 #endif /* TXFILTER_DLL */
 
 #endif /* __EXT_TXFILTER_H__ */
@@ -26,7 +26,17 @@
 #endif
 
 #include <boost/filesystem.hpp>
+#include <algorithm>
+#include <vector>
 #include <zlib.h>
+#ifdef BOOST_WINDOWS_API
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "TxCache.h"
 #include "TxDbg.h"
 #include "../Glide64/m64p.h"
@@ -51,6 +61,17 @@ TxCache::TxCache(int options, int cachesize, const wchar_t *datapath,
   _callback = callback;
   _totalSize = 0;
 
+  _lruHead = NULL;
+  _lruTail = NULL;
+  _hits = 0;
+  _misses = 0;
+  _evictions = 0;
+
+  _map = NULL;
+  _mapSize = 0;
+  _mapIndex = NULL;
+  _mapCount = 0;
+
   /* save path name */
   if (datapath)
     _datapath.assign(datapath);
@@ -84,6 +105,9 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 
   if (!checksum || !info->data) return 0;
 
+  /* the first texture added under a checksum stays */
+  if (_cache.find(checksum) != _cache.end()) return 1;
+
   uint8 *dest = info->data;
   uint16 format = info->format;
 
@@ -107,34 +131,14 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
     }
   }
 
-  /* if cache size exceeds limit, remove old cache */
+  /* keep within the cache size, least recently used textures go first */
   if (_cacheSize > 0) {
-    _totalSize += dataSize;
-    if ((_totalSize > _cacheSize) && !_cachelist.empty()) {
-      /* _cachelist is arranged so that frequently used textures are in the back */
-      std::list<uint64>::iterator itList = _cachelist.begin();
-      while (itList != _cachelist.end()) {
-        /* find it in _cache */
-        std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(*itList);
-        if (itMap != _cache.end()) {
-          /* yep we have it. remove it. */
-          _totalSize -= (*itMap).second->size;
-          free((*itMap).second->info.data);
-          delete (*itMap).second;
-          _cache.erase(itMap);
-        }
-        itList++;
-
-        /* check if memory cache has enough space */
-        if (_totalSize <= _cacheSize)
-          break;
-      }
-      /* remove from _cachelist */
-      _cachelist.erase(_cachelist.begin(), itList);
+    if (dataSize > _cacheSize) return 0;
 
-      DBG_INFO(80, L"+++++++++\n");
+    while (_lruHead && _totalSize + dataSize > _cacheSize) {
+      erase(_lruHead);
+      _evictions++;
     }
-    _totalSize -= dataSize;
   }
 
   /* cache it */
@@ -152,14 +156,12 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
       txCache->info.data = tmpdata;
       txCache->info.format = format;
       txCache->size = dataSize;
+      txCache->checksum = checksum;
 
       /* add to cache */
-      if (_cacheSize > 0) {
-        _cachelist.push_back(checksum);
-        txCache->it = --(_cachelist.end());
-      }
-      /* _cache[checksum] = txCache; */
-      _cache.insert(std::map<uint64, TXCACHE*>::value_type(checksum, txCache));
+      _cache.insert(std::make_pair(checksum, txCache));
+      if (_cacheSize > 0)
+        link(txCache);
 
 #ifdef DEBUG
       DBG_INFO(80, L"[%5d] added!! crc:%08X %08X %d x %d gfmt:%x total:%.02fmb\n",
@@ -174,11 +176,7 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
       }
 
       if (_cacheSize > 0) {
-        DBG_INFO(80, L"cache max config:%.02fmb\n", (float)_cacheSize/1000000);
-
-        if (_cache.size() != _cachelist.size()) {
-          DBG_INFO(80, L"Error: cache/cachelist mismatch! (%d/%d)\n", _cache.size(), _cachelist.size());
-        }
+        DBG_INFO(80, L"cache max config:%.02fmb evicted:%d\n", (float)_cacheSize/1000000, _evictions);
       }
 #endif
 
@@ -196,38 +194,67 @@ TxCache::add(uint64 checksum, GHQTexInfo *info, int dataSize)
 boolean
 TxCache::get(uint64 checksum, GHQTexInfo *info)
 {
-  if (!checksum || _cache.empty()) return 0;
+  if (!checksum) return 0;
+
+  if (_cache.empty() && !_mapCount) {
+    _misses++;
+    return 0;
+  }
+
+  uint32 dataSize;
 
   /* find a match in cache */
-  std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
+  std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
   if (itMap != _cache.end()) {
     /* yep, we've got it. */
-    memcpy(info, &(((*itMap).second)->info), sizeof(GHQTexInfo));
-
-    /* push it to the back of the list */
-    if (_cacheSize > 0) {
-      _cachelist.erase(((*itMap).second)->it);
-      _cachelist.push_back(checksum);
-      ((*itMap).second)->it = --(_cachelist.end());
+    TXCACHE *txCache = (*itMap).second;
+    memcpy(info, &txCache->info, sizeof(GHQTexInfo));
+    dataSize = txCache->size;
+
+    /* move it to the most recently used end */
+    if (_cacheSize > 0 && txCache != _lruTail) {
+      unlink(txCache);
+      link(txCache);
     }
-
-    /* zlib decompress it */
-    if (info->format & GR_TEXFMT_GZ) {
-      uLongf destLen = _gzdestLen;
-      uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
-      if (uncompress(dest, &destLen, info->data, ((*itMap).second)->size) != Z_OK) {
-        DBG_INFO(80, L"Error: zlib decompression failed!\n");
-        return 0;
-      }
-      info->data = dest;
-      info->format &= ~GR_TEXFMT_GZ;
-      DBG_INFO(80, L"zlib decompressed: %.02fkb->%.02fkb\n", (float)(((*itMap).second)->size)/1000, (float)destLen/1000);
+  } else {
+    /* then in the cache file */
+    const TXFILEENTRY *entry = find(checksum);
+    if (!entry) {
+      _misses++;
+      return 0;
     }
 
-    return 1;
+    memset(info, 0, sizeof(GHQTexInfo));
+    info->data = _map + entry->offset;
+    info->width = entry->width;
+    info->height = entry->height;
+    info->format = entry->format;
+    info->smallLodLog2 = entry->smallLodLog2;
+    info->largeLodLog2 = entry->largeLodLog2;
+    info->aspectRatioLog2 = entry->aspectRatioLog2;
+    info->tiles = entry->tiles;
+    info->untiled_width = entry->untiled_width;
+    info->untiled_height = entry->untiled_height;
+    info->is_hires_tex = entry->is_hires_tex;
+    dataSize = entry->size;
   }
 
-  return 0;
+  _hits++;
+
+  /* zlib decompress it */
+  if (info->format & GR_TEXFMT_GZ) {
+    uLongf destLen = _gzdestLen;
+    uint8 *dest = (_gzdest0 == info->data) ? _gzdest1 : _gzdest0;
+    if (uncompress(dest, &destLen, info->data, dataSize) != Z_OK) {
+      DBG_INFO(80, L"Error: zlib decompression failed!\n");
+      return 0;
+    }
+    info->data = dest;
+    info->format &= ~GR_TEXFMT_GZ;
+    DBG_INFO(80, L"zlib decompressed: %.02fkb->%.02fkb\n", (float)dataSize/1000, (float)destLen/1000);
+  }
+
+  return 1;
 }
 
 boolean
@@ -256,65 +283,101 @@ TxCache::save(const wchar_t *path, const wchar_t *filename, int config)
 
     wcstombs(cbuf, filename, MAX_PATH);
 
-    gzFile gzfp = gzopen(cbuf, "wb1");
-    DBG_INFO(80, L"gzfp:%x file:%ls\n", gzfp, filename);
-    if (gzfp) {
-      /* write header to determine config match */
-      gzwrite(gzfp, &config, 4);
-
-      std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
-      while (itMap != _cache.end()) {
-        uint8 *dest    = (*itMap).second->info.data;
-        uint32 destLen = (*itMap).second->size;
-        uint16 format  = (*itMap).second->info.format;
-
-        /* to keep things simple, we save the texture data in a zlib uncompressed state. */
-        /* sigh... for those who cannot wait the extra few seconds. changed to keep
-         * texture data in a zlib compressed state. if the GZ_TEXCACHE or GZ_HIRESTEXCACHE
-         * option is toggled, the cache will need to be rebuilt.
-         */
-        /*if (format & GR_TEXFMT_GZ) {
-          dest = _gzdest0;
-          destLen = _gzdestLen;
-          if (dest && destLen) {
-            if (uncompress(dest, &destLen, (*itMap).second->info.data, (*itMap).second->size) != Z_OK) {
-              dest = NULL;
-              destLen = 0;
-            }
-            format &= ~GR_TEXFMT_GZ;
-          }
-        }*/
-
-        if (dest && destLen) {
-          /* texture checksum */
-          gzwrite(gzfp, &((*itMap).first), 8);
-
-          /* other texture info */
-          gzwrite(gzfp, &((*itMap).second->info.width), 4);
-          gzwrite(gzfp, &((*itMap).second->info.height), 4);
-          gzwrite(gzfp, &format, 2);
-
-          gzwrite(gzfp, &((*itMap).second->info.smallLodLog2), 4);
-          gzwrite(gzfp, &((*itMap).second->info.largeLodLog2), 4);
-          gzwrite(gzfp, &((*itMap).second->info.aspectRatioLog2), 4);
-
-          gzwrite(gzfp, &((*itMap).second->info.tiles), 4);
-          gzwrite(gzfp, &((*itMap).second->info.untiled_width), 4);
-          gzwrite(gzfp, &((*itMap).second->info.untiled_height), 4);
-
-          gzwrite(gzfp, &((*itMap).second->info.is_hires_tex), 1);
-
-          gzwrite(gzfp, &destLen, 4);
-          gzwrite(gzfp, dest, destLen);
-        }
-
+    /* entries from memory and from the mapped file, sorted by checksum.
+     * texture data is saved as it is kept, zlib compressed if GZ_TEXCACHE
+     * or GZ_HIRESTEXCACHE is on, so toggling those needs a new cache. */
+    std::vector<std::pair<uint64, TXCACHE*> > sorted(_cache.begin(), _cache.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<uint64, TXCACHE*> &a, const std::pair<uint64, TXCACHE*> &b) {
+                return a.first < b.first;
+              });
+
+    std::vector<TXFILEENTRY> index;
+    std::vector<const uint8*> data;
+    std::vector<std::pair<uint64, TXCACHE*> >::iterator itMap = sorted.begin();
+    uint32 i = 0;
+    while (itMap != sorted.end() || i < _mapCount) {
+      TXFILEENTRY entry;
+      memset(&entry, 0, sizeof(TXFILEENTRY));
+
+      if (i < _mapCount &&
+          (itMap == sorted.end() || _mapIndex[i].checksum < (*itMap).first)) {
+        entry = _mapIndex[i];
+        data.push_back(_map + entry.offset);
+        i++;
+      } else {
+        /* memory wins over the file */
+        if (i < _mapCount && _mapIndex[i].checksum == (*itMap).first)
+          i++;
+
+        GHQTexInfo *info = &(*itMap).second->info;
+        entry.checksum = (*itMap).first;
+        entry.size = (*itMap).second->size;
+        entry.width = info->width;
+        entry.height = info->height;
+        entry.format = info->format;
+        entry.smallLodLog2 = info->smallLodLog2;
+        entry.largeLodLog2 = info->largeLodLog2;
+        entry.aspectRatioLog2 = info->aspectRatioLog2;
+        entry.tiles = info->tiles;
+        entry.untiled_width = info->untiled_width;
+        entry.untiled_height = info->untiled_height;
+        entry.is_hires_tex = info->is_hires_tex;
+        data.push_back(info->data);
         itMap++;
+      }
+
+      if (data.back() && entry.size)
+        index.push_back(entry);
+      else
+        data.pop_back();
+    }
+
+    /* texture data follows the index, 8 byte aligned */
+    TXFILEHEADER header;
+    memset(&header, 0, sizeof(TXFILEHEADER));
+    memcpy(header.magic, TXCACHE_MAGIC, sizeof(header.magic));
+    header.version = TXCACHE_VERSION;
+    header.config = config;
+    header.count = index.size();
+
+    uint64 offset = sizeof(TXFILEHEADER) + sizeof(TXFILEENTRY) * index.size();
+    for (i = 0; i < index.size(); i++) {
+      index[i].offset = offset;
+      offset += (index[i].size + 7) & ~7;
+    }
 
-        /* not ready yet */
-        /*if (_callback)
-          (*_callback)(L"Total textures saved to HDD: %d\n", std::distance(itMap, _cache.begin()));*/
+    /* the old file may still be mapped, so write a new one and swap */
+    std::string tmpname = std::string(cbuf) + ".tmp";
+    FILE *fp = fopen(tmpname.c_str(), "wb");
+    DBG_INFO(80, L"fp:%x file:%ls\n", fp, filename);
+    if (fp) {
+      static const uint8 pad[8] = { 0 };
+      boolean ok = (fwrite(&header, sizeof(TXFILEHEADER), 1, fp) == 1);
+      if (ok && !index.empty())
+        ok = (fwrite(&index[0], sizeof(TXFILEENTRY), index.size(), fp) == index.size());
+      for (i = 0; ok && i < index.size(); i++) {
+        ok = (fwrite(data[i], 1, index[i].size, fp) == index[i].size);
+        if (ok && (index[i].size & 7))
+          ok = (fwrite(pad, 1, 8 - (index[i].size & 7), fp) == 8 - (index[i].size & 7));
+      }
+      if (fclose(fp) != 0)
+        ok = 0;
+
+      /* the old file stays, mapped, unless the new one is complete.
+       * Windows will neither replace a file by renaming nor remove a
+       * mapped one. */
+      if (ok) {
+        unmap();
+        if (rename(tmpname.c_str(), cbuf) != 0) {
+          remove(cbuf);
+          ok = (rename(tmpname.c_str(), cbuf) == 0);
+        }
+      }
+      if (!ok) {
+        ERRLOG("Error while writing texture cache '%s'!", cbuf);
+        remove(tmpname.c_str());
       }
-      gzclose(gzfp);
     }
 
     if (CHDIR(curpath) != 0)
@@ -347,18 +410,24 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
 
   wcstombs(cbuf, filename, MAX_PATH);
 
-  gzFile gzfp = gzopen(cbuf, "rb");
+  /* indexed cache files are mapped, older ones are read into memory */
+  int tmpconfig;
+  int mapped = map(cbuf, &tmpconfig);
+  gzFile gzfp = mapped ? NULL : gzopen(cbuf, "rb");
   DBG_INFO(80, L"gzfp:%x file:%ls\n", gzfp, filename);
-  if (gzfp) {
+  if (mapped > 0 || gzfp) {
     /* yep, we have it. load it into memory cache. */
     int dataSize;
     uint64 checksum;
     GHQTexInfo tmpInfo;
-    int tmpconfig;
     /* read header to determine config match */
-    gzread(gzfp, &tmpconfig, 4);
+    if (gzfp)
+      gzread(gzfp, &tmpconfig, 4);
 
-    if (tmpconfig == config) {
+    if (tmpconfig == config && mapped > 0) {
+      if (_callback)
+        (*_callback)(L"[%d] mapped:%.02fmb - %ls\n", _mapCount, (float)_mapSize/1000000, filename);
+    } else if (tmpconfig == config) {
       do {
         memset(&tmpInfo, 0, sizeof(GHQTexInfo));
 
@@ -399,6 +468,11 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
       } while (!gzeof(gzfp));
       gzclose(gzfp);
     } else {
+      if (mapped > 0)
+        unmap();
+      else
+        gzclose(gzfp);
+
       if ((tmpconfig & HIRESTEXTURES_MASK) != (config & HIRESTEXTURES_MASK)) {
         const char *conf_str;
         if ((tmpconfig & HIRESTEXTURES_MASK) == NO_HIRESTEXTURES)
@@ -488,7 +562,109 @@ TxCache::load(const wchar_t *path, const wchar_t *filename, int config)
   if (CHDIR(curpath) != 0)
       ERRLOG("Error while changing current directory back to original path of '%s'!", curpath);
 
-  return !_cache.empty();
+  return !_cache.empty() || _mapCount;
+}
+
+int
+TxCache::map(const char *filename, int *config)
+{
+  unmap();
+
+  uint8 *data = NULL;
+  size_t size = 0;
+
+#ifdef BOOST_WINDOWS_API
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return 0;
+  LARGE_INTEGER len;
+  if (GetFileSizeEx(file, &len) && len.QuadPart >= (LONGLONG)sizeof(TXFILEHEADER)) {
+    /* the view keeps the file open */
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+      data = (uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      size = (size_t)len.QuadPart;
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return 0;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(TXFILEHEADER)) {
+    /* the mapping keeps the file open */
+    data = (uint8*)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == (uint8*)MAP_FAILED)
+      data = NULL;
+    size = st.st_size;
+  }
+  close(fd);
+#endif
+
+  if (!data)
+    return 0;
+
+  _map = data;
+  _mapSize = size;
+
+  const TXFILEHEADER *header = (const TXFILEHEADER*)_map;
+  if (memcmp(header->magic, TXCACHE_MAGIC, sizeof(header->magic)) != 0) {
+    unmap();
+    return 0;
+  }
+  *config = header->config;
+
+  /* check the index once, so get() can trust it */
+  boolean ok = (header->version == TXCACHE_VERSION &&
+                header->count <= (_mapSize - sizeof(TXFILEHEADER)) / sizeof(TXFILEENTRY));
+  const TXFILEENTRY *index = (const TXFILEENTRY*)(_map + sizeof(TXFILEHEADER));
+  uint32 i;
+  for (i = 0; ok && i < header->count; i++) {
+    ok = (index[i].offset <= _mapSize && index[i].size <= _mapSize - index[i].offset &&
+          (i == 0 || index[i - 1].checksum < index[i].checksum));
+  }
+  if (!ok) {
+    ERRLOG("Ignored broken texture cache '%s'!", filename);
+    unmap();
+    return -1;
+  }
+
+  _mapIndex = index;
+  _mapCount = header->count;
+
+  return 1;
+}
+
+void
+TxCache::unmap()
+{
+  if (_map) {
+#ifdef BOOST_WINDOWS_API
+    UnmapViewOfFile(_map);
+#else
+    munmap(_map, _mapSize);
+#endif
+  }
+  _map = NULL;
+  _mapSize = 0;
+  _mapIndex = NULL;
+  _mapCount = 0;
+}
+
+const TxCache::TXFILEENTRY*
+TxCache::find(uint64 checksum)
+{
+  if (!_mapCount)
+    return NULL;
+
+  const TXFILEENTRY *entry = std::lower_bound(_mapIndex, _mapIndex + _mapCount, checksum,
+    [](const TXFILEENTRY &e, uint64 c) { return e.checksum < c; });
+  if (entry == _mapIndex + _mapCount || entry->checksum != checksum)
+    return NULL;
+
+  return entry;
 }
 
 boolean
@@ -496,17 +672,9 @@ TxCache::del(uint64 checksum)
 {
   if (!checksum || _cache.empty()) return 0;
 
-  std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
+  std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
   if (itMap != _cache.end()) {
-
-    /* for texture cache (not hi-res cache) */
-    if (!_cachelist.empty()) _cachelist.erase(((*itMap).second)->it);
-
-    /* remove from cache */
-    free((*itMap).second->info.data);
-    _totalSize -= (*itMap).second->size;
-    delete (*itMap).second;
-    _cache.erase(itMap);
+    erase((*itMap).second);
 
     DBG_INFO(80, L"removed from cache: checksum = %08X %08X\n", (uint32)(checksum & 0xffffffff), (uint32)(checksum >> 32));
 
@@ -519,8 +687,9 @@ TxCache::del(uint64 checksum)
 boolean
 TxCache::is_cached(uint64 checksum)
 {
-  std::map<uint64, TXCACHE*>::iterator itMap = _cache.find(checksum);
-  if (itMap != _cache.end()) return 1;
+  if (_cache.find(checksum) != _cache.end()) return 1;
+
+  if (find(checksum)) return 1;
 
   return 0;
 }
@@ -529,7 +698,7 @@ void
 TxCache::clear()
 {
   if (!_cache.empty()) {
-    std::map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
+    std::unordered_map<uint64, TXCACHE*>::iterator itMap = _cache.begin();
     while (itMap != _cache.end()) {
       free((*itMap).second->info.data);
       delete (*itMap).second;
@@ -538,7 +707,59 @@ TxCache::clear()
     _cache.clear();
   }
 
-  if (!_cachelist.empty()) _cachelist.clear();
+  _lruHead = NULL;
+  _lruTail = NULL;
 
   _totalSize = 0;
+
+  unmap();
+}
+
+void
+TxCache::link(TXCACHE *txCache)
+{
+  txCache->prev = _lruTail;
+  txCache->next = NULL;
+  if (_lruTail)
+    _lruTail->next = txCache;
+  else
+    _lruHead = txCache;
+  _lruTail = txCache;
+}
+
+void
+TxCache::unlink(TXCACHE *txCache)
+{
+  if (txCache->prev)
+    txCache->prev->next = txCache->next;
+  else
+    _lruHead = txCache->next;
+  if (txCache->next)
+    txCache->next->prev = txCache->prev;
+  else
+    _lruTail = txCache->prev;
+}
+
+void
+TxCache::erase(TXCACHE *txCache)
+{
+  /* only the texture cache (not hi-res cache) keeps the recency list */
+  if (_cacheSize > 0)
+    unlink(txCache);
+
+  _totalSize -= txCache->size;
+  _cache.erase(txCache->checksum);
+  free(txCache->info.data);
+  delete txCache;
+}
+
+void
+TxCache::stats(TXCACHESTATS *stats)
+{
+  stats->hits = _hits;
+  stats->misses = _misses;
+  stats->evictions = _evictions;
+  stats->count = _cache.size();
+  stats->totalSize = _totalSize;
+  stats->cacheSize = _cacheSize;
 }
@@ -26,17 +26,50 @@
 
 #include "TxInternal.h"
 #include "TxUtil.h"
-#include <list>
-#include <map>
 #include <string>
+#include <unordered_map>
+
+/* cache files are a header, an index sorted by checksum and the texture
+ * data. load() maps them and get() reads textures straight from the map. */
+#define TXCACHE_MAGIC   "GHQINDEX"
+#define TXCACHE_VERSION 1
 
 class TxCache
 {
 private:
-  std::list<uint64> _cachelist;
   uint8 *_gzdest0;
   uint8 *_gzdest1;
   uint32 _gzdestLen;
+  struct TXFILEHEADER {
+    char magic[8];
+    uint32 version;
+    int config;
+    uint32 count;
+    uint32 reserved[3];
+  };
+  struct TXFILEENTRY {
+    uint64 checksum;
+    uint64 offset;
+    uint32 size;
+    int width;
+    int height;
+    int smallLodLog2;
+    int largeLodLog2;
+    int aspectRatioLog2;
+    int tiles;
+    int untiled_width;
+    int untiled_height;
+    uint16 format;
+    uint8 is_hires_tex;
+    uint8 reserved;
+  };
+  uint8 *_map;
+  size_t _mapSize;
+  const TXFILEENTRY *_mapIndex;
+  /* 1 when mapped, 0 when not an indexed cache file, -1 when a broken one */
+  int map(const char *filename, int *config);
+  void unmap();
+  const TXFILEENTRY *find(uint64 checksum);
 protected:
   int _options;
   std::wstring _ident;
@@ -47,17 +80,37 @@ protected:
   struct TXCACHE {
     int size;
     GHQTexInfo info;
-    std::list<uint64>::iterator it;
+    uint64 checksum;
+    TXCACHE *prev; /* recency list, only linked when _cacheSize is set */
+    TXCACHE *next;
   };
   int _totalSize;
   int _cacheSize;
-  std::map<uint64, TXCACHE*> _cache;
+  std::unordered_map<uint64, TXCACHE*> _cache;
+  uint32 _mapCount; /* textures in the mapped cache file, not in _totalSize */
   boolean save(const wchar_t *path, const wchar_t *filename, const int config);
   boolean load(const wchar_t *path, const wchar_t *filename, const int config);
   boolean del(uint64 checksum); /* checksum hi:palette low:texture */
   boolean is_cached(uint64 checksum); /* checksum hi:palette low:texture */
   void clear();
+private:
+  TXCACHE *_lruHead; /* least recently used */
+  TXCACHE *_lruTail; /* most recently used */
+  uint32 _hits;
+  uint32 _misses;
+  uint32 _evictions;
+  void link(TXCACHE *txCache);
+  void unlink(TXCACHE *txCache);
+  void erase(TXCACHE *txCache);
 public:
+  struct TXCACHESTATS {
+    uint32 hits;      /* get() from memory or the mapped cache file */
+    uint32 misses;
+    uint32 evictions; /* textures dropped to stay within the cache size */
+    uint32 count;     /* textures in memory */
+    int totalSize;
+    int cacheSize;
+  };
   ~TxCache();
   TxCache(int options, int cachesize, const wchar_t *datapath,
               const wchar_t *cachepath, const wchar_t *ident,
@@ -66,6 +119,7 @@ public:
               GHQTexInfo *info, int dataSize = 0);
   boolean get(uint64 checksum, /* checksum hi:palette low:texture */
               GHQTexInfo *info);
+  void stats(TXCACHESTATS *stats);
 };
 
 #endif /* __TXCACHE_H__ */
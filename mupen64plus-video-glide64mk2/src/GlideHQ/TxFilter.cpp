@@ -28,16 +28,17 @@
 #include "TxFilter.h"
 #include "TextureFilters.h"
 #include "TxDbg.h"
-#ifndef NO_FILTER_THREAD
-#include <functional>
-#include <thread>
-#endif
 #if defined(__MINGW32__)
 #define swprintf _snwprintf
 #endif
 
 void TxFilter::clear()
 {
+#ifndef NO_FILTER_THREAD
+  /* stop background enhancement */
+  stop();
+#endif
+
   /* clear hires texture cache */
   delete _txHiResCache;
   _txHiResCache = NULL;
@@ -56,6 +57,10 @@ void TxFilter::clear()
   _txQuantize = NULL;
   delete _txUtil;
   _txUtil = NULL;
+
+  /* last, the caches and quantizer above use it */
+  delete _txThreadPool;
+  _txThreadPool = NULL;
 }
 
 TxFilter::~TxFilter()
@@ -69,7 +74,10 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
   _numcore(1), _tex1(NULL), _tex2(NULL), _maxwidth(0), _maxheight(0),
   _maxbpp(0), _options(0), _cacheSize(0), _ident(), _datapath(), _cachepath(),
   _txQuantize(NULL), _txTexCache(NULL), _txHiResCache(NULL), _txUtil(NULL),
-  _txImage(NULL), _initialized(false)
+  _txImage(NULL), _txThreadPool(NULL), _initialized(false)
+#ifndef NO_FILTER_THREAD
+  , _asyncFinished(0), _asyncCollected(0), _asyncTex1(NULL), _asyncTex2(NULL), _asyncQuit(0)
+#endif
 {
   clear(); /* gcc does not allow the destructor to be called */
 
@@ -91,12 +99,16 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
   _options = options;
 
   _txImage      = new TxImage();
-  _txQuantize   = new TxQuantize();
   _txUtil       = new TxUtil();
 
   /* get number of CPU cores. */
   _numcore = _txUtil->getNumberofProcessors();
 
+  /* start the worker threads once, not for every texture */
+  _txThreadPool = new TxThreadPool(_numcore);
+  _numcore      = _txThreadPool->size();
+  _txQuantize   = new TxQuantize(_txThreadPool);
+
   _initialized = 0;
 
   _tex1 = NULL;
@@ -155,7 +167,7 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 
   /* hires texture */
 #if HIRES_TEXTURE
-  _txHiResCache = new TxHiResCache(_maxwidth, _maxheight, _maxbpp, _options, _datapath.c_str(), _cachepath.c_str(), _ident.c_str(), callback);
+  _txHiResCache = new TxHiResCache(_maxwidth, _maxheight, _maxbpp, _options, _datapath.c_str(), _cachepath.c_str(), _ident.c_str(), callback, _txThreadPool);
 
   if (_txHiResCache->empty())
     _options &= ~HIRESTEXTURES_MASK;
@@ -166,37 +178,189 @@ TxFilter::TxFilter(int maxwidth, int maxheight, int maxbpp, int options,
 
   if (_tex1 && _tex2)
       _initialized = 1;
+
+#ifndef NO_FILTER_THREAD
+  /* background enhancement keeps its results in the texture cache */
+  if ((_options & ASYNC_TEX) && _cacheSize && _initialized) {
+    _asyncTex1 = (uint8 *)malloc(_maxwidth * _maxheight * 4);
+    _asyncTex2 = (uint8 *)malloc(_maxwidth * _maxheight * 4);
+    if (_asyncTex1 && _asyncTex2)
+      _asyncThread = std::thread(&TxFilter::worker, this);
+    else
+      stop();
+  }
+  if (!_asyncThread.joinable())
+#endif
+    _options &= ~ASYNC_TEX;
+}
+
+#ifndef NO_FILTER_THREAD
+void
+TxFilter::stop()
+{
+  if (_asyncThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(_asyncMutex);
+      _asyncQuit = 1;
+    }
+    _asyncWake.notify_one();
+    _asyncThread.join();
+  }
+  _asyncQuit = 0;
+
+  while (!_asyncQueue.empty()) {
+    free(_asyncQueue.front()->data);
+    delete _asyncQueue.front();
+    _asyncQueue.pop_front();
+  }
+  while (!_asyncDone.empty()) {
+    free(_asyncDone.front()->data);
+    delete _asyncDone.front();
+    _asyncDone.pop_front();
+  }
+  _asyncPending.clear();
+  _asyncFailed.clear();
+  _asyncFinished = 0;
+  _asyncCollected = 0;
+
+  free(_asyncTex1);
+  _asyncTex1 = NULL;
+  free(_asyncTex2);
+  _asyncTex2 = NULL;
 }
 
 boolean
-TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc, GHQTexInfo *info)
+TxFilter::queue(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc)
 {
-  uint8 *texture = src;
-  uint8 *tmptex = _tex1;
-  uint16 destformat = srcformat;
+  /* already on its way */
+  if (_asyncPending.count(g64crc))
+    return 1;
 
-  /* We need to be initialized first! */
-  if (!_initialized) return 0;
+  /* do it here if it failed before or if the queue is backed up. */
+  if (_asyncFailed.count(g64crc) || _asyncPending.size() >= MAX_ASYNC_JOBS)
+    return 0;
 
-  /* find cached textures */
-  if (_cacheSize) {
+  int dataSize = _txUtil->sizeofTx(srcwidth, srcheight, srcformat);
+  if (!dataSize)
+    return 0;
 
-    /* calculate checksum of source texture */
-    if (!g64crc)
-      g64crc = (uint64)(_txUtil->checksumTx(texture, srcwidth, srcheight, srcformat));
+  /* the caller's buffer is reused as soon as we return */
+  TXJOB *job = new TXJOB;
+  job->data = (uint8 *)malloc(dataSize);
+  if (!job->data) {
+    delete job;
+    return 0;
+  }
+  memcpy(job->data, src, dataSize);
+  job->g64crc = g64crc;
+  job->width  = srcwidth;
+  job->height = srcheight;
+  job->format = srcformat;
+  memset(&job->info, 0, sizeof(GHQTexInfo));
+
+  {
+    std::lock_guard<std::mutex> lock(_asyncMutex);
+    _asyncQueue.push_back(job);
+  }
+  _asyncPending.insert(g64crc);
+  _asyncWake.notify_one();
 
-    DBG_INFO(80, L"filter: crc:%08X %08X %d x %d gfmt:%x\n",
-             (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, srcformat);
+  DBG_INFO(80, L"queued: crc:%08X %08X %d x %d gfmt:%x\n",
+           (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, srcformat);
 
-#if 0 /* use hirestex to retrieve cached textures. */
-    /* check if we have it in cache */
-    if (!(g64crc & 0xffffffff00000000) && /* we reach here only when there is no hires texture for this crc */
-        _txTexCache->get(g64crc, info)) {
-      DBG_INFO(80, L"cache hit: %d x %d gfmt:%x\n", info->width, info->height, info->format);
-      return 1; /* yep, we've got it */
+  return 1;
+}
+
+void
+TxFilter::worker()
+{
+  std::unique_lock<std::mutex> lock(_asyncMutex);
+
+  for (;;) {
+    while (!_asyncQuit && _asyncQueue.empty())
+      _asyncWake.wait(lock);
+    if (_asyncQuit)
+      return;
+
+    TXJOB *job = _asyncQueue.front();
+    _asyncQueue.pop_front();
+    lock.unlock();
+
+    /* the result lands in one of the scratch buffers, keep a copy */
+    uint8 *data = NULL;
+    if (enhance(job->data, job->width, job->height, job->format,
+                _asyncTex1, _asyncTex2, &job->info)) {
+      int dataSize = _txUtil->sizeofTx(job->info.width, job->info.height, job->info.format);
+      if (dataSize)
+        data = (uint8 *)malloc(dataSize);
+      if (data)
+        memcpy(data, job->info.data, dataSize);
     }
+    free(job->data);
+    job->data = data;
+    job->info.data = data;
+
+    lock.lock();
+    _asyncDone.push_back(job);
+    _asyncFinished.fetch_add(1, std::memory_order_release);
+  }
+}
 #endif
+
+void
+TxFilter::collect()
+{
+#ifndef NO_FILTER_THREAD
+  if (!(_options & ASYNC_TEX) ||
+      _asyncFinished.load(std::memory_order_acquire) == _asyncCollected)
+    return;
+
+  std::deque<TXJOB*> done;
+  {
+    std::lock_guard<std::mutex> lock(_asyncMutex);
+    done.swap(_asyncDone);
   }
+  _asyncCollected += done.size();
+
+  /* TxCache is not thread safe, so results are added here. */
+  while (!done.empty()) {
+    TXJOB *job = done.front();
+    done.pop_front();
+
+    boolean added = job->data && _txTexCache->add(job->g64crc, &job->info);
+
+    DBG_INFO(80, L"%s: crc:%08X %08X %d x %d gfmt:%x\n", added ? L"enhanced" : L"enhancement failed",
+             (uint32)(job->g64crc >> 32), (uint32)(job->g64crc & 0xffffffff),
+             job->info.width, job->info.height, job->info.format);
+
+    _asyncPending.erase(job->g64crc);
+    if (!added)
+      _asyncFailed.insert(job->g64crc);
+    free(job->data);
+    delete job;
+  }
+#endif
+}
+
+/* up to date as of the last collect() */
+boolean
+TxFilter::pending(uint64 g64crc)
+{
+#ifndef NO_FILTER_THREAD
+  if (_options & ASYNC_TEX)
+    return _asyncPending.count(g64crc) ? 1 : 0;
+#endif
+
+  return 0;
+}
+
+boolean
+TxFilter::enhance(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
+                  uint8 *tex1, uint8 *tex2, GHQTexInfo *info)
+{
+  uint8 *texture = src;
+  uint8 *tmptex = tex1;
+  uint16 destformat = srcformat;
 
   /* Leave small textures alone because filtering makes little difference.
    * Moreover, some filters require at least 4 * 4 to work.
@@ -262,7 +426,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
        */
       while (num_filters > 0) {
 
-        tmptex = (texture == _tex1) ? _tex2 : _tex1;
+        tmptex = (texture == tex1) ? tex2 : tex1;
 
         uint8 *_texture = texture;
         uint8 *_tmptex  = tmptex;
@@ -275,31 +439,17 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
           numcore--;
         }
         if (blkrow > 0 && numcore > 1) {
-          std::thread *thrd[MAX_NUMCORE];
-          unsigned int i;
           int blkheight = blkrow << 2;
+          int lastheight = srcheight - blkheight * (numcore - 1);
           unsigned int srcStride = (srcwidth * blkheight) << 2;
           unsigned int destStride = srcStride << scale_shift << scale_shift;
-          for (i = 0; i < numcore - 1; i++) {
-            thrd[i] = new std::thread(std::bind(filter_8888,
-                                                (uint32*)_texture,
-                                                srcwidth,
-                                                blkheight,
-                                                (uint32*)_tmptex,
-                                                filter));
-            _texture += srcStride;
-            _tmptex  += destStride;
-          }
-          thrd[i] = new std::thread(std::bind(filter_8888,
-                                              (uint32*)_texture,
-                                              srcwidth,
-                                              srcheight - blkheight * i,
-                                              (uint32*)_tmptex,
-                                              filter));
-          for (i = 0; i < numcore; i++) {
-            thrd[i]->join();
-            delete thrd[i];
-          }
+          _txThreadPool->run(numcore, [&](int i) {
+            filter_8888((uint32*)(_texture + srcStride * i),
+                        srcwidth,
+                        (i < (int)numcore - 1) ? blkheight : lastheight,
+                        (uint32*)(_tmptex + destStride * i),
+                        filter);
+          });
         } else {
           filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter);
         }
@@ -344,7 +494,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
             (destformat == GR_TEXFMT_ALPHA_8)) {
           compressionType = S3TC_COMPRESSION;
         }
-        tmptex = (texture == _tex1) ? _tex2 : _tex1;
+        tmptex = (texture == tex1) ? tex2 : tex1;
         if (_txQuantize->compress(texture, tmptex,
                                   srcwidth, srcheight, srcformat,
                                   &tmpwidth, &tmpheight, &tmpformat,
@@ -363,7 +513,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
       if (destformat == GR_TEXFMT_ARGB_8888) {
         if (srcformat == GR_TEXFMT_ARGB_8888 && (_maxbpp < 32 || _options & FORCE16BPP_TEX)) srcformat = GR_TEXFMT_ARGB_4444;
         if (srcformat != GR_TEXFMT_ARGB_8888) {
-          tmptex = (texture == _tex1) ? _tex2 : _tex1;
+          tmptex = (texture == tex1) ? tex2 : tex1;
           if (!_txQuantize->quantize(texture, tmptex, srcwidth, srcheight, GR_TEXFMT_ARGB_8888, srcformat)) {
             DBG_INFO(80, L"Error: unsupported format! gfmt:%x\n", srcformat);
             return 0;
@@ -378,7 +528,7 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
     case GR_TEXFMT_ARGB_4444:
 
       int scale_shift = 0;
-      tmptex = (texture == _tex1) ? _tex2 : _tex1;
+      tmptex = (texture == tex1) ? tex2 : tex1;
 
       switch (_options & ENHANCEMENT_MASK) {
       case HQ4X_ENHANCEMENT:
@@ -433,11 +583,11 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
       }
 
       if (_options & SMOOTH_FILTER_MASK) {
-        tmptex = (texture == _tex1) ? _tex2 : _tex1;
+        tmptex = (texture == tex1) ? tex2 : tex1;
         SmoothFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SMOOTH_FILTER_MASK));
         texture = tmptex;
       } else if (_options & SHARP_FILTER_MASK) {
-        tmptex = (texture == _tex1) ? _tex2 : _tex1;
+        tmptex = (texture == tex1) ? tex2 : tex1;
         SharpFilter_4444((uint16*)texture, srcwidth, srcheight, (uint16*)tmptex, (_options & SHARP_FILTER_MASK));
         texture = tmptex;
       }
@@ -463,6 +613,49 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint
   info->aspectRatioLog2 = _txUtil->grAspectRatioLog2(srcwidth, srcheight);
   info->is_hires_tex = 0;
 
+  return 1;
+}
+
+boolean
+TxFilter::filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc, GHQTexInfo *info)
+{
+  /* We need to be initialized first! */
+  if (!_initialized) return 0;
+
+  /* find cached textures */
+  if (_cacheSize) {
+
+    /* calculate checksum of source texture */
+    if (!g64crc)
+      g64crc = (uint64)(_txUtil->checksumTx(src, srcwidth, srcheight, srcformat));
+
+    DBG_INFO(80, L"filter: crc:%08X %08X %d x %d gfmt:%x\n",
+             (uint32)(g64crc >> 32), (uint32)(g64crc & 0xffffffff), srcwidth, srcheight, srcformat);
+
+#if 0 /* use hirestex to retrieve cached textures. */
+    /* check if we have it in cache */
+    if (!(g64crc & 0xffffffff00000000) && /* we reach here only when there is no hires texture for this crc */
+        _txTexCache->get(g64crc, info)) {
+      DBG_INFO(80, L"cache hit: %d x %d gfmt:%x\n", info->width, info->height, info->format);
+      return 1; /* yep, we've got it */
+    }
+#endif
+  }
+
+#ifndef NO_FILTER_THREAD
+  /* hand enhancements and filters to the background thread. the caller
+   * uploads the texture as it is until the result shows up in the cache. */
+  if ((_options & ASYNC_TEX) && g64crc &&
+      (srcwidth >= 4 && srcheight >= 4) &&
+      (_options & (FILTER_MASK|ENHANCEMENT_MASK))) {
+    if (queue(src, srcwidth, srcheight, srcformat, g64crc))
+      return 0;
+  }
+#endif
+
+  if (!enhance(src, srcwidth, srcheight, srcformat, _tex1, _tex2, info))
+    return 0;
+
   /* cache the texture. */
   if (_cacheSize) _txTexCache->add(g64crc, info);
 
@@ -24,6 +24,9 @@
 #ifndef __TXFILTER_H__
 #define __TXFILTER_H__
 
+/* maximum number of textures waiting for background enhancement */
+#define MAX_ASYNC_JOBS 256
+
 #include "TxInternal.h"
 #include "TxQuantize.h"
 #include "TxHiResCache.h"
@@ -31,6 +34,14 @@
 #include "TxUtil.h"
 #include "TxImage.h"
 #include <string>
+#ifndef NO_FILTER_THREAD
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#endif
 
 class TxFilter
 {
@@ -52,7 +63,40 @@ private:
   TxHiResCache *_txHiResCache;
   TxUtil *_txUtil;
   TxImage *_txImage;
+  TxThreadPool *_txThreadPool;
   boolean _initialized;
+#ifndef NO_FILTER_THREAD
+  /* background enhancement. only the background thread touches _asyncTex1
+   * and _asyncTex2, and only the caller's thread touches _asyncPending and
+   * _asyncFailed. the queues are guarded by _asyncMutex. the background
+   * thread counts finished jobs in _asyncFinished, so collect() only takes
+   * the lock when there is something to move into _txTexCache. */
+  struct TXJOB {
+    uint64 g64crc;
+    uint8 *data;
+    int width;
+    int height;
+    uint16 format;
+    GHQTexInfo info;
+  };
+  std::deque<TXJOB*> _asyncQueue;
+  std::deque<TXJOB*> _asyncDone;
+  std::set<uint64> _asyncPending;
+  std::set<uint64> _asyncFailed;
+  std::atomic<unsigned int> _asyncFinished;
+  unsigned int _asyncCollected;
+  std::mutex _asyncMutex;
+  std::condition_variable _asyncWake;
+  std::thread _asyncThread;
+  uint8 *_asyncTex1;
+  uint8 *_asyncTex2;
+  boolean _asyncQuit;
+  boolean queue(uint8 *src, int srcwidth, int srcheight, uint16 srcformat, uint64 g64crc);
+  void worker();
+  void stop();
+#endif
+  boolean enhance(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
+                  uint8 *tex1, uint8 *tex2, GHQTexInfo *info);
   void clear();
 public:
   ~TxFilter();
@@ -78,6 +122,8 @@ public:
   uint64 checksum64(uint8 *src, int width, int height, int size, int rowStride, uint8 *palette);
   boolean dmptx(uint8 *src, int width, int height, int rowStridePixel, uint16 gfmt, uint16 n64fmt, uint64 r_crc64);
   boolean reloadhirestex();
+  boolean pending(uint64 g64crc); /* glide64 crc */
+  void collect();
 };
 
 #endif /* __TXFILTER_H__ */
@@ -101,6 +101,22 @@ txfilter_reloadhirestex()
   return 0;
 }
 
+TAPI boolean TAPIENTRY
+txfilter_pending(uint64 g64crc)
+{
+  if (txFilter)
+    return txFilter->pending(g64crc);
+
+  return 0;
+}
+
+TAPI void TAPIENTRY
+txfilter_collect()
+{
+  if (txFilter)
+    txFilter->collect();
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -80,11 +80,12 @@ TxHiResCache::~TxHiResCache()
 
 TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
                            const wchar_t *datapath, const wchar_t *cachepath,
-                           const wchar_t *ident, dispInfoFuncExt callback
+                           const wchar_t *ident, dispInfoFuncExt callback,
+                           TxThreadPool *pool
                            ) : TxCache((options & ~GZ_TEXCACHE), 0, datapath, cachepath, ident, callback)
 {
   _txImage = new TxImage();
-  _txQuantize  = new TxQuantize();
+  _txQuantize  = new TxQuantize(pool);
   _txReSample = new TxReSample();
 
   _maxwidth  = maxwidth;
@@ -122,7 +123,7 @@ TxHiResCache::TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
 boolean
 TxHiResCache::empty()
 {
-  return _cache.empty();
+  return _cache.empty() && !_mapCount;
 }
 
 boolean
@@ -52,7 +52,8 @@ public:
   ~TxHiResCache();
   TxHiResCache(int maxwidth, int maxheight, int maxbpp, int options,
                const wchar_t *datapath, const wchar_t *cachepath,
-               const wchar_t *ident, dispInfoFuncExt callback);
+               const wchar_t *ident, dispInfoFuncExt callback,
+               TxThreadPool *pool);
   boolean empty();
   boolean load(boolean replace);
 };
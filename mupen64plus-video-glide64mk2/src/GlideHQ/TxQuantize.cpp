@@ -25,21 +25,17 @@
 #pragma warning(disable: 4786)
 #endif
 
-#ifndef NO_FILTER_THREAD
-#include <functional>
-#include <thread>
-#endif
-
 /* NOTE: The codes are not optimized. They can be made faster. */
 
 #include "TxQuantize.h"
 
-TxQuantize::TxQuantize()
+TxQuantize::TxQuantize(TxThreadPool *pool)
 {
   _txUtil = new TxUtil();
 
-  /* get number of CPU cores. */
-  _numcore = _txUtil->getNumberofProcessors();
+  /* the worker threads belong to TxFilter */
+  _txThreadPool = pool;
+  _numcore = _txThreadPool->size();
 
   /* get dxtn extensions */
   _tx_compress_fxt1 = TxLoadLib::getInstance()->getfxtCompressTexFuncExt();
@@ -1777,31 +1773,16 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, uint16 srcf
       numcore--;
     }
     if (blkrow > 0 && numcore > 1) {
-      std::thread *thrd[MAX_NUMCORE];
-      unsigned int i;
       int blkheight = blkrow << 2;
+      int lastheight = height - blkheight * (numcore - 1);
       unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
       unsigned int destStride = srcStride << bpp_shift;
-      for (i = 0; i < numcore - 1; i++) {
-        thrd[i] = new std::thread(std::bind(quantizer,
-                                            this,
-                                            (uint32*)src,
-                                            (uint32*)dest,
-                                            width,
-                                            blkheight));
-        src  += srcStride;
-        dest += destStride;
-      }
-      thrd[i] = new std::thread(std::bind(quantizer,
-                                          this,
-                                          (uint32*)src,
-                                          (uint32*)dest,
-                                          width,
-                                          height - blkheight * i));
-      for (i = 0; i < numcore; i++) {
-        thrd[i]->join();
-        delete thrd[i];
-      }
+      _txThreadPool->run(numcore, [&](int i) {
+        (*this.*quantizer)((uint32*)(src + srcStride * i),
+                           (uint32*)(dest + destStride * i),
+                           width,
+                           (i < (int)numcore - 1) ? blkheight : lastheight);
+      });
     } else {
       (*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
     }
@@ -1848,31 +1829,16 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, uint16 srcf
       numcore--;
     }
     if (blkrow > 0 && numcore > 1) {
-      std::thread *thrd[MAX_NUMCORE];
-      unsigned int i;
       int blkheight = blkrow << 2;
+      int lastheight = height - blkheight * (numcore - 1);
       unsigned int srcStride = (width * blkheight) << 2;
       unsigned int destStride = srcStride >> bpp_shift;
-      for (i = 0; i < numcore - 1; i++) {
-        thrd[i] = new std::thread(std::bind(quantizer,
-                                            this,
-                                            (uint32*)src,
-                                            (uint32*)dest,
-                                            width,
-                                            blkheight));
-        src  += srcStride;
-        dest += destStride;
-      }
-      thrd[i] = new std::thread(std::bind(quantizer,
-                                          this,
-                                          (uint32*)src,
-                                          (uint32*)dest,
-                                          width,
-                                          height - blkheight * i));
-      for (i = 0; i < numcore; i++) {
-        thrd[i]->join();
-        delete thrd[i];
-      }
+      _txThreadPool->run(numcore, [&](int i) {
+        (*this.*quantizer)((uint32*)(src + srcStride * i),
+                           (uint32*)(dest + destStride * i),
+                           width,
+                           (i < (int)numcore - 1) ? blkheight : lastheight);
+      });
     } else {
       (*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
     }
@@ -1918,35 +1884,19 @@ TxQuantize::FXT1(uint8 *src, uint8 *dest,
       numcore--;
     }
     if (blkrow > 0 && numcore > 1) {
-      std::thread *thrd[MAX_NUMCORE];
-      unsigned int i;
       int blkheight = blkrow << 2;
+      int lastheight = srcheight - blkheight * (numcore - 1);
       unsigned int srcStride = (srcwidth * blkheight) << 2;
       unsigned int destStride = dstRowStride * blkrow;
-      for (i = 0; i < numcore - 1; i++) {
-        thrd[i] = new std::thread(std::bind(_tx_compress_fxt1,
-                                            srcwidth,
-                                            blkheight,
-                                            4,
-                                            src,
-                                            srcRowStride,
-                                            dest,
-                                            dstRowStride));
-        src  += srcStride;
-        dest += destStride;
-      }
-      thrd[i] = new std::thread(std::bind(_tx_compress_fxt1,
-                                          srcwidth,
-                                          srcheight - blkheight * i,
-                                          4,
-                                          src,
-                                          srcRowStride,
-                                          dest,
-                                          dstRowStride));
-      for (i = 0; i < numcore; i++) {
-        thrd[i]->join();
-        delete thrd[i];
-      }
+      _txThreadPool->run(numcore, [&](int i) {
+        (*_tx_compress_fxt1)(srcwidth,
+                             (i < (int)numcore - 1) ? blkheight : lastheight,
+                             4,
+                             src + srcStride * i,
+                             srcRowStride,
+                             dest + destStride * i,
+                             dstRowStride);
+      });
     } else {
       (*_tx_compress_fxt1)(srcwidth,      /* width */
                            srcheight,     /* height */
@@ -2034,35 +1984,19 @@ TxQuantize::DXTn(uint8 *src, uint8 *dest,
         numcore--;
       }
       if (blkrow > 0 && numcore > 1) {
-        std::thread *thrd[MAX_NUMCORE];
-        unsigned int i;
         int blkheight = blkrow << 2;
+        int lastheight = srcheight - blkheight * (numcore - 1);
         unsigned int srcStride = (srcwidth * blkheight) << 2;
         unsigned int destStride = dstRowStride * blkrow;
-        for (i = 0; i < numcore - 1; i++) {
-          thrd[i] = new std::thread(std::bind(_tx_compress_dxtn_rgba,
-                                              4,
-                                              srcwidth,
-                                              blkheight,
-                                              src,
-                                              compression,
-                                              dest,
-                                              dstRowStride));
-          src  += srcStride;
-          dest += destStride;
-        }
-        thrd[i] = new std::thread(std::bind(_tx_compress_dxtn_rgba,
-                                            4,
-                                            srcwidth,
-                                            srcheight - blkheight * i,
-                                            src,
-                                            compression,
-                                            dest,
-                                            dstRowStride));
-        for (i = 0; i < numcore; i++) {
-          thrd[i]->join();
-          delete thrd[i];
-        }
+        _txThreadPool->run(numcore, [&](int i) {
+          (*_tx_compress_dxtn_rgba)(4,
+                                    srcwidth,
+                                    (i < (int)numcore - 1) ? blkheight : lastheight,
+                                    src + srcStride * i,
+                                    compression,
+                                    dest + destStride * i,
+                                    dstRowStride);
+        });
       } else {
         (*_tx_compress_dxtn_rgba)(4,             /* comps: ARGB8888=4, RGB888=3 */
                              srcwidth,      /* width */
@@ -35,6 +35,7 @@ class TxQuantize
 {
 private:
   TxUtil *_txUtil;
+  TxThreadPool *_txThreadPool;
   int _numcore;
 
   fxtCompressTexFuncExt _tx_compress_fxt1;
@@ -72,7 +73,7 @@ private:
                int *destwidth, int *destheight, uint16 *destformat);
 
 public:
-  TxQuantize();
+  TxQuantize(TxThreadPool *pool);
   ~TxQuantize();
 
   /* others */
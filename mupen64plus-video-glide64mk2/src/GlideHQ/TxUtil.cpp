@@ -528,6 +528,114 @@ TxUtil::getNumberofProcessors()
 }
 
 
+/*
+ * Thread pool for texture manipulations
+ ******************************************************************************/
+TxThreadPool::TxThreadPool(int numthreads)
+{
+  if (numthreads < 1)
+    numthreads = 1;
+  if (numthreads > MAX_NUMCORE)
+    numthreads = MAX_NUMCORE;
+
+#ifdef NO_FILTER_THREAD
+  _numthreads = 1;
+#else
+  _numthreads = numthreads;
+  _job = NULL;
+  _count = 0;
+  _next = 0;
+  _busy = 0;
+  _generation = 0;
+  _quit = 0;
+
+  /* the thread calling run() does its share of the work */
+  int i;
+  for (i = 1; i < _numthreads; i++)
+    _workers.push_back(std::thread(&TxThreadPool::worker, this));
+#endif
+}
+
+TxThreadPool::~TxThreadPool()
+{
+#ifndef NO_FILTER_THREAD
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = 1;
+  }
+  _wake.notify_all();
+
+  unsigned int i;
+  for (i = 0; i < _workers.size(); i++)
+    _workers[i].join();
+#endif
+}
+
+#ifndef NO_FILTER_THREAD
+void
+TxThreadPool::work()
+{
+  int i;
+  while ((i = _next++) < _count)
+    (*_job)(i);
+}
+
+void
+TxThreadPool::worker()
+{
+  unsigned int generation = 0;
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  for (;;) {
+    while (!_quit && _generation == generation)
+      _wake.wait(lock);
+    if (_quit)
+      return;
+    generation = _generation;
+
+    lock.unlock();
+    work();
+    lock.lock();
+
+    /* every worker checks in once per batch, so none can miss one */
+    if (--_busy == 0)
+      _done.notify_one();
+  }
+}
+#endif
+
+void
+TxThreadPool::run(int count, const std::function<void(int)> &job)
+{
+#ifndef NO_FILTER_THREAD
+  std::unique_lock<std::mutex> batch(_batchMutex, std::try_to_lock);
+  if (count > 1 && !_workers.empty() && batch.owns_lock()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _job = &job;
+      _count = count;
+      _next = 0;
+      _busy = _workers.size();
+      _generation++;
+    }
+    _wake.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_busy)
+      _done.wait(lock);
+    _job = NULL;
+    return;
+  }
+#endif
+
+  int i;
+  for (i = 0; i < count; i++)
+    job(i);
+}
+
+
 /*
  * Memory buffers for texture manipulations
  ******************************************************************************/
@@ -29,6 +29,14 @@
 
 #include "TxInternal.h"
 #include <string>
+#include <functional>
+#ifndef NO_FILTER_THREAD
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
 
 #ifndef DXTN_DLL
 #ifdef __cplusplus
@@ -118,4 +126,34 @@ public:
   uint32 size_of(unsigned int num);
 };
 
+/* worker threads that live as long as the texture filter. run() splits
+ * the work into count bands and returns once all of them are done. idle
+ * threads, the caller included, keep taking the next band that is left.
+ * a run() that overlaps another one does its bands on its own. */
+class TxThreadPool
+{
+private:
+  int _numthreads;
+#ifndef NO_FILTER_THREAD
+  std::vector<std::thread> _workers;
+  std::mutex _batchMutex;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  const std::function<void(int)> *_job;
+  int _count;
+  std::atomic<int> _next;
+  int _busy;
+  unsigned int _generation;
+  boolean _quit;
+  void worker();
+  void work();
+#endif
+public:
+  TxThreadPool(int numthreads);
+  ~TxThreadPool();
+  int size() { return _numthreads; }
+  void run(int count, const std::function<void(int)> &job);
+};
+
 #endif /* __TXUTIL_H__ */
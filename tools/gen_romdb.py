@@ -1,142 +1,273 @@
-#!/usr/bin/env python2
+#!/usr/bin/env python
 # -*- coding: utf-8 -*-
-# usage: gen_romdb.py mupen64plus.ini
-import io
-import os
+# usage: gen_romdb.py [--luts] mupen64plus.ini
+#
+# Without options, compiles the ROM database into rom_db.c, which rom.c
+# includes in place of parsing mupen64plus.ini at startup: every entry with
+# its RefMD5 already resolved, plus perfect hash indices on MD5 and CRC.
+#
+# With --luts, writes the save type tables to rom_luts.c instead. rom_luts.c
+# also carries hand-maintained tables (DelaySI, CountPerOp), so merge the
+# output rather than overwrite it.
 import re
 import sys
-from pprint import pprint # for debugging
-from ConfigParser import ConfigParser
-from collections import OrderedDict
 
-OUTPUT_FILE='rom_luts.c'
-
-if len(sys.argv) < 2:
-    print("usage: %s mupen64plus.ini" % sys.argv[0])
+OUTPUT_FILE='rom_db.c'
+LUTS_OUTPUT_FILE='rom_luts.c'
+
+# Matches romdatabase_entry in rom.h.
+DEFAULT = 'DEFAULT'
+SAVE_TYPES = {
+    'Eeprom 4KB': 'EEPROM_4KB',
+    'Eeprom 16KB': 'EEPROM_16KB',
+    'SRAM': 'SRAM',
+    'Flash RAM': 'FLASH_RAM',
+    'Controller Pack': 'CONTROLLER_PACK',
+    'None': 'NONE',
+}
+
+# Must stay in sync with romdb_hash() in rom.c.
+def romdb_hash(words, seed):
+    h = (0x811C9DC5 ^ seed) & 0xFFFFFFFF
+    for w in words:
+        h = ((h ^ w) * 0x9E3779B1) & 0xFFFFFFFF
+        h ^= h >> 16
+    h ^= h >> 13
+    h = (h * 0x85EBCA6B) & 0xFFFFFFFF
+    h ^= h >> 16
+    return h
+
+def md5_words(md5):
+    return [int(md5[i:i+8], 16) for i in range(0, 32, 8)]
+
+def warn(lineno, what):
+    sys.stderr.write("line %i: %s\n" % (lineno, what))
+
+# Parses the file the way romdatabase_open() does, warnings included.
+def parse_ini(path):
+    entries = []
+    entry = None
+    hexre = re.compile(r'^[0-9A-Fa-f]{32}$')
+    crcre = re.compile(r'^([0-9A-Fa-f]{1,8})\s+([0-9A-Fa-f]{1,8})$')
+
+    for lineno, line in enumerate(open(path, 'rb'), 1):
+        line = line.decode('latin-1').strip()
+        if line == '' or line[0] in '#;':
+            continue
+        if line[0] == '[' and line[-1] == ']':
+            name = line[1:-1].strip()
+            if not hexre.match(name):
+                warn(lineno, "invalid MD5")
+                entry = None
+                continue
+            entry = {
+                'md5': name.upper(), 'refmd5': None, 'goodname': None,
+                'crc': None, 'status': 0, 'savetype': DEFAULT,
+                'players': DEFAULT, 'rumble': DEFAULT,
+            }
+            entries.append(entry)
+            continue
+        if '=' not in line:
+            continue
+        if entry is None:
+            warn(lineno, "ignoring property")
+            continue
+
+        key, value = [s.strip() for s in line.split('=', 1)]
+        if key == 'GoodName':
+            entry['goodname'] = value
+        elif key == 'CRC':
+            m = crcre.match(value)
+            if m:
+                entry['crc'] = (int(m.group(1), 16), int(m.group(2), 16))
+            else:
+                warn(lineno, "invalid CRC")
+        elif key == 'RefMD5':
+            if hexre.match(value):
+                entry['refmd5'] = value.upper()
+            else:
+                warn(lineno, "invalid RefMD5")
+        elif key == 'SaveType':
+            if value in SAVE_TYPES:
+                entry['savetype'] = SAVE_TYPES[value]
+            else:
+                warn(lineno, "invalid save type")
+        elif key == 'Status':
+            if value.isdigit() and int(value) < 6:
+                entry['status'] = int(value)
+            else:
+                warn(lineno, "invalid status")
+        elif key == 'Players':
+            if value.isdigit() and int(value) < 8:
+                entry['players'] = int(value)
+            else:
+                warn(lineno, "invalid player count")
+        elif key == 'Rumble':
+            if value in ('Yes', 'No'):
+                entry['rumble'] = int(value == 'Yes')
+            else:
+                warn(lineno, "invalid rumble string")
+        else:
+            warn(lineno, "unknown property")
+
+    return entries
+
+def resolve_refmd5(entries):
+    by_md5 = dict((e['md5'], e) for e in entries)
+    for e in entries:
+        if e['refmd5'] is None:
+            continue
+        ref = by_md5.get(e['refmd5'])
+        if ref is None:
+            sys.stderr.write("error solving RefMD5 %s\n" % e['refmd5'])
+            continue
+        for field, unset in (('savetype', DEFAULT), ('status', 0),
+                             ('players', DEFAULT), ('rumble', DEFAULT)):
+            if ref[field] != unset:
+                e[field] = ref[field]
+
+# Hash and displace: keys are split into buckets by one hash, then each
+# bucket, largest first, gets the first seed that sends all of its keys to
+# free slots. The lookup is two hashes and one compare.
+def perfect_hash(keys):
+    nslots = max(1, len(keys) * 5 // 4)
+    nbuckets = max(1, len(keys) // 3)
+    buckets = [[] for _ in range(nbuckets)]
+    for index, words in keys:
+        buckets[romdb_hash(words, 0) % nbuckets].append((index, words))
+
+    slots = [None] * nslots
+    seeds = [0] * nbuckets
+    order = sorted(range(nbuckets), key=lambda b: -len(buckets[b]))
+    for b in order:
+        if not buckets[b]:
+            continue
+        seed = 1
+        while True:
+            taken = [romdb_hash(w, seed) % nslots for _, w in buckets[b]]
+            if len(set(taken)) == len(taken) and \
+               all(slots[s] is None for s in taken):
+                break
+            seed += 1
+            if seed > 0xFFFF:
+                sys.exit("gen_romdb.py: no displacement for bucket %i" % b)
+        seeds[b] = seed
+        for (index, _), s in zip(buckets[b], taken):
+            slots[s] = index
+
+    return seeds, [0xFFFF if s is None else s for s in slots]
+
+def c_string(s):
+    out = ''
+    for ch in s:
+        if ch in '"\\?':
+            out += '\\' + ch
+        elif ' ' <= ch <= '~':
+            out += ch
+        else:
+            out += '\\%03o' % (ord(ch) & 0xFF)
+    return '"' + out + '"'
+
+def write_table(f, ctype, name, values, per_line):
+    f.write("static const %s %s[%i] = {\n" % (ctype, name, len(values)))
+    for i in range(0, len(values), per_line):
+        f.write("   " + ", ".join(str(v) for v in values[i:i+per_line]) + ",\n")
+    f.write("};\n")
+
+def write_db(entries):
+    # open_rom() copies the goodname unconditionally.
+    entries = [e for e in entries if e['goodname'] is not None]
+    if len(entries) >= 0xFFFF:
+        sys.exit("gen_romdb.py: too many entries for 16-bit indices")
+
+    md5_keys = [(i, md5_words(e['md5'])) for i, e in enumerate(entries)]
+
+    # Several dumps share one header CRC. Prefer the verified good dump,
+    # otherwise the first one listed.
+    by_crc = {}
+    for i, e in enumerate(entries):
+        if e['crc'] is None:
+            continue
+        best = by_crc.get(e['crc'])
+        if best is None or ('[!]' in e['goodname'] and
+                            '[!]' not in entries[best]['goodname']):
+            by_crc[e['crc']] = i
+    crc_keys = [(i, list(crc)) for crc, i in sorted(by_crc.items())]
+
+    md5_seeds, md5_slots = perfect_hash(md5_keys)
+    crc_seeds, crc_slots = perfect_hash(crc_keys)
+
+    f = open(OUTPUT_FILE, 'w')
+    f.write("/* This file was generated by gen_romdb.py */\n")
+    f.write("#define ROMDB_ENTRIES      %i\n" % len(entries))
+    f.write("#define ROMDB_MD5_BUCKETS  %i\n" % len(md5_seeds))
+    f.write("#define ROMDB_MD5_SLOTS    %i\n" % len(md5_slots))
+    f.write("#define ROMDB_CRC_BUCKETS  %i\n" % len(crc_seeds))
+    f.write("#define ROMDB_CRC_SLOTS    %i\n" % len(crc_slots))
+    f.write("#define ROMDB_NONE         0xFFFF\n\n")
+
+    f.write("static const romdatabase_entry romdb_entries[ROMDB_ENTRIES] = {\n")
+    for e in entries:
+        md5 = ",".join("0x" + e['md5'][i:i+2] for i in range(0, 32, 2))
+        crc1, crc2 = e['crc'] if e['crc'] is not None else (0, 0)
+        f.write("   { %s, { %s }, 0x%08X, 0x%08X, %s, %s, %s, %s },\n" % (
+            c_string(e['goodname']), md5, crc1, crc2,
+            e['status'], e['savetype'], e['players'], e['rumble']))
+    f.write("};\n\n")
+
+    f.write("/* MD5 index */\n")
+    write_table(f, "uint16_t", "romdb_md5_seeds", md5_seeds, 12)
+    write_table(f, "uint16_t", "romdb_md5_slots", md5_slots, 12)
+    f.write("\n/* CRC1/CRC2 index */\n")
+    write_table(f, "uint16_t", "romdb_crc_seeds", crc_seeds, 12)
+    write_table(f, "uint16_t", "romdb_crc_slots", crc_slots, 12)
+    f.close()
+    print("Wrote %s (%i entries, %i CRC keys)" % (
+        OUTPUT_FILE, len(entries), len(crc_keys)))
+
+def write_lut(f, name, comment, games):
+    f.write("/* %s */\n" % comment)
+    f.write("static const uint64_t %s[] = {\n" % name)
+    for i, game in enumerate(games):
+        comma = ',' if i < len(games) - 1 else ' '
+        f.write("   0x%08X%08XULL%s /* %s */\n" % (
+            game['crc'][0], game['crc'][1], comma, game['goodname']))
+    f.write("};\n")
+
+def write_luts(entries):
+    # One entry per game name and CRC, ordered by name.
+    games = {}
+    for e in entries:
+        if e['goodname'] is None or e['crc'] is None:
+            continue
+        name = re.match(r'([^(]+)', e['goodname']).group(0).strip().lower()
+        dumps = games.setdefault(name, [])
+        if not any(d['crc'] == e['crc'] for d in dumps):
+            dumps.append(e)
+    ordered = [g for _, dumps in sorted(games.items()) for g in dumps]
+
+    f = open(LUTS_OUTPUT_FILE, 'w')
+    f.write("/* This file was generated by gen_romdb.py */\n")
+    write_lut(f, "lut_ee16k", "Games that use 16Kbit EEPROM",
+              [g for g in ordered if g['savetype'] == 'EEPROM_16KB'])
+    write_lut(f, "lut_ee4k", "Games that use 4Kbit EEPROM",
+              [g for g in ordered if g['savetype'] == 'EEPROM_4KB'])
+    write_lut(f, "lut_flashram", "Games that use Flash RAM",
+              [g for g in ordered if g['savetype'] == 'FLASH_RAM'])
+    f.close()
+    print("Wrote " + LUTS_OUTPUT_FILE)
+
+args = sys.argv[1:]
+luts = '--luts' in args
+args = [a for a in args if a != '--luts']
+if len(args) != 1:
+    print("usage: %s [--luts] mupen64plus.ini" % sys.argv[0])
     sys.exit(0)
 
-gConf  = ConfigParser()
-gGames = dict()
-
-def get_save_type(t):
-    return t.upper().replace(' ', '_') 
-
-sys.stderr.write("Parsing " + sys.argv[1] + "...\n")
-gConf.readfp(open(sys.argv[1]))
-gNameRe = re.compile(r'([^(]+)', re.IGNORECASE)
-
-gEeprom16k  = list()
-gFlashRAM   = list()
-gEeprom4k   = list()
-gCountPerOp = list()
-
-for section in gConf.sections():
-    conf = dict(gConf.items(section))
-    conf['crc'] = conf['crc'].replace(' ', '')
-    conf['simplename'] = gNameRe.search(conf['goodname']).group(0).strip()
-    name = conf['simplename'].lower()
-
-    if not name in gGames:
-        gGames[name] = []
-
-    skip = False
-    for game in gGames[name]:
-        if game['crc'] == conf['crc']:
-            skip = True
-            break
-
-    if not skip:
-        gGames[name].append(conf)
-
-# order by rom name
-gGames = OrderedDict(sorted(gGames.items(), key=lambda t: t[0]))
-
-# detect eeprom16k 
-for _, games in gGames.items():
-    for game in games:
-        if game.get('savetype', '').lower() == 'eeprom 16kb':
-            gEeprom16k.append(game)
-
-        if game.get('savetype', '').lower() == 'eeprom 4kb':
-            gEeprom4k.append(game)
-
-        if game.get('savetype', '').lower() == 'flash ram':
-            gFlashRAM.append(game)
-
-        if 'countperop' in game:
-            gCountPerOp.append(game)
-
-print("Wrote " + OUTPUT_FILE)
-romdb = open(OUTPUT_FILE, 'w')
-romdb.write("/* This file was generated by gen_romdb.py */\n")
-romdb.write("/* Games that use 16Kbit EEPROM */\n")
-romdb.write("static const uint64_t lut_ee16k[] = {\n")
-
-i = 0
-for game in gEeprom16k:
-    comma = ','
-
-    if i == len(gEeprom16k) - 1:
-        comma = ' '
-
-    romdb.write('   0x' + game['crc'] + 'ULL' + comma + ' /* ' + game['goodname'] + " */\n")
-
-    i = i + 1
-
-romdb.write("};\n")
-
-romdb.write("/* Games that use 4Kbit EEPROM */\n")
-romdb.write("static const uint64_t lut_ee4k[] = {\n")
-
-i = 0
-for game in gEeprom4k:
-    comma = ','
-
-    if i == len(gEeprom4k) - 1:
-        comma = ' '
-
-    romdb.write('   0x' + game['crc'] + 'ULL' + comma + ' /* ' + game['goodname'] + " */\n")
-
-    i = i + 1
-
-romdb.write("};\n")
-
-romdb.write("/* Games that use Flash RAM */\n")
-romdb.write("static const uint64_t lut_flashram[] = {\n")
-
-i = 0
-for game in gFlashRAM:
-    comma = ','
-
-    if i == len(gFlashRAM) - 1:
-        comma = ' '
-
-    romdb.write('   0x' + game['crc'] + 'ULL' + comma + ' /* ' + game['goodname'] + " */\n")
-
-    i = i + 1
-
-romdb.write("};\n")
-
-i = 0
-
-romdb.write("/* Cycles per emulated instruction (aka CountPerOp) */\n")
-romdb.write("static const uint64_t lut_cpop[][2] = {\n")
-for game in gCountPerOp:
-    comma = ','
-
-    if i == len(gEeprom16k) - 1:
-        comma = ' '
-
-    if i == len(gEeprom4k) - 1:
-        comma = ' '
-
-    if i == len(gFlashRAM) - 1:
-        comma = ' '
-
-    romdb.write('   { 0x' + game['crc'] + 'ULL, ' + game['countperop'] + ' }' + comma + ' /* ' + game['goodname'] + " */\n")
-
-romdb.write("};\n")
-    
-romdb.close()
-
-
+sys.stderr.write("Parsing " + args[0] + "...\n")
+gEntries = parse_ini(args[0])
+resolve_refmd5(gEntries)
+if luts:
+    write_luts(gEntries)
+else:
+    write_db(gEntries)